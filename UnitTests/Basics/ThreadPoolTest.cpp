@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for ThreadPool class
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2011-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "Basics/ThreadPool.h"
+
+#include <atomic>
+
+using namespace triagens;
+using namespace triagens::basics;
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct ThreadPoolSetup {
+  ThreadPoolSetup () {
+    BOOST_TEST_MESSAGE("setup ThreadPool");
+  }
+
+  ~ThreadPoolSetup () {
+    BOOST_TEST_MESSAGE("teardown ThreadPool");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE (ThreadPoolTest, ThreadPoolSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test_ParallelForEmpty
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (test_ParallelForEmpty) {
+  ThreadPool pool(4, "Test");
+  std::atomic<size_t> calls(0);
+
+  pool.parallelFor(0, [&calls] (size_t) -> void {
+    ++calls;
+  });
+
+  BOOST_CHECK_EQUAL(calls.load(), (size_t) 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test_ParallelForAll
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (test_ParallelForAll) {
+  ThreadPool pool(4, "Test");
+  size_t const n = 1000;
+  vector<std::atomic<int>> seen(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    seen[i] = 0;
+  }
+
+  pool.parallelFor(n, [&seen] (size_t i) -> void {
+    ++seen[i];
+  });
+
+  // every value must have been processed exactly once
+  for (size_t i = 0; i < n; ++i) {
+    BOOST_CHECK_EQUAL(seen[i].load(), 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test_ParallelForNested
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (test_ParallelForNested) {
+  ThreadPool pool(2, "Test");
+  std::atomic<size_t> calls(0);
+
+  // calling parallelFor from inside the pool must not deadlock
+  pool.parallelFor(8, [&pool, &calls] (size_t) -> void {
+    pool.parallelFor(8, [&calls] (size_t) -> void {
+      ++calls;
+    });
+  });
+
+  BOOST_CHECK_EQUAL(calls.load(), (size_t) 64);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
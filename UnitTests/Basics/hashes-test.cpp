@@ -423,6 +423,54 @@ BOOST_AUTO_TEST_CASE (tst_crc32_utf8) {
   BOOST_CHECK_EQUAL((uint64_t) 2590070434ULL,   TRI_FinalCrc32(TRI_BlockCrc32(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test crc32c for simple strings
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_crc32c_simple) {
+  std::string buffer;
+
+  buffer = "";
+  BOOST_CHECK_EQUAL((uint64_t) 0ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+  BOOST_CHECK_EQUAL((uint64_t) 0ULL, TRI_FinalCrc32(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+
+  buffer = " ";
+  BOOST_CHECK_EQUAL((uint64_t) 1925242255ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+  BOOST_CHECK_EQUAL((uint64_t) 1925242255ULL, TRI_FinalCrc32(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+
+  buffer = "a";
+  BOOST_CHECK_EQUAL((uint64_t) 3251651376ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+  BOOST_CHECK_EQUAL((uint64_t) 3251651376ULL, TRI_FinalCrc32(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+
+  buffer = "A";
+  BOOST_CHECK_EQUAL((uint64_t) 3782069742ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+  BOOST_CHECK_EQUAL((uint64_t) 3782069742ULL, TRI_FinalCrc32(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+
+  buffer = "123456789";
+  BOOST_CHECK_EQUAL((uint64_t) 3808858755ULL, TRI_FinalCrc32(TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+  BOOST_CHECK_EQUAL((uint64_t) 3808858755ULL, TRI_FinalCrc32(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str(), strlen(buffer.c_str()))));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test crc32c hardware and software versions produce the same values
+/// for all lengths and alignments
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_crc32c_unaligned) {
+  std::string buffer;
+
+  for (size_t i = 0; i < 512; ++i) {
+    buffer.push_back(static_cast<char>((i * 31) ^ (i >> 3)));
+  }
+
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t length = 0; length < 256; ++length) {
+      BOOST_CHECK_EQUAL(TRI_BlockCrc32CSoftware(TRI_InitialCrc32(), buffer.c_str() + offset, length),
+                        TRI_BlockCrc32C(TRI_InitialCrc32(), buffer.c_str() + offset, length));
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief generate tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -139,4 +139,155 @@ describe ArangoDB do
     end
 
   end
+
+################################################################################
+## streaming cursors
+################################################################################
+
+  context "testing streaming cursors:" do
+    before do
+      @reId = Regexp.new('^\d+$')
+    end
+
+    it "creates a streaming cursor single run" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..5 RETURN i\", \"batchSize\" : 10, \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream-single", cmd, :body => body)
+      
+      doc.code.should eq(201)
+      doc.headers['content-type'].should eq("application/json; charset=utf-8")
+      doc.parsed_response['error'].should eq(false)
+      doc.parsed_response['code'].should eq(201)
+      doc.parsed_response['id'].should be_nil
+      doc.parsed_response['hasMore'].should eq(false)
+      doc.parsed_response['result'].should eq([ 1, 2, 3, 4, 5 ])
+      doc.parsed_response['cached'].should eq(false)
+      doc.parsed_response['extra'].should have_key('stats')
+      doc.parsed_response['extra'].should have_key('warnings')
+    end
+
+    it "creates a streaming cursor" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..5 RETURN i\", \"batchSize\" : 2, \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream", cmd, :body => body)
+      
+      doc.code.should eq(201)
+      doc.parsed_response['error'].should eq(false)
+      doc.parsed_response['id'].should be_kind_of(String)
+      doc.parsed_response['id'].should match(@reId)
+      doc.parsed_response['hasMore'].should eq(true)
+      doc.parsed_response['result'].should eq([ 1, 2 ])
+      doc.parsed_response['count'].should be_nil
+      doc.parsed_response['extra'].should be_nil
+
+      id = doc.parsed_response['id']
+
+      cmd = api + "/#{id}"
+      doc = ArangoDB.log_put("#{prefix}-stream-cont", cmd)
+      
+      doc.code.should eq(200)
+      doc.parsed_response['error'].should eq(false)
+      doc.parsed_response['id'].should eq(id)
+      doc.parsed_response['hasMore'].should eq(true)
+      doc.parsed_response['result'].should eq([ 3, 4 ])
+      doc.parsed_response['extra'].should be_nil
+
+      doc = ArangoDB.log_put("#{prefix}-stream-cont2", cmd)
+      
+      doc.code.should eq(200)
+      doc.parsed_response['error'].should eq(false)
+      doc.parsed_response['id'].should be_nil
+      doc.parsed_response['hasMore'].should eq(false)
+      doc.parsed_response['result'].should eq([ 5 ])
+      doc.parsed_response['extra'].should have_key('stats')
+
+      doc = ArangoDB.log_put("#{prefix}-stream-cont3", cmd)
+      
+      doc.code.should eq(404)
+      doc.parsed_response['error'].should eq(true)
+      doc.parsed_response['errorNum'].should eq(1600)
+    end
+
+    it "creates a streaming cursor and deletes it in the middle" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..100 RETURN i\", \"batchSize\" : 10, \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream-delete", cmd, :body => body)
+      
+      doc.code.should eq(201)
+      doc.parsed_response['hasMore'].should eq(true)
+      doc.parsed_response['result'].length.should eq(10)
+
+      id = doc.parsed_response['id']
+
+      cmd = api + "/#{id}"
+      doc = ArangoDB.log_delete("#{prefix}-stream-delete", cmd)
+
+      doc.code.should eq(202)
+      doc.parsed_response['error'].should eq(false)
+      
+      doc = ArangoDB.log_put("#{prefix}-stream-delete-cont", cmd)
+
+      doc.code.should eq(404)
+      doc.parsed_response['errorNum'].should eq(1600)
+    end
+
+    it "creates a streaming cursor for an invalid query" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..5 RETURN\", \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream-invalid", cmd, :body => body)
+      
+      doc.code.should eq(400)
+      doc.parsed_response['error'].should eq(true)
+      doc.parsed_response['errorNum'].should eq(1501)
+    end
+
+    it "creates a streaming cursor with count" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..5 RETURN i\", \"count\" : true, \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream-count", cmd, :body => body)
+      
+      doc.code.should eq(400)
+      doc.parsed_response['error'].should eq(true)
+      doc.parsed_response['errorNum'].should eq(10)
+    end
+
+    it "creates a streaming cursor for a modification query" do
+      cmd = api
+      body = "{ \"query\" : \"FOR i IN 1..5 INSERT { value: i } INTO UnitTestsCursorStream\", \"options\" : { \"stream\" : true } }"
+      ArangoDB.drop_collection("UnitTestsCursorStream")
+      ArangoDB.create_collection("UnitTestsCursorStream", false)
+      doc = ArangoDB.log_post("#{prefix}-stream-modification", cmd, :body => body)
+      
+      doc.code.should eq(400)
+      doc.parsed_response['error'].should eq(true)
+      doc.parsed_response['errorNum'].should eq(10)
+
+      doc = ArangoDB.log_get("#{prefix}-stream-modification", "/_api/collection/UnitTestsCursorStream/count")
+      doc.parsed_response['count'].should eq(0)
+      ArangoDB.drop_collection("UnitTestsCursorStream")
+    end
+
+    it "keeps a streaming query in the list of running queries" do
+      cmd = api
+      query = "FOR i IN 1..100 RETURN CONCAT('stream-running-', i)"
+      body = "{ \"query\" : \"#{query}\", \"batchSize\" : 10, \"options\" : { \"stream\" : true } }"
+      doc = ArangoDB.log_post("#{prefix}-stream-running", cmd, :body => body)
+      
+      doc.code.should eq(201)
+      doc.parsed_response['hasMore'].should eq(true)
+      id = doc.parsed_response['id']
+
+      doc = ArangoDB.log_get("#{prefix}-stream-running", "/_api/query/current")
+      doc.code.should eq(200)
+      doc.parsed_response.select { |q| q['query'] == query }.length.should eq(1)
+
+      doc = ArangoDB.log_delete("#{prefix}-stream-running", api + "/#{id}")
+      doc.code.should eq(202)
+
+      doc = ArangoDB.log_get("#{prefix}-stream-running", "/_api/query/current")
+      doc.code.should eq(200)
+      doc.parsed_response.select { |q| q['query'] == query }.length.should eq(0)
+    end
+
+  end
 end
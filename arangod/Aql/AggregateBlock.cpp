@@ -28,6 +28,8 @@
 #include "Aql/AggregateBlock.h"
 #include "Aql/AqlItemBlock.h"
 #include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
+#include "Aql/SpillFile.h"
 #include "Basics/Exceptions.h"
 #include "VocBase/vocbase.h"
 
@@ -47,6 +49,7 @@ AggregatorGroup::AggregatorGroup (bool count)
   : firstRow(0),
     lastRow(0),
     groupLength(0),
+    countRegister(ExecutionNode::MaxRegisterId),
     rowsAreValid(false),
     count(count) {
 }
@@ -114,7 +117,15 @@ void AggregatorGroup::addValues (AqlItemBlock const* src,
     TRI_ASSERT(firstRow <= lastRow);
 
     if (count) {
-      groupLength += lastRow + 1 - firstRow;
+      if (countRegister == ExecutionNode::MaxRegisterId) {
+        groupLength += lastRow + 1 - firstRow;
+      }
+      else {
+        // sum up partial group counts
+        for (size_t i = firstRow; i <= lastRow; ++i) {
+          groupLength += static_cast<size_t>(src->getValueReference(i, countRegister).toInt64());
+        }
+      }
     }
     else {
       auto block = src->slice(firstRow, lastRow + 1);
@@ -169,6 +180,12 @@ SortedAggregateBlock::SortedAggregateBlock (ExecutionEngine* engine,
     _groupRegister = (*it).second.registerId;
     TRI_ASSERT(_groupRegister > 0 && _groupRegister < ExecutionNode::MaxRegisterId);
 
+    if (en->_countVariable != nullptr) {
+      auto it = registerPlan.find(en->_countVariable->id);
+      TRI_ASSERT(it != registerPlan.end());
+      _currentGroup.countRegister = (*it).second.registerId;
+    }
+
     if (en->_expressionVariable != nullptr) {
       auto it = registerPlan.find(en->_expressionVariable->id);
       TRI_ASSERT(it != registerPlan.end());
@@ -257,7 +274,7 @@ int SortedAggregateBlock::getOrSkipSome (size_t atLeast,
 
       if (isTotalAggregation && _currentGroup.groupLength == 0) {
         // total aggregation, but have not yet emitted a group
-        res.reset(new AqlItemBlock(1, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+        res.reset(requestBlock(1, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
         emitGroup(nullptr, res.get(), skipped);
         result = res.release();
       }
@@ -271,7 +288,7 @@ int SortedAggregateBlock::getOrSkipSome (size_t atLeast,
   AqlItemBlock* cur = _buffer.front();
 
   if (! skipping) {
-    res.reset(new AqlItemBlock(atMost, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+    res.reset(requestBlock(atMost, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
     TRI_ASSERT(cur->getNrRegs() <= res->getNrRegs());
     inheritRegisters(cur, res.get(), _pos);
@@ -484,7 +501,12 @@ HashedAggregateBlock::HashedAggregateBlock (ExecutionEngine* engine,
                                             AggregateNode const* en)
   : ExecutionBlock(engine, en),
     _aggregateRegisters(),
-    _groupRegister(ExecutionNode::MaxRegisterId) {
+    _groupRegister(ExecutionNode::MaxRegisterId),
+    _countRegister(ExecutionNode::MaxRegisterId),
+    _spillThreshold(engine->getQuery()->spillThreshold()),
+    _partitions(),
+    _nextPartition(0),
+    _inheritBlock(nullptr) {
  
   for (auto const& p : en->_aggregateVariables) {
     // We know that planRegisters() has been run, so
@@ -507,6 +529,12 @@ HashedAggregateBlock::HashedAggregateBlock (ExecutionEngine* engine,
     TRI_ASSERT(it != registerPlan.end());
     _groupRegister = (*it).second.registerId;
     TRI_ASSERT(_groupRegister > 0 && _groupRegister < ExecutionNode::MaxRegisterId);
+
+    if (en->_countVariable != nullptr) {
+      it = registerPlan.find(en->_countVariable->id);
+      TRI_ASSERT(it != registerPlan.end());
+      _countRegister = (*it).second.registerId;
+    }
   }
   else {
     TRI_ASSERT(! static_cast<AggregateNode const*>(_exeNode)->_count);
@@ -516,6 +544,7 @@ HashedAggregateBlock::HashedAggregateBlock (ExecutionEngine* engine,
 }
 
 HashedAggregateBlock::~HashedAggregateBlock () {
+  freePartitions();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -532,6 +561,29 @@ int HashedAggregateBlock::initialize () {
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initializeCursor
+////////////////////////////////////////////////////////////////////////////////
+
+int HashedAggregateBlock::initializeCursor (AqlItemBlock* items, 
+                                            size_t pos) {
+  freePartitions();
+
+  return ExecutionBlock::initializeCursor(items, pos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not there are more groups to return
+////////////////////////////////////////////////////////////////////////////////
+
+bool HashedAggregateBlock::hasMore () {
+  if (! _partitions.empty()) {
+    return (! _done && _nextPartition < _partitions.size());
+  }
+
+  return ExecutionBlock::hasMore();
+}
+
 int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
                                          size_t atMost,
                                          bool skipping,
@@ -544,6 +596,12 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
     return TRI_ERROR_NO_ERROR;
   }
 
+  if (! _partitions.empty()) {
+    // the groups were spilled to disk. return the next partition's groups
+    result = aggregatePartition(skipping, skipped);
+    return TRI_ERROR_NO_ERROR;
+  }
+
   if (_buffer.empty()) {
     if (! ExecutionBlock::getBlock(atLeast, atMost)) {
       // done
@@ -572,7 +630,7 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
     auto planNode = static_cast<AggregateNode const*>(getPlanNode());
     auto nrRegs = planNode->getRegisterPlan()->nrRegs[planNode->getDepth()];
 
-    std::unique_ptr<AqlItemBlock> result(new AqlItemBlock(allGroups.size(), nrRegs));
+    std::unique_ptr<AqlItemBlock> result(requestBlock(allGroups.size(), nrRegs));
     
     if (src != nullptr) {
       inheritRegisters(src, result.get(), 0);
@@ -618,6 +676,20 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
   std::vector<AqlValue> group;
   group.reserve(n);
 
+  // estimated memory used by the groups, only tracked if spilling is enabled
+  size_t memoryUsage = 0;
+
+  auto spillAllGroups = [&] () {
+    for (auto it = allGroups.begin(); it != allGroups.end(); /* no increment */) {
+      spillGroup((*it).first, colls, (*it).second);
+
+      for (auto& key : (*it).first) {
+        const_cast<AqlValue*>(&key)->destroy();
+      }
+      it = allGroups.erase(it);
+    }
+  };
+
   try {
     while (skipped < atMost) {
       groupValues.clear();
@@ -627,23 +699,47 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
         groupValues.emplace_back(cur->getValueReference(_pos, _aggregateRegisters[i].second));
       }
 
-      // now check if we already know this group
-      auto it = allGroups.find(groupValues);
-
-      if (it == allGroups.end()) {
-        // new group
-        group.clear();
+      // the number of rows the input row stands for
+      size_t const rowCount = (_countRegister == ExecutionNode::MaxRegisterId ? 
+                               1 : 
+                               static_cast<size_t>(cur->getValueReference(_pos, _countRegister).toInt64()));
 
-        // copy the group values before they get invalidated
-        for (size_t i = 0; i < n; ++i) {
-          group.emplace_back(cur->getValueReference(_pos, _aggregateRegisters[i].second).clone());
-        }
-
-        allGroups.emplace(group, 1);
+      if (! _partitions.empty()) {
+        // groups have been spilled to disk already. route the row into its partition
+        spillGroup(groupValues, colls, rowCount);
       }
       else {
-        // existing group. simply increase the counter
-        (*it).second++;
+        // now check if we already know this group
+        auto it = allGroups.find(groupValues);
+
+        if (it == allGroups.end()) {
+          // new group
+          group.clear();
+
+          // copy the group values before they get invalidated
+          for (size_t i = 0; i < n; ++i) {
+            group.emplace_back(cur->getValueReference(_pos, _aggregateRegisters[i].second).clone());
+          }
+
+          allGroups.emplace(group, rowCount);
+
+          if (_spillThreshold > 0) {
+            memoryUsage += GroupOverhead;
+            for (auto const& value : group) {
+              memoryUsage += value.memoryUsage();
+            }
+
+            if (memoryUsage > _spillThreshold) {
+              // too many groups. write them to disk and partition all further input
+              createPartitions();
+              spillAllGroups();
+            }
+          }
+        }
+        else {
+          // existing group. simply increase the counter
+          (*it).second += rowCount;
+        }
       }
 
       if (++_pos >= cur->size()) {
@@ -666,6 +762,31 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
               }
             }
 
+            if (! _partitions.empty()) {
+              spillAllGroups();
+
+              // drop partitions that did not receive any groups
+              std::vector<SpillFile*> partitions;
+              for (auto& partition : _partitions) {
+                partition->finish();
+
+                if (partition->numRows() == 0) {
+                  delete partition;
+                }
+                else {
+                  partitions.emplace_back(partition);
+                }
+              }
+              _partitions.swap(partitions);
+              
+              // keep the last input block for register inheritance
+              _inheritBlock = cur;
+              cur = nullptr;
+
+              result = aggregatePartition(skipping, skipped);
+              return TRI_ERROR_NO_ERROR;
+            }
+
             ++skipped;
             result = buildResult(cur);
    
@@ -678,7 +799,9 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
             return TRI_ERROR_NO_ERROR;
           }
           catch (...) {
-            returnBlock(cur);         
+            if (cur != nullptr) {
+              returnBlock(cur);         
+            }
             throw;
           }
         }
@@ -713,6 +836,182 @@ int HashedAggregateBlock::getOrSkipSome (size_t atLeast,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the partition files
+////////////////////////////////////////////////////////////////////////////////
+
+void HashedAggregateBlock::createPartitions () {
+  TRI_ASSERT(_partitions.empty());
+  _partitions.reserve(NumPartitions);
+
+  try {
+    for (size_t i = 0; i < NumPartitions; ++i) {
+      _partitions.emplace_back(new SpillFile(_trx));
+    }
+  }
+  catch (...) {
+    freePartitions();
+    throw;
+  }
+
+  _nextPartition = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes a group key plus its count into the matching partition. the
+/// partition is determined by the group hash, so all rows of a group end up
+/// in the same partition
+////////////////////////////////////////////////////////////////////////////////
+
+void HashedAggregateBlock::spillGroup (std::vector<AqlValue> const& keys,
+                                       std::vector<TRI_document_collection_t const*> const& colls,
+                                       size_t count) {
+  size_t const n = keys.size();
+  uint64_t hash = 0x12345678;
+
+  for (size_t i = 0; i < n; ++i) {
+    hash ^= keys[i].hash(_trx, colls[i]);
+  }
+
+  auto partition = _partitions[hash % _partitions.size()];
+
+  partition->openRow(n + 1);
+  for (size_t i = 0; i < n; ++i) {
+    partition->addValue(keys[i], colls[i]);
+  }
+  // the group count goes into the last slot
+  partition->addNumber(static_cast<double>(count));
+  partition->closeRow();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief aggregates the next partition and returns its groups. partitions
+/// are removed from disk as soon as they have been processed
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* HashedAggregateBlock::aggregatePartition (bool skipping,
+                                                        size_t& skipped) {
+  TRI_ASSERT(_nextPartition < _partitions.size());
+
+  auto partition = _partitions[_nextPartition];
+  size_t const n = _aggregateRegisters.size();
+
+  // values read back from disk do not belong to any collection
+  std::vector<TRI_document_collection_t const*> colls(n, nullptr);
+
+  std::unordered_map<std::vector<AqlValue>, size_t, GroupKeyHash, GroupKeyEqual> groups(
+    1024, 
+    GroupKeyHash(_trx, colls), 
+    GroupKeyEqual(_trx, colls)
+  );
+  
+  std::vector<AqlValue> groupValues;
+  groupValues.reserve(n);
+
+  auto destroyGroups = [&] () {
+    for (auto& it : groups) {
+      for (auto& key : it.first) {
+        const_cast<AqlValue*>(&key)->destroy();
+      }
+    }
+    groups.clear();
+  };
+
+  std::unique_ptr<AqlItemBlock> result;
+
+  try {
+    while (partition->hasRow()) {
+      groupValues.clear();
+
+      for (size_t i = 0; i < n; ++i) {
+        groupValues.emplace_back(partition->copyValue(i));
+      }
+      size_t const count = static_cast<size_t>(partition->value(n).getNumber());
+
+      auto it = groups.find(groupValues);
+
+      if (it == groups.end()) {
+        groups.emplace(groupValues, count);
+      }
+      else {
+        (*it).second += count;
+
+        for (auto& value : groupValues) {
+          value.destroy();
+        }
+      }
+      groupValues.clear();
+
+      partition->nextRow();
+    }
+
+    skipped = groups.size();
+    TRI_ASSERT(skipped > 0);
+
+    if (! skipping) {
+      auto planNode = static_cast<AggregateNode const*>(getPlanNode());
+      auto nrRegs = planNode->getRegisterPlan()->nrRegs[planNode->getDepth()];
+
+      result.reset(requestBlock(groups.size(), nrRegs));
+    
+      if (_inheritBlock != nullptr) {
+        inheritRegisters(_inheritBlock, result.get(), 0);
+      }
+
+      size_t row = 0;
+      for (auto const& it : groups) {
+        size_t i = 0;
+        for (auto& key : it.first) {
+          result->setValue(row, _aggregateRegisters[i++].first, key);
+          const_cast<AqlValue*>(&key)->erase(); // to prevent double-freeing later
+        }
+    
+        if (planNode->_count) {
+          // set group count in result register
+          result->setValue(row, _groupRegister, AqlValue(new Json(static_cast<double>(it.second))));
+        }
+
+        ++row;
+      }
+    }
+  }
+  catch (...) {
+    for (auto& value : groupValues) {
+      value.destroy();
+    }
+    destroyGroups();
+    throw;
+  }
+
+  destroyGroups();
+
+  // the partition is not needed anymore
+  delete partition;
+  _partitions[_nextPartition++] = nullptr;
+
+  if (_nextPartition >= _partitions.size()) {
+    _done = true;
+    freePartitions();
+  }
+
+  return result.release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all partition files
+////////////////////////////////////////////////////////////////////////////////
+
+void HashedAggregateBlock::freePartitions () {
+  for (auto& partition : _partitions) {
+    delete partition;
+  }
+  _partitions.clear();
+  _nextPartition = 0;
+
+  delete _inheritBlock;
+  _inheritBlock = nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief hasher for groups
 ////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +41,7 @@ namespace triagens {
 
     class AqlItemBlock;
     class ExecutionEngine;
+    class SpillFile;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   AggregatorGroup
@@ -58,6 +59,7 @@ namespace triagens {
       size_t firstRow;
       size_t lastRow;
       size_t groupLength;
+      RegisterId countRegister;
       bool rowsAreValid;
       bool const count;
 
@@ -167,6 +169,11 @@ namespace triagens {
 
         int initialize () override;
 
+        int initializeCursor (AqlItemBlock* items, 
+                              size_t pos) override;
+
+        bool hasMore () override;
+
       private:
 
         int getOrSkipSome (size_t atLeast,
@@ -175,8 +182,48 @@ namespace triagens {
                            AqlItemBlock*& result,
                            size_t& skipped) override;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the partition files
+////////////////////////////////////////////////////////////////////////////////
+
+        void createPartitions ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes a group key plus its count into the matching partition
+////////////////////////////////////////////////////////////////////////////////
+
+        void spillGroup (std::vector<AqlValue> const&,
+                         std::vector<TRI_document_collection_t const*> const&,
+                         size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief aggregates the next non-empty partition and returns its groups.
+/// returns a nullptr if all partitions have been processed
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* aggregatePartition (bool,
+                                          size_t&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all partition files
+////////////////////////////////////////////////////////////////////////////////
+
+        void freePartitions ();
+
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of partitions created when the groups are spilled to disk
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const NumPartitions = 32;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimated per-group memory overhead of the hash table
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const GroupOverhead = 64;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief pairs, consisting of out register and in register
 ////////////////////////////////////////////////////////////////////////////////
@@ -190,6 +237,13 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         RegisterId _groupRegister;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input register with partial group counts, MaxRegisterId if the
+/// input rows are counted
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _countRegister;
         
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief hasher for a vector of AQL values
@@ -227,6 +281,32 @@ namespace triagens {
           triagens::arango::AqlTransaction* _trx;
           std::vector<TRI_document_collection_t const*>& _colls;
         };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum memory (in bytes) the groups may use before they are 
+/// spilled to disk. 0 means the groups are never spilled
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t const _spillThreshold;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief partition files, only populated if the groups were spilled
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<SpillFile*> _partitions;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief next partition to aggregate
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _nextPartition;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief last input block, used for inheriting registers into the results
+/// produced from the partitions
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* _inheritBlock;
         
     };
 
@@ -48,7 +48,9 @@ using JsonHelper = triagens::basics::JsonHelper;
 AqlItemBlock::AqlItemBlock (size_t nrItems, 
                             RegisterId nrRegs)
   : _nrItems(nrItems),  
-    _nrRegs(nrRegs) {
+    _nrRegs(nrRegs),
+    _resourceMonitor(nullptr),
+    _trackedMemory(0) {
 
   TRI_ASSERT(nrItems > 0);  // no, empty AqlItemBlocks are not allowed!
 
@@ -70,7 +72,10 @@ AqlItemBlock::AqlItemBlock (size_t nrItems,
 /// @brief create the block from Json, note that this can throw
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlItemBlock::AqlItemBlock (Json const& json) {
+AqlItemBlock::AqlItemBlock (Json const& json) 
+  : _resourceMonitor(nullptr),
+    _trackedMemory(0) {
+
   bool exhausted = JsonHelper::getBooleanValue(json.json(), "exhausted", false);
 
   if (exhausted) {
@@ -181,6 +186,7 @@ AqlItemBlock::AqlItemBlock (Json const& json) {
 
 void AqlItemBlock::destroy () {
   if (_valueCount.empty()) {
+    untrackAllValues();
     return;
   }
 
@@ -211,12 +217,77 @@ void AqlItemBlock::destroy () {
   }
 
   _valueCount.clear();
+  untrackAllValues();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief give an empty block a new shape, reusing its storage
+////////////////////////////////////////////////////////////////////////////////
+
+void AqlItemBlock::rearrange (size_t nrItems, 
+                              RegisterId nrRegs) {
+  TRI_ASSERT(nrItems > 0);
+  TRI_ASSERT(_valueCount.empty());
+  TRI_ASSERT(_data.capacity() >= nrItems * nrRegs);
+
+  // all values are empty here, so this will neither allocate nor change the
+  // memory charged for the block
+  _data.resize(nrItems * nrRegs);
+  _docColls.assign(nrRegs, nullptr);
+
+  _nrItems = nrItems;
+  _nrRegs  = nrRegs;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief attach the block to a resource monitor
+////////////////////////////////////////////////////////////////////////////////
+
+void AqlItemBlock::setResourceMonitor (ResourceMonitor* resourceMonitor) {
+  TRI_ASSERT(_resourceMonitor == nullptr);
+  TRI_ASSERT(_valueCount.empty());
+
+  if (resourceMonitor != nullptr) {
+    resourceMonitor->increaseMemoryUsage(baseMemoryUsage());
+    _resourceMonitor = resourceMonitor;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief detach an empty block from its resource monitor
+////////////////////////////////////////////////////////////////////////////////
+
+void AqlItemBlock::clearResourceMonitor () {
+  TRI_ASSERT(_valueCount.empty());
+
+  if (_resourceMonitor != nullptr) {
+    untrackAllValues();
+    _resourceMonitor->decreaseMemoryUsage(baseMemoryUsage());
+    _resourceMonitor = nullptr;
+  }
 }
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by the block and the values
+/// it is responsible for. values shared by multiple rows are counted once
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlItemBlock::memoryUsage () const {
+  size_t result = sizeof(AqlItemBlock) + 
+                  _data.capacity() * sizeof(AqlValue) +
+                  _docColls.capacity() * sizeof(TRI_document_collection_t const*);
+
+  for (auto const& it : _valueCount) {
+    result += it.first.memoryUsage();
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shrink the block to the specified number of rows
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +317,7 @@ void AqlItemBlock::shrink (size_t nrItems) {
           TRI_ASSERT_EXPENSIVE(it->second > 0);
 
           if (--it->second == 0) {
+            untrackValue(a);
             a.destroy();
             try {
               _valueCount.erase(it);
@@ -280,6 +352,7 @@ void AqlItemBlock::clearRegisters (std::unordered_set<RegisterId> const& toClear
           TRI_ASSERT_EXPENSIVE(it->second > 0);
 
           if (--it->second == 0) {
+            untrackValue(a);
             a.destroy();
             try {
               _valueCount.erase(it);
@@ -307,6 +380,7 @@ AqlItemBlock* AqlItemBlock::slice (size_t from,
   cache.reserve((to - from) * _nrRegs / 4 + 1);
 
   std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(to - from, _nrRegs));
+  res->setResourceMonitor(_resourceMonitor);
 
   for (RegisterId col = 0; col < _nrRegs; col++) {
     res->_docColls[col] = _docColls[col];
@@ -349,6 +423,7 @@ AqlItemBlock* AqlItemBlock::slice (size_t row,
   std::unordered_map<AqlValue, AqlValue> cache;
 
   std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(1, _nrRegs));
+  res->setResourceMonitor(_resourceMonitor);
 
   for (RegisterId col = 0; col < _nrRegs; col++) {
     if (registers.find(col) == registers.end()) {
@@ -396,6 +471,7 @@ AqlItemBlock* AqlItemBlock::slice (std::vector<size_t>& chosen,
   cache.reserve((to - from) * _nrRegs / 4 + 1);
 
   std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(to - from, _nrRegs));
+  res->setResourceMonitor(_resourceMonitor);
 
   for (RegisterId col = 0; col < _nrRegs; col++) {
     res->_docColls[col] = _docColls[col];
@@ -444,6 +520,7 @@ AqlItemBlock* AqlItemBlock::steal (std::vector<size_t>& chosen,
   TRI_ASSERT(from < to && to <= chosen.size());
 
   std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(to - from, _nrRegs));
+  res->setResourceMonitor(_resourceMonitor);
 
   for (RegisterId col = 0; col < _nrRegs; col++) {
     res->_docColls[col] = _docColls[col];
@@ -495,6 +572,7 @@ AqlItemBlock* AqlItemBlock::concatenate (std::vector<AqlItemBlock*> const& block
   TRI_ASSERT(nrRegs > 0);
 
   std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(totalSize, nrRegs));
+  res->setResourceMonitor(blocks[0]->_resourceMonitor);
 
   size_t pos = 0;
   for (it = blocks.begin(); it != blocks.end(); ++it) {
@@ -32,6 +32,7 @@
 #include "Basics/JsonHelper.h"
 #include "Aql/AqlValue.h"
 #include "Aql/Range.h"
+#include "Aql/ResourceUsage.h"
 #include "Aql/types.h"
 
 struct TRI_document_collection_t;
@@ -86,12 +87,96 @@ namespace triagens {
 
         ~AqlItemBlock () {
           destroy();
+
+          if (_resourceMonitor != nullptr) {
+            _resourceMonitor->decreaseMemoryUsage(baseMemoryUsage());
+          }
         }
 
       private:
 
         void destroy ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief give an empty block a new shape, reusing its storage. this is used
+/// for recycling blocks, and the block must have enough capacity already
+////////////////////////////////////////////////////////////////////////////////
+
+        void rearrange (size_t, 
+                        RegisterId);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief attach the block to a resource monitor, charging the memory used
+/// by the block itself. values added later are charged as well
+////////////////////////////////////////////////////////////////////////////////
+
+        void setResourceMonitor (ResourceMonitor*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief detach an empty block from its resource monitor, releasing the
+/// memory charged for the block itself. this is used for blocks that are
+/// kept for recycling
+////////////////////////////////////////////////////////////////////////////////
+
+        void clearResourceMonitor ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory used by the block itself, excluding its values
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t baseMemoryUsage () const {
+          return sizeof(AqlItemBlock) + _data.capacity() * sizeof(AqlValue);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory charged for a value. subquery results are charged via
+/// their own blocks already, so only their container is counted here
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t trackedMemoryUsage (AqlValue const& value) {
+          if (value._type == AqlValue::DOCVEC) {
+            return sizeof(std::vector<AqlItemBlock*>) + 
+                   value._vector->capacity() * sizeof(AqlItemBlock*);
+          }
+          return value.memoryUsage();
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief charge the memory for a value the block becomes responsible for
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void trackValue (AqlValue const& value) {
+          if (_resourceMonitor != nullptr) {
+            size_t const size = trackedMemoryUsage(value);
+            _resourceMonitor->increaseMemoryUsage(size);
+            _trackedMemory += size;
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release the memory for a value the block is not responsible for
+/// anymore. must be called before the value is destroyed
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void untrackValue (AqlValue const& value) {
+          if (_resourceMonitor != nullptr) {
+            size_t const size = (std::min)(trackedMemoryUsage(value), _trackedMemory);
+            _resourceMonitor->decreaseMemoryUsage(size);
+            _trackedMemory -= size;
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release the memory charged for all values
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void untrackAllValues () {
+          if (_resourceMonitor != nullptr) {
+            _resourceMonitor->decreaseMemoryUsage(_trackedMemory);
+            _trackedMemory = 0;
+          }
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
@@ -132,7 +217,14 @@ namespace triagens {
             TRI_IF_FAILURE("AqlItemBlock::setValue") {
               THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
             }
-            _valueCount.emplace(value, 1);
+            trackValue(value);
+            try {
+              _valueCount.emplace(value, 1);
+            }
+            catch (...) {
+              untrackValue(value);
+              throw;
+            }
           }
           else {
             TRI_ASSERT_EXPENSIVE(it->second > 0);
@@ -173,6 +265,7 @@ namespace triagens {
 
             if (it != _valueCount.end()) {
               if (--(it->second) == 0) {
+                untrackValue(element);
                 try {
                   _valueCount.erase(it);
                   element.destroy();
@@ -201,6 +294,7 @@ namespace triagens {
 
             if (it != _valueCount.end()) {
               if (--(it->second) == 0) {
+                untrackValue(element);
                 try {
                   _valueCount.erase(it);
                 }
@@ -226,6 +320,7 @@ namespace triagens {
           }
 
           _valueCount.clear();
+          untrackAllValues();
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -254,6 +349,7 @@ namespace triagens {
             auto it = _valueCount.find(v);
 
             if (it != _valueCount.end()) {
+              untrackValue(v);
               _valueCount.erase(it);
             }
           }
@@ -305,6 +401,13 @@ namespace triagens {
 
         void shrink (size_t nrItems);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by the block and the values
+/// it is responsible for, in bytes
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t memoryUsage () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief clears out some columns (registers), this deletes the values if
 /// necessary, using the reference count.
@@ -404,6 +507,19 @@ namespace triagens {
 
         RegisterId _nrRegs;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the resource monitor the block charges its memory to, may be a
+/// nullptr for blocks that are not tracked
+////////////////////////////////////////////////////////////////////////////////
+
+        ResourceMonitor* _resourceMonitor;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory currently charged for the block's values
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _trackedMemory;
+
     };
 
   }  // namespace triagens::aql
@@ -29,6 +29,7 @@
 
 #include "AqlItemBlockManager.h"
 #include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionStats.h"
 
 using namespace triagens::aql;
 
@@ -40,9 +41,14 @@ using namespace triagens::aql;
 /// @brief create the manager
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlItemBlockManager::AqlItemBlockManager ()
-  : _last(nullptr) {
+AqlItemBlockManager::AqlItemBlockManager (ResourceMonitor* resourceMonitor,
+                                          ExecutionStats* stats)
+  : _resourceMonitor(resourceMonitor),
+    _stats(stats) {
 
+  for (size_t i = 0; i < NumSizeClasses; ++i) {
+    _blocks[i].reserve(MaxBlocksPerSizeClass);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,7 +56,11 @@ AqlItemBlockManager::AqlItemBlockManager ()
 ////////////////////////////////////////////////////////////////////////////////
 
 AqlItemBlockManager::~AqlItemBlockManager () {
-  delete _last;
+  for (size_t i = 0; i < NumSizeClasses; ++i) {
+    for (auto& it : _blocks[i]) {
+      delete it;
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -63,18 +73,54 @@ AqlItemBlockManager::~AqlItemBlockManager () {
 
 AqlItemBlock* AqlItemBlockManager::requestBlock (size_t nrItems, 
                                                  RegisterId nrRegs) {
-  if (_last != nullptr &&
-      _last->size() == nrItems &&
-      _last->getNrRegs() == nrRegs) {
-    auto block = _last;
-    // don't hand out the same block next time
-    _last = nullptr;
-    block->eraseAll();
-
-    return block;
+  if (_stats != nullptr) {
+    ++_stats->itemBlocksRequested;
+  }
+
+  size_t const numValues = nrItems * nrRegs;
+  size_t const sizeClass = sizeClassForCapacity(numValues);
+  // a block taken from the pool is owned here until it is handed out
+  std::unique_ptr<AqlItemBlock> block;
+
+  if (sizeClass < NumSizeClasses) {
+    // blocks in the same size class may or may not be big enough. blocks
+    // returned with the same shape are, so this is the common case
+    auto& blocks = _blocks[sizeClass];
+
+    for (size_t i = blocks.size(); i > 0; --i) {
+      if (blocks[i - 1]->_data.capacity() >= numValues) {
+        block.reset(blocks[i - 1]);
+        blocks.erase(blocks.begin() + (i - 1));
+        break;
+      }
+    }
+
+    if (block == nullptr &&
+        sizeClass + 1 < NumSizeClasses &&
+        ! _blocks[sizeClass + 1].empty()) {
+      // all blocks in the next size class are big enough
+      block.reset(_blocks[sizeClass + 1].back());
+      _blocks[sizeClass + 1].pop_back();
+    }
+  }
+
+  if (block != nullptr) {
+    // recycle a block that was handed back earlier. pooled blocks are not
+    // charged to the query, so charge the block again
+    block->rearrange(nrItems, nrRegs);
+    block->setResourceMonitor(_resourceMonitor);
+
+    if (_stats != nullptr) {
+      ++_stats->itemBlocksRecycled;
+    }
+
+    return block.release();
   }
 
-  return new AqlItemBlock(nrItems, nrRegs);
+  std::unique_ptr<AqlItemBlock> created(new AqlItemBlock(nrItems, nrRegs));
+  created->setResourceMonitor(_resourceMonitor);
+
+  return created.release();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -84,12 +130,45 @@ AqlItemBlock* AqlItemBlockManager::requestBlock (size_t nrItems,
 void AqlItemBlockManager::returnBlock (AqlItemBlock*& block) {
   TRI_ASSERT(block != nullptr);
   block->destroy();
+  // values stolen from the block are not cleared by destroy()
+  block->eraseAll();
+
+  size_t const sizeClass = sizeClassForCapacity(block->_data.capacity());
+
+  if (sizeClass < NumSizeClasses &&
+      _blocks[sizeClass].size() < MaxBlocksPerSizeClass) {
+    // idle blocks are not charged to the query
+    block->clearResourceMonitor();
+    // capacity was reserved in the constructor, so this will not throw
+    _blocks[sizeClass].emplace_back(block);
+  }
+  else {
+    delete block;
+  }
 
-  delete _last;
-  _last = block;
   block = nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the size class a block with the specified capacity is stored in
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlItemBlockManager::sizeClassForCapacity (size_t capacity) {
+  // 1 + floor(log2(capacity))
+  size_t sizeClass = 0;
+
+  while (capacity > 0) {
+    ++sizeClass;
+    capacity >>= 1;
+  }
+
+  return sizeClass;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
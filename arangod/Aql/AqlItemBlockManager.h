@@ -37,6 +37,8 @@ namespace triagens {
   namespace aql {
 
     class AqlItemBlock;
+    class ResourceMonitor;
+    struct ExecutionStats;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                         class AqlItemBlockManager
@@ -51,10 +53,13 @@ namespace triagens {
       public:
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief create the manager
+/// @brief create the manager. all blocks handed out by the manager charge
+/// their memory to the resource monitor. the number of requested and recycled
+/// blocks is counted in the statistics, if specified
 ////////////////////////////////////////////////////////////////////////////////
 
-        AqlItemBlockManager ();
+        AqlItemBlockManager (ResourceMonitor*,
+                             ExecutionStats*);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the manager
@@ -81,6 +86,20 @@ namespace triagens {
 
         void returnBlock (AqlItemBlock*&);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the size class a block with the specified capacity is stored in.
+/// all blocks in size class n > 0 have a capacity between 2^(n - 1) and
+/// 2^n - 1
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t sizeClassForCapacity (size_t);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -88,11 +107,38 @@ namespace triagens {
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief last block handed back to the manager
-/// this is the block that may be recycled
+/// @brief the resource monitor for the blocks, may be a nullptr
+////////////////////////////////////////////////////////////////////////////////
+
+        ResourceMonitor* _resourceMonitor;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the statistics to report requested and recycled blocks to, may be
+/// a nullptr
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionStats* _stats;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of size classes. blocks bigger than the biggest size class
+/// are not recycled
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const NumSizeClasses = 18;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of blocks kept per size class
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxBlocksPerSizeClass = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief blocks handed back to the manager, by size class of their capacity
+/// (number of items times number of registers). these blocks are empty and
+/// may be recycled
 ////////////////////////////////////////////////////////////////////////////////
 
-        AqlItemBlock* _last;
+        std::vector<AqlItemBlock*> _blocks[NumSizeClasses];
 
     };
 
@@ -37,6 +37,99 @@ using namespace triagens::aql;
 using Json = triagens::basics::Json;
 using JsonHelper = triagens::basics::JsonHelper;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts a compact value into a V8 object, without creating an
+/// intermediate TRI_json_t
+////////////////////////////////////////////////////////////////////////////////
+
+static v8::Handle<v8::Value> CompactToV8 (v8::Isolate* isolate,
+                                          CompactValue const& value) {
+  switch (value.type()) {
+    case CompactValue::TYPE_NULL: {
+      return v8::Null(isolate);
+    }
+
+    case CompactValue::TYPE_FALSE:
+    case CompactValue::TYPE_TRUE: {
+      return v8::Boolean::New(isolate, value.getBoolean());
+    }
+
+    case CompactValue::TYPE_SMALLINT:
+    case CompactValue::TYPE_NUMBER: {
+      return v8::Number::New(isolate, value.getNumber());
+    }
+
+    case CompactValue::TYPE_SHORT_STRING:
+    case CompactValue::TYPE_STRING: {
+      size_t length;
+      char const* p = value.getString(length);
+      return TRI_V8_PAIR_STRING(p, length);
+    }
+
+    case CompactValue::TYPE_ARRAY: {
+      uint32_t const n = static_cast<uint32_t>(value.length());
+      v8::Handle<v8::Array> result = v8::Array::New(isolate, static_cast<int>(n));
+
+      for (uint32_t i = 0; i < n; ++i) {
+        result->Set(i, CompactToV8(isolate, value.at(i)));
+      }
+      return result;
+    }
+
+    case CompactValue::TYPE_OBJECT: {
+      size_t const n = value.length();
+      v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+      for (size_t i = 0; i < n; ++i) {
+        CompactValue key = value.keyAt(i);
+        size_t length;
+        char const* p = key.getString(length);
+        result->ForceSet(TRI_V8_PAIR_STRING(p, length), CompactToV8(isolate, CompactValue(key.data() + key.byteSize())));
+      }
+      return result;
+    }
+  }
+
+  return v8::Undefined(isolate);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimates the memory used by a TRI_json_t tree, excluding the
+/// top-level struct itself
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t JsonMemoryUsage (TRI_json_t const* json) {
+  switch (json->_type) {
+    case TRI_JSON_STRING: {
+      return json->_value._string.length;
+    }
+
+    case TRI_JSON_ARRAY:
+    case TRI_JSON_OBJECT: {
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+      size_t result = n * sizeof(TRI_json_t);
+
+      for (size_t i = 0; i < n; ++i) {
+        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+        result += JsonMemoryUsage(sub);
+      }
+      return result;
+    }
+
+    default: {
+      return 0;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   struct AqlValue
+// -----------------------------------------------------------------------------
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief a quick method to decide whether a value is true
 ////////////////////////////////////////////////////////////////////////////////
@@ -58,6 +151,21 @@ bool AqlValue::isTrue () const {
       return true;
     }
   }
+  else if (_type == COMPACT) {
+    CompactValue value(_compact);
+    if (value.isBoolean()) {
+      return value.getBoolean();
+    }
+    else if (value.isNumber()) {
+      return value.getNumber() != 0.0;
+    }
+    else if (value.isString()) {
+      size_t length;
+      value.getString(length);
+      return length > 0;
+    }
+    return (value.isArray() || value.isObject());
+  }
   else if (_type == RANGE || _type == DOCVEC) {
     // a range or a docvec is equivalent to an array
     return true;
@@ -95,6 +203,11 @@ void AqlValue::destroy () {
       _range = nullptr;
       break;
     }
+    case COMPACT: {
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, _compact);
+      _compact = nullptr;
+      break;
+    }
     case SHAPED: {
       // do nothing here, since data pointers need not be freed
       break;
@@ -123,6 +236,8 @@ std::string AqlValue::getTypeString () const {
       return "docvec";
     case RANGE: 
       return "range";
+    case COMPACT: 
+      return "compact";
     case EMPTY: 
       return "empty";
   }
@@ -166,6 +281,10 @@ AqlValue AqlValue::clone () const {
       return AqlValue(_range->_low, _range->_high);
     }
 
+    case COMPACT: {
+      return AqlValue(CompactValue(_compact).copy());
+    }
+
     case EMPTY: {
       return AqlValue();
     }
@@ -198,6 +317,10 @@ bool AqlValue::isString () const {
       return TRI_IsStringJson(json);
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isString();
+    }
+
     case SHAPED: 
     case DOCVEC: 
     case RANGE: 
@@ -221,6 +344,10 @@ bool AqlValue::isNumber () const {
       return TRI_IsNumberJson(json);
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isNumber();
+    }
+
     case SHAPED: 
     case DOCVEC: 
     case RANGE: 
@@ -244,6 +371,10 @@ bool AqlValue::isBoolean () const {
       return TRI_IsBooleanJson(json);
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isBoolean();
+    }
+
     case SHAPED: 
     case DOCVEC: 
     case RANGE: 
@@ -266,6 +397,10 @@ bool AqlValue::isArray () const {
       return TRI_IsArrayJson(json);
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isArray();
+    }
+
     case SHAPED: {
       return false;
     }
@@ -294,6 +429,10 @@ bool AqlValue::isObject () const {
       return TRI_IsObjectJson(json);
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isObject();
+    }
+
     case SHAPED: {
       return true;
     }
@@ -319,6 +458,10 @@ bool AqlValue::isNull (bool emptyIsNull) const {
       return json == nullptr || json->_type == TRI_JSON_NULL;
     }
 
+    case COMPACT: {
+      return CompactValue(_compact).isNull();
+    }
+
     case SHAPED: {
       return false;
     }
@@ -376,6 +519,19 @@ triagens::basics::Json AqlValue::at (triagens::arango::AqlTransaction* trx,
       TRI_ASSERT(_range != nullptr);
       return triagens::basics::Json(static_cast<double>(_range->at(i)));
     }
+
+    case COMPACT: {
+      CompactValue value(_compact);
+      if (value.isArray() && i < value.length()) {
+        TRI_json_t* json = value.at(i).toJson(TRI_UNKNOWN_MEM_ZONE);
+
+        if (json == nullptr) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+        return triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, json);
+      }
+      break; // fall-through to exception
+    }
        
     case SHAPED: 
     case EMPTY: {
@@ -414,6 +570,14 @@ size_t AqlValue::arraySize () const {
       TRI_ASSERT(_range != nullptr);
       return _range->size();
     }
+
+    case COMPACT: {
+      CompactValue value(_compact);
+      if (value.isArray()) {
+        return value.length();
+      }
+      return 0;
+    }
        
     case SHAPED: 
     case EMPTY: {
@@ -431,6 +595,20 @@ int64_t AqlValue::toInt64 () const {
   switch (_type) {
     case JSON: 
       return TRI_ToInt64Json(_json->json());
+    case COMPACT: {
+      CompactValue value(_compact);
+      if (value.isNumber()) {
+        return static_cast<int64_t>(value.getNumber());
+      }
+      if (value.isBoolean()) {
+        return value.getBoolean() ? 1 : 0;
+      }
+      if (value.isNull() || value.isString()) {
+        // use the same conversion as for JSON values
+        return TRI_ToInt64Json(toJson(nullptr, nullptr, false).json());
+      }
+      return 0;
+    }
     case RANGE: {
       size_t rangeSize = _range->size();
       if (rangeSize == 1) {  
@@ -456,6 +634,20 @@ double AqlValue::toNumber () const {
   switch (_type) {
     case JSON: 
       return TRI_ToDoubleJson(_json->json());
+    case COMPACT: {
+      CompactValue value(_compact);
+      if (value.isNumber()) {
+        return value.getNumber();
+      }
+      if (value.isBoolean()) {
+        return value.getBoolean() ? 1.0 : 0.0;
+      }
+      if (value.isNull() || value.isString()) {
+        // use the same conversion as for JSON values
+        return TRI_ToDoubleJson(toJson(nullptr, nullptr, false).json());
+      }
+      return 0.0;
+    }
     case RANGE: {
       size_t rangeSize = _range->size();
       if (rangeSize == 1) {  
@@ -485,6 +677,13 @@ std::string AqlValue::toString () const {
       return std::string(json->_value._string.data, json->_value._string.length - 1);
     }
 
+    case COMPACT: {
+      size_t length;
+      char const* p = CompactValue(_compact).getString(length);
+      TRI_ASSERT(p != nullptr);
+      return std::string(p, length);
+    }
+
     case SHAPED: 
     case DOCVEC: 
     case RANGE: 
@@ -508,6 +707,14 @@ char const* AqlValue::toChar () const {
       return json->_value._string.data;
     }
 
+    case COMPACT: {
+      // compact strings are NUL-terminated
+      size_t length;
+      char const* p = CompactValue(_compact).getString(length);
+      TRI_ASSERT(p != nullptr);
+      return p;
+    }
+
     case SHAPED: 
     case DOCVEC: 
     case RANGE: 
@@ -592,6 +799,11 @@ v8::Handle<v8::Value> AqlValue::toV8 (v8::Isolate* isolate,
       return TRI_ObjectJson(isolate, _json->json());
     }
 
+    case COMPACT: {
+      TRI_ASSERT(_compact != nullptr);
+      return CompactToV8(isolate, CompactValue(_compact));
+    }
+
     case SHAPED: {
       TRI_ASSERT(document != nullptr);
       TRI_ASSERT(_marker != nullptr);
@@ -661,6 +873,16 @@ Json AqlValue::toJson (triagens::arango::AqlTransaction* trx,
       return Json(_json->zone(), _json->json(), Json::NOFREE);
     }
 
+    case COMPACT: {
+      // compact values are always materialized, regardless of copy
+      TRI_json_t* json = CompactValue(_compact).toJson(TRI_UNKNOWN_MEM_ZONE);
+
+      if (json == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+      return Json(TRI_UNKNOWN_MEM_ZONE, json);
+    }
+
     case SHAPED: {
       TRI_ASSERT(document != nullptr);
       TRI_ASSERT(_marker != nullptr);
@@ -745,6 +967,113 @@ Json AqlValue::toJson (triagens::arango::AqlTransaction* trx,
   THROW_ARANGO_EXCEPTION(TRI_ERROR_INTERNAL);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append the value to a compact builder
+////////////////////////////////////////////////////////////////////////////////
+
+void AqlValue::toCompact (triagens::arango::AqlTransaction* trx,
+                          TRI_document_collection_t const* document,
+                          CompactBuilder& builder) const {
+  switch (_type) {
+    case JSON: {
+      builder.addJson(_json->json());
+      return;
+    }
+
+    case COMPACT: {
+      builder.addValue(CompactValue(_compact));
+      return;
+    }
+
+    case RANGE: {
+      TRI_ASSERT(_range != nullptr);
+
+      size_t const n = _range->size();
+      builder.openArray(n);
+      for (size_t i = 0; i < n; ++i) {
+        builder.addNumber(static_cast<double>(_range->at(i)));
+      }
+      builder.closeArray();
+      return;
+    }
+
+    case DOCVEC: {
+      TRI_ASSERT(_vector != nullptr);
+
+      builder.openArray(arraySize());
+      for (auto it = _vector->begin(); it != _vector->end(); ++it) {
+        auto current = (*it);
+        size_t const n = current->size();
+        auto vecCollection = current->getDocumentCollection(0);
+        for (size_t i = 0; i < n; ++i) {
+          current->getValueReference(i, 0).toCompact(trx, vecCollection, builder);
+        }
+      }
+      builder.closeArray();
+      return;
+    }
+
+    case SHAPED: {
+      Json json(toJson(trx, document, false));
+      builder.addJson(json.json());
+      return;
+    }
+
+    case EMPTY: {
+      builder.addNull();
+      return;
+    }
+  }
+
+  THROW_ARANGO_EXCEPTION(TRI_ERROR_INTERNAL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by a JSON value
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlValue::jsonMemoryUsage (TRI_json_t const* json) {
+  return sizeof(TRI_json_t) + JsonMemoryUsage(json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by the value
+////////////////////////////////////////////////////////////////////////////////
+
+size_t AqlValue::memoryUsage () const {
+  switch (_type) {
+    case JSON: {
+      TRI_ASSERT(_json != nullptr);
+      return sizeof(Json) + jsonMemoryUsage(_json->json());
+    }
+
+    case COMPACT: {
+      return CompactValue(_compact).byteSize();
+    }
+
+    case RANGE: {
+      return sizeof(Range);
+    }
+
+    case DOCVEC: {
+      TRI_ASSERT(_vector != nullptr);
+      size_t result = sizeof(std::vector<AqlItemBlock*>);
+      for (auto const& it : *_vector) {
+        result += it->memoryUsage();
+      }
+      return result;
+    }
+
+    case SHAPED:
+    case EMPTY: {
+      // shaped values point into the datafiles
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief hashes the JSON contents
 ////////////////////////////////////////////////////////////////////////////////
@@ -756,6 +1085,11 @@ uint64_t AqlValue::hash (triagens::arango::AqlTransaction* trx,
       return TRI_FastHashJson(_json->json());
     }
 
+    case COMPACT: {
+      // produces the same hash values as TRI_FastHashJson
+      return CompactValue(_compact).hash();
+    }
+
     case SHAPED: {
       TRI_ASSERT(document != nullptr);
       TRI_ASSERT(_marker != nullptr);
@@ -873,6 +1207,22 @@ Json AqlValue::extractObjectMember (triagens::arango::AqlTransaction* trx,
       return Json(Json::Null);
     }
 
+    case COMPACT: {
+      TRI_ASSERT(_compact != nullptr);
+      CompactValue found;
+
+      if (CompactValue(_compact).get(name, strlen(name), found)) {
+        // the value is always materialized, regardless of copy
+        TRI_json_t* json = found.toJson(TRI_UNKNOWN_MEM_ZONE);
+
+        if (json == nullptr) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+        return Json(TRI_UNKNOWN_MEM_ZONE, json);
+      }
+      break;
+    }
+
     case SHAPED: {
       TRI_ASSERT(document != nullptr);
       TRI_ASSERT(_marker != nullptr);
@@ -997,6 +1347,30 @@ Json AqlValue::extractArrayMember (triagens::arango::AqlTransaction* trx,
       return Json(Json::Null);
     }
 
+    case COMPACT: {
+      TRI_ASSERT(_compact != nullptr);
+      CompactValue value(_compact);
+
+      if (value.isArray()) {
+        size_t const length = value.length();
+        if (position < 0) {
+          // a negative position is allowed
+          position = static_cast<int64_t>(length) + position; 
+        }
+        
+        if (position >= 0 && position < static_cast<int64_t>(length)) {
+          // the value is always materialized, regardless of copy
+          TRI_json_t* json = value.at(static_cast<size_t>(position)).toJson(TRI_UNKNOWN_MEM_ZONE);
+
+          if (json == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+          return Json(TRI_UNKNOWN_MEM_ZONE, json);
+        }
+      }
+      break; // fall-through to returning null 
+    }
+
     case RANGE: {
       TRI_ASSERT(_range != nullptr);
       size_t const n = _range->size();
@@ -1127,6 +1501,22 @@ int AqlValue::Compare (triagens::arango::AqlTransaction* trx,
       return 1;
     }
 
+    // COMPACT against JSON and vice versa, without materializing
+    if (left._type == AqlValue::COMPACT && right._type == AqlValue::JSON) {
+      return CompactValue::Compare(CompactValue(left._compact), right._json->json(), compareUtf8);
+    }
+
+    if (left._type == AqlValue::JSON && right._type == AqlValue::COMPACT) {
+      return - CompactValue::Compare(CompactValue(right._compact), left._json->json(), compareUtf8);
+    }
+
+    // COMPACT against x or x against COMPACT
+    if (left._type == AqlValue::COMPACT || right._type == AqlValue::COMPACT) {
+      triagens::basics::Json ljson = left.toJson(trx, leftcoll, false);
+      triagens::basics::Json rjson = right.toJson(trx, rightcoll, false);
+      return TRI_CompareValuesJson(ljson.json(), rjson.json(), compareUtf8);
+    }
+
     // JSON against x
     if (left._type == AqlValue::JSON && 
         (right._type == AqlValue::SHAPED ||
@@ -1193,6 +1583,10 @@ int AqlValue::Compare (triagens::arango::AqlTransaction* trx,
       return TRI_CompareValuesJson(left._json->json(), right._json->json(), compareUtf8);
     }
 
+    case AqlValue::COMPACT: {
+      return CompactValue::Compare(CompactValue(left._compact), CompactValue(right._compact), compareUtf8);
+    }
+
     case AqlValue::SHAPED: {
       TRI_shaped_json_t l;
       TRI_shaped_json_t r;
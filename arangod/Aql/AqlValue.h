@@ -29,6 +29,7 @@
 #define ARANGODB_AQL_AQL_VALUE_H 1
 
 #include "Basics/Common.h"
+#include "Aql/CompactValue.h"
 #include "Aql/Range.h"
 #include "Aql/types.h"
 #include "Basics/JsonHelper.h"
@@ -66,7 +67,8 @@ namespace triagens {
         JSON,      // Json*
         SHAPED,    // TRI_df_marker_t*
         DOCVEC,    // a vector of blocks of results coming from a subquery
-        RANGE      // a pointer to a range remembering lower and upper bound
+        RANGE,     // a pointer to a range remembering lower and upper bound
+        COMPACT    // char*, a value in compact binary representation
       };
 
 // -----------------------------------------------------------------------------
@@ -104,6 +106,11 @@ namespace triagens {
         _range = new Range(low, high);
       }
 
+      explicit AqlValue (char* compact)
+        : _compact(compact),
+          _type(COMPACT) {
+      }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destructor, doing nothing automatically!
 ////////////////////////////////////////////////////////////////////////////////
@@ -163,6 +170,14 @@ namespace triagens {
       inline bool isRange () const throw() {
         return _type == RANGE;
       }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the AqlValue is a COMPACT value
+////////////////////////////////////////////////////////////////////////////////
+
+      inline bool isCompact () const throw() {
+        return _type == COMPACT;
+      }
       
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the shape marker
@@ -182,6 +197,15 @@ namespace triagens {
         return _range;
       }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a view on the compact value
+////////////////////////////////////////////////////////////////////////////////
+
+      inline CompactValue getCompact () const {
+        TRI_ASSERT(isCompact());
+        return CompactValue(_compact);
+      }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief a quick method to decide whether a value is true
 ////////////////////////////////////////////////////////////////////////////////
@@ -324,6 +348,15 @@ namespace triagens {
                                      TRI_document_collection_t const*,
                                      bool) const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append the value to a compact builder, without converting it to
+/// JSON first if possible
+////////////////////////////////////////////////////////////////////////////////
+
+      void toCompact (triagens::arango::AqlTransaction*,
+                      TRI_document_collection_t const*,
+                      CompactBuilder&) const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates a hash value for the AqlValue
 ////////////////////////////////////////////////////////////////////////////////
@@ -331,6 +364,21 @@ namespace triagens {
       uint64_t hash (triagens::arango::AqlTransaction*,
                      TRI_document_collection_t const*) const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by the value, in bytes, 
+/// not including the AqlValue struct itself. SHAPED values point into the
+/// datafiles and are not counted
+////////////////////////////////////////////////////////////////////////////////
+
+      size_t memoryUsage () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns an estimate of the memory used by a JSON value, in bytes,
+/// including its top-level struct
+////////////////////////////////////////////////////////////////////////////////
+
+      static size_t jsonMemoryUsage (TRI_json_t const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief extract an attribute value from the AqlValue 
 /// this will return null if the value is not an object
@@ -395,6 +443,7 @@ namespace triagens {
         TRI_df_marker_t const*      _marker;
         std::vector<AqlItemBlock*>* _vector;
         Range const*                _range;
+        char*                       _compact;
       };
       
 ////////////////////////////////////////////////////////////////////////////////
@@ -436,6 +485,9 @@ namespace std {
         case triagens::aql::AqlValue::RANGE: {
           return res ^ ptrHash(x._range);
         }
+        case triagens::aql::AqlValue::COMPACT: {
+          return res ^ ptrHash(x._compact);
+        }
         case triagens::aql::AqlValue::EMPTY: {
           return res;
         }
@@ -465,6 +517,9 @@ namespace std {
         case triagens::aql::AqlValue::RANGE: {
           return a._range == b._range;
         }
+        case triagens::aql::AqlValue::COMPACT: {
+          return a._compact == b._compact;
+        }
         // case triagens::aql::AqlValue::EMPTY intentionally not handled here!
         // (should fall through and fail!)
 
@@ -1134,13 +1134,105 @@ AstNode* Ast::createNodeNop () {
   return const_cast<AstNode*>(&NopNode);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determines the bind parameters that can be kept symbolic in the
+/// execution plan
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_set<std::string> Ast::symbolicBindParameters () const {
+  std::unordered_set<std::string> all;
+  std::unordered_set<std::string> structural;
+
+  std::function<void(AstNode const*, bool)> visit = [&](AstNode const* node, bool isStructural) -> void {
+    if (node == nullptr) {
+      return;
+    }
+
+    if (node->type == NODE_TYPE_PARAMETER) {
+      std::string const name(node->getStringValue(), node->getStringLength());
+
+      if (isStructural || name.empty() || name[0] == '@') {
+        // collection parameters are always structural
+        structural.emplace(name);
+      }
+      all.emplace(name);
+      return;
+    }
+
+    bool const hasOptions = (node->type == NODE_TYPE_REMOVE ||
+                             node->type == NODE_TYPE_INSERT ||
+                             node->type == NODE_TYPE_UPDATE ||
+                             node->type == NODE_TYPE_REPLACE ||
+                             node->type == NODE_TYPE_UPSERT ||
+                             node->type == NODE_TYPE_COLLECT ||
+                             node->type == NODE_TYPE_COLLECT_COUNT ||
+                             node->type == NODE_TYPE_COLLECT_EXPRESSION);
+
+    size_t const n = node->numMembers();
+
+    for (size_t i = 0; i < n; ++i) {
+      bool memberIsStructural = isStructural;
+
+      if (node->type == NODE_TYPE_LIMIT ||
+          node->type == NODE_TYPE_EXAMPLE) {
+        // LIMIT values and examples are evaluated when the plan is built
+        memberIsStructural = true;
+      }
+      else if (i == 0 && hasOptions) {
+        // query options
+        memberIsStructural = true;
+      }
+      else if (i == 1 && 
+               (node->type == NODE_TYPE_SORT_ELEMENT ||
+                node->type == NODE_TYPE_BOUND_ATTRIBUTE_ACCESS)) {
+        // sort direction or attribute name
+        memberIsStructural = true;
+      }
+
+      visit(node->getMember(i), memberIsStructural);
+    }
+  };
+
+  visit(_root, false);
+
+  for (auto const& it : structural) {
+    all.erase(it);
+  }
+
+  return all;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief injects bind parameters into the AST
 ////////////////////////////////////////////////////////////////////////////////
 
-void Ast::injectBindParameters (BindParameters& parameters) {
+void Ast::injectBindParameters (BindParameters& parameters,
+                                std::unordered_set<std::string> const* symbolic) {
   auto p = parameters();
 
+  _root = injectBindParameters(_root, p, symbolic);
+ 
+  // add all collections used in data-modification statements
+  for (auto& it : _writeCollections) { 
+    if (it->type == NODE_TYPE_COLLECTION) {
+      _query->collections()->add(it->getStringValue(), TRI_TRANSACTION_WRITE);
+    }
+  }
+
+  for (auto it = p.begin(); it != p.end(); ++it) {
+    if (! (*it).second.second) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_BIND_PARAMETER_UNDECLARED, (*it).first.c_str());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief injects bind parameters into the AST or a part of it
+////////////////////////////////////////////////////////////////////////////////
+
+AstNode* Ast::injectBindParameters (AstNode* root,
+                                    BindParametersType& p,
+                                    std::unordered_set<std::string> const* symbolic) {
   auto func = [&](AstNode* node, void*) -> AstNode* {
     if (node->type == NODE_TYPE_PARAMETER) {
       // found a bind parameter in the query string
@@ -1162,6 +1254,12 @@ void Ast::injectBindParameters (BindParameters& parameters) {
       // mark the bind parameter as being used
       (*it).second.second = true;
 
+      if (symbolic != nullptr && 
+          symbolic->find((*it).first) != symbolic->end()) {
+        // the parameter value will be injected into the execution plan later
+        return node;
+      }
+
       auto value = (*it).second.first;
 
       if (*param == '@') {
@@ -1234,20 +1332,7 @@ void Ast::injectBindParameters (BindParameters& parameters) {
     return node;
   };
 
-  _root = traverseAndModify(_root, func, &p); 
- 
-  // add all collections used in data-modification statements
-  for (auto& it : _writeCollections) { 
-    if (it->type == NODE_TYPE_COLLECTION) {
-      _query->collections()->add(it->getStringValue(), TRI_TRANSACTION_WRITE);
-    }
-  }
-
-  for (auto it = p.begin(); it != p.end(); ++it) {
-    if (! (*it).second.second) {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_BIND_PARAMETER_UNDECLARED, (*it).first.c_str());
-    }
-  }
+  return traverseAndModify(root, func, &p); 
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1317,6 +1402,14 @@ AstNode* Ast::replaceVariableReference (AstNode* node,
 ////////////////////////////////////////////////////////////////////////////////
 
 void Ast::validateAndOptimize () {
+  _root = validateAndOptimize(_root);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief optimizes a part of the AST, e.g. a single expression
+////////////////////////////////////////////////////////////////////////////////
+
+AstNode* Ast::validateAndOptimize (AstNode* root) {
   struct TraversalContext {
     int64_t stopOptimizationRequests = 0;
     bool isInFilter       = false;
@@ -1477,7 +1570,7 @@ void Ast::validateAndOptimize () {
 
   // run the optimizations
   TraversalContext context;
-  this->_root = traverseAndModify(this->_root, preVisitor, visitor, postVisitor, &context);
+  return traverseAndModify(root, preVisitor, visitor, postVisitor, &context);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -585,11 +585,32 @@ namespace triagens {
 
         AstNode* createNodeNop ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node from JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        AstNode* nodeFromJson (TRI_json_t const*,
+                               bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determines the bind parameters that can be kept symbolic in the
+/// execution plan. these are value parameters that are only used in
+/// expressions. parameters that determine the structure of the plan, such as
+/// collection names, LIMIT values, SORT directions, attribute names and
+/// query options, are not returned
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_set<std::string> symbolicBindParameters () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief injects bind parameters into the AST
+/// the parameters contained in the optional set are marked as used but are
+/// left in the AST. their values must be injected into the execution plan
+/// later
 ////////////////////////////////////////////////////////////////////////////////
 
-        void injectBindParameters (BindParameters&);
+        void injectBindParameters (BindParameters&,
+                                   std::unordered_set<std::string> const* = nullptr);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables
@@ -614,6 +635,12 @@ namespace triagens {
 
         void validateAndOptimize ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief optimizes a part of the AST, e.g. a single expression
+////////////////////////////////////////////////////////////////////////////////
+
+        AstNode* validateAndOptimize (AstNode*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief determines the variables referenced in an expression
 ////////////////////////////////////////////////////////////////////////////////
@@ -646,6 +673,14 @@ namespace triagens {
 
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief injects bind parameters into the AST or a part of it
+////////////////////////////////////////////////////////////////////////////////
+
+        AstNode* injectBindParameters (AstNode*,
+                                       BindParametersType&,
+                                       std::unordered_set<std::string> const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief make condition from example
 ////////////////////////////////////////////////////////////////////////////////
@@ -752,13 +787,6 @@ namespace triagens {
 
         AstNode* optimizeFor (AstNode*);
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief create an AST node from JSON
-////////////////////////////////////////////////////////////////////////////////
-
-        AstNode* nodeFromJson (TRI_json_t const*,
-                               bool);
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief traverse the AST, using pre- and post-order visitors
 ////////////////////////////////////////////////////////////////////////////////
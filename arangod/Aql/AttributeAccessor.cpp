@@ -33,12 +33,20 @@
 #include "Basics/StringBuffer.h"
 #include "Basics/json.h"
 #include "VocBase/document-collection.h"
+#include "VocBase/shape-accessor.h"
 #include "VocBase/shaped-json.h"
 #include "VocBase/VocShaper.h"
 
 using namespace triagens::aql;
 using Json = triagens::basics::Json;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of shapes cached per accessor
+/// documents with even more different shapes are handled without the cache
+////////////////////////////////////////////////////////////////////////////////
+
+size_t const AttributeAccessor::MaxCachedShapes = 64;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -55,6 +63,9 @@ AttributeAccessor::AttributeAccessor (std::vector<char const*> const& attributeP
     _buffer(TRI_UNKNOWN_MEM_ZONE),
     _shaper(nullptr),
     _pid(0),
+    _document(nullptr),
+    _shapeCache(),
+    _lastShape(0),
     _nameCache({ "", 0 }),
     _attributeType(ATTRIBUTE_TYPE_REGULAR) {
 
@@ -180,6 +191,27 @@ AqlValue AttributeAccessor::get (triagens::arango::AqlTransaction* trx,
 
         // fall-through intentional
       }
+      else if (result.isCompact()) {
+        CompactValue value(result._compact);
+        size_t const n = _attributeParts.size();
+
+        for (size_t i = 0; i < n; ++i) {
+          CompactValue member;
+
+          if (! value.get(_attributeParts[i], strlen(_attributeParts[i]), member)) {
+            break;
+          }
+
+          value = member;
+
+          if (i + 1 == n) {
+            // reached the end
+            return AqlValue(value.copy());
+          }
+        }
+
+        // fall-through intentional
+      }
 
       break;
     }
@@ -286,9 +318,14 @@ AqlValue AttributeAccessor::extractTo (AqlValue const& src,
 AqlValue AttributeAccessor::extractRegular (AqlValue const& src,
                                             triagens::arango::AqlTransaction* trx,
                                             TRI_document_collection_t const* document) {
-  if (_shaper == nullptr) {
+  if (_document != document) {
+    // shapes and attribute paths are per collection, so any cached
+    // information is useless for documents from another collection
+    _document = document;
     _shaper = document->getShaper();
     _pid = _shaper->lookupAttributePathByName(_combinedName.c_str());
+    _shapeCache.clear();
+    _lastShape = 0;
   }
    
   if (_pid != 0) { 
@@ -300,8 +337,18 @@ AqlValue AttributeAccessor::extractRegular (AqlValue const& src,
 
     TRI_shaped_json_t json;
     TRI_shape_t const* shape;
+    bool ok;
+
+    auto entry = lookupShape(shapedJson._sid);
 
-    bool ok = _shaper->extractShapedJson(&shapedJson, 0, _pid, &json, &shape);
+    if (entry != nullptr) {
+      // use the accessor directly, without looking it up again
+      shape = entry->shape;
+      ok = (shape != nullptr && TRI_ExecuteShapeAccessor(entry->accessor, &shapedJson, &json));
+    }
+    else {
+      ok = _shaper->extractShapedJson(&shapedJson, 0, _pid, &json, &shape);
+    }
 
     if (ok && shape != nullptr) {
       std::unique_ptr<TRI_json_t> extracted(TRI_JsonShapedJson(_shaper, &json));
@@ -319,6 +366,49 @@ AqlValue AttributeAccessor::extractRegular (AqlValue const& src,
   return AqlValue(new Json(Json::Null));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the cached accessor for a document shape
+////////////////////////////////////////////////////////////////////////////////
+
+AttributeAccessor::ShapeCacheEntry const* AttributeAccessor::lookupShape (TRI_shape_sid_t sid) {
+  size_t const n = _shapeCache.size();
+
+  // most collections contain only few different shapes, and documents of
+  // the same shape often follow each other
+  if (_lastShape < n && _shapeCache[_lastShape].sid == sid) {
+    return &_shapeCache[_lastShape];
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    if (_shapeCache[i].sid == sid) {
+      _lastShape = i;
+      return &_shapeCache[i];
+    }
+  }
+
+  if (n >= MaxCachedShapes) {
+    return nullptr;
+  }
+
+  auto accessor = _shaper->findAccessor(sid, _pid);
+
+  if (accessor == nullptr) {
+    return nullptr;
+  }
+
+  TRI_shape_t const* shape = nullptr;
+
+  if (accessor->_resultSid != TRI_SHAPE_ILLEGAL) {
+    // a nullptr shape means the attribute is not present in documents of this shape
+    shape = _shaper->lookupShapeId(accessor->_resultSid);
+  }
+
+  _shapeCache.push_back({ sid, accessor, shape });
+  _lastShape = n;
+
+  return &_shapeCache[n];
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #include "VocBase/shaped-json.h"
 
 struct TRI_document_collection_t;
+struct TRI_shape_access_s;
 class VocShaper;
 
 namespace triagens {
@@ -59,6 +60,16 @@ namespace triagens {
           ATTRIBUTE_TYPE_REGULAR
         };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached accessor for all documents with the same shape
+////////////////////////////////////////////////////////////////////////////////
+
+        struct ShapeCacheEntry {
+          TRI_shape_sid_t                  sid;
+          struct TRI_shape_access_s const* accessor;
+          TRI_shape_t const*               shape;
+        };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -134,6 +145,15 @@ namespace triagens {
                                  triagens::arango::AqlTransaction*,
                                  struct TRI_document_collection_t const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the cached accessor for a document shape
+///
+/// returns a nullptr if the cache is full or the accessor cannot be built.
+/// the caller must use the uncached extraction in this case
+////////////////////////////////////////////////////////////////////////////////
+
+        ShapeCacheEntry const* lookupShape (TRI_shape_sid_t);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -176,6 +196,30 @@ namespace triagens {
 
         TRI_shape_pid_t _pid;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection the shaper and the shape cache belong to
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_document_collection_t const* _document;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief accessors for the shapes seen so far, in order of first occurrence
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<ShapeCacheEntry> _shapeCache;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the most recently used shape cache entry
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _lastShape;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of shapes cached per accessor
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxCachedShapes;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief collection name lookup cache
 ////////////////////////////////////////////////////////////////////////////////
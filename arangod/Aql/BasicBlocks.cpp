@@ -97,7 +97,7 @@ int SingletonBlock::getOrSkipSome (size_t,   // atLeast,
   }
 
   if (! skipping) {
-    result = new AqlItemBlock(1, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]);
+    result = requestBlock(1, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]);
 
     try {
       if (_inputRegisterValues != nullptr) {
@@ -205,7 +205,7 @@ bool FilterBlock::getBlock (size_t atLeast, size_t atMost) {
     }
 
     _buffer.pop_front();  // Block was useless, just try again
-    delete cur;   // free this block
+    returnBlock(cur);   // recycle this block
   }
 
   return true;
@@ -268,7 +268,7 @@ int FilterBlock::getOrSkipSome (size_t atLeast,
           more.release();
         }
         skipped += _chosen.size() - _pos;
-        delete cur;
+        returnBlock(cur);
         _buffer.pop_front();
         _chosen.clear();
         _pos = 0;
@@ -286,7 +286,7 @@ int FilterBlock::getOrSkipSome (size_t atLeast,
           collector.emplace_back(cur);
         }
         else {
-          delete cur;
+          returnBlock(cur);
         }
         _buffer.pop_front();
         _chosen.clear();
@@ -483,7 +483,7 @@ AqlItemBlock* ReturnBlock::getSome (size_t atLeast,
   TRI_ASSERT(it != ep->getRegisterPlan()->varInfo.end());
   RegisterId const registerId = it->second.registerId;
 
-  std::unique_ptr<AqlItemBlock> stripped(new AqlItemBlock(n, 1));
+  std::unique_ptr<AqlItemBlock> stripped(requestBlock(n, 1));
 
   for (size_t i = 0; i < n; i++) {
     auto a = res->getValueReference(i, registerId);
@@ -87,6 +87,14 @@ namespace triagens {
 
         uint64_t hash () const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the raw parameter json
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t const* json () const {
+          return _json;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief strip collection name prefixes from the parameters
 /// the values must be a JSON array. the array is modified in place
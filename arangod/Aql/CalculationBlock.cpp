@@ -132,6 +132,32 @@ void CalculationBlock::executeExpression (AqlItemBlock* result) {
 
   size_t const n = result->size();
 
+  if (! hasCondition && 
+      n > 1 &&
+      _expression->canRunBatched()) {
+    // evaluate the expression for all rows of the block at once
+    std::vector<uint8_t> values;
+
+    if (_expression->executeBatch(_trx, result, n, _inVars, _inRegs, values)) {
+      for (size_t i = 0; i < n; i++) {
+        AqlValue a(new Json(TRI_UNKNOWN_MEM_ZONE, values[i] ? &Expression::TrueJson : &Expression::FalseJson, Json::NOFREE));
+
+        try {
+          result->setValue(i, _outReg, a);
+        }
+        catch (...) {
+          a.destroy();
+          throw;
+        }
+      }
+      throwIfKilled(); // check if we were aborted
+      return;
+    }
+
+    // values in the block cannot be processed in batch mode.
+    // fall back to evaluating the expression row by row
+  }
+
   for (size_t i = 0; i < n; i++) {
     // check the condition variable (if any)
     if (hasCondition) {
@@ -232,6 +232,8 @@ bool GatherBlock::hasMore () {
     }
   }
   else {
+    prefetch(DefaultBatchSize, DefaultBatchSize);
+
     for (size_t i = 0; i < _gatherBlockBuffer.size(); i++) { 
       if (! _gatherBlockBuffer.at(i).empty()) {
         return true;
@@ -257,6 +259,9 @@ AqlItemBlock* GatherBlock::getSome (size_t atLeast, size_t atMost) {
     return nullptr;
   }
 
+  // send requests to all shards, so they can work in parallel
+  prefetch(atLeast, atMost);
+
   // the simple case . . .  
   if (_isSimple) {
     auto res = _dependencies.at(_atDep)->getSome(atLeast, atMost);
@@ -274,7 +279,8 @@ AqlItemBlock* GatherBlock::getSome (size_t atLeast, size_t atMost) {
   size_t available = 0; // nr of available rows
   size_t index = 0;     // an index of a non-empty buffer
   
-  // pull more blocks from dependencies . . .
+  // pull more blocks from dependencies. the requests for all of them have
+  // already been sent by prefetch() . . .
   for (size_t i = 0; i < _dependencies.size(); i++) {
     
     if (_gatherBlockBuffer.at(i).empty()) {
@@ -318,7 +324,7 @@ AqlItemBlock* GatherBlock::getSome (size_t atLeast, size_t atMost) {
   AqlItemBlock* example =_gatherBlockBuffer.at(index).front();
   size_t nrRegs = example->getNrRegs();
 
-  std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(toSend,
+  std::unique_ptr<AqlItemBlock> res(requestBlock(toSend,
         static_cast<triagens::aql::RegisterId>(nrRegs)));  
   // automatically deleted if things go wrong
     
@@ -379,6 +385,9 @@ size_t GatherBlock::skipSome (size_t atLeast, size_t atMost) {
     return 0;
   }
 
+  // send requests to all shards, so they can work in parallel
+  prefetch(atLeast, atMost);
+
   // the simple case . . .  
   if (_isSimple) {
     auto skipped = _dependencies.at(_atDep)->skipSome(atLeast, atMost);
@@ -480,6 +489,34 @@ bool GatherBlock::getBlock (size_t i, size_t atLeast, size_t atMost) {
   LEAVE_BLOCK
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prefetch: send a getSome request to all remote dependencies for
+/// which no rows are buffered, so that the shards work in parallel. the
+/// results are then picked up one after the other by getBlock, so the
+/// latency is that of the slowest shard instead of the sum of all
+////////////////////////////////////////////////////////////////////////////////
+
+void GatherBlock::prefetch (size_t atLeast, size_t atMost) {
+  ENTER_BLOCK
+  // in the simple case, the dependencies before _atDep are exhausted
+  size_t const start = (_isSimple ? _atDep : 0);
+
+  for (size_t i = start; i < _dependencies.size(); i++) {
+    auto dep = _dependencies[i];
+
+    if (dep->getPlanNode()->getType() != ExecutionNode::REMOTE) {
+      continue;
+    }
+
+    if (! _isSimple && ! _gatherBlockBuffer.at(i).empty()) {
+      continue;
+    }
+
+    static_cast<RemoteBlock*>(dep)->prefetch(atLeast, atMost);
+  }
+  LEAVE_BLOCK
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief OurLessThan: comparison method for elements of _gatherBlockPos
 ////////////////////////////////////////////////////////////////////////////////
@@ -1158,6 +1195,24 @@ TRI_json_t const* DistributeBlock::getInputJson (AqlItemBlock const* cur) const
 size_t DistributeBlock::sendToClient (AqlItemBlock* cur) {
   ENTER_BLOCK
       
+  // the shard calculation requires JSON, so compact values are converted
+  // in place
+  for (auto const regId : { _regId, _alternativeRegId }) {
+    if (regId != ExecutionNode::MaxRegisterId &&
+        cur->getValueReference(_pos, regId).isCompact()) {
+      AqlValue a(new triagens::basics::Json(cur->getValueReference(_pos, regId).toJson(_trx, nullptr, true)));
+      cur->destroyValue(_pos, regId);
+
+      try {
+        cur->setValue(_pos, regId, a);
+      }
+      catch (...) {
+        a.destroy();
+        throw;
+      }
+    }
+  }
+
   // inspect cur in row _pos and check to which shard it should be sent . .
   auto json = getInputJson(cur);
 
@@ -1396,7 +1451,13 @@ RemoteBlock::RemoteBlock (ExecutionEngine* engine,
   : ExecutionBlock(engine, en),
     _server(server),
     _ownName(ownName),
-    _queryId(queryId) {
+    _queryId(queryId),
+    _usePrefetch(ownName.empty()),
+    _prefetchTransactionId(0),
+    _prefetchOperationId(0),
+    _prefetched(nullptr),
+    _prefetchedPos(0),
+    _exhausted(false) {
 
   TRI_ASSERT(! queryId.empty());
   TRI_ASSERT_EXPENSIVE((triagens::arango::ServerState::instance()->isCoordinator() && ownName.empty()) ||
@@ -1404,6 +1465,11 @@ RemoteBlock::RemoteBlock (ExecutionEngine* engine,
 }
 
 RemoteBlock::~RemoteBlock () {
+  if (_prefetchOperationId != 0) {
+    // nobody is interested in the answer anymore
+    ClusterComm::instance()->drop("AQL", _prefetchTransactionId, _prefetchOperationId, "");
+  }
+  delete _prefetched;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1450,6 +1516,157 @@ ClusterCommResult* RemoteBlock::sendRequest (
   LEAVE_BLOCK
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turn the response of a getSome request into an item block, 
+/// returns a nullptr if the remote side is exhausted
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* RemoteBlock::processGetSomeResponse (Json const& responseBodyJson) const {
+  ENTER_BLOCK
+  ExecutionStats newStats(responseBodyJson.get("stats"));
+  
+  _engine->_stats.addDelta(_deltaStats, newStats);
+  _deltaStats = newStats;
+  
+  if (JsonHelper::getBooleanValue(responseBodyJson.json(), "exhausted", true)) {
+    return nullptr;
+  }
+    
+  return new triagens::aql::AqlItemBlock(responseBodyJson);
+  LEAVE_BLOCK
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prefetch, sends a getSome request in the background if there is
+/// no request in flight and no prefetched rows are buffered
+////////////////////////////////////////////////////////////////////////////////
+
+void RemoteBlock::prefetch (size_t atLeast, size_t atMost) {
+  ENTER_BLOCK
+  if (! _usePrefetch ||
+      _prefetchOperationId != 0 ||
+      _prefetched != nullptr ||
+      _exhausted) {
+    return;
+  }
+
+  Json body(Json::Object, 2);
+  body("atLeast", Json(static_cast<double>(atLeast)))
+      ("atMost", Json(static_cast<double>(atMost)));
+
+  auto cc = ClusterComm::instance();
+  auto headers = new std::map<std::string, std::string>;
+  CoordTransactionID const coordTransactionId = TRI_NewTickServer();
+
+  std::unique_ptr<ClusterCommResult> res;
+  res.reset(cc->asyncRequest("AQL",
+                             coordTransactionId,
+                             _server,
+                             rest::HttpRequest::HTTP_REQUEST_PUT,
+                             std::string("/_db/") 
+                             + triagens::basics::StringUtils::urlEncode(_engine->getQuery()->trx()->vocbase()->_name)
+                             + "/_api/aql/getSome/" + _queryId,
+                             new std::string(body.toString()),
+                             true,
+                             headers,
+                             nullptr,
+                             defaultTimeOut));
+
+  if (res == nullptr || res->status == CL_COMM_ERROR) {
+    // the request could not be queued. the next call will simply send a
+    // synchronous request
+    return;
+  }
+
+  _prefetchTransactionId = coordTransactionId;
+  _prefetchOperationId = res->operationID;
+  LEAVE_BLOCK
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait for the prefetch request in flight (if any) and buffer its 
+/// result
+////////////////////////////////////////////////////////////////////////////////
+
+void RemoteBlock::harvestPrefetch () const {
+  ENTER_BLOCK
+  if (_prefetchOperationId == 0) {
+    return;
+  }
+
+  TRI_ASSERT(_prefetched == nullptr);
+
+  auto currentThread = triagens::rest::DispatcherThread::currentDispatcherThread;
+
+  if (currentThread != nullptr) {
+    triagens::rest::DispatcherThread::currentDispatcherThread->block();
+  }
+
+  std::unique_ptr<ClusterCommResult> res;
+  res.reset(ClusterComm::instance()->wait("AQL", 
+                                          _prefetchTransactionId, 
+                                          _prefetchOperationId, 
+                                          "",
+                                          defaultTimeOut));
+
+  if (currentThread != nullptr) {
+    triagens::rest::DispatcherThread::currentDispatcherThread->unblock();
+  }
+
+  _prefetchOperationId = 0;
+
+  if (res->status != CL_COMM_RECEIVED) {
+    throwExceptionAfterBadSyncRequest(res.get(), false);
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_CLUSTER_AQL_COMMUNICATION);
+  }
+
+  Json responseBodyJson(TRI_UNKNOWN_MEM_ZONE,
+                        TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, 
+                                       res->answer->body()));
+
+  if (res->answer_code != triagens::rest::HttpResponse::OK) {
+    int errorNum = JsonHelper::getNumericValue<int>(responseBodyJson.json(), "errorNum", TRI_ERROR_CLUSTER_AQL_COMMUNICATION);
+    std::string errorMessage = std::string("Error message received from shard '") + 
+      std::string(res->shardID) + 
+      std::string("' on cluster node '") +
+      std::string(res->serverID) +
+      std::string("': ") +
+      JsonHelper::getStringValue(responseBodyJson.json(), "errorMessage", "(no valid error in response)");
+    THROW_ARANGO_EXCEPTION_MESSAGE(errorNum, errorMessage);
+  }
+
+  _prefetched = processGetSomeResponse(responseBodyJson);
+  _prefetchedPos = 0;
+
+  if (_prefetched == nullptr) {
+    _exhausted = true;
+  }
+  LEAVE_BLOCK
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait for the prefetch request in flight (if any) and throw away 
+/// all prefetched rows
+////////////////////////////////////////////////////////////////////////////////
+
+void RemoteBlock::discardPrefetch (bool ignoreErrors) {
+  ENTER_BLOCK
+  try {
+    harvestPrefetch();
+  }
+  catch (...) {
+    if (! ignoreErrors) {
+      throw;
+    }
+  }
+
+  delete _prefetched;
+  _prefetched = nullptr;
+  _prefetchedPos = 0;
+  _exhausted = false;
+  LEAVE_BLOCK
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialize
 ////////////////////////////////////////////////////////////////////////////////
@@ -1472,6 +1689,9 @@ int RemoteBlock::initialize () {
 
 int RemoteBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
   ENTER_BLOCK
+  // rows fetched ahead of time belong to the old cursor
+  discardPrefetch(false);
+
   // For every call we simply forward via HTTP
 
   Json body(Json::Object, 4);
@@ -1512,6 +1732,10 @@ int RemoteBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
 
 int RemoteBlock::shutdown (int errorCode) {
   ENTER_BLOCK
+  // a prefetch request in flight must be finished before the remote query
+  // can be shut down. its errors do not matter anymore
+  discardPrefetch(true);
+
   // For every call we simply forward via HTTP
 
   std::unique_ptr<ClusterCommResult> res;
@@ -1559,6 +1783,57 @@ int RemoteBlock::shutdown (int errorCode) {
 AqlItemBlock* RemoteBlock::getSome (size_t atLeast,
                                     size_t atMost) {
   ENTER_BLOCK
+  if (_usePrefetch) {
+    harvestPrefetch();
+    
+    AqlItemBlock* result = nullptr;
+
+    if (_prefetched != nullptr) {
+      // return the prefetched rows
+      size_t const n = (std::min)(prefetchedRows(), atMost);
+
+      if (_prefetchedPos == 0 && n == _prefetched->size()) {
+        result = _prefetched;
+        _prefetched = nullptr;
+      }
+      else {
+        result = _prefetched->slice(_prefetchedPos, _prefetchedPos + n);
+        _prefetchedPos += n;
+
+        if (prefetchedRows() == 0) {
+          delete _prefetched;
+          _prefetched = nullptr;
+        }
+      }
+    }
+    else if (! _exhausted) {
+      result = getSomeRemote(atLeast, atMost);
+    }
+
+    if (result != nullptr) {
+      // the caller will most likely ask for the next rows soon
+      try {
+        prefetch(atLeast, atMost);
+      }
+      catch (...) {
+        delete result;
+        throw;
+      }
+    }
+    return result;
+  }
+
+  return getSomeRemote(atLeast, atMost);
+  LEAVE_BLOCK
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSomeRemote, sends a synchronous getSome request
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* RemoteBlock::getSomeRemote (size_t atLeast,
+                                          size_t atMost) {
+  ENTER_BLOCK
   // For every call we simply forward via HTTP
 
   Json body(Json::Object, 2);
@@ -1579,16 +1854,7 @@ AqlItemBlock* RemoteBlock::getSome (size_t atLeast,
                         TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, 
                                        responseBodyBuf.begin()));
 
-  ExecutionStats newStats(responseBodyJson.get("stats"));
-  
-  _engine->_stats.addDelta(_deltaStats, newStats);
-  _deltaStats = newStats;
-  
-  if (JsonHelper::getBooleanValue(responseBodyJson.json(), "exhausted", true)) {
-    return nullptr;
-  }
-    
-  return new triagens::aql::AqlItemBlock(responseBodyJson);
+  return processGetSomeResponse(responseBodyJson);
   LEAVE_BLOCK
 }
 
@@ -1597,6 +1863,35 @@ AqlItemBlock* RemoteBlock::getSome (size_t atLeast,
 ////////////////////////////////////////////////////////////////////////////////
 
 size_t RemoteBlock::skipSome (size_t atLeast, size_t atMost) {
+  ENTER_BLOCK
+  size_t skipped = 0;
+
+  if (_usePrefetch) {
+    harvestPrefetch();
+
+    // skip over the prefetched rows first
+    skipped = (std::min)(prefetchedRows(), atMost);
+    _prefetchedPos += skipped;
+
+    if (_prefetched != nullptr && prefetchedRows() == 0) {
+      delete _prefetched;
+      _prefetched = nullptr;
+    }
+
+    if (skipped >= atLeast || _exhausted) {
+      return skipped;
+    }
+  }
+
+  return skipped + skipSomeRemote(atLeast - skipped, atMost - skipped);
+  LEAVE_BLOCK
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skipSomeRemote, sends a synchronous skipSome request
+////////////////////////////////////////////////////////////////////////////////
+
+size_t RemoteBlock::skipSomeRemote (size_t atLeast, size_t atMost) {
   ENTER_BLOCK
   // For every call we simply forward via HTTP
 
@@ -1632,6 +1927,17 @@ size_t RemoteBlock::skipSome (size_t atLeast, size_t atMost) {
 
 bool RemoteBlock::hasMore () {
   ENTER_BLOCK
+  if (_usePrefetch) {
+    harvestPrefetch();
+
+    if (_prefetched != nullptr) {
+      return true;
+    }
+    if (_exhausted) {
+      return false;
+    }
+  }
+
   // For every call we simply forward via HTTP
   std::unique_ptr<ClusterCommResult> res;
   res.reset(sendRequest(rest::HttpRequest::HTTP_REQUEST_GET,
@@ -1658,6 +1964,11 @@ bool RemoteBlock::hasMore () {
 
 int64_t RemoteBlock::count () const {
   ENTER_BLOCK
+  if (_usePrefetch) {
+    // the remote query is busy until the prefetch request is answered
+    harvestPrefetch();
+  }
+
   // For every call we simply forward via HTTP
   std::unique_ptr<ClusterCommResult> res;
   res.reset(sendRequest(rest::HttpRequest::HTTP_REQUEST_GET,
@@ -1685,6 +1996,17 @@ int64_t RemoteBlock::count () const {
 
 int64_t RemoteBlock::remaining () {
   ENTER_BLOCK
+  int64_t prefetched = 0;
+
+  if (_usePrefetch) {
+    harvestPrefetch();
+
+    prefetched = static_cast<int64_t>(prefetchedRows());
+    if (_exhausted) {
+      return prefetched;
+    }
+  }
+
   // For every call we simply forward via HTTP
   std::unique_ptr<ClusterCommResult> res;
   res.reset(sendRequest(rest::HttpRequest::HTTP_REQUEST_GET,
@@ -1701,8 +2023,8 @@ int64_t RemoteBlock::remaining () {
   if (JsonHelper::getBooleanValue(responseBodyJson.json(), "error", true)) {
     THROW_ARANGO_EXCEPTION(TRI_ERROR_CLUSTER_AQL_COMMUNICATION);
   }
-  return JsonHelper::getNumericValue<int64_t>
-               (responseBodyJson.json(), "remaining", 0);
+  return prefetched + JsonHelper::getNumericValue<int64_t>
+                            (responseBodyJson.json(), "remaining", 0);
   LEAVE_BLOCK
 }
 
@@ -126,6 +126,13 @@ namespace triagens {
         
         bool getBlock (size_t i, size_t atLeast, size_t atMost);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prefetch: send a getSome request to all remote dependencies for
+/// which no rows are buffered, so that the shards work in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        void prefetch (size_t atLeast, size_t atMost);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief _gatherBlockBuffer: buffer the incoming block from each dependency
 /// separately 
@@ -630,6 +637,14 @@ namespace triagens {
 
         int64_t remaining () override final;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prefetch, sends a getSome request in the background if there is
+/// no request in flight and no prefetched rows are buffered. the result is
+/// picked up by the next call. this is a no-op on DB servers
+////////////////////////////////////////////////////////////////////////////////
+
+        void prefetch (size_t atLeast, size_t atMost);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief internal method to send a request
 ////////////////////////////////////////////////////////////////////////////////
@@ -641,6 +656,51 @@ namespace triagens {
                   std::string const& urlPart,
                   std::string const& body) const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief send a synchronous getSome request
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* getSomeRemote (size_t atLeast, size_t atMost);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief send a synchronous skipSome request
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSomeRemote (size_t atLeast, size_t atMost);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turn the response of a getSome request into an item block, 
+/// returns a nullptr if the remote side is exhausted
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* processGetSomeResponse (triagens::basics::Json const& responseBodyJson) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait for the prefetch request in flight (if any) and buffer its 
+/// result. this must happen before any other request is sent to the remote
+/// query, because the remote side cannot process two requests at a time
+////////////////////////////////////////////////////////////////////////////////
+
+        void harvestPrefetch () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait for the prefetch request in flight (if any) and throw away 
+/// all prefetched rows
+////////////////////////////////////////////////////////////////////////////////
+
+        void discardPrefetch (bool ignoreErrors);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of prefetched rows not yet returned
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t prefetchedRows () const {
+          if (_prefetched == nullptr) {
+            return 0;
+          }
+          return _prefetched->size() - _prefetchedPos;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief our server, can be like "shard:S1000" or like "server:Claus"
 ////////////////////////////////////////////////////////////////////////////////
@@ -664,7 +724,46 @@ namespace triagens {
 /// @brief the ID of the query on the server as a string
 ////////////////////////////////////////////////////////////////////////////////
 
-        ExecutionStats _deltaStats;
+        mutable ExecutionStats _deltaStats;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not getSome requests are sent ahead of time. this is
+/// only done on the coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _usePrefetch;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief coordinator transaction id of the prefetch request in flight.
+/// the prefetch state is mutable because the const count() must finish a
+/// request in flight, too
+////////////////////////////////////////////////////////////////////////////////
+
+        mutable triagens::arango::CoordTransactionID _prefetchTransactionId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief operation id of the prefetch request in flight, 0 if there is none
+////////////////////////////////////////////////////////////////////////////////
+
+        mutable triagens::arango::OperationID _prefetchOperationId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prefetched rows, starting at _prefetchedPos
+////////////////////////////////////////////////////////////////////////////////
+
+        mutable AqlItemBlock* _prefetched;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the next row to return in _prefetched
+////////////////////////////////////////////////////////////////////////////////
+
+        mutable size_t _prefetchedPos;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a prefetch request found the remote side exhausted
+////////////////////////////////////////////////////////////////////////////////
+
+        mutable bool _exhausted;
         
     };
 
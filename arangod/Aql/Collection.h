@@ -160,7 +160,7 @@ namespace triagens {
 /// @brief returns the indexes of the collection
 ////////////////////////////////////////////////////////////////////////////////
 
-      std::vector<Index*> getIndexes (); 
+      std::vector<Index*> getIndexes () const;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return an index by its id
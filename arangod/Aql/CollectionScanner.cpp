@@ -28,9 +28,32 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CollectionScanner.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/Expression.h"
+#include "Aql/Functions.h"
+#include "Basics/ConditionLocker.h"
+#include "Basics/Exceptions.h"
+#include "Basics/ThreadPool.h"
+#include "Basics/system-functions.h"
+#include "Indexes/PrimaryIndex.h"
 
 using namespace triagens::aql;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the thread pool shared by all parallel collection scans. it is
+/// created on first use, with one thread per processor
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::ThreadPool* ScannerPool () {
+  static triagens::basics::ThreadPool pool((std::max)(static_cast<size_t>(1), TRI_numberProcessors()), "AqlScanner");
+
+  return &pool;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                          struct CollectionScanner
 // -----------------------------------------------------------------------------
@@ -117,6 +140,393 @@ void LinearCollectionScanner::reset () {
   position.reset();
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                       class CollectionScanFilter
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+CollectionScanFilter::CollectionScanFilter (triagens::arango::AqlTransaction* trx,
+                                            TRI_document_collection_t* document,
+                                            Expression* expression,
+                                            Variable const* variable)
+  : _trx(trx),
+    _expression(nullptr),
+    _block(nullptr),
+    _vars{ variable },
+    _regs{ 0 } {
+ 
+  TRI_ASSERT(expression != nullptr);
+  TRI_ASSERT(variable != nullptr);
+
+  std::unique_ptr<Expression> copy(expression->clone());
+  // analyze the expression now, so it is not done concurrently later
+  copy->isV8();
+  TRI_ASSERT(! copy->isV8());
+
+  _block = new AqlItemBlock(1, 1);
+  _block->setDocumentCollection(0, document);
+  _expression = copy.release();
+}
+
+CollectionScanFilter::~CollectionScanFilter () {
+  delete _block;
+  delete _expression;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the document matches the filter condition
+////////////////////////////////////////////////////////////////////////////////
+
+bool CollectionScanFilter::matches (TRI_doc_mptr_copy_t const& mptr) {
+  _block->setShaped(0, 0, static_cast<TRI_df_marker_t const*>(mptr.getDataPtr()));
+
+  TRI_document_collection_t const* myCollection = nullptr;
+  AqlValue result = _expression->execute(_trx, _block, 0, _vars, _regs, &myCollection);
+  bool const matches = result.isTrue();
+  result.destroy();
+
+  return matches;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all non-matching documents from the vector, keeping the
+/// order of the remaining documents
+////////////////////////////////////////////////////////////////////////////////
+
+void CollectionScanFilter::apply (std::vector<TRI_doc_mptr_copy_t>& documents) {
+  size_t const n = documents.size();
+  size_t j = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    if (matches(documents[i])) {
+      if (i != j) {
+        documents[j] = documents[i];
+      }
+      ++j;
+    }
+  }
+
+  documents.resize(j);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                  struct ParallelCollectionScanner
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+ParallelCollectionScanner::ParallelCollectionScanner (triagens::arango::AqlTransaction* trx,
+                                                      TRI_transaction_collection_t* trxCollection,
+                                                      size_t numThreads,
+                                                      Expression* filter,
+                                                      Variable const* variable) 
+  : CollectionScanner(trx, trxCollection),
+    scannedDocuments(0),
+    _numThreads(numThreads),
+    _filter(filter),
+    _variable(variable),
+    _chunks(),
+    _filters(),
+    _maxWorkers(0),
+    _condition(),
+    _freeFilters(),
+    _activeWorkers(0),
+    _nextChunk(0),
+    _readChunk(0),
+    _readPosition(0),
+    _errorCode(TRI_ERROR_NO_ERROR),
+    _abort(false),
+    _started(false),
+    _locked(false) {
+
+  TRI_ASSERT(_numThreads > 0);
+}
+
+ParallelCollectionScanner::~ParallelCollectionScanner () {
+  stop();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+int ParallelCollectionScanner::scan (std::vector<TRI_doc_mptr_copy_t>& docs,
+                                     size_t batchSize) {
+  if (! _started) {
+    try {
+      start();
+    }
+    catch (triagens::basics::Exception const& ex) {
+      stop();
+      return ex.code();
+    }
+    catch (...) {
+      stop();
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+  }
+
+  while (docs.size() < batchSize && _readChunk < _chunks.size()) {
+    auto& chunk = _chunks[_readChunk];
+
+    {
+      CONDITION_LOCKER(guard, _condition);
+
+      if (! chunk.done && ! docs.empty()) {
+        // return what we have instead of waiting
+        break;
+      }
+
+      if (! chunk.done) {
+        spawnWorkers();
+      }
+
+      while (! chunk.done && _errorCode == TRI_ERROR_NO_ERROR) {
+        guard.wait();
+      }
+
+      if (_errorCode != TRI_ERROR_NO_ERROR) {
+        return _errorCode;
+      }
+    }
+
+    if (_readPosition == 0) {
+      scannedDocuments += chunk.scanned;
+    }
+
+    size_t const n = (std::min)(chunk.documents.size() - _readPosition, batchSize - docs.size());
+    docs.insert(docs.end(), chunk.documents.begin() + _readPosition, chunk.documents.begin() + _readPosition + n);
+    _readPosition += n;
+
+    if (_readPosition >= chunk.documents.size()) {
+      // chunk exhausted. free its memory and let the workers continue
+      std::vector<TRI_doc_mptr_copy_t>().swap(chunk.documents);
+      _readPosition = 0;
+
+      CONDITION_LOCKER(guard, _condition);
+      ++_readChunk;
+      spawnWorkers();
+    }
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+void ParallelCollectionScanner::reset () {
+  stop();
+
+  _chunks.clear();
+  _nextChunk = 0;
+  _readChunk = 0;
+  _readPosition = 0;
+  _maxWorkers = 0;
+  _errorCode = TRI_ERROR_NO_ERROR;
+  _abort = false;
+  _started = false;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief split the index into chunks and start the workers
+////////////////////////////////////////////////////////////////////////////////
+
+void ParallelCollectionScanner::start () {
+  TRI_ASSERT(! _started);
+  TRI_ASSERT(_activeWorkers == 0);
+
+  _started = true;
+
+  // keep the collection read-locked while the workers are running
+  int res = trx->readLockCollection(trxCollection);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  _locked = true;
+
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+  auto primaryIndex = document->primaryIndex();
+  size_t const numBuckets = primaryIndex->numBuckets();
+
+  for (size_t i = 0; i < numBuckets; ++i) {
+    uint64_t const capacity = primaryIndex->bucketCapacity(i);
+
+    for (uint64_t from = 0; from < capacity; from += ChunkSize) {
+      _chunks.emplace_back(i, from, (std::min)(from + ChunkSize, capacity));
+    }
+  }
+
+  _maxWorkers = (std::min)((std::min)(_numThreads, ScannerPool()->numThreads()), _chunks.size());
+
+  if (_filter != nullptr) {
+    // each scheduled worker uses a filter of its own
+    _filters.reserve(_maxWorkers);
+    _freeFilters.reserve(_maxWorkers);
+
+    while (_filters.size() < _maxWorkers) {
+      std::unique_ptr<CollectionScanFilter> filter(new CollectionScanFilter(trx, document, _filter, _variable));
+      _filters.emplace_back(filter.get());
+      _freeFilters.emplace_back(filter.release());
+    }
+  }
+
+  CONDITION_LOCKER(guard, _condition);
+  spawnWorkers();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stop the workers and wait until all of them have finished
+////////////////////////////////////////////////////////////////////////////////
+
+void ParallelCollectionScanner::stop () {
+  {
+    CONDITION_LOCKER(guard, _condition);
+    _abort = true;
+
+    // workers that are still queued in the pool refer to this scanner, so
+    // we must wait for them, too
+    while (_activeWorkers > 0) {
+      guard.wait();
+    }
+  }
+
+  _freeFilters.clear();
+
+  for (auto& it : _filters) {
+    delete it;
+  }
+  _filters.clear();
+
+  if (_locked) {
+    trx->readUnlockCollection(trxCollection);
+    _locked = false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief schedule workers in the thread pool while there are chunks left
+/// to scan within the read-ahead window
+////////////////////////////////////////////////////////////////////////////////
+
+void ParallelCollectionScanner::spawnWorkers () {
+  size_t const maxAhead = _maxWorkers * ChunksAheadPerThread;
+
+  while (_activeWorkers < _maxWorkers &&
+         ! _abort &&
+         _errorCode == TRI_ERROR_NO_ERROR &&
+         _nextChunk < _chunks.size() &&
+         _nextChunk < _readChunk + maxAhead) {
+    CollectionScanFilter* filter = nullptr;
+
+    if (_filter != nullptr) {
+      TRI_ASSERT(! _freeFilters.empty());
+      filter = _freeFilters.back();
+      _freeFilters.pop_back();
+    }
+
+    try {
+      ScannerPool()->enqueue([this, filter] () -> void {
+        work(filter);
+      });
+    }
+    catch (...) {
+      if (filter != nullptr) {
+        _freeFilters.emplace_back(filter);
+      }
+      throw;
+    }
+
+    ++_activeWorkers;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief main function of a worker
+////////////////////////////////////////////////////////////////////////////////
+
+void ParallelCollectionScanner::work (CollectionScanFilter* filter) {
+  auto primaryIndex = trxCollection->_collection->_collection->primaryIndex();
+  size_t const maxAhead = _maxWorkers * ChunksAheadPerThread;
+
+  Chunk* chunk = nullptr;
+  std::vector<TRI_doc_mptr_copy_t> documents;
+  uint64_t scanned = 0;
+  int res = TRI_ERROR_NO_ERROR;
+
+  while (true) {
+    {
+      CONDITION_LOCKER(guard, _condition);
+
+      if (chunk != nullptr) {
+        // publish the result of the previous chunk
+        if (res == TRI_ERROR_NO_ERROR) {
+          chunk->documents.swap(documents);
+          chunk->scanned = scanned;
+          chunk->done = true;
+        }
+        else {
+          _errorCode = res;
+        }
+        guard.broadcast();
+      }
+
+      if (_abort || 
+          _errorCode != TRI_ERROR_NO_ERROR || 
+          _nextChunk >= _chunks.size() ||
+          _nextChunk >= _readChunk + maxAhead) {
+        // do not run too far ahead of the reader. the reader will schedule
+        // workers again when it has consumed a chunk. the worker must be
+        // unregistered under the same lock, so the reader cannot miss it
+        if (filter != nullptr) {
+          // cannot fail, as the capacity was reserved upfront
+          _freeFilters.emplace_back(filter);
+        }
+
+        TRI_ASSERT(_activeWorkers > 0);
+        --_activeWorkers;
+        guard.broadcast();
+        break;
+      }
+
+      chunk = &_chunks[_nextChunk++];
+    }
+
+    documents.clear();
+
+    try {
+      primaryIndex->lookupRange(chunk->bucketId, chunk->from, chunk->to, documents);
+      scanned = documents.size();
+
+      if (filter != nullptr) {
+        filter->apply(documents);
+      }
+    }
+    catch (triagens::basics::Exception const& ex) {
+      res = ex.code();
+    }
+    catch (...) {
+      res = TRI_ERROR_INTERNAL;
+    }
+  }
+
+  // clear thread-local data of AQL functions before the pool thread is 
+  // used for other tasks
+  Functions::DestroyThreadContext();
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -31,6 +31,8 @@
 #define ARANGODB_AQL_COLLECTION_SCANNER_H 1
 
 #include "Basics/Common.h"
+#include "Aql/types.h"
+#include "Basics/ConditionVariable.h"
 #include "Utils/AqlTransaction.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/transaction.h"
@@ -39,6 +41,10 @@
 namespace triagens {
   namespace aql {
 
+    class AqlItemBlock;
+    class Expression;
+    struct Variable;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                          struct CollectionScanner
 // -----------------------------------------------------------------------------
@@ -109,6 +115,233 @@ namespace triagens {
       void reset () override;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                       class CollectionScanFilter
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filter condition that is evaluated directly on scanned documents
+/// each instance owns a private copy of the expression, so different 
+/// instances can be used by different threads
+////////////////////////////////////////////////////////////////////////////////
+
+    class CollectionScanFilter {
+
+      public:
+
+        CollectionScanFilter (CollectionScanFilter const&) = delete;
+        CollectionScanFilter& operator= (CollectionScanFilter const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+  
+        CollectionScanFilter (triagens::arango::AqlTransaction*,
+                              TRI_document_collection_t*,
+                              Expression*,
+                              Variable const*);
+
+        ~CollectionScanFilter ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the document matches the filter condition
+////////////////////////////////////////////////////////////////////////////////
+
+        bool matches (TRI_doc_mptr_copy_t const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all non-matching documents from the vector, keeping the
+/// order of the remaining documents
+////////////////////////////////////////////////////////////////////////////////
+
+        void apply (std::vector<TRI_doc_mptr_copy_t>&);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+        triagens::arango::AqlTransaction* _trx;
+
+        Expression* _expression;
+
+        AqlItemBlock* _block;
+
+        std::vector<Variable const*> _vars;
+
+        std::vector<RegisterId> _regs;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                  struct ParallelCollectionScanner
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scanner that splits the primary index into slot ranges and lets
+/// several threads of a shared thread pool scan (and optionally filter) 
+/// them. the documents are returned in the same order as by the 
+/// LinearCollectionScanner. the collection must not be modified while the 
+/// scanner is in use
+////////////////////////////////////////////////////////////////////////////////
+
+    struct ParallelCollectionScanner final : public CollectionScanner {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+  
+      ParallelCollectionScanner (triagens::arango::AqlTransaction*,
+                                 TRI_transaction_collection_t*,
+                                 size_t,
+                                 Expression*,
+                                 Variable const*);
+
+      ~ParallelCollectionScanner ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+      int scan (std::vector<TRI_doc_mptr_copy_t>&,
+                size_t) override;
+      
+      void reset () override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of documents looked at so far, including the ones that 
+/// did not match the filter
+////////////////////////////////////////////////////////////////////////////////
+
+      uint64_t scannedDocuments;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+    private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief split the index into chunks and start the workers
+////////////////////////////////////////////////////////////////////////////////
+
+      void start ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stop the workers and wait until all of them have finished
+////////////////////////////////////////////////////////////////////////////////
+
+      void stop ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief schedule workers in the thread pool while there are chunks left
+/// to scan within the read-ahead window. must be called with _condition
+/// locked
+////////////////////////////////////////////////////////////////////////////////
+
+      void spawnWorkers ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief main function of a worker. the worker scans chunks until the 
+/// read-ahead window is full and then returns its thread to the pool
+////////////////////////////////////////////////////////////////////////////////
+
+      void work (CollectionScanFilter*);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private types
+// -----------------------------------------------------------------------------
+
+      struct Chunk {
+        Chunk (size_t bucketId, 
+               uint64_t from, 
+               uint64_t to)
+          : bucketId(bucketId),
+            from(from),
+            to(to),
+            documents(),
+            scanned(0),
+            done(false) {
+        }
+
+        size_t bucketId;
+        uint64_t from;
+        uint64_t to;
+        std::vector<TRI_doc_mptr_copy_t> documents;
+        uint64_t scanned;
+        bool done;
+      };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of index slots per chunk
+////////////////////////////////////////////////////////////////////////////////
+
+      static uint64_t const ChunkSize = 16384;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of chunks per thread the workers may run ahead of the reader
+////////////////////////////////////////////////////////////////////////////////
+
+      static size_t const ChunksAheadPerThread = 4;
+
+      size_t const _numThreads;
+
+      Expression* _filter;
+
+      Variable const* _variable;
+
+      std::vector<Chunk> _chunks;
+
+      std::vector<CollectionScanFilter*> _filters;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of concurrently scheduled workers
+////////////////////////////////////////////////////////////////////////////////
+
+      size_t _maxWorkers;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief condition variable protecting all variables below and the status
+/// of the chunks
+////////////////////////////////////////////////////////////////////////////////
+
+      triagens::basics::ConditionVariable _condition;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filters not in use by a scheduled worker
+////////////////////////////////////////////////////////////////////////////////
+
+      std::vector<CollectionScanFilter*> _freeFilters;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of workers queued in or running on the thread pool
+////////////////////////////////////////////////////////////////////////////////
+
+      size_t _activeWorkers;
+
+      size_t _nextChunk;
+
+      size_t _readChunk;
+
+      size_t _readPosition;
+
+      int _errorCode;
+
+      bool _abort;
+
+      bool _started;
+
+      bool _locked;
+    };
+
   }
 }
 
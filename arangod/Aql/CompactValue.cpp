@@ -0,0 +1,1266 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, compact binary value representation
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/CompactValue.h"
+#include "Basics/Exceptions.h"
+#include "Basics/fasthash.h"
+#include "Basics/json-utilities.h"
+#include "Basics/string-buffer.h"
+#include "Basics/Utf8Helper.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief size of the array/object header (type, byte size, number of members)
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const HeaderSize = 1 + sizeof(uint32_t) + sizeof(uint32_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum length of a short string
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MaxShortStringLength = 255;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief seed value used by TRI_FastHashJson()
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t const HashSeed = 0x012345678;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the type weight of a compact value, same as for TRI_json_t
+////////////////////////////////////////////////////////////////////////////////
+
+static int TypeWeight (CompactValue const& value) {
+  switch (value.type()) {
+    case CompactValue::TYPE_FALSE:
+    case CompactValue::TYPE_TRUE:
+      return 1;
+    case CompactValue::TYPE_SMALLINT:
+    case CompactValue::TYPE_NUMBER:
+      return 2;
+    case CompactValue::TYPE_SHORT_STRING:
+    case CompactValue::TYPE_STRING:
+      return 3;
+    case CompactValue::TYPE_ARRAY:
+      return 4;
+    case CompactValue::TYPE_OBJECT:
+      return 5;
+    case CompactValue::TYPE_NULL:
+      break;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the type weight of a TRI_json_t value
+////////////////////////////////////////////////////////////////////////////////
+
+static int TypeWeight (TRI_json_t const* value) {
+  if (value != nullptr) {
+    switch (value->_type) {
+      case TRI_JSON_BOOLEAN:
+        return 1;
+      case TRI_JSON_NUMBER:
+        return 2;
+      case TRI_JSON_STRING:
+      case TRI_JSON_STRING_REFERENCE:
+        return 3;
+      case TRI_JSON_ARRAY:
+        return 4;
+      case TRI_JSON_OBJECT:
+        return 5;
+      case TRI_JSON_NULL:
+      case TRI_JSON_UNUSED:
+        break;
+    }
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare two numbers
+////////////////////////////////////////////////////////////////////////////////
+
+static inline int CompareNumbers (double lhs,
+                                  double rhs) {
+  if (lhs == rhs) {
+    return 0;
+  }
+  return (lhs < rhs) ? -1 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare two NUL-terminated strings
+////////////////////////////////////////////////////////////////////////////////
+
+static inline int CompareStrings (char const* lhs,
+                                  size_t lhsLength,
+                                  char const* rhs,
+                                  size_t rhsLength,
+                                  bool useUtf8) {
+  int res;
+  if (useUtf8) {
+    res = TRI_compare_utf8(lhs, lhsLength, rhs, rhsLength);
+  }
+  else {
+    res = strcmp(lhs, rhs);
+  }
+
+  if (res < 0) {
+    return -1;
+  }
+  else if (res > 0) {
+    return 1;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class CompactValue
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the total size of the value in bytes
+////////////////////////////////////////////////////////////////////////////////
+
+size_t CompactValue::byteSize () const {
+  switch (type()) {
+    case TYPE_NULL:
+    case TYPE_FALSE:
+    case TYPE_TRUE:
+      return 1;
+    case TYPE_SMALLINT:
+      return 1 + sizeof(int8_t);
+    case TYPE_NUMBER:
+      return 1 + sizeof(double);
+    case TYPE_SHORT_STRING:
+      return 1 + sizeof(uint8_t) + static_cast<size_t>(_data[1]) + 1;
+    case TYPE_STRING:
+      return 1 + sizeof(uint32_t) + static_cast<size_t>(readUInt32(1)) + 1;
+    case TYPE_ARRAY:
+    case TYPE_OBJECT:
+      return static_cast<size_t>(readUInt32(1));
+  }
+
+  THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "invalid compact value type");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the numeric value, 0.0 if the value is not a number
+////////////////////////////////////////////////////////////////////////////////
+
+double CompactValue::getNumber () const {
+  if (type() == TYPE_SMALLINT) {
+    return static_cast<double>(static_cast<int8_t>(_data[1]));
+  }
+  if (type() == TYPE_NUMBER) {
+    double value;
+    memcpy(&value, _data + 1, sizeof(double));
+    return value;
+  }
+  return 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a pointer to the string value and its length
+////////////////////////////////////////////////////////////////////////////////
+
+char const* CompactValue::getString (size_t& length) const {
+  if (type() == TYPE_SHORT_STRING) {
+    length = static_cast<size_t>(_data[1]);
+    return reinterpret_cast<char const*>(_data + 1 + sizeof(uint8_t));
+  }
+  if (type() == TYPE_STRING) {
+    length = static_cast<size_t>(readUInt32(1));
+    return reinterpret_cast<char const*>(_data + 1 + sizeof(uint32_t));
+  }
+  length = 0;
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of members of an array or object
+////////////////////////////////////////////////////////////////////////////////
+
+size_t CompactValue::length () const {
+  if (type() == TYPE_ARRAY || type() == TYPE_OBJECT) {
+    return static_cast<size_t>(readUInt32(1 + sizeof(uint32_t)));
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the array member at the given position
+////////////////////////////////////////////////////////////////////////////////
+
+CompactValue CompactValue::at (size_t position) const {
+  TRI_ASSERT(type() == TYPE_ARRAY);
+  TRI_ASSERT(position < length());
+
+  return CompactValue(data() + readUInt32(HeaderSize + position * sizeof(uint32_t)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the object key at the given position
+////////////////////////////////////////////////////////////////////////////////
+
+CompactValue CompactValue::keyAt (size_t position) const {
+  TRI_ASSERT(type() == TYPE_OBJECT);
+  TRI_ASSERT(position < length());
+
+  return CompactValue(data() + readUInt32(HeaderSize + position * sizeof(uint32_t)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the object value at the given position
+////////////////////////////////////////////////////////////////////////////////
+
+CompactValue CompactValue::valueAt (size_t position) const {
+  CompactValue key = keyAt(position);
+  return CompactValue(key.data() + key.byteSize());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up an attribute in an object
+////////////////////////////////////////////////////////////////////////////////
+
+bool CompactValue::get (char const* name,
+                        size_t nameLength,
+                        CompactValue& result) const {
+  if (type() != TYPE_OBJECT) {
+    return false;
+  }
+
+  size_t const n = length();
+
+  if (n == 0) {
+    return false;
+  }
+
+  size_t const sortedTable = HeaderSize + n * sizeof(uint32_t);
+
+  // binary search on the sorted index table. on equal keys, the first
+  // inserted key wins, same as in TRI_LookupObjectJson()
+  size_t l = 0;
+  size_t r = n;
+
+  while (l < r) {
+    size_t const m = l + ((r - l) / 2);
+    size_t const index = static_cast<size_t>(readUInt32(sortedTable + m * sizeof(uint32_t)));
+
+    size_t keyLength;
+    char const* key = keyAt(index).getString(keyLength);
+
+    int res = memcmp(key, name, (std::min)(keyLength, nameLength));
+
+    if (res < 0 || (res == 0 && keyLength < nameLength)) {
+      l = m + 1;
+    }
+    else {
+      r = m;
+    }
+  }
+
+  if (l < n) {
+    size_t const index = static_cast<size_t>(readUInt32(sortedTable + l * sizeof(uint32_t)));
+    CompactValue key = keyAt(index);
+
+    size_t keyLength;
+    char const* k = key.getString(keyLength);
+
+    if (keyLength == nameLength && memcmp(k, name, nameLength) == 0) {
+      result = CompactValue(key.data() + key.byteSize());
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert the value into a TRI_json_t tree
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* CompactValue::toJson (TRI_memory_zone_t* zone) const {
+  auto json = static_cast<TRI_json_t*>(TRI_Allocate(zone, sizeof(TRI_json_t), false));
+
+  if (json == nullptr) {
+    return nullptr;
+  }
+
+  if (toJson(zone, json) != TRI_ERROR_NO_ERROR) {
+    TRI_FreeJson(zone, json);
+    return nullptr;
+  }
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize an already allocated TRI_json_t with the value
+////////////////////////////////////////////////////////////////////////////////
+
+int CompactValue::toJson (TRI_memory_zone_t* zone,
+                          TRI_json_t* json) const {
+  switch (type()) {
+    case TYPE_NULL: {
+      TRI_InitNullJson(json);
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    case TYPE_FALSE:
+    case TYPE_TRUE: {
+      TRI_InitBooleanJson(json, getBoolean());
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    case TYPE_SMALLINT:
+    case TYPE_NUMBER: {
+      TRI_InitNumberJson(json, getNumber());
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    case TYPE_SHORT_STRING:
+    case TYPE_STRING: {
+      size_t length;
+      char const* p = getString(length);
+      int res = TRI_InitStringCopyJson(zone, json, p, length);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        TRI_InitNullJson(json);
+      }
+      return res;
+    }
+
+    case TYPE_ARRAY: {
+      size_t const n = length();
+      TRI_InitArrayJson(zone, json, n);
+
+      for (size_t i = 0; i < n; ++i) {
+        auto next = static_cast<TRI_json_t*>(TRI_NextVector(&json->_value._objects));
+
+        if (next == nullptr) {
+          return TRI_ERROR_OUT_OF_MEMORY;
+        }
+
+        int res = at(i).toJson(zone, next);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+      }
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    case TYPE_OBJECT: {
+      size_t const n = length();
+      TRI_InitObjectJson(zone, json, n * 2);
+
+      for (size_t i = 0; i < n; ++i) {
+        CompactValue key = keyAt(i);
+
+        auto next = static_cast<TRI_json_t*>(TRI_NextVector(&json->_value._objects));
+
+        if (next == nullptr) {
+          return TRI_ERROR_OUT_OF_MEMORY;
+        }
+
+        int res = key.toJson(zone, next);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+
+        next = static_cast<TRI_json_t*>(TRI_NextVector(&json->_value._objects));
+
+        if (next == nullptr) {
+          // remove the dangling key again so the object stays valid
+          TRI_DestroyJson(zone, static_cast<TRI_json_t*>(TRI_AddressVector(&json->_value._objects, TRI_LengthVector(&json->_value._objects) - 1)));
+          TRI_ReturnVector(&json->_value._objects);
+          return TRI_ERROR_OUT_OF_MEMORY;
+        }
+
+        res = CompactValue(key.data() + key.byteSize()).toJson(zone, next);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+      }
+      return TRI_ERROR_NO_ERROR;
+    }
+  }
+
+  TRI_InitNullJson(json);
+  return TRI_ERROR_INTERNAL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stringify the value into a string buffer
+////////////////////////////////////////////////////////////////////////////////
+
+int CompactValue::stringify (TRI_string_buffer_t* buffer) const {
+  switch (type()) {
+    case TYPE_NULL: {
+      return TRI_AppendString2StringBuffer(buffer, "null", 4); // strlen("null")
+    }
+
+    case TYPE_FALSE: {
+      return TRI_AppendString2StringBuffer(buffer, "false", 5); // strlen("false")
+    }
+
+    case TYPE_TRUE: {
+      return TRI_AppendString2StringBuffer(buffer, "true", 4); // strlen("true")
+    }
+
+    case TYPE_SMALLINT:
+    case TYPE_NUMBER: {
+      return TRI_AppendDoubleStringBuffer(buffer, getNumber());
+    }
+
+    case TYPE_SHORT_STRING:
+    case TYPE_STRING: {
+      size_t length;
+      char const* p = getString(length);
+
+      int res = TRI_AppendCharStringBuffer(buffer, '"');
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      if (length > 0) {
+        res = TRI_AppendJsonEncodedStringStringBuffer(buffer, p, length, false);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return TRI_ERROR_OUT_OF_MEMORY;
+        }
+      }
+
+      return TRI_AppendCharStringBuffer(buffer, '"');
+    }
+
+    case TYPE_ARRAY: {
+      int res = TRI_AppendCharStringBuffer(buffer, '[');
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      size_t const n = length();
+
+      for (size_t i = 0; i < n; ++i) {
+        if (i > 0) {
+          res = TRI_AppendCharStringBuffer(buffer, ',');
+
+          if (res != TRI_ERROR_NO_ERROR) {
+            return res;
+          }
+        }
+
+        res = at(i).stringify(buffer);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+      }
+
+      return TRI_AppendCharStringBuffer(buffer, ']');
+    }
+
+    case TYPE_OBJECT: {
+      int res = TRI_AppendCharStringBuffer(buffer, '{');
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      size_t const n = length();
+
+      for (size_t i = 0; i < n; ++i) {
+        if (i > 0) {
+          res = TRI_AppendCharStringBuffer(buffer, ',');
+
+          if (res != TRI_ERROR_NO_ERROR) {
+            return res;
+          }
+        }
+
+        CompactValue key = keyAt(i);
+        res = key.stringify(buffer);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+
+        res = TRI_AppendCharStringBuffer(buffer, ':');
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+
+        res = CompactValue(key.data() + key.byteSize()).stringify(buffer);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+      }
+
+      return TRI_AppendCharStringBuffer(buffer, '}');
+    }
+  }
+
+  return TRI_ERROR_INTERNAL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash the value
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t CompactValue::hash () const {
+  return hash(HashSeed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a standalone copy of the value
+////////////////////////////////////////////////////////////////////////////////
+
+char* CompactValue::copy () const {
+  size_t const size = byteSize();
+  auto result = static_cast<char*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, size, false));
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  memcpy(result, _data, size);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 3-way comparison of two compact values
+////////////////////////////////////////////////////////////////////////////////
+
+int CompactValue::Compare (CompactValue const& lhs,
+                           CompactValue const& rhs,
+                           bool useUtf8) {
+  int lWeight = TypeWeight(lhs);
+  int rWeight = TypeWeight(rhs);
+
+  if (lWeight != rWeight) {
+    return (lWeight < rWeight) ? -1 : 1;
+  }
+
+  switch (lhs.type()) {
+    case TYPE_NULL: {
+      return 0;
+    }
+
+    case TYPE_FALSE:
+    case TYPE_TRUE: {
+      if (lhs.getBoolean() == rhs.getBoolean()) {
+        return 0;
+      }
+      return rhs.getBoolean() ? -1 : 1;
+    }
+
+    case TYPE_SMALLINT:
+    case TYPE_NUMBER: {
+      return CompareNumbers(lhs.getNumber(), rhs.getNumber());
+    }
+
+    case TYPE_SHORT_STRING:
+    case TYPE_STRING: {
+      size_t lLength, rLength;
+      char const* l = lhs.getString(lLength);
+      char const* r = rhs.getString(rLength);
+      return CompareStrings(l, lLength, r, rLength, useUtf8);
+    }
+
+    case TYPE_ARRAY: {
+      size_t const nl = lhs.length();
+      size_t const nr = rhs.length();
+      size_t const n = (std::max)(nl, nr);
+
+      for (size_t i = 0; i < n; ++i) {
+        int result;
+        if (i >= nl) {
+          // a missing value compares like null
+          result = (TypeWeight(rhs.at(i)) == 0) ? 0 : -1;
+        }
+        else if (i >= nr) {
+          result = (TypeWeight(lhs.at(i)) == 0) ? 0 : 1;
+        }
+        else {
+          result = Compare(lhs.at(i), rhs.at(i), useUtf8);
+        }
+
+        if (result != 0) {
+          return result;
+        }
+      }
+      return 0;
+    }
+
+    case TYPE_OBJECT: {
+      // objects are compared by their merged and UTF-8 sorted key sets.
+      // this is rare enough to justify using the TRI_json_t implementation
+      TRI_json_t* l = lhs.toJson(TRI_UNKNOWN_MEM_ZONE);
+      TRI_json_t* r = rhs.toJson(TRI_UNKNOWN_MEM_ZONE);
+
+      if (l == nullptr || r == nullptr) {
+        if (l != nullptr) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, l);
+        }
+        if (r != nullptr) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, r);
+        }
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      int result = TRI_CompareValuesJson(l, r, useUtf8);
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, l);
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, r);
+      return result;
+    }
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 3-way comparison of a compact value with a TRI_json_t
+////////////////////////////////////////////////////////////////////////////////
+
+int CompactValue::Compare (CompactValue const& lhs,
+                           TRI_json_t const* rhs,
+                           bool useUtf8) {
+  int lWeight = TypeWeight(lhs);
+  int rWeight = TypeWeight(rhs);
+
+  if (lWeight != rWeight) {
+    return (lWeight < rWeight) ? -1 : 1;
+  }
+
+  switch (lhs.type()) {
+    case TYPE_NULL: {
+      return 0;
+    }
+
+    case TYPE_FALSE:
+    case TYPE_TRUE: {
+      if (lhs.getBoolean() == rhs->_value._boolean) {
+        return 0;
+      }
+      return rhs->_value._boolean ? -1 : 1;
+    }
+
+    case TYPE_SMALLINT:
+    case TYPE_NUMBER: {
+      return CompareNumbers(lhs.getNumber(), rhs->_value._number);
+    }
+
+    case TYPE_SHORT_STRING:
+    case TYPE_STRING: {
+      size_t lLength;
+      char const* l = lhs.getString(lLength);
+      return CompareStrings(l, lLength, rhs->_value._string.data, rhs->_value._string.length - 1, useUtf8);
+    }
+
+    case TYPE_ARRAY: {
+      size_t const nl = lhs.length();
+      size_t const nr = TRI_LengthVector(&rhs->_value._objects);
+      size_t const n = (std::max)(nl, nr);
+
+      for (size_t i = 0; i < n; ++i) {
+        int result;
+        if (i >= nl) {
+          // a missing value compares like null
+          result = (TypeWeight(static_cast<TRI_json_t const*>(TRI_AddressVector(&rhs->_value._objects, i))) == 0) ? 0 : -1;
+        }
+        else if (i >= nr) {
+          result = (TypeWeight(lhs.at(i)) == 0) ? 0 : 1;
+        }
+        else {
+          result = Compare(lhs.at(i), static_cast<TRI_json_t const*>(TRI_AddressVector(&rhs->_value._objects, i)), useUtf8);
+        }
+
+        if (result != 0) {
+          return result;
+        }
+      }
+      return 0;
+    }
+
+    case TYPE_OBJECT: {
+      TRI_json_t* l = lhs.toJson(TRI_UNKNOWN_MEM_ZONE);
+
+      if (l == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      int result = TRI_CompareValuesJson(l, rhs, useUtf8);
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, l);
+      return result;
+    }
+  }
+
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read an unaligned uint32_t at the given offset
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t CompactValue::readUInt32 (size_t offset) const {
+  uint32_t value;
+  memcpy(&value, _data + offset, sizeof(uint32_t));
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash the value recursively, mirrors FastHashJsonRecursive()
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t CompactValue::hash (uint64_t hash) const {
+  switch (type()) {
+    case TYPE_NULL: {
+      return fasthash64(static_cast<void const*>("null"), 4, hash);
+    }
+
+    case TYPE_FALSE: {
+      return fasthash64(static_cast<void const*>("false"), 5, hash);
+    }
+
+    case TYPE_TRUE: {
+      return fasthash64(static_cast<void const*>("true"), 4, hash);
+    }
+
+    case TYPE_SMALLINT:
+    case TYPE_NUMBER: {
+      double const value = getNumber();
+      return fasthash64(static_cast<void const*>(&value), sizeof(value), hash);
+    }
+
+    case TYPE_SHORT_STRING:
+    case TYPE_STRING: {
+      // the trailing NUL byte is hashed, too
+      size_t length;
+      char const* p = getString(length);
+      return fasthash64(static_cast<void const*>(p), length + 1, hash);
+    }
+
+    case TYPE_ARRAY: {
+      hash = fasthash64(static_cast<void const*>("array"), 5, hash);
+      size_t const n = length();
+      for (size_t i = 0; i < n; ++i) {
+        hash = at(i).hash(hash);
+      }
+      return hash;
+    }
+
+    case TYPE_OBJECT: {
+      hash = fasthash64(static_cast<void const*>("object"), 6, hash);
+      size_t const n = length();
+      for (size_t i = 0; i < n; ++i) {
+        CompactValue key = keyAt(i);
+        hash = key.hash(hash);
+        hash = CompactValue(key.data() + key.byteSize()).hash(hash);
+      }
+      return hash;
+    }
+  }
+
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              class CompactBuilder
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the builder
+////////////////////////////////////////////////////////////////////////////////
+
+CompactBuilder::CompactBuilder ()
+  : _buffer(nullptr),
+    _size(0),
+    _capacity(0),
+    _stack() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the builder
+////////////////////////////////////////////////////////////////////////////////
+
+CompactBuilder::~CompactBuilder () {
+  if (_buffer != nullptr) {
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, _buffer);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a null value
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addNull () {
+  registerMember();
+  reserve(1);
+  _buffer[_size++] = static_cast<char>(CompactValue::TYPE_NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a boolean value
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addBoolean (bool value) {
+  registerMember();
+  reserve(1);
+  _buffer[_size++] = static_cast<char>(value ? CompactValue::TYPE_TRUE : CompactValue::TYPE_FALSE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a number value, small integers are stored inline
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addNumber (double value) {
+  registerMember();
+
+  // NaN fails both comparisons
+  if (value >= -128.0 && value <= 127.0) {
+    auto small = static_cast<int8_t>(value);
+
+    if (static_cast<double>(small) == value &&
+        ! (value == 0.0 && std::signbit(value))) {
+      reserve(1 + sizeof(int8_t));
+      _buffer[_size++] = static_cast<char>(CompactValue::TYPE_SMALLINT);
+      _buffer[_size++] = static_cast<char>(small);
+      return;
+    }
+  }
+
+  reserve(1 + sizeof(double));
+  _buffer[_size++] = static_cast<char>(CompactValue::TYPE_NUMBER);
+  memcpy(_buffer + _size, &value, sizeof(double));
+  _size += sizeof(double);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a string value
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addString (char const* value,
+                                size_t length) {
+  registerMember();
+  appendString(value, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a TRI_json_t (recursively)
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addJson (TRI_json_t const* json) {
+  TRI_json_type_e const type = (json == nullptr ? TRI_JSON_UNUSED : json->_type);
+
+  switch (type) {
+    case TRI_JSON_UNUSED:
+    case TRI_JSON_NULL: {
+      addNull();
+      break;
+    }
+
+    case TRI_JSON_BOOLEAN: {
+      addBoolean(json->_value._boolean);
+      break;
+    }
+
+    case TRI_JSON_NUMBER: {
+      addNumber(json->_value._number);
+      break;
+    }
+
+    case TRI_JSON_STRING:
+    case TRI_JSON_STRING_REFERENCE: {
+      addString(json->_value._string.data, json->_value._string.length - 1);
+      break;
+    }
+
+    case TRI_JSON_ARRAY: {
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+      openArray(n);
+      for (size_t i = 0; i < n; ++i) {
+        addJson(static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i)));
+      }
+      closeArray();
+      break;
+    }
+
+    case TRI_JSON_OBJECT: {
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+      openObject(n / 2);
+      for (size_t i = 0; i < n; i += 2) {
+        auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i));
+
+        if (! TRI_IsStringJson(key)) {
+          continue;
+        }
+
+        addKey(key->_value._string.data, key->_value._string.length - 1);
+        addJson(static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i + 1)));
+      }
+      closeObject();
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add an existing compact value by copying its bytes
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addValue (CompactValue const& value) {
+  registerMember();
+
+  size_t const size = value.byteSize();
+  reserve(size);
+  memcpy(_buffer + _size, value.data(), size);
+  _size += size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief open an array with at most n members
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::openArray (size_t n) {
+  registerMember();
+
+  size_t const tableSize = n * sizeof(uint32_t);
+  reserve(HeaderSize + tableSize);
+
+  _stack.push_back(Frame({ _size, static_cast<uint32_t>(n), 0, false, false }));
+
+  _buffer[_size++] = static_cast<char>(CompactValue::TYPE_ARRAY);
+  // byte size and number of members are written when the array is closed
+  _size += 2 * sizeof(uint32_t) + tableSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief close the current array
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::closeArray () {
+  TRI_ASSERT(! _stack.empty() && ! _stack.back().isObject);
+  close(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief open an object with at most n members
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::openObject (size_t n) {
+  registerMember();
+
+  size_t const tableSize = 2 * n * sizeof(uint32_t);
+  reserve(HeaderSize + tableSize);
+
+  _stack.push_back(Frame({ _size, static_cast<uint32_t>(n), 0, true, false }));
+
+  _buffer[_size++] = static_cast<char>(CompactValue::TYPE_OBJECT);
+  // byte size, number of members and the sorted index are written when the
+  // object is closed
+  _size += 2 * sizeof(uint32_t) + tableSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add an object key
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::addKey (char const* key,
+                             size_t length) {
+  TRI_ASSERT(! _stack.empty());
+
+  Frame& frame = _stack.back();
+  TRI_ASSERT(frame.isObject);
+  TRI_ASSERT(! frame.expectValue);
+
+  if (frame.count >= frame.capacity) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "too many members for compact object");
+  }
+
+  writeUInt32(frame.start + HeaderSize + frame.count * sizeof(uint32_t), static_cast<uint32_t>(_size - frame.start));
+  ++frame.count;
+
+  // the key is not a member itself, so it is appended directly
+  appendString(key, length);
+  _stack.back().expectValue = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief close the current object
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::closeObject () {
+  TRI_ASSERT(! _stack.empty() && _stack.back().isObject);
+  close(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief steal the finished value
+////////////////////////////////////////////////////////////////////////////////
+
+char* CompactBuilder::steal () {
+  TRI_ASSERT(_stack.empty());
+  TRI_ASSERT(_buffer != nullptr);
+
+  char* result = _buffer;
+  _buffer = nullptr;
+  _size = 0;
+  _capacity = 0;
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure the buffer has room for the specified number of bytes
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::reserve (size_t length) {
+  if (_size + length <= _capacity) {
+    return;
+  }
+
+  size_t capacity = (std::max)(static_cast<size_t>(64), _capacity * 2);
+  while (capacity < _size + length) {
+    capacity *= 2;
+  }
+
+  auto buffer = static_cast<char*>(TRI_Reallocate(TRI_UNKNOWN_MEM_ZONE, _buffer, capacity));
+
+  if (buffer == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  _buffer = buffer;
+  _capacity = capacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a string value without registering it as a member
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::appendString (char const* value,
+                                   size_t length) {
+  if (length <= MaxShortStringLength) {
+    reserve(1 + sizeof(uint8_t) + length + 1);
+    _buffer[_size++] = static_cast<char>(CompactValue::TYPE_SHORT_STRING);
+    _buffer[_size++] = static_cast<char>(static_cast<uint8_t>(length));
+  }
+  else {
+    if (length > static_cast<size_t>(UINT32_MAX)) {
+      THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "string value too long for compact value");
+    }
+
+    reserve(1 + sizeof(uint32_t) + length + 1);
+    _buffer[_size++] = static_cast<char>(CompactValue::TYPE_STRING);
+    appendUInt32(static_cast<uint32_t>(length));
+  }
+
+  memcpy(_buffer + _size, value, length);
+  _size += length;
+  _buffer[_size++] = '\0';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register the next value as a member of the enclosing array, or as
+/// the value for the last key of the enclosing object
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::registerMember () {
+  if (_stack.empty()) {
+    // top-level value
+    TRI_ASSERT(_size == 0);
+    return;
+  }
+
+  Frame& frame = _stack.back();
+
+  if (frame.expectValue) {
+    // value for an object key
+    frame.expectValue = false;
+    return;
+  }
+
+  // objects require a key before each value
+  TRI_ASSERT(! frame.isObject);
+
+  if (frame.count >= frame.capacity) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "too many members for compact array");
+  }
+
+  writeUInt32(frame.start + HeaderSize + frame.count * sizeof(uint32_t), static_cast<uint32_t>(_size - frame.start));
+  ++frame.count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append an unaligned uint32_t, the space must have been reserved
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::appendUInt32 (uint32_t value) {
+  memcpy(_buffer + _size, &value, sizeof(uint32_t));
+  _size += sizeof(uint32_t);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write an unaligned uint32_t at the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::writeUInt32 (size_t position,
+                                  uint32_t value) {
+  memcpy(_buffer + position, &value, sizeof(uint32_t));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read an unaligned uint32_t from the specified position
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t CompactBuilder::readUInt32 (size_t position) const {
+  uint32_t value;
+  memcpy(&value, _buffer + position, sizeof(uint32_t));
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief close the current array or object, this shrinks the offset tables
+/// if fewer members than announced were added and builds the sorted index
+/// table for objects
+////////////////////////////////////////////////////////////////////////////////
+
+void CompactBuilder::close (bool isObject) {
+  Frame const frame = _stack.back();
+  TRI_ASSERT(! frame.expectValue);
+
+  size_t const tables = isObject ? 2 : 1;
+  size_t const unused = tables * (frame.capacity - frame.count) * sizeof(uint32_t);
+
+  if (unused > 0) {
+    size_t const dataStart = frame.start + HeaderSize + tables * frame.capacity * sizeof(uint32_t);
+
+    memmove(_buffer + dataStart - unused, _buffer + dataStart, _size - dataStart);
+    _size -= unused;
+
+    // all members have moved to the front
+    for (uint32_t i = 0; i < frame.count; ++i) {
+      size_t const position = frame.start + HeaderSize + i * sizeof(uint32_t);
+      writeUInt32(position, readUInt32(position) - static_cast<uint32_t>(unused));
+    }
+  }
+
+  if (isObject && frame.count > 0) {
+    std::vector<uint32_t> sorted;
+    sorted.reserve(frame.count);
+
+    for (uint32_t i = 0; i < frame.count; ++i) {
+      sorted.emplace_back(i);
+    }
+
+    char const* base = _buffer + frame.start;
+
+    auto keyOf = [&] (uint32_t index, size_t& length) -> char const* {
+      uint32_t offset;
+      memcpy(&offset, base + HeaderSize + index * sizeof(uint32_t), sizeof(uint32_t));
+      return CompactValue(base + offset).getString(length);
+    };
+
+    std::stable_sort(sorted.begin(), sorted.end(), [&] (uint32_t lhs, uint32_t rhs) -> bool {
+      size_t lLength, rLength;
+      char const* l = keyOf(lhs, lLength);
+      char const* r = keyOf(rhs, rLength);
+
+      int res = memcmp(l, r, (std::min)(lLength, rLength));
+
+      if (res != 0) {
+        return res < 0;
+      }
+      return lLength < rLength;
+    });
+
+    size_t const sortedTable = frame.start + HeaderSize + frame.count * sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < frame.count; ++i) {
+      writeUInt32(sortedTable + i * sizeof(uint32_t), sorted[i]);
+    }
+  }
+
+  if (_size - frame.start > static_cast<size_t>(UINT32_MAX)) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "value too big for compact value");
+  }
+
+  writeUInt32(frame.start + 1, static_cast<uint32_t>(_size - frame.start));
+  writeUInt32(frame.start + 1 + sizeof(uint32_t), frame.count);
+
+  _stack.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
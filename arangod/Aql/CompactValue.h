@@ -0,0 +1,450 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, compact binary value representation
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_COMPACT_VALUE_H
+#define ARANGODB_AQL_COMPACT_VALUE_H 1
+
+#include "Basics/Common.h"
+#include "Basics/json.h"
+
+struct TRI_string_buffer_s;
+
+namespace triagens {
+  namespace aql {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class CompactValue
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-only view on a value in compact binary representation
+///
+/// A compact value is stored in a single contiguous buffer. Every value starts
+/// with a one-byte type tag. Scalars follow their tag inline:
+///
+/// - null, false, true: no payload
+/// - small integer: int8_t
+/// - number: double
+/// - short string: uint8_t length, characters, terminating NUL byte
+/// - string: uint32_t length, characters, terminating NUL byte
+///
+/// Arrays and objects are followed by their total byte size (uint32_t),
+/// their number of members (uint32_t) and a table of uint32_t offsets
+/// relative to the start of the array or object. For objects, each offset
+/// points to a key string that is directly followed by its value, and a
+/// second table contains the member indexes ordered by key bytes so that
+/// attribute lookups can use a binary search.
+///
+/// All multi-byte values are stored unaligned in host byte order. The
+/// representation is meant for in-memory use inside a single process only.
+////////////////////////////////////////////////////////////////////////////////
+
+    class CompactValue {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                          typedefs
+// -----------------------------------------------------------------------------
+
+      public:
+
+        enum ValueType : uint8_t {
+          TYPE_NULL         = 0x00,
+          TYPE_FALSE        = 0x01,
+          TYPE_TRUE         = 0x02,
+          TYPE_SMALLINT     = 0x03,
+          TYPE_NUMBER       = 0x04,
+          TYPE_SHORT_STRING = 0x05,
+          TYPE_STRING       = 0x06,
+          TYPE_ARRAY        = 0x07,
+          TYPE_OBJECT       = 0x08
+        };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+        CompactValue ()
+          : _data(nullptr) {
+        }
+
+        explicit CompactValue (char const* data)
+          : _data(reinterpret_cast<uint8_t const*>(data)) {
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+        inline char const* data () const {
+          return reinterpret_cast<char const*>(_data);
+        }
+
+        inline ValueType type () const {
+          return static_cast<ValueType>(*_data);
+        }
+
+        inline bool isNull () const {
+          return type() == TYPE_NULL;
+        }
+
+        inline bool isBoolean () const {
+          return type() == TYPE_FALSE || type() == TYPE_TRUE;
+        }
+
+        inline bool isNumber () const {
+          return type() == TYPE_SMALLINT || type() == TYPE_NUMBER;
+        }
+
+        inline bool isString () const {
+          return type() == TYPE_SHORT_STRING || type() == TYPE_STRING;
+        }
+
+        inline bool isArray () const {
+          return type() == TYPE_ARRAY;
+        }
+
+        inline bool isObject () const {
+          return type() == TYPE_OBJECT;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the total size of the value in bytes
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t byteSize () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the boolean value, false if the value is not a boolean
+////////////////////////////////////////////////////////////////////////////////
+
+        inline bool getBoolean () const {
+          return type() == TYPE_TRUE;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the numeric value, 0.0 if the value is not a number
+////////////////////////////////////////////////////////////////////////////////
+
+        double getNumber () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a pointer to the NUL-terminated string value and its length
+/// (not including the NUL byte), nullptr if the value is not a string
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* getString (size_t&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of members of an array or object, 0 otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t length () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the array member at the given position
+////////////////////////////////////////////////////////////////////////////////
+
+        CompactValue at (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the object key at the given position (insertion order)
+////////////////////////////////////////////////////////////////////////////////
+
+        CompactValue keyAt (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the object value at the given position (insertion order)
+////////////////////////////////////////////////////////////////////////////////
+
+        CompactValue valueAt (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up an attribute in an object, returns false if the value is
+/// not an object or does not contain the attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        bool get (char const*,
+                  size_t,
+                  CompactValue&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert the value into a TRI_json_t tree
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t* toJson (TRI_memory_zone_t*) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize an already allocated TRI_json_t with the value
+////////////////////////////////////////////////////////////////////////////////
+
+        int toJson (TRI_memory_zone_t*,
+                    TRI_json_t*) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stringify the value into a string buffer, the output is identical
+/// to TRI_StringifyJson() on the equivalent TRI_json_t
+////////////////////////////////////////////////////////////////////////////////
+
+        int stringify (struct TRI_string_buffer_s*) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash the value, the result is identical to TRI_FastHashJson() on
+/// the equivalent TRI_json_t
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t hash () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a standalone copy of the value, the returned buffer must be
+/// freed with TRI_Free(TRI_UNKNOWN_MEM_ZONE, ...)
+////////////////////////////////////////////////////////////////////////////////
+
+        char* copy () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 3-way comparison of two compact values, using the same sort order
+/// as TRI_CompareValuesJson()
+////////////////////////////////////////////////////////////////////////////////
+
+        static int Compare (CompactValue const&,
+                            CompactValue const&,
+                            bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 3-way comparison of a compact value with a TRI_json_t, using the
+/// same sort order as TRI_CompareValuesJson()
+////////////////////////////////////////////////////////////////////////////////
+
+        static int Compare (CompactValue const&,
+                            TRI_json_t const*,
+                            bool);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+        uint32_t readUInt32 (size_t) const;
+
+        uint64_t hash (uint64_t) const;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start of the value
+////////////////////////////////////////////////////////////////////////////////
+
+        uint8_t const* _data;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              class CompactBuilder
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builds a value in compact binary representation
+///
+/// Arrays and objects must be opened with an upper bound for their number of
+/// members, which is used to reserve their offset tables. If fewer members
+/// are added, the tables are shrunk when the array or object is closed.
+////////////////////////////////////////////////////////////////////////////////
+
+    class CompactBuilder {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        CompactBuilder (CompactBuilder const&) = delete;
+        CompactBuilder& operator= (CompactBuilder const&) = delete;
+
+        CompactBuilder ();
+
+        ~CompactBuilder ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+        void addNull ();
+
+        void addBoolean (bool);
+
+        void addNumber (double);
+
+        void addString (char const*,
+                        size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a TRI_json_t (recursively), a nullptr is added as null
+////////////////////////////////////////////////////////////////////////////////
+
+        void addJson (TRI_json_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add an existing compact value by copying its bytes
+////////////////////////////////////////////////////////////////////////////////
+
+        void addValue (CompactValue const&);
+
+        void openArray (size_t);
+
+        void closeArray ();
+
+        void openObject (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add an object key, must be followed by exactly one value
+////////////////////////////////////////////////////////////////////////////////
+
+        void addKey (char const*,
+                     size_t);
+
+        void closeObject ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the finished value
+////////////////////////////////////////////////////////////////////////////////
+
+        inline CompactValue value () const {
+          TRI_ASSERT(_stack.empty());
+          return CompactValue(_buffer);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief steal the finished value, the returned buffer must be freed with
+/// TRI_Free(TRI_UNKNOWN_MEM_ZONE, ...)
+////////////////////////////////////////////////////////////////////////////////
+
+        char* steal ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of bytes of the finished value
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t size () const {
+          TRI_ASSERT(_stack.empty());
+          return _size;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief discard the contents of the builder, but keep its buffer for 
+/// building the next value
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void clear () {
+          _size = 0;
+          _stack.clear();
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+        void reserve (size_t);
+
+        void appendString (char const*,
+                           size_t);
+
+        void registerMember ();
+
+        void appendUInt32 (uint32_t);
+
+        void writeUInt32 (size_t,
+                          uint32_t);
+
+        uint32_t readUInt32 (size_t) const;
+
+        void close (bool);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief an open array or object
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Frame {
+          size_t   start;
+          uint32_t capacity;
+          uint32_t count;
+          bool     isObject;
+          bool     expectValue;
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the output buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        char* _buffer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes used in the output buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _size;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes allocated for the output buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _capacity;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief currently open arrays and objects
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Frame> _stack;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
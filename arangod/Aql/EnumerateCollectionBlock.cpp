@@ -29,6 +29,7 @@
 #include "Aql/AqlItemBlock.h"
 #include "Aql/CollectionScanner.h"
 #include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
 #include "Basics/Exceptions.h"
 #include "VocBase/vocbase.h"
 
@@ -47,6 +48,8 @@ EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
   : ExecutionBlock(engine, ep),
     _collection(ep->_collection),
     _scanner(nullptr),
+    _filter(nullptr),
+    _scannedDocuments(0),
     _posInDocuments(0),
     _random(ep->_random),
     _mustStoreResult(true) {
@@ -56,17 +59,38 @@ EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
     _trx->orderDitch(trxCollection);
   }
 
+  size_t const scanThreads = engine->getQuery()->scanThreads();
+
   if (_random) {
     // random scan
     _scanner = new RandomCollectionScanner(_trx, trxCollection);
   }
+  else if (scanThreads > 1 &&
+           trxCollection != nullptr &&
+           ep->isParallel()) {
+    // parallel scan. the optimizer only allows this for read-only scans that
+    // are executed once per query. the scanner will evaluate the filter 
+    // condition itself
+    _scanner = new ParallelCollectionScanner(_trx, trxCollection, scanThreads, ep->filter(), ep->_outVariable);
+  }
   else {
     // default: linear scan
     _scanner = new LinearCollectionScanner(_trx, trxCollection);
+
+    if (ep->filter() != nullptr) {
+      try {
+        _filter = new CollectionScanFilter(_trx, _trx->documentCollection(_collection->cid()), ep->filter(), ep->_outVariable);
+      }
+      catch (...) {
+        delete _scanner;
+        throw;
+      }
+    }
   }
 }
 
 EnumerateCollectionBlock::~EnumerateCollectionBlock () {
+  delete _filter;
   delete _scanner;
 }
 
@@ -78,6 +102,7 @@ void EnumerateCollectionBlock::initializeDocuments () {
   _scanner->reset();
   _documents.clear();
   _posInDocuments = 0;
+  _scannedDocuments = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,17 +123,40 @@ bool EnumerateCollectionBlock::moreDocuments (size_t hint) {
   std::vector<TRI_doc_mptr_copy_t> newDocs;
   newDocs.reserve(hint);
 
-  int res = _scanner->scan(newDocs, hint);
+  auto parallel = dynamic_cast<ParallelCollectionScanner*>(_scanner);
 
-  if (res != TRI_ERROR_NO_ERROR) {
-    THROW_ARANGO_EXCEPTION(res);
-  }
+  do {
+    int res = _scanner->scan(newDocs, hint);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(res);
+    }
   
-  if (newDocs.empty()) {
-    return false;
-  }
+    if (newDocs.empty()) {
+      // scan is exhausted
+      return false;
+    }
+
+    if (parallel != nullptr) {
+      // the parallel scanner has already applied the filter
+      uint64_t const scanned = parallel->scannedDocuments - _scannedDocuments;
+      _scannedDocuments = parallel->scannedDocuments;
+      _engine->_stats.scannedFull += static_cast<int64_t>(scanned);
+      _engine->_stats.filtered += static_cast<int64_t>(scanned - newDocs.size());
+    }
+    else {
+      size_t const scanned = newDocs.size();
+      _engine->_stats.scannedFull += static_cast<int64_t>(scanned);
 
-  _engine->_stats.scannedFull += static_cast<int64_t>(newDocs.size());
+      if (_filter != nullptr) {
+        _filter->apply(newDocs);
+        _engine->_stats.filtered += static_cast<int64_t>(scanned - newDocs.size());
+      }
+    }
+
+    throwIfKilled(); 
+  }
+  while (newDocs.empty());
 
   _documents.swap(newDocs);
   _posInDocuments = 0;
@@ -272,7 +320,7 @@ size_t EnumerateCollectionBlock::skipSome (size_t atLeast, size_t atMost) {
         initializeDocuments();
         if (++_pos >= cur->size()) {
           _buffer.pop_front();  // does not throw
-          delete cur;
+          returnBlock(cur);
           _pos = 0;
         }
       }
@@ -39,6 +39,8 @@ namespace triagens {
 
     class AqlItemBlock;
 
+    class CollectionScanFilter;
+
     struct CollectionScanner;
 
     class ExecutionEngine;
@@ -112,6 +114,20 @@ namespace triagens {
 
         CollectionScanner* _scanner;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filter condition embedded into the scan, evaluated here if the
+/// scanner does not evaluate it itself
+////////////////////////////////////////////////////////////////////////////////
+
+        CollectionScanFilter* _filter;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of documents scanned by a parallel scanner so far, used for
+/// updating the statistics
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _scannedDocuments;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief document buffer
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,6 +123,15 @@ AqlItemBlock* EnumerateListBlock::getSome (size_t, size_t atMost) {
         break;
       }
 
+      case AqlValue::COMPACT: {
+        CompactValue value(inVarReg._compact);
+        if (! value.isArray()) {
+          throwArrayExpectedException();
+        }
+        sizeInVar = value.length();
+        break;
+      }
+
       case AqlValue::RANGE: {
         sizeInVar = inVarReg._range->size();
         break;
@@ -160,7 +169,7 @@ AqlItemBlock* EnumerateListBlock::getSome (size_t, size_t atMost) {
       size_t toSend = (std::min)(atMost, sizeInVar - _index);
 
       // create the result
-      res.reset(new AqlItemBlock(toSend, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+      res.reset(requestBlock(toSend, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
       inheritRegisters(cur, res.get(), _pos);
 
@@ -200,7 +209,7 @@ AqlItemBlock* EnumerateListBlock::getSome (size_t, size_t atMost) {
       _seen = 0;
       // advance read position in the current block . . .
       if (++_pos == cur->size()) {
-        delete cur;
+        returnBlock(cur);
         _buffer.pop_front();  // does not throw
         _pos = 0;
       }
@@ -248,6 +257,15 @@ size_t EnumerateListBlock::skipSome (size_t atLeast, size_t atMost) {
         break;
       }
 
+      case AqlValue::COMPACT: {
+        CompactValue value(inVarReg._compact);
+        if (! value.isArray()) {
+          throwArrayExpectedException();
+        }
+        sizeInVar = value.length();
+        break;
+      }
+
       case AqlValue::RANGE: {
         sizeInVar = inVarReg._range->size();
         break;
@@ -282,7 +300,7 @@ size_t EnumerateListBlock::skipSome (size_t atLeast, size_t atMost) {
       _index = 0;
       _thisblock = 0;
       _seen = 0;
-      delete cur;
+      returnBlock(cur);
       _buffer.pop_front();
       _pos = 0;
     }
@@ -309,6 +327,10 @@ AqlValue EnumerateListBlock::getAqlValue (AqlValue const& inVarReg) {
     case AqlValue::RANGE: {
       return AqlValue(new Json(static_cast<double>(inVarReg._range->at(_index++))));
     }
+    case AqlValue::COMPACT: {
+      // members of a compact array are copied as compact values
+      return AqlValue(CompactValue(inVarReg._compact).at(_index++).copy());
+    }
     case AqlValue::DOCVEC: { // incoming doc vec has a single column
       AqlValue out = inVarReg._vector->at(_thisblock)->getValue(_index -
                                                                 _seen, 0).clone();
@@ -494,7 +494,7 @@ int ExecutionBlock::getOrSkipSome (size_t atLeast,
           more.release();
         }
         skipped += cur->size() - _pos;
-        delete cur;
+        returnBlock(cur);
         _buffer.pop_front();
         _pos = 0;
       }
@@ -510,7 +510,7 @@ int ExecutionBlock::getOrSkipSome (size_t atLeast,
           collector.emplace_back(cur);
         }
         else {
-          delete cur;
+          returnBlock(cur);
         }
         _buffer.pop_front();
         _pos = 0;
@@ -38,6 +38,7 @@
 #include "Aql/ExecutionBlock.h"
 #include "Aql/ExecutionNode.h"
 #include "Aql/ExecutionPlan.h"
+#include "Aql/HashJoinBlock.h"
 #include "Aql/IndexRangeBlock.h"
 #include "Aql/ModificationBlock.h"
 #include "Aql/QueryRegistry.h"
@@ -71,6 +72,10 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
       return new EnumerateCollectionBlock(engine,
                                           static_cast<EnumerateCollectionNode const*>(en));
     }
+    case ExecutionNode::HASH_JOIN: {
+      return new HashJoinBlock(engine,
+                               static_cast<HashJoinNode const*>(en));
+    }
     case ExecutionNode::ENUMERATE_LIST: {
       return new EnumerateListBlock(engine,
                                     static_cast<EnumerateListNode const*>(en));
@@ -186,6 +191,7 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
 
 ExecutionEngine::ExecutionEngine (Query* query)
   : _stats(),
+    _itemBlockManager(query->resourceMonitor(), &_stats),
     _blocks(),
     _root(nullptr),
     _query(query),
@@ -75,7 +75,8 @@ std::unordered_map<int, std::string const> const ExecutionNode::TypeNames{
   { static_cast<int>(DISTRIBUTE),                   "DistributeNode" },
   { static_cast<int>(GATHER),                       "GatherNode" },
   { static_cast<int>(NORESULTS),                    "NoResultsNode" },
-  { static_cast<int>(UPSERT),                       "UpsertNode" }
+  { static_cast<int>(UPSERT),                       "UpsertNode" },
+  { static_cast<int>(HASH_JOIN),                    "HashJoinNode" }
 };
           
 // -----------------------------------------------------------------------------
@@ -210,6 +211,11 @@ ExecutionNode* ExecutionNode::fromJsonFactory (ExecutionPlan* plan,
         node->specialized();
       }
 
+      Variable* countVariable = varFromJson(plan->getAst(), oneNode, "countVariable", Optional);
+      if (countVariable != nullptr) {
+        node->setCountVariable(countVariable);
+      }
+
       return node;
     }
     case INSERT:
@@ -228,6 +234,8 @@ ExecutionNode* ExecutionNode::fromJsonFactory (ExecutionPlan* plan,
       return new NoResultsNode(plan, oneNode);
     case INDEX_RANGE:
       return new IndexRangeNode(plan, oneNode);
+    case HASH_JOIN:
+      return new HashJoinNode(plan, oneNode);
     case REMOTE:
       return new RemoteNode(plan, oneNode);
     case GATHER: {
@@ -928,6 +936,21 @@ void ExecutionNode::RegisterPlan::after (ExecutionNode *en) {
       break;
     }
 
+    case ExecutionNode::HASH_JOIN: {
+      depth++;
+      nrRegsHere.emplace_back(1);
+      // create a copy of the last value here
+      // this is requried because back returns a reference and emplace/push_back may invalidate all references
+      RegisterId registerId = 1 + nrRegs.back();
+      nrRegs.emplace_back(registerId);
+
+      auto ep = static_cast<HashJoinNode const*>(en);
+      TRI_ASSERT(ep != nullptr);
+      varInfo.emplace(ep->_outVariable->id, VarInfo(depth, totalNrRegs));
+      totalNrRegs++;
+      break;
+    }
+
     case ExecutionNode::ENUMERATE_LIST: {
       depth++;
       nrRegsHere.emplace_back(1);
@@ -1194,7 +1217,34 @@ EnumerateCollectionNode::EnumerateCollectionNode (ExecutionPlan* plan,
     _vocbase(plan->getAst()->query()->vocbase()),
     _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))),
     _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
-    _random(JsonHelper::checkAndGetBooleanValue(base.json(), "random")) {
+    _random(JsonHelper::checkAndGetBooleanValue(base.json(), "random")),
+    _parallel(JsonHelper::getBooleanValue(base.json(), "parallel", false)),
+    _filter(nullptr) {
+
+  triagens::basics::Json filter = base.get("filter");
+
+  if (filter.isObject()) {
+    _filter = new Expression(plan->getAst(), new AstNode(plan->getAst(), filter));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destructor, for EnumerateCollectionNode
+////////////////////////////////////////////////////////////////////////////////
+
+EnumerateCollectionNode::~EnumerateCollectionNode () {
+  delete _filter;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the filter condition evaluated during the scan
+////////////////////////////////////////////////////////////////////////////////
+
+void EnumerateCollectionNode::setFilter (Expression* filter) {
+  if (filter != _filter) {
+    delete _filter;
+    _filter = filter;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1214,7 +1264,12 @@ void EnumerateCollectionNode::toJsonHelper (triagens::basics::Json& nodes,
   json("database", triagens::basics::Json(_vocbase->_name))
       ("collection", triagens::basics::Json(_collection->getName()))
       ("outVariable", _outVariable->toJson())
-      ("random", triagens::basics::Json(_random));
+      ("random", triagens::basics::Json(_random))
+      ("parallel", triagens::basics::Json(_parallel));
+
+  if (_filter != nullptr) {
+    json("filter", _filter->toJson(TRI_UNKNOWN_MEM_ZONE, verbose));
+  }
 
   // And add it:
   nodes(json);
@@ -1234,6 +1289,16 @@ ExecutionNode* EnumerateCollectionNode::clone (ExecutionPlan* plan,
   }
     
   auto c = new EnumerateCollectionNode(plan, _id, _vocbase, _collection, outVariable, _random);
+  c->_parallel = _parallel;
+
+  if (_filter != nullptr) {
+    c->setFilter(_filter->clone());
+
+    if (outVariable != _outVariable) {
+      std::unordered_map<VariableId, Variable const*> replacements{ { _outVariable->id, outVariable } };
+      c->_filter->replaceVariables(replacements);
+    }
+  }
 
   cloneHelper(c, plan, withDependencies, withProperties);
 
@@ -1376,6 +1441,92 @@ double EnumerateCollectionNode::estimateCost (size_t& nrItems) const {
   return depCost + nrItems * (_random ? 1.005 : 1.0);
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                           methods of HashJoinNode
+// -----------------------------------------------------------------------------
+
+HashJoinNode::HashJoinNode (ExecutionPlan* plan,
+                            triagens::basics::Json const& base)
+  : ExecutionNode(plan, base),
+    _vocbase(plan->getAst()->query()->vocbase()),
+    _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))),
+    _inVariable(varFromJson(plan->getAst(), base, "inVariable")),
+    _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
+    _attribute(JsonHelper::stringArray(JsonHelper::checkAndGetArrayValue(base.json(), "attribute"))) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief toJson, for HashJoinNode
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinNode::toJsonHelper (triagens::basics::Json& nodes,
+                                 TRI_memory_zone_t* zone,
+                                 bool verbose) const {
+  triagens::basics::Json json(ExecutionNode::toJsonHelperGeneric(nodes, zone, verbose));  // call base class method
+
+  if (json.isEmpty()) {
+    return;
+  }
+
+  triagens::basics::Json attribute(triagens::basics::Json::Array, _attribute.size());
+  for (auto const& it : _attribute) {
+    attribute(triagens::basics::Json(it));
+  }
+
+  json("database", triagens::basics::Json(_vocbase->_name))
+      ("collection", triagens::basics::Json(_collection->getName()))
+      ("inVariable", _inVariable->toJson())
+      ("outVariable", _outVariable->toJson())
+      ("attribute", attribute);
+
+  // And add it:
+  nodes(json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+ExecutionNode* HashJoinNode::clone (ExecutionPlan* plan,
+                                    bool withDependencies,
+                                    bool withProperties) const {
+  auto outVariable = _outVariable;
+  auto inVariable = _inVariable;
+
+  if (withProperties) {
+    outVariable = plan->getAst()->variables()->createVariable(outVariable);
+    inVariable = plan->getAst()->variables()->createVariable(inVariable);
+  }
+    
+  auto c = new HashJoinNode(plan, _id, _vocbase, _collection, inVariable, outVariable, _attribute);
+
+  cloneHelper(c, plan, withDependencies, withProperties);
+
+  return static_cast<ExecutionNode*>(c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a hash join node is the cost of building the hash 
+/// table once plus the cost of one lookup per incoming item
+////////////////////////////////////////////////////////////////////////////////
+        
+double HashJoinNode::estimateCost (size_t& nrItems) const { 
+  // same heuristic as used for non-unique hash indexes without selectivity
+  // estimate 
+  static double const EqualityReductionFactor = 100.0;
+  // building the hash table is more expensive than simply scanning the 
+  // collection
+  static double const BuildFactor = 1.5;
+
+  size_t incoming;
+  double depCost = _dependencies.at(0)->getCost(incoming);
+  size_t count = _collection->count();
+
+  nrItems = incoming * (std::max)(static_cast<size_t>(count / EqualityReductionFactor), static_cast<size_t>(1));
+
+  return depCost + count * BuildFactor + incoming + nrItems;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      methods of EnumerateListNode
 // -----------------------------------------------------------------------------
@@ -1485,6 +1636,43 @@ double EnumerateListNode::estimateCost (size_t& nrItems) const {
 // --SECTION--                                         methods of IndexRangeNode
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert the ranges of an index lookup to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::Json RangesToJson (std::vector<std::vector<RangeInfo>> const& orRanges) {
+  triagens::basics::Json ranges(triagens::basics::Json::Array, orRanges.size());
+
+  for (auto const& x : orRanges) {
+    triagens::basics::Json range(triagens::basics::Json::Array, x.size());
+    for (auto const& y : x) {
+      range.add(y.toJson());
+    }
+    ranges.add(range);
+  }
+
+  return ranges;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the ranges of an index lookup from JSON
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<std::vector<RangeInfo>> RangesFromJson (triagens::basics::Json const& rangeArrayJson) {
+  std::vector<std::vector<RangeInfo>> result;
+
+  for (size_t i = 0; i < rangeArrayJson.size(); i++) { //loop over the ranges . . .
+    result.emplace_back();
+
+    triagens::basics::Json rangeJson(rangeArrayJson.at(static_cast<int>(i)));
+    for (size_t j = 0; j < rangeJson.size(); j++) {
+      result.at(i).emplace_back(rangeJson.at(static_cast<int>(j)));
+    }
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief toJson, for IndexRangeNode
 ////////////////////////////////////////////////////////////////////////////////
@@ -1500,15 +1688,7 @@ void IndexRangeNode::toJsonHelper (triagens::basics::Json& nodes,
   }
 
   // put together the range info . . .
-  triagens::basics::Json ranges(triagens::basics::Json::Array, _ranges.size());
-
-  for (auto const& x : _ranges) {
-    triagens::basics::Json range(triagens::basics::Json::Array, x.size());
-    for(auto const& y : x) {
-      range.add(y.toJson());
-    }
-    ranges.add(range);
-  }
+  triagens::basics::Json ranges(RangesToJson(_ranges));
 
   // Now put info about vocbase and cid in there
   json("database", triagens::basics::Json(_vocbase->_name))
@@ -1519,6 +1699,28 @@ void IndexRangeNode::toJsonHelper (triagens::basics::Json& nodes,
   json("index", _index->toJson()); 
   json("reverse", triagens::basics::Json(_reverse));
 
+  // the other indexes used for index intersection or union
+  char const* combination = "none";
+  if (_combination == INDEX_COMBINATION_INTERSECTION) {
+    combination = "intersection";
+  }
+  else if (_combination == INDEX_COMBINATION_UNION) {
+    combination = "union";
+  }
+
+  triagens::basics::Json lookups(triagens::basics::Json::Array, _additionalLookups.size());
+
+  for (auto const& it : _additionalLookups) {
+    triagens::basics::Json lookup(triagens::basics::Json::Object, 2);
+    lookup("index", it.index->toJson())
+          ("ranges", RangesToJson(it.ranges));
+    lookups.add(lookup);
+  }
+
+  json("combination", triagens::basics::Json(combination))
+      ("additionalLookups", lookups)
+      ("covering", triagens::basics::Json(_covering));
+
   // And add it:
   nodes(json);
 }
@@ -1544,6 +1746,12 @@ ExecutionNode* IndexRangeNode::clone (ExecutionPlan* plan,
   auto c = new IndexRangeNode(plan, _id, _vocbase, _collection, 
                               outVariable, _index, ranges, _reverse);
 
+  if (_combination != INDEX_COMBINATION_NONE) {
+    c->combineWith(_combination, _additionalLookups);
+  }
+
+  c->setCovering(_covering);
+
   cloneHelper(c, plan, withDependencies, withProperties);
 
   return static_cast<ExecutionNode*>(c);
@@ -1561,18 +1769,13 @@ IndexRangeNode::IndexRangeNode (ExecutionPlan* plan,
     _outVariable(varFromJson(plan->getAst(), json, "outVariable")),
     _index(nullptr), 
     _ranges(),
-    _reverse(false) {
+    _reverse(false),
+    _combination(INDEX_COMBINATION_NONE),
+    _additionalLookups(),
+    _covering(JsonHelper::getBooleanValue(json.json(), "covering", false)) {
 
   triagens::basics::Json rangeArrayJson(TRI_UNKNOWN_MEM_ZONE, JsonHelper::checkAndGetArrayValue(json.json(), "ranges"));
-
-  for (size_t i = 0; i < rangeArrayJson.size(); i++) { //loop over the ranges . . .
-    _ranges.emplace_back();
-
-    triagens::basics::Json rangeJson(rangeArrayJson.at(static_cast<int>(i)));
-    for (size_t j = 0; j < rangeJson.size(); j++) {
-      _ranges.at(i).emplace_back(rangeJson.at(static_cast<int>(j)));
-    }
-  }
+  _ranges = RangesFromJson(rangeArrayJson);
 
   // now the index . . . 
   // TODO the following could be a constructor method for
@@ -1586,6 +1789,61 @@ IndexRangeNode::IndexRangeNode (ExecutionPlan* plan,
   if (_index == nullptr) {
     THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "index not found");
   }
+
+  // other indexes (optional, only present for index intersection or union)
+  std::string const combination = JsonHelper::getStringValue(json.json(), "combination", "none");
+
+  if (combination == "intersection") {
+    _combination = INDEX_COMBINATION_INTERSECTION;
+  }
+  else if (combination == "union") {
+    _combination = INDEX_COMBINATION_UNION;
+  }
+
+  auto lookups = JsonHelper::getObjectElement(json.json(), "additionalLookups");
+
+  if (_combination != INDEX_COMBINATION_NONE && JsonHelper::isArray(lookups)) {
+    size_t const n = TRI_LengthArrayJson(lookups);
+
+    for (size_t i = 0; i < n; ++i) {
+      auto lookup = static_cast<TRI_json_t const*>(TRI_AtVector(&lookups->_value._objects, i));
+      auto index = JsonHelper::checkAndGetObjectValue(lookup, "index");
+      auto iid   = JsonHelper::checkAndGetStringValue(index, "id");
+
+      IndexLookup l;
+      l.index = _collection->getIndex(iid);
+
+      if (l.index == nullptr) {
+        THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "index not found");
+      }
+
+      triagens::basics::Json ranges(TRI_UNKNOWN_MEM_ZONE, JsonHelper::checkAndGetArrayValue(lookup, "ranges"));
+      l.ranges = RangesFromJson(ranges);
+
+      _additionalLookups.emplace_back(std::move(l));
+    }
+  }
+
+  if (_additionalLookups.empty()) {
+    _combination = INDEX_COMBINATION_NONE;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief combine the node's index with lookups in other indexes
+////////////////////////////////////////////////////////////////////////////////
+
+void IndexRangeNode::combineWith (IndexCombination combination,
+                                  std::vector<IndexLookup> const& lookups) {
+  TRI_ASSERT(combination != INDEX_COMBINATION_NONE);
+  TRI_ASSERT(! lookups.empty());
+
+  _combination = combination;
+  _additionalLookups.clear();
+
+  for (auto const& it : lookups) {
+    _additionalLookups.emplace_back(IndexLookup{ it.index, it.ranges });
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1593,6 +1851,11 @@ IndexRangeNode::IndexRangeNode (ExecutionPlan* plan,
 ////////////////////////////////////////////////////////////////////////////////
 
 ExecutionNode::IndexMatch IndexRangeNode::matchesIndex (IndexMatchVec const& pattern) const {
+  if (_combination != INDEX_COMBINATION_NONE) {
+    // combined index results are not sorted by any index
+    return IndexMatch();
+  }
+
   return CompareIndex(this, _index, pattern);
 }
 
@@ -1602,49 +1865,92 @@ ExecutionNode::IndexMatch IndexRangeNode::matchesIndex (IndexMatchVec const& pat
 ////////////////////////////////////////////////////////////////////////////////
  
 double IndexRangeNode::estimateCost (size_t& nrItems) const { 
-  static double const EqualityReductionFactor = 100.0;
+  // all lookups of a combined index access are executed completely, but
+  // only pointers to the found documents are collected. the documents
+  // themselves are only accessed after combining the results
+  static double const CombinedLookupCostFactor = 0.1;
 
   size_t incoming = 0;
   double const dependencyCost = _dependencies.at(0)->getCost(incoming);
+
+  if (_combination == INDEX_COMBINATION_NONE) {
+    return dependencyCost + estimateLookupCost(_index, _ranges, incoming, nrItems);
+  }
+
+  double const total = static_cast<double>((std::max)(incoming, static_cast<size_t>(1))) *
+                       static_cast<double>((std::max)(_collection->count(), static_cast<size_t>(1)));
+  
+  size_t items = 0;
+  double lookupCost = estimateLookupCost(_index, _ranges, incoming, items);
+  double estimate = static_cast<double>(items);
+
+  for (auto const& it : _additionalLookups) {
+    lookupCost += estimateLookupCost(it.index, it.ranges, incoming, items);
+
+    if (_combination == INDEX_COMBINATION_INTERSECTION) {
+      // assume the indexed attributes are independent
+      estimate *= (std::min)(static_cast<double>(items) / total, 1.0);
+    }
+    else {
+      estimate += static_cast<double>(items);
+    }
+  }
+
+  estimate = (std::min)(estimate, total);
+  nrItems = (std::max)(static_cast<size_t>(estimate), static_cast<size_t>(1));
+
+  return dependencyCost + lookupCost * CombinedLookupCostFactor + static_cast<double>(nrItems);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the cost and number of items for a lookup in one index
+////////////////////////////////////////////////////////////////////////////////
+
+double IndexRangeNode::estimateLookupCost (Index const* index,
+                                           std::vector<std::vector<RangeInfo>> const& ranges,
+                                           size_t incoming,
+                                           size_t& nrItems) const {
+  static double const EqualityReductionFactor = 100.0;
+
   size_t docCount = _collection->count();
 
-  TRI_ASSERT(! _ranges.empty());
+  TRI_ASSERT(! ranges.empty());
   
-  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+  if (index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
     // always an equality lookup
 
     // selectivity of primary index is always 1
-    nrItems = incoming * _ranges.size();
-    return dependencyCost + nrItems;
+    nrItems = incoming * ranges.size();
+    return nrItems;
   }
   
-  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
+  if (index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
     // always an equality lookup
     
     // check if the index can provide a selectivity estimate
-    if (! estimateItemsWithIndexSelectivity(incoming, nrItems)) {
+    if (! estimateItemsWithIndexSelectivity(index, ranges, incoming, nrItems)) {
       // use hard-coded heuristic
-      nrItems = incoming * _ranges.size() * docCount / static_cast<size_t>(EqualityReductionFactor);
+      nrItems = incoming * ranges.size() * docCount / static_cast<size_t>(EqualityReductionFactor);
     }
         
     nrItems = (std::max)(nrItems, static_cast<size_t>(1));
 
-    return dependencyCost + nrItems;
+    return nrItems;
   }
 
-  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+  if (index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
     // always an equality lookup
 
     // check if the index can provide a selectivity estimate
-    if (! estimateItemsWithIndexSelectivity(incoming, nrItems)) {
+    if (! estimateItemsWithIndexSelectivity(index, ranges, incoming, nrItems)) {
       // use hard-coded heuristic
-      if (_index->unique) {
-        nrItems = incoming * _ranges.size();
+      if (index->unique) {
+        nrItems = incoming * ranges.size();
       }
       else {
-        double cost = static_cast<double>(docCount) * incoming * _ranges.size();
+        double cost = static_cast<double>(docCount) * incoming * ranges.size();
         // the more attributes are contained in the index, the more specific the lookup will be
-        for (size_t i = 0; i < _ranges.at(0).size(); ++i) { 
+        for (size_t i = 0; i < ranges.at(0).size(); ++i) { 
           cost /= EqualityReductionFactor; 
         }
     
@@ -1654,26 +1960,26 @@ double IndexRangeNode::estimateCost (size_t& nrItems) const {
         
     nrItems = (std::max)(nrItems, static_cast<size_t>(1));
     // the more attributes an index matches, the better it is
-    double matchLengthFactor = _ranges.at(0).size() * 0.01;
+    double matchLengthFactor = ranges.at(0).size() * 0.01;
 
     // this is to prefer the hash index over skiplists if everything else is equal
-    return dependencyCost + ((static_cast<double>(nrItems) - matchLengthFactor) * 0.9999995);
+    return ((static_cast<double>(nrItems) - matchLengthFactor) * 0.9999995);
   }
 
-  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
-    auto const count = _ranges.at(0).size();
+  if (index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+    auto const count = ranges.at(0).size();
     
     if (count == 0) {
       // no ranges? so this is unlimited -> has to be more expensive
       nrItems = incoming * docCount;
-      return dependencyCost + nrItems;
+      return nrItems;
     }
 
-    if (_index->unique) {
+    if (index->unique) {
       bool allEquality = true;
-      for (auto const& x : _ranges) {
+      for (auto const& x : ranges) {
         // check if we are using all indexed attributes in the query
-        if (x.size() != _index->fields.size()) {
+        if (x.size() != index->fields.size()) {
           allEquality = false;
           break;
         }
@@ -1687,15 +1993,15 @@ double IndexRangeNode::estimateCost (size_t& nrItems) const {
 
       if (allEquality) {
         // unique index, all attributes compared using eq (==) operator
-        nrItems = incoming * _ranges.size();
-        return dependencyCost + nrItems;
+        nrItems = incoming * ranges.size();
+        return nrItems;
       }
     }
 
     // build a total cost for the index usage by peeking into all ranges
     double totalCost = 0.0;
 
-    for (auto const& x : _ranges) {
+    for (auto const& x : ranges) {
       double cost = static_cast<double>(docCount) * incoming;
 
       for (auto const& y : x) { //only doing the 1-d case so far
@@ -1743,12 +2049,12 @@ double IndexRangeNode::estimateCost (size_t& nrItems) const {
 
     nrItems = static_cast<size_t>(totalCost);
 
-    return dependencyCost + totalCost;
+    return totalCost;
   }
 
   // no index
   nrItems = incoming * docCount;
-  return dependencyCost + nrItems;
+  return nrItems;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1798,22 +2104,24 @@ void IndexRangeNode::getVariablesUsedHere (std::unordered_set<Variable const*>&
 /// selectivity info (if present)
 ////////////////////////////////////////////////////////////////////////////////
 
-bool IndexRangeNode::estimateItemsWithIndexSelectivity (size_t incoming,
+bool IndexRangeNode::estimateItemsWithIndexSelectivity (Index const* index,
+                                                        std::vector<std::vector<RangeInfo>> const& ranges,
+                                                        size_t incoming,
                                                         size_t& nrItems) const {
   // check if the index can provide a selectivity estimate
-  if (! _index->hasSelectivityEstimate()) {
+  if (! index->hasSelectivityEstimate()) {
     return false; 
   }
 
   // use index selectivity estimate
-  double estimate = _index->selectivityEstimate();
+  double estimate = index->selectivityEstimate();
 
   if (estimate <= 0.0) {
     // avoid DIV0
     return false;
   }
 
-  nrItems = static_cast<size_t>(incoming * _ranges.size() * (1.0 / estimate));
+  nrItems = static_cast<size_t>(incoming * ranges.size() * (1.0 / estimate));
   return true;
 }
 
@@ -1939,7 +2247,8 @@ SubqueryNode::SubqueryNode (ExecutionPlan* plan,
                             triagens::basics::Json const& base)
   : ExecutionNode(plan, base),
     _subquery(nullptr),
-    _outVariable(varFromJson(plan->getAst(), base, "outVariable")) {
+    _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
+    _outerKeyVariable(varFromJson(plan->getAst(), base, "outerKeyVariable", true)) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1954,7 +2263,12 @@ void SubqueryNode::toJsonHelper (triagens::basics::Json& nodes,
     return;
   }
   json("subquery",  _subquery->toJson(TRI_UNKNOWN_MEM_ZONE, verbose))
-      ("outVariable", _outVariable->toJson());
+      ("outVariable", _outVariable->toJson())
+      ("isConst", triagens::basics::Json(isConst()));
+
+  if (_outerKeyVariable != nullptr) {
+    json("outerKeyVariable", _outerKeyVariable->toJson());
+  }
 
   // And add it:
   nodes(json);
@@ -1971,6 +2285,15 @@ ExecutionNode* SubqueryNode::clone (ExecutionPlan* plan,
   auto c = new SubqueryNode(plan, _id, _subquery->clone(plan, true, withProperties),
                             outVariable);
 
+  if (_outerKeyVariable != nullptr) {
+    auto outerKeyVariable = _outerKeyVariable;
+
+    if (withProperties) {
+      outerKeyVariable = plan->getAst()->variables()->createVariable(outerKeyVariable);
+    }
+    c->_outerKeyVariable = outerKeyVariable;
+  }
+
   cloneHelper(c, plan, withDependencies, withProperties);
 
   return static_cast<ExecutionNode*>(c);
@@ -1989,6 +2312,17 @@ double SubqueryNode::estimateCost (size_t& nrItems) const {
   double depCost = _dependencies.at(0)->getCost(nrItems);
   size_t nrItemsSubquery;
   double subCost = _subquery->getCost(nrItemsSubquery);
+
+  if (_outerKeyVariable != nullptr) {
+    // the subquery is executed once, followed by a hash lookup per row
+    return depCost + subCost + nrItemsSubquery + nrItems;
+  }
+
+  if (isConst()) {
+    // the subquery is executed once, its result is copied for each block
+    return depCost + subCost + nrItems;
+  }
+
   return depCost + nrItems * subCost;
 }
 
@@ -2032,7 +2366,7 @@ struct SubqueryVarUsageFinder final : public WalkerWorker<ExecutionNode> {
      
     // create the set difference. note: cannot use std::set_difference as our sets are NOT sorted
     for (auto it = subfinder._usedLater.begin(); it != subfinder._usedLater.end(); ++it) {
-      if (_valid.find(*it) != _valid.end()) {
+      if (_valid.find(*it) == _valid.end()) {
         _usedLater.emplace((*it));
       }
     }
@@ -2055,6 +2389,10 @@ std::vector<Variable const*> SubqueryNode::getVariablesUsedHere () const {
     }
   }
 
+  if (_outerKeyVariable != nullptr) {
+    v.emplace_back(_outerKeyVariable);
+  }
+
   return v;
 }
 
@@ -2071,6 +2409,10 @@ void SubqueryNode::getVariablesUsedHere (std::unordered_set<Variable const*>& va
       vars.emplace((*it));
     }
   }
+
+  if (_outerKeyVariable != nullptr) {
+    vars.emplace(_outerKeyVariable);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2108,6 +2450,78 @@ bool SubqueryNode::canThrow () {
   return finder._canThrow;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief helper struct to find nodes in a subquery that prevent executing
+/// it only once
+////////////////////////////////////////////////////////////////////////////////
+
+struct NonConstFinder final : public WalkerWorker<ExecutionNode> {
+  bool _nonConst;
+
+  NonConstFinder () 
+    : _nonConst(false) {
+  }
+
+  ~NonConstFinder () {
+  }
+
+  bool enterSubquery (ExecutionNode*, ExecutionNode*) override final {
+    return true;
+  }
+
+  bool before (ExecutionNode* node) override final {
+    switch (node->getType()) {
+      case ExecutionNode::CALCULATION: {
+        _nonConst = ! static_cast<CalculationNode const*>(node)->expression()->isDeterministic();
+        break;
+      }
+      case ExecutionNode::ENUMERATE_COLLECTION: {
+        auto en = static_cast<EnumerateCollectionNode const*>(node);
+        _nonConst = (en->isRandom() || en->collection()->accessType != TRI_TRANSACTION_READ);
+        break;
+      }
+      case ExecutionNode::INDEX_RANGE: {
+        auto en = static_cast<IndexRangeNode const*>(node);
+        _nonConst = (en->collection()->accessType != TRI_TRANSACTION_READ);
+        break;
+      }
+      case ExecutionNode::INSERT:
+      case ExecutionNode::REMOVE:
+      case ExecutionNode::REPLACE:
+      case ExecutionNode::UPDATE:
+      case ExecutionNode::UPSERT: {
+        _nonConst = true;
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+
+    return _nonConst;
+  }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the subquery produces the same result for all rows
+////////////////////////////////////////////////////////////////////////////////
+
+bool SubqueryNode::isConst () const {
+  if (_outerKeyVariable != nullptr) {
+    return false;
+  }
+
+  NonConstFinder finder;
+  _subquery->walk(&finder);
+
+  if (finder._nonConst) {
+    return false;
+  }
+
+  return getVariablesUsedHere().empty();
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                             methods of FilterNode
 // -----------------------------------------------------------------------------
@@ -2179,7 +2593,8 @@ SortNode::SortNode (ExecutionPlan* plan,
                     bool stable)
   : ExecutionNode(plan, base),
     _elements(elements),
-    _stable(stable) {
+    _stable(stable),
+    _limit(JsonHelper::getNumericValue<size_t>(base.json(), "limit", 0)) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2203,6 +2618,7 @@ void SortNode::toJsonHelper (triagens::basics::Json& nodes,
   }
   json("elements", values);
   json("stable", triagens::basics::Json(_stable));
+  json("limit", triagens::basics::Json(static_cast<double>(_limit)));
 
   // And add it:
   nodes(json);
@@ -2340,6 +2756,12 @@ double SortNode::estimateCost (size_t& nrItems) const {
   if (nrItems <= 3.0) {
     return depCost + nrItems;
   }
+  if (_limit > 0 && _limit < nrItems) {
+    // bounded heap of <limit> rows
+    double cost = depCost + nrItems * log(static_cast<double>(_limit) + 1.0);
+    nrItems = _limit;
+    return cost;
+  }
   return depCost + nrItems * log(nrItems);
 }
 
@@ -2364,7 +2786,9 @@ AggregateNode::AggregateNode (ExecutionPlan* plan,
     _keepVariables(keepVariables),
     _variableMap(variableMap),
     _count(count),
-    _isDistinctCommand(isDistinctCommand) {
+    _isDistinctCommand(isDistinctCommand),
+    _specialized(false),
+    _countVariable(nullptr) {
 
 }
 
@@ -2413,6 +2837,12 @@ void AggregateNode::toJsonHelper (triagens::basics::Json& nodes,
   }
 
   json("count", triagens::basics::Json(_count));
+
+  // count variable might be empty
+  if (_countVariable != nullptr) {
+    json("countVariable", _countVariable->toJson());
+  }
+
   json("isDistinctCommand", triagens::basics::Json(_isDistinctCommand));
   json("specialized", triagens::basics::Json(_specialized));
   
@@ -2431,6 +2861,7 @@ ExecutionNode* AggregateNode::clone (ExecutionPlan* plan,
                                      bool withProperties) const {
   auto outVariable = _outVariable;
   auto expressionVariable = _expressionVariable;
+  auto countVariable = _countVariable;
   auto aggregateVariables = _aggregateVariables;
 
   if (withProperties) {
@@ -2438,6 +2869,10 @@ ExecutionNode* AggregateNode::clone (ExecutionPlan* plan,
       expressionVariable = plan->getAst()->variables()->createVariable(expressionVariable);
     }
 
+    if (countVariable != nullptr) {
+      countVariable = plan->getAst()->variables()->createVariable(countVariable);
+    }
+
     if (outVariable != nullptr) {
       outVariable = plan->getAst()->variables()->createVariable(outVariable);
     }
@@ -2470,6 +2905,10 @@ ExecutionNode* AggregateNode::clone (ExecutionPlan* plan,
     c->specialized();
   }
 
+  if (countVariable != nullptr) {
+    c->setCountVariable(countVariable);
+  }
+
   cloneHelper(c, plan, withDependencies, withProperties);
 
   return static_cast<ExecutionNode*>(c);
@@ -2501,6 +2940,7 @@ struct UserVarFinder final : public WalkerWorker<ExecutionNode> {
     }
     else if (en->getType() == ExecutionNode::ENUMERATE_COLLECTION ||
              en->getType() == ExecutionNode::INDEX_RANGE ||
+             en->getType() == ExecutionNode::HASH_JOIN ||
              en->getType() == ExecutionNode::ENUMERATE_LIST ||
              en->getType() == ExecutionNode::AGGREGATE) {
       depth += 1;
@@ -2548,6 +2988,10 @@ void AggregateNode::getVariablesUsedHere (std::unordered_set<Variable const*>& v
     vars.emplace(_expressionVariable);
   }
 
+  if (_countVariable != nullptr) {
+    vars.emplace(_countVariable);
+  }
+
   if (_outVariable != nullptr && ! _count) {
     if (_keepVariables.empty()) {
       // Here we have to find all user defined variables in this query
@@ -101,7 +101,8 @@ namespace triagens {
           RETURN                  = 18,
           NORESULTS               = 19,
           DISTRIBUTE              = 20,
-          UPSERT                  = 21
+          UPSERT                  = 21,
+          HASH_JOIN               = 22
         };
 
 // -----------------------------------------------------------------------------
@@ -932,7 +933,9 @@ namespace triagens {
             _vocbase(vocbase), 
             _collection(collection),
             _outVariable(outVariable),  
-            _random(random) {
+            _random(random),
+            _parallel(false),
+            _filter(nullptr) {
 
           TRI_ASSERT(_vocbase != nullptr);
           TRI_ASSERT(_collection != nullptr);
@@ -942,6 +945,8 @@ namespace triagens {
         EnumerateCollectionNode (ExecutionPlan* plan,
                                  triagens::basics::Json const& base);
 
+        ~EnumerateCollectionNode ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the type of the node
 ////////////////////////////////////////////////////////////////////////////////
@@ -1013,6 +1018,30 @@ namespace triagens {
           _random = true;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the collection is iterated in random order
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isRandom () const {
+          return _random;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allow the collection to be scanned by multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+        void setParallel () {
+          _parallel = true;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the collection may be scanned by multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isParallel () const {
+          return _parallel;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the database
 ////////////////////////////////////////////////////////////////////////////////
@@ -1037,6 +1066,23 @@ namespace triagens {
           return _outVariable;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the filter condition evaluated during the scan (may be a 
+/// nullptr)
+////////////////////////////////////////////////////////////////////////////////
+
+        Expression* filter () const {
+          return _filter;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the filter condition evaluated during the scan. the filter 
+/// may only refer to the out variable. the node takes over ownership of
+/// the expression
+////////////////////////////////////////////////////////////////////////////////
+
+        void setFilter (Expression*);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -1066,6 +1112,201 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _random;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the scan may use multiple threads. this is only
+/// set for scans that are executed once per query
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _parallel;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filter condition evaluated for each document during the scan.
+/// documents for which the condition is not true are not produced at all
+////////////////////////////////////////////////////////////////////////////////
+
+        Expression* _filter;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class HashJoinNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief class HashJoinNode
+/// this node enumerates the documents of a collection whose attribute value
+/// is equal to the value of the input variable. it does so by building a
+/// hash table of all documents in the collection, keyed by the attribute 
+/// value, once, and probing it for every incoming row. it replaces an 
+/// EnumerateCollectionNode with an equality filter for which no index can
+/// be used. the filter itself is kept in the plan
+////////////////////////////////////////////////////////////////////////////////
+
+    class HashJoinNode : public ExecutionNode {
+      friend class ExecutionNode;
+      friend class ExecutionBlock;
+      friend class HashJoinBlock;
+      
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+      public:
+
+        HashJoinNode (ExecutionPlan* plan,
+                      size_t id,
+                      TRI_vocbase_t* vocbase, 
+                      Collection* collection,
+                      Variable const* inVariable,
+                      Variable const* outVariable,
+                      std::vector<std::string> const& attribute)
+          : ExecutionNode(plan, id), 
+            _vocbase(vocbase), 
+            _collection(collection),
+            _inVariable(inVariable),
+            _outVariable(outVariable),
+            _attribute(attribute) {
+
+          TRI_ASSERT(_vocbase != nullptr);
+          TRI_ASSERT(_collection != nullptr);
+          TRI_ASSERT(_inVariable != nullptr);
+          TRI_ASSERT(_outVariable != nullptr);
+          TRI_ASSERT(! _attribute.empty());
+        }
+
+        HashJoinNode (ExecutionPlan* plan,
+                      triagens::basics::Json const& base);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the type of the node
+////////////////////////////////////////////////////////////////////////////////
+
+        NodeType getType () const override final {
+          return HASH_JOIN;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief export to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        void toJsonHelper (triagens::basics::Json&,
+                           TRI_memory_zone_t*,
+                           bool) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionNode* clone (ExecutionPlan* plan,
+                              bool withDependencies,
+                              bool withProperties) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a hash join node is the cost of building the hash 
+/// table once plus the cost of one lookup per incoming item
+////////////////////////////////////////////////////////////////////////////////
+        
+        double estimateCost (size_t&) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, returning a vector
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesUsedHere () const override final {
+          return std::vector<Variable const*>{ _inVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesUsedHere, modifying the set in-place
+////////////////////////////////////////////////////////////////////////////////
+
+        void getVariablesUsedHere (std::unordered_set<Variable const*>& vars) const override final {
+          vars.emplace(_inVariable);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesSetHere
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesSetHere () const override final {
+          return std::vector<Variable const*>{ _outVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the database
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_vocbase_t* vocbase () const {
+          return _vocbase;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection const* collection () const {
+          return _collection;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the in variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* inVariable () const {
+          return _inVariable;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the out variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* outVariable () const {
+          return _outVariable;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the attribute used for joining
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::string> const& attribute () const {
+          return _attribute;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the database
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_vocbase_t* _vocbase;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variable, containing the value to look up
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _inVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief output variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the (possibly nested) document attribute used for joining
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::string> const _attribute;
     };
 
 // -----------------------------------------------------------------------------
@@ -1186,6 +1427,28 @@ namespace triagens {
       friend class ExecutionBlock;
       friend class IndexRangeBlock;
 
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief how the results of the node's indexes are combined
+////////////////////////////////////////////////////////////////////////////////
+
+        enum IndexCombination {
+          INDEX_COMBINATION_NONE,          // single index
+          INDEX_COMBINATION_INTERSECTION,  // documents found in all indexes
+          INDEX_COMBINATION_UNION          // documents found in any index
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a lookup in an additional index, used for index intersection and
+/// index union. ranges have the same meaning as the node's own _ranges
+////////////////////////////////////////////////////////////////////////////////
+
+        struct IndexLookup {
+          Index const* index;
+          std::vector<std::vector<RangeInfo>> ranges;
+        };
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief constructor with a vocbase and a collection name
 ////////////////////////////////////////////////////////////////////////////////
@@ -1193,7 +1456,6 @@ namespace triagens {
 // _ranges must correspond to a prefix of the fields of the index <index>, i.e.
 // _ranges.at(i) is a range of values for idx->_fields._buffer[i]. 
 
-      public:
 
         IndexRangeNode (ExecutionPlan* plan,
                         size_t id,
@@ -1209,7 +1471,10 @@ namespace triagens {
             _outVariable(outVariable),
             _index(index),
             _ranges(ranges),
-            _reverse(reverse) {
+            _reverse(reverse),
+            _combination(INDEX_COMBINATION_NONE),
+            _additionalLookups(),
+            _covering(false) {
 
           TRI_ASSERT(_vocbase != nullptr);
           TRI_ASSERT(_collection != nullptr);
@@ -1326,6 +1591,47 @@ namespace triagens {
           return _index;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief how the results of multiple indexes are combined
+////////////////////////////////////////////////////////////////////////////////
+
+        IndexCombination combination () const {
+          return _combination;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the lookups in the other indexes (if the node uses multiple indexes)
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<IndexLookup> const& additionalLookups () const {
+          return _additionalLookups;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief combine the node's index with lookups in other indexes. all bounds
+/// of all lookups must be constant
+////////////////////////////////////////////////////////////////////////////////
+
+        void combineWith (IndexCombination,
+                          std::vector<IndexLookup> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the index scan is covering, i.e. the node produces
+/// objects with the indexed attribute values only, taken from the index
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isCovering () const {
+          return _covering;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make the index scan covering
+////////////////////////////////////////////////////////////////////////////////
+
+        void setCovering (bool value) {
+          _covering = value;
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
@@ -1337,9 +1643,20 @@ namespace triagens {
 /// selectivity info (if present)
 ////////////////////////////////////////////////////////////////////////////////
 
-        bool estimateItemsWithIndexSelectivity (size_t,
+        bool estimateItemsWithIndexSelectivity (Index const*,
+                                                std::vector<std::vector<RangeInfo>> const&,
+                                                size_t,
                                                 size_t&) const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the cost and number of items for a lookup in one index
+////////////////////////////////////////////////////////////////////////////////
+
+        double estimateLookupCost (Index const*,
+                                   std::vector<std::vector<RangeInfo>> const&,
+                                   size_t,
+                                   size_t&) const;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -1381,6 +1698,24 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _reverse;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief how the results of _index and _additionalLookups are combined
+////////////////////////////////////////////////////////////////////////////////
+
+        IndexCombination _combination;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookups in other indexes, only used for index intersection or union
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<IndexLookup> _additionalLookups;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the index scan is covering
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _covering;
     };
 
 // -----------------------------------------------------------------------------
@@ -1473,6 +1808,30 @@ namespace triagens {
           _fullCount = true;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the offset
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t offset () const {
+          return _offset;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the limit
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t limit () const {
+          return _limit;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the node fully counts what it limits
+////////////////////////////////////////////////////////////////////////////////
+
+        bool fullCount () const {
+          return _fullCount;
+        }
+
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1702,7 +2061,8 @@ namespace triagens {
                       Variable const* outVariable)
           : ExecutionNode(plan, id), 
             _subquery(subquery), 
-            _outVariable(outVariable) {
+            _outVariable(outVariable),
+            _outerKeyVariable(nullptr) {
 
           TRI_ASSERT(_subquery != nullptr);
           TRI_ASSERT(_outVariable != nullptr);
@@ -1798,6 +2158,47 @@ namespace triagens {
 
         bool canThrow () override;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the subquery produces the same result for all input
+/// rows. this is the case if it does not use any variables of the outer
+/// query, is deterministic and does not read collections that are modified
+/// by the query. the SubqueryBlock will then execute it only once
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isConst () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the subquery was decorrelated
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isDecorrelated () const {
+          return (_outerKeyVariable != nullptr);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the variable with the lookup key of a decorrelated subquery
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* outerKeyVariable () const {
+          return _outerKeyVariable;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turn the subquery into a decorrelated subquery. <subquery> is the
+/// new root node of the subquery, which must not use any outer variables
+/// and must return [ key, value ] pairs. the result of the subquery for an
+/// input row is the array of the values whose keys are equal to the value
+/// of <outerKeyVariable> in that row
+////////////////////////////////////////////////////////////////////////////////
+
+        void decorrelate (ExecutionNode* subquery,
+                          Variable const* outerKeyVariable) {
+          TRI_ASSERT(subquery != nullptr);
+          TRI_ASSERT(outerKeyVariable != nullptr);
+          _subquery = subquery;
+          _outerKeyVariable = outerKeyVariable;
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -1816,6 +2217,12 @@ namespace triagens {
 
         Variable const* _outVariable;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup key for a decorrelated subquery, nullptr otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outerKeyVariable;
+
     };
 
 // -----------------------------------------------------------------------------
@@ -1991,7 +2398,8 @@ namespace triagens {
                   bool stable) 
           : ExecutionNode(plan, id),
             _elements(elements),
-            _stable(stable) {
+            _stable(stable),
+            _limit(0) {
 
         }
         
@@ -2016,6 +2424,24 @@ namespace triagens {
           return _stable;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the maximum number of rows the sort needs to produce, 
+/// 0 if unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t limit () const {
+          return _limit;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restrict the sort to produce only the first <limit> rows. this 
+/// is used when the sort is followed by a LIMIT
+////////////////////////////////////////////////////////////////////////////////
+
+        void setLimit (size_t limit) {
+          _limit = limit;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief export to JSON
 ////////////////////////////////////////////////////////////////////////////////
@@ -2032,6 +2458,7 @@ namespace triagens {
                               bool withDependencies,
                               bool withProperties) const override final {
           auto c = new SortNode(plan, _id, _elements, _stable);
+          c->setLimit(_limit);
 
           cloneHelper(c, plan, withDependencies, withProperties);
 
@@ -2112,6 +2539,13 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _stable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of rows to produce (0 = unlimited). if set, the 
+/// SortBlock only keeps the best <limit> rows in memory
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _limit;
     };
 
 
@@ -2158,7 +2592,8 @@ namespace triagens {
             _variableMap(variableMap),
             _count(count), 
             _isDistinctCommand(isDistinctCommand),
-            _specialized(false) {
+            _specialized(false),
+            _countVariable(nullptr) {
 
           // outVariable can be a nullptr, but only if _count is not set
           TRI_ASSERT(! _count || _outVariable != nullptr);
@@ -2268,6 +2703,25 @@ namespace triagens {
           return _count;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the variable with partial group counts, only set for the node that
+/// merges the results of a two-phase aggregation
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* countVariable () const {
+          return _countVariable;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make the node sum up the partial group counts in <variable> 
+/// instead of counting its input rows
+////////////////////////////////////////////////////////////////////////////////
+
+        void setCountVariable (Variable const* variable) {
+          TRI_ASSERT(_count);
+          _countVariable = variable;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not the node has an outVariable (i.e. INTO ...)
 ////////////////////////////////////////////////////////////////////////////////
@@ -2417,6 +2871,13 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _specialized;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief input variable with partial group counts, if set the node sums up
+/// its values instead of counting the input rows
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _countVariable;
     };
 
 // -----------------------------------------------------------------------------
@@ -1510,6 +1510,120 @@ std::vector<ExecutionNode*> ExecutionPlan::findNodesOfType (
   return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace the parameter nodes contained in a JSON value
+////////////////////////////////////////////////////////////////////////////////
+
+static void ReplaceParameterNodes (TRI_json_t* json,
+                                   std::unordered_map<std::string, TRI_json_t*> const& values) {
+  if (TRI_IsArrayJson(json)) {
+    size_t const n = TRI_LengthVector(&json->_value._objects);
+
+    for (size_t i = 0; i < n; ++i) {
+      ReplaceParameterNodes(static_cast<TRI_json_t*>(TRI_AddressVector(&json->_value._objects, i)), values);
+    }
+    return;
+  }
+
+  if (! TRI_IsObjectJson(json)) {
+    return;
+  }
+
+  TRI_json_t const* type = TRI_LookupObjectJson(json, "type");
+
+  if (TRI_IsStringJson(type) &&
+      strcmp(type->_value._string.data, "parameter") == 0) {
+    TRI_json_t const* name = TRI_LookupObjectJson(json, "name");
+
+    if (TRI_IsStringJson(name)) {
+      auto it = values.find(std::string(name->_value._string.data, name->_value._string.length - 1));
+
+      if (it != values.end()) {
+        TRI_json_t copy;
+
+        if (TRI_CopyToJson(TRI_UNKNOWN_MEM_ZONE, &copy, (*it).second) != TRI_ERROR_NO_ERROR) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+
+        // turn the parameter node into the value node
+        TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, json);
+        *json = copy;
+      }
+    }
+    return;
+  }
+
+  size_t const n = TRI_LengthVector(&json->_value._objects);
+
+  for (size_t i = 1; i < n; i += 2) {
+    ReplaceParameterNodes(static_cast<TRI_json_t*>(TRI_AddressVector(&json->_value._objects, i)), values);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inject the values of symbolic bind parameters into the JSON
+/// representation of a plan
+/// symbolic bind parameters may be contained in all expressions of the plan,
+/// e.g. in calculations, index range bounds or filters, which all serialize
+/// their expressions as AST nodes. the parameter nodes are replaced by the
+/// value nodes the AST would have created for the bind parameter values
+////////////////////////////////////////////////////////////////////////////////
+
+void ExecutionPlan::injectBindParameters (Ast* ast,
+                                          TRI_json_t* json,
+                                          BindParameters& parameters) {
+  std::unordered_map<std::string, TRI_json_t*> values;
+
+  try {
+    for (auto const& it : parameters()) {
+      if (it.first.empty() || it.first[0] == '@') {
+        // collection parameters are never symbolic
+        continue;
+      }
+
+      AstNode* node = ast->nodeFromJson(it.second.first, false);
+
+      if (node == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      TRI_json_t* value = node->toJson(TRI_UNKNOWN_MEM_ZONE, true);
+
+      if (value == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      values.emplace(it.first, value);
+    }
+
+    ReplaceParameterNodes(json, values);
+  }
+  catch (...) {
+    for (auto& it : values) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.second);
+    }
+    throw;
+  }
+
+  for (auto& it : values) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.second);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fold constants in the calculations of the plan again
+/// this is much cheaper than running the optimizer, and is used for cached
+/// plans after the values of the bind parameters have been injected
+////////////////////////////////////////////////////////////////////////////////
+
+void ExecutionPlan::optimizeExpressions () {
+  std::vector<ExecutionNode*>&& nodes = findNodesOfType(ExecutionNode::CALCULATION, true);
+
+  for (auto const& n : nodes) {
+    static_cast<CalculationNode*>(n)->expression()->optimize();
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief check linkage of execution plan
 ////////////////////////////////////////////////////////////////////////////////
@@ -1781,6 +1895,11 @@ ExecutionNode* ExecutionPlan::fromJson (triagens::basics::Json const& json) {
 
     TRI_ASSERT(ret != nullptr);
 
+    if (ret->id() > _nextId) {
+      // nodes created later must not reuse the ids of the nodes from the JSON
+      _nextId = ret->id();
+    }
+
     if (ret->getType() == triagens::aql::ExecutionNode::SUBQUERY) {
       // found a subquery node. now do magick here
       triagens::basics::Json subquery = oneJsonNode.get("subquery");
@@ -1836,7 +1955,8 @@ bool ExecutionPlan::isDeadSimple () const {
     if (nodeType == ExecutionNode::SUBQUERY ||
         nodeType == ExecutionNode::ENUMERATE_COLLECTION ||
         nodeType == ExecutionNode::ENUMERATE_LIST ||
-        nodeType == ExecutionNode::INDEX_RANGE) {
+        nodeType == ExecutionNode::INDEX_RANGE ||
+        nodeType == ExecutionNode::HASH_JOIN) {
       // these node types are not simple
       return false;
     }
@@ -243,6 +243,21 @@ namespace triagens {
         std::vector<ExecutionNode*> findNodesOfType (std::vector<ExecutionNode::NodeType> const&,
                                                      bool enterSubqueries);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inject the values of symbolic bind parameters into the JSON
+/// representation of a plan
+////////////////////////////////////////////////////////////////////////////////
+
+        static void injectBindParameters (Ast*,
+                                          TRI_json_t*,
+                                          BindParameters&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fold constants in the calculations of the plan again
+////////////////////////////////////////////////////////////////////////////////
+
+        void optimizeExpressions ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief check linkage
 ////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +69,10 @@ namespace triagens {
         scannedIndex   += summand.scannedIndex;
         fullCount      += summand.fullCount;
         filtered       += summand.filtered;
+        itemBlocksRequested += summand.itemBlocksRequested;
+        itemBlocksRecycled  += summand.itemBlocksRecycled;
+        // the peak is not additive
+        peakMemoryUsage = (std::max)(peakMemoryUsage, summand.peakMemoryUsage);
       }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +86,10 @@ namespace triagens {
         scannedIndex   += newStats.scannedIndex   - lastStats.scannedIndex;
         fullCount      += newStats.fullCount      - lastStats.fullCount;
         filtered       += newStats.filtered       - lastStats.filtered;
+        itemBlocksRequested += newStats.itemBlocksRequested - lastStats.itemBlocksRequested;
+        itemBlocksRecycled  += newStats.itemBlocksRecycled  - lastStats.itemBlocksRecycled;
+        // the peak is not additive
+        peakMemoryUsage = (std::max)(peakMemoryUsage, newStats.peakMemoryUsage);
       }
 
 
@@ -121,6 +129,25 @@ namespace triagens {
 
       int64_t fullCount; 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief peak memory usage of the query (in bytes)
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t peakMemoryUsage; 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of item blocks requested from the item block manager
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t itemBlocksRequested; 
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of requested item blocks that were served from the manager's
+/// pool of recycled blocks
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t itemBlocksRecycled; 
+
     };
 
   }
@@ -121,22 +121,22 @@ std::unordered_map<std::string, Function const> const Executor::FunctionNames{
   
   // string functions
   { "CONCAT",                      Function("CONCAT",                      "AQL_CONCAT", "szl|+", true, true, false, true, true, &Functions::Concat) },
-  { "CONCAT_SEPARATOR",            Function("CONCAT_SEPARATOR",            "AQL_CONCAT_SEPARATOR", "s,szl|+", true, true, false, true, true) },
-  { "CHAR_LENGTH",                 Function("CHAR_LENGTH",                 "AQL_CHAR_LENGTH", "s", true, true, false, true, true) },
-  { "LOWER",                       Function("LOWER",                       "AQL_LOWER", "s", true, true, false, true, true) },
-  { "UPPER",                       Function("UPPER",                       "AQL_UPPER", "s", true, true, false, true, true) },
-  { "SUBSTRING",                   Function("SUBSTRING",                   "AQL_SUBSTRING", "s,n|n", true, true, false, true, true) },
-  { "CONTAINS",                    Function("CONTAINS",                    "AQL_CONTAINS", "s,s|b", true, true, false, true, true) },
+  { "CONCAT_SEPARATOR",            Function("CONCAT_SEPARATOR",            "AQL_CONCAT_SEPARATOR", "s,szl|+", true, true, false, true, true, &Functions::ConcatSeparator) },
+  { "CHAR_LENGTH",                 Function("CHAR_LENGTH",                 "AQL_CHAR_LENGTH", "s", true, true, false, true, true, &Functions::CharLength) },
+  { "LOWER",                       Function("LOWER",                       "AQL_LOWER", "s", true, true, false, true, true, &Functions::Lower) },
+  { "UPPER",                       Function("UPPER",                       "AQL_UPPER", "s", true, true, false, true, true, &Functions::Upper) },
+  { "SUBSTRING",                   Function("SUBSTRING",                   "AQL_SUBSTRING", "s,n|n", true, true, false, true, true, &Functions::Substring) },
+  { "CONTAINS",                    Function("CONTAINS",                    "AQL_CONTAINS", "s,s|b", true, true, false, true, true, &Functions::Contains) },
   { "LIKE",                        Function("LIKE",                        "AQL_LIKE", "s,r|b", true, true, false, true, true, &Functions::Like) },
-  { "LEFT",                        Function("LEFT",                        "AQL_LEFT", "s,n", true, true, false, true, true) },
-  { "RIGHT",                       Function("RIGHT",                       "AQL_RIGHT", "s,n", true, true, false, true, true) },
-  { "TRIM",                        Function("TRIM",                        "AQL_TRIM", "s|ns", true, true, false, true, true) },
-  { "LTRIM",                       Function("LTRIM",                       "AQL_LTRIM", "s|s", true, true, false, true, true) },
-  { "RTRIM",                       Function("RTRIM",                       "AQL_RTRIM", "s|s", true, true, false, true, true) },
-  { "FIND_FIRST",                  Function("FIND_FIRST",                  "AQL_FIND_FIRST", "s,s|zn,zn", true, true, false, true, true) },
-  { "FIND_LAST",                   Function("FIND_LAST",                   "AQL_FIND_LAST", "s,s|zn,zn", true, true, false, true, true) },
-  { "SPLIT",                       Function("SPLIT",                       "AQL_SPLIT", "s|sl,n", true, true, false, true, true) },
-  { "SUBSTITUTE",                  Function("SUBSTITUTE",                  "AQL_SUBSTITUTE", "s,las|lsn,n", true, true, false, true, true) },
+  { "LEFT",                        Function("LEFT",                        "AQL_LEFT", "s,n", true, true, false, true, true, &Functions::Left) },
+  { "RIGHT",                       Function("RIGHT",                       "AQL_RIGHT", "s,n", true, true, false, true, true, &Functions::Right) },
+  { "TRIM",                        Function("TRIM",                        "AQL_TRIM", "s|ns", true, true, false, true, true, &Functions::Trim) },
+  { "LTRIM",                       Function("LTRIM",                       "AQL_LTRIM", "s|s", true, true, false, true, true, &Functions::LTrim) },
+  { "RTRIM",                       Function("RTRIM",                       "AQL_RTRIM", "s|s", true, true, false, true, true, &Functions::RTrim) },
+  { "FIND_FIRST",                  Function("FIND_FIRST",                  "AQL_FIND_FIRST", "s,s|zn,zn", true, true, false, true, true, &Functions::FindFirst) },
+  { "FIND_LAST",                   Function("FIND_LAST",                   "AQL_FIND_LAST", "s,s|zn,zn", true, true, false, true, true, &Functions::FindLast) },
+  { "SPLIT",                       Function("SPLIT",                       "AQL_SPLIT", "s|sl,n", true, true, false, true, true, &Functions::Split) },
+  { "SUBSTITUTE",                  Function("SUBSTITUTE",                  "AQL_SUBSTITUTE", "s,las|lsn,n", true, true, false, true, true, &Functions::Substitute) },
   { "MD5",                         Function("MD5",                         "AQL_MD5", "s", true, true, false, true, true, &Functions::Md5) },
   { "SHA1",                        Function("SHA1",                        "AQL_SHA1", "s", true, true, false, true, true, &Functions::Sha1) },
   { "RANDOM_TOKEN",                Function("RANDOM_TOKEN",                "AQL_RANDOM_TOKEN", "n", false, false, true, true, true) },
@@ -234,27 +234,27 @@ std::unordered_map<std::string, Function const> const Executor::FunctionNames{
   { "GRAPH_RADIUS",                Function("GRAPH_RADIUS",                "AQL_GRAPH_RADIUS", "s|a", false, false, true, false, false) },
 
   // date functions
-  { "DATE_NOW",                    Function("DATE_NOW",                    "AQL_DATE_NOW", "", false, false, false, true, true) },
-  { "DATE_TIMESTAMP",              Function("DATE_TIMESTAMP",              "AQL_DATE_TIMESTAMP", "ns|ns,ns,ns,ns,ns,ns", true, true, false, true, true) },
-  { "DATE_ISO8601",                Function("DATE_ISO8601",                "AQL_DATE_ISO8601", "ns|ns,ns,ns,ns,ns,ns", true, true, false, true, true) },
-  { "DATE_DAYOFWEEK",              Function("DATE_DAYOFWEEK",              "AQL_DATE_DAYOFWEEK", "ns", true, true, false, true, true) },
-  { "DATE_YEAR",                   Function("DATE_YEAR",                   "AQL_DATE_YEAR", "ns", true, true, false, true, true) },
-  { "DATE_MONTH",                  Function("DATE_MONTH",                  "AQL_DATE_MONTH", "ns", true, true, false, true, true) },
-  { "DATE_DAY",                    Function("DATE_DAY",                    "AQL_DATE_DAY", "ns", true, true, false, true, true) },
-  { "DATE_HOUR",                   Function("DATE_HOUR",                   "AQL_DATE_HOUR", "ns", true, true, false, true, true) },
-  { "DATE_MINUTE",                 Function("DATE_MINUTE",                 "AQL_DATE_MINUTE", "ns", true, true, false, true, true) },
-  { "DATE_SECOND",                 Function("DATE_SECOND",                 "AQL_DATE_SECOND", "ns", true, true, false, true, true) },
-  { "DATE_MILLISECOND",            Function("DATE_MILLISECOND",            "AQL_DATE_MILLISECOND", "ns", true, true, false, true, true) },
-  { "DATE_DAYOFYEAR",              Function("DATE_DAYOFYEAR",              "AQL_DATE_DAYOFYEAR", "ns", true, true, false, true, true) },
-  { "DATE_ISOWEEK",                Function("DATE_ISOWEEK",                "AQL_DATE_ISOWEEK", "ns", true, true, false, true, true) },
-  { "DATE_LEAPYEAR",               Function("DATE_LEAPYEAR",               "AQL_DATE_LEAPYEAR", "ns", true, true, false, true, true) },
-  { "DATE_QUARTER",                Function("DATE_QUARTER",                "AQL_DATE_QUARTER", "ns", true, true, false, true, true) },
-  { "DATE_DAYS_IN_MONTH",          Function("DATE_DAYS_IN_MONTH",          "AQL_DATE_DAYS_IN_MONTH", "ns", true, true, false, true, true) },
-  { "DATE_ADD",                    Function("DATE_ADD",                    "AQL_DATE_ADD", "ns,ns|n", true, true, false, true, true) },
-  { "DATE_SUBTRACT",               Function("DATE_SUBTRACT",               "AQL_DATE_SUBTRACT", "ns,ns|n", true, true, false, true, true) },
-  { "DATE_DIFF",                   Function("DATE_DIFF",                   "AQL_DATE_DIFF", "ns,ns,s|b", true, true, false, true, true) },
-  { "DATE_COMPARE",                Function("DATE_COMPARE",                "AQL_DATE_COMPARE", "ns,ns,s|s", true, true, false, true, true) },
-  { "DATE_FORMAT",                 Function("DATE_FORMAT",                 "AQL_DATE_FORMAT", "ns,s", true, true, false, true, true) },
+  { "DATE_NOW",                    Function("DATE_NOW",                    "AQL_DATE_NOW", "", false, false, false, true, true, &Functions::DateNow) },
+  { "DATE_TIMESTAMP",              Function("DATE_TIMESTAMP",              "AQL_DATE_TIMESTAMP", "ns|ns,ns,ns,ns,ns,ns", true, true, false, true, true, &Functions::DateTimestamp) },
+  { "DATE_ISO8601",                Function("DATE_ISO8601",                "AQL_DATE_ISO8601", "ns|ns,ns,ns,ns,ns,ns", true, true, false, true, true, &Functions::DateIso8601) },
+  { "DATE_DAYOFWEEK",              Function("DATE_DAYOFWEEK",              "AQL_DATE_DAYOFWEEK", "ns", true, true, false, true, true, &Functions::DateDayOfWeek) },
+  { "DATE_YEAR",                   Function("DATE_YEAR",                   "AQL_DATE_YEAR", "ns", true, true, false, true, true, &Functions::DateYear) },
+  { "DATE_MONTH",                  Function("DATE_MONTH",                  "AQL_DATE_MONTH", "ns", true, true, false, true, true, &Functions::DateMonth) },
+  { "DATE_DAY",                    Function("DATE_DAY",                    "AQL_DATE_DAY", "ns", true, true, false, true, true, &Functions::DateDay) },
+  { "DATE_HOUR",                   Function("DATE_HOUR",                   "AQL_DATE_HOUR", "ns", true, true, false, true, true, &Functions::DateHour) },
+  { "DATE_MINUTE",                 Function("DATE_MINUTE",                 "AQL_DATE_MINUTE", "ns", true, true, false, true, true, &Functions::DateMinute) },
+  { "DATE_SECOND",                 Function("DATE_SECOND",                 "AQL_DATE_SECOND", "ns", true, true, false, true, true, &Functions::DateSecond) },
+  { "DATE_MILLISECOND",            Function("DATE_MILLISECOND",            "AQL_DATE_MILLISECOND", "ns", true, true, false, true, true, &Functions::DateMillisecond) },
+  { "DATE_DAYOFYEAR",              Function("DATE_DAYOFYEAR",              "AQL_DATE_DAYOFYEAR", "ns", true, true, false, true, true, &Functions::DateDayOfYear) },
+  { "DATE_ISOWEEK",                Function("DATE_ISOWEEK",                "AQL_DATE_ISOWEEK", "ns", true, true, false, true, true, &Functions::DateIsoWeek) },
+  { "DATE_LEAPYEAR",               Function("DATE_LEAPYEAR",               "AQL_DATE_LEAPYEAR", "ns", true, true, false, true, true, &Functions::DateLeapYear) },
+  { "DATE_QUARTER",                Function("DATE_QUARTER",                "AQL_DATE_QUARTER", "ns", true, true, false, true, true, &Functions::DateQuarter) },
+  { "DATE_DAYS_IN_MONTH",          Function("DATE_DAYS_IN_MONTH",          "AQL_DATE_DAYS_IN_MONTH", "ns", true, true, false, true, true, &Functions::DateDaysInMonth) },
+  { "DATE_ADD",                    Function("DATE_ADD",                    "AQL_DATE_ADD", "ns,ns|n", true, true, false, true, true, &Functions::DateAdd) },
+  { "DATE_SUBTRACT",               Function("DATE_SUBTRACT",               "AQL_DATE_SUBTRACT", "ns,ns|n", true, true, false, true, true, &Functions::DateSubtract) },
+  { "DATE_DIFF",                   Function("DATE_DIFF",                   "AQL_DATE_DIFF", "ns,ns,s|b", true, true, false, true, true, &Functions::DateDiff) },
+  { "DATE_COMPARE",                Function("DATE_COMPARE",                "AQL_DATE_COMPARE", "ns,ns,s|s", true, true, false, true, true, &Functions::DateCompare) },
+  { "DATE_FORMAT",                 Function("DATE_FORMAT",                 "AQL_DATE_FORMAT", "ns,s", true, true, false, true, true, &Functions::DateFormat) },
 
   // misc functions
   { "FAIL",                        Function("FAIL",                        "AQL_FAIL", "|s", false, false, true, true, true) },
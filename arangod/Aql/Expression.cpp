@@ -38,6 +38,7 @@
 #include "Basics/Exceptions.h"
 #include "Basics/JsonHelper.h"
 #include "Basics/StringBuffer.h"
+#include "Basics/Utf8Helper.h"
 #include "Basics/json.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/shaped-json.h"
@@ -71,6 +72,309 @@ TRI_json_t const Expression::TrueJson  = { TRI_JSON_BOOLEAN, { true } };
 
 TRI_json_t const Expression::FalseJson = { TRI_JSON_BOOLEAN, { false } };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 struct BatchColumn
+// -----------------------------------------------------------------------------
+
+namespace triagens {
+  namespace aql {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a column of values of the same type, computed for the rows of an
+/// item block when an expression is executed in batch mode
+////////////////////////////////////////////////////////////////////////////////
+
+    struct BatchColumn {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief value types supported in batch mode. the order of the types is the
+/// same as the order used when comparing values of different types
+////////////////////////////////////////////////////////////////////////////////
+
+      enum ValueType : uint8_t {
+        TYPE_NONE,
+        TYPE_NULL,
+        TYPE_BOOL,
+        TYPE_NUMBER,
+        TYPE_STRING
+      };
+
+      BatchColumn ()
+        : type(TYPE_NONE),
+          isConstant(false) {
+      }
+
+      ~BatchColumn () {
+        for (auto& it : values) {
+          it.destroy();
+        }
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the number of values stored in the column
+////////////////////////////////////////////////////////////////////////////////
+
+      inline size_t size (size_t n) const {
+        return isConstant ? 1 : n;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a JSON value to the column
+////////////////////////////////////////////////////////////////////////////////
+
+      bool addJson (TRI_json_t const* json) {
+        if (json == nullptr) {
+          return addType(TYPE_NULL);
+        }
+
+        switch (json->_type) {
+          case TRI_JSON_UNUSED:
+          case TRI_JSON_NULL:
+            return addType(TYPE_NULL);
+          case TRI_JSON_BOOLEAN:
+            if (! addType(TYPE_BOOL)) {
+              return false;
+            }
+            bools.emplace_back(json->_value._boolean ? 1 : 0);
+            return true;
+          case TRI_JSON_NUMBER:
+            if (! addType(TYPE_NUMBER)) {
+              return false;
+            }
+            numbers.emplace_back(json->_value._number);
+            return true;
+          case TRI_JSON_STRING:
+          case TRI_JSON_STRING_REFERENCE:
+            if (! addType(TYPE_STRING)) {
+              return false;
+            }
+            strings.emplace_back(json->_value._string.data, json->_value._string.length - 1);
+            return true;
+          case TRI_JSON_ARRAY:
+          case TRI_JSON_OBJECT:
+            break;
+        }
+
+        return false;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a value in compact representation to the column
+////////////////////////////////////////////////////////////////////////////////
+
+      bool addCompact (CompactValue const& value) {
+        if (value.isNull()) {
+          return addType(TYPE_NULL);
+        }
+        if (value.isBoolean()) {
+          if (! addType(TYPE_BOOL)) {
+            return false;
+          }
+          bools.emplace_back(value.getBoolean() ? 1 : 0);
+          return true;
+        }
+        if (value.isNumber()) {
+          if (! addType(TYPE_NUMBER)) {
+            return false;
+          }
+          numbers.emplace_back(value.getNumber());
+          return true;
+        }
+        if (value.isString()) {
+          if (! addType(TYPE_STRING)) {
+            return false;
+          }
+          size_t length;
+          char const* data = value.getString(length);
+          strings.emplace_back(data, length);
+          return true;
+        }
+
+        return false;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add an AqlValue to the column. the column takes over the value,
+/// which must not be used by the caller afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+      bool addValue (AqlValue& value) {
+        bool result = false;
+
+        try {
+          if (value.isJson()) {
+            result = addJson(value._json->json());
+          }
+          else if (value.isCompact()) {
+            result = addCompact(value.getCompact());
+          }
+
+          if (result && type == TYPE_STRING) {
+            // strings point into the value, so we must keep it
+            values.emplace_back(value);
+            return true;
+          }
+        }
+        catch (...) {
+          value.destroy();
+          throw;
+        }
+
+        value.destroy();
+        return result;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the type of the column, or check that a value has the type of
+/// the other values in the column
+////////////////////////////////////////////////////////////////////////////////
+
+      inline bool addType (ValueType valueType) {
+        if (type == TYPE_NONE) {
+          type = valueType;
+          return true;
+        }
+        return (type == valueType);
+      }
+
+      ValueType                                    type;
+      bool                                         isConstant;
+      std::vector<uint8_t>                         bools;
+      std::vector<double>                          numbers;
+      std::vector<std::pair<char const*, size_t>>  strings;
+      std::vector<AqlValue>                        values;
+    };
+
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief apply a comparison operator to two columns of values of the same
+/// type. the loops are kept free of branches so the compiler can vectorize
+/// them
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T, typename Op>
+static void CompareColumnValues (std::vector<T> const& left,
+                                 bool leftIsConstant,
+                                 std::vector<T> const& right,
+                                 bool rightIsConstant,
+                                 size_t n,
+                                 uint8_t* out,
+                                 Op const& op) {
+  T const* l = left.data();
+  T const* r = right.data();
+
+  if (leftIsConstant && rightIsConstant) {
+    out[0] = op(l[0], r[0]) ? 1 : 0;
+  }
+  else if (leftIsConstant) {
+    T const value = l[0];
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = op(value, r[i]) ? 1 : 0;
+    }
+  }
+  else if (rightIsConstant) {
+    T const value = r[0];
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = op(l[i], value) ? 1 : 0;
+    }
+  }
+  else {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = op(l[i], r[i]) ? 1 : 0;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief apply the comparison operator of the node to two columns
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+static void CompareColumns (AstNodeType type,
+                            std::vector<T> const& left,
+                            bool leftIsConstant,
+                            std::vector<T> const& right,
+                            bool rightIsConstant,
+                            size_t n,
+                            uint8_t* out) {
+  switch (type) {
+    case NODE_TYPE_OPERATOR_BINARY_EQ:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::equal_to<T>());
+      break;
+    case NODE_TYPE_OPERATOR_BINARY_NE:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::not_equal_to<T>());
+      break;
+    case NODE_TYPE_OPERATOR_BINARY_LT:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::less<T>());
+      break;
+    case NODE_TYPE_OPERATOR_BINARY_LE:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::less_equal<T>());
+      break;
+    case NODE_TYPE_OPERATOR_BINARY_GT:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::greater<T>());
+      break;
+    case NODE_TYPE_OPERATOR_BINARY_GE:
+      CompareColumnValues(left, leftIsConstant, right, rightIsConstant, n, out, std::greater_equal<T>());
+      break;
+    default:
+      TRI_ASSERT(false);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert the result of a three-way comparison into the result of
+/// the comparison operator of the node
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint8_t ComparisonResult (AstNodeType type,
+                                        int compareResult) {
+  switch (type) {
+    case NODE_TYPE_OPERATOR_BINARY_EQ:
+      return (compareResult == 0) ? 1 : 0;
+    case NODE_TYPE_OPERATOR_BINARY_NE:
+      return (compareResult != 0) ? 1 : 0;
+    case NODE_TYPE_OPERATOR_BINARY_LT:
+      return (compareResult < 0) ? 1 : 0;
+    case NODE_TYPE_OPERATOR_BINARY_LE:
+      return (compareResult <= 0) ? 1 : 0;
+    case NODE_TYPE_OPERATOR_BINARY_GT:
+      return (compareResult > 0) ? 1 : 0;
+    case NODE_TYPE_OPERATOR_BINARY_GE:
+      return (compareResult >= 0) ? 1 : 0;
+    default:
+      TRI_ASSERT(false);
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare two strings, either using UTF-8 collation or binary
+////////////////////////////////////////////////////////////////////////////////
+
+static int CompareStrings (std::pair<char const*, size_t> const& left,
+                           std::pair<char const*, size_t> const& right,
+                           bool compareUtf8) {
+  if (compareUtf8) {
+    return TRI_compare_utf8(left.first, left.second, right.first, right.second);
+  }
+
+  int res = memcmp(left.first, right.first, (std::min)(left.second, right.second));
+
+  if (res != 0) {
+    return res;
+  }
+  if (left.second == right.second) {
+    return 0;
+  }
+  return (left.second < right.second) ? -1 : 1;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -90,6 +394,8 @@ Expression::Expression (Ast* ast,
     _isDeterministic(false),
     _hasDeterminedAttributes(false),
     _built(false),
+    _batchMode(BATCH_UNDETERMINED),
+    _batchAccessors(),
     _attributes(),
     _buffer(TRI_UNKNOWN_MEM_ZONE) {
 
@@ -138,6 +444,10 @@ Expression::~Expression () {
       
     }
   }
+
+  for (auto& it : _batchAccessors) {
+    delete it.second;
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -216,6 +526,69 @@ AqlValue Expression::execute (triagens::arango::AqlTransaction* trx,
   THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "invalid simple expression");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the expression can be executed for many rows of
+/// an item block at once
+////////////////////////////////////////////////////////////////////////////////
+
+bool Expression::canRunBatched () {
+  if (_batchMode == BATCH_UNDETERMINED) {
+    if (_type == UNPROCESSED) {
+      analyzeExpression();
+    }
+
+    if (_type == SIMPLE && isBatchOperator(_node)) {
+      prepareBatchExpression(_node);
+      _batchMode = BATCH_ENABLED;
+    }
+    else {
+      _batchMode = BATCH_DISABLED;
+    }
+  }
+
+  return (_batchMode == BATCH_ENABLED);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the expression for the first n rows of an item block at
+/// once
+////////////////////////////////////////////////////////////////////////////////
+
+bool Expression::executeBatch (triagens::arango::AqlTransaction* trx,
+                               AqlItemBlock const* argv,
+                               size_t n,
+                               std::vector<Variable const*> const& vars,
+                               std::vector<RegisterId> const& regs,
+                               std::vector<uint8_t>& results) {
+  TRI_ASSERT(_batchMode == BATCH_ENABLED);
+  TRI_ASSERT(n > 0);
+
+  if (! _variables.empty()) {
+    return false;
+  }
+
+  BatchColumn column;
+
+  if (! executeBatchExpression(_node, column, trx, argv, n, vars, regs) ||
+      column.type != BatchColumn::TYPE_BOOL) {
+    // the values in the block cannot be processed in batch mode. as this is
+    // likely to be the case for the following blocks, too, we turn batch mode
+    // off for the expression
+    _batchMode = BATCH_DISABLED;
+    return false;
+  }
+
+  if (column.isConstant) {
+    results.assign(n, column.bools[0]);
+  }
+  else {
+    TRI_ASSERT(column.bools.size() == n);
+    results.swap(column.bools);
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables in the expression with other variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -257,6 +630,36 @@ void Expression::replaceVariableReference (Variable const* variable,
   _hasDeterminedAttributes = false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief run the AST optimizations on the expression again, e.g. to fold
+/// the bind parameter values injected into a cached plan
+////////////////////////////////////////////////////////////////////////////////
+
+void Expression::optimize () {
+  _node = _ast->validateAndOptimize(const_cast<AstNode*>(_node));
+  TRI_ASSERT(_node != nullptr);
+  invalidate(); 
+
+  if (_type != UNPROCESSED) {
+    if (_built) {
+      if (_type == ATTRIBUTE) {
+        delete _accessor;
+        _accessor = nullptr;
+      }
+      else if (_type == JSON) {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _data);
+        _data = nullptr;
+      }
+      _built = false;
+    }
+    // must set back the expression type so the expression will be analyzed again
+    _type = UNPROCESSED;
+  }
+
+  _attributes.clear();
+  _hasDeterminedAttributes = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief invalidates an expression
 /// this only has an effect for V8-based functions, which need to be created,
@@ -265,6 +668,15 @@ void Expression::replaceVariableReference (Variable const* variable,
 ////////////////////////////////////////////////////////////////////////////////
 
 void Expression::invalidate () {
+  if (_batchMode != BATCH_UNDETERMINED) {
+    // the accessors point to nodes that might be replaced
+    for (auto& it : _batchAccessors) {
+      delete it.second;
+    }
+    _batchAccessors.clear();
+    _batchMode = BATCH_UNDETERMINED;
+  }
+
   if (_type == V8) {
     // V8 expressions need a special handling
     if (_built) {
@@ -475,6 +887,19 @@ AqlValue Expression::executeSimpleExpression (AstNode const* node,
     TRI_document_collection_t const* myCollection = nullptr;
     AqlValue result = executeSimpleExpression(member, &myCollection, trx, argv, startPos, vars, regs, false);
 
+    if (result.isCompact()) {
+      // look up the attribute without converting the value to JSON
+      CompactValue found;
+      if (result.getCompact().get(name, strlen(name), found)) {
+        char* copy = found.copy();
+        result.destroy();
+        return AqlValue(copy);
+      }
+
+      result.destroy();
+      return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, &NullJson, Json::NOFREE));
+    }
+
     auto j = result.extractObjectMember(trx, myCollection, name, true, _buffer);
     result.destroy();
     return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, j.steal()));
@@ -1023,6 +1448,227 @@ AqlValue Expression::executeSimpleExpression (AstNode const* node,
   THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, msg.c_str());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a node can be evaluated as a whole column in batch
+/// mode
+////////////////////////////////////////////////////////////////////////////////
+
+bool Expression::isBatchOperator (AstNode const* node) {
+  switch (node->type) {
+    case NODE_TYPE_OPERATOR_UNARY_NOT:
+    case NODE_TYPE_OPERATOR_BINARY_AND:
+    case NODE_TYPE_OPERATOR_BINARY_OR:
+    case NODE_TYPE_OPERATOR_BINARY_EQ:
+    case NODE_TYPE_OPERATOR_BINARY_NE:
+    case NODE_TYPE_OPERATOR_BINARY_LT:
+    case NODE_TYPE_OPERATOR_BINARY_LE:
+    case NODE_TYPE_OPERATOR_BINARY_GT:
+    case NODE_TYPE_OPERATOR_BINARY_GE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepare the attribute accessors for the leaves of a batch
+/// expression
+////////////////////////////////////////////////////////////////////////////////
+
+void Expression::prepareBatchExpression (AstNode const* node) {
+  if (isBatchOperator(node)) {
+    size_t const n = node->numMembers();
+
+    for (size_t i = 0; i < n; ++i) {
+      prepareBatchExpression(node->getMemberUnchecked(i));
+    }
+    return;
+  }
+
+  if (node->type != NODE_TYPE_ATTRIBUTE_ACCESS) {
+    // other leaves will be executed as simple expressions
+    return;
+  }
+
+  auto member = node->getMemberUnchecked(0);
+  std::vector<char const*> parts{ static_cast<char const*>(node->getData()) };
+
+  while (member->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    parts.insert(parts.begin(), static_cast<char const*>(member->getData()));
+    member = member->getMemberUnchecked(0);
+  }
+
+  if (member->type == NODE_TYPE_REFERENCE) {
+    auto v = static_cast<Variable const*>(member->getData());
+
+    std::unique_ptr<AttributeAccessor> accessor(new AttributeAccessor(parts, v));
+    _batchAccessors.emplace(node, accessor.get());
+    accessor.release();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a node of a batch expression for a whole column of rows
+////////////////////////////////////////////////////////////////////////////////
+
+bool Expression::executeBatchExpression (AstNode const* node,
+                                         BatchColumn& column,
+                                         triagens::arango::AqlTransaction* trx,
+                                         AqlItemBlock const* argv,
+                                         size_t n,
+                                         std::vector<Variable const*> const& vars,
+                                         std::vector<RegisterId> const& regs) {
+  if (! isBatchOperator(node)) {
+    return executeBatchLeaf(node, column, trx, argv, n, vars, regs);
+  }
+
+  if (node->type == NODE_TYPE_OPERATOR_UNARY_NOT) {
+    BatchColumn operand;
+
+    if (! executeBatchExpression(node->getMember(0), operand, trx, argv, n, vars, regs) ||
+        operand.type != BatchColumn::TYPE_BOOL) {
+      return false;
+    }
+
+    size_t const m = operand.size(n);
+    uint8_t const* in = operand.bools.data();
+
+    column.type = BatchColumn::TYPE_BOOL;
+    column.isConstant = operand.isConstant;
+    column.bools.resize(m);
+    uint8_t* out = column.bools.data();
+
+    for (size_t i = 0; i < m; ++i) {
+      out[i] = in[i] ^ 1;
+    }
+    return true;
+  }
+
+  BatchColumn left;
+  BatchColumn right;
+
+  if (! executeBatchExpression(node->getMember(0), left, trx, argv, n, vars, regs) ||
+      ! executeBatchExpression(node->getMember(1), right, trx, argv, n, vars, regs)) {
+    return false;
+  }
+
+  column.type = BatchColumn::TYPE_BOOL;
+  column.isConstant = (left.isConstant && right.isConstant);
+  size_t const m = column.size(n);
+  column.bools.resize(m);
+  uint8_t* out = column.bools.data();
+
+  if (node->type == NODE_TYPE_OPERATOR_BINARY_AND ||
+      node->type == NODE_TYPE_OPERATOR_BINARY_OR) {
+    // logical operators return one of their operands. we can only handle
+    // them if both operands are booleans
+    if (left.type != BatchColumn::TYPE_BOOL ||
+        right.type != BatchColumn::TYPE_BOOL) {
+      return false;
+    }
+
+    if (node->type == NODE_TYPE_OPERATOR_BINARY_AND) {
+      CompareColumnValues(left.bools, left.isConstant, right.bools, right.isConstant, m, out, std::logical_and<uint8_t>());
+    }
+    else {
+      CompareColumnValues(left.bools, left.isConstant, right.bools, right.isConstant, m, out, std::logical_or<uint8_t>());
+    }
+    return true;
+  }
+
+  // comparison operators
+  if (left.type != right.type) {
+    // values of different types are ordered by their type only
+    column.isConstant = true;
+    column.bools.resize(1);
+    column.bools[0] = ComparisonResult(node->type, (left.type < right.type) ? -1 : 1);
+    return true;
+  }
+
+  switch (left.type) {
+    case BatchColumn::TYPE_NULL: {
+      column.isConstant = true;
+      column.bools.resize(1);
+      column.bools[0] = ComparisonResult(node->type, 0);
+      break;
+    }
+
+    case BatchColumn::TYPE_BOOL: {
+      CompareColumns(node->type, left.bools, left.isConstant, right.bools, right.isConstant, m, out);
+      break;
+    }
+
+    case BatchColumn::TYPE_NUMBER: {
+      CompareColumns(node->type, left.numbers, left.isConstant, right.numbers, right.isConstant, m, out);
+      break;
+    }
+
+    case BatchColumn::TYPE_STRING: {
+      // for equality and non-equality we can use a binary comparison
+      bool const compareUtf8 = (node->type != NODE_TYPE_OPERATOR_BINARY_EQ && 
+                                node->type != NODE_TYPE_OPERATOR_BINARY_NE);
+
+      for (size_t i = 0; i < m; ++i) {
+        auto const& l = left.strings[left.isConstant ? 0 : i];
+        auto const& r = right.strings[right.isConstant ? 0 : i];
+
+        out[i] = ComparisonResult(node->type, CompareStrings(l, r, compareUtf8));
+      }
+      break;
+    }
+
+    case BatchColumn::TYPE_NONE: {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a leaf of a batch expression row by row, and collect its
+/// values in a column
+////////////////////////////////////////////////////////////////////////////////
+
+bool Expression::executeBatchLeaf (AstNode const* node,
+                                   BatchColumn& column,
+                                   triagens::arango::AqlTransaction* trx,
+                                   AqlItemBlock const* argv,
+                                   size_t n,
+                                   std::vector<Variable const*> const& vars,
+                                   std::vector<RegisterId> const& regs) {
+  if (node->type == NODE_TYPE_VALUE) {
+    // the node owns the JSON, so we can refer to its strings directly
+    column.isConstant = true;
+    return column.addJson(node->computeJson());
+  }
+
+  AttributeAccessor* accessor = nullptr;
+  auto it = _batchAccessors.find(node);
+
+  if (it != _batchAccessors.end()) {
+    accessor = (*it).second;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    AqlValue value;
+
+    if (accessor != nullptr) {
+      value = accessor->get(trx, argv, i, vars, regs);
+    }
+    else {
+      TRI_document_collection_t const* myCollection = nullptr;
+      value = executeSimpleExpression(node, &myCollection, trx, argv, i, vars, regs, false);
+    }
+
+    if (! column.addValue(value)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief check whether this is an attribute access of any degree (e.g. a.b, 
 /// a.b.c, ...)
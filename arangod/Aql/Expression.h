@@ -51,6 +51,7 @@ namespace triagens {
     struct AqlValue;
     class Ast;
     class AttributeAccessor;
+    struct BatchColumn;
     class Executor;
     struct V8Expression;
 
@@ -179,6 +180,29 @@ namespace triagens {
                           std::vector<RegisterId> const&,
                           TRI_document_collection_t const**);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the expression can be executed for many rows of
+/// an item block at once. this is the case for simple expressions that
+/// consist of comparisons and logical operators only
+////////////////////////////////////////////////////////////////////////////////
+
+        bool canRunBatched ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the expression for the first n rows of an item block at
+/// once, and store the boolean result for each row in results. this will
+/// return false if the values in the block cannot be processed in batch
+/// mode, e.g. because they are of mixed types. in this case, the caller
+/// must execute the expression row by row
+////////////////////////////////////////////////////////////////////////////////
+
+        bool executeBatch (triagens::arango::AqlTransaction* trx,
+                           AqlItemBlock const*,
+                           size_t,
+                           std::vector<Variable const*> const&,
+                           std::vector<RegisterId> const&,
+                           std::vector<uint8_t>&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief check whether this is a JSON expression
 ////////////////////////////////////////////////////////////////////////////////
@@ -281,6 +305,13 @@ namespace triagens {
 
         void replaceVariableReference (Variable const*, AstNode const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief run the AST optimizations on the expression again, e.g. to fold
+/// the bind parameter values injected into a cached plan
+////////////////////////////////////////////////////////////////////////////////
+
+        void optimize ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief invalidates an expression
 /// this only has an effect for V8-based functions, which need to be created,
@@ -341,6 +372,45 @@ namespace triagens {
                                           std::vector<RegisterId> const&,
                                           bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a node can be evaluated as a whole column in batch
+/// mode
+////////////////////////////////////////////////////////////////////////////////
+
+        static bool isBatchOperator (AstNode const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepare the attribute accessors for the leaves of a batch
+/// expression
+////////////////////////////////////////////////////////////////////////////////
+
+        void prepareBatchExpression (AstNode const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a node of a batch expression for a whole column of rows
+////////////////////////////////////////////////////////////////////////////////
+
+        bool executeBatchExpression (AstNode const*,
+                                     BatchColumn&,
+                                     triagens::arango::AqlTransaction*,
+                                     AqlItemBlock const*,
+                                     size_t,
+                                     std::vector<Variable const*> const&,
+                                     std::vector<RegisterId> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a leaf of a batch expression row by row, and collect its
+/// values in a column
+////////////////////////////////////////////////////////////////////////////////
+
+        bool executeBatchLeaf (AstNode const*,
+                               BatchColumn&,
+                               triagens::arango::AqlTransaction*,
+                               AqlItemBlock const*,
+                               size_t,
+                               std::vector<Variable const*> const&,
+                               std::vector<RegisterId> const&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -415,6 +485,22 @@ namespace triagens {
 
         bool                      _built;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not batch mode can be used for the expression
+////////////////////////////////////////////////////////////////////////////////
+
+        enum : uint8_t {
+          BATCH_UNDETERMINED,
+          BATCH_ENABLED,
+          BATCH_DISABLED
+        }                         _batchMode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief attribute accessors for the leaves of a batch expression
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<AstNode const*, AttributeAccessor*> _batchAccessors;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the top-level attributes used in the expression, grouped 
 /// by variable name
@@ -36,12 +36,16 @@
 #include "Basics/json-utilities.h"
 #include "Basics/ScopeGuard.h"
 #include "Basics/StringBuffer.h"
+#include "Basics/system-functions.h"
 #include "Basics/Utf8Helper.h"
 #include "Rest/SslInterface.h"
 #include "V8Server/V8Traverser.h"
 #include "VocBase/KeyGenerator.h"
 #include "VocBase/VocShaper.h"
 
+#include "unicode/unistr.h"
+#include "unicode/utf8.h"
+
 using namespace triagens::aql;
 using Json = triagens::basics::Json;
 using CollectionNameResolver = triagens::arango::CollectionNameResolver;
@@ -400,1551 +404,3929 @@ static void AppendAsString (triagens::basics::StringBuffer& buffer,
   }
 }
 
-// -----------------------------------------------------------------------------
-// --SECTION--                                      AQL functions public helpers
-// -----------------------------------------------------------------------------
-
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief called before a query starts
-/// has the chance to set up any thread-local storage
+/// @brief create an AqlValue from the contents of a string buffer
+/// the buffer's memory is stolen so the data does not need to be copied
 ////////////////////////////////////////////////////////////////////////////////
 
-void Functions::InitializeThreadContext () {
+static AqlValue StringBufferToAqlValue (triagens::basics::StringBuffer& buffer) {
+  size_t length = buffer.length();
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, buffer.steal(), length));
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief called when a query ends
-/// its responsibility is to clear any thread-local storage
+/// @brief create an AqlValue from a UTF-16 string
 ////////////////////////////////////////////////////////////////////////////////
 
-void Functions::DestroyThreadContext () {
-  ClearRegexCache();
+static AqlValue UnicodeStringToAqlValue (UnicodeString const& value) {
+  std::string result;
+  value.toUTF8String(result);
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result));
 }
 
-// -----------------------------------------------------------------------------
-// --SECTION--                                             AQL function bindings
-// -----------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert a function parameter into a UTF-16 string
+///
+/// string positions in AQL are counted in UTF-16 code units (as in
+/// JavaScript), so all position-based string functions work on UTF-16
+////////////////////////////////////////////////////////////////////////////////
+
+static UnicodeString ExtractUnicodeStringParameter (triagens::arango::AqlTransaction* trx,
+                                                    FunctionParameters const& parameters,
+                                                    size_t position) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  auto const value = ExtractFunctionParameter(trx, parameters, position, false);
+  AppendAsString(buffer, value.json());
+
+  return UnicodeString::fromUTF8(StringPiece(buffer.c_str(), static_cast<int32_t>(buffer.length())));
+}
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_NULL
+/// @brief extract an optional numeric function parameter
+/// returns false if the parameter is not present or null
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsNull (triagens::aql::Query*, 
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isNull()));
+static bool ExtractOptionalNumberParameter (triagens::arango::AqlTransaction* trx,
+                                            FunctionParameters const& parameters,
+                                            size_t position,
+                                            double& result) {
+  if (position >= parameters.size()) {
+    return false;
+  }
+
+  auto const value = ExtractFunctionParameter(trx, parameters, position, false);
+
+  if (value.isEmpty() || value.isNull()) {
+    return false;
+  }
+
+  bool isValid;
+  result = ValueToNumber(value.json(), isValid);
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_BOOL
+/// @brief number of UTF-16 code units needed for a UTF-8 string
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsBool (triagens::aql::Query*,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isBoolean()));
+static size_t Utf16Length (char const* p,
+                           size_t length) {
+  size_t result = 0;
+
+  for (size_t i = 0; i < length; ++i) {
+    uint8_t const c = static_cast<uint8_t>(p[i]);
+
+    if ((c & 0xC0) != 0x80) {
+      // not a continuation byte. 4 byte sequences need a surrogate pair
+      result += (c >= 0xF0 ? 2 : 1);
+    }
+  }
+
+  return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_NUMBER
+/// @brief calculate the substring range for a JavaScript-style substr() call
+///
+/// a negative start is counted from the end of the string. the count is
+/// clamped to the remaining length of the string
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsNumber (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isNumber()));
+static void SubstringRange (int32_t length,
+                            double start,
+                            double count,
+                            bool hasCount,
+                            int32_t& from,
+                            int32_t& n) {
+  start = std::trunc(start);
+
+  if (start < 0.0) {
+    start = (std::max)(static_cast<double>(length) + start, 0.0);
+  }
+  start = (std::min)(start, static_cast<double>(length));
+
+  double remaining = static_cast<double>(length) - start;
+
+  if (hasCount) {
+    remaining = (std::min)((std::max)(std::trunc(count), 0.0), remaining);
+  }
+
+  from = static_cast<int32_t>(start);
+  n = static_cast<int32_t>(remaining);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_STRING
+/// @brief JavaScript-style indexOf() for UTF-16 strings
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsString (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isString()));
+static int32_t IndexOf (UnicodeString const& value,
+                        UnicodeString const& search,
+                        double position) {
+  position = (std::min)((std::max)(std::trunc(position), 0.0), static_cast<double>(value.length()));
+  int32_t const start = static_cast<int32_t>(position);
+
+  if (search.isEmpty()) {
+    return start;
+  }
+
+  return value.indexOf(search, start);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_ARRAY
+/// @brief JavaScript-style lastIndexOf() for UTF-16 strings
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsArray (triagens::aql::Query*,
-                             triagens::arango::AqlTransaction* trx,
-                             FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isArray()));
+static int32_t LastIndexOf (UnicodeString const& value,
+                            UnicodeString const& search) {
+  if (search.isEmpty()) {
+    return value.length();
+  }
+
+  return value.lastIndexOf(search);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function IS_OBJECT
+/// @brief whether or not a code point is whitespace, using the same
+/// definition as JavaScript regular expressions (\s)
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::IsObject (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  return AqlValue(new Json(value.isObject()));
+static bool IsWhitespace (UChar32 c) {
+  return (c >= 0x09 && c <= 0x0D) ||
+         c == 0x20 ||
+         c == 0xA0 ||
+         c == 0x1680 ||
+         c == 0x180E ||
+         (c >= 0x2000 && c <= 0x200A) ||
+         c == 0x2028 ||
+         c == 0x2029 ||
+         c == 0x202F ||
+         c == 0x205F ||
+         c == 0x3000 ||
+         c == 0xFEFF;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function TO_NUMBER
+/// @brief shared implementation of TRIM, LTRIM and RTRIM
+///
+/// strips whitespace or the characters contained in chars from the left
+/// and/or right end of value. chars may be a nullptr to strip whitespace
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::ToNumber (triagens::aql::Query*,
-                             triagens::arango::AqlTransaction* trx,
-                             FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+static AqlValue TrimString (char const* value,
+                            size_t length,
+                            char const* chars,
+                            size_t charsLength,
+                            bool left,
+                            bool right) {
+  std::vector<UChar32> strip;
+
+  if (chars != nullptr) {
+    int32_t i = 0;
+    while (i < static_cast<int32_t>(charsLength)) {
+      UChar32 c;
+      U8_NEXT(reinterpret_cast<uint8_t const*>(chars), i, static_cast<int32_t>(charsLength), c);
+      strip.emplace_back(c);
+    }
+  }
 
-  bool isValid;
-  double v = ValueToNumber(value.json(), isValid);
+  auto mustStrip = [&] (UChar32 c) -> bool {
+    if (chars == nullptr) {
+      return IsWhitespace(c);
+    }
+    return std::find(strip.begin(), strip.end(), c) != strip.end();
+  };
 
-  if (! isValid) {
-    return AqlValue(new Json(Json::Null));
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(value);
+  int32_t start = 0;
+  int32_t end = static_cast<int32_t>(length);
+
+  if (left) {
+    while (start < end) {
+      int32_t next = start;
+      UChar32 c;
+      U8_NEXT(p, next, end, c);
+      if (! mustStrip(c)) {
+        break;
+      }
+      start = next;
+    }
   }
-  return AqlValue(new Json(v));
+
+  if (right) {
+    while (end > start) {
+      int32_t previous = end;
+      UChar32 c;
+      U8_PREV(p, start, previous, c);
+      if (! mustStrip(c)) {
+        break;
+      }
+      end = previous;
+    }
+  }
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, value + start, static_cast<size_t>(end - start)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function TO_STRING
+/// @brief number of milliseconds per day
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::ToString (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+static int64_t const MillisecondsPerDay = 86400000LL;
 
-  AppendAsString(buffer, value.json());
-  size_t length = buffer.length();
-  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, buffer.steal(), length));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum absolute timestamp value (same limit as in JavaScript)
+////////////////////////////////////////////////////////////////////////////////
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
-}
+static double const MaxTimestamp = 8.64e15;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function TO_BOOL
+/// @brief English month names
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::ToBool (triagens::aql::Query*,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+static char const* MonthNames[] = {
+  "January",
+  "February",
+  "March",
+  "April",
+  "May",
+  "June",
+  "July",
+  "August",
+  "September",
+  "October",
+  "November",
+  "December"
+};
 
-  return AqlValue(new Json(ValueToBoolean(value.json())));
-}
+////////////////////////////////////////////////////////////////////////////////
+/// @brief English weekday names
+////////////////////////////////////////////////////////////////////////////////
+
+static char const* WeekdayNames[] = {
+  "Sunday",
+  "Monday",
+  "Tuesday",
+  "Wednesday",
+  "Thursday",
+  "Friday",
+  "Saturday"
+};
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function TO_ARRAY
+/// @brief offsets for day of year calculation (non-leap years and leap years)
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::ToArray (triagens::aql::Query*,
-                             triagens::arango::AqlTransaction* trx,
-                             FunctionParameters const& parameters) {
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+static int const DayOfYearOffsets[2][12] = {
+  { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 },
+  { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 }
+};
 
-  if (value.isBoolean() ||
-      value.isNumber() ||
-      value.isString()) {
-    // return array with single member
-    Json array(Json::Array, 1);
-    array.add(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value.json()));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief milliseconds per month, counting February as 28 days
+////////////////////////////////////////////////////////////////////////////////
 
-    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, array.steal()));
-  }
-  if (value.isArray()) {
-    // return copy of the original array
-    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value.json())));
-  }
-  if (value.isObject()) {
-    // return an array with the attribute values
-    auto const source = value.json();
-    size_t const n = TRI_LengthVector(&source->_value._objects);
+static double const MillisecondsPerMonth[] = {
+  26784e5, 24192e5, 26784e5, 2592e6, 26784e5, 2592e6,
+  26784e5, 26784e5, 2592e6, 26784e5, 2592e6, 26784e5
+};
 
-    Json array(Json::Array, n);
-    for (size_t i = 1; i < n; i += 2) {
-      auto v = static_cast<TRI_json_t const*>(TRI_AtVector(&source->_value._objects, i));
-      array.add(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, v));
-    } 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief broken-down UTC representation of a timestamp
+////////////////////////////////////////////////////////////////////////////////
 
-    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, array.steal()));
-  }
+struct DateComponents {
+  int64_t _year;
+  int     _month;        // 1 - 12
+  int     _day;          // 1 - 31
+  int     _hour;
+  int     _minute;
+  int     _second;
+  int     _millisecond;
+  int     _weekday;      // 0 = Sunday
+};
 
-  // return empty array
-  return AqlValue(new Json(Json::Array));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the year is a leap year in the Gregorian calendar
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool IsLeapYear (int64_t year) {
+  return ((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function LENGTH
+/// @brief number of days in the given month (month is 1-based)
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Length (triagens::aql::Query*,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  if (! parameters.empty() &&
-      parameters[0].first.isArray()) {
-    // shortcut!
-    return AqlValue(new Json(static_cast<double>(parameters[0].first.arraySize())));
+static int DaysInMonth (int64_t year,
+                        int month) {
+  static int const days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  if (month == 2 && IsLeapYear(year)) {
+    return 29;
   }
+  return days[month - 1];
+}
 
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief day of the year (1-based) for the given date components
+////////////////////////////////////////////////////////////////////////////////
 
-  TRI_json_t const* json = value.json();
-  size_t length = 0;
+static int DayOfYear (DateComponents const& components) {
+  return DayOfYearOffsets[IsLeapYear(components._year) ? 1 : 0][components._month - 1] + components._day;
+}
 
-  if (json != nullptr) {
-    switch (json->_type) {
-      case TRI_JSON_UNUSED:
-      case TRI_JSON_NULL: {
-        length = 0;
-        break;
-      }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of days since 1970-01-01 for a date in the proleptic
+/// Gregorian calendar (month and day are 1-based)
+////////////////////////////////////////////////////////////////////////////////
 
-      case TRI_JSON_BOOLEAN: {
-        length = (json->_value._boolean ? 1 : 0);
-        break;
-      }
+static int64_t DaysFromCivil (int64_t year,
+                              int month,
+                              int day) {
+  year -= (month <= 2 ? 1 : 0);
+  int64_t const era = (year >= 0 ? year : year - 399) / 400;
+  int64_t const yoe = year - era * 400;
+  int64_t const doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int64_t const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
 
-      case TRI_JSON_NUMBER: {
-        if (std::isnan(json->_value._number) ||
-            ! std::isfinite(json->_value._number)) {
-          // invalid value
-          length = strlen("null");
-        }
-        else {
-          // convert to a string representation of the number
-          char buffer[24];
-          length = static_cast<size_t>(fpconv_dtoa(json->_value._number, buffer));
-        }
-        break;
-      }
+  return era * 146097 + doe - 719468;
+}
 
-      case TRI_JSON_STRING:
-      case TRI_JSON_STRING_REFERENCE: {
-        // return number of characters (not bytes) in string
-        length = TRI_CharLengthUtf8String(json->_value._string.data);
-        break;
-      }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calendar date for the number of days since 1970-01-01
+////////////////////////////////////////////////////////////////////////////////
 
-      case TRI_JSON_OBJECT: {
-        // return number of attributes
-        length = TRI_LengthVector(&json->_value._objects) / 2;
-        break;
-      }
+static void CivilFromDays (int64_t days,
+                           int64_t& year,
+                           int& month,
+                           int& day) {
+  days += 719468;
+  int64_t const era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t const doe = days - era * 146097;
+  int64_t const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t const mp  = (5 * doy + 2) / 153;
+
+  day   = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  year  = yoe + era * 400 + (month <= 2 ? 1 : 0);
+}
 
-      case TRI_JSON_ARRAY: {
-        // return list length
-        length = TRI_LengthArrayJson(json);
-        break;
-      }
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief split a timestamp (milliseconds since the epoch) into its UTC
+/// date components
+////////////////////////////////////////////////////////////////////////////////
+
+static void DecomposeDate (int64_t timestamp,
+                           DateComponents& components) {
+  int64_t days = timestamp / MillisecondsPerDay;
+  int64_t rest = timestamp % MillisecondsPerDay;
+
+  if (rest < 0) {
+    --days;
+    rest += MillisecondsPerDay;
   }
 
-  return AqlValue(new Json(static_cast<double>(length)));
+  CivilFromDays(days, components._year, components._month, components._day);
+
+  // 1970-01-01 was a Thursday
+  components._weekday     = static_cast<int>(((days % 7) + 11) % 7);
+  components._hour        = static_cast<int>(rest / 3600000);
+  components._minute      = static_cast<int>((rest / 60000) % 60);
+  components._second      = static_cast<int>((rest / 1000) % 60);
+  components._millisecond = static_cast<int>(rest % 1000);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function CONCAT
+/// @brief build a timestamp from (possibly overflowing) date components
+///
+/// this mimics JavaScript's Date.UTC(): all components are truncated to
+/// integers, and overflowing values are carried into the next larger unit.
+/// the month is 0-based here. returns false if the resulting date is invalid
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Concat (triagens::aql::Query*,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+static bool ComposeDate (double year,
+                         double month,
+                         double day,
+                         double hour,
+                         double minute,
+                         double second,
+                         double millisecond,
+                         int64_t& result) {
+  if (! std::isfinite(year) ||
+      ! std::isfinite(month) ||
+      ! std::isfinite(day) ||
+      ! std::isfinite(hour) ||
+      ! std::isfinite(minute) ||
+      ! std::isfinite(second) ||
+      ! std::isfinite(millisecond)) {
+    return false;
+  }
 
-  size_t const n = parameters.size();
+  month = std::trunc(month);
+  double const carry = std::floor(month / 12.0);
+  year = std::trunc(year) + carry;
+  month -= carry * 12.0;
 
-  for (size_t i = 0; i < n; ++i) {
-    auto const member = ExtractFunctionParameter(trx, parameters, i, false);
+  if (std::abs(year) > 400000.0) {
+    // way outside the valid range
+    return false;
+  }
 
-    if (member.isEmpty() || member.isNull()) {
-      continue;
-    }
-      
-    TRI_json_t const* json = member.json();
-    
-    if (member.isArray()) {
-      // append each member individually
-      size_t const subLength = TRI_LengthArrayJson(json);
+  double const days = static_cast<double>(DaysFromCivil(static_cast<int64_t>(year), static_cast<int>(month) + 1, 1)) +
+                      std::trunc(day) - 1.0;
+  double const time = days * static_cast<double>(MillisecondsPerDay) +
+                      std::trunc(hour) * 3600000.0 +
+                      std::trunc(minute) * 60000.0 +
+                      std::trunc(second) * 1000.0 +
+                      std::trunc(millisecond);
 
-      for (size_t j = 0; j < subLength; ++j) {
-        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, j));
+  if (! std::isfinite(time) || std::abs(time) > MaxTimestamp) {
+    return false;
+  }
 
-        if (sub == nullptr || sub->_type == TRI_JSON_NULL) {
-          continue;
-        }
+  result = static_cast<int64_t>(time);
+  return true;
+}
 
-        AppendAsString(buffer, sub);
-      }
-    }
-    else {
-      // convert member to a string and append
-      AppendAsString(buffer, json);
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse between minDigits and maxDigits decimal digits
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ParseDigits (char const*& p,
+                         char const* end,
+                         int minDigits,
+                         int maxDigits,
+                         int& value) {
+  int digits = 0;
+  value = 0;
+
+  while (p < end && digits < maxDigits && *p >= '0' && *p <= '9') {
+    value = value * 10 + (*p - '0');
+    ++p;
+    ++digits;
   }
-  
-  // steal the StringBuffer's char* pointer so we can avoid copying data around
-  // multiple times
-  size_t length = buffer.length();
-  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, buffer.steal(), length));
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
+  return (digits >= minDigits);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function LIKE
+/// @brief parse a date string in ISO 8601 format
+///
+/// accepted formats are YYYY[-MM[-DD]][(T| )HH:MM[:SS[.fff]]][Z|(+|-)HH[[:]MM]],
+/// with the year optionally given as +YYYYYY or -YYYYYY. month and day may
+/// have one or two digits. date strings without a timezone are treated as UTC
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Like (triagens::aql::Query* query,
-                          triagens::arango::AqlTransaction* trx,
-                          FunctionParameters const& parameters) {
-  if (parameters.size() < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "LIKE", (int) 2, (int) 3);
+static bool ParseDateString (char const* p,
+                             size_t length,
+                             int64_t& result) {
+  char const* end = p + length;
+
+  // ignore leading and trailing whitespace
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    ++p;
+  }
+  while (p < end && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+    --end;
   }
 
-  bool const caseInsensitive = GetBooleanParameter(trx, parameters, 2, false);
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  if (p == end) {
+    return false;
+  }
 
-  // build pattern from parameter #1
-  auto const regex = ExtractFunctionParameter(trx, parameters, 1, false);
-  AppendAsString(buffer, regex.json());
-  size_t const length = buffer.length();
+  // year
+  int year;
+  bool negativeYear = false;
 
-  std::string const pattern = BuildRegexPattern(buffer.c_str(), length, caseInsensitive);
-  RegexMatcher* matcher = nullptr;
+  if (*p == '+' || *p == '-') {
+    negativeYear = (*p == '-');
+    ++p;
+    if (! ParseDigits(p, end, 6, 6, year)) {
+      return false;
+    }
+  }
+  else if (! ParseDigits(p, end, 4, 4, year)) {
+    return false;
+  }
 
-  if (RegexCache != nullptr) {
-    auto it = RegexCache->find(pattern);
+  int month = 1;
+  int day = 1;
 
-    // check regex cache
-    if (it != RegexCache->end()) {
-      matcher = (*it).second;
+  if (p < end && *p == '-') {
+    ++p;
+    if (! ParseDigits(p, end, 1, 2, month) || month < 1 || month > 12) {
+      return false;
+    }
+
+    if (p < end && *p == '-') {
+      ++p;
+      // days beyond the end of the month are carried into the next month
+      if (! ParseDigits(p, end, 1, 2, day) || day < 1 || day > 31) {
+        return false;
+      }
     }
   }
 
-  if (matcher == nullptr) {
-    matcher = triagens::basics::Utf8Helper::DefaultUtf8Helper.buildMatcher(pattern);
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  int millisecond = 0;
+  bool hasTime = false;
 
-    try {
-      if (RegexCache == nullptr) {
-        RegexCache = new std::unordered_map<std::string, RegexMatcher*>();
-      }
-      // insert into cache, no matter if pattern is valid or not
-      RegexCache->emplace(pattern, matcher);
+  if (p < end && (*p == 'T' || *p == 't' || *p == ' ')) {
+    ++p;
+    hasTime = true;
+
+    if (! ParseDigits(p, end, 1, 2, hour) || hour > 23) {
+      return false;
     }
-    catch (...) {
-      delete matcher;
-      ClearRegexCache();
-      throw;
+    if (p == end || *p != ':') {
+      return false;
+    }
+    ++p;
+    if (! ParseDigits(p, end, 2, 2, minute) || minute > 59) {
+      return false;
+    }
+
+    if (p < end && *p == ':') {
+      ++p;
+      if (! ParseDigits(p, end, 2, 2, second) || second > 59) {
+        return false;
+      }
+
+      if (p < end && (*p == '.' || *p == ',')) {
+        ++p;
+
+        // only the first three fractional digits are significant
+        int digits = 0;
+        int factor = 100;
+
+        while (p < end && *p >= '0' && *p <= '9') {
+          if (digits < 3) {
+            millisecond += (*p - '0') * factor;
+            factor /= 10;
+          }
+          ++p;
+          ++digits;
+        }
+
+        if (digits == 0) {
+          return false;
+        }
+      }
     }
   }
-  
-  if (matcher == nullptr) {
-    // compiling regular expression failed
-    RegisterWarning(query, "LIKE", TRI_ERROR_QUERY_INVALID_REGEX);
-    return AqlValue(new Json(Json::Null));
+
+  int64_t offset = 0;
+
+  if (p < end) {
+    if (*p == 'Z' || *p == 'z') {
+      ++p;
+    }
+    else if (hasTime && (*p == '+' || *p == '-')) {
+      bool const negative = (*p == '-');
+      int offsetHours;
+      int offsetMinutes = 0;
+
+      ++p;
+      if (! ParseDigits(p, end, 2, 2, offsetHours) || offsetHours > 23) {
+        return false;
+      }
+      if (p < end && *p == ':') {
+        ++p;
+      }
+      if (p < end && ! ParseDigits(p, end, 2, 2, offsetMinutes)) {
+        return false;
+      }
+      if (offsetMinutes > 59) {
+        return false;
+      }
+
+      offset = (offsetHours * 60 + offsetMinutes) * 60000LL;
+      if (negative) {
+        offset = -offset;
+      }
+    }
   }
 
-  // extract value
-  buffer.clear();
-  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
-  AppendAsString(buffer, value.json());
- 
-  bool error = false;
-  bool const result = triagens::basics::Utf8Helper::DefaultUtf8Helper.matches(matcher, buffer.c_str(), buffer.length(), error);
+  if (p != end) {
+    // trailing garbage
+    return false;
+  }
 
-  if (error) {
-    // compiling regular expression failed
-    RegisterWarning(query, "LIKE", TRI_ERROR_QUERY_INVALID_REGEX);
-    return AqlValue(new Json(Json::Null));
+  if (! ComposeDate(negativeYear ? - year : year, month - 1, day, hour, minute, second, millisecond, result)) {
+    return false;
   }
-        
-  return AqlValue(new Json(result));
+
+  result -= offset;
+
+  return (std::abs(static_cast<double>(result)) <= MaxTimestamp);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function PASSTHRU
+/// @brief parse the leading integer of a string, like JavaScript's parseInt()
+/// returns NaN if the string does not start with an integer
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Passthru (triagens::aql::Query*,
-                              triagens::arango::AqlTransaction* trx,
-                              FunctionParameters const& parameters) {
+static double ParseIntegerPrefix (char const* p,
+                                  size_t length) {
+  char const* end = p + length;
 
-  if (parameters.empty()) {
-    return AqlValue(new Json(Json::Null));
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    ++p;
   }
 
-  auto json = ExtractFunctionParameter(trx, parameters, 0, true);
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, json.steal()));
-}
+  bool negative = false;
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNSET
-////////////////////////////////////////////////////////////////////////////////
+  if (p < end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    ++p;
+  }
 
-AqlValue Functions::Unset (triagens::aql::Query* query,
-                           triagens::arango::AqlTransaction* trx,
-                           FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+  if (p == end || *p < '0' || *p > '9') {
+    return std::nan("");
+  }
 
-  if (! value.isObject()) {
-    RegisterInvalidArgumentWarning(query, "UNSET");
-    return AqlValue(new Json(Json::Null));
+  double value = 0.0;
+
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value * 10.0 + (*p - '0');
+    ++p;
   }
- 
-  std::unordered_set<std::string> names;
-  ExtractKeys(names, query, trx, parameters, 1, "UNSET");
 
+  return negative ? - value : value;
+}
 
-  // create result object
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert a timestamp into an ISO 8601 string, like JavaScript's
+/// Date.toISOString(). years outside 0 - 9999 are written with 6 digits and
+/// a sign
+////////////////////////////////////////////////////////////////////////////////
 
-  size_t size;
-  if (names.size() >= n / 2) {
-    size = 4; 
+static std::string DateToString (int64_t timestamp) {
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  char buffer[32];
+  int length;
+
+  if (components._year >= 0 && components._year <= 9999) {
+    length = snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                      static_cast<int>(components._year),
+                      components._month,
+                      components._day,
+                      components._hour,
+                      components._minute,
+                      components._second,
+                      components._millisecond);
   }
   else {
-    size = (n / 2) - names.size(); 
+    length = snprintf(buffer, sizeof(buffer), "%c%06d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                      (components._year < 0 ? '-' : '+'),
+                      static_cast<int>(std::abs(components._year)),
+                      components._month,
+                      components._day,
+                      components._hour,
+                      components._minute,
+                      components._second,
+                      components._millisecond);
   }
 
-  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, size));
+  return std::string(buffer, static_cast<size_t>(length));
+}
 
-  if (j == nullptr) {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief convert a single value (timestamp or date string) into a timestamp
+/// returns TRI_ERROR_NO_ERROR or the error code for the warning to register
+////////////////////////////////////////////////////////////////////////////////
 
-  for (size_t i = 0; i < n; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+static int MakeDate (TRI_json_t const* json,
+                     int64_t& result) {
+  if (TRI_IsNumberJson(json)) {
+    double const value = json->_value._number;
 
-    if (TRI_IsStringJson(key) && 
-        names.find(key->_value._string.data) == names.end()) {
-      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+    if (std::abs(value) > MaxTimestamp) {
+      return TRI_ERROR_QUERY_INVALID_DATE_VALUE;
+    }
 
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      } 
+    result = static_cast<int64_t>(value);
+    return TRI_ERROR_NO_ERROR;
+  }
 
-      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+  if (TRI_IsStringJson(json)) {
+    if (! ParseDateString(json->_value._string.data, json->_value._string.length - 1, result)) {
+      return TRI_ERROR_QUERY_INVALID_DATE_VALUE;
     }
-  } 
+    return TRI_ERROR_NO_ERROR;
+  }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
+  return TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function KEEP
+/// @brief convert a list of date components (year, month, day, hour, minute,
+/// second, millisecond) into a timestamp, or a single value if only one
+/// parameter is given. returns TRI_ERROR_NO_ERROR or the error code for the
+/// warning to register
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Keep (triagens::aql::Query* query,
-                          triagens::arango::AqlTransaction* trx,
-                          FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static int MakeDate (triagens::arango::AqlTransaction* trx,
+                     FunctionParameters const& parameters,
+                     int64_t& result) {
+  size_t const n = parameters.size();
 
-  if (! value.isObject()) {
-    RegisterInvalidArgumentWarning(query, "KEEP");
-    return AqlValue(new Json(Json::Null));
+  if (n == 1) {
+    auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    return MakeDate(value.json(), result);
   }
- 
-  std::unordered_set<std::string> names;
-  ExtractKeys(names, query, trx, parameters, 1, "KEEP");
-
-
-  // create result object
-  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, names.size()));
 
-  if (j == nullptr) {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  if (n < 3) {
+    return TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH;
   }
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+  double components[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
 
-  for (size_t i = 0; i < n; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+  for (size_t i = 0; i < n && i < 7; ++i) {
+    auto value = ExtractFunctionParameter(trx, parameters, i, false);
+    TRI_json_t const* json = value.json();
 
-    if (TRI_IsStringJson(key) && 
-        names.find(key->_value._string.data) != names.end()) {
-      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+    if (TRI_IsNumberJson(json)) {
+      components[i] = json->_value._number;
+    }
+    else if (TRI_IsStringJson(json)) {
+      components[i] = ParseIntegerPrefix(json->_value._string.data, json->_value._string.length - 1);
+    }
+    else if (json == nullptr || json->_type == TRI_JSON_NULL) {
+      // null counts as 0, even for the month
+      continue;
+    }
+    else {
+      return TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH;
+    }
 
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      } 
+    if (components[i] < 0.0) {
+      return TRI_ERROR_QUERY_INVALID_DATE_VALUE;
+    }
 
-      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+    if (i == 1) {
+      // months are 1-based in AQL
+      components[i] -= 1.0;
     }
-  } 
+  }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
-  j.release();
-  return AqlValue(jr);
+  // two-digit years are interpreted as 19xx, as in Date.UTC()
+  double const year = std::trunc(components[0]);
+  if (year >= 0.0 && year <= 99.0) {
+    components[0] = 1900.0 + year;
+  }
+
+  if (! ComposeDate(components[0], components[1], components[2], components[3], 
+                    components[4], components[5], components[6], result)) {
+    return TRI_ERROR_QUERY_INVALID_DATE_VALUE;
+  }
+
+  return TRI_ERROR_NO_ERROR;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MERGE
+/// @brief register the warnings for a failed date conversion
+/// an invalid date value warning is registered in any case
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Merge (triagens::aql::Query* query,
-                           triagens::arango::AqlTransaction* trx,
-                           FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
-
-  if (n == 0) {
-    // no parameters
-    return AqlValue(new Json(Json::Object));
+static void RegisterDateWarning (triagens::aql::Query* query,
+                                 char const* functionName,
+                                 int code) {
+  if (code != TRI_ERROR_QUERY_INVALID_DATE_VALUE) {
+    RegisterWarning(query, functionName, code);
   }
+  RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+}
 
-  // use the first argument as the preliminary result
-  auto initial = ExtractFunctionParameter(trx, parameters, 0, true);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract a function parameter as a timestamp
+/// registers warnings and returns false if the parameter is not a valid date
+////////////////////////////////////////////////////////////////////////////////
 
-  if (! initial.isObject()) {
-    RegisterInvalidArgumentWarning(query, "MERGE");
-    return AqlValue(new Json(Json::Null));
+static bool ExtractDateParameter (triagens::aql::Query* query,
+                                  triagens::arango::AqlTransaction* trx,
+                                  FunctionParameters const& parameters,
+                                  size_t position,
+                                  char const* functionName,
+                                  int64_t& result) {
+  auto value = ExtractFunctionParameter(trx, parameters, position, false);
+  int res = MakeDate(value.json(), result);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    RegisterDateWarning(query, functionName, res);
+    return false;
   }
 
-  std::unique_ptr<TRI_json_t> result(initial.steal());
+  return true;
+}
 
-  // now merge in all other arguments
-  for (size_t i = 1; i < n; ++i) {
-    auto param = ExtractFunctionParameter(trx, parameters, i, false);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up a date unit name (e.g. "y", "years", "ms")
+/// returns one of 'y', 'm', 'w', 'd', 'h', 'i', 's', 'f', or '\0' if the unit
+/// name is unknown
+////////////////////////////////////////////////////////////////////////////////
 
-    if (! param.isObject()) {
-      RegisterInvalidArgumentWarning(query, "MERGE");
-      return AqlValue(new Json(Json::Null));
-    }
- 
-    auto merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, result.get(), param.json(), false, true);
+static char LookupDateUnit (TRI_json_t const* json,
+                            bool caseInsensitive) {
+  static std::unordered_map<std::string, char> const units({
+    { "y", 'y' }, { "year", 'y' }, { "years", 'y' },
+    { "m", 'm' }, { "month", 'm' }, { "months", 'm' },
+    { "w", 'w' }, { "week", 'w' }, { "weeks", 'w' },
+    { "d", 'd' }, { "day", 'd' }, { "days", 'd' },
+    { "h", 'h' }, { "hour", 'h' }, { "hours", 'h' },
+    { "i", 'i' }, { "minute", 'i' }, { "minutes", 'i' },
+    { "s", 's' }, { "second", 's' }, { "seconds", 's' },
+    { "f", 'f' }, { "millisecond", 'f' }, { "milliseconds", 'f' }, { "ms", 'f' }
+  });
+
+  if (! TRI_IsStringJson(json)) {
+    return '\0';
+  }
 
-    if (merged == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
+  std::string name(json->_value._string.data, json->_value._string.length - 1);
 
-    result.reset(merged);
-  } 
+  if (caseInsensitive) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+  auto it = units.find(name);
+
+  if (it == units.end()) {
+    return '\0';
+  }
+
+  return (*it).second;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function HAS
+/// @brief add an amount of a date unit to a timestamp, carrying over into the
+/// larger units like the JavaScript Date setters do
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Has (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
-
-  if (n < 2) {
-    // no parameters
-    return AqlValue(new Json(false));
-  }
-    
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-
-  if (! value.isObject()) {
-    // not an object
-    return AqlValue(new Json(false));
+static bool AdjustDate (int64_t& timestamp,
+                        char unit,
+                        double amount) {
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  double year        = static_cast<double>(components._year);
+  double month       = static_cast<double>(components._month - 1);
+  double day         = static_cast<double>(components._day);
+  double hour        = static_cast<double>(components._hour);
+  double minute      = static_cast<double>(components._minute);
+  double second      = static_cast<double>(components._second);
+  double millisecond = static_cast<double>(components._millisecond);
+
+  switch (unit) {
+    case 'y':
+      year += amount;
+      break;
+    case 'm':
+      month += amount;
+      break;
+    case 'w':
+      day += amount * 7.0;
+      break;
+    case 'd':
+      day += amount;
+      break;
+    case 'h':
+      hour += amount;
+      break;
+    case 'i':
+      minute += amount;
+      break;
+    case 's':
+      second += amount;
+      break;
+    case 'f':
+      millisecond += amount;
+      break;
+    default:
+      return false;
   }
- 
-  // process name parameter 
-  auto name = ExtractFunctionParameter(trx, parameters, 1, false);
-
-  char const* p;
 
-  if (! name.isString()) {
-    triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-    AppendAsString(buffer, name.json());
-    p = buffer.c_str();
-  }
-  else {
-    p = name.json()->_value._string.data;
-  }
- 
-  bool const hasAttribute = (TRI_LookupObjectJson(value.json(), p) != nullptr);
-  return AqlValue(new Json(hasAttribute));
+  return ComposeDate(year, month, day, hour, minute, second, millisecond, timestamp);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function ATTRIBUTES
+/// @brief parse an ISO 8601 duration string, e.g. P1Y2M3W4DT5H6M7.890S
+///
+/// the amounts are returned in the order y, m, w, d, h, i, s, f. amounts that
+/// are not present in the string are returned as -1
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Attributes (triagens::aql::Query* query,
-                                triagens::arango::AqlTransaction* trx,
-                                FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+static bool ParseDuration (char const* p,
+                           size_t length,
+                           double* amounts) {
+  static char const DateDesignators[] = "YMWD";
+  static char const TimeDesignators[] = "HMS";
 
-  if (n < 1) {
-    // no parameters
-    return AqlValue(new Json(Json::Null));
-  }
-    
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+  char const* end = p + length;
 
-  if (! value.isObject()) {
-    // not an object
-    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
-    return AqlValue(new Json(Json::Null));
+  for (size_t i = 0; i < 8; ++i) {
+    amounts[i] = -1.0;
   }
- 
-  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
-  bool const doSort = GetBooleanParameter(trx, parameters, 2, false);
-
-  auto const valueJson = value.json();
-  TRI_ASSERT(TRI_IsObjectJson(valueJson));
-
-  size_t const numValues = TRI_LengthVectorJson(valueJson);
 
-  if (numValues == 0) {
-    // empty object
-    return AqlValue(new Json(Json::Object));
+  if (p == end || (*p != 'P' && *p != 'p')) {
+    return false;
   }
+  ++p;
 
-  std::vector<std::pair<char const*, size_t>> sortPositions;
-  sortPositions.reserve(numValues / 2);
-
-  // create a vector with positions into the object
-  for (size_t i = 0; i < numValues; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+  bool inTime = false;
+  size_t next = 0;
 
-    if (! TRI_IsStringJson(key)) {
-      // somehow invalid
+  while (p < end) {
+    if (! inTime && (*p == 'T' || *p == 't')) {
+      inTime = true;
+      next = 0;
+      ++p;
       continue;
     }
 
-    if (removeInternal && *key->_value._string.data == '_') {
-      // skip attribute
-      continue;
+    if (*p < '0' || *p > '9') {
+      return false;
     }
 
-    sortPositions.emplace_back(std::make_pair(key->_value._string.data, i));
-  }
-
-  if (doSort) {
-    // sort according to attribute name
-    std::sort(sortPositions.begin(), sortPositions.end(), [] (std::pair<char const*, size_t> const& lhs,
-                                                              std::pair<char const*, size_t> const& rhs) -> bool {
-      return TRI_compare_utf8(lhs.first, rhs.first) < 0;
-    });
-  }
-
-  // create the output
-  Json result(Json::Array, sortPositions.size());
-
-  // iterate over either sorted or unsorted object 
-  for (auto const& it : sortPositions) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, it.second));
-
-    result.add(Json(std::string(key->_value._string.data, key->_value._string.length - 1)));
-  } 
-
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief function VALUES
-////////////////////////////////////////////////////////////////////////////////
+    double value = 0.0;
 
-AqlValue Functions::Values (triagens::aql::Query* query,
-                            triagens::arango::AqlTransaction* trx,
-                            FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+    while (p < end && *p >= '0' && *p <= '9') {
+      value = value * 10.0 + (*p - '0');
+      ++p;
+    }
 
-  if (n < 1) {
-    // no parameters
-    return AqlValue(new Json(Json::Null));
-  }
-    
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    double fraction = -1.0;
 
-  if (! value.isObject()) {
-    // not an object
-    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
-    return AqlValue(new Json(Json::Null));
-  }
- 
-  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
+    if (inTime && p < end && *p == '.') {
+      // fractional seconds. only the first three digits are used
+      ++p;
+      int digits = 0;
+      double factor = 100.0;
+      fraction = 0.0;
 
-  auto const valueJson = value.json();
-  TRI_ASSERT(TRI_IsObjectJson(valueJson));
+      while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 3) {
+          fraction += (*p - '0') * factor;
+          factor /= 10.0;
+        }
+        ++p;
+        ++digits;
+      }
 
-  size_t const numValues = TRI_LengthVectorJson(valueJson);
+      if (digits == 0) {
+        return false;
+      }
+    }
 
-  if (numValues == 0) {
-    // empty object
-    return AqlValue(new Json(Json::Object));
-  }
+    if (p == end) {
+      return false;
+    }
 
-  // create the output
-  Json result(Json::Array, numValues);
+    char const designator = static_cast<char>(::toupper(*p));
+    char const* designators = (inTime ? TimeDesignators : DateDesignators);
+    size_t const n = (inTime ? 3 : 4);
 
-  // create a vector with positions into the object
-  for (size_t i = 0; i < numValues; i += 2) {
-    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+    // designators must appear in order, and each one at most once
+    while (next < n && designators[next] != designator) {
+      ++next;
+    }
 
-    if (! TRI_IsStringJson(key)) {
-      // somehow invalid
-      continue;
+    if (next == n || (fraction >= 0.0 && designator != 'S')) {
+      return false;
     }
 
-    if (removeInternal && *key->_value._string.data == '_') {
-      // skip attribute
-      continue;
+    amounts[(inTime ? 4 : 0) + next] = value;
+    if (fraction >= 0.0) {
+      amounts[7] = fraction;
     }
 
-    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i + 1));
-    result.add(Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value)));
+    ++next;
+    ++p;
   }
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MIN
+/// @brief shared implementation of DATE_ADD and DATE_SUBTRACT
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Min (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static AqlValue DateCalculation (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters,
+                                 char const* functionName,
+                                 double sign) {
+  int64_t timestamp;
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "MIN", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+  if (! ExtractDateParameter(query, trx, parameters, 0, functionName, timestamp)) {
     return AqlValue(new Json(Json::Null));
   }
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  TRI_json_t const* minValue = nullptr;;
+  auto amount = ExtractFunctionParameter(trx, parameters, 1, false);
+  auto unit = ExtractFunctionParameter(trx, parameters, 2, false);
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  if (unit.isNull()) {
+    // amount must be an ISO 8601 duration string
+    if (! TRI_IsStringJson(amount.json())) {
+      RegisterInvalidArgumentWarning(query, functionName);
+      return AqlValue(new Json(Json::Null));
+    }
 
-    if (TRI_IsNullJson(value)) {
-      continue;
+    static char const Units[] = "ymwdhisf";
+    double amounts[8];
+
+    if (! ParseDuration(amount.json()->_value._string.data, amount.json()->_value._string.length - 1, amounts)) {
+      RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+      return AqlValue(new Json(Json::Null));
     }
 
-    if (minValue == nullptr ||
-        TRI_CompareValuesJson(value, minValue) < 0) {
-      minValue = value;
+    // apply component by component, from milliseconds to years
+    for (size_t i = 8; i > 0; --i) {
+      if (amounts[i - 1] >= 0.0 &&
+          ! AdjustDate(timestamp, Units[i - 1], amounts[i - 1] * sign)) {
+        RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+        return AqlValue(new Json(Json::Null));
+      }
+    }
+  }
+  else {
+    if (! unit.isString() || ! amount.isNumber()) {
+      RegisterInvalidArgumentWarning(query, functionName);
+      return AqlValue(new Json(Json::Null));
     }
-  } 
 
-  if (minValue != nullptr) {
-    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, minValue));
-    
-    if (result != nullptr) {
-      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-      result.release();
-      return AqlValue(jr);
+    char const u = LookupDateUnit(unit.json(), true);
+
+    if (u == '\0' ||
+        ! AdjustDate(timestamp, u, amount.json()->_value._number * sign)) {
+      RegisterWarning(query, functionName, TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+      return AqlValue(new Json(Json::Null));
     }
   }
 
-  return AqlValue(new Json(Json::Null));
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, DateToString(timestamp)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MAX
+/// @brief ISO week number (1 - 53) of a timestamp
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Max (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static int IsoWeek (int64_t timestamp) {
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "MAX", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
+  // move to the Thursday of the same week. its year is the ISO week year
+  int64_t days = DaysFromCivil(components._year, components._month, components._day) +
+                 4 - (components._weekday == 0 ? 7 : components._weekday);
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  TRI_json_t const* maxValue = nullptr;;
+  int64_t year;
+  int month;
+  int day;
+  CivilFromDays(days, year, month, day);
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  return static_cast<int>((days - DaysFromCivil(year, 1, 1)) / 7 + 1);
+}
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief placeholders for DATE_FORMAT
+/// the escape sequence comes first, the rest is ordered by length so the
+/// longest placeholder wins
+////////////////////////////////////////////////////////////////////////////////
 
-    if (maxValue == nullptr ||
-        TRI_CompareValuesJson(value, maxValue) > 0) {
-      maxValue = value;
-    }
-  } 
+static char const* DateFormatPlaceholders[] = {
+  "%&", "%yyyyyy", "%yyyy", "%mmmm", "%wwww", "%mmm", "%www", "%fff", "%xxx",
+  "%yy", "%mm", "%dd", "%hh", "%ii", "%ss", "%kk", "%t", "%z", "%w", "%y", "%m",
+  "%d", "%h", "%i", "%s", "%f", "%x", "%k", "%l", "%q", "%a", "%%", "%"
+};
 
-  if (maxValue != nullptr) {
-    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, maxValue));
-    
-    if (result != nullptr) {
-      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-      result.release();
-      return AqlValue(jr);
-    }
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a zero-padded number
+////////////////////////////////////////////////////////////////////////////////
 
-  return AqlValue(new Json(Json::Null));
+static void AppendZeroPadded (triagens::basics::StringBuffer& buffer,
+                              int64_t value,
+                              size_t width) {
+  std::string const number = std::to_string(value);
+
+  for (size_t i = number.size(); i < width; ++i) {
+    buffer.appendChar('0');
+  }
+  buffer.appendText(number);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function SUM
+/// @brief append a substring of the ISO 8601 representation of a date
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Sum (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+static void AppendSlice (triagens::basics::StringBuffer& buffer,
+                         std::string const& value,
+                         size_t from,
+                         size_t to) {
+  if (from < value.size() && from < to) {
+    buffer.appendText(value.c_str() + from, (std::min)(to, value.size()) - from);
+  }
+}
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "SUM", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a date formatted according to the DATE_FORMAT placeholders
+////////////////////////////////////////////////////////////////////////////////
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  double sum = 0.0;
+static void AppendFormattedDate (triagens::basics::StringBuffer& buffer,
+                                 int64_t timestamp,
+                                 char const* format,
+                                 size_t length) {
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+  std::string const iso = DateToString(timestamp);
+  bool const extendedYear = (components._year < 0 || components._year > 9999);
+  size_t const offset = (extendedYear ? 3 : 0);
 
-    if (TRI_IsNullJson(value)) {
+  char const* p = format;
+  char const* end = format + length;
+
+  while (p < end) {
+    if (*p != '%') {
+      buffer.appendChar(*p++);
       continue;
     }
 
-    if (! TRI_IsNumberJson(value)) {
-      RegisterInvalidArgumentWarning(query, "SUM");
-      return AqlValue(new Json(Json::Null));
-    }
+    // find the first matching placeholder (case-insensitive)
+    std::string placeholder;
 
-    // got a numeric value
-    double const number = value->_value._number;
+    for (auto const& candidate : DateFormatPlaceholders) {
+      size_t const n = strlen(candidate);
 
-    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
-      sum += number;
-    } 
-  } 
+      if (static_cast<size_t>(end - p) >= n && 
+          TRI_CaseEqualString2(p, candidate, n)) {
+        placeholder = candidate;
+        break;
+      }
+    }
 
-  if (! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
-    return AqlValue(new Json(sum));
-  } 
+    p += placeholder.size();
 
-  return AqlValue(new Json(Json::Null));
+    if (placeholder == "%t") {
+      buffer.appendInteger(timestamp);
+    }
+    else if (placeholder == "%z") {
+      buffer.appendText(iso);
+    }
+    else if (placeholder == "%w") {
+      buffer.appendInteger(static_cast<int32_t>(components._weekday));
+    }
+    else if (placeholder == "%y") {
+      buffer.appendInteger(components._year);
+    }
+    else if (placeholder == "%yy") {
+      if (components._year < 0) {
+        buffer.appendChar('-');
+      }
+      AppendSlice(buffer, iso, 2 + offset, 4 + offset);
+    }
+    else if (placeholder == "%yyyy") {
+      AppendSlice(buffer, iso, 0, 4 + offset);
+    }
+    else if (placeholder == "%yyyyyy") {
+      if (extendedYear) {
+        AppendSlice(buffer, iso, 0, 7);
+      }
+      else {
+        buffer.appendChar('+');
+        AppendZeroPadded(buffer, components._year, 6);
+      }
+    }
+    else if (placeholder == "%m") {
+      buffer.appendInteger(static_cast<int32_t>(components._month));
+    }
+    else if (placeholder == "%mm") {
+      AppendSlice(buffer, iso, 5 + offset, 7 + offset);
+    }
+    else if (placeholder == "%d") {
+      buffer.appendInteger(static_cast<int32_t>(components._day));
+    }
+    else if (placeholder == "%dd") {
+      AppendSlice(buffer, iso, 8 + offset, 10 + offset);
+    }
+    else if (placeholder == "%h") {
+      buffer.appendInteger(static_cast<int32_t>(components._hour));
+    }
+    else if (placeholder == "%hh") {
+      AppendSlice(buffer, iso, 11 + offset, 13 + offset);
+    }
+    else if (placeholder == "%i") {
+      buffer.appendInteger(static_cast<int32_t>(components._minute));
+    }
+    else if (placeholder == "%ii") {
+      AppendSlice(buffer, iso, 14 + offset, 16 + offset);
+    }
+    else if (placeholder == "%s") {
+      buffer.appendInteger(static_cast<int32_t>(components._second));
+    }
+    else if (placeholder == "%ss") {
+      AppendSlice(buffer, iso, 17 + offset, 19 + offset);
+    }
+    else if (placeholder == "%f") {
+      buffer.appendInteger(static_cast<int32_t>(components._millisecond));
+    }
+    else if (placeholder == "%fff") {
+      AppendSlice(buffer, iso, 20 + offset, 23 + offset);
+    }
+    else if (placeholder == "%x") {
+      buffer.appendInteger(static_cast<int32_t>(DayOfYear(components)));
+    }
+    else if (placeholder == "%xxx") {
+      AppendZeroPadded(buffer, DayOfYear(components), 3);
+    }
+    else if (placeholder == "%k") {
+      buffer.appendInteger(static_cast<int32_t>(IsoWeek(timestamp)));
+    }
+    else if (placeholder == "%kk") {
+      AppendZeroPadded(buffer, IsoWeek(timestamp), 2);
+    }
+    else if (placeholder == "%l") {
+      buffer.appendChar(IsLeapYear(components._year) ? '1' : '0');
+    }
+    else if (placeholder == "%q") {
+      buffer.appendInteger(static_cast<int32_t>((components._month - 1) / 3 + 1));
+    }
+    else if (placeholder == "%a") {
+      buffer.appendInteger(static_cast<int32_t>(DaysInMonth(components._year, components._month)));
+    }
+    else if (placeholder == "%mmm") {
+      buffer.appendText(MonthNames[components._month - 1], 3);
+    }
+    else if (placeholder == "%mmmm") {
+      buffer.appendText(MonthNames[components._month - 1]);
+    }
+    else if (placeholder == "%www") {
+      buffer.appendText(WeekdayNames[components._weekday], 3);
+    }
+    else if (placeholder == "%wwww") {
+      buffer.appendText(WeekdayNames[components._weekday]);
+    }
+    else if (placeholder == "%%") {
+      buffer.appendChar('%');
+    }
+    // "%&" and a lone "%" produce no output
+  }
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                      AQL functions public helpers
+// -----------------------------------------------------------------------------
+
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function AVERAGE
+/// @brief called before a query starts
+/// has the chance to set up any thread-local storage
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Average (triagens::aql::Query* query,
-                             triagens::arango::AqlTransaction* trx,
-                             FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+void Functions::InitializeThreadContext () {
+}
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "AVERAGE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief called when a query ends
+/// its responsibility is to clear any thread-local storage
+////////////////////////////////////////////////////////////////////////////////
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
-  double sum = 0.0;
-  size_t count = 0;
+void Functions::DestroyThreadContext () {
+  ClearRegexCache();
+}
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+// -----------------------------------------------------------------------------
+// --SECTION--                                             AQL function bindings
+// -----------------------------------------------------------------------------
 
-    if (TRI_IsNullJson(value)) {
-      continue;
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_NULL
+////////////////////////////////////////////////////////////////////////////////
 
-    if (! TRI_IsNumberJson(value)) {
-      RegisterInvalidArgumentWarning(query, "AVERAGE");
-      return AqlValue(new Json(Json::Null));
-    }
+AqlValue Functions::IsNull (triagens::aql::Query*, 
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isNull()));
+}
 
-    // got a numeric value
-    double const number = value->_value._number;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_BOOL
+////////////////////////////////////////////////////////////////////////////////
 
-    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
-      sum += number;
-      ++count;
-    } 
-  } 
+AqlValue Functions::IsBool (triagens::aql::Query*,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isBoolean()));
+}
 
-  if (count > 0 && 
-      ! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
-    return AqlValue(new Json(sum / static_cast<size_t>(count)));
-  } 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_NUMBER
+////////////////////////////////////////////////////////////////////////////////
 
-  return AqlValue(new Json(Json::Null));
+AqlValue Functions::IsNumber (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isNumber()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function MD5
+/// @brief function IS_STRING
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Md5 (triagens::aql::Query* query,
-                         triagens::arango::AqlTransaction* trx,
-                         FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-    
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-  AppendAsString(buffer, value.json());
-  
-  // create md5
-  char hash[17]; 
-  char* p = &hash[0];
-  size_t length;
+AqlValue Functions::IsString (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isString()));
+}
 
-  triagens::rest::SslInterface::sslMD5(buffer.c_str(), buffer.length(), p, length);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_ARRAY
+////////////////////////////////////////////////////////////////////////////////
 
-  // as hex
-  char hex[33];
-  p = &hex[0];
+AqlValue Functions::IsArray (triagens::aql::Query*,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isArray()));
+}
 
-  triagens::rest::SslInterface::sslHEX(hash, 16, p, length);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function IS_OBJECT
+////////////////////////////////////////////////////////////////////////////////
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 32));
+AqlValue Functions::IsObject (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  return AqlValue(new Json(value.isObject()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function SHA1
+/// @brief function TO_NUMBER
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Sha1 (triagens::aql::Query* query,
-                          triagens::arango::AqlTransaction* trx,
-                          FunctionParameters const& parameters) {
-  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
-    
-  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
-  AppendAsString(buffer, value.json());
-  
-  // create sha1
-  char hash[21];
-  char* p = &hash[0];
-  size_t length;
+AqlValue Functions::ToNumber (triagens::aql::Query*,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
 
-  triagens::rest::SslInterface::sslSHA1(buffer.c_str(), buffer.length(), p, length);
+  bool isValid;
+  double v = ValueToNumber(value.json(), isValid);
 
-  // as hex
-  char hex[41];
-  p = &hex[0];
+  if (! isValid) {
+    return AqlValue(new Json(Json::Null));
+  }
+  return AqlValue(new Json(v));
+}
 
-  triagens::rest::SslInterface::sslHEX(hash, 20, p, length);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function TO_STRING
+////////////////////////////////////////////////////////////////////////////////
 
-  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 40));
+AqlValue Functions::ToString (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  AppendAsString(buffer, value.json());
+  size_t length = buffer.length();
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, buffer.steal(), length));
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNIQUE
+/// @brief function TO_BOOL
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Unique (triagens::aql::Query* query,
+AqlValue Functions::ToBool (triagens::aql::Query*,
                             triagens::arango::AqlTransaction* trx,
                             FunctionParameters const& parameters) {
-  if (parameters.size() != 1) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNIQUE", (int) 1, (int) 1);
-  }
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  return AqlValue(new Json(ValueToBoolean(value.json())));
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function TO_ARRAY
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::ToArray (triagens::aql::Query*,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
   auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
 
-  if (! value.isArray()) {
-    // not an array
-    RegisterWarning(query, "UNIQUE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-    return AqlValue(new Json(Json::Null));
+  if (value.isBoolean() ||
+      value.isNumber() ||
+      value.isString()) {
+    // return array with single member
+    Json array(Json::Array, 1);
+    array.add(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value.json()));
+
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, array.steal()));
   }
-  
-  std::unordered_set<TRI_json_t const*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
+  if (value.isArray()) {
+    // return copy of the original array
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value.json())));
+  }
+  if (value.isObject()) {
+    // return an array with the attribute values
+    auto const source = value.json();
+    size_t const n = TRI_LengthVector(&source->_value._objects);
 
-  TRI_json_t const* valueJson = value.json();
-  size_t const n = TRI_LengthArrayJson(valueJson);
+    Json array(Json::Array, n);
+    for (size_t i = 1; i < n; i += 2) {
+      auto v = static_cast<TRI_json_t const*>(TRI_AtVector(&source->_value._objects, i));
+      array.add(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, v));
+    } 
+
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, array.steal()));
+  }
+
+  // return empty array
+  return AqlValue(new Json(Json::Array));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function LENGTH
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Length (triagens::aql::Query*,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  if (! parameters.empty() &&
+      parameters[0].first.isArray()) {
+    // shortcut!
+    return AqlValue(new Json(static_cast<double>(parameters[0].first.arraySize())));
+  }
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  TRI_json_t const* json = value.json();
+  size_t length = 0;
+
+  if (json != nullptr) {
+    switch (json->_type) {
+      case TRI_JSON_UNUSED:
+      case TRI_JSON_NULL: {
+        length = 0;
+        break;
+      }
+
+      case TRI_JSON_BOOLEAN: {
+        length = (json->_value._boolean ? 1 : 0);
+        break;
+      }
+
+      case TRI_JSON_NUMBER: {
+        if (std::isnan(json->_value._number) ||
+            ! std::isfinite(json->_value._number)) {
+          // invalid value
+          length = strlen("null");
+        }
+        else {
+          // convert to a string representation of the number
+          char buffer[24];
+          length = static_cast<size_t>(fpconv_dtoa(json->_value._number, buffer));
+        }
+        break;
+      }
+
+      case TRI_JSON_STRING:
+      case TRI_JSON_STRING_REFERENCE: {
+        // return number of characters (not bytes) in string
+        length = TRI_CharLengthUtf8String(json->_value._string.data);
+        break;
+      }
+
+      case TRI_JSON_OBJECT: {
+        // return number of attributes
+        length = TRI_LengthVector(&json->_value._objects) / 2;
+        break;
+      }
+
+      case TRI_JSON_ARRAY: {
+        // return list length
+        length = TRI_LengthArrayJson(json);
+        break;
+      }
+    }
+  }
+
+  return AqlValue(new Json(static_cast<double>(length)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function CONCAT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Concat (triagens::aql::Query*,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  size_t const n = parameters.size();
 
   for (size_t i = 0; i < n; ++i) {
-    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+    auto const member = ExtractFunctionParameter(trx, parameters, i, false);
 
-    if (value == nullptr) {
+    if (member.isEmpty() || member.isNull()) {
+      continue;
+    }
+      
+    TRI_json_t const* json = member.json();
+    
+    if (member.isArray()) {
+      // append each member individually
+      size_t const subLength = TRI_LengthArrayJson(json);
+
+      for (size_t j = 0; j < subLength; ++j) {
+        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, j));
+
+        if (sub == nullptr || sub->_type == TRI_JSON_NULL) {
+          continue;
+        }
+
+        AppendAsString(buffer, sub);
+      }
+    }
+    else {
+      // convert member to a string and append
+      AppendAsString(buffer, json);
+    }
+  }
+  
+  // steal the StringBuffer's char* pointer so we can avoid copying data around
+  // multiple times
+  return StringBufferToAqlValue(buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function CONCAT_SEPARATOR
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::ConcatSeparator (triagens::aql::Query*,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer separator(TRI_UNKNOWN_MEM_ZONE, 8);
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const first = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(separator, first.json());
+
+  size_t const n = parameters.size();
+  bool found = false;
+
+  for (size_t i = 1; i < n; ++i) {
+    auto const member = ExtractFunctionParameter(trx, parameters, i, false);
+
+    if (member.isEmpty() || member.isNull()) {
       continue;
     }
 
-    values.emplace(value); 
-  } 
+    if (found) {
+      buffer.appendText(separator);
+    }
 
-  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
- 
-  for (auto const& it : values) {
-    auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, it);
+    TRI_json_t const* json = member.json();
 
-    if (copy == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    if (member.isArray()) {
+      // append each member individually
+      size_t const subLength = TRI_LengthArrayJson(json);
+      found = false;
+
+      for (size_t j = 0; j < subLength; ++j) {
+        auto sub = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, j));
+
+        if (sub == nullptr || sub->_type == TRI_JSON_NULL) {
+          continue;
+        }
+
+        if (found) {
+          buffer.appendText(separator);
+        }
+        AppendAsString(buffer, sub);
+        found = true;
+      }
+    }
+    else {
+      // convert member to a string and append
+      AppendAsString(buffer, json);
+      found = true;
     }
- 
-    TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy); 
   }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
+
+  return StringBufferToAqlValue(buffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function CHAR_LENGTH
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::CharLength (triagens::aql::Query*,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  return AqlValue(new Json(static_cast<double>(Utf16Length(buffer.c_str(), buffer.length()))));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function LOWER
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Lower (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  int32_t length = 0;
+  char* result = triagens::basics::Utf8Helper::DefaultUtf8Helper.tolower(TRI_UNKNOWN_MEM_ZONE, buffer.c_str(), static_cast<int32_t>(buffer.length()), length);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, result, static_cast<size_t>(length)));
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
   return AqlValue(jr);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNION
+/// @brief function UPPER
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Union (triagens::aql::Query* query,
+AqlValue Functions::Upper (triagens::aql::Query*,
                            triagens::arango::AqlTransaction* trx,
                            FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
 
-  if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION", (int) 2, (int) Function::MaxArguments);
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  int32_t length = 0;
+  char* result = triagens::basics::Utf8Helper::DefaultUtf8Helper.toupper(TRI_UNKNOWN_MEM_ZONE, buffer.c_str(), static_cast<int32_t>(buffer.length()), length);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
   }
 
-  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 16));
+  std::unique_ptr<TRI_json_t> j(TRI_CreateStringJson(TRI_UNKNOWN_MEM_ZONE, result, static_cast<size_t>(length)));
 
-  for (size_t i = 0; i < n; ++i) {
-    auto value = ExtractFunctionParameter(trx, parameters, i, false);
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
 
-    if (! value.isArray()) {
-      // not an array
-      RegisterInvalidArgumentWarning(query, "UNION");
-      return AqlValue(new Json(Json::Null));
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SUBSTRING
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Substring (triagens::aql::Query*,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  UnicodeString const value = ExtractUnicodeStringParameter(trx, parameters, 0);
+
+  bool isValid;
+  auto const offset = ExtractFunctionParameter(trx, parameters, 1, false);
+  double const start = ValueToNumber(offset.json(), isValid);
+
+  double count = 0.0;
+  bool const hasCount = (parameters.size() > 2);
+
+  if (hasCount) {
+    auto const length = ExtractFunctionParameter(trx, parameters, 2, false);
+    count = ValueToNumber(length.json(), isValid);
+  }
+
+  int32_t from, n;
+  SubstringRange(value.length(), start, count, hasCount, from, n);
+
+  return UnicodeStringToAqlValue(value.tempSubString(from, n));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function CONTAINS
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Contains (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+  triagens::basics::StringBuffer search(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+  auto const needle = ExtractFunctionParameter(trx, parameters, 1, false);
+  AppendAsString(search, needle.json());
+
+  bool const returnIndex = GetBooleanParameter(trx, parameters, 2, false);
+  double result = -1.0;
+
+  if (search.length() > 0) {
+    // searching the UTF-8 bytes finds the same first match as searching the
+    // UTF-16 representation would
+    std::string const haystack(buffer.c_str(), buffer.length());
+    size_t const position = haystack.find(search.c_str(), 0, search.length());
+
+    if (position != std::string::npos) {
+      result = static_cast<double>(Utf16Length(buffer.c_str(), position));
+    }
+  }
+
+  if (returnIndex) {
+    return AqlValue(new Json(result));
+  }
+
+  return AqlValue(new Json(result != -1.0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function LIKE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Like (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  if (parameters.size() < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "LIKE", (int) 2, (int) 3);
+  }
+
+  bool const caseInsensitive = GetBooleanParameter(trx, parameters, 2, false);
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  // build pattern from parameter #1
+  auto const regex = ExtractFunctionParameter(trx, parameters, 1, false);
+  AppendAsString(buffer, regex.json());
+  size_t const length = buffer.length();
+
+  std::string const pattern = BuildRegexPattern(buffer.c_str(), length, caseInsensitive);
+  RegexMatcher* matcher = nullptr;
+
+  if (RegexCache != nullptr) {
+    auto it = RegexCache->find(pattern);
+
+    // check regex cache
+    if (it != RegexCache->end()) {
+      matcher = (*it).second;
+    }
+  }
+
+  if (matcher == nullptr) {
+    matcher = triagens::basics::Utf8Helper::DefaultUtf8Helper.buildMatcher(pattern);
+
+    try {
+      if (RegexCache == nullptr) {
+        RegexCache = new std::unordered_map<std::string, RegexMatcher*>();
+      }
+      // insert into cache, no matter if pattern is valid or not
+      RegexCache->emplace(pattern, matcher);
+    }
+    catch (...) {
+      delete matcher;
+      ClearRegexCache();
+      throw;
+    }
+  }
+  
+  if (matcher == nullptr) {
+    // compiling regular expression failed
+    RegisterWarning(query, "LIKE", TRI_ERROR_QUERY_INVALID_REGEX);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  // extract value
+  buffer.clear();
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+ 
+  bool error = false;
+  bool const result = triagens::basics::Utf8Helper::DefaultUtf8Helper.matches(matcher, buffer.c_str(), buffer.length(), error);
+
+  if (error) {
+    // compiling regular expression failed
+    RegisterWarning(query, "LIKE", TRI_ERROR_QUERY_INVALID_REGEX);
+    return AqlValue(new Json(Json::Null));
+  }
+        
+  return AqlValue(new Json(result));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function LEFT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Left (triagens::aql::Query*,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  UnicodeString const value = ExtractUnicodeStringParameter(trx, parameters, 0);
+
+  bool isValid;
+  auto const length = ExtractFunctionParameter(trx, parameters, 1, false);
+  double const count = ValueToNumber(length.json(), isValid);
+
+  int32_t from, n;
+  SubstringRange(value.length(), 0.0, count, true, from, n);
+
+  return UnicodeStringToAqlValue(value.tempSubString(from, n));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function RIGHT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Right (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  UnicodeString const value = ExtractUnicodeStringParameter(trx, parameters, 0);
+
+  bool isValid;
+  auto const length = ExtractFunctionParameter(trx, parameters, 1, false);
+  double const count = ValueToNumber(length.json(), isValid);
+  double const start = (std::max)(static_cast<double>(value.length()) - count, 0.0);
+
+  int32_t from, n;
+  SubstringRange(value.length(), start, count, true, from, n);
+
+  return UnicodeStringToAqlValue(value.tempSubString(from, n));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function TRIM
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Trim (triagens::aql::Query*,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  auto const chars = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (chars.isEmpty() || chars.isNull()) {
+    return TrimString(buffer.c_str(), buffer.length(), nullptr, 0, true, true);
+  }
+
+  if (chars.isNumber()) {
+    // 0 = trim both sides, 1 = trim left, 2 = trim right
+    double const type = chars.json()->_value._number;
+
+    if (type == 0.0 || type == 1.0 || type == 2.0) {
+      return TrimString(buffer.c_str(), buffer.length(), nullptr, 0, type != 2.0, type != 1.0);
+    }
+  }
+
+  triagens::basics::StringBuffer strip(TRI_UNKNOWN_MEM_ZONE, 8);
+  AppendAsString(strip, chars.json());
+
+  return TrimString(buffer.c_str(), buffer.length(), strip.c_str(), strip.length(), true, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function LTRIM
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::LTrim (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  auto const chars = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (chars.isEmpty() || chars.isNull()) {
+    return TrimString(buffer.c_str(), buffer.length(), nullptr, 0, true, false);
+  }
+
+  triagens::basics::StringBuffer strip(TRI_UNKNOWN_MEM_ZONE, 8);
+  AppendAsString(strip, chars.json());
+
+  return TrimString(buffer.c_str(), buffer.length(), strip.c_str(), strip.length(), true, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function RTRIM
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::RTrim (triagens::aql::Query*,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  auto const chars = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (chars.isEmpty() || chars.isNull()) {
+    return TrimString(buffer.c_str(), buffer.length(), nullptr, 0, false, true);
+  }
+
+  triagens::basics::StringBuffer strip(TRI_UNKNOWN_MEM_ZONE, 8);
+  AppendAsString(strip, chars.json());
+
+  return TrimString(buffer.c_str(), buffer.length(), strip.c_str(), strip.length(), false, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SPLIT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Split (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  UnicodeString const value = ExtractUnicodeStringParameter(trx, parameters, 0);
+  auto const separator = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (separator.isEmpty() || separator.isNull()) {
+    Json result(Json::Array, 1);
+    std::string s;
+    value.toUTF8String(s);
+    result.add(Json(TRI_UNKNOWN_MEM_ZONE, s));
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  }
+
+  double limit = 4294967295.0;
+  double number;
+
+  if (ExtractOptionalNumberParameter(trx, parameters, 2, number)) {
+    if (number < 0.0) {
+      RegisterInvalidArgumentWarning(query, "SPLIT");
+      return AqlValue(new Json(Json::Null));
+    }
+    limit = std::trunc(number);
+  }
+
+  // an array of separators splits at any of its members. the first member
+  // that matches at a position wins
+  std::vector<UnicodeString> separators;
+
+  if (separator.isArray()) {
+    TRI_json_t const* json = separator.json();
+    size_t const n = TRI_LengthArrayJson(json);
+
+    for (size_t i = 0; i < n; ++i) {
+      triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 8);
+      AppendAsString(buffer, static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i)));
+      separators.emplace_back(UnicodeString::fromUTF8(StringPiece(buffer.c_str(), static_cast<int32_t>(buffer.length()))));
+    }
+
+    if (separators.empty()) {
+      // an empty alternation matches the empty string
+      separators.emplace_back(UnicodeString());
+    }
+  }
+  else {
+    separators.emplace_back(ExtractUnicodeStringParameter(trx, parameters, 1));
+  }
+
+  // returns the end position of the separator matching at position q, or -1
+  auto matchAt = [&] (int32_t q) -> int32_t {
+    for (auto const& it : separators) {
+      if (q + it.length() <= value.length() && value.compare(q, it.length(), it) == 0) {
+        return q + it.length();
+      }
+    }
+    return -1;
+  };
+
+  Json result(Json::Array);
+
+  auto addPart = [&] (int32_t from, int32_t to) -> void {
+    std::string s;
+    value.tempSubString(from, to - from).toUTF8String(s);
+    result.add(Json(TRI_UNKNOWN_MEM_ZONE, s));
+  };
+
+  if (limit == 0.0) {
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  }
+
+  int32_t const length = value.length();
+
+  if (length == 0) {
+    if (matchAt(0) == -1) {
+      addPart(0, 0);
+    }
+    return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+  }
+
+  // this follows the algorithm of JavaScript's String.prototype.split()
+  int32_t p = 0;
+  int32_t q = 0;
+
+  while (q != length) {
+    int32_t const e = matchAt(q);
+
+    if (e == -1 || e == p) {
+      ++q;
+    }
+    else {
+      addPart(p, q);
+      if (static_cast<double>(result.size()) == limit) {
+        return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+      }
+      p = e;
+      q = p;
+    }
+  }
+
+  addPart(p, length);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SUBSTITUTE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Substitute (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE, 24);
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+  AppendAsString(buffer, value.json());
+
+  auto const search = ExtractFunctionParameter(trx, parameters, 1, false);
+  auto const replace = ExtractFunctionParameter(trx, parameters, 2, false);
+
+  // search strings in order of precedence, and the replacement per search
+  // string. if a search string occurs multiple times, the last replacement wins
+  std::vector<std::string> patterns;
+  std::unordered_map<std::string, std::string> replacements;
+  size_t limitPosition = 3;
+
+  auto toString = [] (TRI_json_t const* json) -> std::string {
+    triagens::basics::StringBuffer temp(TRI_UNKNOWN_MEM_ZONE, 24);
+    AppendAsString(temp, json);
+    return std::string(temp.c_str(), temp.length());
+  };
+
+  if (search.isObject()) {
+    // object with search strings as keys and replacements as values
+    TRI_json_t const* json = search.json();
+    size_t const n = TRI_LengthVector(&json->_value._objects);
+
+    for (size_t i = 0; i < n; i += 2) {
+      auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+      auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i + 1));
+
+      std::string k(key->_value._string.data, key->_value._string.length - 1);
+      patterns.emplace_back(k);
+      replacements[k] = toString(value);
+    }
+
+    // the limit is passed in the third parameter
+    limitPosition = 2;
+  }
+  else if (search.isArray()) {
+    TRI_json_t const* json = search.json();
+    size_t const n = TRI_LengthArrayJson(json);
+
+    if (n == 0) {
+      RegisterInvalidArgumentWarning(query, "SUBSTITUTE");
+      return StringBufferToAqlValue(buffer);
+    }
+
+    if (replace.isArray()) {
+      // replace each search string with the member at the same position
+      TRI_json_t const* replaceJson = replace.json();
+      size_t const m = TRI_LengthArrayJson(replaceJson);
+
+      for (size_t i = 0; i < n; ++i) {
+        std::string k = toString(static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i)));
+        patterns.emplace_back(k);
+
+        if (i < m) {
+          replacements[k] = toString(static_cast<TRI_json_t const*>(TRI_AtVector(&replaceJson->_value._objects, i)));
+        }
+        else {
+          replacements[k] = "";
+        }
+      }
+    }
+    else {
+      // replace all search strings with the same string
+      std::string const r = ((replace.isEmpty() || replace.isNull()) ? "" : toString(replace.json()));
+
+      for (size_t i = 0; i < n; ++i) {
+        std::string k = toString(static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i)));
+        patterns.emplace_back(k);
+        replacements[k] = r;
+      }
+    }
+  }
+  else {
+    std::string k = toString(search.json());
+    patterns.emplace_back(k);
+    replacements[k] = ((replace.isEmpty() || replace.isNull()) ? "" : toString(replace.json()));
+  }
+
+  double limit = HUGE_VAL;
+  double number;
+
+  if (ExtractOptionalNumberParameter(trx, parameters, limitPosition, number)) {
+    if (number < 0.0) {
+      RegisterInvalidArgumentWarning(query, "SUBSTITUTE");
+      return AqlValue(new Json(Json::Null));
+    }
+    limit = std::ceil(number);
+  }
+
+  char const* p = buffer.c_str();
+  size_t const length = buffer.length();
+  size_t position = 0;
+
+  triagens::basics::StringBuffer result(TRI_UNKNOWN_MEM_ZONE, length + 8);
+
+  // scan the string from left to right. at each position, the first search
+  // string that matches is replaced
+  while (position <= length && limit > 0.0) {
+    std::string const* match = nullptr;
+
+    for (auto const& it : patterns) {
+      if (it.size() <= length - position &&
+          memcmp(p + position, it.c_str(), it.size()) == 0) {
+        match = &it;
+        break;
+      }
+    }
+
+    if (match != nullptr) {
+      result.appendText(replacements[*match]);
+      limit -= 1.0;
+      position += match->size();
+
+      if (! match->empty()) {
+        continue;
+      }
+    }
+
+    if (position == length) {
+      break;
+    }
+
+    // copy one (UTF-8) character
+    size_t n = 1;
+    while (position + n < length && (static_cast<uint8_t>(p[position + n]) & 0xC0) == 0x80) {
+      ++n;
+    }
+    result.appendText(p + position, n);
+    position += n;
+  }
+
+  if (position < length) {
+    result.appendText(p + position, length - position);
+  }
+
+  return StringBufferToAqlValue(result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function PASSTHRU
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Passthru (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+
+  if (parameters.empty()) {
+    return AqlValue(new Json(Json::Null));
+  }
+
+  auto json = ExtractFunctionParameter(trx, parameters, 0, true);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, json.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNSET
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Unset (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    RegisterInvalidArgumentWarning(query, "UNSET");
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  std::unordered_set<std::string> names;
+  ExtractKeys(names, query, trx, parameters, 1, "UNSET");
+
+
+  // create result object
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+
+  size_t size;
+  if (names.size() >= n / 2) {
+    size = 4; 
+  }
+  else {
+    size = (n / 2) - names.size(); 
+  }
+
+  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, size));
+
+  if (j == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+
+    if (TRI_IsStringJson(key) && 
+        names.find(key->_value._string.data) == names.end()) {
+      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      } 
+
+      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+    }
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function KEEP
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Keep (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    RegisterInvalidArgumentWarning(query, "KEEP");
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  std::unordered_set<std::string> names;
+  ExtractKeys(names, query, trx, parameters, 1, "KEEP");
+
+
+  // create result object
+  std::unique_ptr<TRI_json_t> j(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, names.size()));
+
+  if (j == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthVector(&valueJson->_value._objects);
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i + 1));
+
+    if (TRI_IsStringJson(key) && 
+        names.find(key->_value._string.data) != names.end()) {
+      auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      } 
+
+      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, j.get(), key->_value._string.data, copy);
+    }
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, j.get());
+  j.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MERGE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Merge (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n == 0) {
+    // no parameters
+    return AqlValue(new Json(Json::Object));
+  }
+
+  // use the first argument as the preliminary result
+  auto initial = ExtractFunctionParameter(trx, parameters, 0, true);
+
+  if (! initial.isObject()) {
+    RegisterInvalidArgumentWarning(query, "MERGE");
+    return AqlValue(new Json(Json::Null));
+  }
+
+  std::unique_ptr<TRI_json_t> result(initial.steal());
+
+  // now merge in all other arguments
+  for (size_t i = 1; i < n; ++i) {
+    auto param = ExtractFunctionParameter(trx, parameters, i, false);
+
+    if (! param.isObject()) {
+      RegisterInvalidArgumentWarning(query, "MERGE");
+      return AqlValue(new Json(Json::Null));
+    }
+ 
+    auto merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, result.get(), param.json(), false, true);
+
+    if (merged == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    result.reset(merged);
+  } 
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function HAS
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Has (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    // no parameters
+    return AqlValue(new Json(false));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    return AqlValue(new Json(false));
+  }
+ 
+  // process name parameter 
+  auto name = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  char const* p;
+
+  if (! name.isString()) {
+    triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+    AppendAsString(buffer, name.json());
+    p = buffer.c_str();
+  }
+  else {
+    p = name.json()->_value._string.data;
+  }
+ 
+  bool const hasAttribute = (TRI_LookupObjectJson(value.json(), p) != nullptr);
+  return AqlValue(new Json(hasAttribute));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function ATTRIBUTES
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Attributes (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 1) {
+    // no parameters
+    return AqlValue(new Json(Json::Null));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
+  bool const doSort = GetBooleanParameter(trx, parameters, 2, false);
+
+  auto const valueJson = value.json();
+  TRI_ASSERT(TRI_IsObjectJson(valueJson));
+
+  size_t const numValues = TRI_LengthVectorJson(valueJson);
+
+  if (numValues == 0) {
+    // empty object
+    return AqlValue(new Json(Json::Object));
+  }
+
+  std::vector<std::pair<char const*, size_t>> sortPositions;
+  sortPositions.reserve(numValues / 2);
+
+  // create a vector with positions into the object
+  for (size_t i = 0; i < numValues; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (! TRI_IsStringJson(key)) {
+      // somehow invalid
+      continue;
+    }
+
+    if (removeInternal && *key->_value._string.data == '_') {
+      // skip attribute
+      continue;
+    }
+
+    sortPositions.emplace_back(std::make_pair(key->_value._string.data, i));
+  }
+
+  if (doSort) {
+    // sort according to attribute name
+    std::sort(sortPositions.begin(), sortPositions.end(), [] (std::pair<char const*, size_t> const& lhs,
+                                                              std::pair<char const*, size_t> const& rhs) -> bool {
+      return TRI_compare_utf8(lhs.first, rhs.first) < 0;
+    });
+  }
+
+  // create the output
+  Json result(Json::Array, sortPositions.size());
+
+  // iterate over either sorted or unsorted object 
+  for (auto const& it : sortPositions) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, it.second));
+
+    result.add(Json(std::string(key->_value._string.data, key->_value._string.length - 1)));
+  } 
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function VALUES
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Values (triagens::aql::Query* query,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 1) {
+    // no parameters
+    return AqlValue(new Json(Json::Null));
+  }
+    
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isObject()) {
+    // not an object
+    RegisterWarning(query, "ATTRIBUTES", TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return AqlValue(new Json(Json::Null));
+  }
+ 
+  bool const removeInternal = GetBooleanParameter(trx, parameters, 1, false);
+
+  auto const valueJson = value.json();
+  TRI_ASSERT(TRI_IsObjectJson(valueJson));
+
+  size_t const numValues = TRI_LengthVectorJson(valueJson);
+
+  if (numValues == 0) {
+    // empty object
+    return AqlValue(new Json(Json::Object));
+  }
+
+  // create the output
+  Json result(Json::Array, numValues);
+
+  // create a vector with positions into the object
+  for (size_t i = 0; i < numValues; i += 2) {
+    auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (! TRI_IsStringJson(key)) {
+      // somehow invalid
+      continue;
+    }
+
+    if (removeInternal && *key->_value._string.data == '_') {
+      // skip attribute
+      continue;
+    }
+
+    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i + 1));
+    result.add(Json(TRI_UNKNOWN_MEM_ZONE, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value)));
+  }
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, result.steal()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MIN
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Min (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "MIN", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  TRI_json_t const* minValue = nullptr;;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (minValue == nullptr ||
+        TRI_CompareValuesJson(value, minValue) < 0) {
+      minValue = value;
+    }
+  } 
+
+  if (minValue != nullptr) {
+    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, minValue));
+    
+    if (result != nullptr) {
+      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+      result.release();
+      return AqlValue(jr);
+    }
+  }
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MAX
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Max (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "MAX", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  TRI_json_t const* maxValue = nullptr;;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (maxValue == nullptr ||
+        TRI_CompareValuesJson(value, maxValue) > 0) {
+      maxValue = value;
+    }
+  } 
+
+  if (maxValue != nullptr) {
+    std::unique_ptr<TRI_json_t> result(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, maxValue));
+    
+    if (result != nullptr) {
+      auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+      result.release();
+      return AqlValue(jr);
+    }
+  }
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SUM
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Sum (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "SUM", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  double sum = 0.0;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (! TRI_IsNumberJson(value)) {
+      RegisterInvalidArgumentWarning(query, "SUM");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    // got a numeric value
+    double const number = value->_value._number;
+
+    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
+      sum += number;
+    } 
+  } 
+
+  if (! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
+    return AqlValue(new Json(sum));
+  } 
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function AVERAGE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Average (triagens::aql::Query* query,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "AVERAGE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+  double sum = 0.0;
+  size_t count = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&valueJson->_value._objects, i));
+
+    if (TRI_IsNullJson(value)) {
+      continue;
+    }
+
+    if (! TRI_IsNumberJson(value)) {
+      RegisterInvalidArgumentWarning(query, "AVERAGE");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    // got a numeric value
+    double const number = value->_value._number;
+
+    if (! std::isnan(number) && number != HUGE_VAL && number != -HUGE_VAL) {
+      sum += number;
+      ++count;
+    } 
+  } 
+
+  if (count > 0 && 
+      ! std::isnan(sum) && sum != HUGE_VAL && sum != -HUGE_VAL) {
+    return AqlValue(new Json(sum / static_cast<size_t>(count)));
+  } 
+
+  return AqlValue(new Json(Json::Null));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function MD5
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Md5 (triagens::aql::Query* query,
+                         triagens::arango::AqlTransaction* trx,
+                         FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendAsString(buffer, value.json());
+  
+  // create md5
+  char hash[17]; 
+  char* p = &hash[0];
+  size_t length;
+
+  triagens::rest::SslInterface::sslMD5(buffer.c_str(), buffer.length(), p, length);
+
+  // as hex
+  char hex[33];
+  p = &hex[0];
+
+  triagens::rest::SslInterface::sslHEX(hash, 16, p, length);
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 32));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function SHA1
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Sha1 (triagens::aql::Query* query,
+                          triagens::arango::AqlTransaction* trx,
+                          FunctionParameters const& parameters) {
+  auto value = ExtractFunctionParameter(trx, parameters, 0, false);
+    
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendAsString(buffer, value.json());
+  
+  // create sha1
+  char hash[21];
+  char* p = &hash[0];
+  size_t length;
+
+  triagens::rest::SslInterface::sslSHA1(buffer.c_str(), buffer.length(), p, length);
+
+  // as hex
+  char hex[41];
+  p = &hex[0];
+
+  triagens::rest::SslInterface::sslHEX(hash, 20, p, length);
+
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, hex, 40));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function FIND_FIRST
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::FindFirst (triagens::aql::Query*,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  double start = 0.0;
+  double end;
+
+  if (ExtractOptionalNumberParameter(trx, parameters, 2, start) && start < 0.0) {
+    return AqlValue(new Json(-1.0));
+  }
+
+  bool const hasEnd = ExtractOptionalNumberParameter(trx, parameters, 3, end);
+
+  if (hasEnd && (end < start || end < 0.0)) {
+    return AqlValue(new Json(-1.0));
+  }
+
+  UnicodeString value = ExtractUnicodeStringParameter(trx, parameters, 0);
+  UnicodeString const search = ExtractUnicodeStringParameter(trx, parameters, 1);
+
+  if (hasEnd) {
+    int32_t from, n;
+    SubstringRange(value.length(), 0.0, end + 1.0, true, from, n);
+    value.truncate(n);
+  }
+
+  return AqlValue(new Json(static_cast<double>(IndexOf(value, search, start))));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function FIND_LAST
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::FindLast (triagens::aql::Query*,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  double start = 0.0;
+  double end;
+
+  bool const hasStart = ExtractOptionalNumberParameter(trx, parameters, 2, start);
+  bool const hasEnd = ExtractOptionalNumberParameter(trx, parameters, 3, end);
+
+  if (hasEnd && ((hasStart && end < start) || end < 0.0)) {
+    return AqlValue(new Json(-1.0));
+  }
+
+  UnicodeString const value = ExtractUnicodeStringParameter(trx, parameters, 0);
+  UnicodeString const search = ExtractUnicodeStringParameter(trx, parameters, 1);
+
+  if (start > 0.0 || hasEnd) {
+    int32_t from, n;
+    SubstringRange(value.length(), start, end - start + 1.0, hasEnd, from, n);
+
+    int32_t const result = LastIndexOf(value.tempSubString(from, n), search);
+
+    if (result == -1) {
+      return AqlValue(new Json(-1.0));
+    }
+    return AqlValue(new Json(static_cast<double>(result) + std::trunc(start)));
+  }
+
+  return AqlValue(new Json(static_cast<double>(LastIndexOf(value, search))));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNIQUE
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Unique (triagens::aql::Query* query,
+                            triagens::arango::AqlTransaction* trx,
+                            FunctionParameters const& parameters) {
+  if (parameters.size() != 1) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNIQUE", (int) 1, (int) 1);
+  }
+
+  auto const value = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! value.isArray()) {
+    // not an array
+    RegisterWarning(query, "UNIQUE", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+    return AqlValue(new Json(Json::Null));
+  }
+  
+  std::unordered_set<TRI_json_t const*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  TRI_json_t const* valueJson = value.json();
+  size_t const n = TRI_LengthArrayJson(valueJson);
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, i));
+
+    if (value == nullptr) {
+      continue;
+    }
+
+    values.emplace(value); 
+  } 
+
+  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+ 
+  for (auto const& it : values) {
+    auto copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, it);
+
+    if (copy == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+ 
+    TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy); 
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNION
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Union (triagens::aql::Query* query,
+                           triagens::arango::AqlTransaction* trx,
+                           FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unique_ptr<TRI_json_t> result(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 16));
+
+  for (size_t i = 0; i < n; ++i) {
+    auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+    if (! value.isArray()) {
+      // not an array
+      RegisterInvalidArgumentWarning(query, "UNION");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    TRI_json_t const* valueJson = value.json();
+    size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+    if (TRI_ReserveVector(&(result.get()->_value._objects), nrValues) != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+    
+    // this passes ownership for the JSON contens into result
+    for (size_t j = 0; j < nrValues; ++j) {
+      TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, TRI_LookupArrayJson(valueJson, j));
+
+      if (copy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+    
+      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy);
+
+      TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
+    } 
+  } 
+      
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function UNION_DISTINCT
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::UnionDistinct (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION_DISTINCT", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unordered_set<TRI_json_t*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  auto freeValues = [&values] () -> void {
+    for (auto& it : values) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
+    }
+  };
+
+  std::unique_ptr<TRI_json_t> result;
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+      if (! value.isArray()) {
+        // not an array
+        freeValues();
+        RegisterInvalidArgumentWarning(query, "UNION_DISTINCT");
+        return AqlValue(new Json(Json::Null));
+      }
+
+      TRI_json_t const* valueJson = value.json();
+      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+      for (size_t j = 0; j < nrValues; ++j) {
+        auto value = static_cast<TRI_json_t*>(TRI_AddressVector(&valueJson->_value._objects, j));
+
+        if (values.find(value) == values.end()) { 
+          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+
+          if (copy == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+      
+          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+          }
+
+          values.emplace(copy.get());
+          copy.release();
+        }
+      }
+    }
+
+    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+
+    if (result == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+          
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+   
+    for (auto const& it : values) {
+      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it); 
+    }
+
+  }
+  catch (...) {  
+    freeValues();
+    throw;
+  }
+    
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function INTERSECTION
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Intersection (triagens::aql::Query* query,
+                                  triagens::arango::AqlTransaction* trx,
+                                  FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+
+  if (n < 2) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "INTERSECTION", (int) 2, (int) Function::MaxArguments);
+  }
+
+  std::unordered_map<TRI_json_t*, size_t, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
+    512, 
+    triagens::basics::JsonHash(), 
+    triagens::basics::JsonEqual()
+  );
+
+  auto freeValues = [&values] () -> void {
+    for (auto& it : values) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+    }
+    values.clear();
+  };
+
+  std::unique_ptr<TRI_json_t> result;
+
+  try {
+    for (size_t i = 0; i < n; ++i) {
+      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+
+      if (! value.isArray()) {
+        // not an array
+        freeValues();
+        RegisterWarning(query, "INTERSECTION", TRI_ERROR_QUERY_ARRAY_EXPECTED);
+        return AqlValue(new Json(Json::Null));
+      }
+
+      TRI_json_t const* valueJson = value.json();
+      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+
+      for (size_t j = 0; j < nrValues; ++j) {
+        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, j));
+
+        if (i == 0) {
+          // round one
+          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+
+          if (copy == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+    
+          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+          }
+
+          auto r = values.emplace(copy.get(), 1);
+ 
+          if (r.second) {
+            // successfully inserted
+            copy.release();
+          }
+        }
+        else {
+          // check if we have seen the same element before
+          auto it = values.find(const_cast<TRI_json_t*>(value));
+
+          if (it != values.end()) {
+            // already seen
+            TRI_ASSERT((*it).second > 0);
+            ++((*it).second);
+          }
+        }
+      }
+    }
+ 
+    // count how many valid we have 
+    size_t total = 0;
+
+    for (auto const& it : values) {
+      if (it.second == n) {
+        ++total;
+      }
+    }
+
+    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, total));
+
+    if (result == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+          
+    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+   
+    for (auto& it : values) {
+      if (it.second == n) {
+        TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it.first); 
+      }
+      else {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
+      }
+    }
+    values.clear();
+   
+  } 
+  catch (...) {
+    freeValues();
+    throw;
+  }
+    
+  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+      
+  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+  return AqlValue(jr);
+}
+
+// TODO DELETE THESE HELPER FUNCTIONS.
+
+static inline Json TRI_ExpandShapedJson (VocShaper* shaper,
+                                         CollectionNameResolver const* resolver,
+                                         TRI_voc_cid_t const& cid,
+                                         TRI_doc_mptr_t const* mptr) {
+  TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());
+
+  TRI_shaped_json_t shaped;
+  TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
+  Json json(shaper->memoryZone(), TRI_JsonShapedJson(shaper, &shaped));
+  char const* key = TRI_EXTRACT_MARKER_KEY(marker);
+  std::string id(resolver->getCollectionName(cid));
+  id.push_back('/');
+  id.append(key);
+  json(TRI_VOC_ATTRIBUTE_ID, Json(id));
+  json(TRI_VOC_ATTRIBUTE_REV, Json(std::to_string(TRI_EXTRACT_MARKER_RID(marker))));
+  json(TRI_VOC_ATTRIBUTE_KEY, Json(key));
+
+  if (TRI_IS_EDGE_MARKER(marker)) {
+    std::string from(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
+    from.push_back('/');
+    from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
+    json(TRI_VOC_ATTRIBUTE_FROM, Json(from));
+    std::string to(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
+
+    to.push_back('/');
+    to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
+    json(TRI_VOC_ATTRIBUTE_TO, Json(to));
+  }
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms VertexId to Json
+////////////////////////////////////////////////////////////////////////////////
+
+static Json VertexIdToJson (triagens::arango::AqlTransaction* trx,
+                            CollectionNameResolver const* resolver,
+                            VertexId const& id) {
+  TRI_doc_mptr_copy_t mptr;
+  auto collection = trx->trxCollection(id.cid);
+  int res = trx->readSingle(collection, &mptr, id.key); 
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(res);
+  }
+
+  return TRI_ExpandShapedJson(
+    collection->_collection->_collection->getShaper(),
+    resolver,
+    id.cid,
+    &mptr
+  );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms VertexId to std::string
+////////////////////////////////////////////////////////////////////////////////
+
+static std::string VertexIdToString (CollectionNameResolver const* resolver,
+                                     VertexId const& id) {
+  return resolver->getCollectionName(id.cid) + "/" + std::string(id.key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Transforms an unordered_map<VertexId> to AQL json values
+////////////////////////////////////////////////////////////////////////////////
+
+static AqlValue VertexIdsToAqlValue (triagens::arango::AqlTransaction* trx,
+                                     CollectionNameResolver const* resolver,
+                                     std::unordered_set<VertexId>& ids,
+                                     bool includeData = false) {
+  std::unique_ptr<Json> result(new Json(Json::Array, ids.size()));
+
+  if (includeData) {
+    for (auto& it : ids) {
+      result->add(Json(VertexIdToJson(trx, resolver, it)));
+    }
+  } 
+  else {
+    for (auto& it : ids) {
+      result->add(Json(VertexIdToString(resolver, it)));
+    }
+  }
+
+  AqlValue v(result.get());
+  result.release();
+
+  return v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function NEIGHBORS
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Neighbors (triagens::aql::Query* query,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  size_t const n = parameters.size();
+  basics::traverser::NeighborsOptions opts;
+
+  if (n < 4 || n > 6) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "NEIGHBORS", (int) 4, (int) 6);
+  }
+
+  auto resolver = trx->resolver();
+
+  Json vertexCol = ExtractFunctionParameter(trx, parameters, 0, false);
+
+  if (! vertexCol.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+  std::string vColName = basics::JsonHelper::getStringValue(vertexCol.json(), "");
+
+  Json edgeCol = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (! edgeCol.isString()) {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+  std::string eColName = basics::JsonHelper::getStringValue(edgeCol.json(), "");
+
+  Json vertexInfo = ExtractFunctionParameter(trx, parameters, 2, false);
+  std::string vertexId;
+  if (vertexInfo.isString()) {
+    vertexId = basics::JsonHelper::getStringValue(vertexInfo.json(), "");
+    if (vertexId.find("/") != std::string::npos) {
+      
+      // TODO tmp can be replaced by Traversal::IdStringToVertexId
+      size_t split;
+      char const* str = vertexId.c_str();
+
+      if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+      }
+
+      std::string const collectionName = vertexId.substr(0, split);
+      auto coli = resolver->getCollectionStruct(collectionName);
+
+      if (coli == nullptr || collectionName.compare(vColName) != 0) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+      }
+
+      VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
+      opts.start = v;
+    }
+    else {
+      VertexId v(resolver->getCollectionId(vColName), vertexId.c_str());
+      opts.start = v;
+    }
+  }
+  else if (vertexInfo.isObject()) {
+    if (! vertexInfo.has("_id")) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+    vertexId = basics::JsonHelper::getStringValue(vertexInfo.get("_id").json(), "");
+    // TODO tmp can be replaced by Traversal::IdStringToVertexId
+    size_t split;
+    char const* str = vertexId.c_str();
+
+    if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+    }
+
+    std::string const collectionName = vertexId.substr(0, split);
+    auto coli = resolver->getCollectionStruct(collectionName);
+
+    if (coli == nullptr || collectionName.compare(vColName) != 0) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+    }
+
+    VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
+    opts.start = v;
+  }
+  else {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+
+  Json direction = ExtractFunctionParameter(trx, parameters, 3, false);
+  if (direction.isString()) {
+    std::string const dir = basics::JsonHelper::getStringValue(direction.json(), "");
+    if (dir.compare("outbound") == 0) {
+      opts.direction = TRI_EDGE_OUT;
+    }
+    else if (dir.compare("inbound") == 0) {
+      opts.direction = TRI_EDGE_IN;
+    }
+    else if (dir.compare("any") == 0) {
+      opts.direction = TRI_EDGE_ANY;
+    }
+    else {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+  }
+  else {
+    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  }
+
+
+  bool includeData = false;
+
+  if (n > 5) {
+    auto options = ExtractFunctionParameter(trx, parameters, 5, false);
+    if (! options.isObject()) {
+      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+    }
+    includeData = basics::JsonHelper::getBooleanValue(options.json(), "includeData", false);
+    opts.minDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "minDepth", 1);
+    if (opts.minDepth == 0) {
+      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", 1);
+    } 
+    else {
+      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", opts.minDepth);
+    }
+  }
+
+  std::unordered_set<VertexId> neighbors;
+
+
+  TRI_voc_cid_t eCid = resolver->getCollectionId(eColName);
+
+
+  // Function to return constant distance
+  auto wc = [](TRI_doc_mptr_copy_t& edge) -> double { return 1; };
+
+  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
+    eCid,
+    trx->documentCollection(eCid),
+    wc
+  ));
+  TRI_IF_FAILURE("EdgeCollectionInfoOOM1") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+  
+
+  if (n > 4) {
+    auto edgeExamples = ExtractFunctionParameter(trx, parameters, 4, false);
+    if (! (edgeExamples.isArray() && edgeExamples.size() == 0) ) {
+      opts.addEdgeFilter(edgeExamples, eci->getShaper(), eCid, resolver); 
+    }
+  }
+  
+  std::vector<EdgeCollectionInfo*> edgeCollectionInfos;
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&edgeCollectionInfos]() -> void {
+      for (auto& p : edgeCollectionInfos) {
+        delete p;
+      }
+    }
+  };
+  edgeCollectionInfos.emplace_back(eci.get());
+  eci.release();
+  TRI_IF_FAILURE("EdgeCollectionInfoOOM2") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+
+  TRI_RunNeighborsSearch(
+    edgeCollectionInfos,
+    opts,
+    neighbors
+  );
+
+  return VertexIdsToAqlValue(trx, resolver, neighbors, includeData);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_NOW
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateNow (triagens::aql::Query*,
+                             triagens::arango::AqlTransaction*,
+                             FunctionParameters const&) {
+  return AqlValue(new Json(std::floor(TRI_microtime() * 1000.0)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_TIMESTAMP
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateTimestamp (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  int64_t timestamp;
+  int res = MakeDate(trx, parameters, timestamp);
 
-    TRI_json_t const* valueJson = value.json();
-    size_t const nrValues = TRI_LengthArrayJson(valueJson);
+  if (res != TRI_ERROR_NO_ERROR) {
+    RegisterDateWarning(query, "DATE_TIMESTAMP", res);
+    return AqlValue(new Json(Json::Null));
+  }
 
-    if (TRI_ReserveVector(&(result.get()->_value._objects), nrValues) != TRI_ERROR_NO_ERROR) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
+  return AqlValue(new Json(static_cast<double>(timestamp)));
+}
 
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-    }
-    
-    // this passes ownership for the JSON contens into result
-    for (size_t j = 0; j < nrValues; ++j) {
-      TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, TRI_LookupArrayJson(valueJson, j));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_ISO8601
+////////////////////////////////////////////////////////////////////////////////
 
-      if (copy == nullptr) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-      }
-    
-      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), copy);
+AqlValue Functions::DateIso8601 (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  int64_t timestamp;
+  int res = MakeDate(trx, parameters, timestamp);
 
-      TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-      }
-    } 
-  } 
-      
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  if (res != TRI_ERROR_NO_ERROR) {
+    RegisterDateWarning(query, "DATE_ISO8601", res);
+    return AqlValue(new Json(Json::Null));
   }
 
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, DateToString(timestamp)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function UNION_DISTINCT
+/// @brief function DATE_DAYOFWEEK
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::UnionDistinct (triagens::aql::Query* query,
+AqlValue Functions::DateDayOfWeek (triagens::aql::Query* query,
                                    triagens::arango::AqlTransaction* trx,
                                    FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+  int64_t timestamp;
 
-  if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "UNION_DISTINCT", (int) 2, (int) Function::MaxArguments);
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_DAYOFWEEK", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  std::unordered_set<TRI_json_t*, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  auto freeValues = [&values] () -> void {
-    for (auto& it : values) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
-    }
-  };
+  return AqlValue(new Json(static_cast<double>(components._weekday)));
+}
 
-  std::unique_ptr<TRI_json_t> result;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_YEAR
+////////////////////////////////////////////////////////////////////////////////
 
-  try {
-    for (size_t i = 0; i < n; ++i) {
-      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+AqlValue Functions::DateYear (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-      if (! value.isArray()) {
-        // not an array
-        freeValues();
-        RegisterInvalidArgumentWarning(query, "UNION_DISTINCT");
-        return AqlValue(new Json(Json::Null));
-      }
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_YEAR", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
 
-      TRI_json_t const* valueJson = value.json();
-      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-      for (size_t j = 0; j < nrValues; ++j) {
-        auto value = static_cast<TRI_json_t*>(TRI_AddressVector(&valueJson->_value._objects, j));
+  return AqlValue(new Json(static_cast<double>(components._year)));
+}
 
-        if (values.find(value) == values.end()) { 
-          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MONTH
+////////////////////////////////////////////////////////////////////////////////
 
-          if (copy == nullptr) {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-          }
-      
-          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-          }
+AqlValue Functions::DateMonth (triagens::aql::Query* query,
+                               triagens::arango::AqlTransaction* trx,
+                               FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-          values.emplace(copy.get());
-          copy.release();
-        }
-      }
-    }
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_MONTH", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
 
-    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, values.size()));
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-    if (result == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
-          
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-    }
-   
-    for (auto const& it : values) {
-      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it); 
-    }
+  return AqlValue(new Json(static_cast<double>(components._month)));
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_DAY
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateDay (triagens::aql::Query* query,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  int64_t timestamp;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_DAY", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
-  catch (...) {  
-    freeValues();
-    throw;
-  }
-    
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-  }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  return AqlValue(new Json(static_cast<double>(components._day)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function INTERSECTION
+/// @brief function DATE_HOUR
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Intersection (triagens::aql::Query* query,
-                                  triagens::arango::AqlTransaction* trx,
-                                  FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
+AqlValue Functions::DateHour (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-  if (n < 2) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "INTERSECTION", (int) 2, (int) Function::MaxArguments);
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_HOUR", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  std::unordered_map<TRI_json_t*, size_t, triagens::basics::JsonHash, triagens::basics::JsonEqual> values(
-    512, 
-    triagens::basics::JsonHash(), 
-    triagens::basics::JsonEqual()
-  );
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  auto freeValues = [&values] () -> void {
-    for (auto& it : values) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
-    }
-    values.clear();
-  };
+  return AqlValue(new Json(static_cast<double>(components._hour)));
+}
 
-  std::unique_ptr<TRI_json_t> result;
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MINUTE
+////////////////////////////////////////////////////////////////////////////////
 
-  try {
-    for (size_t i = 0; i < n; ++i) {
-      auto value = ExtractFunctionParameter(trx, parameters, i, false);
+AqlValue Functions::DateMinute (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-      if (! value.isArray()) {
-        // not an array
-        freeValues();
-        RegisterWarning(query, "INTERSECTION", TRI_ERROR_QUERY_ARRAY_EXPECTED);
-        return AqlValue(new Json(Json::Null));
-      }
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_MINUTE", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
 
-      TRI_json_t const* valueJson = value.json();
-      size_t const nrValues = TRI_LengthArrayJson(valueJson);
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-      for (size_t j = 0; j < nrValues; ++j) {
-        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&valueJson->_value._objects, j));
+  return AqlValue(new Json(static_cast<double>(components._minute)));
+}
 
-        if (i == 0) {
-          // round one
-          std::unique_ptr<TRI_json_t> copy(TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_SECOND
+////////////////////////////////////////////////////////////////////////////////
 
-          if (copy == nullptr) {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-          }
-    
-          TRI_IF_FAILURE("AqlFunctions::OutOfMemory1") {
-            THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-          }
+AqlValue Functions::DateSecond (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-          auto r = values.emplace(copy.get(), 1);
- 
-          if (r.second) {
-            // successfully inserted
-            copy.release();
-          }
-        }
-        else {
-          // check if we have seen the same element before
-          auto it = values.find(const_cast<TRI_json_t*>(value));
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_SECOND", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
 
-          if (it != values.end()) {
-            // already seen
-            TRI_ASSERT((*it).second > 0);
-            ++((*it).second);
-          }
-        }
-      }
-    }
- 
-    // count how many valid we have 
-    size_t total = 0;
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-    for (auto const& it : values) {
-      if (it.second == n) {
-        ++total;
-      }
-    }
+  return AqlValue(new Json(static_cast<double>(components._second)));
+}
 
-    result.reset(TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, total));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_MILLISECOND
+////////////////////////////////////////////////////////////////////////////////
 
-    if (result == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
-          
-    TRI_IF_FAILURE("AqlFunctions::OutOfMemory2") {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
-    }
-   
-    for (auto& it : values) {
-      if (it.second == n) {
-        TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, result.get(), it.first); 
-      }
-      else {
-        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.first);
-      }
-    }
-    values.clear();
-   
-  } 
-  catch (...) {
-    freeValues();
-    throw;
-  }
-    
-  TRI_IF_FAILURE("AqlFunctions::OutOfMemory3") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+AqlValue Functions::DateMillisecond (triagens::aql::Query* query,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  int64_t timestamp;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_MILLISECOND", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
-      
-  auto jr = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
-  result.release();
-  return AqlValue(jr);
+
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  return AqlValue(new Json(static_cast<double>(components._millisecond)));
 }
 
-// TODO DELETE THESE HELPER FUNCTIONS.
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_DAYOFYEAR
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::DateDayOfYear (triagens::aql::Query* query,
+                                   triagens::arango::AqlTransaction* trx,
+                                   FunctionParameters const& parameters) {
+  int64_t timestamp;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_DAYOFYEAR", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
 
-static inline Json TRI_ExpandShapedJson (VocShaper* shaper,
-                                         CollectionNameResolver const* resolver,
-                                         TRI_voc_cid_t const& cid,
-                                         TRI_doc_mptr_t const* mptr) {
-  TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  TRI_shaped_json_t shaped;
-  TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
-  Json json(shaper->memoryZone(), TRI_JsonShapedJson(shaper, &shaped));
-  char const* key = TRI_EXTRACT_MARKER_KEY(marker);
-  std::string id(resolver->getCollectionName(cid));
-  id.push_back('/');
-  id.append(key);
-  json(TRI_VOC_ATTRIBUTE_ID, Json(id));
-  json(TRI_VOC_ATTRIBUTE_REV, Json(std::to_string(TRI_EXTRACT_MARKER_RID(marker))));
-  json(TRI_VOC_ATTRIBUTE_KEY, Json(key));
+  return AqlValue(new Json(static_cast<double>(DayOfYear(components))));
+}
 
-  if (TRI_IS_EDGE_MARKER(marker)) {
-    std::string from(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
-    from.push_back('/');
-    from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
-    json(TRI_VOC_ATTRIBUTE_FROM, Json(from));
-    std::string to(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_ISOWEEK
+////////////////////////////////////////////////////////////////////////////////
 
-    to.push_back('/');
-    to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
-    json(TRI_VOC_ATTRIBUTE_TO, Json(to));
+AqlValue Functions::DateIsoWeek (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  int64_t timestamp;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_ISOWEEK", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  return json;
+  return AqlValue(new Json(static_cast<double>(IsoWeek(timestamp))));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms VertexId to Json
+/// @brief function DATE_LEAPYEAR
 ////////////////////////////////////////////////////////////////////////////////
 
-static Json VertexIdToJson (triagens::arango::AqlTransaction* trx,
-                            CollectionNameResolver const* resolver,
-                            VertexId const& id) {
-  TRI_doc_mptr_copy_t mptr;
-  auto collection = trx->trxCollection(id.cid);
-  int res = trx->readSingle(collection, &mptr, id.key); 
+AqlValue Functions::DateLeapYear (triagens::aql::Query* query,
+                                  triagens::arango::AqlTransaction* trx,
+                                  FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-  if (res != TRI_ERROR_NO_ERROR) {
-    THROW_ARANGO_EXCEPTION(res);
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_LEAPYEAR", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  return TRI_ExpandShapedJson(
-    collection->_collection->_collection->getShaper(),
-    resolver,
-    id.cid,
-    &mptr
-  );
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  return AqlValue(new Json(IsLeapYear(components._year)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms VertexId to std::string
+/// @brief function DATE_QUARTER
 ////////////////////////////////////////////////////////////////////////////////
 
-static std::string VertexIdToString (CollectionNameResolver const* resolver,
-                                     VertexId const& id) {
-  return resolver->getCollectionName(id.cid) + "/" + std::string(id.key);
+AqlValue Functions::DateQuarter (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  int64_t timestamp;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_QUARTER", timestamp)) {
+    return AqlValue(new Json(Json::Null));
+  }
+
+  DateComponents components;
+  DecomposeDate(timestamp, components);
+
+  return AqlValue(new Json(static_cast<double>((components._month - 1) / 3 + 1)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief Transforms an unordered_map<VertexId> to AQL json values
+/// @brief function DATE_DAYS_IN_MONTH
 ////////////////////////////////////////////////////////////////////////////////
 
-static AqlValue VertexIdsToAqlValue (triagens::arango::AqlTransaction* trx,
-                                     CollectionNameResolver const* resolver,
-                                     std::unordered_set<VertexId>& ids,
-                                     bool includeData = false) {
-  std::unique_ptr<Json> result(new Json(Json::Array, ids.size()));
+AqlValue Functions::DateDaysInMonth (triagens::aql::Query* query,
+                                     triagens::arango::AqlTransaction* trx,
+                                     FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-  if (includeData) {
-    for (auto& it : ids) {
-      result->add(Json(VertexIdToJson(trx, resolver, it)));
-    }
-  } 
-  else {
-    for (auto& it : ids) {
-      result->add(Json(VertexIdToString(resolver, it)));
-    }
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_DAYS_IN_MONTH", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  AqlValue v(result.get());
-  result.release();
+  DateComponents components;
+  DecomposeDate(timestamp, components);
 
-  return v;
+  return AqlValue(new Json(static_cast<double>(DaysInMonth(components._year, components._month))));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief function NEIGHBORS
+/// @brief function DATE_ADD
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlValue Functions::Neighbors (triagens::aql::Query* query,
-                               triagens::arango::AqlTransaction* trx,
-                               FunctionParameters const& parameters) {
-  size_t const n = parameters.size();
-  basics::traverser::NeighborsOptions opts;
+AqlValue Functions::DateAdd (triagens::aql::Query* query,
+                             triagens::arango::AqlTransaction* trx,
+                             FunctionParameters const& parameters) {
+  return DateCalculation(query, trx, parameters, "DATE_ADD", 1.0);
+}
 
-  if (n < 4 || n > 6) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH, "NEIGHBORS", (int) 4, (int) 6);
-  }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_SUBTRACT
+////////////////////////////////////////////////////////////////////////////////
 
-  auto resolver = trx->resolver();
+AqlValue Functions::DateSubtract (triagens::aql::Query* query,
+                                  triagens::arango::AqlTransaction* trx,
+                                  FunctionParameters const& parameters) {
+  return DateCalculation(query, trx, parameters, "DATE_SUBTRACT", -1.0);
+}
 
-  Json vertexCol = ExtractFunctionParameter(trx, parameters, 0, false);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_DIFF
+////////////////////////////////////////////////////////////////////////////////
 
-  if (! vertexCol.isString()) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+AqlValue Functions::DateDiff (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              FunctionParameters const& parameters) {
+  int64_t timestamp1;
+  int64_t timestamp2;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_DIFF", timestamp1) ||
+      ! ExtractDateParameter(query, trx, parameters, 1, "DATE_DIFF", timestamp2)) {
+    return AqlValue(new Json(Json::Null));
   }
-  std::string vColName = basics::JsonHelper::getStringValue(vertexCol.json(), "");
 
-  Json edgeCol = ExtractFunctionParameter(trx, parameters, 1, false);
+  auto unitJson = ExtractFunctionParameter(trx, parameters, 2, false);
+  char const unit = LookupDateUnit(unitJson.json(), true);
 
-  if (! edgeCol.isString()) {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+  if (unit == '\0') {
+    RegisterWarning(query, "DATE_DIFF", TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return AqlValue(new Json(Json::Null));
   }
-  std::string eColName = basics::JsonHelper::getStringValue(edgeCol.json(), "");
 
-  Json vertexInfo = ExtractFunctionParameter(trx, parameters, 2, false);
-  std::string vertexId;
-  if (vertexInfo.isString()) {
-    vertexId = basics::JsonHelper::getStringValue(vertexInfo.json(), "");
-    if (vertexId.find("/") != std::string::npos) {
-      
-      // TODO tmp can be replaced by Traversal::IdStringToVertexId
-      size_t split;
-      char const* str = vertexId.c_str();
+  bool const asFloat = GetBooleanParameter(trx, parameters, 3, false);
+  double result;
 
-      if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
-      }
+  if (unit == 'm' || unit == 'y') {
+    // months and years have varying lengths. count the full months between
+    // the dates, and add the difference of the offsets into the months
+    // relative to the mean length of both months
+    DateComponents components1;
+    DateComponents components2;
+    DecomposeDate(timestamp1, components1);
+    DecomposeDate(timestamp2, components2);
 
-      std::string const collectionName = vertexId.substr(0, split);
-      auto coli = resolver->getCollectionStruct(collectionName);
+    double const monthLength1 = MillisecondsPerMonth[components1._month - 1] +
+      ((components1._month == 2 && IsLeapYear(components1._year)) ? static_cast<double>(MillisecondsPerDay) : 0.0);
+    double const monthLength2 = MillisecondsPerMonth[components2._month - 1] +
+      ((components2._month == 2 && IsLeapYear(components2._year)) ? static_cast<double>(MillisecondsPerDay) : 0.0);
 
-      if (coli == nullptr || collectionName.compare(vColName) != 0) {
-        THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
-      }
+    double const offset1 = static_cast<double>(timestamp1 - DaysFromCivil(components1._year, components1._month, 1) * MillisecondsPerDay);
+    double const offset2 = static_cast<double>(timestamp2 - DaysFromCivil(components2._year, components2._month, 1) * MillisecondsPerDay);
 
-      VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
-      opts.start = v;
-    }
-    else {
-      VertexId v(resolver->getCollectionId(vColName), vertexId.c_str());
-      opts.start = v;
+    result = static_cast<double>((components2._year * 12 + components2._month) - (components1._year * 12 + components1._month));
+    result += (offset2 - offset1) / ((monthLength1 + monthLength2) / 2.0);
+
+    if (unit == 'y') {
+      result /= 12.0;
     }
   }
-  else if (vertexInfo.isObject()) {
-    if (! vertexInfo.has("_id")) {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
-    }
-    vertexId = basics::JsonHelper::getStringValue(vertexInfo.get("_id").json(), "");
-    // TODO tmp can be replaced by Traversal::IdStringToVertexId
-    size_t split;
-    char const* str = vertexId.c_str();
+  else {
+    static std::unordered_map<char, double> const divisors({
+      { 'f', 1.0 }, { 's', 1e3 }, { 'i', 6e4 }, { 'h', 36e5 }, { 'd', 864e5 }, { 'w', 6048e5 }
+    });
 
-    if (! TRI_ValidateDocumentIdKeyGenerator(str, &split)) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD);
+    result = static_cast<double>(timestamp2 - timestamp1) / divisors.at(unit);
+  }
+
+  if (! asFloat) {
+    // round towards zero, regardless of sign
+    result = std::trunc(result);
+    if (result == 0.0) {
+      // avoid returning -0
+      result = 0.0;
     }
+  }
 
-    std::string const collectionName = vertexId.substr(0, split);
-    auto coli = resolver->getCollectionStruct(collectionName);
+  return AqlValue(new Json(result));
+}
 
-    if (coli == nullptr || collectionName.compare(vColName) != 0) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
-    }
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_COMPARE
+////////////////////////////////////////////////////////////////////////////////
 
-    VertexId v(coli->_cid, const_cast<char*>(str + split + 1));
-    opts.start = v;
-  }
-  else {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+AqlValue Functions::DateCompare (triagens::aql::Query* query,
+                                 triagens::arango::AqlTransaction* trx,
+                                 FunctionParameters const& parameters) {
+  int64_t timestamp1;
+  int64_t timestamp2;
+
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_COMPARE", timestamp1) ||
+      ! ExtractDateParameter(query, trx, parameters, 1, "DATE_COMPARE", timestamp2)) {
+    return AqlValue(new Json(Json::Null));
   }
 
-  Json direction = ExtractFunctionParameter(trx, parameters, 3, false);
-  if (direction.isString()) {
-    std::string const dir = basics::JsonHelper::getStringValue(direction.json(), "");
-    if (dir.compare("outbound") == 0) {
-      opts.direction = TRI_EDGE_OUT;
-    }
-    else if (dir.compare("inbound") == 0) {
-      opts.direction = TRI_EDGE_IN;
-    }
-    else if (dir.compare("any") == 0) {
-      opts.direction = TRI_EDGE_ANY;
-    }
-    else {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
-    }
+  auto startUnit = ExtractFunctionParameter(trx, parameters, 2, false);
+  char const start = LookupDateUnit(startUnit.json(), false);
+  char end = start;
+
+  if (parameters.size() > 3) {
+    auto endUnit = ExtractFunctionParameter(trx, parameters, 3, false);
+    end = LookupDateUnit(endUnit.json(), false);
   }
-  else {
-    THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
+
+  // positions of the units in the ISO 8601 string representation
+  // 0123_56_89_12_45_78_012_
+  static char const Units[] = "ymdhisf";
+  static size_t const Ranges[][2] = {
+    { 0, 4 }, { 5, 7 }, { 8, 10 }, { 11, 13 }, { 14, 16 }, { 17, 19 }, { 20, 23 }
+  };
+
+  char const* startPosition = (start == '\0' ? nullptr : strchr(Units, start));
+  char const* endPosition = (end == '\0' ? nullptr : strchr(Units, end));
+
+  if (startPosition == nullptr || endPosition == nullptr) {
+    RegisterWarning(query, "DATE_COMPARE", TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return AqlValue(new Json(Json::Null));
   }
 
+  size_t from = Ranges[startPosition - Units][0];
+  size_t to = Ranges[endPosition - Units][1];
 
-  bool includeData = false;
+  DateComponents components1;
+  DateComponents components2;
+  DecomposeDate(timestamp1, components1);
+  DecomposeDate(timestamp2, components2);
 
-  if (n > 5) {
-    auto options = ExtractFunctionParameter(trx, parameters, 5, false);
-    if (! options.isObject()) {
-      THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH, "NEIGHBORS");
-    }
-    includeData = basics::JsonHelper::getBooleanValue(options.json(), "includeData", false);
-    opts.minDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "minDepth", 1);
-    if (opts.minDepth == 0) {
-      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", 1);
-    } 
-    else {
-      opts.maxDepth = basics::JsonHelper::getNumericValue<uint64_t>(options.json(), "maxDepth", opts.minDepth);
-    }
+  // extended years have 3 more characters (sign and two more digits)
+  if ((components1._year < 0 || components1._year > 9999) && from != 0) {
+    from += 3;
+  }
+  if (components2._year < 0 || components2._year > 9999) {
+    to += 3;
   }
 
-  std::unordered_set<VertexId> neighbors;
+  std::string const value1 = DateToString(timestamp1);
+  std::string const value2 = DateToString(timestamp2);
 
+  if (from >= to || from >= value1.size() || from >= value2.size()) {
+    // the end unit is before the start unit
+    RegisterWarning(query, "DATE_COMPARE", TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return AqlValue(new Json(Json::Null));
+  }
 
-  TRI_voc_cid_t eCid = resolver->getCollectionId(eColName);
+  return AqlValue(new Json(value1.substr(from, to - from) == value2.substr(from, to - from)));
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DATE_FORMAT
+////////////////////////////////////////////////////////////////////////////////
 
-  // Function to return constant distance
-  auto wc = [](TRI_doc_mptr_copy_t& edge) -> double { return 1; };
+AqlValue Functions::DateFormat (triagens::aql::Query* query,
+                                triagens::arango::AqlTransaction* trx,
+                                FunctionParameters const& parameters) {
+  int64_t timestamp;
 
-  std::unique_ptr<EdgeCollectionInfo> eci(new EdgeCollectionInfo(
-    eCid,
-    trx->documentCollection(eCid),
-    wc
-  ));
-  TRI_IF_FAILURE("EdgeCollectionInfoOOM1") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  if (! ExtractDateParameter(query, trx, parameters, 0, "DATE_FORMAT", timestamp)) {
+    return AqlValue(new Json(Json::Null));
   }
-  
 
-  if (n > 4) {
-    auto edgeExamples = ExtractFunctionParameter(trx, parameters, 4, false);
-    if (! (edgeExamples.isArray() && edgeExamples.size() == 0) ) {
-      opts.addEdgeFilter(edgeExamples, eci->getShaper(), eCid, resolver); 
-    }
-  }
-  
-  std::vector<EdgeCollectionInfo*> edgeCollectionInfos;
-  triagens::basics::ScopeGuard guard{
-    []() -> void { },
-    [&edgeCollectionInfos]() -> void {
-      for (auto& p : edgeCollectionInfos) {
-        delete p;
-      }
-    }
-  };
-  edgeCollectionInfos.emplace_back(eci.get());
-  eci.release();
-  TRI_IF_FAILURE("EdgeCollectionInfoOOM2") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  auto format = ExtractFunctionParameter(trx, parameters, 1, false);
+
+  if (! format.isString()) {
+    RegisterWarning(query, "DATE_FORMAT", TRI_ERROR_QUERY_INVALID_DATE_VALUE);
+    return AqlValue(new Json(Json::Null));
   }
 
-  TRI_RunNeighborsSearch(
-    edgeCollectionInfos,
-    opts,
-    neighbors
-  );
+  triagens::basics::StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+  AppendFormattedDate(buffer, 
+                      timestamp, 
+                      format.json()->_value._string.data, 
+                      format.json()->_value._string.length - 1);
 
-  return VertexIdsToAqlValue(trx, resolver, neighbors, includeData);
+  return AqlValue(new Json(TRI_UNKNOWN_MEM_ZONE, buffer.c_str(), buffer.length()));
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,520 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief AQL HashJoinBlock
+///
+/// @file 
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2014 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, triagens GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/HashJoinBlock.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/CollectionScanner.h"
+#include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
+#include "Aql/ResourceUsage.h"
+#include "Basics/Exceptions.h"
+#include "Basics/fasthash.h"
+#include "Basics/json-utilities.h"
+#include "VocBase/vocbase.h"
+
+using namespace std;
+using namespace triagens::arango;
+using namespace triagens::aql;
+
+using Json = triagens::basics::Json;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief empty list of matches
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<TRI_df_marker_t const*> const NoMatches;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes a join key
+/// this is similar to TRI_FastHashJson, but produces the same hash value for
+/// all values that compare equal with TRI_CompareValuesJson
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t HashKey (uint64_t hash,
+                         TRI_json_t const* json) {
+  if (json == nullptr) {
+    return fasthash64(static_cast<void const*>("null"), 4, hash);
+  }
+
+  switch (json->_type) {
+    case TRI_JSON_UNUSED: 
+    case TRI_JSON_NULL: {
+      return fasthash64(static_cast<void const*>("null"), 4, hash);
+    }
+
+    case TRI_JSON_BOOLEAN: {
+      if (json->_value._boolean) {
+        return fasthash64(static_cast<void const*>("true"), 4, hash);
+      }
+      return fasthash64(static_cast<void const*>("false"), 5, hash);
+    }
+
+    case TRI_JSON_NUMBER: {
+      double value = json->_value._number;
+      if (value == 0.0) {
+        // +0 and -0 compare equal
+        value = 0.0;
+      }
+      return fasthash64(static_cast<void const*>(&value), sizeof(value), hash);
+    }
+
+    case TRI_JSON_STRING:
+    case TRI_JSON_STRING_REFERENCE: {
+      return fasthash64(static_cast<void const*>(json->_value._string.data), json->_value._string.length - 1, hash);
+    }
+
+    case TRI_JSON_OBJECT: {
+      // combine the attribute hashes so the attribute order does not matter
+      uint64_t result = fasthash64(static_cast<void const*>("object"), 6, hash);
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+
+      for (size_t i = 0; i < n; i += 2) {
+        auto key = static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i));
+        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i + 1));
+        result ^= HashKey(HashKey(hash, key), value);
+      }
+      return result;
+    }
+
+    case TRI_JSON_ARRAY: {
+      hash = fasthash64(static_cast<void const*>("array"), 5, hash);
+      size_t const n = TRI_LengthVector(&json->_value._objects);
+
+      for (size_t i = 0; i < n; ++i) {
+        auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&json->_value._objects, i));
+        hash = HashKey(hash, value);
+      }
+      return hash;
+    }
+  }
+
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                               class HashJoinBlock
+// -----------------------------------------------------------------------------
+
+HashJoinBlock::HashJoinBlock (ExecutionEngine* engine,
+                              HashJoinNode const* ep)
+  : ExecutionBlock(engine, ep),
+    _collection(ep->_collection),
+    _document(nullptr),
+    _table(),
+    _tableBuilt(false),
+    _trackedMemory(0),
+    _matches(nullptr),
+    _posInMatches(0),
+    _inRegister(ExecutionNode::MaxRegisterId),
+    _mustStoreResult(true),
+    _attributePath(),
+    _stringBuffer(TRI_UNKNOWN_MEM_ZONE) {
+
+  for (auto const& it : ep->_attribute) {
+    if (! _attributePath.empty()) {
+      _attributePath.push_back('.');
+    }
+    _attributePath.append(it);
+  }
+
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  if (trxCollection != nullptr) {
+    _trx->orderDitch(trxCollection);
+  }
+
+  auto it = ep->getRegisterPlan()->varInfo.find(ep->_inVariable->id);
+
+  if (it == ep->getRegisterPlan()->varInfo.end()) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "variable not found");
+  }
+
+  _inRegister = (*it).second.registerId;
+  TRI_ASSERT(_inRegister < ExecutionNode::MaxRegisterId);
+}
+
+HashJoinBlock::~HashJoinBlock () {
+  for (auto& it : _table) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, const_cast<TRI_json_t*>(it.first));
+  }
+
+  _engine->getQuery()->resourceMonitor()->decreaseMemoryUsage(_trackedMemory);
+}
+
+int HashJoinBlock::initialize () {
+  auto ep = static_cast<HashJoinNode const*>(_exeNode);
+  _mustStoreResult = ep->isVarUsedLater(ep->_outVariable);
+  _document = _trx->documentCollection(_collection->cid());
+  
+  return ExecutionBlock::initialize();
+}
+
+int HashJoinBlock::initializeCursor (AqlItemBlock* items, 
+                                     size_t pos) {
+  int res = ExecutionBlock::initializeCursor(items, pos);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  // the hash table is kept. the collection is not modified by the query
+  _matches = nullptr;
+  _posInMatches = 0;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* HashJoinBlock::getSome (size_t, // atLeast,
+                                      size_t atMost) {
+  if (_done) {
+    return nullptr;
+  }
+
+  // find the next input row with at least one matching document
+  while (true) {
+    if (_buffer.empty()) {
+      size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+      if (! ExecutionBlock::getBlock(toFetch, toFetch)) {
+        _done = true;
+        return nullptr;
+      }
+      _pos = 0;           // this is in the first block
+      _matches = nullptr;
+
+      // only build the hash table once there is an input row to look up
+      if (! _tableBuilt) {
+        buildHashTable();
+      }
+    }
+
+    AqlItemBlock* cur = _buffer.front();
+
+    if (_matches == nullptr) {
+      lookup(cur);
+    }
+
+    if (_posInMatches < _matches->size()) {
+      break;
+    }
+
+    nextRow(cur);
+  }
+
+  // If we get here, we do have _buffer.front() and matches for the current row
+  AqlItemBlock* cur = _buffer.front();
+  size_t const curRegs = cur->getNrRegs();
+
+  size_t available = _matches->size() - _posInMatches;
+  size_t toSend = (std::min)(atMost, available);
+  RegisterId nrRegs = getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()];
+
+  std::unique_ptr<AqlItemBlock> res(requestBlock(toSend, nrRegs));
+  // automatically freed if we throw
+  TRI_ASSERT(curRegs <= res->getNrRegs());
+
+  // only copy 1st row of registers inherited from previous frame(s)
+  inheritRegisters(cur, res.get(), _pos);
+
+  // set our collection for our output register
+  res->setDocumentCollection(static_cast<triagens::aql::RegisterId>(curRegs), _document);
+
+  for (size_t j = 0; j < toSend; j++) {
+    if (j > 0) {
+      // re-use already copied aqlvalues
+      for (RegisterId i = 0; i < curRegs; i++) {
+        res->setValue(j, i, res->getValueReference(0, i));
+        // Note: if this throws, then all values will be deleted
+        // properly since the first one is.
+      }
+    }
+
+    if (_mustStoreResult) {
+      res->setShaped(j, 
+                     static_cast<triagens::aql::RegisterId>(curRegs),
+                     (*_matches)[_posInMatches]);
+    }
+
+    ++_posInMatches;
+  }
+
+  if (_posInMatches >= _matches->size()) {
+    // all matches for this row sent
+    nextRow(cur);
+  }
+
+  // Clear out registers no longer needed later:
+  clearRegisters(res.get());
+
+  return res.release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skipSome
+////////////////////////////////////////////////////////////////////////////////
+
+size_t HashJoinBlock::skipSome (size_t atLeast, size_t atMost) {
+  size_t skipped = 0;
+
+  if (_done) {
+    return skipped;
+  }
+
+  while (skipped < atLeast) {
+    if (_buffer.empty()) {
+      size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+      if (! getBlock(toFetch, toFetch)) {
+        _done = true;
+        return skipped;
+      }
+      _pos = 0;           // this is in the first block
+      _matches = nullptr;
+
+      if (! _tableBuilt) {
+        buildHashTable();
+      }
+    }
+
+    AqlItemBlock* cur = _buffer.front();
+
+    if (_matches == nullptr) {
+      lookup(cur);
+    }
+
+    size_t available = _matches->size() - _posInMatches;
+
+    if (atMost >= skipped + available) {
+      skipped += available;
+      nextRow(cur);
+    }
+    else {
+      _posInMatches += atMost - skipped;
+      skipped = atMost;
+    }
+  }
+
+  return skipped;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the hash table from all documents in the collection
+/// the memory used by the table is charged to the query's resource monitor
+/// after each batch of documents, so a query that exceeds its memory limit
+/// is aborted while the table is built
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinBlock::buildHashTable () {
+  TRI_ASSERT(! _tableBuilt);
+
+  auto resourceMonitor = _engine->getQuery()->resourceMonitor();
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  LinearCollectionScanner scanner(_trx, trxCollection);
+
+  std::vector<TRI_doc_mptr_copy_t> documents;
+  documents.reserve(DefaultBatchSize);
+  
+  size_t const buckets = static_cast<size_t>(_collection->count());
+  resourceMonitor->increaseMemoryUsage(buckets * sizeof(void*));
+  _trackedMemory += buckets * sizeof(void*);
+
+  _table.reserve(buckets);
+
+  while (true) {
+    throwIfKilled(); // check if we were aborted
+  
+    TRI_IF_FAILURE("HashJoinBlock::buildHashTable") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+
+    documents.clear();
+    int res = scanner.scan(documents, DefaultBatchSize);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(res);
+    }
+
+    if (documents.empty()) {
+      break;
+    }
+
+    _engine->_stats.scannedFull += static_cast<int64_t>(documents.size());
+
+    size_t memory = 0;
+
+    for (auto const& it : documents) {
+      auto marker = static_cast<TRI_df_marker_t const*>(it.getDataPtr());
+      TRI_json_t* key = extractKey(marker);
+
+      auto found = _table.find(key);
+
+      if (found != _table.end()) {
+        // key already present
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, key);
+        (*found).second.emplace_back(marker);
+        memory += sizeof(TRI_df_marker_t const*);
+        continue;
+      }
+
+      try {
+        _table.emplace(key, std::vector<TRI_df_marker_t const*>{ marker });
+      }
+      catch (...) {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, key);
+        throw;
+      }
+
+      // the table node, its vector with one element and the key
+      memory += sizeof(decltype(_table)::value_type) + sizeof(void*) + 
+                sizeof(TRI_df_marker_t const*) + 
+                AqlValue::jsonMemoryUsage(key);
+    }
+
+    resourceMonitor->increaseMemoryUsage(memory);
+    _trackedMemory += memory;
+  }
+
+  _tableBuilt = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the join attribute value from a document
+/// the result is always a copy and must be freed by the caller. a missing
+/// attribute is returned as null
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* HashJoinBlock::extractKey (TRI_df_marker_t const* marker) {
+  auto const& attribute = static_cast<HashJoinNode const*>(_exeNode)->_attribute;
+
+  AqlValue document(marker);
+  TRI_json_t* key = nullptr;
+
+  if (attribute.size() == 1 || attribute[0][0] != '_') {
+    // the shaper can look up nested attribute paths directly
+    Json value(document.extractObjectMember(_trx, _document, _attributePath.c_str(), true, _stringBuffer));
+    key = value.steal();
+  }
+  else {
+    // nested attribute of a system attribute
+    Json value(document.extractObjectMember(_trx, _document, attribute[0].c_str(), true, _stringBuffer));
+    key = value.steal();
+  }
+
+  for (size_t i = 1; i < attribute.size() && attribute[0][0] == '_'; ++i) {
+    if (key == nullptr) {
+      break;
+    }
+
+    TRI_json_t* sub = nullptr;
+
+    if (TRI_IsObjectJson(key)) {
+      TRI_json_t const* member = TRI_LookupObjectJson(key, attribute[i].c_str());
+
+      if (member != nullptr) {
+        sub = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, member);
+      }
+    }
+
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, key);
+    key = sub;
+  }
+
+  if (key == nullptr) {
+    key = TRI_CreateNullJson(TRI_UNKNOWN_MEM_ZONE);
+
+    if (key == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+  }
+
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the documents matching the current input row
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinBlock::lookup (AqlItemBlock const* cur) {
+  AqlValue const& value = cur->getValueReference(_pos, _inRegister);
+  Json probe(value.toJson(_trx, cur->getDocumentCollection(_inRegister), false));
+
+  auto it = _table.find(probe.json());
+
+  if (it == _table.end()) {
+    _matches = &NoMatches;
+  }
+  else {
+    _matches = &((*it).second);
+  }
+  _posInMatches = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief advance to the next input row
+////////////////////////////////////////////////////////////////////////////////
+
+void HashJoinBlock::nextRow (AqlItemBlock* cur) {
+  _matches = nullptr;
+  _posInMatches = 0;
+
+  if (++_pos >= cur->size()) {
+    _buffer.pop_front();  // does not throw
+    returnBlock(cur);
+    _pos = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hasher for join keys
+////////////////////////////////////////////////////////////////////////////////
+
+size_t HashJoinBlock::KeyHash::operator() (TRI_json_t const* value) const {
+  return static_cast<size_t>(HashKey(0x12345678, value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief comparator for join keys
+////////////////////////////////////////////////////////////////////////////////
+    
+bool HashJoinBlock::KeyEqual::operator() (TRI_json_t const* lhs,
+                                          TRI_json_t const* rhs) const {
+  return (TRI_CompareValuesJson(lhs, rhs, false) == 0);
+}
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
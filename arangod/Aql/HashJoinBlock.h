@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief AQL HashJoinBlock
+///
+/// @file 
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2014 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, triagens GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_HASH_JOIN_BLOCK_H
+#define ARANGODB_AQL_HASH_JOIN_BLOCK_H 1
+
+#include "Aql/Collection.h"
+#include "Aql/ExecutionBlock.h"
+#include "Aql/ExecutionNode.h"
+#include "Basics/StringBuffer.h"
+
+struct TRI_df_marker_s;
+struct TRI_json_t;
+
+namespace triagens {
+  namespace aql {
+
+    class AqlItemBlock;
+
+    class ExecutionEngine;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     HashJoinBlock
+// -----------------------------------------------------------------------------
+
+    class HashJoinBlock : public ExecutionBlock {
+
+      public:
+
+        HashJoinBlock (ExecutionEngine* engine,
+                       HashJoinNode const* ep);
+
+        ~HashJoinBlock ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize
+////////////////////////////////////////////////////////////////////////////////
+
+        int initialize () override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initializeCursor
+////////////////////////////////////////////////////////////////////////////////
+
+        int initializeCursor (AqlItemBlock* items, size_t pos) override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* getSome (size_t atLeast, size_t atMost) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+// skip between atLeast and atMost, returns the number actually skipped . . .
+// will only return less than atLeast if there aren't atLeast many
+// things to skip overall.
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSome (size_t atLeast, size_t atMost) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the hash table from all documents in the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void buildHashTable ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the join attribute value from a document
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t* extractKey (TRI_df_marker_s const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up the documents matching the current input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void lookup (AqlItemBlock const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief advance to the next input row
+////////////////////////////////////////////////////////////////////////////////
+
+        void nextRow (AqlItemBlock*);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private classes
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hasher for join keys. objects are hashed independent of the order
+/// of their attributes, so that values that compare equal have the same hash
+////////////////////////////////////////////////////////////////////////////////
+
+        struct KeyHash {
+          size_t operator() (TRI_json_t const*) const;
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief comparator for join keys, using the semantics of the AQL == 
+/// operator
+////////////////////////////////////////////////////////////////////////////////
+
+        struct KeyEqual {
+          bool operator() (TRI_json_t const*,
+                           TRI_json_t const*) const;
+        };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the document collection
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_document_collection_t const* _document;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the hash table, mapping join attribute values to documents. the
+/// keys are owned by the table
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<TRI_json_t const*, std::vector<TRI_df_marker_s const*>, KeyHash, KeyEqual> _table;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the hash table was built
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _tableBuilt;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory charged to the query's resource monitor for the hash table
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _trackedMemory;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents matching the current input row, nullptr if the lookup
+/// for the current input row has not been done yet
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_df_marker_s const*> const* _matches;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief current position in _matches
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _posInMatches;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register containing the lookup value
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _inRegister;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the documents need to be stored
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _mustStoreResult;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the join attribute, as a dot-separated path
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _attributePath;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief temporary buffer for attribute extraction
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::StringBuffer _stringBuffer;
+    };
+
+  }  // namespace triagens::aql
+}  // namespace triagens
+
+#endif
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -29,6 +29,7 @@
 #include "Aql/ExecutionEngine.h"
 #include "Aql/Functions.h"
 #include "Basics/ScopeGuard.h"
+#include "Basics/StringUtils.h"
 #include "Basics/json-utilities.h"
 #include "Basics/Exceptions.h"
 #include "Indexes/EdgeIndex.h"
@@ -61,6 +62,8 @@ IndexRangeBlock::IndexRangeBlock (ExecutionEngine* engine,
                                   IndexRangeNode const* en)
   : ExecutionBlock(engine, en),
     _collection(en->collection()),
+    _index(en->_index),
+    _covering(en->_covering && en->_combination == IndexRangeNode::INDEX_COMBINATION_NONE),
     _posInDocs(0),
     _anyBoundVariable(false),
     _skiplistIterator(nullptr),
@@ -94,7 +97,35 @@ IndexRangeBlock::IndexRangeBlock (ExecutionEngine* engine,
     removeOverlapsIndexOr(*_condition);
   }
 
-  TRI_ASSERT(en->_index != nullptr);
+  TRI_ASSERT(_index != nullptr);
+
+  // conditions for the other indexes in case of index intersection or union.
+  // the bounds of these are always constant
+  for (auto const& lookup : en->_additionalLookups) {
+    IndexOrCondition condition;
+
+    for (auto const& andRanges : lookup.ranges) {
+      condition.emplace_back(IndexAndCondition());
+
+      for (auto const& ri : andRanges) {
+        TRI_ASSERT(ri.isConstant());
+        condition.back().emplace_back(ri.clone());
+      }
+    }
+
+    if (condition.size() > 1) {
+      removeOverlapsIndexOr(condition);
+    }
+
+    _additionalConditions.emplace_back(std::move(condition));
+  }
+
+  if (_covering) {
+    for (auto const& field : _index->fields) {
+      TRI_ASSERT(field.size() == 1 && ! field[0].shouldExpand);
+      _coveredAttributes.emplace_back(triagens::basics::StringUtils::split(field[0].name, '.'));
+    }
+  }
 
   _allBoundsConstant.clear();
   _allBoundsConstant.reserve(orRanges.size());
@@ -128,8 +159,7 @@ IndexRangeBlock::~IndexRangeBlock () {
 }
 
 bool IndexRangeBlock::useHighBounds () const {
-  auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  return (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX);
+  return (_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX);
 }
 
 bool IndexRangeBlock::hasV8Expression () const {
@@ -185,7 +215,7 @@ void IndexRangeBlock::buildExpressions () {
           bound = *(a._json);
           a.destroy();  // the TRI_json_t* of a._json has been stolen
         } 
-        else if (a._type == AqlValue::SHAPED || a._type == AqlValue::DOCVEC) {
+        else if (a._type == AqlValue::SHAPED || a._type == AqlValue::DOCVEC || a._type == AqlValue::COMPACT) {
           bound = a.toJson(_trx, myCollection, true);
           a.destroy();  // the TRI_json_t* of a._json has been stolen
         } 
@@ -255,7 +285,7 @@ void IndexRangeBlock::buildExpressions () {
             bound = *(a._json);
             a.destroy();  // the TRI_json_t* of a._json has been stolen
           } 
-          else if (a._type == AqlValue::SHAPED || a._type == AqlValue::DOCVEC) {
+          else if (a._type == AqlValue::SHAPED || a._type == AqlValue::DOCVEC || a._type == AqlValue::COMPACT) {
             bound = a.toJson(_trx, myCollection, true);
             a.destroy();  // the TRI_json_t* of a._json has been stolen
           } 
@@ -494,13 +524,17 @@ bool IndexRangeBlock::initRanges () {
   }
   
   auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  TRI_ASSERT(en->_index != nullptr);
+  TRI_ASSERT(_index != nullptr);
+
+  if (en->_combination != IndexRangeNode::INDEX_COMBINATION_NONE) {
+    return true; // all indexes are read at once in readIndex
+  }
    
-  if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
     return true; //no initialization here!
   }
   
-  if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
     if (_condition == nullptr || _condition->empty()) {
       return false;
     }
@@ -510,7 +544,7 @@ bool IndexRangeBlock::initRanges () {
     return (_edgeIndexIterator != nullptr);
   }
       
-  if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
     if (_condition == nullptr || _condition->empty()) {
       return false;
     }
@@ -520,7 +554,7 @@ bool IndexRangeBlock::initRanges () {
     return (_hashIndexSearchValue._values != nullptr); 
   }
   
-  if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
     if (_condition == nullptr || _condition->empty()) {
       return false;
     }
@@ -562,7 +596,7 @@ void IndexRangeBlock::sortConditions () {
   prefix.reserve(n);
 
   auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  size_t const numFields = en->_index->fields.size();
+  size_t const numFields = _index->fields.size();
 
   for (size_t s = 0; s < n; s++) {
     _sortCoords.emplace_back(s);
@@ -583,7 +617,7 @@ void IndexRangeBlock::sortConditions () {
       for (size_t u = 0; u < _condition->at(s).size(); u++) {
         auto const& ri = _condition->at(s)[u];
         std::string fieldString;
-        TRI_AttributeNamesToString(en->_index->fields[t], fieldString, true);
+        TRI_AttributeNamesToString(_index->fields[t], fieldString, true);
 
         if (fieldString.compare(ri._attr) == 0) {
     
@@ -793,21 +827,28 @@ bool IndexRangeBlock::readIndex (size_t atMost) {
   else { 
     _documents.clear();
   }
+  _elements.clear();
   
   auto en = static_cast<IndexRangeNode const*>(getPlanNode());
   
-  if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+  if (en->_combination != IndexRangeNode::INDEX_COMBINATION_NONE) {
+    // like the primary index, the combined indexes are read at once
+    if (_flag && _condition != nullptr) {
+      readCombinedIndexes();
+    }
+  }
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
     if (_flag && _condition != nullptr) {
       readPrimaryIndex(*_condition);
     }
   }
-  else if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
     readEdgeIndex(atMost);
   }
-  else if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
     readHashIndex(atMost);
   }
-  else if (en->_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
     readSkiplistIndex(atMost);
   }
   else {
@@ -874,7 +915,7 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
       if (! readIndex(atMost)) { //no more output from this version of the index
         if (++_pos >= cur->size()) {
           _buffer.pop_front();  // does not throw
-          delete cur;
+          returnBlock(cur);
           _pos = 0;
         }
         if (_buffer.empty()) {
@@ -902,7 +943,7 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
 
     if (toSend > 0) {
 
-      res.reset(new AqlItemBlock(toSend,
+      res.reset(requestBlock(toSend,
             getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
       // automatically freed should we throw
@@ -928,9 +969,15 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
         // The result is in the first variable of this depth,
         // we do not need to do a lookup in getPlanNode()->_registerPlan->varInfo,
         // but can just take cur->getNrRegs() as registerId:
-        res->setValue(j, static_cast<triagens::aql::RegisterId>(curRegs),
-                      AqlValue(reinterpret_cast<TRI_df_marker_t
-                               const*>(_documents[_posInDocs++].getDataPtr())));
+        if (_covering) {
+          res->setValue(j, static_cast<triagens::aql::RegisterId>(curRegs),
+                        coveringValue(_elements[_posInDocs++]));
+        }
+        else {
+          res->setValue(j, static_cast<triagens::aql::RegisterId>(curRegs),
+                        AqlValue(reinterpret_cast<TRI_df_marker_t
+                                 const*>(_documents[_posInDocs++].getDataPtr())));
+        }
         // No harm done, if the setValue throws!
       }
     }
@@ -989,7 +1036,7 @@ size_t IndexRangeBlock::skipSome (size_t atLeast,
       if (! readIndex(atMost)) {
         if (++_pos >= cur->size()) {
           _buffer.pop_front();  // does not throw
-          delete cur;
+          returnBlock(cur);
           _pos = 0;
         }
 
@@ -1011,6 +1058,122 @@ size_t IndexRangeBlock::skipSome (size_t atLeast,
   return skipped; 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read all documents of the current index lookup at once
+////////////////////////////////////////////////////////////////////////////////
+
+void IndexRangeBlock::readIndexCompletely () {
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+    readPrimaryIndex(*_condition);
+    return;
+  }
+
+  if (_condition->empty()) {
+    return;
+  }
+
+  _posInRanges = 0;
+
+  if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
+    getEdgeIndexIterator(_condition->at(_posInRanges));
+
+    while (_edgeIndexIterator != nullptr) {
+      readEdgeIndex(DefaultBatchSize);
+    }
+  }
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+    getHashIndexIterator(_condition->at(_posInRanges));
+
+    while (_hashIndexSearchValue._values != nullptr) {
+      readHashIndex(DefaultBatchSize);
+    }
+  }
+  else if (_index->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+    sortConditions();
+    getSkiplistIterator(_condition->at(_sortCoords[_posInRanges]));
+
+    while (_skiplistIterator != nullptr) {
+      readSkiplistIndex(DefaultBatchSize);
+    }
+  }
+  else {
+    TRI_ASSERT(false);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read the documents from all indexes of the node and combine them.
+/// the results of each index are sorted by document address, so they can be
+/// intersected or merged without looking at the documents
+////////////////////////////////////////////////////////////////////////////////
+
+void IndexRangeBlock::readCombinedIndexes () {
+  ENTER_BLOCK;
+  auto en = static_cast<IndexRangeNode const*>(getPlanNode());
+  bool const intersect = (en->_combination == IndexRangeNode::INDEX_COMBINATION_INTERSECTION);
+
+  auto compare = [] (TRI_doc_mptr_copy_t const& lhs, TRI_doc_mptr_copy_t const& rhs) -> bool {
+    return std::less<void const*>()(lhs.getDataPtr(), rhs.getDataPtr());
+  };
+  auto equal = [] (TRI_doc_mptr_copy_t const& lhs, TRI_doc_mptr_copy_t const& rhs) -> bool {
+    return lhs.getDataPtr() == rhs.getDataPtr();
+  };
+
+  IndexOrCondition* condition = _condition;
+
+  // the read functions work on _index and _condition, so switch these for
+  // every lookup and restore them afterwards
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [&]() -> void {
+      _index = en->_index;
+      _condition = condition;
+    }
+  };
+    
+  std::vector<TRI_doc_mptr_copy_t> result;
+  std::vector<TRI_doc_mptr_copy_t> combined;
+  size_t const n = _additionalConditions.size() + 1;
+
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0) {
+      _index = en->_additionalLookups[i - 1].index;
+      _condition = &_additionalConditions[i - 1];
+    }
+
+    _documents.clear();
+    readIndexCompletely();
+
+    std::sort(_documents.begin(), _documents.end(), compare);
+    _documents.erase(std::unique(_documents.begin(), _documents.end(), equal), _documents.end());
+
+    if (i == 0) {
+      result.swap(_documents);
+    }
+    else {
+      combined.clear();
+      combined.reserve(intersect ? (std::min)(result.size(), _documents.size()) : result.size() + _documents.size());
+
+      if (intersect) {
+        std::set_intersection(result.begin(), result.end(), _documents.begin(), _documents.end(), std::back_inserter(combined), compare);
+      }
+      else {
+        std::set_union(result.begin(), result.end(), _documents.begin(), _documents.end(), std::back_inserter(combined), compare);
+      }
+
+      result.swap(combined);
+    }
+
+    if (intersect && result.empty()) {
+      // no need to look into the other indexes
+      break;
+    }
+  }
+
+  _documents.swap(result);
+  LEAVE_BLOCK;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read documents using the primary index
 ////////////////////////////////////////////////////////////////////////////////
@@ -1151,8 +1314,7 @@ void IndexRangeBlock::readEdgeIndex (size_t atMost) {
     return;
   }
 
-  auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  auto idx = en->_index->getInternals();
+  auto idx = _index->getInternals();
   TRI_ASSERT(idx != nullptr);
  
   try { 
@@ -1191,6 +1353,70 @@ void IndexRangeBlock::readEdgeIndex (size_t atMost) {
   LEAVE_BLOCK;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the result value of a covering index scan. values of small
+/// fixed-size types (numbers, booleans, null and short strings) are stored
+/// inside the index element, so the document is not accessed for them
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue IndexRangeBlock::coveringValue (TRI_index_element_t const* element) const {
+  auto shaper = _collection->documentCollection()->getShaper();
+  TRI_ASSERT(shaper != nullptr);
+
+  size_t const n = _coveredAttributes.size();
+  std::unique_ptr<TRI_json_t> result(TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE, n));
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  TRI_shaped_sub_t const* subObjects = element->subObjects();
+
+  for (size_t i = 0; i < n; ++i) {
+    char const* data = nullptr;
+    size_t length = 0;
+    TRI_InspectShapedSub(&subObjects[i], element->document(), data, length);
+
+    TRI_shaped_json_t shaped;
+    shaped._sid = subObjects[i]._sid;
+    shaped._data.data = const_cast<char*>(data);
+    shaped._data.length = static_cast<uint32_t>(length);
+
+    TRI_json_t* value = TRI_JsonShapedJson(shaper, &shaped);
+
+    if (value == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    // create the sub-objects for nested attributes, e.g. "a.b"
+    auto const& parts = _coveredAttributes[i];
+    TRI_json_t* object = result.get();
+
+    for (size_t j = 0; j + 1 < parts.size(); ++j) {
+      TRI_json_t* sub = TRI_LookupObjectJson(object, parts[j].c_str());
+
+      if (sub == nullptr) {
+        TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, object, parts[j].c_str(), TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE));
+        sub = TRI_LookupObjectJson(object, parts[j].c_str());
+      }
+
+      if (! TRI_IsObjectJson(sub)) {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      object = sub;
+    }
+
+    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, object, parts.back().c_str(), value);
+  }
+
+  auto json = new Json(TRI_UNKNOWN_MEM_ZONE, result.get());
+  result.release();
+
+  return AqlValue(json);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the search values for the hash index lookup
 ////////////////////////////////////////////////////////////////////////////////
@@ -1213,8 +1439,7 @@ void IndexRangeBlock::destroyHashIndexSearchValues () {
 ////////////////////////////////////////////////////////////////////////////////
 
 bool IndexRangeBlock::setupHashIndexSearchValue (IndexAndCondition const& range) { 
-  auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  auto idx = en->_index->getInternals();
+  auto idx = _index->getInternals();
   TRI_ASSERT(idx != nullptr);
 
   auto hashIndex = static_cast<triagens::arango::HashIndex*>(idx);
@@ -1297,8 +1522,7 @@ void IndexRangeBlock::readHashIndex (size_t atMost) {
     return;
   }
 
-  auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  auto idx = en->_index->getInternals();
+  auto idx = _index->getInternals();
   TRI_ASSERT(idx != nullptr);
   
   size_t nrSent = 0;
@@ -1309,7 +1533,8 @@ void IndexRangeBlock::readHashIndex (size_t atMost) {
       THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
     }
 
-    static_cast<triagens::arango::HashIndex*>(idx)->lookup(&_hashIndexSearchValue, _documents, _hashNextElement, atMost);
+    static_cast<triagens::arango::HashIndex*>(idx)->lookup(&_hashIndexSearchValue, _documents, _hashNextElement, atMost,
+                                                           _covering ? &_elements : nullptr);
     size_t const numRead = _documents.size() - n;
 
     _engine->_stats.scannedIndex += static_cast<int64_t>(numRead);
@@ -1371,7 +1596,7 @@ void IndexRangeBlock::getSkiplistIterator (IndexAndCondition const& ranges) {
   TRI_ASSERT(_skiplistIterator == nullptr);
   
   auto en = static_cast<IndexRangeNode const*>(getPlanNode());
-  auto idx = en->_index->getInternals();
+  auto idx = _index->getInternals();
   TRI_ASSERT(idx != nullptr);
 
   auto shaper = _collection->documentCollection()->getShaper(); 
@@ -1479,6 +1704,10 @@ void IndexRangeBlock::readSkiplistIndex (size_t atMost) {
         }
         
         _documents.emplace_back(*(indexElement->document()));
+
+        if (_covering) {
+          _elements.emplace_back(indexElement);
+        }
         ++nrSent;
         ++_engine->_stats.scannedIndex;
       }
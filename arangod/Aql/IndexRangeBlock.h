@@ -126,12 +126,32 @@ namespace triagens {
         
         bool initRanges ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read all documents of the current index lookup at once
+////////////////////////////////////////////////////////////////////////////////
+
+        void readIndexCompletely ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read and combine the documents of all indexes (index intersection
+/// or union)
+////////////////////////////////////////////////////////////////////////////////
+
+        void readCombinedIndexes ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read using the primary index
 ////////////////////////////////////////////////////////////////////////////////
 
         void readPrimaryIndex (IndexOrCondition const&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the result value of a covering index scan from the attribute
+/// values stored in an index element
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlValue coveringValue (TRI_index_element_t const*) const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the hash index search value
 ////////////////////////////////////////////////////////////////////////////////
@@ -239,12 +259,46 @@ namespace triagens {
 
         Collection const* _collection;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the index currently read. this is the node's index, unless
+/// multiple indexes are combined
+////////////////////////////////////////////////////////////////////////////////
+
+        Index const* _index;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief conditions for the node's additional index lookups (only used for
+/// index intersection or union)
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<IndexOrCondition> _additionalConditions;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief document buffer
 ////////////////////////////////////////////////////////////////////////////////
 
         std::vector<TRI_doc_mptr_copy_t> _documents;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief index elements of the documents in _documents, only filled for
+/// covering index scans
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_index_element_t const*> _elements;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the index scan is covering
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _covering;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the indexed attributes (split into their parts), in the order of
+/// the index fields. only used for covering index scans
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::vector<std::string>> _coveredAttributes;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief current position in _allDocs
 ////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,54 @@ using namespace triagens::aql;
 using Json = triagens::basics::Json;
 using JsonHelper = triagens::basics::JsonHelper;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private classes
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write-locks the collection for processing a block of modifications
+///
+/// the lock is only acquired if the transaction does not hold it already.
+/// while it is held, the single-document operations called for each row will
+/// not acquire and release the collection lock themselves
+////////////////////////////////////////////////////////////////////////////////
+
+class BatchWriteLocker {
+
+  public:
+
+    BatchWriteLocker (AqlTransaction* trx,
+                      TRI_transaction_collection_t* trxCollection)
+      : _trx(trx),
+        _trxCollection(trxCollection),
+        _locked(false) {
+
+      if (! TRI_IsLockedCollectionTransaction(_trxCollection)) {
+        int res = _trx->writeLockCollection(_trxCollection);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          THROW_ARANGO_EXCEPTION(res);
+        }
+
+        _locked = true;
+      }
+    }
+
+    ~BatchWriteLocker () {
+      if (_locked) {
+        _trx->writeUnlockCollection(_trxCollection);
+      }
+    }
+
+  private:
+
+    AqlTransaction* _trx;
+
+    TRI_transaction_collection_t* _trxCollection;
+
+    bool _locked;
+};
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                           class ModificationBlock
 // -----------------------------------------------------------------------------
@@ -198,8 +246,6 @@ void ModificationBlock::constructMptr (TRI_doc_mptr_copy_t* dst,
   dst->_rid = TRI_EXTRACT_MARKER_RID(marker);
   dst->_fid = 0;
   dst->_hash = 0;
-  dst->_prev = nullptr;
-  dst->_next = nullptr;
   dst->setDataPtr(marker);
 }
 
@@ -295,8 +341,8 @@ AqlItemBlock* RemoveBlock::work (std::vector<AqlItemBlock*>& blocks) {
   bool const ignoreDocumentNotFound = ep->getOptions().ignoreDocumentNotFound;
   bool const producesOutput = (ep->_outVariableOld != nullptr);
 
-  result.reset(new AqlItemBlock(count,
-                                getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+  result.reset(requestBlock(count,
+                            getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
   if (producesOutput) {
     result->setDocumentCollection(_outRegOld, trxCollection->_collection->_collection);
@@ -311,6 +357,9 @@ AqlItemBlock* RemoveBlock::work (std::vector<AqlItemBlock*>& blocks) {
     throwIfKilled(); // check if we were aborted
       
     size_t const n = res->size();
+
+    // lock the collection once for the complete block
+    BatchWriteLocker locker(_trx, trxCollection);
     
     // loop over the complete block
     for (size_t i = 0; i < n; ++i) {
@@ -418,22 +467,25 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
 
   auto trxCollection = _trx->trxCollection(_collection->cid());
 
-  TRI_doc_mptr_copy_t nptr;
   bool const isEdgeCollection = _collection->isEdgeCollection();
   bool const producesOutput = (ep->_outVariableNew != nullptr);
-         
-  // initialize an empty edge container
-  TRI_document_edge_t edge = { 0, nullptr, 0, nullptr };
+  bool const ignoreErrors = ep->_options.ignoreErrors;
 
-  std::string from;
-  std::string to;
-
-  result.reset(new AqlItemBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+  result.reset(requestBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
   if (producesOutput) {
     result->setDocumentCollection(_outRegNew, trxCollection->_collection->_collection);
   }
 
+  std::vector<Json> jsons;
+  std::vector<TRI_json_t const*> values;
+  std::vector<void const*> data;
+  std::vector<int> results;
+  std::vector<TRI_doc_mptr_copy_t> mptrs;
+  std::vector<TRI_document_edge_t> edges;
+  std::vector<std::string> from;
+  std::vector<std::string> to;
+
   // loop over all blocks
   size_t dstRow = 0;
   for (auto it = blocks.begin(); it != blocks.end(); ++it) {
@@ -443,12 +495,25 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
     
     throwIfKilled(); // check if we were aborted
     
-    // loop over the complete block
+    jsons.clear();
+    jsons.reserve(n);
+    values.assign(n, nullptr);
+    data.assign(n, nullptr);
+    results.assign(n, TRI_ERROR_NO_ERROR);
+
+    if (isEdgeCollection) {
+      // initialize empty edge containers
+      edges.assign(n, TRI_document_edge_t{ 0, nullptr, 0, nullptr });
+      from.assign(n, std::string());
+      to.assign(n, std::string());
+    }
+    
+    // first convert the complete block into JSON
     for (size_t i = 0; i < n; ++i) {
       AqlValue a = res->getValue(i, registerId);
       
       // only copy 1st row of registers inherited from previous frame(s)
-      inheritRegisters(res, result.get(), i, dstRow);
+      inheritRegisters(res, result.get(), i, dstRow + i);
 
       int errorCode = TRI_ERROR_NO_ERROR;
 
@@ -463,7 +528,7 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
           json = member.json();
 
           if (TRI_IsStringJson(json)) {
-            errorCode = resolve(json->_value._string.data, edge._fromCid, from);
+            errorCode = resolve(json->_value._string.data, edges[i]._fromCid, from[i]);
           }
           else {
             errorCode = TRI_ERROR_ARANGO_DOCUMENT_HANDLE_BAD;
@@ -473,7 +538,7 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
             Json member(a.extractObjectMember(_trx, document, TRI_VOC_ATTRIBUTE_TO, false, _buffer));
             json = member.json();
             if (TRI_IsStringJson(json)) {
-              errorCode = resolve(json->_value._string.data, edge._toCid, to);
+              errorCode = resolve(json->_value._string.data, edges[i]._toCid, to[i]);
             }
             else {
               errorCode = TRI_ERROR_ARANGO_DOCUMENT_HANDLE_BAD;
@@ -486,28 +551,36 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
       }
 
       if (errorCode == TRI_ERROR_NO_ERROR) {
-        TRI_doc_mptr_copy_t mptr;
-        auto json = a.toJson(_trx, document, false);
+        jsons.emplace_back(a.toJson(_trx, document, false));
+        values[i] = jsons.back().json();
 
         if (isEdgeCollection) {
           // edge
-          edge._fromKey = (TRI_voc_key_t) from.c_str();
-          edge._toKey = (TRI_voc_key_t) to.c_str();
-          errorCode = _trx->create(trxCollection, &mptr, json.json(), &edge, ep->_options.waitForSync);
-        }
-        else {
-          // document
-          errorCode = _trx->create(trxCollection, &mptr, json.json(), nullptr, ep->_options.waitForSync);
+          edges[i]._fromKey = (TRI_voc_key_t) from[i].c_str();
+          edges[i]._toKey = (TRI_voc_key_t) to[i].c_str();
+          data[i] = &edges[i];
         }
+      }
 
-        if (producesOutput && errorCode == TRI_ERROR_NO_ERROR) {
-          result->setValue(dstRow,
-                           _outRegNew,
-                           AqlValue(reinterpret_cast<TRI_df_marker_t const*>(mptr.getDataPtr())));
-        }
+      results[i] = errorCode;
+    }
+
+    // now shape and insert all documents of the block in one go. this will
+    // stop at the first failed document unless errors are to be ignored
+    int errorCode = _trx->createBatch(trxCollection, values, data, mptrs, results, ! ignoreErrors, ep->_options.waitForSync);
+
+    if (errorCode != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(errorCode);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      if (producesOutput && results[i] == TRI_ERROR_NO_ERROR) {
+        result->setValue(dstRow,
+                         _outRegNew,
+                         AqlValue(reinterpret_cast<TRI_df_marker_t const*>(mptrs[i].getDataPtr())));
       }
 
-      handleResult(errorCode, ep->_options.ignoreErrors);
+      handleResult(results[i], ignoreErrors);
       ++dstRow; 
     }
     // done with a block
@@ -565,7 +638,7 @@ AqlItemBlock* UpdateBlock::work (std::vector<AqlItemBlock*>& blocks) {
   
   auto trxCollection = _trx->trxCollection(_collection->cid());
 
-  result.reset(new AqlItemBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+  result.reset(requestBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
   if (ep->_outVariableOld != nullptr) {
     result->setDocumentCollection(_outRegOld, trxCollection->_collection->_collection);
@@ -588,6 +661,9 @@ AqlItemBlock* UpdateBlock::work (std::vector<AqlItemBlock*>& blocks) {
     }
 
     size_t const n = res->size();
+
+    // lock the collection once for the complete block
+    BatchWriteLocker locker(_trx, trxCollection);
     
     // loop over the complete block
     for (size_t i = 0; i < n; ++i) {
@@ -761,7 +837,7 @@ AqlItemBlock* UpsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
   auto trxCollection = _trx->trxCollection(_collection->cid());
   bool const isEdgeCollection = _collection->isEdgeCollection();
 
-  result.reset(new AqlItemBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+  result.reset(requestBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
   if (ep->_outVariableNew != nullptr) {
     result->setDocumentCollection(_outRegNew, trxCollection->_collection->_collection);
@@ -993,7 +1069,7 @@ AqlItemBlock* ReplaceBlock::work (std::vector<AqlItemBlock*>& blocks) {
 
   auto trxCollection = _trx->trxCollection(_collection->cid());
 
-  result.reset(new AqlItemBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+  result.reset(requestBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
   if (ep->_outVariableOld != nullptr) {
     result->setDocumentCollection(_outRegOld, trxCollection->_collection->_collection);
@@ -1016,6 +1092,9 @@ AqlItemBlock* ReplaceBlock::work (std::vector<AqlItemBlock*>& blocks) {
     throwIfKilled(); // check if we were aborted
       
     size_t const n = res->size();
+
+    // lock the collection once for the complete block
+    BatchWriteLocker locker(_trx, trxCollection);
     
     // loop over the complete block
     for (size_t i = 0; i < n; ++i) {
@@ -476,6 +476,13 @@ void Optimizer::setupRules () {
   ///           levels go back to this or lower levels!
   //////////////////////////////////////////////////////////////////////////////
 
+  // reorder the FOR loops of a join based on collection sizes, 
+  // join conditions and index selectivity
+  registerRule("reorder-joins",
+               reorderJoinsRule,
+               reorderJoinsRule_pass3,
+               true);
+
   registerRule("interchange-adjacent-enumerations", 
                interchangeAdjacentEnumerationsRule,
                interchangeAdjacentEnumerationsRule_pass3,
@@ -554,6 +561,12 @@ void Optimizer::setupRules () {
                propagateConstantAttributesRule,
                propagateConstantAttributesRule_pass5,
                true);
+  
+  // decorrelate simple correlated subqueries
+  registerRule("decorrelate-subqueries",
+               decorrelateSubqueriesRule,
+               decorrelateSubqueriesRule_pass5,
+               true);
 
   //////////////////////////////////////////////////////////////////////////////
   /// "Pass 6": use indexes if possible for FILTER and/or SORT nodes
@@ -589,6 +602,12 @@ void Optimizer::setupRules () {
                useIndexForSortRule_pass6,
                true);
 
+  // replace remaining equi-joins with hash joins
+  registerRule("use-hash-join",
+               useHashJoinRule,
+               useHashJoinRule_pass6,
+               true);
+
   // finally, push calculations as far down as possible
   registerRule("move-calculations-down",
                moveCalculationsDownRule,
@@ -609,6 +628,24 @@ void Optimizer::setupRules () {
                patchUpdateStatementsRule_pass9,
                true);
 
+  // let SORT operations followed by a LIMIT only keep the required rows
+  registerRule("sort-limit",
+               sortLimitRule,
+               sortLimitRule_pass9,
+               true);
+
+  // evaluate filters during parallel full collection scans
+  registerRule("move-filters-into-enumerate",
+               moveFiltersIntoEnumerateRule,
+               moveFiltersIntoEnumerateRule_pass9,
+               true);
+
+  // read indexed attribute values from the index instead of the documents
+  registerRule("use-covering-index",
+               useCoveringIndexRule,
+               useCoveringIndexRule_pass9,
+               true);
+
   if (triagens::arango::ServerState::instance()->isCoordinator()) {
     // distribute operations in cluster
     registerRule("scatter-in-cluster",
@@ -631,6 +668,11 @@ void Optimizer::setupRules () {
                  distributeSortToClusterRule,
                  distributeSortToClusterRule_pass10,
                  true);
+
+    registerRule("distribute-collect-to-cluster",
+                 distributeCollectToClusterRule,
+                 distributeCollectToClusterRule_pass10,
+                 true);
     
     registerRule("remove-unnecessary-remote-scatter",
                  removeUnnecessaryRemoteScatterRule,
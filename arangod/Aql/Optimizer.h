@@ -125,6 +125,12 @@ namespace triagens {
 //////////////////////////////////////////////////////////////////////////////
 
         pass3                                         = 500,
+
+        // reorder the FOR loops of a join based on collection sizes, 
+        // join conditions and index selectivity
+        reorderJoinsRule_pass3                        = 505,
+
+        // enumerate all permutations of adjacent FOR loops
         interchangeAdjacentEnumerationsRule_pass3     = 510,
 
 //////////////////////////////////////////////////////////////////////////////
@@ -171,6 +177,10 @@ namespace triagens {
         // remove unused out variables for data-modification queries
         removeDataModificationOutVariablesRule_pass5  = 770,
 
+        // execute simple correlated subqueries only once and group their
+        // results
+        decorrelateSubqueriesRule_pass5               = 780,
+
 //////////////////////////////////////////////////////////////////////////////
 /// "Pass 6": use indexes if possible for FILTER and/or SORT nodes
 //////////////////////////////////////////////////////////////////////////////
@@ -192,6 +202,9 @@ namespace triagens {
         // try to find sort blocks which are superseeded by indexes
         useIndexForSortRule_pass6                     = 850,
 
+        // replace equi-joins that cannot use an index with hash joins
+        useHashJoinRule_pass6                         = 860,
+
 //////////////////////////////////////////////////////////////////////////////
 /// Pass 9: push down calculations beyond FILTERs and LIMITs
 //////////////////////////////////////////////////////////////////////////////
@@ -210,6 +223,25 @@ namespace triagens {
         
         patchUpdateStatementsRule_pass9               = 902,
 
+//////////////////////////////////////////////////////////////////////////////
+/// Pass 9: restrict SORT operations that are followed by a LIMIT
+//////////////////////////////////////////////////////////////////////////////
+        
+        sortLimitRule_pass9                           = 903,
+
+//////////////////////////////////////////////////////////////////////////////
+/// Pass 9: evaluate FILTERs directly during parallel collection scans
+//////////////////////////////////////////////////////////////////////////////
+        
+        moveFiltersIntoEnumerateRule_pass9            = 904,
+
+//////////////////////////////////////////////////////////////////////////////
+/// Pass 9: produce the indexed attributes from the index if a query does not
+/// need anything else from the documents
+//////////////////////////////////////////////////////////////////////////////
+        
+        useCoveringIndexRule_pass9                    = 905,
+
 //////////////////////////////////////////////////////////////////////////////
 /// "Pass 10": final transformations for the cluster
 //////////////////////////////////////////////////////////////////////////////
@@ -228,6 +260,10 @@ namespace triagens {
         // move SortNodes into the distribution.
         // adjust gathernode to also contain the sort criteria.
         distributeSortToClusterRule_pass10            = 1030,
+
+        // compute partial COLLECT results on the DB servers and merge them 
+        // on the coordinator
+        distributeCollectToClusterRule_pass10         = 1035,
         
         // try to get rid of a RemoteNode->ScatterNode combination which has
         // only a SingletonNode and possibly some CalculationNodes as dependencies
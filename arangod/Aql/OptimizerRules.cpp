@@ -32,6 +32,7 @@
 #include "Aql/Function.h"
 #include "Aql/Variable.h"
 #include "Aql/types.h"
+#include "Basics/StringUtils.h"
 
 using namespace triagens::aql;
 using Json = triagens::basics::Json;
@@ -151,7 +152,8 @@ int triagens::aql::removeRedundantSortsRule (Optimizer* opt,
           }
         }
         else if (current->getType() == EN::ENUMERATE_LIST ||
-                 current->getType() == EN::ENUMERATE_COLLECTION) {
+                 current->getType() == EN::ENUMERATE_COLLECTION ||
+                 current->getType() == EN::HASH_JOIN) {
           // ok, but we cannot remove two different sorts if one of these node types is between them
           // example: in the following query, the one sort will be optimized away:
           //   FOR i IN [ { a: 1 }, { a: 2 } , { a: 3 } ] SORT i.a ASC SORT i.a DESC RETURN i
@@ -845,7 +847,8 @@ int triagens::aql::removeSortRandRule (Optimizer* opt,
         case EN::FILTER: 
         case EN::SUBQUERY:
         case EN::ENUMERATE_LIST:
-        case EN::INDEX_RANGE: {
+        case EN::INDEX_RANGE:
+        case EN::HASH_JOIN: {
           // if we found another SortNode, an AggregateNode, FilterNode, a SubqueryNode, 
           // an EnumerateListNode or an IndexRangeNode
           // this means we cannot apply our optimization
@@ -1046,6 +1049,7 @@ int triagens::aql::moveCalculationsDownRule (Optimizer* opt,
       } 
       else if (currentType == EN::INDEX_RANGE ||
                currentType == EN::ENUMERATE_COLLECTION ||
+               currentType == EN::HASH_JOIN ||
                currentType == EN::ENUMERATE_LIST ||
                currentType == EN::AGGREGATE ||
                currentType == EN::NORESULTS) {
@@ -2057,6 +2061,10 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
     
     // a reference to the indexes processed for CollectionNodes
     IndexCache& _doneIndexes;
+
+    // a reference to the CollectionNodes for which a node combining multiple
+    // indexes has been created
+    std::unordered_set<ExecutionNode const*>& _doneCombinations;
   
   public:
 
@@ -2065,7 +2073,8 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
                             std::unordered_map<size_t, size_t>& changesPlaces,
                             std::vector<std::pair<size_t, std::vector<ExecutionNode*>>>& changes,
                             std::unordered_set<ExecutionNode const*>& doneCollections, 
-                            IndexCache& doneIndexes)
+                            IndexCache& doneIndexes,
+                            std::unordered_set<ExecutionNode const*>& doneCombinations)
       : _rangeInfoMapVec(nullptr),
         _plan(plan), 
         _varIds(),
@@ -2074,7 +2083,8 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
         _changesPlaces(changesPlaces),
         _changes(changes),
         _doneCollections(doneCollections),
-        _doneIndexes(doneIndexes) {
+        _doneIndexes(doneIndexes),
+        _doneCombinations(doneCombinations) {
 
       _varIds.emplace(var->id);
     }
@@ -2086,7 +2096,362 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
     bool modified () const {
       return _modified;
     }
-    
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the lookup condition for an index from the ranges found at
+/// the positions <validPos>. returns an empty condition if the index cannot
+/// be used for all of these positions
+////////////////////////////////////////////////////////////////////////////////
+
+    IndexOrCondition buildIndexOrCondition (triagens::aql::Index const* idx,
+                                            size_t prefix,
+                                            Variable const* var,
+                                            std::vector<size_t> const& validPos) const {
+      // initialize all conditions with empty ranges
+      IndexOrCondition indexOrCondition(validPos.size());
+
+      if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+        for (size_t k = 0; k < validPos.size(); k++) {
+          bool handled = false;
+
+          auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
+          auto range = map->find(std::string(TRI_VOC_ATTRIBUTE_ID));
+
+          if (range != map->end()) { 
+            if (! range->second.is1ValueRangeInfo()) {
+              indexOrCondition.clear();   // not usable
+              break;
+            }
+
+            indexOrCondition.at(k).emplace_back(range->second);
+            handled = true;
+          }
+
+          if (! handled) {
+            range = map->find(std::string(TRI_VOC_ATTRIBUTE_KEY));
+
+            if (range != map->end()) {
+              if (! range->second.is1ValueRangeInfo()) {
+                indexOrCondition.clear();   // not usable
+                break;
+              }
+
+              indexOrCondition.at(k).emplace_back(range->second);
+            }
+          }
+        }
+      }
+      else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
+        for (size_t k = 0; k < validPos.size(); k++) {
+          bool handled = false;
+
+          auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
+          auto range = map->find(std::string(TRI_VOC_ATTRIBUTE_FROM));
+
+          if (range != map->end()) { 
+            if (! range->second.is1ValueRangeInfo()) {
+              indexOrCondition.clear();
+              break; // not usable
+            }
+
+            indexOrCondition.at(k).emplace_back(range->second);
+            handled = true;
+          }
+
+          if (! handled) {
+            range = map->find(std::string(TRI_VOC_ATTRIBUTE_TO));
+
+            if (range != map->end()) {
+              if (! range->second.is1ValueRangeInfo()) {
+                indexOrCondition.clear();   // not usable
+                break;
+              }
+
+              indexOrCondition.at(k).emplace_back(range->second);
+            }
+          }
+        }
+      }
+      else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+        // each valid orCondition should match every field of the given index
+        for (size_t k = 0; k < validPos.size() && ! indexOrCondition.empty(); k++) {
+          auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
+
+          for (size_t j = 0; j < idx->fields.size(); j++) {
+            std::string fieldString;
+            TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
+            auto range = map->find(fieldString);
+
+            if (range == map->end() || ! range->second.is1ValueRangeInfo()) {
+              indexOrCondition.clear();   // not usable
+              break;
+            }
+
+            if (idx->sparse) {
+              // a sparse hash index must not be used if any of the lookup values is
+              // either null (null is not contained in a sparse index) or is calculated
+              // using an expression with unknown result. this is because the expression
+              // result may be null and using the sparse index then would not allow
+              // finding the document
+              bool mustClear = false;
+              auto const& rib = range->second; 
+
+              if (rib.isConstant()) {
+                // value is constant (and an equality because we're looking at a hash index)
+                auto const& value = rib._lowConst.bound();
+                if (value.isEmpty() || value.isNull()) {
+                  // lookup value is null. can't use a sparse index.
+                  mustClear = true;
+                }
+              }
+              else {
+                // non-constant lookup value. it might be null, so we can't use the index
+                mustClear = true;
+              }
+
+              if (mustClear) {
+                // not usable
+                indexOrCondition.clear();   
+                break; // exit for loop
+              }
+            }
+
+            indexOrCondition.at(k).emplace_back(range->second);
+          }
+        }
+      }
+      else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+        for (size_t k = 0; k < validPos.size(); k++) {
+          auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
+
+          std::string fieldString;
+          TRI_AttributeNamesToString(idx->fields[0], fieldString, true);
+          // check if there is a range that contains the first index attribute
+          auto range = map->find(fieldString);
+
+          if (range == map->end()) { 
+            indexOrCondition.clear();
+            break; // not usable
+          }
+
+          // insert the first index attribute
+          indexOrCondition.at(k).emplace_back(range->second);
+
+          // iterate over all index attributes from left to right 
+          bool equality = range->second.is1ValueRangeInfo();
+          bool handled = false;
+          size_t j = 0;
+          while (++j < prefix && equality) {
+            std::string fieldString;
+            TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
+            range = map->find(fieldString);
+
+            if (range == map->end()) { 
+              indexOrCondition.clear();
+              handled = true;
+              break; // not usable
+            }
+
+            indexOrCondition.at(k).emplace_back(range->second);
+            equality = equality && range->second.is1ValueRangeInfo();
+          }
+
+          if (handled) {
+            break; // exit for loop
+          }
+        }
+
+        // check if index is sparse and exclude it if required
+        // a sparse skiplist index must not be used if any of the lookup values is
+        // either null (null is not contained in a sparse index) or is calculated
+        // using an expression with unknown result. this is because the expression
+        // result may be null and using the sparse index then would not allow
+        // finding the document
+        if (idx->sparse && ! indexOrCondition.empty()) {
+          for (size_t k = 0; k < validPos.size() && ! indexOrCondition.empty(); k++) {
+            auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
+
+            for (size_t j = 0; j < idx->fields.size(); j++) {
+              std::string fieldString;
+              TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
+              auto range = map->find(fieldString);
+
+              if (range == map->end()) { 
+                indexOrCondition.clear();
+                break; // not usable
+              }
+
+              auto const& rib = range->second; 
+
+              // if the lookup value is dynamic, undefined or includes null, then we 
+              // can't use the index
+              if (! rib.isConstant() || 
+                  ! rib._lowConst.isDefined() ||
+                  (rib._lowConst.inclusive() && rib._lowConst.bound().isNull())) {
+                indexOrCondition.clear();
+                break;
+              }
+            }
+          }
+        }
+
+      }
+
+      // check if there are all positions are non-empty
+      bool isEmpty = indexOrCondition.empty();
+
+      if (! isEmpty) {
+        size_t const vs = validPos.size();
+
+        for (size_t k = 0; k < vs; k++) {
+          if (indexOrCondition[k].empty()) {
+            isEmpty = true;
+            break;
+          }
+        }
+      }
+
+      if (isEmpty) {
+        indexOrCondition.clear();
+      }
+
+      return indexOrCondition;
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not all bounds of an index condition are constant
+////////////////////////////////////////////////////////////////////////////////
+
+    static bool isConstantCondition (IndexOrCondition const& condition) {
+      for (auto const& andCondition : condition) {
+        for (auto const& ri : andCondition) {
+          if (! ri.isConstant()) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an IndexRangeNode that combines multiple indexes, in
+/// addition to the nodes that use a single index:
+/// - index intersection: a condition without OR, with some attributes covered
+///   by one index and some by another (e.g. doc.a == 1 && doc.b == 2 with
+///   separate indexes on a and b)
+/// - index union: an OR condition whose parts can only be covered by
+///   different indexes (e.g. doc.a == 1 || doc.b == 2)
+/// only constant lookup values are supported
+////////////////////////////////////////////////////////////////////////////////
+
+    void addCombinedIndexNode (EnumerateCollectionNode* node,
+                               Variable const* var,
+                               std::vector<size_t> const& validPos,
+                               std::vector<triagens::aql::Index*> const& idxs,
+                               std::vector<size_t> const& prefixes) {
+      if (_doneCombinations.find(node) != _doneCombinations.end()) {
+        return;
+      }
+
+      std::vector<IndexRangeNode::IndexLookup> lookups;
+      IndexRangeNode::IndexCombination combination;
+
+      if (validPos.size() == 1) {
+        combination = IndexRangeNode::INDEX_COMBINATION_INTERSECTION;
+        std::unordered_set<std::string> covered;
+
+        for (size_t i = 0; i < idxs.size(); ++i) {
+          auto condition = buildIndexOrCondition(idxs[i], prefixes[i], var, validPos);
+
+          if (condition.empty() || ! isConstantCondition(condition)) {
+            continue;
+          }
+
+          // only use indexes that cover attributes not covered by the other
+          // indexes picked so far
+          bool coversNew = false;
+          for (auto const& ri : condition[0]) {
+            if (covered.emplace(ri._attr).second) {
+              coversNew = true;
+            }
+          }
+
+          if (coversNew) {
+            lookups.emplace_back(IndexRangeNode::IndexLookup{ idxs[i], condition });
+          }
+        }
+      }
+      else {
+        combination = IndexRangeNode::INDEX_COMBINATION_UNION;
+
+        for (auto const& pos : validPos) {
+          std::vector<size_t> const onePos{ pos };
+          bool found = false;
+
+          // use the first index that covers this part of the OR condition
+          for (size_t i = 0; i < idxs.size() && ! found; ++i) {
+            auto condition = buildIndexOrCondition(idxs[i], prefixes[i], var, onePos);
+
+            if (condition.empty() || ! isConstantCondition(condition)) {
+              continue;
+            }
+
+            found = true;
+
+            for (auto& lookup : lookups) {
+              if (lookup.index == idxs[i]) {
+                lookup.ranges.emplace_back(condition[0]);
+                condition.clear();
+                break;
+              }
+            }
+
+            if (! condition.empty()) {
+              lookups.emplace_back(IndexRangeNode::IndexLookup{ idxs[i], condition });
+            }
+          }
+
+          if (! found) {
+            // this part of the OR condition cannot use an index
+            return;
+          }
+        }
+      }
+
+      if (lookups.size() < 2) {
+        // the single-index nodes cover this already
+        return;
+      }
+
+      _doneCombinations.emplace(node);
+
+      auto indexRangeNode = new IndexRangeNode(
+        _plan, 
+        _plan->nextId(), 
+        node->vocbase(), 
+        node->collection(), 
+        node->outVariable(), 
+        lookups[0].index, 
+        lookups[0].ranges, 
+        false
+      );
+
+      std::unique_ptr<ExecutionNode> newNode(indexRangeNode);
+      lookups.erase(lookups.begin());
+      indexRangeNode->combineWith(combination, lookups);
+
+      size_t place = node->id();
+
+      auto it = _changesPlaces.find(place);
+
+      if (it == _changesPlaces.end()) {
+        _changes.emplace_back(place, std::vector<ExecutionNode*>());
+        it = _changesPlaces.emplace(place, _changes.size() - 1).first;
+      }
+
+      _changes[it->second].second.emplace_back(newNode.release());
+    }
+
     bool before (ExecutionNode* en) override final {
       _canThrow = (_canThrow || en->canThrow()); // can any node walked over throw?
 
@@ -2095,6 +2460,7 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
         case EN::SUBQUERY:        
         case EN::SORT:
         case EN::INDEX_RANGE:
+        case EN::HASH_JOIN:
           break;
 
         case EN::CALCULATION: {
@@ -2289,210 +2655,8 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
                       } 
                     }
 
-                    // initialize all conditions with empty ranges
-                    IndexOrCondition indexOrCondition(validPos.size());
-
-
-                    if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
-                      for (size_t k = 0; k < validPos.size(); k++) {
-                        bool handled = false;
-
-                        auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
-                        auto range = map->find(std::string(TRI_VOC_ATTRIBUTE_ID));
-
-                        if (range != map->end()) { 
-                          if (! range->second.is1ValueRangeInfo()) {
-                            indexOrCondition.clear();   // not usable
-                            break;
-                          }
-
-                          indexOrCondition.at(k).emplace_back(range->second);
-                          handled = true;
-                        }
-
-                        if (! handled) {
-                          range = map->find(std::string(TRI_VOC_ATTRIBUTE_KEY));
-
-                          if (range != map->end()) {
-                            if (! range->second.is1ValueRangeInfo()) {
-                              indexOrCondition.clear();   // not usable
-                              break;
-                            }
-
-                            indexOrCondition.at(k).emplace_back(range->second);
-                          }
-                        }
-                      }
-                    }
-                    else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX) {
-                      for (size_t k = 0; k < validPos.size(); k++) {
-                        bool handled = false;
-
-                        auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
-                        auto range = map->find(std::string(TRI_VOC_ATTRIBUTE_FROM));
-
-                        if (range != map->end()) { 
-                          if (! range->second.is1ValueRangeInfo()) {
-                            indexOrCondition.clear();
-                            break; // not usable
-                          }
-
-                          indexOrCondition.at(k).emplace_back(range->second);
-                          handled = true;
-                        }
-
-                        if (! handled) {
-                          range = map->find(std::string(TRI_VOC_ATTRIBUTE_TO));
-
-                          if (range != map->end()) {
-                            if (! range->second.is1ValueRangeInfo()) {
-                              indexOrCondition.clear();   // not usable
-                              break;
-                            }
-
-                            indexOrCondition.at(k).emplace_back(range->second);
-                          }
-                        }
-                      }
-                    }
-                    else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
-                      // each valid orCondition should match every field of the given index
-                      for (size_t k = 0; k < validPos.size() && ! indexOrCondition.empty(); k++) {
-                        auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
-                      
-                        for (size_t j = 0; j < idx->fields.size(); j++) {
-                          std::string fieldString;
-                          TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
-                          auto range = map->find(fieldString);
-                      
-                          if (range == map->end() || ! range->second.is1ValueRangeInfo()) {
-                            indexOrCondition.clear();   // not usable
-                            break;
-                          }
- 
-                          if (idx->sparse) {
-                            // a sparse hash index must not be used if any of the lookup values is
-                            // either null (null is not contained in a sparse index) or is calculated
-                            // using an expression with unknown result. this is because the expression
-                            // result may be null and using the sparse index then would not allow
-                            // finding the document
-                            bool mustClear = false;
-                            auto const& rib = range->second; 
-
-                            if (rib.isConstant()) {
-                              // value is constant (and an equality because we're looking at a hash index)
-                              auto const& value = rib._lowConst.bound();
-                              if (value.isEmpty() || value.isNull()) {
-                                // lookup value is null. can't use a sparse index.
-                                mustClear = true;
-                              }
-                            }
-                            else {
-                              // non-constant lookup value. it might be null, so we can't use the index
-                              mustClear = true;
-                            }
-                          
-                            if (mustClear) {
-                              // not usable
-                              indexOrCondition.clear();   
-                              break; // exit for loop
-                            }
-                          }
-
-                          indexOrCondition.at(k).emplace_back(range->second);
-                        }
-                      }
-                    }
-                    else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
-                      for (size_t k = 0; k < validPos.size(); k++) {
-                        auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
-
-                        std::string fieldString;
-                        TRI_AttributeNamesToString(idx->fields[0], fieldString, true);
-                        // check if there is a range that contains the first index attribute
-                        auto range = map->find(fieldString);
-
-                        if (range == map->end()) { 
-                          indexOrCondition.clear();
-                          break; // not usable
-                        }
-
-                        // insert the first index attribute
-                        indexOrCondition.at(k).emplace_back(range->second);
-                       
-                        // iterate over all index attributes from left to right 
-                        bool equality = range->second.is1ValueRangeInfo();
-                        bool handled = false;
-                        size_t j = 0;
-                        while (++j < prefixes.at(i) && equality) {
-                          std::string fieldString;
-                          TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
-                          range = map->find(fieldString);
-
-                          if (range == map->end()) { 
-                            indexOrCondition.clear();
-                            handled = true;
-                            break; // not usable
-                          }
-
-                          indexOrCondition.at(k).emplace_back(range->second);
-                          equality = equality && range->second.is1ValueRangeInfo();
-                        }
-
-                        if (handled) {
-                          break; // exit for loop
-                        }
-                      }
-
-                      // check if index is sparse and exclude it if required
-                      // a sparse skiplist index must not be used if any of the lookup values is
-                      // either null (null is not contained in a sparse index) or is calculated
-                      // using an expression with unknown result. this is because the expression
-                      // result may be null and using the sparse index then would not allow
-                      // finding the document
-                      if (idx->sparse && ! indexOrCondition.empty()) {
-                        for (size_t k = 0; k < validPos.size() && ! indexOrCondition.empty(); k++) {
-                          auto const map = _rangeInfoMapVec->find(var->name, validPos[k]);
-
-                          for (size_t j = 0; j < idx->fields.size(); j++) {
-                            std::string fieldString;
-                            TRI_AttributeNamesToString(idx->fields[j], fieldString, true);
-                            auto range = map->find(fieldString);
-
-                            if (range == map->end()) { 
-                              indexOrCondition.clear();
-                              break; // not usable
-                            }
-
-                            auto const& rib = range->second; 
-
-                            // if the lookup value is dynamic, undefined or includes null, then we 
-                            // can't use the index
-                            if (! rib.isConstant() || 
-                                ! rib._lowConst.isDefined() ||
-                                (rib._lowConst.inclusive() && rib._lowConst.bound().isNull())) {
-                              indexOrCondition.clear();
-                              break;
-                            }
-                          }
-                        }
-                      }
-
-                    }
-
-                    // check if there are all positions are non-empty
-                    bool isEmpty = indexOrCondition.empty();
-
-                    if (! isEmpty) {
-                      size_t const vs = validPos.size();
-
-                      for (size_t k = 0; k < vs; k++) {
-                        if (indexOrCondition[k].empty()) {
-                          isEmpty = true;
-                          break;
-                        }
-                      }
-                    }
+                    IndexOrCondition indexOrCondition(buildIndexOrCondition(idx, prefixes.at(i), var, validPos));
+                    bool const isEmpty = indexOrCondition.empty();
 
                     if (! isEmpty) {
                       // enter index into the index cache
@@ -2542,6 +2706,9 @@ class FilterToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
                       // exception happens, the destructor will free it
                     }
                   }
+
+                  // additionally try index intersection or index union
+                  addCombinedIndexNode(node, var, validPos, idxs, prefixes);
                 }
               }
             }
@@ -2611,6 +2778,7 @@ int triagens::aql::useIndexRangeRule (Optimizer* opt,
 
   try {
     std::unordered_set<ExecutionNode const*> doneCollections;
+    std::unordered_set<ExecutionNode const*> doneCombinations;
     FilterToEnumCollFinder::IndexCache doneIndexes;
 
     for (auto const& n : nodes) {
@@ -2623,7 +2791,7 @@ int triagens::aql::useIndexRangeRule (Optimizer* opt,
       auto invars = nn->getVariablesUsedHere();
       TRI_ASSERT(invars.size() == 1);
 
-      FilterToEnumCollFinder finder(plan, invars[0], changesPlaces, changes, doneCollections, doneIndexes);
+      FilterToEnumCollFinder finder(plan, invars[0], changesPlaces, changes, doneCollections, doneIndexes, doneCombinations);
       nn->walk(&finder);
       modified |= finder.modified();
 
@@ -2937,6 +3105,7 @@ class SortToIndexNode final : public WalkerWorker<ExecutionNode> {
 
         if (node->getType() == EN::ENUMERATE_COLLECTION ||
             node->getType() == EN::INDEX_RANGE ||
+            node->getType() == EN::HASH_JOIN ||
             node->getType() == EN::ENUMERATE_LIST) {
           // we are contained in an outer loop
           return true;
@@ -3065,6 +3234,7 @@ class SortToIndexNode final : public WalkerWorker<ExecutionNode> {
       case EN::GATHER:
       case EN::REMOTE:
       case EN::ILLEGAL:
+      case EN::HASH_JOIN:
       case EN::LIMIT:                      // LIMIT is criterion to stop
         return true;  // abort.
 
@@ -3316,20 +3486,35 @@ int triagens::aql::removeFiltersCoveredByIndexRule (Optimizer* opt,
     while (current != nullptr) {
       if (current->getType() == EN::INDEX_RANGE) {
         // found an index range, now check if the expression is covered by the index
-        auto const& ranges = static_cast<IndexRangeNode const*>(current)->ranges();
+        auto indexRangeNode = static_cast<IndexRangeNode const*>(current);
+
+        if (indexRangeNode->combination() == IndexRangeNode::INDEX_COMBINATION_UNION) {
+          // the documents found by an index union do not all satisfy the 
+          // ranges of any single index
+          break;
+        }
+
+        std::vector<std::vector<std::vector<RangeInfo>> const*> allRanges{ &indexRangeNode->ranges() };
+
+        // with index intersection, all documents satisfy the ranges of every index
+        for (auto const& lookup : indexRangeNode->additionalLookups()) {
+          allRanges.emplace_back(&lookup.ranges);
+        }
 
         // TODO: this is not prepared for OR conditions
-        for (auto const& it : ranges) {
-          for (auto it2 : it) {
-            if (condition.isFullyCoveredBy(it2)) {
-              toUnlink.emplace(setter);
-              toUnlink.emplace(n);
+        for (auto const& ranges : allRanges) {
+          for (auto const& it : *ranges) {
+            for (auto it2 : it) {
+              if (condition.isFullyCoveredBy(it2)) {
+                toUnlink.emplace(setter);
+                toUnlink.emplace(n);
+                break;
+              }
+            } 
+
+            if (handled) {
               break;
             }
-          } 
-
-          if (handled) {
-            break;
           }
         }
       }
@@ -3357,61 +3542,1169 @@ int triagens::aql::removeFiltersCoveredByIndexRule (Optimizer* opt,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief helper to compute lots of permutation tuples
-/// a permutation tuple is represented as a single vector together with
-/// another vector describing the boundaries of the tuples.
-/// Example:
-/// data:   0,1,2, 3,4, 5,6
-/// starts: 0,     3,   5,      (indices of starts of sections)
-/// means a tuple of 3 permutations of 3, 2 and 2 points respectively
-/// This function computes the next permutation tuple among the 
-/// lexicographically sorted list of all such tuples. It returns true
-/// if it has successfully computed this and false if the tuple is already
-/// the lexicographically largest one. If false is returned, the permutation
-/// tuple is back to the beginning.
+/// @brief splits an attribute access expression such as "doc.a.b" into its
+/// attribute names. returns the accessed variable or nullptr if the
+/// expression is not a pure attribute access
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool NextPermutationTuple (std::vector<size_t>& data,
-                                  std::vector<size_t>& starts) {
-  auto begin = data.begin();  // a random access iterator
+static Variable const* HashJoinAttributeAccess (AstNode const* node,
+                                                std::vector<std::string>& attribute) {
+  attribute.clear();
 
-  for (size_t i = starts.size(); i-- != 0; ) {
-    std::vector<size_t>::iterator from = begin + starts[i];
-    std::vector<size_t>::iterator to;
-    if (i == starts.size() - 1) {
-      to = data.end();
-    }
-    else {
-      to = begin + starts[i + 1];
-    }
-    if (std::next_permutation(from, to)) {
-      return true;
-    }
+  while (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    attribute.emplace(attribute.begin(), std::string(node->getStringValue(), node->getStringLength()));
+    node = node->getMember(0);
   }
 
-  return false;
+  if (attribute.empty() || node->type != NODE_TYPE_REFERENCE) {
+    return nullptr;
+  }
+
+  return static_cast<Variable const*>(node->getData());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief interchange adjacent EnumerateCollectionNodes in all possible ways
+/// @brief returns the singleton node at the top of the (sub)query that
+/// contains <node>
 ////////////////////////////////////////////////////////////////////////////////
 
-int triagens::aql::interchangeAdjacentEnumerationsRule (Optimizer* opt,
-                                                        ExecutionPlan* plan,
-                                                        Optimizer::Rule const* rule) {
-  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+static ExecutionNode const* HashJoinSingleton (ExecutionNode const* node) {
+  while (node->hasDependency()) {
+    node = node->getFirstDependency();
+  }
+  return node;
+}
 
-  std::unordered_set<ExecutionNode*> nodesSet;
-  for (auto const& n : nodes) {
-    TRI_ASSERT(nodesSet.find(n) == nodesSet.end());
-    nodesSet.emplace(n);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the node is executed more than once per query, i.e.
+/// if it is contained in an outer loop or in a subquery. building a hash
+/// table only pays off for such nodes
+////////////////////////////////////////////////////////////////////////////////
+
+static bool HashJoinIsExecutedRepeatedly (ExecutionPlan const* plan,
+                                          ExecutionNode const* node) {
+  auto current = node;
+  while (current->hasDependency()) {
+    current = current->getFirstDependency();
+    auto const type = current->getType();
+
+    if (type == EN::ENUMERATE_COLLECTION ||
+        type == EN::INDEX_RANGE ||
+        type == EN::HASH_JOIN ||
+        type == EN::ENUMERATE_LIST) {
+      // contained in an outer loop
+      return true;
+    }
   }
 
-  std::vector<ExecutionNode*> nodesToPermute;
-  std::vector<size_t> permTuple;
-  std::vector<size_t> starts;
+  // no outer loop. still, the node will be executed repeatedly if it is 
+  // contained in a subquery
+  return (current != HashJoinSingleton(plan->root()));
+}
 
-  // We use that the order of the nodes is such that a node B that is among the
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace equi-joins that cannot use an index with hash joins
+///
+/// this rule looks for an EnumerateCollectionNode inside an outer loop that
+/// is followed by a FILTER of the form `inner.attribute == expression`, with
+/// `expression` only depending on variables of outer loops. such a node is
+/// replaced with a HashJoinNode that builds a hash table over the inner
+/// collection once and then looks up the value of `expression` for each
+/// input row. The FILTER is kept, so its semantics are unaffected. the rule
+/// runs after the index rules so it only kicks in when no index applies
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useHashJoinRule (Optimizer* opt,
+                                    ExecutionPlan* plan,
+                                    Optimizer::Rule const* rule) {
+  if (triagens::arango::ServerState::instance()->isCoordinator()) {
+    // the hash join is not yet supported in the cluster
+    opt->addPlan(plan, rule, false);
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+  bool modified = false;
+
+  for (auto const& n : nodes) {
+    auto en = static_cast<EnumerateCollectionNode*>(n);
+    auto collection = en->collection();
+
+    if (en->isRandom() ||
+        collection->accessType != TRI_TRANSACTION_READ ||
+        en->getDependencies().size() != 1 ||
+        ! HashJoinIsExecutedRepeatedly(plan, en)) {
+      // the hash table is built only once per query, so the collection 
+      // must not be modified by the query
+      continue;
+    }
+
+    // variables that are not yet available in front of the collection
+    std::unordered_set<Variable const*> innerVariables;
+    innerVariables.emplace(en->outVariable());
+
+    std::unordered_map<VariableId, CalculationNode*> calculations;
+    AstNode const* probe = nullptr;
+    std::vector<std::string> attribute;
+
+    ExecutionNode* current = en;
+    while (probe == nullptr && current->getParents().size() == 1) {
+      current = current->getParents()[0];
+      auto const type = current->getType();
+
+      if (type == EN::CALCULATION) {
+        auto cn = static_cast<CalculationNode*>(current);
+        calculations.emplace(cn->outVariable()->id, cn);
+        innerVariables.emplace(cn->outVariable());
+        continue;
+      }
+
+      if (type != EN::FILTER) {
+        break;
+      }
+
+      auto inVariable = current->getVariablesUsedHere()[0];
+      auto it = calculations.find(inVariable->id);
+      if (it == calculations.end()) {
+        continue;
+      }
+
+      auto condition = (*it).second->expression()->node();
+      if (condition->type != NODE_TYPE_OPERATOR_BINARY_EQ) {
+        continue;
+      }
+
+      for (size_t i = 0; i < 2; ++i) {
+        auto other = condition->getMember(1 - i);
+
+        if (HashJoinAttributeAccess(condition->getMember(i), attribute) != en->outVariable() ||
+            ! other->isDeterministic() ||
+            other->canThrow()) {
+          continue;
+        }
+
+        std::unordered_set<Variable const*> used;
+        Ast::getReferencedVariables(other, used);
+
+        bool valid = ! used.empty();
+        for (auto const& v : used) {
+          if (innerVariables.find(v) != innerVariables.end()) {
+            valid = false;
+            break;
+          }
+        }
+
+        if (valid) {
+          probe = other;
+          break;
+        }
+      }
+    }
+
+    if (probe == nullptr) {
+      continue;
+    }
+
+    // calculate the probe value in front of the join
+    ExecutionNode* calculationNode = nullptr;
+    auto probeVariable = plan->getAst()->variables()->createTemporaryVariable();
+    auto expression = new Expression(plan->getAst(), plan->getAst()->clone(probe));
+    try {
+      calculationNode = new CalculationNode(plan, plan->nextId(), expression, probeVariable);
+    }
+    catch (...) {
+      delete expression;
+      throw;
+    }
+    plan->registerNode(calculationNode);
+    plan->insertDependency(en, calculationNode);
+
+    auto hashJoinNode = new HashJoinNode(plan,
+                                         plan->nextId(),
+                                         en->vocbase(),
+                                         const_cast<Collection*>(collection),
+                                         probeVariable,
+                                         en->outVariable(),
+                                         attribute);
+    plan->registerNode(hashJoinNode);
+    plan->replaceNode(en, hashJoinNode);
+    modified = true;
+  }
+
+  if (modified) {
+    plan->findVarUsage();
+  }
+
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a subquery that can be decorrelated
+////////////////////////////////////////////////////////////////////////////////
+
+struct DecorrelationCandidate {
+  size_t subqueryId;
+  size_t filterId;
+  size_t calculationId;
+  AstNode const* innerKey;
+  AstNode const* outerKey;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether a subquery can be decorrelated. this is the case for
+/// subqueries of the form
+///   FOR inner IN collection 
+///     FILTER inner.attribute == outer.attribute 
+///     RETURN expression
+/// with arbitrary additional calculations and FILTERs that do not depend on
+/// outer variables
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CanDecorrelateSubquery (SubqueryNode const* sn,
+                                    DecorrelationCandidate& candidate) {
+  auto root = sn->getSubquery();
+
+  if (root->getType() != EN::RETURN) {
+    return false;
+  }
+
+  // collect the nodes of the subquery, from the RETURN upwards
+  std::vector<ExecutionNode*> nodes;
+  EnumerateCollectionNode const* en = nullptr;
+  std::unordered_set<Variable const*> innerVariables;
+
+  auto current = root;
+  while (current->getType() != EN::SINGLETON) {
+    if (current->getDependencies().size() != 1) {
+      return false;
+    }
+
+    auto const type = current->getType();
+
+    if (type == EN::ENUMERATE_COLLECTION) {
+      if (en != nullptr) {
+        // more than one collection
+        return false;
+      }
+      en = static_cast<EnumerateCollectionNode const*>(current);
+      innerVariables.emplace(en->outVariable());
+    }
+    else if (type == EN::CALCULATION) {
+      auto cn = static_cast<CalculationNode const*>(current);
+      if (! cn->expression()->isDeterministic()) {
+        return false;
+      }
+      innerVariables.emplace(cn->outVariable());
+    }
+    else if (type != EN::FILTER && type != EN::RETURN) {
+      return false;
+    }
+
+    nodes.emplace_back(current);
+    current = current->getFirstDependency();
+  }
+
+  if (en == nullptr ||
+      en->isRandom() ||
+      en->filter() != nullptr ||
+      en->collection()->accessType != TRI_TRANSACTION_READ) {
+    // the subquery is executed only once, so the collection must not be
+    // modified by the query
+    return false;
+  }
+
+  CalculationNode* correlated = nullptr;
+  ExecutionNode const* correlatedFilter = nullptr;
+
+  for (auto const& node : nodes) {
+    if (node->getType() != EN::CALCULATION) {
+      continue;
+    }
+
+    auto cn = static_cast<CalculationNode*>(node);
+    std::unordered_set<Variable const*> used;
+    Ast::getReferencedVariables(cn->expression()->node(), used);
+
+    for (auto const& v : used) {
+      if (innerVariables.find(v) == innerVariables.end()) {
+        // the calculation depends on outer variables
+        if (correlated != nullptr && correlated != cn) {
+          return false;
+        }
+        correlated = cn;
+      }
+    }
+  }
+
+  if (correlated == nullptr) {
+    // not correlated at all. such subqueries are executed only once anyway
+    return false;
+  }
+
+  // the result of the correlated calculation must only be used by a FILTER
+  for (auto const& node : nodes) {
+    for (auto const& v : node->getVariablesUsedHere()) {
+      if (v != correlated->outVariable()) {
+        continue;
+      }
+      if (node->getType() != EN::FILTER || correlatedFilter != nullptr) {
+        return false;
+      }
+      correlatedFilter = node;
+    }
+  }
+
+  if (correlatedFilter == nullptr) {
+    return false;
+  }
+
+  auto condition = correlated->expression()->node();
+
+  if (condition->type != NODE_TYPE_OPERATOR_BINARY_EQ) {
+    return false;
+  }
+
+  std::vector<std::string> attribute;
+  candidate.innerKey = nullptr;
+  candidate.outerKey = nullptr;
+
+  for (size_t i = 0; i < 2; ++i) {
+    auto inner = condition->getMember(i);
+    auto outer = condition->getMember(1 - i);
+
+    if (HashJoinAttributeAccess(inner, attribute) != en->outVariable()) {
+      continue;
+    }
+
+    if (outer->type != NODE_TYPE_REFERENCE &&
+        HashJoinAttributeAccess(outer, attribute) == nullptr) {
+      continue;
+    }
+
+    std::unordered_set<Variable const*> used;
+    Ast::getReferencedVariables(outer, used);
+
+    if (used.empty() || 
+        innerVariables.find(*(used.begin())) != innerVariables.end()) {
+      continue;
+    }
+
+    candidate.innerKey = inner;
+    candidate.outerKey = outer;
+    break;
+  }
+
+  if (candidate.innerKey == nullptr) {
+    return false;
+  }
+
+  // calculations following the correlated FILTER will be executed for all
+  // documents of the collection after the rewrite, so they must not throw
+  for (auto const& node : nodes) {
+    if (node == correlatedFilter) {
+      break;
+    }
+    if (node->getType() == EN::CALCULATION &&
+        static_cast<CalculationNode*>(node)->expression()->canThrow()) {
+      return false;
+    }
+  }
+
+  candidate.subqueryId = sn->id();
+  candidate.filterId = correlatedFilter->id();
+  candidate.calculationId = correlated->id();
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief decorrelate a subquery. the subquery is rewritten to return 
+/// [ innerKey, result ] pairs for all documents, and the correlated FILTER is
+/// removed. the key for each outer row is calculated in front of the
+/// SubqueryNode
+////////////////////////////////////////////////////////////////////////////////
+
+static void DecorrelateSubquery (ExecutionPlan* plan,
+                                 DecorrelationCandidate const& candidate) {
+  auto ast = plan->getAst();
+
+  auto sn = static_cast<SubqueryNode*>(plan->getNodeById(candidate.subqueryId));
+  auto filter = plan->getNodeById(candidate.filterId);
+  auto correlated = static_cast<CalculationNode*>(plan->getNodeById(candidate.calculationId));
+  TRI_ASSERT(sn != nullptr && filter != nullptr && correlated != nullptr);
+
+  auto oldReturn = static_cast<ReturnNode*>(sn->getSubquery());
+  auto resultVariable = oldReturn->getVariablesUsedHere()[0];
+
+  // calculate the inner key instead of the filter condition
+  auto innerKeyVariable = ast->variables()->createTemporaryVariable();
+  ExecutionNode* calculationNode = nullptr;
+  auto expression = new Expression(ast, ast->clone(candidate.innerKey));
+  try {
+    calculationNode = new CalculationNode(plan, plan->nextId(), expression, innerKeyVariable);
+  }
+  catch (...) {
+    delete expression;
+    throw;
+  }
+  plan->registerNode(calculationNode);
+  plan->replaceNode(correlated, calculationNode);
+  plan->unlinkNode(filter);
+
+  // return [ innerKey, result ] pairs
+  auto pairVariable = ast->variables()->createTemporaryVariable();
+  auto pair = ast->createNodeArray();
+  pair->addMember(ast->createNodeReference(innerKeyVariable));
+  pair->addMember(ast->createNodeReference(resultVariable));
+
+  expression = new Expression(ast, pair);
+  try {
+    calculationNode = new CalculationNode(plan, plan->nextId(), expression, pairVariable);
+  }
+  catch (...) {
+    delete expression;
+    throw;
+  }
+  plan->registerNode(calculationNode);
+
+  auto newReturn = new ReturnNode(plan, plan->nextId(), pairVariable);
+  plan->registerNode(newReturn);
+  plan->replaceNode(oldReturn, newReturn);
+  plan->insertDependency(newReturn, calculationNode);
+
+  // calculate the outer key in front of the subquery
+  auto outerKeyVariable = ast->variables()->createTemporaryVariable();
+  expression = new Expression(ast, ast->clone(candidate.outerKey));
+  try {
+    calculationNode = new CalculationNode(plan, plan->nextId(), expression, outerKeyVariable);
+  }
+  catch (...) {
+    delete expression;
+    throw;
+  }
+  plan->registerNode(calculationNode);
+  plan->insertDependency(sn, calculationNode);
+
+  sn->decorrelate(newReturn, outerKeyVariable);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute simple correlated subqueries only once and group their 
+/// results by the correlation key
+///
+/// a subquery such as
+///   FOR inner IN collection FILTER inner.attribute == outer.attribute RETURN inner
+/// is executed for each outer row. this rule creates an additional plan in 
+/// which the subquery is executed only once for all documents of the 
+/// collection. its results are grouped by `inner.attribute`, and each outer 
+/// row looks up its group via `outer.attribute`. this is a hash join with 
+/// aggregation into an array, and will be cheaper than the original plan if 
+/// the subquery is executed for many outer rows and there is no index for 
+/// the lookup. the original plan is kept so the cheaper one can be picked
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::decorrelateSubqueriesRule (Optimizer* opt,
+                                              ExecutionPlan* plan,
+                                              Optimizer::Rule const* rule) {
+  if (triagens::arango::ServerState::instance()->isCoordinator()) {
+    // decorrelation is not yet supported in the cluster
+    opt->addPlan(plan, rule, false);
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::SUBQUERY, true);
+  std::vector<DecorrelationCandidate> candidates;
+
+  for (auto const& n : nodes) {
+    auto sn = static_cast<SubqueryNode const*>(n);
+
+    if (sn->isDecorrelated()) {
+      continue;
+    }
+
+    DecorrelationCandidate candidate;
+    if (CanDecorrelateSubquery(sn, candidate)) {
+      candidates.emplace_back(candidate);
+    }
+  }
+
+  if (! candidates.empty()) {
+    std::unique_ptr<ExecutionPlan> newPlan(plan->clone());
+
+    for (auto const& candidate : candidates) {
+      DecorrelateSubquery(newPlan.get(), candidate);
+    }
+
+    newPlan->findVarUsage();
+    opt->addPlan(newPlan.release(), rule, true);
+  }
+
+  // keep the original plan, too
+  opt->addPlan(plan, rule, false);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of collections in a join for which the join order
+/// is determined by dynamic programming. larger joins are ordered greedily
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MaxJoinSizeForDynamicProgramming = 10;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reduction factor for an equality lookup that cannot be estimated
+/// via an index selectivity estimate. this is the same heuristic that is 
+/// used by IndexRangeNode::estimateCost
+////////////////////////////////////////////////////////////////////////////////
+
+static double const JoinEqualityReductionFactor = 100.0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief an equality predicate on an attribute of one of the collections
+/// of a join. the predicate can be used as soon as the collection <other> 
+/// has been bound in an outer loop. <other> is -1 if the predicate compares
+/// with a value that does not depend on the join at all
+////////////////////////////////////////////////////////////////////////////////
+
+struct JoinPredicate {
+  JoinPredicate (std::string const& attribute,
+                 int other) 
+    : attribute(attribute),
+      other(other) {
+  }
+
+  std::string const  attribute;
+  int const          other;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a collection participating in a join
+////////////////////////////////////////////////////////////////////////////////
+
+struct JoinMember {
+  JoinMember (EnumerateCollectionNode* node)
+    : node(node),
+      count((std::max)(static_cast<double>(node->collection()->count()), 1.0)),
+      predicates() {
+  }
+
+  EnumerateCollectionNode* const  node;
+  double const                    count;
+  std::vector<JoinPredicate>      predicates;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate of adding a collection to a partial join order
+////////////////////////////////////////////////////////////////////////////////
+
+struct JoinStepEstimate {
+  double  accessCost;    // cost of producing the documents for one outer row
+  double  nrItems;       // number of documents remaining per outer row
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extract the attribute name of an attribute access on a variable,
+/// e.g. "a.b" for the expression "doc.a.b". returns the variable or nullptr
+/// if the expression is not a pure attribute access
+////////////////////////////////////////////////////////////////////////////////
+
+static Variable const* JoinAttributeAccess (AstNode const* node,
+                                            std::string& attribute) {
+  if (node->type != NODE_TYPE_ATTRIBUTE_ACCESS) {
+    return nullptr;
+  }
+
+  std::vector<std::string> parts;
+
+  while (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    parts.emplace_back(std::string(node->getStringValue(), node->getStringLength()));
+    node = node->getMember(0);
+  }
+
+  if (node->type != NODE_TYPE_REFERENCE) {
+    return nullptr;
+  }
+
+  attribute.clear();
+  for (size_t i = parts.size(); i-- > 0; ) {
+    attribute.append(parts[i]);
+    if (i > 0) {
+      attribute.push_back('.');
+    }
+  }
+
+  return static_cast<Variable const*>(node->getData());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the join member that produces the variable, -1 if none
+////////////////////////////////////////////////////////////////////////////////
+
+static int JoinMemberForVariable (std::vector<JoinMember> const& members,
+                                  Variable const* variable) {
+  for (size_t i = 0; i < members.size(); ++i) {
+    if (members[i].node->outVariable() == variable) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine which join member(s) an expression depends on. returns
+/// -1 if it does not depend on any join member, -2 if it depends on more
+/// than one, and the index of the member otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+static int JoinDependency (std::vector<JoinMember> const& members,
+                           AstNode const* node) {
+  std::unordered_set<Variable const*> vars;
+  Ast::getReferencedVariables(node, vars);
+
+  int result = -1;
+  for (auto const& v : vars) {
+    int member = JoinMemberForVariable(members, v);
+    if (member >= 0) {
+      if (result >= 0 && result != member) {
+        return -2;
+      }
+      result = member;
+    }
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register an equality predicate "lhs == rhs" if lhs is an attribute
+/// of a join member
+////////////////////////////////////////////////////////////////////////////////
+
+static void AddJoinPredicate (std::vector<JoinMember>& members,
+                              AstNode const* lhs,
+                              AstNode const* rhs) {
+  std::string attribute;
+  auto variable = JoinAttributeAccess(lhs, attribute);
+
+  if (variable == nullptr) {
+    return;
+  }
+
+  int const member = JoinMemberForVariable(members, variable);
+
+  if (member < 0) {
+    return;
+  }
+
+  int const other = JoinDependency(members, rhs);
+
+  if (other == -2 || other == member) {
+    // depends on multiple collections or is not a lookup value at all
+    return;
+  }
+
+  members[member].predicates.emplace_back(attribute, other);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collect the equality predicates of a (sub-)condition
+////////////////////////////////////////////////////////////////////////////////
+
+static void CollectJoinPredicates (std::vector<JoinMember>& members,
+                                   AstNode const* node) {
+  if (node->type == NODE_TYPE_OPERATOR_BINARY_AND) {
+    CollectJoinPredicates(members, node->getMember(0));
+    CollectJoinPredicates(members, node->getMember(1));
+    return;
+  }
+
+  if (node->type == NODE_TYPE_OPERATOR_BINARY_EQ) {
+    auto lhs = node->getMember(0);
+    auto rhs = node->getMember(1);
+    AddJoinPredicate(members, lhs, rhs);
+    AddJoinPredicate(members, rhs, lhs);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the number of documents a lookup in the index returns
+/// for a single lookup value. returns a negative value if the index cannot
+/// be used with the attributes given
+////////////////////////////////////////////////////////////////////////////////
+
+static double EstimateIndexLookup (Index const* idx,
+                                   size_t prefix,
+                                   double count) {
+  if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_PRIMARY_INDEX) {
+    return 1.0;
+  }
+
+  if (idx->unique && 
+      (idx->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX ||
+       prefix == idx->fields.size())) {
+    return 1.0;
+  }
+
+  if (idx->hasSelectivityEstimate() &&
+      (idx->type != triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX || 
+       prefix == idx->fields.size())) {
+    double const estimate = idx->selectivityEstimate();
+
+    if (estimate > 0.0) {
+      return (std::max)(1.0 / estimate, 1.0);
+    }
+  }
+
+  size_t parts = 1;
+  if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX) {
+    parts = idx->fields.size();
+  }
+  else if (idx->type == triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+    parts = prefix;
+  }
+
+  double estimate = count;
+  for (size_t i = 0; i < parts; ++i) {
+    estimate /= JoinEqualityReductionFactor;
+  }
+  return (std::max)(estimate, 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the cost of adding a collection to a join when the 
+/// collections in <bound> (bitmask) are already enumerated in outer loops
+////////////////////////////////////////////////////////////////////////////////
+
+static JoinStepEstimate EstimateJoinStep (std::vector<JoinMember> const& members,
+                                          size_t member,
+                                          uint64_t bound) {
+  auto const& m = members[member];
+
+  std::unordered_set<std::string> attributes;
+  for (auto const& p : m.predicates) {
+    if (p.other < 0 || (bound & (static_cast<uint64_t>(1) << p.other)) != 0) {
+      attributes.emplace(p.attribute);
+    }
+  }
+
+  JoinStepEstimate result;
+  // full collection scan
+  result.accessCost = m.count;
+  result.nrItems = m.count;
+
+  if (attributes.empty()) {
+    return result;
+  }
+
+  std::vector<Index*> indexes;
+  std::vector<size_t> prefixes;
+  m.node->getIndexesForIndexRangeNode(attributes, indexes, prefixes);
+
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    double const estimate = EstimateIndexLookup(indexes[i], prefixes[i], m.count);
+
+    if (estimate < result.accessCost) {
+      result.accessCost = estimate;
+    }
+  }
+
+  // each usable equality predicate restricts the result further, regardless
+  // of whether it is satisfied by an index or by a filter
+  double nrItems = m.count;
+  for (size_t i = 0; i < attributes.size(); ++i) {
+    nrItems /= JoinEqualityReductionFactor;
+  }
+  result.nrItems = (std::max)((std::min)(nrItems, result.accessCost), 1.0);
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimate the total cost of a join order
+////////////////////////////////////////////////////////////////////////////////
+
+static double EstimateJoinOrder (std::vector<JoinMember> const& members,
+                                 std::vector<size_t> const& order) {
+  double cost = 0.0;
+  double nrItems = 1.0;
+  uint64_t bound = 0;
+
+  for (auto const& member : order) {
+    auto step = EstimateJoinStep(members, member, bound);
+    cost += nrItems * step.accessCost;
+    nrItems *= step.nrItems;
+    bound |= (static_cast<uint64_t>(1) << member);
+  }
+
+  return cost;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine the cheapest join order via dynamic programming over
+/// all subsets of collections (left-deep nested loops only)
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<size_t> OptimalJoinOrder (std::vector<JoinMember> const& members) {
+  size_t const n = members.size();
+  size_t const subsets = static_cast<size_t>(1) << n;
+
+  std::vector<double> cost(subsets, 0.0);
+  std::vector<double> nrItems(subsets, 1.0);
+  std::vector<int> last(subsets, -1);
+
+  for (size_t set = 0; set < subsets; ++set) {
+    if (set != 0 && last[set] < 0) {
+      // not reachable
+      continue;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      size_t const bit = static_cast<size_t>(1) << i;
+
+      if ((set & bit) != 0) {
+        continue;
+      }
+
+      auto step = EstimateJoinStep(members, i, set);
+      double const total = cost[set] + nrItems[set] * step.accessCost;
+
+      if (last[set | bit] < 0 || total < cost[set | bit]) {
+        cost[set | bit] = total;
+        nrItems[set | bit] = nrItems[set] * step.nrItems;
+        last[set | bit] = static_cast<int>(i);
+      }
+    }
+  }
+
+  std::vector<size_t> order;
+  size_t set = subsets - 1;
+  while (set != 0) {
+    TRI_ASSERT(last[set] >= 0);
+    order.emplace_back(static_cast<size_t>(last[set]));
+    set &= ~(static_cast<size_t>(1) << last[set]);
+  }
+
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine a cheap join order greedily, by always picking the
+/// collection that is cheapest to add next
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<size_t> GreedyJoinOrder (std::vector<JoinMember> const& members) {
+  size_t const n = members.size();
+  std::vector<size_t> order;
+  uint64_t bound = 0;
+
+  while (order.size() < n) {
+    size_t best = n;
+    JoinStepEstimate bestStep = { 0.0, 0.0 };
+
+    for (size_t i = 0; i < n; ++i) {
+      if ((bound & (static_cast<uint64_t>(1) << i)) != 0) {
+        continue;
+      }
+
+      auto step = EstimateJoinStep(members, i, bound);
+
+      if (best == n ||
+          step.accessCost < bestStep.accessCost ||
+          (step.accessCost == bestStep.accessCost && step.nrItems < bestStep.nrItems)) {
+        best = i;
+        bestStep = step;
+      }
+    }
+
+    order.emplace_back(best);
+    bound |= (static_cast<uint64_t>(1) << best);
+  }
+
+  return order;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether a node can be part of a join that is reordered
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CanBeReorderedInJoin (ExecutionNode const* node) {
+  auto const type = node->getType();
+
+  if (type == EN::ENUMERATE_COLLECTION ||
+      type == EN::FILTER) {
+    return true;
+  }
+
+  if (type == EN::CALCULATION) {
+    auto calculation = static_cast<CalculationNode const*>(node);
+    return (! calculation->expression()->canThrow() && calculation->expression()->isDeterministic());
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reorder a join consisting of the nodes in <chain>, ordered from
+/// the outermost to the innermost node. returns whether the join was changed
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ReorderJoin (ExecutionPlan* plan,
+                         std::vector<ExecutionNode*> const& chain) {
+  std::vector<JoinMember> members;
+  std::vector<ExecutionNode*> others;
+
+  for (auto const& n : chain) {
+    if (n->getType() == EN::ENUMERATE_COLLECTION) {
+      members.emplace_back(static_cast<EnumerateCollectionNode*>(n));
+    }
+    else {
+      others.emplace_back(n);
+    }
+  }
+
+  if (members.size() < 2 || members.size() > 64) {
+    return false;
+  }
+
+  // collect the join conditions from the filters in the chain
+  for (auto const& n : others) {
+    if (n->getType() != EN::FILTER) {
+      continue;
+    }
+
+    auto variable = n->getVariablesUsedHere()[0];
+    auto setter = plan->getVarSetBy(variable->id);
+
+    if (setter == nullptr || setter->getType() != EN::CALCULATION) {
+      continue;
+    }
+
+    auto expression = static_cast<CalculationNode const*>(setter)->expression();
+    CollectJoinPredicates(members, expression->node());
+  }
+
+  std::vector<size_t> current;
+  for (size_t i = 0; i < members.size(); ++i) {
+    current.emplace_back(i);
+  }
+
+  std::vector<size_t> order;
+  if (members.size() <= MaxJoinSizeForDynamicProgramming) {
+    order = OptimalJoinOrder(members);
+  }
+  else {
+    order = GreedyJoinOrder(members);
+  }
+
+  if (order == current ||
+      EstimateJoinOrder(members, order) >= EstimateJoinOrder(members, current) * 0.99) {
+    // no significant improvement
+    return false;
+  }
+
+  // build the new chain. calculations and filters are placed as early as
+  // their input variables allow
+  std::unordered_set<Variable const*> available;
+  std::vector<ExecutionNode*> newChain;
+  std::vector<bool> placed(others.size(), false);
+
+  std::unordered_set<Variable const*> setInChain;
+  for (auto const& n : chain) {
+    for (auto const& v : n->getVariablesSetHere()) {
+      setInChain.emplace(v);
+    }
+  }
+
+  auto placeReadyNodes = [&] () -> void {
+    bool found = true;
+    while (found) {
+      found = false;
+      for (size_t i = 0; i < others.size(); ++i) {
+        if (placed[i]) {
+          continue;
+        }
+
+        bool ready = true;
+        for (auto const& v : others[i]->getVariablesUsedHere()) {
+          if (setInChain.find(v) != setInChain.end() &&
+              available.find(v) == available.end()) {
+            ready = false;
+            break;
+          }
+        }
+
+        if (ready) {
+          newChain.emplace_back(others[i]);
+          for (auto const& v : others[i]->getVariablesSetHere()) {
+            available.emplace(v);
+          }
+          placed[i] = true;
+          found = true;
+        }
+      }
+    }
+  };
+
+  placeReadyNodes();
+  for (auto const& member : order) {
+    auto node = members[member].node;
+    newChain.emplace_back(node);
+    available.emplace(node->outVariable());
+    placeReadyNodes();
+  }
+
+  if (newChain.size() != chain.size()) {
+    // should not happen, but better leave the plan alone
+    return false;
+  }
+
+  auto const& parents = chain.back()->getParents();
+  TRI_ASSERT(parents.size() == 1);
+  auto parent = parents[0];
+
+  for (auto const& n : chain) {
+    plan->unlinkNode(n);
+  }
+
+  // each node is inserted directly below the chain's old parent, so the
+  // outermost node must be inserted first
+  for (auto const& n : newChain) {
+    plan->insertDependency(parent, n);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reorder the collections of a join based on their estimated costs
+/// this rule looks at chains of FOR loops over collections, mixed with 
+/// FILTER and CALCULATION nodes, and determines the cheapest order of the 
+/// loops using the number of documents in the collections, the equality 
+/// join conditions found in the FILTERs and the indexes that can be used for
+/// them (including their selectivity estimates). 
+/// this rule modifies the plan in place
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::reorderJoinsRule (Optimizer* opt,
+                                     ExecutionPlan* plan,
+                                     Optimizer::Rule const* rule) {
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+  std::unordered_set<ExecutionNode*> seen;
+  bool modified = false;
+
+  for (auto const& n : nodes) {
+    if (seen.find(n) != seen.end()) {
+      continue;
+    }
+
+    // find the innermost node of the chain
+    ExecutionNode* top = n;
+    while (true) {
+      auto const& parents = top->getParents();
+      if (parents.size() != 1 || ! CanBeReorderedInJoin(parents[0])) {
+        break;
+      }
+      top = parents[0];
+    }
+
+    if (top->getParents().size() != 1) {
+      seen.emplace(n);
+      continue;
+    }
+
+    // now collect the chain
+    std::vector<ExecutionNode*> chain;
+    ExecutionNode* current = top;
+    while (true) {
+      chain.emplace_back(current);
+      if (current->getType() == EN::ENUMERATE_COLLECTION) {
+        seen.emplace(current);
+      }
+
+      if (! current->hasDependency() ||
+          current->getDependencies().size() != 1 ||
+          ! CanBeReorderedInJoin(current->getFirstDependency())) {
+        break;
+      }
+      current = current->getFirstDependency();
+    }
+
+    // the chain is innermost-first now, but we want it outermost-first
+    std::reverse(chain.begin(), chain.end());
+
+    if (ReorderJoin(plan, chain)) {
+      modified = true;
+    }
+  }
+
+  if (modified) {
+    plan->findVarUsage();
+  }
+
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief helper to compute lots of permutation tuples
+/// a permutation tuple is represented as a single vector together with
+/// another vector describing the boundaries of the tuples.
+/// Example:
+/// data:   0,1,2, 3,4, 5,6
+/// starts: 0,     3,   5,      (indices of starts of sections)
+/// means a tuple of 3 permutations of 3, 2 and 2 points respectively
+/// This function computes the next permutation tuple among the 
+/// lexicographically sorted list of all such tuples. It returns true
+/// if it has successfully computed this and false if the tuple is already
+/// the lexicographically largest one. If false is returned, the permutation
+/// tuple is back to the beginning.
+////////////////////////////////////////////////////////////////////////////////
+
+static bool NextPermutationTuple (std::vector<size_t>& data,
+                                  std::vector<size_t>& starts) {
+  auto begin = data.begin();  // a random access iterator
+
+  for (size_t i = starts.size(); i-- != 0; ) {
+    std::vector<size_t>::iterator from = begin + starts[i];
+    std::vector<size_t>::iterator to;
+    if (i == starts.size() - 1) {
+      to = data.end();
+    }
+    else {
+      to = begin + starts[i + 1];
+    }
+    if (std::next_permutation(from, to)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief interchange adjacent EnumerateCollectionNodes in all possible ways
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::interchangeAdjacentEnumerationsRule (Optimizer* opt,
+                                                        ExecutionPlan* plan,
+                                                        Optimizer::Rule const* rule) {
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+
+  std::unordered_set<ExecutionNode*> nodesSet;
+  for (auto const& n : nodes) {
+    TRI_ASSERT(nodesSet.find(n) == nodesSet.end());
+    nodesSet.emplace(n);
+  }
+
+  std::vector<ExecutionNode*> nodesToPermute;
+  std::vector<size_t> permTuple;
+  std::vector<size_t> starts;
+
+  // We use that the order of the nodes is such that a node B that is among the
   // recursive dependencies of a node A is later in the vector.
   for (auto const& n : nodes) {
     if (nodesSet.find(n) != nodesSet.end()) {
@@ -3894,6 +5187,7 @@ int triagens::aql::distributeFilternCalcToClusterRule (Optimizer* opt,
         case EN::SORT:
         case EN::INDEX_RANGE:
         case EN::ENUMERATE_COLLECTION:
+        case EN::HASH_JOIN:
           //do break
           stopSearching = true;
           break;
@@ -3990,6 +5284,7 @@ int triagens::aql::distributeSortToClusterRule (Optimizer* opt,
         case EN::LIMIT:
         case EN::INDEX_RANGE:
         case EN::ENUMERATE_COLLECTION:
+        case EN::HASH_JOIN:
           // For all these, we do not want to pull a SortNode further down
           // out to the DBservers, note that potential FilterNodes and
           // CalculationNodes that can be moved to the DBservers have 
@@ -4026,6 +5321,137 @@ int triagens::aql::distributeSortToClusterRule (Optimizer* opt,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute partial COLLECT results on the DB servers and merge them 
+/// on the coordinator
+/// this rule modifies the plan in place
+/// a COLLECT directly following a GatherNode is split into two phases: each 
+/// DB server groups its own rows and counts them, and the coordinator groups
+/// the partial results again and sums up the partial counts. this way only
+/// one row per group and shard is sent to the coordinator. COLLECT ... INTO
+/// is not distributed, because it needs all rows on the coordinator anyway
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::distributeCollectToClusterRule (Optimizer* opt, 
+                                                   ExecutionPlan* plan,
+                                                   Optimizer::Rule const* rule) {
+  bool modified = false;
+
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::GATHER, true);
+  
+  for (auto& n : nodes) {
+    auto const& remoteNodeList = n->getDependencies();
+    auto gatherNode = static_cast<GatherNode*>(n);
+    TRI_ASSERT(remoteNodeList.size() > 0);
+    auto rn = remoteNodeList[0];
+
+    if (! n->hasParent() || n->getParents().size() != 1) {
+      continue;
+    }
+
+    auto parent = n->getParents()[0];
+
+    if (parent->getType() != EN::AGGREGATE) {
+      continue;
+    }
+
+    auto aggregateNode = static_cast<AggregateNode*>(parent);
+
+    if (aggregateNode->hasExpressionVariable() ||
+        (aggregateNode->hasOutVariable() && ! aggregateNode->count()) ||
+        aggregateNode->countVariable() != nullptr) {
+      // COLLECT ... INTO needs all input rows, and partial results must not 
+      // be distributed again
+      continue;
+    }
+
+    // the partial group values produced on the DB servers
+    std::vector<std::pair<Variable const*, Variable const*>> partialAggregates;
+    std::vector<std::pair<Variable const*, Variable const*>> mergeAggregates;
+    std::unordered_map<Variable const*, Variable const*> replacements;
+
+    for (auto const& p : aggregateNode->aggregateVariables()) {
+      auto partial = plan->getAst()->variables()->createTemporaryVariable();
+      partialAggregates.emplace_back(std::make_pair(partial, p.second));
+      mergeAggregates.emplace_back(std::make_pair(p.first, partial));
+      replacements.emplace(p.second, partial);
+    }
+
+    // the GatherNode must merge the partial results by their group values
+    SortElementVector elements;
+    bool valid = true;
+
+    for (auto const& it : gatherNode->getElements()) {
+      auto it2 = replacements.find(it.first);
+
+      if (it2 == replacements.end()) {
+        valid = false;
+        break;
+      }
+      elements.emplace_back(std::make_pair((*it2).second, it.second));
+    }
+
+    if (! valid) {
+      continue;
+    }
+
+    Variable const* partialCount = nullptr;
+    if (aggregateNode->count()) {
+      partialCount = plan->getAst()->variables()->createTemporaryVariable();
+    }
+
+    // compute the partial results on the DB servers
+    auto partialNode = new AggregateNode(plan,
+                                         plan->nextId(),
+                                         aggregateNode->getOptions(),
+                                         partialAggregates,
+                                         nullptr,
+                                         partialCount,
+                                         std::vector<Variable const*>(),
+                                         aggregateNode->variableMap(),
+                                         aggregateNode->count(),
+                                         aggregateNode->isDistinctCommand());
+    partialNode->aggregationMethod(aggregateNode->aggregationMethod());
+    if (aggregateNode->isSpecialized()) {
+      partialNode->specialized();
+    }
+    plan->registerNode(partialNode);
+    plan->insertDependency(rn, partialNode);
+
+    // and merge them on the coordinator
+    auto mergeNode = new AggregateNode(plan,
+                                       plan->nextId(),
+                                       aggregateNode->getOptions(),
+                                       mergeAggregates,
+                                       nullptr,
+                                       aggregateNode->outVariable(),
+                                       std::vector<Variable const*>(),
+                                       aggregateNode->variableMap(),
+                                       aggregateNode->count(),
+                                       aggregateNode->isDistinctCommand());
+    mergeNode->aggregationMethod(aggregateNode->aggregationMethod());
+    if (aggregateNode->isSpecialized()) {
+      mergeNode->specialized();
+    }
+    if (partialCount != nullptr) {
+      mergeNode->setCountVariable(partialCount);
+    }
+    plan->registerNode(mergeNode);
+    plan->replaceNode(aggregateNode, mergeNode);
+
+    gatherNode->setElements(elements);
+    modified = true;
+  }
+  
+  if (modified) {
+    plan->findVarUsage();
+  }
+  
+  opt->addPlan(plan, rule, modified);
+  
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief try to get rid of a RemoteNode->ScatterNode combination which has
 /// only a SingletonNode and possibly some CalculationNodes as dependencies
@@ -4262,7 +5688,8 @@ class RemoveToEnumCollFinder final : public WalkerWorker<ExecutionNode> {
         case EN::ILLEGAL:
         case EN::LIMIT:           
         case EN::SORT:
-        case EN::INDEX_RANGE: {
+        case EN::INDEX_RANGE:
+        case EN::HASH_JOIN: {
           // if we meet any of the above, then we abort . . .
         }
     }
@@ -4804,6 +6231,7 @@ int triagens::aql::patchUpdateStatementsRule (Optimizer* opt,
 
       if (type == EN::ENUMERATE_LIST || 
           type == EN::INDEX_RANGE ||
+          type == EN::HASH_JOIN ||
           type == EN::SUBQUERY) {
         // not suitable
         modified = false;
@@ -4838,6 +6266,380 @@ int triagens::aql::patchUpdateStatementsRule (Optimizer* opt,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restrict a SORT that is followed by a LIMIT to the number of rows
+/// the LIMIT will consume (offset + count). the SortBlock will then keep only
+/// that many rows in a bounded heap instead of sorting its complete input.
+/// only calculations that cannot throw may be located between the SORT and 
+/// the LIMIT, and the LIMIT must not fully count its input
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::sortLimitRule (Optimizer* opt,
+                                  ExecutionPlan* plan,
+                                  Optimizer::Rule const* rule) {
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::SORT, true);
+  bool modified = false;
+
+  for (auto const& n : nodes) {
+    auto sortNode = static_cast<SortNode*>(n);
+
+    if (sortNode->limit() > 0) {
+      // already restricted
+      continue;
+    }
+
+    ExecutionNode* current = n;
+
+    while (current->getParents().size() == 1) {
+      current = current->getParents()[0];
+      auto const type = current->getType();
+
+      if (type == EN::CALCULATION && ! current->canThrow()) {
+        // calculations do not change the number of rows
+        continue;
+      }
+
+      if (type == EN::LIMIT) {
+        auto limitNode = static_cast<LimitNode const*>(current);
+
+        if (! limitNode->fullCount() &&
+            limitNode->limit() > 0 &&
+            limitNode->limit() <= SIZE_MAX - limitNode->offset()) {
+          sortNode->setLimit(limitNode->offset() + limitNode->limit());
+          modified = true;
+        }
+      }
+
+      break;
+    }
+  }
+
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not all usages of <variable> in the expression <node>
+/// are accesses to attributes other than _id. the condition is evaluated
+/// concurrently by the threads of a parallel scan, and building the _id
+/// value or the complete document requires the transaction's collection 
+/// name resolver, which must not be used by multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsParallelScanFilter (AstNode const* node,
+                                  Variable const* variable) {
+  if (node == nullptr) {
+    return true;
+  }
+
+  if (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    auto member = node->getMember(0);
+
+    if (member->type == NODE_TYPE_REFERENCE &&
+        static_cast<Variable const*>(member->getData()) == variable) {
+      return (std::string(node->getStringValue(), node->getStringLength()) != TRI_VOC_ATTRIBUTE_ID);
+    }
+  }
+  else if (node->type == NODE_TYPE_REFERENCE) {
+    // the complete document is used
+    return (static_cast<Variable const*>(node->getData()) != variable);
+  }
+
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (! IsParallelScanFilter(node->getMember(i), variable)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allow full collection scans that are executed only once per query
+/// to use multiple threads, and move FILTERs that only depend on the scanned
+/// documents into the EnumerateCollectionNode, so they can be evaluated by 
+/// the threads of the parallel collection scan
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::moveFiltersIntoEnumerateRule (Optimizer* opt,
+                                                 ExecutionPlan* plan,
+                                                 Optimizer::Rule const* rule) {
+  bool modified = false;
+
+  if (plan->getAst()->query()->scanThreads() <= 1) {
+    // filters are only moved if the scan can run in parallel
+    opt->addPlan(plan, rule, modified);
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+  std::unordered_set<ExecutionNode*> toUnlink;
+  std::vector<CalculationNode*> calculations;
+
+  for (auto const& n : nodes) {
+    auto enumerateNode = static_cast<EnumerateCollectionNode*>(n);
+    auto collection = enumerateNode->collection();
+
+    if (enumerateNode->isRandom() ||
+        collection->isEdgeCollection() ||
+        collection->accessType != TRI_TRANSACTION_READ ||
+        HashJoinIsExecutedRepeatedly(plan, enumerateNode)) {
+      // only the outermost scan of a query is parallelized. inner scans 
+      // would restart their threads for every row of the outer loop
+      continue;
+    }
+
+    if (! enumerateNode->isParallel()) {
+      enumerateNode->setParallel();
+      modified = true;
+    }
+
+    auto outVariable = enumerateNode->outVariable();
+    AstNode const* condition = nullptr;
+
+    if (enumerateNode->filter() != nullptr) {
+      condition = enumerateNode->filter()->node();
+    }
+
+    ExecutionNode* current = n;
+
+    while (current->getParents().size() == 1) {
+      current = current->getParents()[0];
+      auto const type = current->getType();
+
+      if (type == EN::CALCULATION) {
+        // calculations do not change the number of rows
+        continue;
+      }
+
+      if (type != EN::FILTER) {
+        break;
+      }
+
+      auto setter = plan->getVarSetBy(current->getVariablesUsedHere()[0]->id);
+
+      if (setter == nullptr || setter->getType() != EN::CALCULATION) {
+        break;
+      }
+
+      auto calculationNode = static_cast<CalculationNode*>(setter);
+      auto expression = calculationNode->expression();
+
+      if (expression->isV8() || ! expression->isDeterministic()) {
+        // the filter is evaluated outside the query's V8 context, and
+        // possibly by multiple threads
+        break;
+      }
+
+      std::unordered_set<Variable const*> vars;
+      expression->variables(vars);
+
+      if (vars.size() != 1 || *vars.begin() != outVariable) {
+        // filter must depend on the enumerated documents only
+        break;
+      }
+
+      if (! IsParallelScanFilter(expression->node(), outVariable)) {
+        break;
+      }
+
+      if (condition == nullptr) {
+        condition = expression->node();
+      }
+      else {
+        condition = plan->getAst()->createNodeBinaryOperator(NODE_TYPE_OPERATOR_BINARY_AND, condition, expression->node());
+      }
+
+      toUnlink.emplace(current);
+      calculations.emplace_back(calculationNode);
+    }
+
+    if (condition != nullptr && 
+        (enumerateNode->filter() == nullptr || condition != enumerateNode->filter()->node())) {
+      enumerateNode->setFilter(new Expression(plan->getAst(), condition));
+      modified = true;
+    }
+  }
+
+  if (! toUnlink.empty()) {
+    plan->unlinkNodes(toUnlink);
+    plan->findVarUsage();
+
+    // remove the calculations of the filter conditions if their results 
+    // are not used otherwise
+    toUnlink.clear();
+
+    for (auto const& calculationNode : calculations) {
+      if (! calculationNode->isVarUsedLater(calculationNode->outVariable())) {
+        toUnlink.emplace(calculationNode);
+      }
+    }
+
+    if (! toUnlink.empty()) {
+      plan->unlinkNodes(toUnlink);
+      plan->findVarUsage();
+    }
+  }
+
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether all usages of <variable> in the expression <node>
+/// are accesses to (sub-attributes of) the attributes <fields>
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsCoveredByIndex (AstNode const* node,
+                              Variable const* variable,
+                              std::vector<std::vector<std::string>> const& fields) {
+  if (node == nullptr) {
+    return true;
+  }
+
+  if (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    std::vector<std::string> attribute;
+
+    if (HashJoinAttributeAccess(node, attribute) == variable) {
+      for (auto const& field : fields) {
+        if (field.size() <= attribute.size() &&
+            std::equal(field.begin(), field.end(), attribute.begin())) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+  else if (node->type == NODE_TYPE_REFERENCE) {
+    // the variable itself is used, e.g. RETURN doc
+    return (static_cast<Variable const*>(node->getData()) != variable);
+  }
+
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (! IsCoveredByIndex(node->getMember(i), variable, fields)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make hash and skiplist index scans covering if the query only uses
+/// indexed attributes of the found documents. the IndexRangeBlock will then
+/// produce objects with the indexed attributes only, built from the values 
+/// stored in the index elements, and the documents are not accessed for
+/// values that are stored in the index elements completely
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useCoveringIndexRule (Optimizer* opt,
+                                         ExecutionPlan* plan,
+                                         Optimizer::Rule const* rule) {
+  std::vector<ExecutionNode*>&& nodes = plan->findNodesOfType(EN::INDEX_RANGE, true);
+  bool modified = false;
+
+  for (auto const& n : nodes) {
+    auto indexRangeNode = static_cast<IndexRangeNode*>(n);
+
+    if (indexRangeNode->isCovering() ||
+        indexRangeNode->combination() != IndexRangeNode::INDEX_COMBINATION_NONE) {
+      continue;
+    }
+
+    auto index = indexRangeNode->getIndex();
+
+    if (index->type != triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX &&
+        index->type != triagens::arango::Index::TRI_IDX_TYPE_SKIPLIST_INDEX) {
+      continue;
+    }
+
+    if (indexRangeNode->collection()->accessType != TRI_TRANSACTION_READ) {
+      // the index elements are handed out later and must not be removed by
+      // the query itself
+      continue;
+    }
+
+    std::vector<std::vector<std::string>> fields;
+    bool usable = true;
+
+    for (auto const& field : index->fields) {
+      if (field.size() != 1 || field[0].shouldExpand) {
+        // array indexes may contain multiple elements per document
+        usable = false;
+        break;
+      }
+
+      auto&& parts = triagens::basics::StringUtils::split(field[0].name, '.');
+
+      if (parts[0] == TRI_VOC_ATTRIBUTE_KEY ||
+          parts[0] == TRI_VOC_ATTRIBUTE_ID ||
+          parts[0] == TRI_VOC_ATTRIBUTE_REV ||
+          parts[0] == TRI_VOC_ATTRIBUTE_FROM ||
+          parts[0] == TRI_VOC_ATTRIBUTE_TO) {
+        // system attributes are not contained in the index elements
+        usable = false;
+        break;
+      }
+
+      for (auto const& other : fields) {
+        size_t const length = (std::min)(parts.size(), other.size());
+
+        if (std::equal(parts.begin(), parts.begin() + length, other.begin())) {
+          // an indexed attribute is a sub-attribute of another one
+          usable = false;
+          break;
+        }
+      }
+
+      fields.emplace_back(std::move(parts));
+    }
+
+    auto outVariable = indexRangeNode->outVariable();
+    ExecutionNode* current = n;
+
+    while (usable && ! current->getParents().empty()) {
+      if (current->getParents().size() != 1) {
+        usable = false;
+        break;
+      }
+
+      current = current->getParents()[0];
+
+      if (current->getType() == EN::CALCULATION) {
+        auto expression = static_cast<CalculationNode const*>(current)->expression();
+
+        if (! IsCoveredByIndex(expression->node(), outVariable, fields)) {
+          usable = false;
+        }
+      }
+      else {
+        // all other nodes must not use the documents at all
+        std::unordered_set<Variable const*> vars;
+        current->getVariablesUsedHere(vars);
+
+        if (vars.find(outVariable) != vars.end()) {
+          usable = false;
+        }
+      }
+    }
+
+    if (usable) {
+      indexRangeNode->setCovering(true);
+      modified = true;
+    }
+  }
+
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 // Local Variables:
 // mode: outline-minor
 // outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
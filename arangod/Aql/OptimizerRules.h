@@ -159,6 +159,25 @@ namespace triagens {
 
     int removeFiltersCoveredByIndexRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace equi-joins that cannot use an index with hash joins
+////////////////////////////////////////////////////////////////////////////////
+
+    int useHashJoinRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute simple correlated subqueries only once and group their 
+/// results by the correlation key
+////////////////////////////////////////////////////////////////////////////////
+
+    int decorrelateSubqueriesRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reorder the collections of a join based on their estimated costs
+////////////////////////////////////////////////////////////////////////////////
+
+    int reorderJoinsRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief interchange adjacent EnumerateCollectionNodes in all possible ways
 ////////////////////////////////////////////////////////////////////////////////
@@ -188,6 +207,13 @@ namespace triagens {
 
     int distributeSortToClusterRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compute partial COLLECT results on the DB servers and merge them 
+/// on the coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+    int distributeCollectToClusterRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief try to get rid of a RemoteNode->ScatterNode combination which has
 /// only a SingletonNode and possibly some CalculationNodes as dependencies
@@ -251,6 +277,29 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
     int patchUpdateStatementsRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restrict a SORT that is followed by a LIMIT to the number of rows
+/// the LIMIT will consume
+////////////////////////////////////////////////////////////////////////////////
+
+    int sortLimitRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allow full collection scans that are executed only once per query
+/// to use multiple threads, and move FILTERs that only depend on the scanned
+/// documents into the EnumerateCollectionNode, so they can be evaluated by 
+/// the threads of the parallel collection scan
+////////////////////////////////////////////////////////////////////////////////
+
+    int moveFiltersIntoEnumerateRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make hash and skiplist index scans covering if the query only uses
+/// indexed attributes of the found documents
+////////////////////////////////////////////////////////////////////////////////
+
+    int useCoveringIndexRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
     
   }  // namespace aql
 }  // namespace triagens
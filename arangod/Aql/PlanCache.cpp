@@ -0,0 +1,502 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, execution plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/PlanCache.h"
+#include "Basics/fasthash.h"
+#include "Basics/json.h"
+#include "Basics/Exceptions.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/WriteLocker.h"
+#include "VocBase/vocbase.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief singleton instance of the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::aql::PlanCache Instance;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             struct PlanCacheEntry
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a plan cache entry
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheEntry::PlanCacheEntry (uint64_t hash,
+                                std::string const& queryString,
+                                std::string const& key,
+                                TRI_json_t* plan,
+                                std::vector<std::string> const& collections,
+                                bool isModificationQuery,
+                                bool isCacheable)
+  : _hash(hash),
+    _queryString(queryString),
+    _key(key),
+    _plan(plan),
+    _collections(collections),
+    _isModificationQuery(isModificationQuery),
+    _isCacheable(isCacheable),
+    _prev(nullptr),
+    _next(nullptr) {
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a plan cache entry
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheEntry::~PlanCacheEntry () {
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _plan);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                     struct PlanCacheDatabaseEntry
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheDatabaseEntry::PlanCacheDatabaseEntry () 
+  : _entriesByHash(),
+    _head(nullptr),
+    _tail(nullptr) {
+  
+  _entriesByHash.reserve(128);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheDatabaseEntry::~PlanCacheDatabaseEntry () {  
+  for (auto& it : _entriesByHash) {
+    delete it.second;
+  }
+
+  _entriesByHash.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCacheEntry const* PlanCacheDatabaseEntry::lookup (uint64_t hash,
+                                                      char const* queryString,
+                                                      size_t queryStringLength,
+                                                      std::string const& key) const {
+  auto it = _entriesByHash.find(hash);
+
+  if (it == _entriesByHash.end()) {
+    // not found in cache
+    return nullptr;
+  }
+
+  // found some plan in cache. now compare query string and key, as the
+  // hash values may collide
+  auto entry = (*it).second;
+
+  if (entry->_queryString.size() != queryStringLength ||
+      memcmp(entry->_queryString.c_str(), queryString, queryStringLength) != 0 ||
+      entry->_key != key) {
+    // different query or different bind parameter names / options
+    return nullptr;
+  }
+
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::store (PlanCacheEntry* entry,
+                                    size_t maxPlans) {
+  auto it = _entriesByHash.find(entry->_hash);
+
+  if (it != _entriesByHash.end()) {
+    // an entry with the same hash is already present. replace it
+    remove((*it).second);
+  }
+
+  _entriesByHash.emplace(entry->_hash, entry);
+  link(entry);
+
+  enforceMaxPlans(maxPlans);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans that use the collection
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::invalidate (char const* collection) {
+  auto entry = _head;
+
+  while (entry != nullptr) {
+    auto next = entry->_next;
+
+    for (auto const& it : entry->_collections) {
+      if (strcmp(it.c_str(), collection) == 0) {
+        remove(entry);
+        break;
+      }
+    }
+
+    entry = next;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief enforce maximum number of plans
+/// the oldest plans will be evicted first
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::enforceMaxPlans (size_t value) {
+  while (_entriesByHash.size() > value) {
+    TRI_ASSERT(_head != nullptr);
+    remove(_head);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove a plan entry from the cache and delete it
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::remove (PlanCacheEntry* e) {
+  _entriesByHash.erase(e->_hash);
+  unlink(e);
+  delete e;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unlink the plan entry from the list
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::unlink (PlanCacheEntry* e) {
+  if (e->_prev != nullptr) {
+    e->_prev->_next = e->_next;
+  }
+  if (e->_next != nullptr) {
+    e->_next->_prev = e->_prev;
+  }
+
+  if (_head == e) {
+    _head = e->_next;
+  }
+  if (_tail == e) {
+    _tail = e->_prev;
+  }
+
+  e->_prev = nullptr;
+  e->_next = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief link the plan entry to the end of the list
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCacheDatabaseEntry::link (PlanCacheEntry* e) {
+  if (_head == nullptr) {
+    _head = e;
+  }
+
+  if (_tail != nullptr) {
+    _tail->_next = e;
+    e->_prev = _tail;
+  }
+
+  _tail = e;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class PlanCache
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache::PlanCache () 
+  : _maxPlans(128),
+    _entriesLock(),
+    _entries() {
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache::~PlanCache () {
+  invalidate();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+size_t PlanCache::maxPlans () const {
+  return _maxPlans.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of plans per database
+/// a value of 0 turns off the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::setMaxPlans (size_t value) {
+  _maxPlans.store(value, std::memory_order_relaxed);
+
+  for (unsigned int i = 0; i < NumberOfParts; ++i) {
+    WRITE_LOCKER(_entriesLock[i]);
+
+    for (auto& it : _entries[i]) {
+      it.second->enforceMaxPlans(value);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the cache
+/// if a plan is found, a copy of its JSON representation is returned and
+/// the caller is responsible for freeing it. returns a nullptr if no plan
+/// was found
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* PlanCache::lookup (TRI_vocbase_t* vocbase,
+                               char const* queryString,
+                               size_t queryStringLength,
+                               std::string const& key,
+                               bool& isModificationQuery,
+                               bool& isCacheable) {
+  if (! isActive()) {
+    return nullptr;
+  }
+
+  uint64_t const h = hash(queryString, queryStringLength, key);
+  auto const part = getPart(vocbase);
+  READ_LOCKER(_entriesLock[part]);
+
+  auto it = _entries[part].find(vocbase);
+
+  if (it == _entries[part].end()) {
+    // no entry found for the requested database
+    return nullptr;
+  } 
+
+  auto entry = (*it).second->lookup(h, queryString, queryStringLength, key);
+
+  if (entry == nullptr) {
+    return nullptr;
+  }
+
+  // copy the plan while still holding the lock
+  TRI_json_t* plan = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, entry->_plan);
+
+  if (plan == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  isModificationQuery = entry->_isModificationQuery;
+  isCacheable = entry->_isCacheable;
+
+  return plan;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the cache
+/// the cache will take over ownership of the plan JSON in any case
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::store (TRI_vocbase_t* vocbase,
+                       char const* queryString,
+                       size_t queryStringLength,
+                       std::string const& key,
+                       TRI_json_t* plan,
+                       std::vector<std::string> const& collections,
+                       bool isModificationQuery,
+                       bool isCacheable) {
+  TRI_ASSERT(plan != nullptr);
+
+  std::unique_ptr<PlanCacheEntry> entry;
+
+  try {
+    entry.reset(new PlanCacheEntry(hash(queryString, queryStringLength, key), 
+                                   std::string(queryString, queryStringLength),
+                                   key,
+                                   plan,
+                                   collections,
+                                   isModificationQuery,
+                                   isCacheable));
+  }
+  catch (...) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, plan);
+    throw;
+  }
+
+  auto const part = getPart(vocbase);
+
+  WRITE_LOCKER(_entriesLock[part]);
+
+  size_t const max = maxPlans();
+
+  if (max == 0) {
+    // cache was turned off in the meantime
+    return;
+  }
+
+  auto it = _entries[part].find(vocbase);
+
+  if (it == _entries[part].end()) { 
+    // create entry for the current database
+    std::unique_ptr<PlanCacheDatabaseEntry> db(new PlanCacheDatabaseEntry());
+    it = _entries[part].emplace(vocbase, db.get()).first;
+    db.release();
+  }
+
+  (*it).second->store(entry.get(), max);
+  entry.release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular collection
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (TRI_vocbase_t* vocbase,
+                            char const* collection) {
+  auto const part = getPart(vocbase);
+  WRITE_LOCKER(_entriesLock[part]);
+
+  auto it = _entries[part].find(vocbase);
+
+  if (it == _entries[part].end()) { 
+    return;
+  } 
+
+  (*it).second->invalidate(collection);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular database
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate (TRI_vocbase_t* vocbase) {
+  PlanCacheDatabaseEntry* databasePlanCache = nullptr;
+
+  {
+    auto const part = getPart(vocbase);
+    WRITE_LOCKER(_entriesLock[part]);
+
+    auto it = _entries[part].find(vocbase);
+
+    if (it == _entries[part].end()) { 
+      return;
+    } 
+
+    databasePlanCache = (*it).second;
+    _entries[part].erase(it);
+  }
+
+  // delete without holding the lock
+  TRI_ASSERT(databasePlanCache != nullptr);
+  delete databasePlanCache;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans
+////////////////////////////////////////////////////////////////////////////////
+
+void PlanCache::invalidate () {
+  for (unsigned int i = 0; i < NumberOfParts; ++i) {
+    WRITE_LOCKER(_entriesLock[i]);
+
+    for (auto& it : _entries[i]) {
+      delete it.second;
+    }
+
+    _entries[i].clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the plan cache instance
+////////////////////////////////////////////////////////////////////////////////
+
+PlanCache* PlanCache::instance () {
+  return &Instance;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes a query string and the plan key
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PlanCache::hash (char const* queryString,
+                          size_t queryStringLength,
+                          std::string const& key) const {
+  TRI_ASSERT(queryString != nullptr);
+
+  uint64_t h = fasthash64(queryString, queryStringLength, 0x3123456789abcdef);
+  return fasthash64(key.c_str(), key.size(), h);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine which lock to use for the cache entries
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned int PlanCache::getPart (TRI_vocbase_t const* vocbase) const {
+  return static_cast<int>(fasthash64(vocbase, sizeof(decltype(vocbase)), 0xf12345678abcdef) % NumberOfParts);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,348 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, execution plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_PLAN_CACHE_H
+#define ARANGODB_AQL_PLAN_CACHE_H 1
+
+#include "Basics/Common.h"
+#include "Basics/ReadWriteLock.h"
+
+struct TRI_json_t;
+struct TRI_vocbase_t;
+
+namespace triagens {
+  namespace aql {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              struct PlanCacheEntry
+// -----------------------------------------------------------------------------
+
+    struct PlanCacheEntry {
+      PlanCacheEntry (PlanCacheEntry const&) = delete;
+      PlanCacheEntry& operator= (PlanCacheEntry const&) = delete;
+      PlanCacheEntry () = delete;
+
+      PlanCacheEntry (uint64_t,
+                      std::string const&,
+                      std::string const&,
+                      struct TRI_json_t*,
+                      std::vector<std::string> const&,
+                      bool,
+                      bool);
+
+      ~PlanCacheEntry ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  member variables
+// -----------------------------------------------------------------------------
+
+      uint64_t const                  _hash;
+      std::string const               _queryString;
+      std::string const               _key;
+      struct TRI_json_t*              _plan;
+      std::vector<std::string> const  _collections;
+      bool const                      _isModificationQuery;
+      bool const                      _isCacheable;
+      PlanCacheEntry*                 _prev;
+      PlanCacheEntry*                 _next;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                     struct PlanCacheDatabaseEntry
+// -----------------------------------------------------------------------------
+
+    struct PlanCacheDatabaseEntry {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      PlanCacheDatabaseEntry (PlanCacheDatabaseEntry const&) = delete;
+      PlanCacheDatabaseEntry& operator= (PlanCacheDatabaseEntry const&) = delete;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+     
+      PlanCacheDatabaseEntry ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a database-specific plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+      ~PlanCacheDatabaseEntry ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+      PlanCacheEntry const* lookup (uint64_t, 
+                                    char const*,
+                                    size_t,
+                                    std::string const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the database-specific cache
+////////////////////////////////////////////////////////////////////////////////
+
+      void store (PlanCacheEntry*,
+                  size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans that use the collection
+////////////////////////////////////////////////////////////////////////////////
+
+      void invalidate (char const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief enforce maximum number of plans
+////////////////////////////////////////////////////////////////////////////////
+
+      void enforceMaxPlans (size_t);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove a plan entry from the cache and delete it
+////////////////////////////////////////////////////////////////////////////////
+
+      void remove (PlanCacheEntry*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unlink the plan entry from the list
+////////////////////////////////////////////////////////////////////////////////
+  
+      void unlink (PlanCacheEntry*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief link the plan entry to the end of the list
+////////////////////////////////////////////////////////////////////////////////
+  
+      void link (PlanCacheEntry*);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash table that maps query hashes to plans
+////////////////////////////////////////////////////////////////////////////////
+
+      std::unordered_map<uint64_t, PlanCacheEntry*> _entriesByHash;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief beginning of linked list of plan entries (oldest entry)
+////////////////////////////////////////////////////////////////////////////////
+
+      PlanCacheEntry* _head;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief end of linked list of plan entries (newest entry)
+////////////////////////////////////////////////////////////////////////////////
+
+      PlanCacheEntry* _tail;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class PlanCache
+// -----------------------------------------------------------------------------
+
+    class PlanCache {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        PlanCache (PlanCache const&) = delete;
+        PlanCache& operator= (PlanCache const&) = delete;
+      
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        PlanCache ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        ~PlanCache ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t maxPlans () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of plans per database
+/// a value of 0 turns off the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        void setMaxPlans (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test whether the plan cache is active
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isActive () const {
+          return maxPlans() > 0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lookup a plan in the cache
+/// if a plan is found, a copy of its JSON representation is returned and
+/// the caller is responsible for freeing it. returns a nullptr if no plan
+/// was found
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_json_t* lookup (TRI_vocbase_t*,
+                                   char const*,
+                                   size_t,
+                                   std::string const&,
+                                   bool&,
+                                   bool&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan in the cache
+/// the cache will take over ownership of the plan JSON in any case
+////////////////////////////////////////////////////////////////////////////////
+
+        void store (TRI_vocbase_t*, 
+                    char const*,
+                    size_t,
+                    std::string const&,
+                    struct TRI_json_t*,
+                    std::vector<std::string> const&,
+                    bool,
+                    bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (TRI_vocbase_t*,
+                         char const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans for a particular database
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (TRI_vocbase_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidate all plans
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the pointer to the global plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        static PlanCache* instance ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes a query string and the plan key
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t hash (char const*,
+                       size_t,
+                       std::string const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine which part of the cache to use for the cache entries
+////////////////////////////////////////////////////////////////////////////////
+
+        unsigned int getPart (TRI_vocbase_t const*) const;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of R/W locks for the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t const NumberOfParts = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<size_t> _maxPlans;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-write lock for the cache
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ReadWriteLock _entriesLock[NumberOfParts];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached plans, organized per database
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<TRI_vocbase_t*, PlanCacheDatabaseEntry*> _entries[NumberOfParts];
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
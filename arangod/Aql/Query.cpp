@@ -34,12 +34,14 @@
 #include "Aql/ExecutionPlan.h"
 #include "Aql/Optimizer.h"
 #include "Aql/Parser.h"
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryList.h"
 #include "Aql/ShortStringStorage.h"
 #include "Basics/fasthash.h"
 #include "Basics/JsonHelper.h"
 #include "Basics/json.h"
+#include "Basics/MutexLocker.h"
 #include "Basics/tri-strings.h"
 #include "Basics/Exceptions.h"
 #include "Cluster/ServerState.h"
@@ -189,6 +191,7 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _queryString(queryString),
     _queryLength(queryLength),
     _queryJson(),
+    _resourceMonitor(),
     _bindParameters(bindParameters),
     _options(options),
     _collections(vocbase),
@@ -203,14 +206,18 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _engine(nullptr),
     _maxWarningCount(10),
     _warnings(),
+    _warningsLock(),
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
     _killed(false),
-    _isModificationQuery(false) {
+    _isModificationQuery(false),
+    _isCacheable(false) {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR: " << queryString << "\n";
 
   TRI_ASSERT(_vocbase != nullptr);
+  
+  _resourceMonitor.setMemoryLimit(memoryLimit());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -231,6 +238,7 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _queryString(nullptr),
     _queryLength(0),
     _queryJson(queryStruct),
+    _resourceMonitor(),
     _bindParameters(nullptr),
     _options(options),
     _collections(vocbase),
@@ -245,14 +253,18 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _engine(nullptr),
     _maxWarningCount(10),
     _warnings(),
+    _warningsLock(),
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
     _killed(false),
-    _isModificationQuery(false) {
+    _isModificationQuery(false),
+    _isCacheable(false) {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR (JSON): " << _queryJson.toString() << "\n";
 
   TRI_ASSERT(_vocbase != nullptr);
+  
+  _resourceMonitor.setMemoryLimit(memoryLimit());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -480,6 +492,8 @@ void Query::registerWarning (int code,
 
   TRI_ASSERT(code != TRI_ERROR_NO_ERROR);
 
+  MUTEX_LOCKER(_warningsLock);
+
   if (_warnings.size() > _maxWarningCount) {
     return;
   }
@@ -506,21 +520,51 @@ QueryResult Query::prepare (QueryRegistry* registry) {
 
     std::unique_ptr<Parser> parser(new Parser(this));
     std::unique_ptr<ExecutionPlan> plan;
+
+    // look up the plan in the plan cache first. cached plans are optimized
+    // before the values of bind parameters are injected, so they can be
+    // reused for other bind parameter values
+    bool const usePlanCache = canUsePlanCache();
+    std::string planKey;
+    triagens::basics::Json cachedPlan;
+
+    if (usePlanCache) {
+      planKey = planCacheKey();
+      TRI_json_t* json = PlanCache::instance()->lookup(_vocbase, _queryString, _queryLength, planKey, _isModificationQuery, _isCacheable);
+
+      if (json != nullptr) {
+        cachedPlan = triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, json);
+
+        if (! matchesStructuralBindParameters(cachedPlan)) {
+          // the plan was built for other collections, LIMIT values etc.
+          cachedPlan = triagens::basics::Json();
+        }
+      }
+    }
+
+    bool const fromAst = (_queryString != nullptr && cachedPlan.isEmpty());
+    std::unordered_set<std::string> symbolic;
     
-    if (_queryString != nullptr) {
+    if (fromAst) {
       parser->parse(false);
+
+      if (usePlanCache) {
+        // keep the bind parameters that are only used in expressions out of
+        // the plan for now
+        symbolic = parser->ast()->symbolicBindParameters();
+      }
+
       // put in bind parameters
-      parser->ast()->injectBindParameters(_bindParameters);
+      parser->ast()->injectBindParameters(_bindParameters, &symbolic);
+      _isModificationQuery = parser->isModificationQuery();
     }
-      
-    _isModificationQuery = parser->isModificationQuery();
 
     // create the transaction object, but do not start it yet
     _trx = new triagens::arango::AqlTransaction(createTransactionContext(), _vocbase, _collections.collections(), _part == PART_MAIN);
 
     bool planRegisters;
 
-    if (_queryString != nullptr) {
+    if (fromAst) {
       // we have an AST
       int res = _trx->begin();
 
@@ -532,6 +576,7 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       enterState(AST_OPTIMIZATION);
 
       parser->ast()->validateAndOptimize();
+      _isCacheable = parser->ast()->root()->isCacheable();
       // std::cout << "AST: " << triagens::basics::JsonHelper::toString(parser->ast()->toJson(TRI_UNKNOWN_MEM_ZONE, false)) << "\n";
 
       enterState(PLAN_INSTANTIATION);
@@ -550,12 +595,26 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       // Now plan and all derived plans belong to the optimizer
       plan.reset(opt.stealBest()); // Now we own the best one again
       planRegisters = true;
+
+      if (usePlanCache) {
+        // the optimized plan still contains the symbolic bind parameters.
+        // serialize it with its registers and continue with the serialized
+        // plan, in the same way as with a plan from the cache
+        cachedPlan = serializePlan(plan.get(), parser->ast(), symbolic);
+        plan.reset();
+
+        if (_warnings.empty()) {
+          storePlan(cachedPlan, planKey);
+        }
+      }
     }
-    else {   // no queryString, we are instantiating from _queryJson
+    else {   // no queryString or a cached plan, we are instantiating from JSON
+      triagens::basics::Json const& planJson = (cachedPlan.isEmpty() ? _queryJson : cachedPlan);
+
       enterState(PLAN_INSTANTIATION);
-      ExecutionPlan::getCollectionsFromJson(parser->ast(), _queryJson);
+      ExecutionPlan::getCollectionsFromJson(parser->ast(), planJson);
 
-      parser->ast()->variables()->fromJson(_queryJson);
+      parser->ast()->variables()->fromJson(planJson);
       // creating the plan may have produced some collections
       // we need to add them to the transaction now (otherwise the query will fail)
 
@@ -569,14 +628,33 @@ QueryResult Query::prepare (QueryRegistry* registry) {
         return transactionError(res);
       }
 
-      // we have an execution plan in JSON format
-      plan.reset(ExecutionPlan::instantiateFromJson(parser->ast(), _queryJson));
+      if (cachedPlan.isEmpty()) {
+        // we have an execution plan in JSON format
+        plan.reset(ExecutionPlan::instantiateFromJson(parser->ast(), _queryJson));
+        if (plan.get() == nullptr) {
+          // oops
+          return QueryResult(TRI_ERROR_INTERNAL);
+        }
+
+        // std::cout << "GOT PLAN:\n" << plan.get()->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true).toString() << "\n\n";
+      }
+      planRegisters = false;
+    }
+
+    if (! cachedPlan.isEmpty()) {
+      // we have an optimized plan with symbolic bind parameters. put in the
+      // values of the bind parameters and fold constants again, but do not
+      // run the optimizer. the registers were planned before serialization
+      enterState(PLAN_INSTANTIATION);
+      ExecutionPlan::injectBindParameters(parser->ast(), cachedPlan.json(), _bindParameters);
+
+      plan.reset(ExecutionPlan::instantiateFromJson(parser->ast(), cachedPlan));
       if (plan.get() == nullptr) {
         // oops
         return QueryResult(TRI_ERROR_INTERNAL);
       }
 
-      // std::cout << "GOT PLAN:\n" << plan.get()->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true).toString() << "\n\n";
+      plan->optimizeExpressions();
       planRegisters = false;
     }
 
@@ -663,7 +741,7 @@ QueryResult Query::execute (QueryRegistry* registry) {
       return res;
     }
 
-    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _ast->root()->isCacheable())) {
+    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _isCacheable)) {
       useQueryCache = false;
     }
 
@@ -734,7 +812,7 @@ QueryResult Query::execute (QueryRegistry* registry) {
       throw;
     }
 
-    stats = _engine->_stats.toJson();
+    stats = getStats();
 
     _trx->commit();
     
@@ -771,6 +849,61 @@ QueryResult Query::execute (QueryRegistry* registry) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish an AQL query whose results were fetched from the engine by
+/// the caller
+////////////////////////////////////////////////////////////////////////////////
+
+QueryResult Query::finish () {
+  TRI_ASSERT(_engine != nullptr);
+  TRI_ASSERT(_trx != nullptr);
+
+  try {
+    triagens::basics::Json stats = getStats();
+
+    _trx->commit();
+    
+    cleanupPlanAndEngine(TRI_ERROR_NO_ERROR);
+
+    enterState(FINALIZATION); 
+
+    QueryResult result(TRI_ERROR_NO_ERROR);
+    result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
+    result.stats    = stats.steal(); 
+
+    if (_profile != nullptr && profiling()) {
+      result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
+    }
+
+    return result;
+  }
+  catch (triagens::basics::Exception const& ex) {
+    cleanupPlanAndEngine(ex.code());
+    return QueryResult(ex.code(), ex.message() + getStateString());
+  }
+  catch (std::bad_alloc const&) {
+    cleanupPlanAndEngine(TRI_ERROR_OUT_OF_MEMORY);
+    return QueryResult(TRI_ERROR_OUT_OF_MEMORY, TRI_errno_string(TRI_ERROR_OUT_OF_MEMORY) + getStateString());
+  }
+  catch (std::exception const& ex) {
+    cleanupPlanAndEngine(TRI_ERROR_INTERNAL);
+    return QueryResult(TRI_ERROR_INTERNAL, ex.what() + getStateString());
+  }
+  catch (...) {
+    cleanupPlanAndEngine(TRI_ERROR_INTERNAL);
+    return QueryResult(TRI_ERROR_INTERNAL, TRI_errno_string(TRI_ERROR_INTERNAL) + getStateString());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief abort an AQL query whose results were fetched from the engine by
+/// the caller
+////////////////////////////////////////////////////////////////////////////////
+
+void Query::abort () {
+  cleanupPlanAndEngine(TRI_ERROR_TRANSACTION_ABORTED);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -805,7 +938,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate,
       return res;
     }
 
-    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _ast->root()->isCacheable())) {
+    if (useQueryCache && (_isModificationQuery || ! _warnings.empty() || ! _isCacheable)) {
       useQueryCache = false;
     }
 
@@ -880,7 +1013,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate,
       throw;
     }
 
-    stats = _engine->_stats.toJson();
+    stats = getStats();
 
     _trx->commit();
     
@@ -1186,6 +1319,11 @@ void Query::exitContext () {
 
 triagens::basics::Json Query::getStats() {
   if (_engine) {
+    // remote parts of the query may already have reported a higher peak
+    size_t const peak = _resourceMonitor.usage().peakMemoryUsage;
+    if (static_cast<int64_t>(peak) > _engine->_stats.peakMemoryUsage) {
+      _engine->_stats.peakMemoryUsage = static_cast<int64_t>(peak);
+    }
     return _engine->_stats.toJson();
   }
   return ExecutionStats::toJsonStatic();
@@ -1321,6 +1459,153 @@ bool Query::canUseQueryCache () const {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan cache can be used for the query
+////////////////////////////////////////////////////////////////////////////////
+
+bool Query::canUsePlanCache () const {
+  if (_queryString == nullptr || _part != PART_MAIN) {
+    return false;
+  }
+
+  if (! PlanCache::instance()->isActive() || ! getBooleanOption("planCache", true)) {
+    return false;
+  }
+
+  // plans in the cluster are distributed over several servers and cannot
+  // be cached at the moment
+  return ! triagens::arango::ServerState::instance()->isRunningInCluster();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the plan cache key for the query from the bind parameter
+/// names and options. the query string itself is not part of the key
+/// bind parameter values are not part of the key either: cached plans are
+/// stored before the values are injected. the values of the few parameters
+/// that shape the plan are stored with the plan and checked on lookup
+////////////////////////////////////////////////////////////////////////////////
+
+std::string Query::planCacheKey () const {
+  std::string key;
+
+  TRI_json_t const* bindParameters = _bindParameters.json();
+
+  if (TRI_IsObjectJson(bindParameters)) {
+    std::vector<std::string> names;
+    size_t const n = TRI_LengthVector(&bindParameters->_value._objects);
+
+    for (size_t i = 0; i < n; i += 2) {
+      auto name = static_cast<TRI_json_t const*>(TRI_AddressVector(&bindParameters->_value._objects, i));
+
+      if (TRI_IsStringJson(name)) {
+        names.emplace_back(name->_value._string.data, name->_value._string.length - 1);
+      }
+    }
+
+    std::sort(names.begin(), names.end());
+
+    for (auto const& name : names) {
+      key.append(name);
+      key.push_back(',');
+    }
+  }
+
+  key.push_back('|');
+
+  if (_options != nullptr) {
+    key.append(triagens::basics::JsonHelper::toString(_options));
+  }
+
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief serialize an optimized plan with symbolic bind parameters, including
+/// its registers. the values of all other bind parameters were used to build
+/// the plan and are stored with it
+////////////////////////////////////////////////////////////////////////////////
+
+triagens::basics::Json Query::serializePlan (ExecutionPlan* plan,
+                                             Ast* ast,
+                                             std::unordered_set<std::string> const& symbolic) {
+  if (! plan->varUsageComputed()) {
+    plan->findVarUsage();
+  }
+  plan->planRegisters();
+
+  triagens::basics::Json json(plan->toJson(ast, TRI_UNKNOWN_MEM_ZONE, true));
+  triagens::basics::Json structural(triagens::basics::Json::Object);
+
+  for (auto const& it : _bindParameters()) {
+    if (symbolic.find(it.first) == symbolic.end()) {
+      TRI_json_t* value = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, it.second.first);
+
+      if (value == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+
+      structural.set(it.first.c_str(), value);
+    }
+  }
+
+  json("structuralBindParameters", structural);
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a serialized plan in the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+void Query::storePlan (triagens::basics::Json const& plan,
+                       std::string const& key) {
+  try {
+    TRI_json_t* json = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, plan.json());
+
+    if (json == nullptr) {
+      return;
+    }
+
+    PlanCache::instance()->store(_vocbase, _queryString, _queryLength, key, json, _collections.collectionNames(), _isModificationQuery, _isCacheable);
+  }
+  catch (...) {
+    // if the plan cannot be stored, the query can still go on
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a cached plan was built for the current values of
+/// the structural bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+bool Query::matchesStructuralBindParameters (triagens::basics::Json const& plan) const {
+  TRI_json_t const* structural = TRI_LookupObjectJson(plan.json(), "structuralBindParameters");
+
+  if (! TRI_IsObjectJson(structural)) {
+    return false;
+  }
+
+  TRI_json_t const* bindParameters = _bindParameters.json();
+  size_t const n = TRI_LengthVector(&structural->_value._objects);
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto name = static_cast<TRI_json_t const*>(TRI_AddressVector(&structural->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AddressVector(&structural->_value._objects, i + 1));
+
+    if (! TRI_IsStringJson(name) || ! TRI_IsObjectJson(bindParameters)) {
+      return false;
+    }
+
+    TRI_json_t const* current = TRI_LookupObjectJson(bindParameters, name->_value._string.data);
+
+    if (current == nullptr || ! TRI_CheckSameValueJson(value, current)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief fetch a numeric value from the options
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,9 +32,11 @@
 
 #include "Basics/Common.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/Mutex.h"
 #include "Aql/BindParameters.h"
 #include "Aql/Collections.h"
 #include "Aql/QueryResultV8.h"
+#include "Aql/ResourceUsage.h"
 #include "Aql/ShortStringStorage.h"
 #include "Aql/types.h"
 #include "Utils/AqlTransaction.h"
@@ -186,6 +188,15 @@ namespace triagens {
           return _part;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query modifies data. this is only known after
+/// the query was prepared
+////////////////////////////////////////////////////////////////////////////////
+
+        inline bool isModificationQuery () const {
+          return _isModificationQuery;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the vocbase
 ////////////////////////////////////////////////////////////////////////////////
@@ -202,6 +213,18 @@ namespace triagens {
           return &_collections;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the query's resource monitor
+////////////////////////////////////////////////////////////////////////////////
+
+        inline ResourceMonitor* resourceMonitor () {
+          return &_resourceMonitor;
+        }
+
+        inline ResourceMonitor const* resourceMonitor () const {
+          return &_resourceMonitor;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the names of collections used in the query
 ////////////////////////////////////////////////////////////////////////////////
@@ -296,6 +319,44 @@ namespace triagens {
           return -1;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory usage (in bytes) of a SORT or COLLECT operation above which
+/// it writes its intermediate data to temporary files. 0 means never
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t spillThreshold () const { 
+          double value = getNumericOption("spillThreshold", 0.0);
+          if (value > 0) {
+            return static_cast<size_t>(value);
+          }
+          return 0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of threads to use for full collection scans. 0 and 1 mean
+/// that collections are scanned by the query's own thread only
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t scanThreads () const { 
+          double value = getNumericOption("scanThreads", 0.0);
+          if (value > 1) {
+            return (std::min)(static_cast<size_t>(value), static_cast<size_t>(64));
+          }
+          return 0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum memory usage (in bytes) of the query. 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t memoryLimit () const { 
+          double value = getNumericOption("memoryLimit", 0.0);
+          if (value > 0) {
+            return static_cast<size_t>(value);
+          }
+          return 0;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief extract a region from the query
 ////////////////////////////////////////////////////////////////////////////////
@@ -341,6 +402,21 @@ namespace triagens {
 
         QueryResult execute (QueryRegistry*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish an AQL query whose results were fetched from the engine by
+/// the caller, as done by streaming cursors. this commits the transaction,
+/// destroys the engine and returns the query's statistics and warnings
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryResult finish ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief abort an AQL query whose results were fetched from the engine by
+/// the caller. this destroys the engine and aborts the transaction
+////////////////////////////////////////////////////////////////////////////////
+
+        void abort ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -507,6 +583,41 @@ namespace triagens {
 
         bool canUseQueryCache () const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan cache can be used for the query
+////////////////////////////////////////////////////////////////////////////////
+
+        bool canUsePlanCache () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the plan cache key for the query from the bind parameter
+/// names and options. the query string itself is not part of the key
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string planCacheKey () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief serialize an optimized plan with symbolic bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Json serializePlan (ExecutionPlan*,
+                                              Ast*,
+                                              std::unordered_set<std::string> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a serialized plan in the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        void storePlan (triagens::basics::Json const&,
+                        std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a cached plan was built for the current values of
+/// the structural bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+        bool matchesStructuralBindParameters (triagens::basics::Json const&) const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief fetch a numeric value from the options
 ////////////////////////////////////////////////////////////////////////////////
@@ -616,6 +727,12 @@ namespace triagens {
 
         triagens::basics::Json const      _queryJson;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory tracking for the query
+////////////////////////////////////////////////////////////////////////////////
+
+        ResourceMonitor                   _resourceMonitor;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief bind parameters for the query
 ////////////////////////////////////////////////////////////////////////////////
@@ -703,6 +820,13 @@ namespace triagens {
 
         std::vector<std::pair<int, std::string>> _warnings;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief protects _warnings, which may be written by the worker threads of
+/// parallel collection scans
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Mutex           _warningsLock;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the query part
 ////////////////////////////////////////////////////////////////////////////////
@@ -727,6 +851,13 @@ namespace triagens {
 
         bool                              _isModificationQuery;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query result may be stored in the query cache
+/// this is determined from the AST when the query is prepared
+////////////////////////////////////////////////////////////////////////////////
+
+        bool                              _isCacheable;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not query tracking is disabled globally
 ////////////////////////////////////////////////////////////////////////////////
@@ -54,11 +54,15 @@ QueryEntry::QueryEntry (triagens::aql::Query const* query,
 QueryEntryCopy::QueryEntryCopy (TRI_voc_tick_t id,
                                 std::string const& queryString,
                                 double started,
-                                double runTime) 
+                                double runTime,
+                                size_t memoryUsage,
+                                size_t peakMemoryUsage) 
   : id(id),
     queryString(queryString),
     started(started),
-    runTime(runTime) {
+    runTime(runTime),
+    memoryUsage(memoryUsage),
+    peakMemoryUsage(peakMemoryUsage) {
 
 }
 
@@ -213,11 +217,15 @@ void QueryList::remove (Query const* query,
             THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
           } 
 
+          auto const usage = entry->query->resourceMonitor()->usage();
+
           _slow.emplace_back(QueryEntryCopy(
             entry->query->id(), 
             std::string(queryString, length).append(originalLength > maxLength ? "..." : ""), 
             entry->started, 
-            now - entry->started
+            now - entry->started,
+            usage.memoryUsage,
+            usage.peakMemoryUsage
           ));
 
           if (++_slowCount > _maxSlowQueries) {
@@ -312,11 +320,15 @@ std::vector<QueryEntryCopy> QueryList::listCurrent () {
         }
       }
 
+      auto const usage = entry->query->resourceMonitor()->usage();
+
       result.emplace_back(QueryEntryCopy(
         entry->query->id(), 
         std::string(queryString, length).append(originalLength > maxLength ? "..." : ""), 
         entry->started, 
-        now - entry->started
+        now - entry->started,
+        usage.memoryUsage,
+        usage.peakMemoryUsage
       ));
 
        
@@ -61,12 +61,16 @@ namespace triagens {
       QueryEntryCopy (TRI_voc_tick_t,
                       std::string const&,
                       double,
-                      double);
+                      double,
+                      size_t,
+                      size_t);
 
       TRI_voc_tick_t  id;
       std::string     queryString;
       double          started;
       double          runTime;
+      size_t          memoryUsage;
+      size_t          peakMemoryUsage;
     };
 
 // -----------------------------------------------------------------------------
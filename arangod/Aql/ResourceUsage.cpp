@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, per-query resource usage tracking
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/ResourceUsage.h"
+#include "Basics/Exceptions.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             class ResourceMonitor
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a monitor
+////////////////////////////////////////////////////////////////////////////////
+
+ResourceMonitor::ResourceMonitor (size_t maxMemoryUsage) 
+  : _memoryUsage(0),
+    _peakMemoryUsage(0),
+    _maxMemoryUsage(maxMemoryUsage) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the monitor
+////////////////////////////////////////////////////////////////////////////////
+
+ResourceMonitor::~ResourceMonitor () {
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief charge memory
+////////////////////////////////////////////////////////////////////////////////
+
+void ResourceMonitor::increaseMemoryUsage (size_t value) {
+  size_t const now = _memoryUsage.fetch_add(value, std::memory_order_relaxed) + value;
+
+  if (_maxMemoryUsage > 0 && now > _maxMemoryUsage) {
+    _memoryUsage.fetch_sub(value, std::memory_order_relaxed);
+
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_QUERY_RESOURCE_LIMIT);
+  }
+
+  size_t peak = _peakMemoryUsage.load(std::memory_order_relaxed);
+
+  while (now > peak) {
+    if (_peakMemoryUsage.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release previously charged memory
+////////////////////////////////////////////////////////////////////////////////
+
+void ResourceMonitor::decreaseMemoryUsage (size_t value) {
+  TRI_ASSERT(_memoryUsage.load(std::memory_order_relaxed) >= value);
+
+  _memoryUsage.fetch_sub(value, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the current and the peak memory usage
+////////////////////////////////////////////////////////////////////////////////
+
+ResourceUsage ResourceMonitor::usage () const {
+  ResourceUsage result;
+  result.memoryUsage     = _memoryUsage.load(std::memory_order_relaxed);
+  result.peakMemoryUsage = _peakMemoryUsage.load(std::memory_order_relaxed);
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
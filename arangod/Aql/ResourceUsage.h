@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, per-query resource usage tracking
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_RESOURCE_USAGE_H
+#define ARANGODB_AQL_RESOURCE_USAGE_H 1
+
+#include "Basics/Common.h"
+
+namespace triagens {
+  namespace aql {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                               struct ResourceUsage
+// -----------------------------------------------------------------------------
+
+    struct ResourceUsage {
+      ResourceUsage () 
+        : memoryUsage(0),
+          peakMemoryUsage(0) {
+      }
+
+      size_t memoryUsage;
+      size_t peakMemoryUsage;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             class ResourceMonitor
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tracks the memory used by a query. all memory that is charged by 
+/// the query's execution blocks is accounted for here. the counters may be
+/// read concurrently, e.g. when listing the currently running queries
+////////////////////////////////////////////////////////////////////////////////
+
+    class ResourceMonitor {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        ResourceMonitor (ResourceMonitor const&) = delete;
+        ResourceMonitor& operator= (ResourceMonitor const&) = delete;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a monitor. a limit of 0 means the memory usage is tracked
+/// but not limited
+////////////////////////////////////////////////////////////////////////////////
+
+        explicit ResourceMonitor (size_t = 0);
+
+        ~ResourceMonitor ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the memory limit
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void setMemoryLimit (size_t value) {
+          _maxMemoryUsage = value;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the memory limit
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t memoryLimit () const {
+          return _maxMemoryUsage;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief charge memory. throws TRI_ERROR_QUERY_RESOURCE_LIMIT if the 
+/// new memory usage would exceed the limit. nothing is charged in this case
+////////////////////////////////////////////////////////////////////////////////
+
+        void increaseMemoryUsage (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release previously charged memory
+////////////////////////////////////////////////////////////////////////////////
+
+        void decreaseMemoryUsage (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the current and the peak memory usage
+////////////////////////////////////////////////////////////////////////////////
+
+        ResourceUsage usage () const;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief current memory usage
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<size_t> _memoryUsage;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief peak memory usage
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<size_t> _peakMemoryUsage;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum allowed memory usage, 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _maxMemoryUsage;
+
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
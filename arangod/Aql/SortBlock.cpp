@@ -27,6 +27,8 @@
 
 #include "Aql/SortBlock.h"
 #include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
+#include "Aql/SpillFile.h"
 #include "Basics/Exceptions.h"
 #include "VocBase/vocbase.h"
 
@@ -45,7 +47,13 @@ SortBlock::SortBlock (ExecutionEngine* engine,
                       SortNode const* en)
   : ExecutionBlock(engine, en),
     _sortRegisters(),
-    _stable(en->_stable) {
+    _stable(en->_stable),
+    _limit(en->_limit),
+    _spillThreshold(engine->getQuery()->spillThreshold()),
+    _runs(),
+    _mergeHeap(),
+    _mergeRemaining(0),
+    _nrRegs(0) {
   
   for (auto const& p : en->_elements) {
     auto it = en->getRegisterPlan()->varInfo.find(p.first->id);
@@ -56,6 +64,7 @@ SortBlock::SortBlock (ExecutionEngine* engine,
 }
 
 SortBlock::~SortBlock () {
+  freeRuns();
 }
 
 int SortBlock::initialize () {
@@ -67,8 +76,42 @@ int SortBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
   if (res != TRI_ERROR_NO_ERROR) {
     return res;
   }
-  // suck all blocks into _buffer
-  while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
+  freeRuns();
+
+  if (_limit > 0) {
+    // only the first _limit rows are needed
+    doTopKSorting();
+  }
+  else {
+    // suck all blocks into _buffer
+    size_t memoryUsage = 0;
+
+    while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
+      if (_spillThreshold > 0) {
+        memoryUsage += _buffer.back()->memoryUsage();
+
+        if (memoryUsage > _spillThreshold) {
+          // write a sorted run to disk and continue with an empty buffer
+          spillRun();
+          memoryUsage = 0;
+        }
+      }
+    }
+
+    if (! _runs.empty()) {
+      if (! _buffer.empty()) {
+        spillRun();
+      }
+      startMerge();
+
+      _done = (_mergeRemaining == 0);
+      _pos = 0;
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    if (! _buffer.empty()) {
+      doSorting();
+    }
   }
 
   if (_buffer.empty()) {
@@ -76,14 +119,194 @@ int SortBlock::initializeCursor (AqlItemBlock* items, size_t pos) {
     return TRI_ERROR_NO_ERROR;
   }
 
-  doSorting();
-
   _done = false;
   _pos = 0;
 
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not there are more rows to return
+////////////////////////////////////////////////////////////////////////////////
+
+bool SortBlock::hasMore () {
+  if (! _runs.empty()) {
+    return (! _done && _mergeRemaining > 0);
+  }
+  return ExecutionBlock::hasMore();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows left
+////////////////////////////////////////////////////////////////////////////////
+
+int64_t SortBlock::remaining () {
+  if (! _runs.empty()) {
+    return static_cast<int64_t>(_mergeRemaining);
+  }
+  return ExecutionBlock::remaining();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns or skips rows. if the input was spilled to disk, the rows
+/// are produced by merging the sorted runs, otherwise they are taken from 
+/// the sorted buffer
+////////////////////////////////////////////////////////////////////////////////
+
+int SortBlock::getOrSkipSome (size_t atLeast,
+                              size_t atMost,
+                              bool skipping,
+                              AqlItemBlock*& result,
+                              size_t& skipped) {
+  if (_runs.empty()) {
+    return ExecutionBlock::getOrSkipSome(atLeast, atMost, skipping, result, skipped);
+  }
+
+  TRI_ASSERT(result == nullptr && skipped == 0);
+
+  if (_done) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  size_t const toSend = (std::min)(atMost, _mergeRemaining);
+  std::unique_ptr<AqlItemBlock> res;
+
+  if (! skipping) {
+    res.reset(requestBlock(toSend, _nrRegs));
+  }
+
+  auto heapCompare = [this] (size_t a, size_t b) {
+    // std heaps are max-heaps, but we want the smallest row at the front
+    return runLessThan(b, a);
+  };
+
+  for (size_t i = 0; i < toSend; ++i) {
+    TRI_ASSERT(! _mergeHeap.empty());
+    std::pop_heap(_mergeHeap.begin(), _mergeHeap.end(), heapCompare);
+
+    auto run = _runs[_mergeHeap.back()];
+    if (! skipping) {
+      run->readRow(res.get(), i);
+    }
+    run->nextRow();
+
+    if (run->hasRow()) {
+      std::push_heap(_mergeHeap.begin(), _mergeHeap.end(), heapCompare);
+    }
+    else {
+      _mergeHeap.pop_back();
+    }
+  }
+
+  skipped = toSend;
+  _mergeRemaining -= toSend;
+
+  if (_mergeRemaining == 0) {
+    _done = true;
+  }
+
+  result = res.release();
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sorts the buffered rows and writes them to a new run file. the 
+/// buffer is empty afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+void SortBlock::spillRun () {
+  TRI_ASSERT(! _buffer.empty());
+
+  doSorting();
+
+  _nrRegs = _buffer.front()->getNrRegs();
+
+  std::unique_ptr<SpillFile> run(new SpillFile(_trx));
+
+  for (auto const& block : _buffer) {
+    size_t const n = block->size();
+    for (size_t i = 0; i < n; ++i) {
+      run->addRow(block, i);
+    }
+  }
+  
+  _runs.emplace_back(run.get());
+  run.release();
+
+  for (auto& block : _buffer) {
+    delete block;
+  }
+  _buffer.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares merging the run files
+////////////////////////////////////////////////////////////////////////////////
+
+void SortBlock::startMerge () {
+  _mergeHeap.clear();
+  _mergeRemaining = 0;
+
+  for (size_t i = 0; i < _runs.size(); ++i) {
+    _runs[i]->finish();
+    _mergeRemaining += _runs[i]->numRows();
+
+    if (_runs[i]->hasRow()) {
+      _mergeHeap.emplace_back(i);
+    }
+  }
+
+  std::make_heap(_mergeHeap.begin(), _mergeHeap.end(), [this] (size_t a, size_t b) {
+    return runLessThan(b, a);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the current row of run <a> sorts before the current row of
+/// run <b>. rows that compare equal are ordered by their run, which keeps the
+/// sort stable as the runs were created in input order
+////////////////////////////////////////////////////////////////////////////////
+
+bool SortBlock::runLessThan (size_t a, 
+                             size_t b) const {
+  auto lhs = _runs[a];
+  auto rhs = _runs[b];
+
+  for (auto const& reg : _sortRegisters) {
+    int cmp;
+
+    if (lhs->isEmpty(reg.first) || rhs->isEmpty(reg.first)) {
+      cmp = (lhs->isEmpty(reg.first) ? 0 : 1) - (rhs->isEmpty(reg.first) ? 0 : 1);
+    }
+    else {
+      cmp = CompactValue::Compare(lhs->value(reg.first), rhs->value(reg.first), true);
+    }
+
+    if (cmp < 0) {
+      return reg.second;
+    } 
+    else if (cmp > 0) {
+      return ! reg.second;
+    }
+  }
+
+  return (a < b);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all run files
+////////////////////////////////////////////////////////////////////////////////
+
+void SortBlock::freeRuns () {
+  for (auto& run : _runs) {
+    delete run;
+  }
+  _runs.clear();
+  _mergeHeap.clear();
+  _mergeRemaining = 0;
+}
+
 void SortBlock::doSorting () {
   // coords[i][j] is the <j>th row of the <i>th block
   std::vector<std::pair<size_t, size_t>> coords;
@@ -108,10 +331,7 @@ void SortBlock::doSorting () {
     count++;
   }
 
-  std::vector<TRI_document_collection_t const*> colls;
-  for (RegisterId i = 0; i < _sortRegisters.size(); i++) {
-    colls.emplace_back(_buffer.front()->getDocumentCollection(_sortRegisters[i].first));
-  }
+  std::vector<TRI_document_collection_t const*> colls = sortCollections();
 
   // comparison function
   OurLessThan ourLessThan(_trx, _buffer, _sortRegisters, colls);
@@ -124,20 +344,131 @@ void SortBlock::doSorting () {
     std::sort(coords.begin(), coords.end(), ourLessThan);
   }
 
+  rearrangeBuffer(coords);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetches all input and keeps only the first _limit rows in sort
+/// order. the best rows seen so far are kept in a max-heap, so the worst of
+/// them can be replaced in O(log _limit). blocks only referenced by rows 
+/// that have been dropped from the heap are released by compacting the 
+/// buffer from time to time, so memory usage stays in O(_limit)
+////////////////////////////////////////////////////////////////////////////////
+
+void SortBlock::doTopKSorting () {
+  std::vector<std::pair<size_t, size_t>> heap;
+  std::vector<TRI_document_collection_t const*> colls;
+
+  OurLessThan ourLessThan(_trx, _buffer, _sortRegisters, colls);
+  
+  // the input position of a row. as the buffer is always compacted in 
+  // input order, this is also the order in which the rows were produced
+  auto inputOrder = [] (std::pair<size_t, size_t> const& a,
+                        std::pair<size_t, size_t> const& b) {
+    return (a.first < b.first || (a.first == b.first && a.second < b.second));
+  };
+
+  // for a stable sort, equal rows are ordered by their input position. this
+  // makes sure the rows seen first survive in the heap
+  bool const stable = _stable;
+  auto heapOrder = [&ourLessThan, &inputOrder, stable] (std::pair<size_t, size_t> const& a,
+                                                        std::pair<size_t, size_t> const& b) {
+    if (ourLessThan(a, b)) {
+      return true;
+    }
+    return (stable && ! ourLessThan(b, a) && inputOrder(a, b));
+  };
+
+  // rows that are not part of the heap anymore, but are still buffered 
+  size_t garbage = 0;
+  size_t const maxGarbage = (std::max)(_limit, DefaultBatchSize);
+
+  while (getBlock(DefaultBatchSize, DefaultBatchSize)) {
+    if (colls.empty()) {
+      colls = sortCollections();
+    }
+
+    size_t const blockNr = _buffer.size() - 1;
+    size_t const n = _buffer.back()->size();
+
+    for (size_t i = 0; i < n; ++i) {
+      auto const coord = std::make_pair(blockNr, i);
+
+      if (heap.size() < _limit) {
+        heap.emplace_back(coord);
+        std::push_heap(heap.begin(), heap.end(), heapOrder);
+      }
+      else {
+        if (heapOrder(coord, heap.front())) {
+          // the new row is better than the worst row in the heap
+          std::pop_heap(heap.begin(), heap.end(), heapOrder);
+          heap.back() = coord;
+          std::push_heap(heap.begin(), heap.end(), heapOrder);
+        }
+        ++garbage;
+      }
+    }
+
+    if (garbage >= maxGarbage) {
+      // compact the buffer so it only contains the rows of the heap
+      std::sort(heap.begin(), heap.end(), inputOrder);
+      rearrangeBuffer(heap);
+
+      for (size_t i = 0; i < heap.size(); ++i) {
+        heap[i] = std::make_pair(i / DefaultBatchSize, i % DefaultBatchSize);
+      }
+      std::make_heap(heap.begin(), heap.end(), heapOrder);
+      garbage = 0;
+    }
+  }
+
+  if (heap.empty()) {
+    return;
+  }
+
+  TRI_IF_FAILURE("SortBlock::doSorting") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), heapOrder);
+
+  rearrangeBuffer(heap);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the collections of the sort registers
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<TRI_document_collection_t const*> SortBlock::sortCollections () const {
+  std::vector<TRI_document_collection_t const*> colls;
+  for (RegisterId i = 0; i < _sortRegisters.size(); i++) {
+    colls.emplace_back(_buffer.front()->getDocumentCollection(_sortRegisters[i].first));
+  }
+  return colls;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replaces _buffer with new blocks that contain the rows at the
+/// given coordinates, in the given order
+////////////////////////////////////////////////////////////////////////////////
+
+void SortBlock::rearrangeBuffer (std::vector<std::pair<size_t, size_t>> const& coords) {
+  size_t const sum = coords.size();
+  size_t count = 0;
+
   // here we collect the new blocks (later swapped into _buffer):
   std::deque<AqlItemBlock*> newbuffer;
 
   try {  // If we throw from here, the catch will delete the new
     // blocks in newbuffer
 
-    count = 0;
     RegisterId const nrregs = _buffer.front()->getNrRegs();
 
     // install the rearranged values from _buffer into newbuffer
 
     while (count < sum) {
       size_t sizeNext = (std::min)(sum - count, DefaultBatchSize);
-      AqlItemBlock* next = new AqlItemBlock(sizeNext, nrregs);
+      AqlItemBlock* next = requestBlock(sizeNext, nrregs);
 
       try {
         TRI_IF_FAILURE("SortBlock::doSortingInner") {
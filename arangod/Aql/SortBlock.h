@@ -40,6 +40,8 @@ namespace triagens {
 
     class ExecutionEngine;
 
+    class SpillFile;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                         SortBlock
 // -----------------------------------------------------------------------------
@@ -57,14 +59,70 @@ namespace triagens {
 
         int initializeCursor (AqlItemBlock* items, size_t pos) override final;
 
+        bool hasMore () override final;
+
+        int64_t remaining () override final;
+
+      private:
+
+        int getOrSkipSome (size_t atLeast,
+                           size_t atMost,
+                           bool skipping,
+                           AqlItemBlock*& result,
+                           size_t& skipped) override;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief dosorting
 ////////////////////////////////////////////////////////////////////////////////
 
-      private:
-
         void doSorting ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sorts the buffered rows and writes them to a new run file
+////////////////////////////////////////////////////////////////////////////////
+
+        void spillRun ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares merging the run files
+////////////////////////////////////////////////////////////////////////////////
+
+        void startMerge ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the current row of run <a> sorts before the current row of
+/// run <b>
+////////////////////////////////////////////////////////////////////////////////
+
+        bool runLessThan (size_t a, 
+                          size_t b) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all run files
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeRuns ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetches all input and keeps only the first _limit rows in sort
+/// order, using a bounded heap
+////////////////////////////////////////////////////////////////////////////////
+
+        void doTopKSorting ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replaces _buffer with new blocks that contain the rows at the
+/// given coordinates, in the given order
+////////////////////////////////////////////////////////////////////////////////
+
+        void rearrangeBuffer (std::vector<std::pair<size_t, size_t>> const& coords);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the collections of the sort registers
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_document_collection_t const*> sortCollections () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief OurLessThan
 ////////////////////////////////////////////////////////////////////////////////
@@ -105,6 +163,44 @@ namespace triagens {
 
         bool _stable;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of rows to produce, 0 if unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _limit;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory usage of the buffered input above which sorted runs are
+/// written to temporary files, 0 if the sort is always done in memory
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t const _spillThreshold;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the sorted runs written to temporary files
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<SpillFile*> _runs;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief heap of the indexes of all runs that have rows left, with the run
+/// whose current row sorts first at the front
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<size_t> _mergeHeap;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows left in all runs
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _mergeRemaining;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of registers of the spilled rows
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _nrRegs;
+
     };
 
   }  // namespace triagens::aql
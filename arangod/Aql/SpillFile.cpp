@@ -0,0 +1,306 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief AQL, temporary files for intermediate results
+///
+/// @file 
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2014 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, triagens GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/SpillFile.h"
+#include "Aql/AqlItemBlock.h"
+#include "Basics/Exceptions.h"
+#include "Basics/files.h"
+#include "Basics/logging.h"
+#include "Basics/memory-map.h"
+#include "Utils/AqlTransaction.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief size of the write buffer. buffered rows are written to the file
+/// once the buffer has grown beyond this size
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const WriteBufferSize = 4 * 1024 * 1024;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a new temporary file
+////////////////////////////////////////////////////////////////////////////////
+
+SpillFile::SpillFile (triagens::arango::AqlTransaction* trx)
+  : _trx(trx),
+    _filename(),
+    _fd(-1),
+    _builder(),
+    _writeBuffer(),
+    _numRows(0),
+    _fileSize(0),
+    _data(nullptr),
+    _mmHandle(nullptr),
+    _readPosition(0) {
+
+  char* filename = nullptr;
+  std::string errorMessage;
+  long systemError;
+
+  if (TRI_GetTempName("aql", &filename, true, systemError, errorMessage) != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_CREATE_TEMP_FILE, 
+                                   "could not create temporary file for AQL query: " + errorMessage);
+  }
+
+  _filename = filename;
+  TRI_Free(TRI_CORE_MEM_ZONE, filename);
+
+  _fd = TRI_OPEN(_filename.c_str(), O_RDWR);
+
+  if (_fd < 0) {
+    TRI_UnlinkFile(_filename.c_str());
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_CREATE_TEMP_FILE,
+                                   "could not open temporary file '" + _filename + "' for AQL query");
+  }
+
+  _writeBuffer.reserve(WriteBufferSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the file
+////////////////////////////////////////////////////////////////////////////////
+
+SpillFile::~SpillFile () {
+  if (_data != nullptr) {
+    TRI_UNMMFile(_data, _fileSize, _fd, &_mmHandle);
+  }
+
+  if (_fd >= 0) {
+    TRI_CLOSE(_fd);
+  }
+
+  int res = TRI_UnlinkFile(_filename.c_str());
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    LOG_WARNING("unable to remove temporary file '%s': %s", _filename.c_str(), TRI_errno_string(res));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start a new row
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::openRow (size_t numSlots) {
+  TRI_ASSERT(_data == nullptr);
+
+  _builder.clear();
+  _builder.openArray(numSlots);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a value to the current row
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::addValue (AqlValue const& value,
+                          TRI_document_collection_t const* document) {
+  if (value.isEmpty()) {
+    _builder.openArray(0);
+    _builder.closeArray();
+    return;
+  }
+
+  _builder.openArray(1);
+  value.toCompact(_trx, document, _builder);
+  _builder.closeArray();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a number to the current row
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::addNumber (double value) {
+  _builder.openArray(1);
+  _builder.addNumber(value);
+  _builder.closeArray();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the current row
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::closeRow () {
+  _builder.closeArray();
+
+  size_t const size = _builder.size();
+  _writeBuffer.append(_builder.value().data(), size);
+  _fileSize += size;
+  ++_numRows;
+
+  if (_writeBuffer.size() >= WriteBufferSize) {
+    flush();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add all registers of a row of an AqlItemBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::addRow (AqlItemBlock const* block,
+                        size_t row) {
+  RegisterId const n = block->getNrRegs();
+
+  openRow(n);
+  for (RegisterId i = 0; i < n; ++i) {
+    addValue(block->getValueReference(row, i), block->getDocumentCollection(i));
+  }
+  closeRow();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief flush all pending rows and map the file for reading
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::finish () {
+  TRI_ASSERT(_data == nullptr);
+
+  flush();
+
+  if (_fileSize == 0) {
+    return;
+  }
+
+  void* data = nullptr;
+  int res = TRI_MMFile(nullptr, _fileSize, PROT_READ, MAP_SHARED, _fd, &_mmHandle, 0, &data);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(res, "could not memory-map temporary file '" + _filename + "' for AQL query");
+  }
+
+  _data = static_cast<char*>(data);
+  _readPosition = 0;
+
+  // rows are read sequentially
+  TRI_MMFileAdvise(_data, _fileSize, TRI_MADVISE_SEQUENTIAL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a slot of the current row is empty
+////////////////////////////////////////////////////////////////////////////////
+
+bool SpillFile::isEmpty (size_t slot) const {
+  return currentRow().at(slot).length() == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a slot of the current row
+////////////////////////////////////////////////////////////////////////////////
+
+CompactValue SpillFile::value (size_t slot) const {
+  CompactValue wrapper = currentRow().at(slot);
+  TRI_ASSERT(wrapper.length() == 1);
+  return wrapper.at(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a copy of a slot of the current row
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue SpillFile::copyValue (size_t slot) const {
+  CompactValue wrapper = currentRow().at(slot);
+
+  if (wrapper.length() == 0) {
+    return AqlValue();
+  }
+
+  return AqlValue(wrapper.at(0).copy());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief copy the current row into the registers of a row of an AqlItemBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::readRow (AqlItemBlock* block,
+                         size_t row) const {
+  CompactValue current = currentRow();
+  RegisterId const n = block->getNrRegs();
+  TRI_ASSERT(current.length() == n);
+
+  for (RegisterId i = 0; i < n; ++i) {
+    CompactValue wrapper = current.at(i);
+
+    if (wrapper.length() == 0) {
+      continue;
+    }
+
+    AqlValue value(wrapper.at(0).copy());
+
+    try {
+      block->setValue(row, i, value);
+    }
+    catch (...) {
+      value.destroy();
+      throw;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief advance to the next row
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::nextRow () {
+  _readPosition += currentRow().byteSize();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write the buffered rows to the file
+////////////////////////////////////////////////////////////////////////////////
+
+void SpillFile::flush () {
+  if (_writeBuffer.empty()) {
+    return;
+  }
+
+  if (! TRI_WritePointer(_fd, _writeBuffer.c_str(), _writeBuffer.size())) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_CANNOT_WRITE_FILE, 
+                                   "could not write to temporary file '" + _filename + "' for AQL query");
+  }
+
+  _writeBuffer.clear();
+}
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief AQL, temporary files for intermediate results
+///
+/// @file 
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2014 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, triagens GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_SPILL_FILE_H
+#define ARANGODB_AQL_SPILL_FILE_H 1
+
+#include "Basics/Common.h"
+#include "Aql/AqlValue.h"
+#include "Aql/CompactValue.h"
+
+struct TRI_document_collection_t;
+
+namespace triagens {
+  namespace arango {
+    class AqlTransaction;
+  }
+
+  namespace aql {
+
+    class AqlItemBlock;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class SpillFile
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a temporary file that rows of AQL values are written to when an
+/// operation exceeds its memory budget, and from which they are read back
+/// sequentially later
+///
+/// Each row is stored as one value in compact binary representation: an
+/// array with one entry per slot, which is an empty array for an empty 
+/// value and an array with the value as its only member otherwise. Rows are
+/// appended using a write buffer. Once finish() has been called, the file is
+/// memory-mapped read-only and rows can be read back without copying them.
+/// The file is removed when the SpillFile is destroyed.
+////////////////////////////////////////////////////////////////////////////////
+
+    class SpillFile {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        SpillFile (SpillFile const&) = delete;
+        SpillFile& operator= (SpillFile const&) = delete;
+
+        explicit SpillFile (triagens::arango::AqlTransaction*);
+
+        ~SpillFile ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start a new row with at most the given number of slots
+////////////////////////////////////////////////////////////////////////////////
+
+        void openRow (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a value to the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        void addValue (AqlValue const&,
+                       TRI_document_collection_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a number to the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        void addNumber (double);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        void closeRow ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add all registers of a row of an AqlItemBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        void addRow (AqlItemBlock const*,
+                     size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief flush all pending rows and prepare the file for reading
+////////////////////////////////////////////////////////////////////////////////
+
+        void finish ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows in the file
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t numRows () const {
+          return _numRows;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes in the file
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t byteSize () const {
+          return _fileSize;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not there is a row to read
+////////////////////////////////////////////////////////////////////////////////
+
+        inline bool hasRow () const {
+          return (_data != nullptr && _readPosition < _fileSize);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not a slot of the current row is empty
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isEmpty (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a slot of the current row. the value points into the file
+/// and is only valid as long as the SpillFile exists
+////////////////////////////////////////////////////////////////////////////////
+
+        CompactValue value (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a copy of a slot of the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlValue copyValue (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief copy the current row into the registers of a row of an 
+/// AqlItemBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        void readRow (AqlItemBlock*,
+                      size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief advance to the next row
+////////////////////////////////////////////////////////////////////////////////
+
+        void nextRow ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write the buffered rows to the file
+////////////////////////////////////////////////////////////////////////////////
+
+        void flush ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        inline CompactValue currentRow () const {
+          TRI_ASSERT(hasRow());
+          return CompactValue(_data + _readPosition);
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the transaction, used to convert shaped values
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::arango::AqlTransaction* _trx;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the file
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _filename;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief file descriptor
+////////////////////////////////////////////////////////////////////////////////
+
+        int _fd;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builder for the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        CompactBuilder _builder;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief rows not yet written to the file
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _writeBuffer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of rows
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _numRows;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes written to the file
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _fileSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the memory-mapped file contents, once finished
+////////////////////////////////////////////////////////////////////////////////
+
+        char* _data;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief memory map handle
+////////////////////////////////////////////////////////////////////////////////
+
+        void* _mmHandle;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief position of the current row
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _readPosition;
+    };
+
+  }  // namespace triagens::aql
+}  // namespace triagens
+
+#endif
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
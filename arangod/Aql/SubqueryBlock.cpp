@@ -28,6 +28,8 @@
 #include "SubqueryBlock.h"
 #include "Aql/ExecutionEngine.h"
 #include "Basics/Exceptions.h"
+#include "Basics/json.h"
+#include "Basics/ScopeGuard.h"
 #include "VocBase/vocbase.h"
 
 using namespace std;
@@ -43,12 +45,24 @@ SubqueryBlock::SubqueryBlock (ExecutionEngine* engine,
                               ExecutionBlock* subquery)
   : ExecutionBlock(engine, en), 
     _outReg(ExecutionNode::MaxRegisterId),
-    _subquery(subquery) {
+    _subquery(subquery),
+    _isConst(en->isConst()),
+    _constResults(nullptr),
+    _outerKeyReg(ExecutionNode::MaxRegisterId),
+    _groupsBuilt(false),
+    _groups() {
   
   auto it = en->getRegisterPlan()->varInfo.find(en->_outVariable->id);
   TRI_ASSERT(it != en->getRegisterPlan()->varInfo.end());
   _outReg = it->second.registerId;
   TRI_ASSERT(_outReg < ExecutionNode::MaxRegisterId);
+
+  if (en->isDecorrelated()) {
+    it = en->getRegisterPlan()->varInfo.find(en->_outerKeyVariable->id);
+    TRI_ASSERT(it != en->getRegisterPlan()->varInfo.end());
+    _outerKeyReg = it->second.registerId;
+    TRI_ASSERT(_outerKeyReg < ExecutionNode::MaxRegisterId);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -56,6 +70,7 @@ SubqueryBlock::SubqueryBlock (ExecutionEngine* engine,
 ////////////////////////////////////////////////////////////////////////////////
 
 SubqueryBlock::~SubqueryBlock () {
+  freeCachedResults();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -84,62 +99,243 @@ AqlItemBlock* SubqueryBlock::getSome (size_t atLeast,
     return nullptr;
   }
 
-  // TODO: constant and deterministic subqueries only need to be executed once
-  bool const subqueryIsConst = false; // TODO 
+  if (_outerKeyReg != ExecutionNode::MaxRegisterId) {
+    fillDecorrelatedResults(res.get());
+  }
+  else if (_isConst) {
+    fillConstResults(res.get());
+  }
+  else {
+    fillResults(res.get());
+  }
+
+  // Clear out registers no longer needed later:
+  clearRegisters(res.get());
+  return res.release();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shutdown, tell dependency and the subquery
+////////////////////////////////////////////////////////////////////////////////
 
-  std::vector<AqlItemBlock*>* subqueryResults = nullptr;
+int SubqueryBlock::shutdown (int errorCode) {
+  freeCachedResults();
+
+  int res = ExecutionBlock::shutdown(errorCode);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  return getSubquery()->shutdown(errorCode);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, executing the
+/// subquery for each row
+////////////////////////////////////////////////////////////////////////////////
 
+void SubqueryBlock::fillResults (AqlItemBlock* res) {
   for (size_t i = 0; i < res->size(); i++) {
-    int ret = _subquery->initializeCursor(res.get(), i);
+    int ret = _subquery->initializeCursor(res, i);
 
     if (ret != TRI_ERROR_NO_ERROR) {
       THROW_ARANGO_EXCEPTION(ret);
     }
 
-    if (i > 0 && subqueryIsConst) {
-      // re-use already calculated subquery result
-      TRI_ASSERT(subqueryResults != nullptr);
+    // execute the subquery
+    auto subqueryResults = executeSubquery();
+    TRI_ASSERT(subqueryResults != nullptr);
+
+    try {
+      TRI_IF_FAILURE("SubqueryBlock::getSome") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
       res->setValue(i, _outReg, AqlValue(subqueryResults));
     }
+    catch (...) {
+      destroySubqueryResults(subqueryResults);
+      throw;
+    }
+      
+    throwIfKilled(); // check if we were aborted
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, for a
+/// constant subquery. the subquery is executed only once per query
+////////////////////////////////////////////////////////////////////////////////
+
+void SubqueryBlock::fillConstResults (AqlItemBlock* res) {
+  if (_constResults == nullptr) {
+    int ret = _subquery->initializeCursor(res, 0);
+
+    if (ret != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(ret);
+    }
+
+    _constResults = executeSubquery();
+    TRI_ASSERT(_constResults != nullptr);
+  }
+
+  // the results are owned by the output block, so every block gets its
+  // own copy. all rows of the block share it
+  AqlValue value = AqlValue(_constResults).clone();
+
+  try {
+    TRI_IF_FAILURE("SubqueryBlock::getSome") {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    }
+    res->setValue(0, _outReg, value);
+  }
+  catch (...) {
+    value.destroy();
+    throw;
+  }
+
+  for (size_t i = 1; i < res->size(); i++) {
+    res->setValue(i, _outReg, res->getValueReference(0, _outReg));
+  }
+      
+  throwIfKilled(); // check if we were aborted
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, for a
+/// decorrelated subquery. the subquery is executed only once per query, and
+/// the result for each row is looked up by key
+////////////////////////////////////////////////////////////////////////////////
+
+void SubqueryBlock::fillDecorrelatedResults (AqlItemBlock* res) {
+  if (! _groupsBuilt) {
+    buildGroups(res);
+    _groupsBuilt = true;
+  }
+
+  auto document = res->getDocumentCollection(_outerKeyReg);
+
+  for (size_t i = 0; i < res->size(); i++) {
+    auto key = res->getValueReference(i, _outerKeyReg).toJson(_trx, document, false);
+    auto it = _groups.find(key.json());
+
+    TRI_json_t* group;
+    if (it == _groups.end()) {
+      group = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE);
+    }
     else {
-      // initial subquery execution or subquery is not constant
+      group = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, (*it).second);
+    }
+
+    if (group == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
 
-      // execute the subquery
-      subqueryResults = executeSubquery();
-      TRI_ASSERT(subqueryResults != nullptr);
+    AqlValue value(new triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, group));
 
-      try {
-        TRI_IF_FAILURE("SubqueryBlock::getSome") {
-          THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+    try {
+      TRI_IF_FAILURE("SubqueryBlock::getSome") {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+      }
+      res->setValue(i, _outReg, value);
+    }
+    catch (...) {
+      value.destroy();
+      throw;
+    }
+  }
+      
+  throwIfKilled(); // check if we were aborted
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a decorrelated subquery and group its results by key. the
+/// subquery returns [ key, value ] pairs
+////////////////////////////////////////////////////////////////////////////////
+
+void SubqueryBlock::buildGroups (AqlItemBlock* res) {
+  TRI_ASSERT(_groups.empty());
+
+  int ret = _subquery->initializeCursor(res, 0);
+
+  if (ret != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(ret);
+  }
+
+  auto subqueryResults = executeSubquery();
+  TRI_ASSERT(subqueryResults != nullptr);
+
+  triagens::basics::ScopeGuard guard{
+    []() -> void { },
+    [this, &subqueryResults]() -> void {
+      destroySubqueryResults(subqueryResults);
+    }
+  };
+
+  for (auto const& block : *subqueryResults) {
+    auto document = block->getDocumentCollection(0);
+    size_t const n = block->size();
+
+    for (size_t i = 0; i < n; ++i) {
+      auto pair = block->getValueReference(i, 0).toJson(_trx, document, false);
+      TRI_ASSERT(pair.isArray() && pair.size() == 2);
+
+      auto key = TRI_LookupArrayJson(pair.json(), 0);
+      auto it = _groups.find(key);
+
+      if (it == _groups.end()) {
+        auto keyCopy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, key);
+        auto group = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE);
+
+        if (keyCopy == nullptr || group == nullptr) {
+          if (keyCopy != nullptr) {
+            TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, keyCopy);
+          }
+          if (group != nullptr) {
+            TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, group);
+          }
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+
+        try {
+          it = _groups.emplace(keyCopy, group).first;
+        }
+        catch (...) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, keyCopy);
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, group);
+          throw;
         }
-        res->setValue(i, _outReg, AqlValue(subqueryResults));
       }
-      catch (...) {
-        destroySubqueryResults(subqueryResults);
-        throw;
+
+      auto value = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, TRI_LookupArrayJson(pair.json(), 1));
+
+      if (value == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
       }
-    } 
+
+      TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, (*it).second, value);
+    }
       
     throwIfKilled(); // check if we were aborted
   }
-
-  // Clear out registers no longer needed later:
-  clearRegisters(res.get());
-  return res.release();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief shutdown, tell dependency and the subquery
+/// @brief free the cached results of a constant or decorrelated subquery
 ////////////////////////////////////////////////////////////////////////////////
 
-int SubqueryBlock::shutdown (int errorCode) {
-  int res = ExecutionBlock::shutdown(errorCode);
-
-  if (res != TRI_ERROR_NO_ERROR) {
-    return res;
+void SubqueryBlock::freeCachedResults () {
+  if (_constResults != nullptr) {
+    destroySubqueryResults(_constResults);
+    _constResults = nullptr;
   }
 
-  return getSubquery()->shutdown(errorCode);
+  for (auto& it : _groups) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, const_cast<TRI_json_t*>(it.first));
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it.second);
+  }
+  _groups.clear();
+  _groupsBuilt = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,7 @@
 
 #include "Aql/ExecutionBlock.h"
 #include "Aql/ExecutionNode.h"
+#include "Basics/json-utilities.h"
 #include "Utils/AqlTransaction.h"
 
 namespace triagens {
@@ -98,6 +99,39 @@ namespace triagens {
 
         void destroySubqueryResults (std::vector<AqlItemBlock*>*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, executing the
+/// subquery for each row
+////////////////////////////////////////////////////////////////////////////////
+
+        void fillResults (AqlItemBlock*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, for a
+/// constant subquery
+////////////////////////////////////////////////////////////////////////////////
+
+        void fillConstResults (AqlItemBlock*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the subquery results for a block of input rows, for a
+/// decorrelated subquery
+////////////////////////////////////////////////////////////////////////////////
+
+        void fillDecorrelatedResults (AqlItemBlock*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a decorrelated subquery and group its results by key
+////////////////////////////////////////////////////////////////////////////////
+
+        void buildGroups (AqlItemBlock*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the cached results of a constant or decorrelated subquery
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeCachedResults ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief output register
 ////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +143,38 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         ExecutionBlock* _subquery;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the subquery produces the same result for all rows
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _isConst;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the result of a constant subquery, executed only once. every
+/// output block gets a copy of it
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<AqlItemBlock*>* _constResults;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register with the lookup key, only used for decorrelated subqueries
+////////////////////////////////////////////////////////////////////////////////
+
+        RegisterId _outerKeyReg;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not _groups was built
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _groupsBuilt;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief results of a decorrelated subquery, grouped by key. keys and values
+/// are owned by the block
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<TRI_json_t const*, TRI_json_t*, triagens::basics::JsonHash, triagens::basics::JsonEqual> _groups;
     };
 
   }  // namespace triagens::aql
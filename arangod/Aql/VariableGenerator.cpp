@@ -162,6 +162,11 @@ Variable* VariableGenerator::createVariable (triagens::basics::Json const& json)
     delete variable;
     return existing;
   }
+
+  if (variable->id >= _id) {
+    // variables created later must not reuse the ids of the variables from the JSON
+    _id = variable->id + 1;
+  }
   
   try {
     _variables.emplace(variable->id, variable);
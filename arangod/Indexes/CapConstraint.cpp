@@ -54,9 +54,8 @@ CapConstraint::CapConstraint (TRI_idx_iid_t iid,
                               int64_t size)
   : Index(iid, collection, std::vector<std::vector<triagens::basics::AttributeName>>()),
     _count(count),
-    _size(static_cast<int64_t>(size)) {
-
-  initialize();
+    _size(static_cast<int64_t>(size)),
+    _revisions() {
 }
 
 CapConstraint::~CapConstraint () {
@@ -67,7 +66,8 @@ CapConstraint::~CapConstraint () {
 // -----------------------------------------------------------------------------
         
 size_t CapConstraint::memory () const {
-  return 0;
+  // estimate for the map nodes: the value plus three pointers and the color
+  return _revisions.size() * (sizeof(RevisionMap::value_type) + 4 * sizeof(void*));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -108,11 +108,22 @@ int CapConstraint::insert (TRI_doc_mptr_t const* doc,
     }
   }
 
+  try {
+    _revisions.emplace(doc->_rid, const_cast<TRI_doc_mptr_t*>(doc));
+  }
+  catch (...) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
   return TRI_ERROR_NO_ERROR;
 }
          
-int CapConstraint::remove (TRI_doc_mptr_t const*, 
+int CapConstraint::remove (TRI_doc_mptr_t const* doc, 
                            bool) {
+  // master pointers are updated in place, so this is called with the old
+  // revision before the master pointer is changed
+  _revisions.erase(doc->_rid);
+
   return TRI_ERROR_NO_ERROR;
 }
         
@@ -183,7 +194,12 @@ int CapConstraint::apply (TRI_document_collection_t* document,
   // delete while at least one of the constraints is still violated
   while ((_count > 0 && currentCount > _count) ||
          (_size > 0 && currentSize > _size)) {
-    TRI_doc_mptr_t* oldest = headers->front();
+    // the oldest document is the one with the lowest revision
+    TRI_doc_mptr_t* oldest = nullptr;
+
+    if (! _revisions.empty()) {
+      oldest = (*_revisions.begin()).second;
+    }
 
     if (oldest != nullptr) {
       TRI_ASSERT(oldest->getDataPtr() != nullptr);  // ONLY IN INDEX, PROTECTED by RUNTIME
@@ -200,6 +216,7 @@ int CapConstraint::apply (TRI_document_collection_t* document,
         }
       }
       else {
+        _revisions.erase(oldest->_rid);
         headers->unlink(oldest);
       }
 
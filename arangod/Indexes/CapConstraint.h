@@ -65,6 +65,13 @@ namespace triagens {
 
       public:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents of the collection ordered by their revision ids, i.e. in
+/// order of insertion/update
+////////////////////////////////////////////////////////////////////////////////
+
+        typedef std::map<TRI_voc_rid_t, struct TRI_doc_mptr_t*> RevisionMap;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief maximum number of documents in the collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +87,15 @@ namespace triagens {
         int64_t size () const {
           return _size;
         }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents of the collection ordered by revision
+/// the caller must hold at least the collection's read lock
+////////////////////////////////////////////////////////////////////////////////
+
+        RevisionMap const& revisions () const {
+          return _revisions;
+        }
         
         IndexType type () const override final {
           return Index::TRI_IDX_TYPE_CAP_CONSTRAINT;
@@ -104,18 +120,22 @@ namespace triagens {
         
         int postInsert (struct TRI_transaction_collection_s*, struct TRI_doc_mptr_t const*) override final;
 
-// -----------------------------------------------------------------------------
-// --SECTION--                                                   private methods
-// -----------------------------------------------------------------------------
-
-      private:
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialize the cap constraint
+///
+/// this removes the oldest documents until the constraint is satisfied. it
+/// must not be called while the secondary indexes are not maintained, because
+/// the revisions of the constraint are not maintained then either
 ////////////////////////////////////////////////////////////////////////////////
 
         int initialize ();
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief apply the cap constraint for the collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -141,6 +161,12 @@ namespace triagens {
 
         int64_t const _size;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents of the collection ordered by revision
+////////////////////////////////////////////////////////////////////////////////
+
+        RevisionMap _revisions;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public variables
 // -----------------------------------------------------------------------------
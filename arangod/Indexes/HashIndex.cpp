@@ -405,13 +405,15 @@ int HashIndex::lookup (TRI_index_search_value_t* searchValue,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief locates entries in the hash index given shaped json objects
+/// @brief locates entries in the hash index given shaped json objects, in
+/// batches
 ////////////////////////////////////////////////////////////////////////////////
 
 int HashIndex::lookup (TRI_index_search_value_t* searchValue,
                        std::vector<TRI_doc_mptr_copy_t>& documents,
                        TRI_index_element_t*& next,
-                       size_t batchSize) const {
+                       size_t batchSize,
+                       std::vector<TRI_index_element_t const*>* elements) const {
 
   if (_unique) {
     next = nullptr;
@@ -420,6 +422,10 @@ int HashIndex::lookup (TRI_index_search_value_t* searchValue,
     if (found != nullptr) {
       // unique hash index: maximum number is 1
       documents.emplace_back(*(found->document()));
+
+      if (elements != nullptr) {
+        elements->emplace_back(found);
+      }
     }
     return TRI_ERROR_NO_ERROR;
   }
@@ -449,6 +455,10 @@ int HashIndex::lookup (TRI_index_search_value_t* searchValue,
       try {
         for (size_t i = 0; i < results->size(); i++) {
           documents.emplace_back(*((*results)[i]->document()));
+
+          if (elements != nullptr) {
+            elements->emplace_back((*results)[i]);
+          }
         }
       }
       catch (...) {
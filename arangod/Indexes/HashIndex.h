@@ -111,13 +111,16 @@ namespace triagens {
                     std::vector<TRI_doc_mptr_copy_t>&) const;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief locates entries in the hash index given shaped json objects
+/// @brief locates entries in the hash index given shaped json objects, in
+/// batches. if <elements> is given, the found index elements are also
+/// returned, in the same order as the documents
 ////////////////////////////////////////////////////////////////////////////////
 
         int lookup (TRI_index_search_value_t*,
                     std::vector<TRI_doc_mptr_copy_t>&,
                     TRI_index_element_t*&,
-                    size_t batchSize) const;
+                    size_t batchSize,
+                    std::vector<TRI_index_element_t const*>* elements = nullptr) const;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
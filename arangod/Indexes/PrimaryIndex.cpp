@@ -210,6 +210,37 @@ TRI_doc_mptr_t* PrimaryIndex::lookupSequentialReverse (triagens::basics::BucketP
   return _primaryIndex->findSequentialReverse(position);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of buckets of the index
+////////////////////////////////////////////////////////////////////////////////
+
+size_t PrimaryIndex::numBuckets () const {
+  return _primaryIndex->numBuckets();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of slots in a bucket of the index
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PrimaryIndex::bucketCapacity (size_t bucketId) const {
+  return _primaryIndex->bucketCapacity(bucketId);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a method to fetch all elements from a slot range of a bucket.
+///        Slot ranges of different buckets can be scanned in parallel, as
+///        long as the caller holds the collection's read lock.
+////////////////////////////////////////////////////////////////////////////////
+
+void PrimaryIndex::lookupRange (size_t bucketId,
+                                uint64_t from,
+                                uint64_t to,
+                                std::vector<TRI_doc_mptr_copy_t>& result) const {
+  _primaryIndex->invokeOnRange(bucketId, from, to, [&result] (TRI_doc_mptr_t* mptr) -> void {
+    result.emplace_back(*mptr);
+  });
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief adds a key/element to the index
 /// returns a status code, and *found will contain a found element (if any)
@@ -140,6 +140,29 @@ namespace triagens {
 
         TRI_doc_mptr_t* lookupSequentialReverse (triagens::basics::BucketPosition& position);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of buckets of the index
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t numBuckets () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of slots in a bucket of the index
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t bucketCapacity (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a method to fetch all elements from a slot range of a bucket.
+///        Slot ranges of different buckets can be scanned in parallel, as
+///        long as the caller holds the collection's read lock.
+////////////////////////////////////////////////////////////////////////////////
+
+        void lookupRange (size_t,
+                          uint64_t,
+                          uint64_t,
+                          std::vector<TRI_doc_mptr_copy_t>&) const;
+
         int insertKey (TRI_doc_mptr_t*, void const**);
 
 ////////////////////////////////////////////////////////////////////////////////
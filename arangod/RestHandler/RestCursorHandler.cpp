@@ -133,6 +133,11 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
   
   auto options = buildOptions(json);
 
+  if (triagens::basics::JsonHelper::getBooleanValue(options.json(), "stream", false)) {
+    processStreamingQuery(queryString, bindVars, options);
+    return;
+  }
+
   triagens::aql::Query query(_applicationV8, 
                              false, 
                              _vocbase, 
@@ -238,6 +243,78 @@ void RestCursorHandler::processQuery (TRI_json_t const* json) {
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the query and returns a streaming cursor for it. the
+/// results are produced batch by batch when they are fetched from the cursor,
+/// so the query's execution engine and transaction stay alive until the
+/// cursor is exhausted, deleted or expires
+////////////////////////////////////////////////////////////////////////////////
+
+void RestCursorHandler::processStreamingQuery (TRI_json_t const* queryString,
+                                               TRI_json_t const* bindVars,
+                                               triagens::basics::Json const& options) {
+  if (triagens::basics::JsonHelper::getBooleanValue(options.json(), "count", false)) {
+    // the number of results is not known before the cursor is exhausted
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_BAD_PARAMETER, "count is not supported for streaming cursors");
+  }
+
+  std::unique_ptr<triagens::aql::Query> query(new triagens::aql::Query(
+    _applicationV8, 
+    false, 
+    _vocbase, 
+    queryString->_value._string.data,
+    static_cast<size_t>(queryString->_value._string.length - 1),
+    (bindVars != nullptr ? TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, bindVars) : nullptr),
+    TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, options.json()), 
+    triagens::aql::PART_MAIN
+  ));
+
+  registerQuery(query.get()); 
+  auto queryResult = query->prepare(_queryRegistry);
+  unregisterQuery(); 
+
+  if (queryResult.code != TRI_ERROR_NO_ERROR) {
+    if (queryResult.code == TRI_ERROR_REQUEST_CANCELED ||
+        (queryResult.code == TRI_ERROR_QUERY_KILLED && wasCanceled())) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_REQUEST_CANCELED);
+    }
+
+    THROW_ARANGO_EXCEPTION_MESSAGE(queryResult.code, queryResult.details);
+  }
+
+  if (query->isModificationQuery()) {
+    // the query's transaction is continued by other threads, and its locks
+    // are held until the cursor is gone. this is only acceptable for reads
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_BAD_PARAMETER, "streaming is only supported for read-only queries");
+  }
+
+  auto cursors = static_cast<triagens::arango::CursorRepository*>(_vocbase->_cursorRepository);
+  TRI_ASSERT(cursors != nullptr);
+
+  size_t batchSize = triagens::basics::JsonHelper::getNumericValue<size_t>(options.json(), "batchSize", 1000);
+  double ttl = triagens::basics::JsonHelper::getNumericValue<double>(options.json(), "ttl", 30);
+
+  // the cursor will take over the ownership of the query
+  triagens::arango::StreamCursor* cursor = cursors->createFromQuery(query.release(), batchSize, ttl); 
+
+  try {
+    _response = createResponse(HttpResponse::CREATED);
+    _response->setContentType("application/json; charset=utf-8");
+
+    _response->body().appendChar('{');
+    cursor->dump(_response->body());
+    _response->body().appendText(",\"error\":false,\"code\":");
+    _response->body().appendInteger(static_cast<uint32_t>(_response->responseCode()));
+    _response->body().appendChar('}');
+
+    cursors->release(cursor);
+  }
+  catch (...) {
+    cursors->release(cursor);
+    throw;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief register the currently running query
 ////////////////////////////////////////////////////////////////////////////////
@@ -432,6 +509,14 @@ triagens::basics::Json RestCursorHandler::buildExtra (triagens::aql::QueryResult
 /// be present in the result if the query has a LIMIT clause and the LIMIT clause is
 /// actually used in the query.
 ///
+/// @RESTSTRUCT{memoryLimit,JSF_post_api_cursor_opts,integer,optional,int64}
+/// the maximum amount of memory (in bytes) that the query is allowed to use.
+/// If the query uses more memory than that, it will be aborted with error
+/// *1505* (query would use more memory than allowed). The default value is
+/// *0*, which means that the memory usage is not limited. The peak memory
+/// usage of a query is returned in the *peakMemoryUsage* attribute of the
+/// query's statistics.
+///
 /// @RESTSTRUCT{maxPlans,JSF_post_api_cursor_opts,integer,optional,int64}
 /// limits the maximum number of plans that are created by the AQL query optimizer.
 ///
@@ -441,11 +526,46 @@ triagens::basics::Json RestCursorHandler::buildExtra (triagens::aql::QueryResult
 /// specific rules. To disable a rule, prefix its name with a `-`, to enable a rule, prefix it
 /// with a `+`. There is also a pseudo-rule `all`, which will match all optimizer rules.
 ///
+/// @RESTSTRUCT{planCache,JSF_post_api_cursor_opts,boolean,optional,}
+/// if set to *false*, the query will neither use a cached execution plan nor
+/// put its plan into the plan cache. The default value is *true*. A cached
+/// plan is only reused for queries with the same query string, bind
+/// parameter names and options. Collection bind parameters and bind
+/// parameters used for LIMIT values, SORT directions, attribute names or
+/// query options must have the same values, too.
+///
 /// @RESTSTRUCT{profile,JSF_post_api_cursor_opts,boolean,optional,}
 /// if set to *true*, then the additional query profiling information
 /// will be returned in the *extra.stats* return attribute if the query result is not
 /// served from the query cache.
 ///
+/// @RESTSTRUCT{scanThreads,JSF_post_api_cursor_opts,integer,optional,int64}
+/// the number of threads used for full collection scans. If set to a value
+/// greater than *1*, full scans of collections that are only read by the query
+/// are split into chunks which are scanned by this many threads, and filter
+/// conditions that only refer to the scanned documents are evaluated by these
+/// threads as well. Edge collections are always scanned by a single thread.
+/// The default value is *0*, which means that collections are scanned by
+/// the thread executing the query.
+///
+/// @RESTSTRUCT{spillThreshold,JSF_post_api_cursor_opts,integer,optional,int64}
+/// the maximum amount of memory (in bytes) that a *SORT* or a hashed *COLLECT*
+/// may use for buffering its input. If the threshold is exceeded, the data
+/// is written to temporary files on disk. The default value is *0*, which 
+/// means that data is never written to disk.
+///
+/// @RESTSTRUCT{stream,JSF_post_api_cursor_opts,boolean,optional,}
+/// if set to *true*, the query will not be executed to completion when the
+/// cursor is created. Instead, each batch of results is produced when it is
+/// fetched from the cursor, so the server only needs to keep one batch of
+/// results in memory. The query's transaction and collection locks are held 
+/// until the cursor is exhausted, deleted or expires, so streaming is only
+/// supported for queries that do not modify data, and the *ttl* of streaming
+/// cursors is limited to 60 seconds. Setting the *count* attribute is not
+/// supported for streaming cursors and results in an HTTP 400 error, and the
+/// *extra* attribute is only returned with the last batch. The default value
+/// is *false*.
+///
 /// @RESTDESCRIPTION
 /// The query details include the query string plus optional query options and
 /// bind parameters. These values need to be passed in a JSON representation in
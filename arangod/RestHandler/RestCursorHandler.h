@@ -107,6 +107,14 @@ namespace triagens {
 
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the query and returns a streaming cursor for it
+////////////////////////////////////////////////////////////////////////////////
+
+        void processStreamingQuery (TRI_json_t const*,
+                                    TRI_json_t const*,
+                                    triagens::basics::Json const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief register the currently running query
 ////////////////////////////////////////////////////////////////////////////////
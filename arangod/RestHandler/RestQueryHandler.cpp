@@ -202,6 +202,12 @@ bool RestQueryHandler::readQueryProperties () {
 /// - *runTime*: the query's run time up to the point the list of queries was
 ///   queried
 ///
+/// - *memoryUsage*: the memory (in bytes) used by the query up to the point
+///   the list of queries was queried
+///
+/// - *peakMemoryUsage*: the maximum memory (in bytes) used by the query up to
+///   the point the list of queries was queried
+///
 /// @RESTRETURNCODES
 ///
 /// @RESTRETURNCODE{200}
@@ -238,6 +244,12 @@ bool RestQueryHandler::readQueryProperties () {
 /// - *runTime*: the query's run time up to the point the list of queries was
 ///   queried
 ///
+/// - *memoryUsage*: the memory (in bytes) used by the query up to the point
+///   the list of queries was queried
+///
+/// - *peakMemoryUsage*: the maximum memory (in bytes) used by the query up to
+///   the point the list of queries was queried
+///
 /// @RESTRETURNCODES
 ///
 /// @RESTRETURNCODE{200}
@@ -265,7 +277,9 @@ bool RestQueryHandler::readQuery (bool slow) {
       .set("id", Json(StringUtils::itoa(it.id)))
       .set("query", Json(queryString))
       .set("started", Json(timeString))
-      .set("runTime", Json(it.runTime));
+      .set("runTime", Json(it.runTime))
+      .set("memoryUsage", Json(static_cast<double>(it.memoryUsage)))
+      .set("peakMemoryUsage", Json(static_cast<double>(it.peakMemoryUsage)));
 
       result.add(entry);
     }
@@ -36,6 +36,7 @@
 #include "Actions/actions.h"
 #include "Admin/ApplicationAdminServer.h"
 #include "Aql/Query.h"
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/RestAqlHandler.h"
 #include "Basics/FileUtils.h"
@@ -367,6 +368,7 @@ ArangoServer::ArangoServer (int argc, char** argv)
     _databasePath(),
     _queryCacheMode("off"),
     _queryCacheMaxResults(128),
+    _planCacheMaxPlans(128),
     _defaultMaximalSize(TRI_JOURNAL_DEFAULT_MAXIMAL_SIZE),
     _defaultWaitForSync(false),
     _forceSyncProperties(true),
@@ -595,6 +597,7 @@ void ArangoServer::buildApplicationServer () {
     ("database.disable-query-tracking", &_disableQueryTracking, "turn off AQL query tracking by default")
     ("database.query-cache-mode", &_queryCacheMode, "mode for the AQL query cache (on, off, demand)")
     ("database.query-cache-max-results", &_queryCacheMaxResults, "maximum number of results in query cache per database")
+    ("database.plan-cache-max-plans", &_planCacheMaxPlans, "maximum number of cached AQL execution plans per database (0 = disable plan cache)")
     ("database.index-threads", &_indexThreads, "threads to start for parallel background index creation")
     ("database.throw-collection-not-loaded-error", &_throwCollectionNotLoadedError, "throw an error when accessing a collection that is still loading")
   ;
@@ -755,6 +758,9 @@ void ArangoServer::buildApplicationServer () {
     triagens::aql::QueryCache::instance()->setProperties(cacheProperties);
   }
 
+  // configure the plan cache
+  triagens::aql::PlanCache::instance()->setMaxPlans(static_cast<size_t>(_planCacheMaxPlans));
+
   // .............................................................................
   // now run arangod
   // .............................................................................
@@ -451,6 +451,25 @@ namespace triagens {
 
         uint64_t _queryCacheMaxResults;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of execution plans in the plan cache per database
+/// @startDocuBlock planCacheMaxPlans
+/// `--database.plan-cache-max-plans`
+///
+/// Maximum number of AQL execution plans that are kept per database. When a
+/// query is executed again with the same query string, bind parameter names
+/// and options, its cached plan is reused and parsing is skipped. Plans are
+/// cached before bind parameter values are put in, so a cached plan can be
+/// reused for different values. If the plan cache of a database is full, the
+/// oldest plan will be removed from it.
+///
+/// Setting this option to *0* turns off the plan cache. Individual queries
+/// can bypass the plan cache by setting their *planCache* option to *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _planCacheMaxPlans;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @startDocuBlock databaseMaximalJournalSize
 /// 
@@ -165,6 +165,40 @@ namespace triagens {
           return trxColl->_collection->_collection;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-lock a collection, used by parallel collection scans which
+/// must keep the collection locked while their worker threads are running
+////////////////////////////////////////////////////////////////////////////////
+
+        int readLockCollection (TRI_transaction_collection_t* trxCollection) {
+          return this->lock(trxCollection, TRI_TRANSACTION_READ);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-unlock a collection
+////////////////////////////////////////////////////////////////////////////////
+
+        int readUnlockCollection (TRI_transaction_collection_t* trxCollection) {
+          return this->unlock(trxCollection, TRI_TRANSACTION_READ);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write-lock a collection, used by data-modification operations
+/// which modify a whole batch of documents at once
+////////////////////////////////////////////////////////////////////////////////
+
+        int writeLockCollection (TRI_transaction_collection_t* trxCollection) {
+          return this->lock(trxCollection, TRI_TRANSACTION_WRITE);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write-unlock a collection
+////////////////////////////////////////////////////////////////////////////////
+
+        int writeUnlockCollection (TRI_transaction_collection_t* trxCollection) {
+          return this->unlock(trxCollection, TRI_TRANSACTION_WRITE);
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief clone, used to make daughter transactions for parts of a distributed
 /// AQL query running on the coordinator
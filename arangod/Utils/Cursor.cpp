@@ -28,8 +28,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils/Cursor.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
 #include "Basics/JsonHelper.h"
 #include "Utils/CollectionExport.h"
+#include "Utils/Transaction.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/shaped-json.h"
 #include "VocBase/vocbase.h"
@@ -423,6 +427,304 @@ void ExportCursor::dump (triagens::basics::StringBuffer& buffer) {
   }
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class StreamCursor
+// -----------------------------------------------------------------------------
+
+double const StreamCursor::MaxTtl = 60.0;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+StreamCursor::StreamCursor (TRI_vocbase_t* vocbase,
+                            CursorId id,
+                            triagens::aql::Query* query,
+                            size_t batchSize,
+                            double ttl)
+  : Cursor(id, batchSize, nullptr, (ttl > MaxTtl ? MaxTtl : ttl), false),
+    _vocbase(vocbase),
+    _query(query),
+    _block(nullptr),
+    _blockPosition(0),
+    _produced(0),
+    _resultRegister(query->engine()->resultRegister()),
+    _done(false),
+    _attached(true) {
+
+  TRI_UseVocBase(vocbase);
+
+  // the query's transaction was started by the current thread, but will be
+  // continued by the threads that fetch the next batches
+  detach();
+}
+        
+StreamCursor::~StreamCursor () {
+  freeQuery();
+
+  // the query stays in the list of running queries until the cursor is gone
+  delete _query;
+
+  TRI_ReleaseVocBase(_vocbase);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether the cursor contains more data
+////////////////////////////////////////////////////////////////////////////////
+
+bool StreamCursor::hasNext () {
+  return ! _done;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next element (not implemented)
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* StreamCursor::next () {
+  // should not be called directly
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of results produced so far
+////////////////////////////////////////////////////////////////////////////////
+
+size_t StreamCursor::count () const {
+  return _produced;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the next batch of results into a string buffer
+/// the results are pulled from the execution engine only now, so at most
+/// one batch of results is held in memory at a time
+////////////////////////////////////////////////////////////////////////////////
+        
+void StreamCursor::dump (triagens::basics::StringBuffer& buffer) {
+  TRI_ASSERT(! _done);
+
+  buffer.appendText("\"result\":[");
+
+  size_t const n = batchSize();
+
+  try {
+    attach();
+
+    size_t i = 0;
+
+    while (i < n && fetch()) {
+      auto doc = _block->getDocumentCollection(_resultRegister);
+      auto const& val = _block->getValueReference(_blockPosition++, _resultRegister);
+
+      if (val.isEmpty()) {
+        continue;
+      }
+
+      if (i > 0) {
+        buffer.appendChar(',');
+      }
+
+      triagens::basics::Json json(val.toJson(_query->trx(), doc, true));
+      int res = TRI_StringifyJson(buffer.stringBuffer(), json.json());
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      ++i;
+    }
+
+    _produced += i;
+
+    if (! fetch()) {
+      // no more results. the query's statistics and warnings are returned
+      // with the last batch
+      finish();
+    }
+    else {
+      detach();
+    }
+  }
+  catch (...) {
+    // the query cannot be continued after an error
+    freeQuery();
+    this->deleted();
+    throw;
+  }
+
+  buffer.appendText("],\"hasMore\":");
+  buffer.appendText(hasNext() ? "true" : "false");
+
+  if (hasNext()) {
+    // only return cursor id if there are more documents
+    buffer.appendText(",\"id\":\"");
+    buffer.appendInteger(id());
+    buffer.appendText("\"");
+  }
+
+  TRI_json_t const* extraJson = extra();
+
+  if (TRI_IsObjectJson(extraJson)) {
+    buffer.appendText(",\"extra\":");
+    TRI_StringifyJson(buffer.stringBuffer(), extraJson);
+  }
+
+  buffer.appendText(",\"cached\":false");
+    
+  if (! hasNext()) {
+    // mark the cursor as deleted
+    this->deleted();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure there is a block with unread rows, fetching the next
+/// block from the execution engine if required. returns false if the query
+/// has no more results
+////////////////////////////////////////////////////////////////////////////////
+
+bool StreamCursor::fetch () {
+  while (_block == nullptr || _blockPosition >= _block->size()) {
+    delete _block;
+    _block = nullptr;
+    _blockPosition = 0;
+
+    if (_query == nullptr || _query->engine() == nullptr) {
+      return false;
+    }
+
+    _block = _query->engine()->getSome(1, batchSize());
+
+    if (_block == nullptr) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the query and build the "extra" attribute from its results
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::finish () {
+  TRI_ASSERT(_query != nullptr);
+  TRI_ASSERT(_attached);
+
+  // the block must be freed before the engine is destroyed
+  delete _block;
+  _block = nullptr;
+
+  auto queryResult = _query->finish();
+  _attached = false;
+  _done = true;
+
+  if (queryResult.code != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(queryResult.code, queryResult.details);
+  }
+
+  triagens::basics::Json extra(triagens::basics::Json::Object, 3); 
+
+  if (queryResult.stats != nullptr) {
+    extra.set("stats", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.stats, triagens::basics::Json::AUTOFREE));
+    queryResult.stats = nullptr;
+  }
+  if (queryResult.profile != nullptr) {
+    extra.set("profile", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.profile, triagens::basics::Json::AUTOFREE));
+    queryResult.profile = nullptr;
+  }
+  if (queryResult.warnings == nullptr) {
+    extra.set("warnings", triagens::basics::Json(triagens::basics::Json::Array));
+  }
+  else {
+    extra.set("warnings", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.warnings, triagens::basics::Json::AUTOFREE));
+    queryResult.warnings = nullptr;
+  }
+
+  _extra = extra.steal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the query's engine and its last result block. if the query 
+/// was not finished yet, this will abort its transaction. the query object
+/// itself is kept until the cursor is destroyed
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::freeQuery () {
+  // the block must be freed before the engine, as its memory is accounted
+  // for in the query
+  delete _block;
+  _block = nullptr;
+
+  if (_query != nullptr && _query->trx() != nullptr) {
+    // the transaction is destroyed by the current thread
+    attach();
+    _query->abort();
+  }
+
+  _attached = false;
+  _done = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief let the current thread take over the query's transaction, as
+/// done by QueryRegistry::open
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::attach () {
+  if (_attached || _query == nullptr || _query->trx() == nullptr) {
+    return;
+  }
+
+  // count up the debugging counters for transactions of this thread
+  TransactionBase::increaseNumbers(1, 1);
+
+  auto engine = _query->engine();
+
+  if (engine != nullptr && 
+      engine->lockedShards() != nullptr &&
+      Transaction::_makeNolockHeaders == nullptr) {
+    Transaction::_makeNolockHeaders = engine->lockedShards();
+  }
+
+  _attached = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief release the query's transaction from the current thread, as done
+/// by QueryRegistry::close
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::detach () {
+  if (! _attached) {
+    return;
+  }
+
+  _attached = false;
+
+  if (_query == nullptr || _query->trx() == nullptr) {
+    return;
+  }
+
+  // count down the debugging counters for transactions of this thread
+  TransactionBase::increaseNumbers(-1, -1);
+
+  auto engine = _query->engine();
+
+  if (engine != nullptr && 
+      Transaction::_makeNolockHeaders != nullptr &&
+      Transaction::_makeNolockHeaders == engine->lockedShards()) {
+    Transaction::_makeNolockHeaders = nullptr;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
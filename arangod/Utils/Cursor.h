@@ -31,6 +31,7 @@
 #define ARANGODB_ARANGO_CURSOR_H 1
 
 #include "Basics/Common.h"
+#include "Aql/types.h"
 #include "Basics/StringBuffer.h"
 #include "VocBase/voc-types.h"
 
@@ -38,6 +39,11 @@ struct TRI_json_t;
 struct TRI_vocbase_t;
 
 namespace triagens {
+  namespace aql {
+    class AqlItemBlock;
+    class Query;
+  }
+
   namespace arango {
 
     class CollectionExport;
@@ -235,6 +241,86 @@ namespace triagens {
         size_t const                        _size;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class StreamCursor
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a cursor that keeps the query's execution engine alive and produces
+/// its results batch by batch, instead of materializing the full result
+////////////////////////////////////////////////////////////////////////////////
+    
+    class StreamCursor : public Cursor {
+      public:
+
+        StreamCursor (TRI_vocbase_t*,
+                      CursorId,
+                      triagens::aql::Query*,
+                      size_t,
+                      double);
+
+        ~StreamCursor ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+      public:
+
+        bool hasNext () override final;
+
+        struct TRI_json_t* next () override final;
+        
+        size_t count () const override final;
+
+        void dump (triagens::basics::StringBuffer&) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                           public static variables
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum ttl for streaming cursors. a streaming cursor keeps the
+/// query's transaction and collection locks while it is not fetched from, so
+/// this bounds the time an abandoned cursor can block writers
+////////////////////////////////////////////////////////////////////////////////
+
+        static double const MaxTtl;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+        bool fetch ();
+
+        void finish ();
+
+        void freeQuery ();
+
+        void attach ();
+
+        void detach ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+        TRI_vocbase_t*                      _vocbase;
+        triagens::aql::Query*               _query;
+        triagens::aql::AqlItemBlock*        _block;
+        size_t                              _blockPosition;
+        size_t                              _produced;
+        triagens::aql::RegisterId const     _resultRegister;
+        bool                                _done;
+        bool                                _attached;
+    };
+
   }
 }
 
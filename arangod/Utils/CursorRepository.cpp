@@ -28,6 +28,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils/CursorRepository.h"
+#include "Aql/Query.h"
 #include "Basics/json.h"
 #include "Basics/logging.h"
 #include "Basics/MutexLocker.h"
@@ -172,6 +173,40 @@ ExportCursor* CursorRepository::createFromExport (triagens::arango::CollectionEx
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a streaming cursor for a prepared query and stores it in 
+/// the registry
+////////////////////////////////////////////////////////////////////////////////
+
+StreamCursor* CursorRepository::createFromQuery (triagens::aql::Query* query,
+                                                 size_t batchSize,
+                                                 double ttl) {
+  TRI_ASSERT(query != nullptr);
+
+  CursorId const id = TRI_NewTickServer();
+  triagens::arango::StreamCursor* cursor = nullptr;
+
+  try {
+    cursor = new triagens::arango::StreamCursor(_vocbase, id, query, batchSize, ttl);
+  }
+  catch (...) {
+    delete query;
+    throw;
+  }
+
+  cursor->use();
+
+  try {
+    MUTEX_LOCKER(_lock);
+    _cursors.emplace(std::make_pair(id, cursor));
+    return cursor;
+  }
+  catch (...) {
+    delete cursor;
+    throw;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove a cursor by id
 ////////////////////////////////////////////////////////////////////////////////
@@ -96,6 +96,15 @@ namespace triagens {
                                         double, 
                                         bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a streaming cursor for a prepared query and stores it in 
+/// the registry. the cursor will take ownership of the query
+////////////////////////////////////////////////////////////////////////////////
+
+        StreamCursor* createFromQuery (triagens::aql::Query*,
+                                       size_t,
+                                       double);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove a cursor by id
 ////////////////////////////////////////////////////////////////////////////////
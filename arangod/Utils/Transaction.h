@@ -36,6 +36,7 @@
 #include "Basics/random.h"
 #include "Basics/tri-strings.h"
 #include "Cluster/ServerState.h"
+#include "Indexes/CapConstraint.h"
 #include "Indexes/PrimaryIndex.h"
 #include "Utils/CollectionNameResolver.h"
 #include "Utils/DocumentHelper.h"
@@ -568,6 +569,94 @@ namespace triagens {
           return res;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create multiple documents, using JSON
+///
+/// all documents are shaped first, and the collection is then write-locked
+/// only once for inserting all of them. the result code of each document is
+/// stored in results, which must have the same length as jsons. documents
+/// with a result code other than TRI_ERROR_NO_ERROR on entry are skipped.
+/// if stopOnError is set, no further documents will be inserted after the
+/// first failed one, as if the documents had been inserted one by one
+////////////////////////////////////////////////////////////////////////////////
+
+        int createBatch (TRI_transaction_collection_t* trxCollection,
+                         std::vector<TRI_json_t const*> const& jsons,
+                         std::vector<void const*> const& data,
+                         std::vector<TRI_doc_mptr_copy_t>& mptrs,
+                         std::vector<int>& results,
+                         bool stopOnError,
+                         bool forceSync) {
+
+          size_t n = jsons.size();
+
+          TRI_ASSERT(data.size() == n);
+          TRI_ASSERT(results.size() == n);
+
+          mptrs.resize(n);
+
+          auto shaper = this->shaper(trxCollection);
+          TRI_memory_zone_t* zone = shaper->memoryZone();
+
+          std::vector<TRI_voc_key_t> keys(n, nullptr);
+          std::vector<TRI_shaped_json_t*> shapes(n, nullptr);
+
+          auto freeShapes = [&] () -> void {
+            for (auto& it : shapes) {
+              if (it != nullptr) {
+                TRI_FreeShapedJson(zone, it);
+              }
+            }
+          };
+
+          int res = TRI_ERROR_NO_ERROR;
+
+          try {
+            // shape all documents first, without holding the collection lock
+            for (size_t i = 0; i < n; ++i) {
+              if (results[i] == TRI_ERROR_NO_ERROR) {
+                results[i] = DocumentHelper::getKey(jsons[i], &keys[i]);
+
+                if (results[i] == TRI_ERROR_NO_ERROR) {
+                  shapes[i] = TRI_ShapedJsonJson(shaper, jsons[i], true);
+
+                  if (shapes[i] == nullptr) {
+                    results[i] = TRI_ERROR_ARANGO_SHAPER_FAILED;
+                  }
+                }
+              }
+
+              if (results[i] != TRI_ERROR_NO_ERROR && stopOnError) {
+                break;
+              }
+            }
+
+            // now insert all documents with a single lock acquisition.
+            // documents that could not be shaped have no shape and are skipped
+            res = TRI_InsertShapedJsonDocumentCollectionBatch(trxCollection,
+                                                              keys,
+                                                              shapes,
+                                                              data,
+                                                              mptrs,
+                                                              results,
+                                                              stopOnError,
+                                                              ! isLocked(trxCollection, TRI_TRANSACTION_WRITE),
+                                                              forceSync);
+          }
+          catch (triagens::basics::Exception const& ex) {
+            freeShapes();
+            return ex.code();
+          }
+          catch (...) {
+            freeShapes();
+            return TRI_ERROR_INTERNAL;
+          }
+
+          freeShapes();
+
+          return res;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief update a single document, using JSON
 ////////////////////////////////////////////////////////////////////////////////
@@ -877,6 +966,13 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read master pointers in order of insertion/update
+///
+/// the order of insertion/update is the order of the documents' revisions. a
+/// non-negative offset counts from the oldest document, a negative one from
+/// the newest document (-1 being the newest). documents are returned in the
+/// order they are counted. a cap constraint keeps the documents ordered by
+/// revision anyway. without one, the primary index is scanned and only the
+/// offset + count wanted documents are kept in a heap
 ////////////////////////////////////////////////////////////////////////////////
 
         int readOrdered (TRI_transaction_collection_t* trxCollection,
@@ -896,47 +992,47 @@ namespace triagens {
             return TRI_ERROR_OUT_OF_MEMORY;
           }
 
-          TRI_doc_mptr_t* doc;
+          // number of documents to skip when reading from front or back
+          uint64_t const skip = static_cast<uint64_t>(offset >= 0 ? offset : - (offset + 1));
+          auto primaryIndex = document->primaryIndex();
 
-          if (offset >= 0) {
-            // read from front
-            doc = document->_headersPtr->front();  // PROTECTED by trx in trxCollection
-            int64_t i = 0;
+          if (count > 0 && skip < primaryIndex->size()) {
+            auto capConstraint = document->capConstraint();
 
-            while (doc != nullptr && i < offset) {
-              doc = doc->_next;
-              ++i;
-            }
+            try {
+              if (capConstraint != nullptr) {
+                auto const& revisions = capConstraint->revisions();
 
-            i = 0;
-            while (doc != nullptr && i < count) {
-              documents.emplace_back(*doc);
-              doc = doc->_next;
-              ++i;
-            }
-          }
-          else {
-            // read from back
-            doc = document->_headersPtr->back();  // PROTECTED by trx in trxCollection
-            int64_t i = -1;
+                if (offset >= 0) {
+                  auto it = revisions.begin();
+                  std::advance(it, skip);
 
-            while (doc != nullptr && i > offset) {
-              doc = doc->_prev;
-              --i;
-            }
+                  for (; it != revisions.end() && count > 0; ++it, --count) {
+                    documents.emplace_back(*(*it).second);
+                  }
+                }
+                else {
+                  auto it = revisions.rbegin();
+                  std::advance(it, skip);
 
-            i = 0;
-            while (doc != nullptr && i < count) {
-              documents.emplace_back(*doc);
-              doc = doc->_prev;
-              ++i;
+                  for (; it != revisions.rend() && count > 0; ++it, --count) {
+                    documents.emplace_back(*(*it).second);
+                  }
+                }
+              }
+              else {
+                readOrderedScan(primaryIndex, documents, offset >= 0, skip, static_cast<uint64_t>(count));
+              }
+            }
+            catch (...) {
+              res = TRI_ERROR_OUT_OF_MEMORY;
             }
           }
 
           this->unlock(trxCollection, TRI_TRANSACTION_READ);
           // READ-LOCK END
 
-          return TRI_ERROR_NO_ERROR;
+          return res;
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1189,6 +1285,60 @@ namespace triagens {
 
       private:
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read master pointers in order of insertion/update by scanning the
+/// primary index
+///
+/// only the skip + count oldest (or newest) documents are kept while
+/// scanning. the heap's top is the document that is dropped first when a
+/// better one is found
+////////////////////////////////////////////////////////////////////////////////
+
+        void readOrderedScan (triagens::arango::PrimaryIndex* primaryIndex,
+                              std::vector<TRI_doc_mptr_copy_t>& documents,
+                              bool fromOldest,
+                              uint64_t skip,
+                              uint64_t count) {
+          uint64_t const total = primaryIndex->size();
+          TRI_ASSERT(skip < total);
+
+          size_t const wanted = static_cast<size_t>(skip + (std::min)(count, total - skip));
+
+          auto isBefore = [fromOldest] (TRI_doc_mptr_t const* lhs, TRI_doc_mptr_t const* rhs) -> bool {
+            return (fromOldest ? lhs->_rid < rhs->_rid : lhs->_rid > rhs->_rid);
+          };
+
+          std::vector<TRI_doc_mptr_t*> heap;
+          heap.reserve(wanted);
+
+          triagens::basics::BucketPosition position;
+          uint64_t scanned = 0;
+
+          while (true) {
+            TRI_doc_mptr_t* mptr = primaryIndex->lookupSequential(position, scanned);
+
+            if (mptr == nullptr) {
+              break;
+            }
+
+            if (heap.size() < wanted) {
+              heap.emplace_back(mptr);
+              std::push_heap(heap.begin(), heap.end(), isBefore);
+            }
+            else if (isBefore(mptr, heap.front())) {
+              std::pop_heap(heap.begin(), heap.end(), isBefore);
+              heap.back() = mptr;
+              std::push_heap(heap.begin(), heap.end(), isBefore);
+            }
+          }
+
+          std::sort_heap(heap.begin(), heap.end(), isBefore);
+
+          for (size_t i = static_cast<size_t>(skip); i < heap.size(); ++i) {
+            documents.emplace_back(*heap[i]);
+          }
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief register an error for the transaction
 ////////////////////////////////////////////////////////////////////////////////
@@ -1741,6 +1741,13 @@ static TRI_doc_collection_info_t* GetFigures (TRI_vocbase_col_t* collection) {
 /// * *indexes.count*: The total number of indexes defined for the
 ///   collection, including the pre-defined indexes (e.g. primary index).
 /// * *indexes.size*: The total memory allocated for indexes in bytes.
+/// * *headers.count*: The number of document master pointers in use. There
+///   is one master pointer per document in memory, including documents that
+///   are contained in the write-ahead log only.
+/// * *headers.size*: The total memory reserved for master pointers in bytes.
+///   This includes memory for master pointers that are currently unused.
+/// * *headers.sizePerDocument*: The size of a single master pointer in bytes,
+///   i.e. the fixed memory overhead per document.
 /// * *maxTick*: The tick of the last marker that was stored in a journal
 ///   of the collection. This might be 0 if the collection does not yet have
 ///   a journal.
@@ -1860,6 +1867,12 @@ static void JS_FiguresVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& arg
   indexes->Set(TRI_V8_ASCII_STRING("count"),     v8::Number::New(isolate, (double) info->_numberIndexes));
   indexes->Set(TRI_V8_ASCII_STRING("size"),      v8::Number::New(isolate, (double) info->_sizeIndexes));
 
+  v8::Handle<v8::Object> headers = v8::Object::New(isolate);
+  result->Set(TRI_V8_ASCII_STRING("headers"),    headers);
+  headers->Set(TRI_V8_ASCII_STRING("count"),     v8::Number::New(isolate, (double) info->_numberHeaders));
+  headers->Set(TRI_V8_ASCII_STRING("size"),      v8::Number::New(isolate, (double) info->_sizeHeaders));
+  headers->Set(TRI_V8_ASCII_STRING("sizePerDocument"), v8::Number::New(isolate, (double) sizeof(TRI_doc_mptr_t)));
+
   result->Set(TRI_V8_ASCII_STRING("lastTick"),   V8TickId(isolate, info->_tickMax));
   result->Set(TRI_V8_ASCII_STRING("uncollectedLogfileEntries"), v8::Number::New(isolate, (double) info->_uncollectedLogfileEntries));
 
@@ -1519,6 +1519,8 @@ static void JS_QueriesCurrentAql (const v8::FunctionCallbackInfo<v8::Value>& arg
       obj->Set(TRI_V8_ASCII_STRING("query"), TRI_V8_STD_STRING(it.queryString));
       obj->Set(TRI_V8_ASCII_STRING("started"), TRI_V8_STD_STRING(timeString));
       obj->Set(TRI_V8_ASCII_STRING("runTime"), v8::Number::New(isolate, it.runTime));
+      obj->Set(TRI_V8_ASCII_STRING("memoryUsage"), v8::Number::New(isolate, static_cast<double>(it.memoryUsage)));
+      obj->Set(TRI_V8_ASCII_STRING("peakMemoryUsage"), v8::Number::New(isolate, static_cast<double>(it.peakMemoryUsage)));
    
       result->Set(i++, obj);
     }
@@ -1571,6 +1573,8 @@ static void JS_QueriesSlowAql (const v8::FunctionCallbackInfo<v8::Value>& args)
       obj->Set(TRI_V8_ASCII_STRING("query"), TRI_V8_STD_STRING(it.queryString));
       obj->Set(TRI_V8_ASCII_STRING("started"), TRI_V8_STD_STRING(timeString));
       obj->Set(TRI_V8_ASCII_STRING("runTime"), v8::Number::New(isolate, it.runTime));
+      obj->Set(TRI_V8_ASCII_STRING("memoryUsage"), v8::Number::New(isolate, static_cast<double>(it.memoryUsage)));
+      obj->Set(TRI_V8_ASCII_STRING("peakMemoryUsage"), v8::Number::New(isolate, static_cast<double>(it.peakMemoryUsage)));
    
       result->Set(i++, obj);
     }
@@ -0,0 +1,846 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection checkpoints
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2011-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include "Basics/win-utils.h"
+#endif
+
+#include "checkpoint.h"
+
+#include "Basics/conversions.h"
+#include "Basics/files.h"
+#include "Basics/hashes.h"
+#include "Basics/logging.h"
+#include "Basics/memory-map.h"
+#include "Basics/tri-strings.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash function for document keys
+////////////////////////////////////////////////////////////////////////////////
+
+struct CheckpointKeyHash {
+  size_t operator() (char const* key) const {
+    return static_cast<size_t>(TRI_FnvHashString(key));
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief comparison function for document keys
+////////////////////////////////////////////////////////////////////////////////
+
+struct CheckpointKeyEqual {
+  bool operator() (char const* lhs,
+                   char const* rhs) const {
+    return strcmp(lhs, rhs) == 0;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief surviving revision of a document while building a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct checkpoint_entry_s {
+  TRI_checkpoint_marker_t _marker;
+  int64_t                 _size;
+  size_t                  _datafile;
+}
+checkpoint_entry_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief state while building a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct checkpoint_state_s {
+  std::unordered_map<char const*, checkpoint_entry_t, CheckpointKeyHash, CheckpointKeyEqual> _documents;
+  std::vector<TRI_checkpoint_marker_t>   _shapes;
+  std::vector<TRI_checkpoint_datafile_t> _datafiles;
+  TRI_voc_tick_t                         _tickMax;
+  TRI_voc_rid_t                          _revision;
+  uint64_t                               _keyValue;
+}
+checkpoint_state_t;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the filename of a collection's checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+static char* CheckpointFilename (TRI_document_collection_t const* document) {
+  return TRI_Concatenate2File(document->_directory, TRI_CHECKPOINT_FILENAME);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the CRC of a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_crc_t CalculateCrcCheckpoint (char const* data,
+                                             size_t size) {
+  TRI_checkpoint_header_t header;
+  memcpy(&header, data, sizeof(TRI_checkpoint_header_t));
+  header._crc = 0;
+
+  TRI_voc_crc_t crc = TRI_InitialCrc32();
+  crc = TRI_BlockCrc32C(crc, reinterpret_cast<char const*>(&header), sizeof(TRI_checkpoint_header_t));
+  crc = TRI_BlockCrc32C(crc, data + sizeof(TRI_checkpoint_header_t), size - sizeof(TRI_checkpoint_header_t));
+
+  return TRI_FinalCrc32(crc);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief updates the tick values of a covered datafile
+///
+/// this mimics what loading the collection does to the datafile's ticks
+////////////////////////////////////////////////////////////////////////////////
+
+static void UpdateTicksCheckpoint (TRI_checkpoint_datafile_t* info,
+                                   TRI_df_marker_t const* marker) {
+  TRI_df_marker_type_t type = marker->_type;
+  TRI_voc_tick_t tick = marker->_tick;
+
+  if (type != TRI_DF_MARKER_HEADER &&
+      type != TRI_DF_MARKER_FOOTER &&
+      type != TRI_COL_MARKER_HEADER) {
+    if (info->_tickMin == 0) {
+      info->_tickMin = tick;
+    }
+
+    if (info->_tickMax < tick) {
+      info->_tickMax = tick;
+    }
+
+    if (type != TRI_DF_MARKER_ATTRIBUTE &&
+        type != TRI_DF_MARKER_SHAPE) {
+      if (info->_dataMin == 0) {
+        info->_dataMin = tick;
+      }
+
+      if (info->_dataMax < tick) {
+        info->_dataMax = tick;
+      }
+    }
+  }
+
+  if (type == TRI_DOC_MARKER_KEY_DOCUMENT ||
+      type == TRI_DOC_MARKER_KEY_EDGE) {
+    if (info->_dataMin == 0) {
+      info->_dataMin = tick;
+    }
+
+    if (info->_dataMax < tick) {
+      info->_dataMax = tick;
+    }
+  }
+
+  if (info->_tickMin == 0) {
+    info->_tickMin = tick;
+  }
+
+  if (info->_tickMax < tick) {
+    info->_tickMax = tick;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief notes the key and revision of a document or deletion marker
+////////////////////////////////////////////////////////////////////////////////
+
+static void TrackCheckpoint (checkpoint_state_t* state,
+                             char const* key,
+                             TRI_voc_rid_t rid) {
+  uint64_t value = TRI_UInt64String(key);
+
+  if (value > state->_keyValue) {
+    state->_keyValue = value;
+  }
+
+  if (rid > state->_revision) {
+    state->_revision = rid;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief marks a previously surviving revision as dead
+////////////////////////////////////////////////////////////////////////////////
+
+static void KillEntryCheckpoint (checkpoint_state_t* state,
+                                 checkpoint_entry_t const* entry) {
+  TRI_doc_datafile_info_t* dfi = &state->_datafiles[entry->_datafile]._dfi;
+
+  dfi->_numberAlive--;
+  dfi->_sizeAlive -= entry->_size;
+
+  dfi->_numberDead++;
+  dfi->_sizeDead += entry->_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fills an entry with the position, revision and key hash of a
+/// document or edge marker
+////////////////////////////////////////////////////////////////////////////////
+
+static void InitEntryCheckpoint (checkpoint_entry_t* entry,
+                                 TRI_datafile_t const* datafile,
+                                 char const* ptr,
+                                 char const* key,
+                                 int64_t size,
+                                 size_t position) {
+  auto d = reinterpret_cast<TRI_doc_document_key_marker_t const*>(ptr);
+
+  memset(&entry->_marker, 0, sizeof(TRI_checkpoint_marker_t));
+  entry->_marker._fid     = datafile->_fid;
+  entry->_marker._rid     = d->_rid;
+  entry->_marker._keyHash = TRI_FnvHashString(key);
+  entry->_marker._offset  = static_cast<TRI_voc_size_t>(ptr - datafile->_data);
+  entry->_marker._size    = d->base._size;
+  entry->_marker._type    = d->base._type;
+  entry->_size            = size;
+  entry->_datafile        = position;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scans a sealed datafile while building a checkpoint
+///
+/// this applies the same rules as loading the collection does. returns false
+/// if the datafile contains markers that prevent a checkpoint, i.e. markers of
+/// old-style transactions
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ScanDatafileCheckpoint (checkpoint_state_t* state,
+                                    TRI_datafile_t const* datafile,
+                                    size_t position) {
+  TRI_checkpoint_datafile_t* info = &state->_datafiles[position];
+  TRI_doc_datafile_info_t* dfi = &info->_dfi;
+
+  char const* ptr = datafile->_data;
+  char const* end = datafile->_data + datafile->_currentSize;
+
+  while (ptr < end) {
+    TRI_df_marker_t const* marker = reinterpret_cast<TRI_df_marker_t const*>(ptr);
+
+    if (marker->_size == 0) {
+      break;
+    }
+
+    int64_t const size = static_cast<int64_t>(TRI_DF_ALIGN_BLOCK(marker->_size));
+    TRI_df_marker_type_t const type = marker->_type;
+
+    UpdateTicksCheckpoint(info, marker);
+
+    if (type != TRI_DF_MARKER_HEADER &&
+        type != TRI_DF_MARKER_FOOTER &&
+        type != TRI_COL_MARKER_HEADER &&
+        marker->_tick > state->_tickMax) {
+      state->_tickMax = marker->_tick;
+    }
+
+    if (type == TRI_DOC_MARKER_KEY_DOCUMENT ||
+        type == TRI_DOC_MARKER_KEY_EDGE) {
+      auto d = reinterpret_cast<TRI_doc_document_key_marker_t const*>(marker);
+
+      if (d->_tid > 0) {
+        return false;
+      }
+
+      char const* key = reinterpret_cast<char const*>(d) + d->_offsetKey;
+      TrackCheckpoint(state, key, d->_rid);
+
+      auto it = state->_documents.find(key);
+
+      if (it == state->_documents.end()) {
+        // new document
+        checkpoint_entry_t entry;
+        InitEntryCheckpoint(&entry, datafile, ptr, key, size, position);
+
+        state->_documents.emplace(key, entry);
+
+        dfi->_numberAlive++;
+        dfi->_sizeAlive += size;
+      }
+      else if ((*it).second._marker._rid < d->_rid ||
+               ((*it).second._marker._rid == d->_rid && (*it).second._marker._fid <= datafile->_fid)) {
+        // update
+        checkpoint_entry_t& entry = (*it).second;
+        KillEntryCheckpoint(state, &entry);
+
+        InitEntryCheckpoint(&entry, datafile, ptr, key, size, position);
+
+        dfi->_numberAlive++;
+        dfi->_sizeAlive += size;
+      }
+      else {
+        // stale update
+        dfi->_numberDead++;
+        dfi->_sizeDead += (*it).second._size;
+      }
+    }
+    else if (type == TRI_DOC_MARKER_KEY_DELETION) {
+      auto d = reinterpret_cast<TRI_doc_deletion_key_marker_t const*>(marker);
+
+      if (d->_tid > 0) {
+        return false;
+      }
+
+      char const* key = reinterpret_cast<char const*>(d) + d->_offsetKey;
+      TrackCheckpoint(state, key, d->_rid);
+
+      auto it = state->_documents.find(key);
+
+      if (it != state->_documents.end()) {
+        KillEntryCheckpoint(state, &(*it).second);
+        state->_documents.erase(it);
+      }
+
+      dfi->_numberDeletion++;
+    }
+    else if (type == TRI_DF_MARKER_SHAPE ||
+             type == TRI_DF_MARKER_ATTRIBUTE) {
+      TRI_checkpoint_marker_t shape;
+      memset(&shape, 0, sizeof(TRI_checkpoint_marker_t));
+      shape._fid    = datafile->_fid;
+      shape._offset = static_cast<TRI_voc_size_t>(ptr - datafile->_data);
+      shape._size   = marker->_size;
+      shape._type   = type;
+
+      state->_shapes.emplace_back(shape);
+
+      if (type == TRI_DF_MARKER_SHAPE) {
+        dfi->_numberShapes++;
+        dfi->_sizeShapes += size;
+      }
+      else {
+        dfi->_numberAttributes++;
+        dfi->_sizeAttributes += size;
+      }
+    }
+    else if (type == TRI_DOC_MARKER_BEGIN_TRANSACTION ||
+             type == TRI_DOC_MARKER_COMMIT_TRANSACTION ||
+             type == TRI_DOC_MARKER_PREPARE_TRANSACTION ||
+             type == TRI_DOC_MARKER_ABORT_TRANSACTION) {
+      return false;
+    }
+
+    ptr += size;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of leading datafiles that are covered unchanged
+/// by a previous checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t MatchDatafilesCheckpoint (TRI_checkpoint_t const* previous,
+                                        std::vector<TRI_datafile_t*> const& datafiles) {
+  uint64_t const n = previous->_header->_numberDatafiles;
+  size_t i = 0;
+
+  while (i < datafiles.size() && i < n) {
+    TRI_checkpoint_datafile_t const* info = &previous->_datafiles[i];
+    TRI_datafile_t const* df = datafiles[i];
+
+    if (df->_fid != info->_fid ||
+        df->_currentSize != info->_currentSize ||
+        TRI_FooterTickCheckpointDatafile(df) != info->_footerTick) {
+      break;
+    }
+
+    ++i;
+  }
+
+  return i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collects the key hashes of all document and deletion markers of a
+/// sealed datafile
+////////////////////////////////////////////////////////////////////////////////
+
+static void CollectKeysCheckpoint (std::unordered_set<uint64_t>& keys,
+                                   TRI_datafile_t const* datafile) {
+  char const* ptr = datafile->_data;
+  char const* end = datafile->_data + datafile->_currentSize;
+
+  while (ptr < end) {
+    TRI_df_marker_t const* marker = reinterpret_cast<TRI_df_marker_t const*>(ptr);
+
+    if (marker->_size == 0) {
+      break;
+    }
+
+    if (marker->_type == TRI_DOC_MARKER_KEY_DOCUMENT ||
+        marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
+      auto d = reinterpret_cast<TRI_doc_document_key_marker_t const*>(marker);
+      keys.emplace(TRI_FnvHashString(reinterpret_cast<char const*>(d) + d->_offsetKey));
+    }
+    else if (marker->_type == TRI_DOC_MARKER_KEY_DELETION) {
+      auto d = reinterpret_cast<TRI_doc_deletion_key_marker_t const*>(marker);
+      keys.emplace(TRI_FnvHashString(reinterpret_cast<char const*>(d) + d->_offsetKey));
+    }
+
+    ptr += TRI_DF_ALIGN_BLOCK(marker->_size);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief re-uses the part of the previous checkpoint that covers the first
+/// datafiles
+///
+/// the datafile statistics and the markers of these datafiles are taken over
+/// unchanged, except for the documents whose keys show up in the datafiles
+/// that still need to be scanned. these are put into the state, so that
+/// scanning the newer datafiles can update or remove them exactly as a full
+/// scan would. all other markers are appended to kept, in their original
+/// order. returns false if the previous checkpoint cannot be used
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ReuseCheckpoint (checkpoint_state_t* state,
+                             TRI_checkpoint_t const* previous,
+                             std::vector<TRI_datafile_t*> const& datafiles,
+                             size_t reused,
+                             std::vector<TRI_checkpoint_marker_t>& kept) {
+  std::unordered_set<uint64_t> keys;
+
+  for (size_t i = reused; i < datafiles.size(); ++i) {
+    CollectKeysCheckpoint(keys, datafiles[i]);
+  }
+
+  state->_datafiles.insert(state->_datafiles.end(), previous->_datafiles, previous->_datafiles + reused);
+
+  // the high-water marks may include markers of datafiles that were compacted
+  // since. they can only be too high, which is what loading all datafiles
+  // would have seen before the compaction, too
+  state->_tickMax  = previous->_header->_tickMax;
+  state->_revision = previous->_header->_revision;
+  state->_keyValue = previous->_header->_keyValue;
+
+  TRI_voc_fid_t const lastFid = datafiles[reused - 1]->_fid;
+  size_t position = 0;
+
+  for (uint64_t i = 0; i < previous->_header->_numberMarkers; ++i) {
+    TRI_checkpoint_marker_t const* m = &previous->_markers[i];
+
+    if (m->_fid > lastFid) {
+      // markers are sorted by fid, all others belong to datafiles we rescan
+      break;
+    }
+
+    if (m->_type == TRI_DF_MARKER_SHAPE ||
+        m->_type == TRI_DF_MARKER_ATTRIBUTE ||
+        keys.find(m->_keyHash) == keys.end()) {
+      kept.emplace_back(*m);
+      continue;
+    }
+
+    while (position < reused && datafiles[position]->_fid != m->_fid) {
+      ++position;
+    }
+
+    if (position == reused ||
+        m->_offset + sizeof(TRI_doc_document_key_marker_t) > datafiles[position]->_currentSize) {
+      return false;
+    }
+
+    auto d = reinterpret_cast<TRI_doc_document_key_marker_t const*>(datafiles[position]->_data + m->_offset);
+
+    if (d->base._type != m->_type ||
+        d->base._size != m->_size ||
+        d->_rid != m->_rid) {
+      return false;
+    }
+
+    checkpoint_entry_t entry;
+    entry._marker   = *m;
+    entry._size     = static_cast<int64_t>(TRI_DF_ALIGN_BLOCK(m->_size));
+    entry._datafile = position;
+
+    state->_documents.emplace(reinterpret_cast<char const*>(d) + d->_offsetKey, entry);
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes a checkpoint for the sealed datafiles of a collection
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_WriteCheckpointDocumentCollection (TRI_document_collection_t* document) {
+  std::vector<TRI_datafile_t*> datafiles;
+
+  TRI_READ_LOCK_DATAFILES_DOC_COLLECTION(document);
+
+  // a pending compaction result will replace one of the datafiles
+  bool usable = (document->_compactors._length == 0);
+
+  for (size_t i = 0;  usable && i < document->_datafiles._length;  ++i) {
+    auto df = static_cast<TRI_datafile_t*>(document->_datafiles._buffer[i]);
+
+    if (! df->isPhysical(df) ||
+        ! df->_isSealed ||
+        TRI_FooterTickCheckpointDatafile(df) == 0) {
+      usable = false;
+    }
+    else {
+      datafiles.emplace_back(df);
+    }
+  }
+
+  TRI_READ_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+
+  if (! usable ||
+      datafiles.empty() ||
+      datafiles.back()->_fid == document->_checkpointFid) {
+    // nothing to do
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  TRI_voc_fid_t const lastFid = datafiles.back()->_fid;
+  double start = TRI_microtime();
+
+  // calculate the state of the collection after loading the sealed datafiles.
+  // the datafiles cannot go away while we are working on them because the
+  // caller holds the collection's status lock, and only the compactor thread
+  // (which is us) modifies sealed datafiles
+  checkpoint_state_t state;
+  state._tickMax  = 0;
+  state._revision = 0;
+  state._keyValue = 0;
+
+  // markers taken over from the previous checkpoint, sorted
+  std::vector<TRI_checkpoint_marker_t> kept;
+  size_t reused = 0;
+
+  try {
+    state._datafiles.reserve(datafiles.size());
+
+    // start from the previous checkpoint for the datafiles that did not change
+    TRI_checkpoint_t* previous = TRI_OpenCheckpointDocumentCollection(document);
+
+    if (previous != nullptr) {
+      reused = MatchDatafilesCheckpoint(previous, datafiles);
+      bool reusable = false;
+
+      try {
+        reusable = (reused > 0 && ReuseCheckpoint(&state, previous, datafiles, reused, kept));
+      }
+      catch (...) {
+        TRI_CloseCheckpoint(previous);
+        throw;
+      }
+
+      if (reused > 0 && ! reusable) {
+        LOG_DEBUG("ignoring previous checkpoint of collection '%s'", document->_info._name);
+
+        state._documents.clear();
+        state._datafiles.clear();
+        state._tickMax  = 0;
+        state._revision = 0;
+        state._keyValue = 0;
+        kept.clear();
+        reused = 0;
+      }
+
+      TRI_CloseCheckpoint(previous);
+    }
+
+    for (size_t i = reused; i < datafiles.size(); ++i) {
+      TRI_datafile_t const* df = datafiles[i];
+
+      TRI_checkpoint_datafile_t info;
+      memset(&info, 0, sizeof(TRI_checkpoint_datafile_t));
+      info._fid          = df->_fid;
+      info._footerTick   = TRI_FooterTickCheckpointDatafile(df);
+      info._currentSize  = df->_currentSize;
+      info._dfi._fid     = df->_fid;
+
+      state._datafiles.emplace_back(info);
+
+      if (! ScanDatafileCheckpoint(&state, df, i)) {
+        // datafiles contain transaction markers of an old version.
+        // we'll not try again until there is another datafile
+        LOG_DEBUG("not writing checkpoint for collection '%s' because of legacy transaction markers",
+                  document->_info._name);
+
+        document->_checkpointFid = lastFid;
+        return TRI_ERROR_NO_ERROR;
+      }
+    }
+  }
+  catch (...) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  // collect and sort all markers so that loading accesses them sequentially.
+  // the markers taken over from the previous checkpoint are sorted already
+  auto compare = [] (TRI_checkpoint_marker_t const& lhs, TRI_checkpoint_marker_t const& rhs) {
+    if (lhs._fid != rhs._fid) {
+      return lhs._fid < rhs._fid;
+    }
+    return lhs._offset < rhs._offset;
+  };
+
+  std::vector<TRI_checkpoint_marker_t> markers;
+
+  try {
+    std::vector<TRI_checkpoint_marker_t> scanned;
+    scanned.reserve(state._documents.size() + state._shapes.size());
+    scanned.insert(scanned.end(), state._shapes.begin(), state._shapes.end());
+
+    for (auto const& it : state._documents) {
+      scanned.emplace_back(it.second._marker);
+    }
+
+    std::sort(scanned.begin(), scanned.end(), compare);
+
+    markers.reserve(kept.size() + scanned.size());
+    std::merge(kept.begin(), kept.end(), scanned.begin(), scanned.end(), std::back_inserter(markers), compare);
+  }
+  catch (...) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  // serialize the checkpoint
+  TRI_checkpoint_header_t header;
+  memset(&header, 0, sizeof(TRI_checkpoint_header_t));
+  header._magic           = TRI_CHECKPOINT_MAGIC;
+  header._version         = TRI_CHECKPOINT_VERSION;
+  header._cid             = document->_info._cid;
+  header._tickMax         = state._tickMax;
+  header._revision        = state._revision;
+  header._keyValue        = state._keyValue;
+  header._numberDatafiles = static_cast<uint64_t>(state._datafiles.size());
+  header._numberMarkers   = static_cast<uint64_t>(markers.size());
+
+  size_t const size = sizeof(TRI_checkpoint_header_t) +
+                      state._datafiles.size() * sizeof(TRI_checkpoint_datafile_t) +
+                      markers.size() * sizeof(TRI_checkpoint_marker_t);
+
+  char* data = static_cast<char*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, size, false));
+
+  if (data == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  char* ptr = data;
+  memcpy(ptr, &header, sizeof(TRI_checkpoint_header_t));
+  ptr += sizeof(TRI_checkpoint_header_t);
+  memcpy(ptr, state._datafiles.data(), state._datafiles.size() * sizeof(TRI_checkpoint_datafile_t));
+  ptr += state._datafiles.size() * sizeof(TRI_checkpoint_datafile_t);
+
+  if (! markers.empty()) {
+    memcpy(ptr, markers.data(), markers.size() * sizeof(TRI_checkpoint_marker_t));
+  }
+
+  reinterpret_cast<TRI_checkpoint_header_t*>(data)->_crc = CalculateCrcCheckpoint(data, size);
+
+  // write to a temporary file first and then move it in place, so there is
+  // never a partially written checkpoint
+  char* filename = CheckpointFilename(document);
+  char* tmpname = TRI_Concatenate2String(filename, ".tmp");
+
+  if (TRI_ExistsFile(tmpname)) {
+    TRI_UnlinkFile(tmpname);
+  }
+
+  int res = TRI_WriteFile(tmpname, data, size);
+
+  TRI_Free(TRI_UNKNOWN_MEM_ZONE, data);
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    res = TRI_RenameFile(tmpname, filename);
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_UnlinkFile(tmpname);
+
+    LOG_WARNING("cannot write checkpoint '%s': %s", filename, TRI_errno_string(res));
+  }
+  else {
+    document->_checkpointFid = lastFid;
+
+    LOG_TIMER((TRI_microtime() - start),
+              "write-checkpoint { collection: %s/%s }, datafiles: %llu, scanned: %llu, markers: %llu",
+              document->_vocbase->_name,
+              document->_info._name,
+              (unsigned long long) header._numberDatafiles,
+              (unsigned long long) (datafiles.size() - reused),
+              (unsigned long long) header._numberMarkers);
+  }
+
+  TRI_FreeString(TRI_CORE_MEM_ZONE, tmpname);
+  TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maps the checkpoint of a collection into memory
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_checkpoint_t* TRI_OpenCheckpointDocumentCollection (TRI_document_collection_t* document) {
+  TRI_ERRORBUF;
+
+  char* filename = CheckpointFilename(document);
+
+  if (! TRI_ExistsFile(filename)) {
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+    return nullptr;
+  }
+
+  int fd = TRI_OPEN(filename, O_RDONLY);
+
+  if (fd < 0) {
+    TRI_SYSTEM_ERROR();
+    LOG_WARNING("cannot open checkpoint '%s': %s", filename, TRI_GET_ERRORBUF);
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+    return nullptr;
+  }
+
+  TRI_stat_t status;
+
+  if (TRI_FSTAT(fd, &status) < 0 ||
+      static_cast<size_t>(status.st_size) < sizeof(TRI_checkpoint_header_t)) {
+    LOG_WARNING("ignoring invalid checkpoint '%s'", filename);
+    TRI_CLOSE(fd);
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+    return nullptr;
+  }
+
+  size_t const size = static_cast<size_t>(status.st_size);
+  void* mmHandle;
+  void* data;
+
+  int res = TRI_MMFile(0, size, PROT_READ, MAP_SHARED, fd, &mmHandle, 0, &data);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    LOG_WARNING("cannot memory map checkpoint '%s': %s", filename, TRI_errno_string(res));
+    TRI_CLOSE(fd);
+    TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+    return nullptr;
+  }
+
+  auto header = static_cast<TRI_checkpoint_header_t const*>(data);
+  bool valid = (header->_magic == TRI_CHECKPOINT_MAGIC &&
+                header->_version == TRI_CHECKPOINT_VERSION &&
+                header->_cid == document->_info._cid &&
+                header->_numberDatafiles > 0 &&
+                size == sizeof(TRI_checkpoint_header_t) +
+                        header->_numberDatafiles * sizeof(TRI_checkpoint_datafile_t) +
+                        header->_numberMarkers * sizeof(TRI_checkpoint_marker_t));
+
+  if (valid &&
+      header->_crc != CalculateCrcCheckpoint(static_cast<char const*>(data), size)) {
+    valid = false;
+  }
+
+  TRI_checkpoint_t* checkpoint = nullptr;
+
+  if (valid) {
+    checkpoint = static_cast<TRI_checkpoint_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, sizeof(TRI_checkpoint_t), false));
+  }
+  else {
+    LOG_WARNING("ignoring invalid checkpoint '%s'", filename);
+  }
+
+  TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+
+  if (checkpoint == nullptr) {
+    TRI_UNMMFile(data, size, fd, &mmHandle);
+    TRI_CLOSE(fd);
+
+    return nullptr;
+  }
+
+  checkpoint->_fd        = fd;
+  checkpoint->_mmHandle  = mmHandle;
+  checkpoint->_data      = static_cast<char*>(data);
+  checkpoint->_size      = size;
+  checkpoint->_header    = header;
+  checkpoint->_datafiles = reinterpret_cast<TRI_checkpoint_datafile_t const*>(checkpoint->_data + sizeof(TRI_checkpoint_header_t));
+  checkpoint->_markers   = reinterpret_cast<TRI_checkpoint_marker_t const*>(checkpoint->_datafiles + header->_numberDatafiles);
+
+  TRI_MMFileAdvise(checkpoint->_data, size, TRI_MADVISE_SEQUENTIAL);
+
+  return checkpoint;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unmaps and frees a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_CloseCheckpoint (TRI_checkpoint_t* checkpoint) {
+  TRI_UNMMFile(checkpoint->_data, checkpoint->_size, checkpoint->_fd, &checkpoint->_mmHandle);
+  TRI_CLOSE(checkpoint->_fd);
+
+  TRI_Free(TRI_UNKNOWN_MEM_ZONE, checkpoint);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the footer tick of a sealed datafile
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_tick_t TRI_FooterTickCheckpointDatafile (TRI_datafile_t const* datafile) {
+  size_t const footerSize = TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_footer_marker_t));
+
+  if (! datafile->_isSealed ||
+      datafile->_currentSize < footerSize) {
+    return 0;
+  }
+
+  auto footer = reinterpret_cast<TRI_df_marker_t const*>(datafile->_data + datafile->_currentSize - footerSize);
+
+  if (footer->_type != TRI_DF_MARKER_FOOTER) {
+    return 0;
+  }
+
+  return footer->_tick;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection checkpoints
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2011-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_VOC_BASE_CHECKPOINT_H
+#define ARANGODB_VOC_BASE_CHECKPOINT_H 1
+
+#include "Basics/Common.h"
+
+#include "VocBase/datafile.h"
+#include "VocBase/document-collection.h"
+#include "VocBase/voc-types.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief name of the checkpoint file in the collection directory
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_CHECKPOINT_FILENAME "checkpoint.db"
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief magic value at the start of a checkpoint file
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_CHECKPOINT_MAGIC (0x50434b41)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief current checkpoint file format version
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_CHECKPOINT_VERSION (3)
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                      public types
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checkpoint file header
+///
+/// A checkpoint file consists of the header, followed by one
+/// TRI_checkpoint_datafile_t per covered datafile and one
+/// TRI_checkpoint_marker_t per marker that is still relevant when the
+/// collection is loaded. The CRC is a CRC32C over the complete file, computed
+/// with the _crc attribute set to 0.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_checkpoint_header_s {
+  uint32_t         _magic;            //  4 bytes
+  uint32_t         _version;          //  4 bytes
+  TRI_voc_cid_t    _cid;              //  8 bytes
+  TRI_voc_tick_t   _tickMax;          //  8 bytes
+  TRI_voc_rid_t    _revision;         //  8 bytes
+  uint64_t         _keyValue;         //  8 bytes
+  uint64_t         _numberDatafiles;  //  8 bytes
+  uint64_t         _numberMarkers;    //  8 bytes
+  TRI_voc_crc_t    _crc;              //  4 bytes
+  uint32_t         _padding;          //  4 bytes
+}
+TRI_checkpoint_header_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a datafile covered by a checkpoint
+///
+/// the footer tick identifies the physical file, as compaction results re-use
+/// the fid of the original datafile
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_checkpoint_datafile_s {
+  TRI_voc_fid_t            _fid;
+  TRI_voc_tick_t           _footerTick;
+  TRI_voc_tick_t           _tickMin;
+  TRI_voc_tick_t           _tickMax;
+  TRI_voc_tick_t           _dataMin;
+  TRI_voc_tick_t           _dataMax;
+  TRI_voc_size_t           _currentSize;
+  uint32_t                 _padding;
+  TRI_doc_datafile_info_t  _dfi;
+}
+TRI_checkpoint_datafile_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a marker referenced by a checkpoint
+///
+/// this is either the surviving revision of a document or edge, or a shape
+/// or attribute marker. the revision, the key hash (as used by the primary
+/// index) and the marker size are copied from the marker, so loading can
+/// create the master pointers and the primary index without reading the
+/// document markers. for shape and attribute markers, the revision and key
+/// hash are 0
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_checkpoint_marker_s {
+  TRI_voc_fid_t            _fid;      //  8 bytes
+  TRI_voc_rid_t            _rid;      //  8 bytes
+  uint64_t                 _keyHash;  //  8 bytes
+  TRI_voc_size_t           _offset;   //  4 bytes
+  TRI_voc_size_t           _size;     //  4 bytes
+  TRI_df_marker_type_t     _type;     //  4 bytes
+  uint32_t                 _padding;  //  4 bytes
+}
+TRI_checkpoint_marker_t;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a memory-mapped checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_checkpoint_s {
+  int                              _fd;
+  void*                            _mmHandle;
+  char*                            _data;
+  size_t                           _size;
+
+  TRI_checkpoint_header_t const*   _header;
+  TRI_checkpoint_datafile_t const* _datafiles;
+  TRI_checkpoint_marker_t const*   _markers;
+}
+TRI_checkpoint_t;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes a checkpoint for the sealed datafiles of a collection
+///
+/// the checkpoint is calculated from the sealed datafiles, independent of the
+/// in-memory state of the collection. the part of the previous checkpoint that
+/// covers unchanged datafiles is re-used, so only datafiles that were sealed
+/// or compacted since then are scanned. it must be called by the compactor
+/// thread only, while it holds the collection's compaction lock
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_WriteCheckpointDocumentCollection (TRI_document_collection_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maps the checkpoint of a collection into memory
+///
+/// returns nullptr if there is no checkpoint or if it is invalid. this only
+/// validates the checkpoint file itself, not the datafiles it refers to
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_checkpoint_t* TRI_OpenCheckpointDocumentCollection (TRI_document_collection_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unmaps and frees a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_CloseCheckpoint (TRI_checkpoint_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the footer tick of a sealed datafile, or 0 if the datafile
+/// has no footer
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_tick_t TRI_FooterTickCheckpointDatafile (TRI_datafile_t const*);
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
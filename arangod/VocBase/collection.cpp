@@ -38,6 +38,7 @@
 #include "Basics/logging.h"
 #include "Basics/tri-strings.h"
 #include "Basics/memory-map.h"
+#include "Basics/ThreadPool.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/server.h"
 #include "VocBase/vocbase.h"
@@ -427,6 +428,9 @@ static bool CheckCollection (TRI_collection_t* collection,
   regex_t re;
   size_t i, n;
 
+  // datafiles to open, together with the type from their filename
+  std::vector<std::pair<std::string, std::string>> toOpen;
+
   if (regcomp(&re, "^(temp|compaction|journal|datafile|index|compactor)-([0-9][0-9]*)\\.(db|json)(\\.dead)?$", REG_EXTENDED) != 0) {
     LOG_ERROR("unable to compile regular expression");
 
@@ -484,13 +488,11 @@ static bool CheckCollection (TRI_collection_t* collection,
       }
 
       // .............................................................................
-      // file is a journal or datafile, open the datafile
+      // file is a journal or datafile, remember it for opening
       // .............................................................................
 
       else if (TRI_EqualString2("db", third, thirdLen)) {
         char* filename;
-        char* ptr;
-        TRI_col_header_marker_t* cm;
 
         if (TRI_EqualString2("compaction", first, firstLen)) {
           // found a compaction file. now rename it back
@@ -535,95 +537,141 @@ static bool CheckCollection (TRI_collection_t* collection,
         }
 
         TRI_ASSERT(filename != nullptr);
-        datafile = TRI_OpenDatafile(filename, ignoreErrors);
+        toOpen.emplace_back(std::string(filename), std::string(first, firstLen));
+        TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+      }
+      else {
+        LOG_ERROR("unknown datafile '%s'", file);
+      }
+    }
+  }
 
-        if (datafile == nullptr) {
-          collection->_lastError = TRI_errno();
-          LOG_ERROR("cannot open datafile '%s': %s", filename, TRI_last_error());
+  TRI_DestroyVectorString(&files);
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+  regfree(&re);
 
-        TRI_PushBackVectorPointer(&all, datafile);
+  // open the datafiles. opening a datafile checks all markers in it, which is
+  // the expensive part of loading a collection. the datafiles are independent
+  // of each other, so they are opened in parallel if the server has an index
+  // thread pool
+  size_t const numFiles = toOpen.size();
+  std::vector<TRI_datafile_t*> opened(numFiles, nullptr);
+  std::vector<int> errors(numFiles, TRI_ERROR_NO_ERROR);
 
-        // check the document header
-        ptr  = datafile->_data;
-        // skip the datafile header
-        ptr += TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_header_marker_t));
-        cm   = (TRI_col_header_marker_t*) ptr;
+  if (! stop) {
+    auto openDatafile = [&toOpen, &opened, &errors, ignoreErrors] (size_t pos) -> void {
+      opened[pos] = TRI_OpenDatafile(toOpen[pos].first.c_str(), ignoreErrors);
 
-        if (cm->base._type != TRI_COL_MARKER_HEADER) {
-          LOG_ERROR("collection header mismatch in file '%s', expected TRI_COL_MARKER_HEADER, found %lu",
-                    filename,
-                    (unsigned long) cm->base._type);
+      if (opened[pos] == nullptr) {
+        // TRI_errno() is thread-local
+        errors[pos] = TRI_errno();
+      }
+    };
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+    triagens::basics::ThreadPool* pool = nullptr;
 
-        if (cm->_cid != collection->_info._cid) {
-          LOG_ERROR("collection identifier mismatch, expected %llu, found %llu",
-                    (unsigned long long) collection->_info._cid,
-                    (unsigned long long) cm->_cid);
+    if (collection->_vocbase != nullptr && collection->_vocbase->_server != nullptr) {
+      pool = collection->_vocbase->_server->_indexPool;
+    }
 
-          TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-          stop = true;
-          break;
-        }
+    if (pool != nullptr && numFiles > 1) {
+      pool->parallelFor(numFiles, openDatafile);
+    }
+    else {
+      for (i = 0;  i < numFiles;  ++i) {
+        openDatafile(i);
+      }
+    }
+  }
 
-        // file is a journal
-        if (TRI_EqualString2("journal", first, firstLen)) {
-          if (datafile->_isSealed) {
-            if (datafile->_state != TRI_DF_STATE_READ) {
-              LOG_WARNING("strange, journal '%s' is already sealed; must be a left over; will use it as datafile", filename);
-            }
+  // check and classify the opened datafiles in directory order
+  for (i = 0;  i < numFiles;  ++i) {
+    char const* filename = toOpen[i].first.c_str();
+    char const* first = toOpen[i].second.c_str();
+    size_t firstLen = toOpen[i].second.size();
+    char* ptr;
+    TRI_col_header_marker_t* cm;
 
-            TRI_PushBackVectorPointer(&sealed, datafile);
-          }
-          else {
-            TRI_PushBackVectorPointer(&journals, datafile);
-          }
-        }
+    datafile = opened[i];
 
-        // file is a compactor
-        else if (TRI_EqualString2("compactor", first, firstLen)) {
-          // ignore
-        }
+    if (datafile == nullptr) {
+      if (! stop) {
+        collection->_lastError = TRI_set_errno(errors[i]);
+        LOG_ERROR("cannot open datafile '%s': %s", filename, TRI_errno_string(errors[i]));
+        stop = true;
+      }
+      continue;
+    }
 
-        // file is a datafile (or was a compaction file)
-        else if (TRI_EqualString2("datafile", first, firstLen) ||
-                 TRI_EqualString2("compaction", first, firstLen)) {
-          if (! datafile->_isSealed) {
-            LOG_ERROR("datafile '%s' is not sealed, this should never happen", filename);
+    // all opened datafiles must be closed again if we stop
+    TRI_PushBackVectorPointer(&all, datafile);
 
-            collection->_lastError = TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
-            TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
-            stop = true;
-            break;
-          }
-          else {
-            TRI_PushBackVectorPointer(&datafiles, datafile);
-          }
-        }
+    if (stop) {
+      continue;
+    }
 
-        else {
-          LOG_ERROR("unknown datafile '%s'", file);
+    // check the document header
+    ptr  = datafile->_data;
+    // skip the datafile header
+    ptr += TRI_DF_ALIGN_BLOCK(sizeof(TRI_df_header_marker_t));
+    cm   = (TRI_col_header_marker_t*) ptr;
+
+    if (cm->base._type != TRI_COL_MARKER_HEADER) {
+      LOG_ERROR("collection header mismatch in file '%s', expected TRI_COL_MARKER_HEADER, found %lu",
+                filename,
+                (unsigned long) cm->base._type);
+
+      stop = true;
+      continue;
+    }
+
+    if (cm->_cid != collection->_info._cid) {
+      LOG_ERROR("collection identifier mismatch, expected %llu, found %llu",
+                (unsigned long long) collection->_info._cid,
+                (unsigned long long) cm->_cid);
+
+      stop = true;
+      continue;
+    }
+
+    // file is a journal
+    if (TRI_EqualString2("journal", first, firstLen)) {
+      if (datafile->_isSealed) {
+        if (datafile->_state != TRI_DF_STATE_READ) {
+          LOG_WARNING("strange, journal '%s' is already sealed; must be a left over; will use it as datafile", filename);
         }
 
-        TRI_FreeString(TRI_CORE_MEM_ZONE, filename);
+        TRI_PushBackVectorPointer(&sealed, datafile);
       }
       else {
-        LOG_ERROR("unknown datafile '%s'", file);
+        TRI_PushBackVectorPointer(&journals, datafile);
       }
     }
-  }
 
-  TRI_DestroyVectorString(&files);
+    // file is a compactor
+    else if (TRI_EqualString2("compactor", first, firstLen)) {
+      // ignore
+    }
 
-  regfree(&re);
+    // file is a datafile (or was a compaction file)
+    else if (TRI_EqualString2("datafile", first, firstLen) ||
+             TRI_EqualString2("compaction", first, firstLen)) {
+      if (! datafile->_isSealed) {
+        LOG_ERROR("datafile '%s' is not sealed, this should never happen", filename);
+
+        collection->_lastError = TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
+        stop = true;
+        continue;
+      }
+      else {
+        TRI_PushBackVectorPointer(&datafiles, datafile);
+      }
+    }
+
+    else {
+      LOG_ERROR("unknown datafile '%s'", filename);
+    }
+  }
 
   // convert the sealed journals into datafiles
   if (! stop) {
@@ -723,6 +771,7 @@ static void FreeDatafilesVector (TRI_vector_pointer_t* const vector) {
 ////////////////////////////////////////////////////////////////////////////////
 
 static bool IterateDatafilesVector (const TRI_vector_pointer_t* const files,
+                                    TRI_voc_fid_t skipFid,
                                     bool (*iterator)(TRI_df_marker_t const*, void*, TRI_datafile_t*),
                                     void* data) {
   TRI_ASSERT(iterator != nullptr);
@@ -732,6 +781,10 @@ static bool IterateDatafilesVector (const TRI_vector_pointer_t* const files,
   for (size_t i = 0;  i < n;  ++i) {
     TRI_datafile_t* datafile = static_cast<TRI_datafile_t*>(TRI_AtVectorPointer(files, i));
 
+    if (datafile->_fid <= skipFid) {
+      continue;
+    }
+
     LOG_TRACE("iterating over datafile '%s', fid %llu",
               datafile->getName(datafile),
               (unsigned long long) datafile->_fid);
@@ -1526,6 +1579,7 @@ int TRI_RenameCollection (TRI_collection_t* collection,
 ////////////////////////////////////////////////////////////////////////////////
 
 bool TRI_IterateCollection (TRI_collection_t* collection,
+                            TRI_voc_fid_t skipFid,
                             bool (*iterator)(TRI_df_marker_t const*, void*, TRI_datafile_t*),
                             void* data) {
   TRI_ASSERT(iterator != nullptr);
@@ -1558,9 +1612,9 @@ bool TRI_IterateCollection (TRI_collection_t* collection,
   }
 
   bool result;
-  if (! IterateDatafilesVector(datafiles , iterator, data) ||
-      ! IterateDatafilesVector(compactors, iterator, data) ||
-      ! IterateDatafilesVector(journals,   iterator, data)) {
+  if (! IterateDatafilesVector(datafiles,  skipFid, iterator, data) ||
+      ! IterateDatafilesVector(compactors, skipFid, iterator, data) ||
+      ! IterateDatafilesVector(journals,   skipFid, iterator, data)) {
     result = false;
   }
   else {
@@ -1811,8 +1865,10 @@ int TRI_UpgradeCollection20 (TRI_vocbase_t* vocbase,
         tick = TRI_NewTickServer();
 
         // datafile header
+        // shape and attribute markers are copied verbatim from the old
+        // datafiles, so the new file must keep using CRC32 checksums
         TRI_InitMarkerDatafile((char*) &header, TRI_DF_MARKER_HEADER, sizeof(TRI_df_header_marker_t));
-        header._version     = TRI_DF_VERSION;
+        header._version     = TRI_DF_VERSION_CRC32;
         header._maximalSize = 0; // TODO: seems ok to set this to 0, check if this is ok
         header._fid         = tick;
         header.base._tick   = tick;
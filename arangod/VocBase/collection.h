@@ -368,9 +368,12 @@ int TRI_RemoveFileIndexCollection (TRI_collection_t*,
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief iterates over a collection
+///
+/// datafiles with a fid less than or equal to the given fid are skipped
 ////////////////////////////////////////////////////////////////////////////////
 
 bool TRI_IterateCollection (TRI_collection_t*,
+                            TRI_voc_fid_t,
                             bool (*)(TRI_df_marker_t const*, void*, TRI_datafile_t*),
                             void*);
 
@@ -39,6 +39,7 @@
 #include "Basics/tri-strings.h"
 #include "Basics/memory-map.h"
 #include "Utils/transactions.h"
+#include "VocBase/checkpoint.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/server.h"
 #include "VocBase/vocbase.h"
@@ -101,6 +102,12 @@
 
 #define COMPACTOR_COLLECTION_INTERVAL (10.0)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimum time between two checkpoints of a collection, in seconds
+////////////////////////////////////////////////////////////////////////////////
+
+#define COMPACTOR_CHECKPOINT_INTERVAL (60.0)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief compactify interval in microseconds
 ////////////////////////////////////////////////////////////////////////////////
@@ -205,6 +212,7 @@ static TRI_datafile_t* CreateCompactor (TRI_document_collection_t* document,
 
 static int CopyMarker (TRI_document_collection_t* document,
                        TRI_datafile_t* compactor,
+                       TRI_datafile_t const* datafile,
                        TRI_df_marker_t const* marker,
                        TRI_df_marker_t** result) {
   int res = TRI_ReserveElementDatafile(compactor, marker->_size, result, 0);
@@ -215,7 +223,16 @@ static int CopyMarker (TRI_document_collection_t* document,
     return TRI_ERROR_ARANGO_NO_JOURNAL;
   }
 
-  return TRI_WriteElementDatafile(compactor, *result, marker, false);
+  res = TRI_WriteElementDatafile(compactor, *result, marker, false);
+
+  if (res == TRI_ERROR_NO_ERROR &&
+      datafile->_version != compactor->_version) {
+    // the marker was copied from a datafile with a different checksum
+    // algorithm. recalculate the checksum for the compactor file
+    (*result)->_crc = TRI_CalculateCrcMarkerDatafile(*result, compactor->_version);
+  }
+
+  return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -465,7 +482,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
     context->_keepDeletions = true;
 
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -488,7 +505,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   else if (marker->_type == TRI_DOC_MARKER_KEY_DELETION &&
            context->_keepDeletions) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -502,7 +519,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   // shapes
   else if (marker->_type == TRI_DF_MARKER_SHAPE) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -522,7 +539,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   // attributes
   else if (marker->_type == TRI_DF_MARKER_ATTRIBUTE) {
     // write to compactor files
-    res = CopyMarker(document, context->_compactor, marker, &result);
+    res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
     if (res != TRI_ERROR_NO_ERROR) {
       // TODO: dont fail but recover from this state
@@ -550,7 +567,7 @@ static bool Compactifier (TRI_df_marker_t const* marker,
 
     if (document->_failedTransactions != nullptr) {
       // write to compactor files
-      res = CopyMarker(document, context->_compactor, marker, &result);
+      res = CopyMarker(document, context->_compactor, datafile, marker, &result);
 
       if (res != TRI_ERROR_NO_ERROR) {
         // TODO: dont fail but recover from this state
@@ -782,6 +799,11 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
     return;
   }
 
+  // the checkpoint refers to the datafiles we are about to replace. it stays
+  // in place because loading checks the covered datafiles anyway, and the next
+  // checkpoint re-uses the part that covers the datafiles before these
+  document->_checkpointFid = 0;
+
   LOG_TRACE("compactify called for collection '%llu' for %d datafiles of total size %llu",
             (unsigned long long) document->_info._cid,
             (int) n,
@@ -1425,6 +1447,25 @@ void TRI_CompactorVocBase (void* data) {
               }
               // if we worked, then we don't set the compaction stamp to force another round of compaction
 
+              bool checkpointDue = (document->_lastCheckpoint + COMPACTOR_CHECKPOINT_INTERVAL <= now);
+
+              TRI_IF_FAILURE("CompactorCheckpointInterval") {
+                checkpointDue = true;
+              }
+
+              if (! worked && checkpointDue) {
+                // write a new checkpoint if datafiles were sealed since the last one
+                document->_lastCheckpoint = now;
+
+                int res = TRI_WriteCheckpointDocumentCollection(document);
+
+                if (res != TRI_ERROR_NO_ERROR) {
+                  LOG_WARNING("cannot write checkpoint for collection '%s': %s",
+                              document->_info._name,
+                              TRI_errno_string(res));
+                }
+              }
+
               document->ditches()->freeDitch(ce);
             }
           }
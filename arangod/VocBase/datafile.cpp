@@ -131,9 +131,13 @@ static int TruncateDatafile (TRI_datafile_t* const datafile, const off_t length)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief calculates the actual CRC of a marker, without bounds checks
+///
+/// the checksum algorithm depends on the version of the datafile the marker
+/// is contained in
 ////////////////////////////////////////////////////////////////////////////////
 
-static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
+static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker,
+                                        TRI_df_version_t version) {
   TRI_voc_size_t zero = 0;
   off_t o = offsetof(TRI_df_marker_t, _crc);
   size_t n = sizeof(TRI_voc_crc_t);
@@ -142,9 +146,16 @@ static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
 
   TRI_voc_crc_t crc = TRI_InitialCrc32();
 
-  crc = TRI_BlockCrc32(crc, ptr, o);
-  crc = TRI_BlockCrc32(crc, (char*) &zero, n);
-  crc = TRI_BlockCrc32(crc, ptr + o + n, marker->_size - o - n);
+  if (version == TRI_DF_VERSION_CRC32) {
+    crc = TRI_BlockCrc32(crc, ptr, o);
+    crc = TRI_BlockCrc32(crc, (char*) &zero, n);
+    crc = TRI_BlockCrc32(crc, ptr + o + n, marker->_size - o - n);
+  }
+  else {
+    crc = TRI_BlockCrc32C(crc, ptr, o);
+    crc = TRI_BlockCrc32C(crc, (char*) &zero, n);
+    crc = TRI_BlockCrc32C(crc, ptr + o + n, marker->_size - o - n);
+  }
 
   crc = TRI_FinalCrc32(crc);
 
@@ -156,7 +167,8 @@ static TRI_voc_crc_t CalculateCrcValue (TRI_df_marker_t const* marker) {
 ////////////////////////////////////////////////////////////////////////////////
 
 static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
-                                   char const* end) {
+                                   char const* end,
+                                   TRI_df_version_t version) {
   std::ostringstream result;
 
   if (marker == nullptr) {
@@ -195,7 +207,7 @@ static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
     return result.str();
   }
 
-  TRI_voc_crc_t crc = CalculateCrcValue(marker);
+  TRI_voc_crc_t crc = CalculateCrcValue(marker, version);
     
   if (marker->_crc == crc) {
     result << "crc checksum is correct";
@@ -212,7 +224,8 @@ static std::string DiagnoseMarker (TRI_df_marker_t const* marker,
 ////////////////////////////////////////////////////////////////////////////////
 
 static bool CheckCrcMarker (TRI_df_marker_t const* marker,
-                            char const* end) {
+                            char const* end,
+                            TRI_df_version_t version) {
   if (marker->_size < sizeof(TRI_df_marker_t)) {
     return false;
   }
@@ -221,7 +234,7 @@ static bool CheckCrcMarker (TRI_df_marker_t const* marker,
     return false;
   }
 
-  auto expected = CalculateCrcValue(marker);
+  auto expected = CalculateCrcValue(marker, version);
   return marker->_crc == expected;
 }
 
@@ -340,6 +353,7 @@ static void InitDatafile (TRI_datafile_t* datafile,
   datafile->_fid         = fid;
 
   datafile->_filename    = filename;
+  datafile->_version     = TRI_DF_VERSION;
   datafile->_fd          = fd;
   datafile->_mmHandle    = mmHandle;
 
@@ -595,7 +609,7 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
     if (marker->_size < sizeof(TRI_df_marker_t)) {
       entry._status = 4;
 
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(marker, end, datafile->_version);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
 
       scan._endPosition = currentSize;
@@ -608,7 +622,7 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
     if (! TRI_IsValidMarkerDatafile(marker)) {
       entry._status = 4;
 
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(marker, end, datafile->_version);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
 
       scan._endPosition = currentSize;
@@ -618,12 +632,12 @@ static TRI_df_scan_t ScanDatafile (TRI_datafile_t const* datafile) {
       return scan;
     }
 
-    ok = CheckCrcMarker(marker, end);
+    ok = CheckCrcMarker(marker, end, datafile->_version);
 
     if (! ok) {
       entry._status = 5;
       
-      auto&& diagnosis = DiagnoseMarker(marker, end);
+      auto&& diagnosis = DiagnoseMarker(marker, end, datafile->_version);
       entry._diagnosis = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, diagnosis.c_str(), diagnosis.size());
       
       scan._status = 4;
@@ -683,7 +697,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
     }
 
     if (marker->_type != 0) {
-      if (! CheckCrcMarker(marker, end)) {
+      if (! CheckCrcMarker(marker, end, datafile->_version)) {
         // CRC mismatch!
         auto next = reinterpret_cast<char const*>(marker) + marker->_size;
         auto p = next;
@@ -719,7 +733,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
                 nextMarker->_size >= sizeof(TRI_df_marker_t) &&
                 next + nextMarker->_size <= end &&
                 TRI_IsValidMarkerDatafile(nextMarker) &&
-                CheckCrcMarker(nextMarker, end)) {
+                CheckCrcMarker(nextMarker, end, datafile->_version)) {
               // next marker looks good.
 
               // create a temporary buffer
@@ -732,7 +746,7 @@ static bool TryRepairDatafile (TRI_datafile_t* datafile) {
               // create a new marker in the temporary buffer
               auto temp = reinterpret_cast<TRI_df_marker_t*>(buffer);
               TRI_InitMarkerDatafile(static_cast<char*>(buffer), TRI_DF_MARKER_BLANK, static_cast<TRI_voc_size_t>(marker->_size));
-              temp->_crc = CalculateCrcValue(temp);
+              temp->_crc = CalculateCrcValue(temp, datafile->_version);
 
               // all done. now copy back the marker into the file
               memcpy(static_cast<void*>(ptr), buffer, static_cast<size_t>(marker->_size));
@@ -924,7 +938,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
     }
 
     if (marker->_type != 0) {
-      bool ok = CheckCrcMarker(marker, end);
+      bool ok = CheckCrcMarker(marker, end, datafile->_version);
 
       if (! ok) {
         // CRC mismatch!
@@ -962,7 +976,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
                     nextMarker->_size >= sizeof(TRI_df_marker_t) &&
                     next + nextMarker->_size <= end &&
                     TRI_IsValidMarkerDatafile(nextMarker) &&
-                    CheckCrcMarker(nextMarker, end)) {
+                    CheckCrcMarker(nextMarker, end, datafile->_version)) {
                   // next marker looks good.
                   nextMarkerOk = true;
                 }
@@ -987,7 +1001,7 @@ static bool CheckDatafile (TRI_datafile_t* datafile,
           LOG_WARNING("crc mismatch found in datafile '%s' at position %lu. expected crc: %x, actual crc: %x", 
                       datafile->getName(datafile),
                       (unsigned long) currentSize,
-                      CalculateCrcValue(marker),
+                      CalculateCrcValue(marker, datafile->_version),
                       marker->_crc);
           
           if (nextMarkerOk) {
@@ -1160,13 +1174,16 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
   
   char const* end = static_cast<char const*>(ptr) + len;
 
-  // check CRC
-  ok = CheckCrcMarker(&header.base, end);
+  // check the datafile version first, as it determines the checksum
+  // algorithm of the header and of all other markers
+  ok = TRI_IsValidVersionDatafile(header._version);
 
   if (! ok) {
     TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
 
-    LOG_ERROR("corrupted datafile header read from '%s'", filename);
+    LOG_ERROR("unknown datafile version '%u' in datafile '%s'",
+              (unsigned int) header._version,
+              filename);
 
     if (! ignoreErrors) {
       TRI_CLOSE(fd);
@@ -1174,14 +1191,16 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
     }
   }
 
-  // check the datafile version
+  TRI_df_version_t const version = (ok ? header._version : TRI_DF_VERSION);
+
+  // check CRC
   if (ok) {
-    if (header._version != TRI_DF_VERSION) {
+    ok = CheckCrcMarker(&header.base, end, version);
+
+    if (! ok) {
       TRI_set_errno(TRI_ERROR_ARANGO_CORRUPTED_DATAFILE);
 
-      LOG_ERROR("unknown datafile version '%u' in datafile '%s'",
-                (unsigned int) header._version,
-                filename);
+      LOG_ERROR("corrupted datafile header read from '%s'", filename);
 
       if (! ignoreErrors) {
         TRI_CLOSE(fd);
@@ -1228,6 +1247,8 @@ static TRI_datafile_t* OpenDatafile (char const* filename,
                fid,
                static_cast<char*>(data));
 
+  datafile->_version = version;
+
   return datafile;
 }
 
@@ -1594,6 +1615,24 @@ bool TRI_IsValidMarkerDatafile (TRI_df_marker_t const* marker) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether a datafile version is known
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_IsValidVersionDatafile (TRI_df_version_t version) {
+  return (version == TRI_DF_VERSION_CRC32 ||
+          version == TRI_DF_VERSION_CRC32C);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the checksum of a marker for a datafile version
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_crc_t TRI_CalculateCrcMarkerDatafile (TRI_df_marker_t const* marker,
+                                              TRI_df_version_t version) {
+  return CalculateCrcValue(marker, version);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reserves room for an element, advances the pointer
 ///
@@ -1837,10 +1876,7 @@ int TRI_WriteCrcElementDatafile (TRI_datafile_t* datafile,
   TRI_ASSERT(marker->_tick != 0);
 
   if (datafile->isPhysical(datafile)) {
-    TRI_voc_crc_t crc = TRI_InitialCrc32();
-
-    crc = TRI_BlockCrc32(crc, (char const*) marker, marker->_size);
-    marker->_crc = TRI_FinalCrc32(crc);
+    marker->_crc = TRI_CalculateCrcMarkerDatafile(marker, datafile->_version);
   }
 
   return TRI_WriteElementDatafile(datafile, position, marker, forceSync);
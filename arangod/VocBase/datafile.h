@@ -95,10 +95,26 @@
 // -----------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief datafile version
+/// @brief datafile version with CRC32 marker checksums
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_DF_VERSION_CRC32    (1)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief datafile version with CRC32C (Castagnoli) marker checksums
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_DF_VERSION_CRC32C   (2)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief datafile version used for new datafiles and logfiles
+///
+/// the version is stored in the datafile header marker and determines the
+/// checksum algorithm for all markers in the file. existing datafiles keep
+/// their version and are still verified with CRC32
 ////////////////////////////////////////////////////////////////////////////////
 
-#define TRI_DF_VERSION          (1)
+#define TRI_DF_VERSION          (TRI_DF_VERSION_CRC32C)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief alignment in datafile blocks
@@ -274,6 +290,8 @@ typedef struct TRI_datafile_s {
 
   char* _filename;               // underlying filename
 
+  TRI_df_version_t _version;     // datafile version, determines the marker checksum algorithm
+
   // function pointers
   bool (*isPhysical)(const struct TRI_datafile_s* const); // returns true if the datafile is a physical file
   const char* (*getName)(const struct TRI_datafile_s* const); // returns the name of a datafile
@@ -661,6 +679,21 @@ void TRI_InitMarkerDatafile (char*,
 
 bool TRI_IsValidMarkerDatafile (TRI_df_marker_t const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether a datafile version is known
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_IsValidVersionDatafile (TRI_df_version_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the checksum of a marker for a datafile version
+///
+/// the value of the marker's _crc attribute is ignored for the calculation
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_voc_crc_t TRI_CalculateCrcMarkerDatafile (TRI_df_marker_t const*,
+                                              TRI_df_version_t);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reserves room for an element, advances the pointer
 ////////////////////////////////////////////////////////////////////////////////
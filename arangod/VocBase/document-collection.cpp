@@ -29,6 +29,7 @@
 
 #include "document-collection.h"
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Basics/Barrier.h"
 #include "Basics/conversions.h"
@@ -49,6 +50,7 @@
 #include "Utils/transactions.h"
 #include "Utils/CollectionReadLocker.h"
 #include "Utils/CollectionWriteLocker.h"
+#include "VocBase/checkpoint.h"
 #include "VocBase/Ditch.h"
 #include "VocBase/edge-collection.h"
 #include "VocBase/ExampleMatcher.h"
@@ -368,6 +370,9 @@ TRI_doc_collection_info_t* TRI_document_collection_t::figures () {
 
   if (_headersPtr != nullptr) {
     info->_sizeIndexes += static_cast<int64_t>(_headersPtr->memory());
+
+    info->_numberHeaders = static_cast<TRI_voc_ssize_t>(_headersPtr->numAllocated());
+    info->_sizeHeaders   = static_cast<int64_t>(_headersPtr->reservedMemory());
   }
 
   for (auto& idx : allIndexes()) {
@@ -516,6 +521,14 @@ VocShaper* TRI_document_collection_t::getShaper () const {
 
 int TRI_AddOperationTransaction (triagens::wal::DocumentOperation&, bool&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add several WAL operations for the same transaction collection
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AddOperationsTransaction (std::vector<triagens::wal::DocumentOperation*>&,
+                                  std::vector<int>&,
+                                  bool&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              forward declarations
 // -----------------------------------------------------------------------------
@@ -663,13 +676,39 @@ static int InsertPrimaryIndex (TRI_document_collection_t* document,
   return TRI_ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether an index is filled using batch insert when inserting
+/// several documents at once
+///
+/// this is only done for indexes that cannot fail for an individual document,
+/// because batch insert does not report which document caused an error
+////////////////////////////////////////////////////////////////////////////////
+
+static bool UseBatchInsert (triagens::arango::Index const* idx) {
+  if (! idx->hasBatchInsert()) {
+    return false;
+  }
+
+  switch (idx->type()) {
+    case triagens::arango::Index::TRI_IDX_TYPE_EDGE_INDEX:
+      return true;
+    case triagens::arango::Index::TRI_IDX_TYPE_HASH_INDEX:
+      return ! static_cast<triagens::arango::HashIndex const*>(idx)->unique();
+    default:
+      return false;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates a new entry in the secondary indexes
+/// if skipBatchInsert is set, indexes that are filled using batch insert are
+/// left out
 ////////////////////////////////////////////////////////////////////////////////
 
 static int InsertSecondaryIndexes (TRI_document_collection_t* document,
                                    TRI_doc_mptr_t const* header,
-                                   bool isRollback) {
+                                   bool isRollback,
+                                   bool skipBatchInsert) {
   TRI_IF_FAILURE("InsertSecondaryIndexes") {
     return TRI_ERROR_DEBUG;
   }
@@ -685,6 +724,11 @@ static int InsertSecondaryIndexes (TRI_document_collection_t* document,
 
   for (size_t i = 1; i < n; ++i) {
     auto idx = indexes[i];
+
+    if (skipBatchInsert && UseBatchInsert(idx)) {
+      continue;
+    }
+
     int res = idx->insert(header, isRollback);
 
     // in case of no-memory, return immediately
@@ -964,7 +1008,7 @@ static int InsertDocument (TRI_transaction_collection_t* trxCollection,
   }
 
   // insert into secondary indexes
-  res = InsertSecondaryIndexes(document, header, false);
+  res = InsertSecondaryIndexes(document, header, false, false);
 
   if (res != TRI_ERROR_NO_ERROR) {
     DeleteSecondaryIndexes(document, header, true);
@@ -1045,7 +1089,7 @@ static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
 
   if (res != TRI_ERROR_NO_ERROR) {
     // re-enter the document in case of failure, ignore errors during rollback
-    InsertSecondaryIndexes(document, oldHeader, true);
+    InsertSecondaryIndexes(document, oldHeader, true, false);
 
     return res;
   }
@@ -1061,7 +1105,7 @@ static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
   newHeader->setDataPtr(operation.marker->mem());  // PROTECTED by trx in trxCollection
 
   // insert new document into secondary indexes
-  res = InsertSecondaryIndexes(document, newHeader, false);
+  res = InsertSecondaryIndexes(document, newHeader, false, false);
 
   if (res != TRI_ERROR_NO_ERROR) {
     // rollback
@@ -1070,7 +1114,7 @@ static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
     // copy back old header data
     oldHeader->copy(oldData);
 
-    InsertSecondaryIndexes(document, oldHeader, true);
+    InsertSecondaryIndexes(document, oldHeader, true, false);
 
     return res;
   }
@@ -2032,6 +2076,8 @@ static int InitBaseDocumentCollection (TRI_document_collection_t* document,
   document->setShaper(shaper);
   document->_numberDocuments    = 0;
   document->_lastCompaction     = 0.0;
+  document->_checkpointFid      = 0;
+  document->_lastCheckpoint     = 0.0;
 
   int res = TRI_InitAssociativePointer(&document->_datafileInfo,
                                        TRI_UNKNOWN_MEM_ZONE,
@@ -2162,8 +2208,260 @@ static bool InitDocumentCollection (TRI_document_collection_t* document,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether a checkpoint matches the datafiles of a collection
+///
+/// the covered datafiles must still be the same physical files, and all other
+/// datafiles and journals must be newer than the covered ones. the markers
+/// themselves are not read, the checkpoint is protected by its own CRC.
+/// also returns the number of documents in the checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ValidateCheckpoint (TRI_collection_t* collection,
+                                TRI_checkpoint_t const* checkpoint,
+                                std::vector<TRI_datafile_t*>& covered,
+                                size_t& numberDocuments) {
+  uint64_t const n = checkpoint->_header->_numberDatafiles;
+  TRI_voc_fid_t const lastFid = checkpoint->_datafiles[n - 1]._fid;
+
+  if (collection->_compactors._length > 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < collection->_journals._length; ++i) {
+    auto df = static_cast<TRI_datafile_t const*>(collection->_journals._buffer[i]);
+
+    if (df->_fid <= lastFid) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < collection->_datafiles._length; ++i) {
+    auto df = static_cast<TRI_datafile_t*>(collection->_datafiles._buffer[i]);
+
+    if (df->_fid > lastFid) {
+      continue;
+    }
+
+    size_t const position = covered.size();
+
+    if (position >= n) {
+      return false;
+    }
+
+    TRI_checkpoint_datafile_t const* info = &checkpoint->_datafiles[position];
+
+    if (df->_fid != info->_fid ||
+        df->_currentSize != info->_currentSize ||
+        TRI_FooterTickCheckpointDatafile(df) != info->_footerTick) {
+      return false;
+    }
+
+    covered.emplace_back(df);
+  }
+
+  if (covered.size() != n) {
+    return false;
+  }
+
+  // check that all markers are inside the covered datafiles
+  size_t position = 0;
+  numberDocuments = 0;
+
+  for (uint64_t i = 0; i < checkpoint->_header->_numberMarkers; ++i) {
+    TRI_checkpoint_marker_t const* m = &checkpoint->_markers[i];
+
+    while (position < n && covered[position]->_fid != m->_fid) {
+      ++position;
+    }
+
+    if (position == n ||
+        m->_size < sizeof(TRI_df_marker_t) ||
+        static_cast<uint64_t>(m->_offset) + m->_size > covered[position]->_currentSize) {
+      return false;
+    }
+
+    if (m->_type == TRI_DOC_MARKER_KEY_DOCUMENT ||
+        m->_type == TRI_DOC_MARKER_KEY_EDGE) {
+      ++numberDocuments;
+    }
+    else if (m->_type != TRI_DF_MARKER_SHAPE &&
+             m->_type != TRI_DF_MARKER_ATTRIBUTE) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the master pointer of a document from its checkpoint entry
+/// and inserts it into the primary index
+///
+/// the master pointer only points to the marker, and the primary index uses
+/// the key hash from the checkpoint, so the marker is not read here
+////////////////////////////////////////////////////////////////////////////////
+
+static int RestoreDocumentCheckpoint (TRI_document_collection_t* document,
+                                      TRI_checkpoint_marker_t const* m,
+                                      char const* data) {
+  TRI_doc_mptr_t* header = document->_headersPtr->request(m->_size);  // ONLY IN OPENITERATOR
+
+  if (header == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  header->_rid  = m->_rid;
+  header->_fid  = m->_fid;
+  header->setDataPtr(data);  // ONLY IN OPENITERATOR
+  header->_hash = m->_keyHash;
+
+  // no primary index lock required here because we are the only ones reading from the index ATM
+  void const* found = nullptr;
+  int res = document->primaryIndex()->insertKey(header, &found);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    document->_headersPtr->release(header, true);  // ONLY IN OPENITERATOR
+    return res;
+  }
+
+  ++document->_numberDocuments;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief restores the state of the sealed datafiles from the checkpoint
+///
+/// the master pointers and the primary index are created from the checkpoint
+/// entries without reading the document markers. only the shape and attribute
+/// markers are read, as the shaper needs their contents. the datafile
+/// statistics and ticks are taken from the checkpoint. secondary indexes,
+/// including the edge index, are filled from the markers afterwards as usual.
+/// returns the newest fid covered by the checkpoint, or 0 if there is no
+/// usable checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_fid_t RestoreCheckpoint (TRI_collection_t* collection,
+                                        open_iterator_state_t* state,
+                                        int* res) {
+  auto document = reinterpret_cast<TRI_document_collection_t*>(collection);
+
+  *res = TRI_ERROR_NO_ERROR;
+
+  TRI_checkpoint_t* checkpoint = TRI_OpenCheckpointDocumentCollection(document);
+
+  if (checkpoint == nullptr) {
+    return 0;
+  }
+
+  std::vector<TRI_datafile_t*> covered;
+  size_t numberDocuments = 0;
+
+  try {
+    if (! ValidateCheckpoint(collection, checkpoint, covered, numberDocuments)) {
+      LOG_DEBUG("checkpoint of collection '%s' does not match its datafiles",
+                collection->_info._name);
+
+      TRI_CloseCheckpoint(checkpoint);
+      return 0;
+    }
+  }
+  catch (...) {
+    TRI_CloseCheckpoint(checkpoint);
+    *res = TRI_ERROR_OUT_OF_MEMORY;
+    return 0;
+  }
+
+  uint64_t const n = checkpoint->_header->_numberDatafiles;
+
+  if (static_cast<int64_t>(numberDocuments) > state->_initialCount) {
+    *res = document->primaryIndex()->resize(static_cast<size_t>(numberDocuments * 1.1));
+
+    if (*res != TRI_ERROR_NO_ERROR) {
+      TRI_CloseCheckpoint(checkpoint);
+      return 0;
+    }
+  }
+
+  size_t position = 0;
+
+  for (uint64_t i = 0; i < checkpoint->_header->_numberMarkers; ++i) {
+    TRI_checkpoint_marker_t const* m = &checkpoint->_markers[i];
+
+    while (covered[position]->_fid != m->_fid) {
+      ++position;
+    }
+
+    char const* data = covered[position]->_data + m->_offset;
+
+    if (m->_type == TRI_DOC_MARKER_KEY_DOCUMENT ||
+        m->_type == TRI_DOC_MARKER_KEY_EDGE) {
+      *res = RestoreDocumentCheckpoint(document, m, data);
+      ++state->_documents;
+    }
+    else if (! OpenIterator(reinterpret_cast<TRI_df_marker_t const*>(data), state, covered[position])) {
+      *res = TRI_ERROR_INTERNAL;
+    }
+
+    if (*res != TRI_ERROR_NO_ERROR) {
+      LOG_ERROR("cannot restore collection '%s' from checkpoint: %s",
+                collection->_info._name,
+                TRI_errno_string(*res));
+
+      TRI_CloseCheckpoint(checkpoint);
+      return 0;
+    }
+  }
+
+  // the statistics and ticks also reflect the markers that were skipped
+  for (uint64_t i = 0; i < n; ++i) {
+    TRI_checkpoint_datafile_t const* info = &checkpoint->_datafiles[i];
+    TRI_datafile_t* df = covered[i];
+
+    df->_tickMin = info->_tickMin;
+    df->_tickMax = info->_tickMax;
+    df->_dataMin = info->_dataMin;
+    df->_dataMax = info->_dataMax;
+
+    TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, info->_fid, true);
+
+    if (dfi != nullptr) {
+      *dfi = info->_dfi;
+    }
+
+    TRI_MMFileAdvise(df->_data, df->_maximalSize, TRI_MADVISE_RANDOM);
+  }
+
+  if (checkpoint->_header->_tickMax > document->_tickMax) {
+    document->_tickMax = checkpoint->_header->_tickMax;
+  }
+
+  SetRevision(document, checkpoint->_header->_revision, false);
+
+  if (checkpoint->_header->_keyValue > 0) {
+    char buffer[21];
+    buffer[TRI_StringUInt64InPlace(checkpoint->_header->_keyValue, &buffer[0])] = '\0';
+    document->_keyGenerator->track(&buffer[0]);
+  }
+
+  TRI_voc_fid_t const lastFid = checkpoint->_datafiles[n - 1]._fid;
+
+  LOG_DEBUG("restored %llu markers of collection '%s' from checkpoint, covering %llu datafiles",
+            (unsigned long long) checkpoint->_header->_numberMarkers,
+            collection->_info._name,
+            (unsigned long long) n);
+
+  TRI_CloseCheckpoint(checkpoint);
+
+  return lastFid;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief iterate all markers of the collection
+///
+/// if the collection has a usable checkpoint, only the markers it references
+/// and the datafiles newer than the checkpoint are read
 ////////////////////////////////////////////////////////////////////////////////
 
 static int IterateMarkersCollection (TRI_collection_t* collection) {
@@ -2200,8 +2498,18 @@ static int IterateMarkersCollection (TRI_collection_t* collection) {
     return res;
   }
 
-  // read all documents and fill primary index
-  TRI_IterateCollection(collection, OpenIterator, &openState);
+  // restore the state of the older datafiles from the checkpoint
+  TRI_voc_fid_t checkpointFid = RestoreCheckpoint(collection, &openState, &res);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_DestroyVector(&openState._operations);
+    return res;
+  }
+
+  document->_checkpointFid = checkpointFid;
+
+  // read all other documents and fill primary index
+  TRI_IterateCollection(collection, checkpointFid, OpenIterator, &openState);
 
   LOG_TRACE("found %llu document markers, %llu deletion markers for collection '%s'",
             (unsigned long long) openState._documents,
@@ -2723,7 +3031,7 @@ int TRI_RollbackOperationDocumentCollection (TRI_document_collection_t* document
     // revert to the old state
     header->copy(*oldData);
     // re-insert old state
-    int res = InsertSecondaryIndexes(document, header, true);
+    int res = InsertSecondaryIndexes(document, header, true, false);
     // revert again to the new state, because other parts of the new state
     // will be reverted at some other place
     header->copy(copy);
@@ -2734,7 +3042,7 @@ int TRI_RollbackOperationDocumentCollection (TRI_document_collection_t* document
     int res = InsertPrimaryIndex(document, header, true);
 
     if (res == TRI_ERROR_NO_ERROR) {
-      res = InsertSecondaryIndexes(document, header, true);
+      res = InsertSecondaryIndexes(document, header, true, false);
       document->_numberDocuments++;
     }
     else {
@@ -3690,6 +3998,7 @@ bool TRI_DropIndexDocumentCollection (TRI_document_collection_t* document,
     TRI_WRITE_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
   
     triagens::aql::QueryCache::instance()->invalidate(vocbase, document->_info._name);
+    triagens::aql::PlanCache::instance()->invalidate(vocbase, document->_info._name);
     found = document->removeIndex(iid);
   
     TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
@@ -3886,6 +4195,12 @@ static triagens::arango::Index* CreateCapConstraintDocumentCollection (TRI_docum
     return nullptr;
   }
 
+  if (document->useSecondaryIndexes()) {
+    // remove documents exceeding the constraint. when the collection is
+    // loaded, the constraint is applied with the next insert
+    static_cast<triagens::arango::CapConstraint*>(idx)->initialize();
+  }
+
   if (created != nullptr) {
     *created = true;
   }
@@ -3974,6 +4289,7 @@ triagens::arango::Index* TRI_EnsureCapConstraintDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4302,6 +4618,7 @@ triagens::arango::Index* TRI_EnsureGeoIndex1DocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4333,6 +4650,7 @@ triagens::arango::Index* TRI_EnsureGeoIndex2DocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4500,6 +4818,7 @@ triagens::arango::Index* TRI_EnsureHashIndexDocumentCollection (TRI_document_col
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4664,6 +4983,7 @@ triagens::arango::Index* TRI_EnsureSkiplistIndexDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -4860,6 +5180,7 @@ triagens::arango::Index* TRI_EnsureFulltextIndexDocumentCollection (TRI_document
   if (idx != nullptr) {
     if (created) {
       triagens::aql::QueryCache::instance()->invalidate(document->_vocbase, document->_info._name);
+      triagens::aql::PlanCache::instance()->invalidate(document->_vocbase, document->_info._name);
       int res = TRI_SaveIndex(document, idx, true);
 
       if (res != TRI_ERROR_NO_ERROR) {
@@ -5066,14 +5387,14 @@ int TRI_RemoveShapedJsonDocumentCollection (TRI_transaction_collection_t* trxCol
     res = DeleteSecondaryIndexes(document, header, false);
 
     if (res != TRI_ERROR_NO_ERROR) {
-      InsertSecondaryIndexes(document, header, true);
+      InsertSecondaryIndexes(document, header, true, false);
       return res;
     }
 
     res = DeletePrimaryIndex(document, header, false);
 
     if (res != TRI_ERROR_NO_ERROR) {
-      InsertSecondaryIndexes(document, header, true);
+      InsertSecondaryIndexes(document, header, true, false);
       return res;
     }
 
@@ -5239,6 +5560,229 @@ int TRI_InsertShapedJsonDocumentCollection (TRI_transaction_collection_t* trxCol
   return res;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief insert several shaped-json documents (or edges)
+///
+/// Documents with a shape of nullptr are skipped. Keys might be nullptr, in
+/// which case they are auto-generated. The markers are created before the
+/// collection lock is acquired, and the lock is acquired only once for all
+/// documents. Indexes that support it are filled with a single batch insert,
+/// and the markers are written to the WAL with batched slot reservations.
+/// The result for each document is stored in results.
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_InsertShapedJsonDocumentCollectionBatch (TRI_transaction_collection_t* trxCollection,
+                                                 std::vector<TRI_voc_key_t> const& keys,
+                                                 std::vector<TRI_shaped_json_t*> const& shapes,
+                                                 std::vector<void const*> const& edges,
+                                                 std::vector<TRI_doc_mptr_copy_t>& mptrs,
+                                                 std::vector<int>& results,
+                                                 bool stopOnError,
+                                                 bool lock,
+                                                 bool forceSync) {
+  size_t n = shapes.size();
+
+  TRI_ASSERT(keys.size() == n);
+  TRI_ASSERT(edges.size() == n);
+  TRI_ASSERT(mptrs.size() == n);
+  TRI_ASSERT(results.size() == n);
+
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+
+  std::vector<std::unique_ptr<triagens::wal::Marker>> markers(n);
+  std::vector<TRI_voc_rid_t> rids(n, 0);
+  std::vector<uint64_t> hashes(n, 0);
+  size_t numberMarkers = 0;
+
+  // create the markers without holding the lock
+  for (size_t i = 0; i < n; ++i) {
+    if (shapes[i] == nullptr) {
+      continue;
+    }
+
+    mptrs[i].setDataPtr(nullptr);  // PROTECTED by trx in trxCollection
+
+    TRI_voc_rid_t rid = GetRevisionId(0);
+    TRI_voc_tick_t tick = static_cast<TRI_voc_tick_t>(rid);
+
+    std::string keyString;
+    int res = TRI_ERROR_NO_ERROR;
+
+    if (keys[i] == nullptr) {
+      // no key specified, now generate a new one
+      keyString.assign(document->_keyGenerator->generate(tick));
+
+      if (keyString.empty()) {
+        res = TRI_ERROR_ARANGO_OUT_OF_KEYS;
+      }
+    }
+    else {
+      // key was specified, now validate it
+      res = document->_keyGenerator->validate(keys[i], false);
+      keyString = keys[i];
+    }
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      triagens::wal::Marker* marker = nullptr;
+      res = CreateMarkerNoLegend(marker, document, rid, trxCollection, keyString, shapes[i], static_cast<TRI_document_edge_t const*>(edges[i]));
+      markers[i].reset(marker);
+    }
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      markers[i].reset();
+      results[i] = res;
+
+      if (stopOnError) {
+        n = i;
+        break;
+      }
+      continue;
+    }
+
+    rids[i] = rid;
+    hashes[i] = document->primaryIndex()->calculateHash(keyString.c_str(), keyString.size());
+    ++numberMarkers;
+  }
+
+  if (numberMarkers == 0) {
+    // nothing to insert, so no need to lock
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  TRI_voc_tick_t markerTick = 0;
+  
+  {
+    triagens::arango::CollectionWriteLocker collectionLocker(document, lock);
+
+    // the operations must be destroyed (and thus reverted) while the lock
+    // is still held
+    std::vector<std::unique_ptr<triagens::wal::DocumentOperation>> operations;
+    operations.reserve(numberMarkers);
+    // input positions of the operations
+    std::vector<size_t> positions;
+    positions.reserve(numberMarkers);
+    std::vector<TRI_doc_mptr_t*> headers;
+    headers.reserve(numberMarkers);
+
+    for (size_t i = 0; i < n; ++i) {
+      if (markers[i] == nullptr) {
+        continue;
+      }
+
+      auto marker = markers[i].release();
+      operations.emplace_back(new triagens::wal::DocumentOperation(marker, true, trxCollection, TRI_VOC_DOCUMENT_OPERATION_INSERT, rids[i]));
+      auto& operation = *operations.back();
+
+      // create a new header
+      TRI_doc_mptr_t* header = operation.header = document->_headersPtr->request(marker->size());  // PROTECTED by trx in trxCollection
+      int res = TRI_ERROR_OUT_OF_MEMORY;
+
+      if (header != nullptr) {
+        // update the header we got
+        header->_rid  = rids[i];
+        header->setDataPtr(marker->mem());  // PROTECTED by trx in trxCollection
+        header->_hash = hashes[i];
+
+        // insert into the primary index and the indexes that do not
+        // support batch insert
+        res = InsertPrimaryIndex(document, header, false);
+
+        if (res == TRI_ERROR_NO_ERROR) {
+          res = InsertSecondaryIndexes(document, header, false, true);
+
+          if (res != TRI_ERROR_NO_ERROR) {
+            DeleteSecondaryIndexes(document, header, true);
+            DeletePrimaryIndex(document, header, true);
+          }
+        }
+      }
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        operations.pop_back();
+        results[i] = res;
+
+        if (stopOnError) {
+          break;
+        }
+        continue;
+      }
+
+      document->_numberDocuments++;
+      operation.indexed();
+
+      positions.emplace_back(i);
+      headers.emplace_back(header);
+    }
+
+    if (operations.empty()) {
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    // now fill the remaining indexes in one go
+    if (document->useSecondaryIndexes()) {
+      std::vector<TRI_doc_mptr_t const*> documents(headers.begin(), headers.end());
+      auto const& indexes = document->allIndexes();
+
+      for (size_t j = 1; j < indexes.size(); ++j) {
+        auto idx = indexes[j];
+
+        if (! UseBatchInsert(idx)) {
+          continue;
+        }
+
+        int res = idx->batchInsert(&documents, 1);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          // revert all operations. this removes them from all indexes
+          for (auto position : positions) {
+            results[position] = res;
+          }
+          operations.clear();
+
+          return TRI_ERROR_NO_ERROR;
+        }
+      }
+    }
+
+    std::vector<triagens::wal::DocumentOperation*> pending;
+    pending.reserve(operations.size());
+
+    for (auto& operation : operations) {
+      pending.emplace_back(operation.get());
+    }
+
+    bool waitForSync = forceSync;
+    std::vector<int> written;
+    TRI_AddOperationsTransaction(pending, written, waitForSync);
+
+    for (size_t j = 0; j < operations.size(); ++j) {
+      size_t const i = positions[j];
+
+      if (written[j] != TRI_ERROR_NO_ERROR) {
+        operations[j]->revert();
+        results[i] = written[j];
+        continue;
+      }
+
+      mptrs[i] = *headers[j];
+      PostInsertIndexes(trxCollection, headers[j]);
+
+      TRI_ASSERT(mptrs[i].getDataPtr() != nullptr);  // PROTECTED by trx in trxCollection
+
+      if (waitForSync) {
+        markerTick = operations[j]->tick;
+      }
+    }
+  }
+
+  if (markerTick > 0) {
+    // need to wait for tick, outside the lock
+    triagens::wal::LogfileManager::instance()->slots()->waitForTick(markerTick);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief updates a document in the collection from shaped json
 ////////////////////////////////////////////////////////////////////////////////
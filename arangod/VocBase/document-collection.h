@@ -123,14 +123,17 @@ class KeyGenerator;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief master pointer
+///
+/// there is one master pointer per document in memory, so it is kept small:
+/// outside of maintainer mode it has no virtual methods and thus no vtable,
+/// and it is not linked into any list. the master pointers of a collection
+/// are handed out from the blocks managed by TRI_headers_t
 ////////////////////////////////////////////////////////////////////////////////
 
 struct TRI_doc_mptr_t {
     TRI_voc_rid_t          _rid;     // this is the revision identifier
     TRI_voc_fid_t          _fid;     // this is the datafile identifier
     uint64_t               _hash;    // the pre-calculated hash value of the key
-    TRI_doc_mptr_t*        _prev;    // previous master pointer
-    TRI_doc_mptr_t*        _next;    // next master pointer
   protected:
     void const*            _dataptr; // this is the pointer to the beginning of the raw marker
 
@@ -138,21 +141,19 @@ struct TRI_doc_mptr_t {
     TRI_doc_mptr_t () : _rid(0), 
                         _fid(0), 
                         _hash(0),
-                        _prev(nullptr),
-                        _next(nullptr),
                         _dataptr(nullptr) {
     }
 
+#ifdef TRI_ENABLE_MAINTAINER_MODE
     virtual ~TRI_doc_mptr_t () {
     }
+#endif
 
     void clear () {
       _rid = 0;
       _fid = 0;
       setDataPtr(nullptr);
       _hash = 0;
-      _prev = nullptr;
-      _next = nullptr;
     }
 
     void copy (TRI_doc_mptr_t const& that) {
@@ -161,8 +162,6 @@ struct TRI_doc_mptr_t {
       _fid = that._fid;
       _dataptr = that._dataptr;
       _hash = that._hash;
-      _prev = that._prev;
-      _next = that._next;
     }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -339,6 +338,9 @@ typedef struct TRI_doc_collection_info_s {
   int64_t         _sizeTransactions;
   int64_t         _sizeIndexes;
 
+  TRI_voc_ssize_t _numberHeaders;
+  int64_t         _sizeHeaders;
+
   int64_t         _datafileSize;
   int64_t         _journalfileSize;
   int64_t         _compactorfileSize;
@@ -422,6 +424,12 @@ public:
   TRI_read_write_lock_t                  _compactionLock;
   double                                 _lastCompaction;
 
+  // newest datafile covered by the collection's checkpoint file, and the
+  // time of the last attempt to write a checkpoint. only used by the
+  // compactor thread and when loading the collection
+  TRI_voc_fid_t                          _checkpointFid;
+  double                                 _lastCheckpoint;
+
   // ...........................................................................
   // this condition variable protects the _journalsCondition
   // ...........................................................................
@@ -1124,7 +1132,19 @@ int TRI_InsertShapedJsonDocumentCollection (TRI_transaction_collection_t*,
                                             bool);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief updates a document in the collection from shaped json
+/// @brief insert several shaped-json documents (or edges)
+/// note: keys might be NULL. in this case, they are auto-generated
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_InsertShapedJsonDocumentCollectionBatch (TRI_transaction_collection_t*,
+                                                 std::vector<TRI_voc_key_t> const&,
+                                                 std::vector<TRI_shaped_json_t*> const&,
+                                                 std::vector<void const*> const&,
+                                                 std::vector<TRI_doc_mptr_copy_t>&,
+                                                 std::vector<int>&,
+                                                 bool,
+                                                 bool,
+                                                 bool);
 ////////////////////////////////////////////////////////////////////////////////
 
 int TRI_UpdateShapedJsonDocumentCollection (TRI_transaction_collection_t*,
@@ -32,6 +32,10 @@
 #include "Basics/logging.h"
 #include "VocBase/document-collection.h"
 
+#ifndef TRI_ENABLE_MAINTAINER_MODE
+static_assert(sizeof(TRI_doc_mptr_t) == 32, "invalid master pointer size");
+#endif
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
@@ -56,7 +60,7 @@ static inline size_t GetBlockSize (size_t blockNumber) {
   }
 
   // use a block size of 32768
-  // this will use 32768 * sizeof(TRI_doc_mptr_t) bytes, i.e. 1.5 MB
+  // this will use 32768 * sizeof(TRI_doc_mptr_t) bytes, i.e. 1 MB
   return (size_t) (BLOCK_SIZE_UNIT << 8);
 }
 
@@ -70,8 +74,7 @@ static inline size_t GetBlockSize (size_t blockNumber) {
 
 TRI_headers_t::TRI_headers_t ()
   : _freelist(nullptr),
-    _begin(nullptr),
-    _end(nullptr),
+    _nrReserved(0),
     _nrAllocated(0),
     _nrLinked(0),
     _totalSize(0),
@@ -95,7 +98,7 @@ TRI_headers_t::~TRI_headers_t () {
 // -----------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves an existing header to the end of the list
+/// @brief accounts for an update of an existing header
 /// this is called when there is an update operation on a document
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -109,12 +112,6 @@ void TRI_headers_t::moveBack (TRI_doc_mptr_t* header,
   TRI_ASSERT(_nrLinked > 0);
   TRI_ASSERT(_totalSize > 0);
 
-  // we have at least one element in the list
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
-
   TRI_ASSERT(old != nullptr);
   TRI_ASSERT(old->getDataPtr() != nullptr);  // ONLY IN HEADERS, PROTECTED by RUNTIME
 
@@ -125,42 +122,11 @@ void TRI_headers_t::moveBack (TRI_doc_mptr_t* header,
   _totalSize += (  TRI_DF_ALIGN_BLOCK(newSize)
                  - TRI_DF_ALIGN_BLOCK(oldSize));
 
-  if (_end == header) {
-    // header is already at the end
-    TRI_ASSERT(header->_next == nullptr);
-    return;
-  }
-
-  TRI_ASSERT(_begin != _end);
-
-  // unlink the element
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
-  }
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
-  }
-
-  if (_begin == header) {
-    TRI_ASSERT(header->_next != nullptr);
-    _begin = header->_next;
-  }
-
-  header->_prev   = _end;
-  header->_next   = nullptr;
-  _end            = header;
-  header->_prev->_next = header;
-
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
-
   TRI_ASSERT(_totalSize > 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief unlinks a header from the linked list, without freeing it
+/// @brief unlinks a header, without freeing it
 ////////////////////////////////////////////////////////////////////////////////
 
 void TRI_headers_t::unlink (TRI_doc_mptr_t* header) {
@@ -168,55 +134,25 @@ void TRI_headers_t::unlink (TRI_doc_mptr_t* header) {
 
   TRI_ASSERT(header != nullptr);
   TRI_ASSERT(header->getDataPtr() != nullptr); // ONLY IN HEADERS, PROTECTED by RUNTIME
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 
   size = (int64_t) ((TRI_df_marker_t*) header->getDataPtr())->_size; // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(size > 0);
 
-  // unlink the header
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
-  }
-
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
-  }
-
-  // adjust begin & end pointers
-  if (_begin == header) {
-    _begin = header->_next;
-  }
-
-  if (_end == header) {
-    _end = header->_prev;
-  }
-
-  TRI_ASSERT(_begin != header);
-  TRI_ASSERT(_end != header);
-
   TRI_ASSERT(_nrLinked > 0);
   _nrLinked--;
   _totalSize -= TRI_DF_ALIGN_BLOCK(size);
 
   if (_nrLinked == 0) {
-    TRI_ASSERT(_begin == nullptr);
-    TRI_ASSERT(_end == nullptr);
     TRI_ASSERT(_totalSize == 0);
   }
   else {
-    TRI_ASSERT(_begin != nullptr);
-    TRI_ASSERT(_end != nullptr);
     TRI_ASSERT(_totalSize > 0);
   }
-
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves a header around in the list, using its previous position
-/// (specified in "old"), note that this is only used in revert operations
+/// @brief accounts for reverting the update of a header, using its previous
+/// state (specified in "old"), note that this is only used in revert operations
 ////////////////////////////////////////////////////////////////////////////////
 
 void TRI_headers_t::move (TRI_doc_mptr_t* header,
@@ -226,8 +162,6 @@ void TRI_headers_t::move (TRI_doc_mptr_t* header,
   }
 
   TRI_ASSERT(_nrAllocated > 0);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
   TRI_ASSERT(header->getDataPtr() != nullptr); // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(((TRI_df_marker_t*) header->getDataPtr())->_size > 0); // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(old != nullptr);
@@ -242,51 +176,10 @@ void TRI_headers_t::move (TRI_doc_mptr_t* header,
   // are actually OK:
   _totalSize -= (  TRI_DF_ALIGN_BLOCK(newSize)
                  - TRI_DF_ALIGN_BLOCK(oldSize));
-
-  // adjust list start and end pointers
-  if (old->_prev == nullptr) {
-    _begin = header;
-  }
-  else if (_begin == header) {
-    if (old->_prev != nullptr) {
-      _begin = old->_prev;
-    }
-  }
-
-  if (old->_next == nullptr) {
-    _end = header;
-  }
-  else if (_end == header) {
-    if (old->_next != nullptr) {
-      _end = old->_next;
-    }
-  }
-
-  if (header->_prev != nullptr) {
-    header->_prev->_next = header->_next;
-  }
-  if (header->_next != nullptr) {
-    header->_next->_prev = header->_prev;
-  }
-
-  if (old->_prev != nullptr) {
-    old->_prev->_next = header;
-  }
-  if (old->_next != nullptr) {
-    old->_next->_prev = header;
-  }
-
-  header->_prev = old->_prev;
-  header->_next = old->_next;
-
-  TRI_ASSERT(_begin != nullptr);
-  TRI_ASSERT(_end != nullptr);
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief moves a header back into the list, using its previous position
+/// @brief relinks a header that was unlinked before, using its previous state
 /// (specified in "old")
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -301,16 +194,10 @@ void TRI_headers_t::relink (TRI_doc_mptr_t* header,
   int64_t size = (int64_t) ((TRI_df_marker_t*) header->getDataPtr())->_size; // ONLY IN HEADERS, PROTECTED by RUNTIME
   TRI_ASSERT(size > 0);
 
-  TRI_ASSERT(_begin != header);
-  TRI_ASSERT(_end != header);
-
   this->move(header, old);
   _nrLinked++;
   _totalSize += TRI_DF_ALIGN_BLOCK(size);
   TRI_ASSERT(_totalSize > 0);
-
-  TRI_ASSERT(header->_prev != header);
-  TRI_ASSERT(header->_next != header);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -349,8 +236,6 @@ TRI_doc_mptr_t* TRI_headers_t::request (size_t size) {
       header = ptr;
     }
 
-    _freelist = header;
-
     try {
       _blocks.emplace_back(begin);
     }
@@ -360,6 +245,9 @@ TRI_doc_mptr_t* TRI_headers_t::request (size_t size) {
       TRI_set_errno(TRI_ERROR_OUT_OF_MEMORY);
       return nullptr;
     }
+
+    _freelist = header;
+    _nrReserved += blockSize;
   }
 
   TRI_ASSERT(_freelist != nullptr);
@@ -370,32 +258,6 @@ TRI_doc_mptr_t* TRI_headers_t::request (size_t size) {
   _freelist = static_cast<TRI_doc_mptr_t const*>(result->getDataPtr()); // ONLY IN HEADERS, PROTECTED by RUNTIME
   result->setDataPtr(nullptr); // ONLY IN HEADERS
 
-  // put new header at the end of the list
-  if (_begin == nullptr) {
-    // list of headers is empty
-    TRI_ASSERT(_nrLinked == 0);
-    TRI_ASSERT(_totalSize == 0);
-
-    _begin = result;
-    _end   = result;
-
-    result->_prev   = nullptr;
-    result->_next   = nullptr;
-  }
-  else {
-    // list is not empty
-    TRI_ASSERT(_nrLinked > 0);
-    TRI_ASSERT(_totalSize > 0);
-    TRI_ASSERT(_nrAllocated > 0);
-    TRI_ASSERT(_begin != nullptr);
-    TRI_ASSERT(_end != nullptr);
-
-    _end->_next   = result;
-    result->_prev = _end;
-    result->_next = nullptr;
-    _end          = result;
-  }
-
   _nrAllocated++;
   _nrLinked++;
   _totalSize += (int64_t) TRI_DF_ALIGN_BLOCK(size);
@@ -437,8 +299,7 @@ void TRI_headers_t::release (TRI_doc_mptr_t* header,
     _blocks.clear();
 
     _freelist = nullptr;
-    _begin = nullptr;
-    _end = nullptr;
+    _nrReserved = 0;
   }
 }
 
@@ -37,6 +37,14 @@
 // --SECTION--                                               class TRI_headers_t
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief master pointers of a collection
+///
+/// master pointers are handed out from blocks of increasing size. headers
+/// that are in use are "linked", i.e. they are counted in the number and
+/// total marker size of the collection's active documents
+////////////////////////////////////////////////////////////////////////////////
+
 class TRI_headers_t {
 
 // -----------------------------------------------------------------------------
@@ -80,26 +88,33 @@ class TRI_headers_t {
     }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief move an existing header to the end of the linked list
+/// @brief returns the memory reserved by the blocks, including free headers
+////////////////////////////////////////////////////////////////////////////////
+
+    size_t reservedMemory () const {
+      return _nrReserved * sizeof(TRI_doc_mptr_t);
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief account for an update of an existing header
 ////////////////////////////////////////////////////////////////////////////////
 
     void moveBack (TRI_doc_mptr_t*, TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief unlink an existing header from the linked list, without freeing it
+/// @brief unlink an existing header, without freeing it
 ////////////////////////////////////////////////////////////////////////////////
 
     void unlink (TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief move an existing header to another position in the linked list
+/// @brief account for reverting the update of an existing header
 ////////////////////////////////////////////////////////////////////////////////
 
     void move (TRI_doc_mptr_t*, TRI_doc_mptr_t*);
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief relink an existing header into the linked list, at its original
-/// position
+/// @brief relink an existing header that was unlinked before
 ////////////////////////////////////////////////////////////////////////////////
 
     void relink (TRI_doc_mptr_t*, TRI_doc_mptr_t*);
@@ -123,26 +138,6 @@ class TRI_headers_t {
 
     void adjustTotalSize (int64_t, int64_t);
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief return the element at the head of the list
-///
-/// note: the element returned might be nullptr
-////////////////////////////////////////////////////////////////////////////////
-
-    inline TRI_doc_mptr_t* front () const {
-      return _begin;
-    }
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief return the element at the tail of the list
-///
-/// note: the element returned might be nullptr
-////////////////////////////////////////////////////////////////////////////////
-
-    inline TRI_doc_mptr_t* back () const {
-      return _end;
-    }
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the number of active headers
 ////////////////////////////////////////////////////////////////////////////////
@@ -167,8 +162,7 @@ class TRI_headers_t {
 
     TRI_doc_mptr_t const*         _freelist;    // free headers
 
-    TRI_doc_mptr_t*               _begin;       // start pointer to list of allocated headers
-    TRI_doc_mptr_t*               _end;         // end pointer to list of allocated headers
+    size_t                        _nrReserved;  // number of headers in all blocks
     size_t                        _nrAllocated; // number of allocated headers
     size_t                        _nrLinked;    // number of linked headers
     int64_t                       _totalSize;   // total size of markers for linked headers
@@ -35,6 +35,7 @@
 
 #include <regex.h>
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryRegistry.h"
 #include "Basics/conversions.h"
@@ -2372,6 +2373,7 @@ int TRI_DropDatabaseServer (TRI_server_t* server,
 
   // invalidate all entries for the database
   triagens::aql::QueryCache::instance()->invalidate(vocbase);
+  triagens::aql::PlanCache::instance()->invalidate(vocbase);
 
   int res = TRI_ERROR_NO_ERROR;
 
@@ -1083,18 +1083,13 @@ bool TRI_IsLockedCollectionTransaction (TRI_transaction_collection_t const* trxC
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief add a WAL operation for a transaction collection
+/// @brief prepare the transaction for writing WAL operations
 ////////////////////////////////////////////////////////////////////////////////
 
-int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
-                                 bool& waitForSync) {
-  TRI_transaction_collection_t* trxCollection = operation.trxCollection;
+static int PrepareOperationTransaction (TRI_transaction_collection_t* trxCollection,
+                                        bool& waitForSync) {
   TRI_transaction_t* trx = trxCollection->_transaction;
 
-  TRI_ASSERT(operation.header != nullptr);
-
-  bool const isSingleOperationTransaction = IsSingleOperationTransaction(trx);
-
   // upgrade the info for the transaction
   if (waitForSync || trxCollection->_waitForSync) {
     trx->_waitForSync = true;
@@ -1102,7 +1097,7 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
 
   // default is false
   waitForSync = false;
-  if (isSingleOperationTransaction) {
+  if (IsSingleOperationTransaction(trx)) {
     waitForSync |= trxCollection->_waitForSync;
   }
   
@@ -1123,6 +1118,156 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
     }
   }
 
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether a marker must be written to the WAL with a legend
+////////////////////////////////////////////////////////////////////////////////
+
+static bool NeedsLegendMarker (triagens::wal::document_marker_t const* marker) {
+  return ((marker->_type == TRI_WAL_MARKER_DOCUMENT ||
+           marker->_type == TRI_WAL_MARKER_EDGE) &&
+          ! triagens::wal::LogfileManager::instance()->suppressShapeInformation());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build a copy of a document or edge marker that includes the legend
+/// for its shape
+////////////////////////////////////////////////////////////////////////////////
+
+static int CreateLegendMarker (TRI_document_collection_t* document,
+                               char const* oldmarker,
+                               std::unique_ptr<char[]>& newmarker,
+                               int64_t& sizeChanged) {
+  auto oldm = reinterpret_cast<triagens::wal::document_marker_t const*>(oldmarker);
+
+  triagens::basics::JsonLegend legend(document->getShaper());  // PROTECTED by trx in trxCollection
+  int res = legend.addShape(oldm->_shape, oldmarker + oldm->_offsetJson,
+                            oldm->_size - oldm->_offsetJson);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  sizeChanged =   legend.getSize() 
+                - (oldm->_offsetJson - oldm->_offsetLegend);
+  TRI_voc_size_t newMarkerSize = (TRI_voc_size_t) (oldm->_size + sizeChanged);
+
+  // Now construct the new marker on the heap:
+  newmarker.reset(new char[newMarkerSize]);
+  memcpy(newmarker.get(), oldmarker, oldm->_offsetLegend);
+  legend.dump(newmarker.get() + oldm->_offsetLegend);
+  memcpy(newmarker.get() + oldm->_offsetLegend + legend.getSize(), 
+         oldmarker + oldm->_offsetJson,
+         oldm->_size - oldm->_offsetJson);
+
+  // And fix its entries:
+  auto newm = reinterpret_cast<triagens::wal::document_marker_t*>(newmarker.get());
+  newm->_size = newMarkerSize;
+  newm->_offsetJson = (uint32_t) (oldm->_offsetLegend + legend.getSize());
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register an operation that has been written to the WAL with the
+/// transaction collection
+////////////////////////////////////////////////////////////////////////////////
+
+static int RegisterOperationTransaction (triagens::wal::DocumentOperation& operation,
+                                         TRI_voc_fid_t fid,
+                                         void const* position,
+                                         int64_t sizeChanged) {
+  TRI_transaction_collection_t* trxCollection = operation.trxCollection;
+  TRI_transaction_t* trx = trxCollection->_transaction;
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+
+  TRI_ASSERT(fid > 0);
+  TRI_ASSERT(position != nullptr);
+  
+  if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT ||
+      operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE) {
+    // adjust the data position in the header
+    operation.header->setDataPtr(position);  // PROTECTED by ongoing trx from operation
+    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT && sizeChanged) {
+      document->_headersPtr->adjustTotalSize(0, sizeChanged);
+    }
+  }
+  
+  TRI_IF_FAILURE("TransactionOperationAfterAdjust") {
+    return TRI_ERROR_DEBUG;
+  }
+
+  // set header file id
+  operation.header->_fid = fid;
+
+  TRI_ASSERT(operation.header->_fid > 0);
+
+  if (IsSingleOperationTransaction(trx)) {
+    // operation is directly executed
+    operation.handle();
+     
+    triagens::aql::QueryCache::instance()->invalidate(trx->_vocbase, document->_info._name);
+
+    ++document->_uncollectedLogfileEntries;
+
+    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
+        operation.type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
+      // update datafile statistics for the old header
+      TRI_ASSERT(operation.oldHeader._fid > 0);
+       
+      TRI_LOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+
+      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, operation.oldHeader._fid, false);
+      // the old header might point to the WAL. in this case, there'll be no stats update
+
+      if (dfi != nullptr) {
+        TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(operation.oldHeader.getDataPtr());  // PROTECTED by trx from above
+        dfi->_numberDead += 1;
+        dfi->_sizeDead += TRI_DF_ALIGN_BLOCK(marker->_size);
+        dfi->_numberAlive -= 1;
+        dfi->_sizeAlive -= TRI_DF_ALIGN_BLOCK(marker->_size);
+      }
+      
+      TRI_UNLOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+    }
+  }
+  else {
+    // operation is buffered and might be rolled back
+    if (trxCollection->_operations == nullptr) {
+      trxCollection->_operations = new std::vector<triagens::wal::DocumentOperation*>;
+      trx->_hasOperations = true;
+    }
+
+    triagens::wal::DocumentOperation* copy = operation.swap();
+    trxCollection->_operations->push_back(copy);
+    copy->handle();
+  }
+
+  TRI_UpdateRevisionDocumentCollection(document, operation.rid, false);
+  
+  TRI_IF_FAILURE("TransactionOperationAtEnd") {
+    return TRI_ERROR_DEBUG;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add a WAL operation for a transaction collection
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
+                                 bool& waitForSync) {
+  TRI_ASSERT(operation.header != nullptr);
+
+  int res = PrepareOperationTransaction(operation.trxCollection, waitForSync);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
   TRI_voc_fid_t fid = 0;
   void const* position = nullptr;
 
@@ -1133,9 +1278,7 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
     // this is a "real" marker that must be written into the logfiles
     char* oldmarker = static_cast<char*>(operation.marker->mem());
     auto oldm = reinterpret_cast<triagens::wal::document_marker_t*>(oldmarker);
-    if ((oldm->_type == TRI_WAL_MARKER_DOCUMENT ||
-         oldm->_type == TRI_WAL_MARKER_EDGE) &&
-         ! triagens::wal::LogfileManager::instance()->suppressShapeInformation()) {
+    if (NeedsLegendMarker(oldm)) {
       // In this case we have to take care of the legend, we know that the
       // marker does not have a legend so far, so first try to get away 
       // with this:
@@ -1146,38 +1289,21 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
       triagens::wal::SlotInfoCopy slotInfo = triagens::wal::LogfileManager::instance()->allocateAndWrite(oldmarker, operation.marker->size(), false, cid, sid, 0, oldLegend);
       if (slotInfo.errorCode == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE) {
         // Oh dear, we have to build a legend and patch the marker:
-        triagens::basics::JsonLegend legend(document->getShaper());  // PROTECTED by trx in trxCollection
-        int res = legend.addShape(sid, oldmarker + oldm->_offsetJson,
-                                       oldm->_size - oldm->_offsetJson);
+        std::unique_ptr<char[]> newmarker;
+        res = CreateLegendMarker(document, oldmarker, newmarker, sizeChanged);
+
         if (res != TRI_ERROR_NO_ERROR) {
           return res;
         }
-        else {
-          sizeChanged =   legend.getSize() 
-                        - (oldm->_offsetJson - oldm->_offsetLegend);
-          TRI_voc_size_t newMarkerSize = (TRI_voc_size_t) (oldm->_size + sizeChanged);
-
-          // Now construct the new marker on the heap:
-          char* newmarker = new char[newMarkerSize];
-          memcpy(newmarker, oldmarker, oldm->_offsetLegend);
-          legend.dump(newmarker + oldm->_offsetLegend);
-          memcpy(newmarker + oldm->_offsetLegend + legend.getSize(), 
-                 oldmarker + oldm->_offsetJson,
-                 oldm->_size - oldm->_offsetJson);
-
-          // And fix its entries:
-          auto newm = reinterpret_cast<triagens::wal::document_marker_t*>(newmarker);
-          newm->_size = newMarkerSize;
-          newm->_offsetJson = (uint32_t) (oldm->_offsetLegend + legend.getSize());
-          triagens::wal::SlotInfoCopy slotInfo2 = triagens::wal::LogfileManager::instance()->allocateAndWrite(newmarker, newMarkerSize, false, cid, sid, newm->_offsetLegend, oldLegend);
-          delete[] newmarker;
-          if (slotInfo2.errorCode != TRI_ERROR_NO_ERROR) {
-            return slotInfo2.errorCode;
-          }
-          fid = slotInfo2.logfileId;
-          position = slotInfo2.mem; 
-          operation.tick = slotInfo2.tick;
+
+        auto newm = reinterpret_cast<triagens::wal::document_marker_t*>(newmarker.get());
+        triagens::wal::SlotInfoCopy slotInfo2 = triagens::wal::LogfileManager::instance()->allocateAndWrite(newmarker.get(), newm->_size, false, cid, sid, newm->_offsetLegend, oldLegend);
+        if (slotInfo2.errorCode != TRI_ERROR_NO_ERROR) {
+          return slotInfo2.errorCode;
         }
+        fid = slotInfo2.logfileId;
+        position = slotInfo2.mem; 
+        operation.tick = slotInfo2.tick;
       }
       else if (slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
         return slotInfo.errorCode;
@@ -1214,72 +1340,151 @@ int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
     position = operation.marker->mem();
   }
    
-  TRI_ASSERT(fid > 0);
-  TRI_ASSERT(position != nullptr);
-  
-  if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT ||
-      operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE) {
-    // adjust the data position in the header
-    operation.header->setDataPtr(position);  // PROTECTED by ongoing trx from operation
-    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT && sizeChanged) {
-      document->_headersPtr->adjustTotalSize(0, sizeChanged);
-    }
+  return RegisterOperationTransaction(operation, fid, position, sizeChanged);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add several WAL operations for the same transaction collection
+///
+/// The markers of all operations are written with batched slot reservations,
+/// so the WAL reservation turn is taken once per batch of slots instead of
+/// once per marker. Operations are processed in order. The result for each
+/// operation is stored in results. Operations that failed have not been
+/// registered with the transaction, and must be reverted by the caller.
+/// The function only returns an error if no operation could be written.
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AddOperationsTransaction (std::vector<triagens::wal::DocumentOperation*>& operations,
+                                  std::vector<int>& results,
+                                  bool& waitForSync) {
+  size_t const n = operations.size();
+
+  results.assign(n, TRI_ERROR_NO_ERROR);
+
+  if (n == 0) {
+    return TRI_ERROR_NO_ERROR;
   }
-  
-  TRI_IF_FAILURE("TransactionOperationAfterAdjust") {
-    return TRI_ERROR_DEBUG;
+
+  TRI_transaction_collection_t* trxCollection = operations[0]->trxCollection;
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+
+  int res = PrepareOperationTransaction(trxCollection, waitForSync);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    results.assign(n, res);
+    return res;
   }
 
-  // set header file id
-  operation.header->_fid = fid;
+  auto logfileManager = triagens::wal::LogfileManager::instance();
 
-  TRI_ASSERT(operation.header->_fid > 0);
+  std::vector<triagens::wal::SlotRequest> requests;
+  requests.reserve(n);
 
-  if (isSingleOperationTransaction) {
-    // operation is directly executed
-    operation.handle();
-     
-    triagens::aql::QueryCache::instance()->invalidate(trx->_vocbase, document->_info._name);
+  for (auto operation : operations) {
+    TRI_ASSERT(operation->header != nullptr);
+    TRI_ASSERT(operation->trxCollection == trxCollection);
+    // envelope markers are never part of a batch
+    TRI_ASSERT(operation->marker->fid() == 0);
 
-    ++document->_uncollectedLogfileEntries;
+    auto m = static_cast<triagens::wal::document_marker_t const*>(operation->marker->mem());
 
-    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
-        operation.type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
-      // update datafile statistics for the old header
-      TRI_ASSERT(operation.oldHeader._fid > 0);
-       
-      TRI_LOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+    if (NeedsLegendMarker(m)) {
+      requests.emplace_back(operation->marker->size(), m->_collectionId, m->_shape, 0);
+    }
+    else {
+      requests.emplace_back(operation->marker->size());
+    }
+  }
 
-      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, operation.oldHeader._fid, false);
-      // the old header might point to the WAL. in this case, there'll be no stats update
+  // markers that had to be rebuilt with a legend
+  std::vector<std::unique_ptr<char[]>> legendMarkers(n);
+  std::vector<int64_t> sizeChanged(n, 0);
+  std::vector<TRI_voc_fid_t> fids(n, 0);
+  std::vector<void const*> positions(n, nullptr);
 
-      if (dfi != nullptr) {
-        TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(operation.oldHeader.getDataPtr());  // PROTECTED by trx from above
-        dfi->_numberDead += 1;
-        dfi->_sizeDead += TRI_DF_ALIGN_BLOCK(marker->_size);
-        dfi->_numberAlive -= 1;
-        dfi->_sizeAlive -= TRI_DF_ALIGN_BLOCK(marker->_size);
+  std::vector<triagens::wal::SlotInfo> slots;
+  size_t i = 0;
+
+  while (i < n) {
+    slots.clear();
+    res = logfileManager->allocate(requests, i, slots);
+
+    // fill and return all slots we got, regardless of res
+    for (auto& slotInfo : slots) {
+      auto const& request = requests[i];
+      char* mem = legendMarkers[i] != nullptr ? legendMarkers[i].get() : static_cast<char*>(operations[i]->marker->mem());
+
+      if (request.checkLegend && request.legendOffset == 0) {
+        // the legend is already in the WAL file. point to it, relative
+        // to the position the marker is written to
+        auto m = reinterpret_cast<triagens::wal::document_marker_t*>(mem);
+        int64_t* legendPtr = reinterpret_cast<int64_t*>(mem + m->_offsetLegend);
+        *legendPtr =  static_cast<char const*>(request.oldLegend)
+                     -(static_cast<char const*>(slotInfo.mem) + m->_offsetLegend);
       }
-      
-      TRI_UNLOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+
+      try {
+        slotInfo.slot->fill(mem, request.size);
+
+        // we must copy the slotinfo because finalize() will set its internal to 0 again
+        triagens::wal::SlotInfoCopy copy(slotInfo.slot);
+        operations[i]->tick = copy.tick;
+        fids[i] = copy.logfileId;
+        positions[i] = copy.mem;
+      }
+      catch (...) {
+        results[i] = TRI_ERROR_INTERNAL;
+      }
+
+      // if we don't return the slot we'll run into serious problems later
+      logfileManager->finalize(slotInfo, false);
+      ++i;
     }
-  }
-  else {
-    // operation is buffered and might be rolled back
-    if (trxCollection->_operations == nullptr) {
-      trxCollection->_operations = new std::vector<triagens::wal::DocumentOperation*>;
-      trx->_hasOperations = true;
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      continue;
     }
 
-    triagens::wal::DocumentOperation* copy = operation.swap();
-    trxCollection->_operations->push_back(copy);
-    copy->handle();
+    TRI_ASSERT(i < n);
+
+    if (res == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE) {
+      // we have to build a legend for this marker, and ask again
+      auto& request = requests[i];
+      res = CreateLegendMarker(document, static_cast<char const*>(operations[i]->marker->mem()), legendMarkers[i], sizeChanged[i]);
+
+      if (res == TRI_ERROR_NO_ERROR) {
+        auto newm = reinterpret_cast<triagens::wal::document_marker_t const*>(legendMarkers[i].get());
+        request.size = newm->_size;
+        request.legendOffset = newm->_offsetLegend;
+        continue;
+      }
+    }
+
+    if (res == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE ||
+        res == TRI_ERROR_ARANGO_DOCUMENT_TOO_LARGE) {
+      // only this operation is affected
+      results[i++] = res;
+      continue;
+    }
+
+    // the WAL cannot take any more operations
+    while (i < n) {
+      results[i++] = res;
+    }
   }
 
-  TRI_UpdateRevisionDocumentCollection(document, operation.rid, false);
-  
-  TRI_IF_FAILURE("TransactionOperationAtEnd") {
-    return TRI_ERROR_DEBUG;
+  // register the written operations
+  bool written = false;
+
+  for (i = 0; i < n; ++i) {
+    if (results[i] == TRI_ERROR_NO_ERROR) {
+      results[i] = RegisterOperationTransaction(*operations[i], fids[i], positions[i], sizeChanged[i]);
+      written = true;
+    }
+  }
+
+  if (! written) {
+    return results[0];
   }
 
   return TRI_ERROR_NO_ERROR;
@@ -35,6 +35,7 @@
 
 #include <regex.h>
 
+#include "Aql/PlanCache.h"
 #include "Aql/QueryCache.h"
 #include "Aql/QueryList.h"
 #include "Basics/conversions.h"
@@ -779,6 +780,8 @@ static int RenameCollection (TRI_vocbase_t* vocbase,
 
   // invalidate all entries for the two collections
   triagens::aql::QueryCache::instance()->invalidate(vocbase, std::vector<char const*>{ oldName, newName });
+  triagens::aql::PlanCache::instance()->invalidate(vocbase, oldName);
+  triagens::aql::PlanCache::instance()->invalidate(vocbase, newName);
 
   return TRI_ERROR_NO_ERROR;
 }
@@ -1162,6 +1165,7 @@ static int DropCollection (TRI_vocbase_t* vocbase,
   TRI_EVENTUAL_WRITE_LOCK_STATUS_VOCBASE_COL(collection);
 
   triagens::aql::QueryCache::instance()->invalidate(vocbase, collection->_name); 
+  triagens::aql::PlanCache::instance()->invalidate(vocbase, collection->_name);
 
   // .............................................................................
   // collection already deleted
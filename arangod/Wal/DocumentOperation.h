@@ -93,7 +93,7 @@ namespace triagens {
         TRI_document_collection_t* document = trxCollection->_collection->_collection;
 
         if (type == TRI_VOC_DOCUMENT_OPERATION_UPDATE) {
-          // move header to the end of the list
+          // account for the size of the updated document
           document->_headersPtr->moveBack(header, &oldHeader);  // PROTECTED by trx in trxCollection
         }
 
@@ -113,6 +113,16 @@ static inline uint32_t MaxSlots () {
   return 1024 * 1024 * 16;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of slots reserved at once for a batch of entries
+/// must stay well below MinSlots, because reserved slots are not recycled
+/// before they are returned
+////////////////////////////////////////////////////////////////////////////////
+
+static inline size_t MaxBatchSlots () {
+  return 256;
+}
+
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                              class LogfileManager
@@ -827,6 +837,48 @@ SlotInfo LogfileManager::allocate (uint32_t size,
   return _slots->nextUnused(size, cid, sid, legendOffset, oldLegend);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocate space in a logfile for several entries at once
+///
+/// Reserves slots for the requests starting at position from, and appends
+/// them to slots. At most MaxBatchSlots slots are reserved per call, and the
+/// slots layer may reserve fewer (see Slots::nextUnused). The caller must
+/// finalize all slots it got, even if an error is returned for the request
+/// that follows them. Requests are treated like in the legend version of
+/// allocate if their checkLegend flag is set.
+////////////////////////////////////////////////////////////////////////////////
+
+int LogfileManager::allocate (std::vector<SlotRequest>& requests,
+                              size_t from,
+                              std::vector<SlotInfo>& slots) {
+  TRI_ASSERT(from < requests.size());
+
+  if (! _allowWrites) {
+    // no writes allowed
+    return TRI_ERROR_ARANGO_READ_ONLY;
+  }
+
+  size_t to = (std::min)(requests.size(), from + MaxBatchSlots());
+
+  for (size_t i = from; i < to; ++i) {
+    uint32_t size = requests[i].size;
+
+    if (size > MaxEntrySize() ||
+        (size > _filesize && ! _allowOversizeEntries)) {
+      // entry is too big
+      if (i == from) {
+        return TRI_ERROR_ARANGO_DOCUMENT_TOO_LARGE;
+      }
+
+      // reserve the entries before it, and let the caller ask again
+      to = i;
+      break;
+    }
+  }
+
+  return _slots->nextUnused(requests, from, to, slots);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finalize a log entry
 ////////////////////////////////////////////////////////////////////////////////
@@ -1743,7 +1795,13 @@ int LogfileManager::runRecovery () {
   // this is because all other threads competing for the lock are
   // not active yet
   { 
-    int res = _recoverState->replayLogfiles();
+    int res = _recoverState->loadCollections();
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    res = _recoverState->replayLogfiles();
 
     if (res != TRI_ERROR_NO_ERROR) {
       return res;
@@ -459,6 +459,14 @@ namespace triagens {
                            uint32_t legendOffset,
                            void*& oldLegend);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reserve space in a logfile for several entries at once
+////////////////////////////////////////////////////////////////////////////////
+
+        int allocate (std::vector<SlotRequest>&,
+                      size_t,
+                      std::vector<SlotInfo>&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finalize a log entry
 ////////////////////////////////////////////////////////////////////////////////
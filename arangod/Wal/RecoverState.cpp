@@ -33,6 +33,7 @@
 #include "Basics/files.h"
 #include "Basics/Exceptions.h"
 #include "Basics/memory-map.h"
+#include "Basics/ThreadPool.h"
 #include "VocBase/collection.h"
 #include "VocBase/replication-applier.h"
 #include "VocBase/VocShaper.h"
@@ -553,18 +554,44 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
       state->failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, true)));
       break;
     }
-/*
+
     // -----------------------------------------------------------------------------
-    // create markers 
+    // data markers
     // -----------------------------------------------------------------------------
 
+    case TRI_WAL_MARKER_DOCUMENT: {
+      document_marker_t const* m = reinterpret_cast<document_marker_t const*>(marker);
+      // note that the collection must be loaded for replaying
+      state->usedCollections.emplace(m->_collectionId, m->_databaseId);
+      break;
+    }
+
+    case TRI_WAL_MARKER_EDGE: {
+      edge_marker_t const* m = reinterpret_cast<edge_marker_t const*>(marker);
+      // note that the collection must be loaded for replaying
+      state->usedCollections.emplace(m->_collectionId, m->_databaseId);
+      break;
+    }
+
+    case TRI_WAL_MARKER_REMOVE: {
+      remove_marker_t const* m = reinterpret_cast<remove_marker_t const*>(marker);
+      // note that the collection must be loaded for replaying
+      state->usedCollections.emplace(m->_collectionId, m->_databaseId);
+      break;
+    }
+
     case TRI_WAL_MARKER_CREATE_COLLECTION: {
       collection_create_marker_t const* m = reinterpret_cast<collection_create_marker_t const*>(marker);
-      // undo a potential drop marker discovered before for the same collection
-      state->droppedCollections.erase(m->_collectionId);
+      // replaying the marker will drop and re-create the collection, so it
+      // must not be loaded in advance
+      state->createdIds.insert(m->_collectionId);
       break;
     }
-  
+/*
+    // -----------------------------------------------------------------------------
+    // create markers 
+    // -----------------------------------------------------------------------------
+
     case TRI_WAL_MARKER_CREATE_DATABASE: {
       database_create_marker_t const* m = reinterpret_cast<database_create_marker_t const*>(marker);
       // undo a potential drop marker discovered before for the same database
@@ -1345,6 +1372,81 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the collections referenced by data markers in the logfiles
+////////////////////////////////////////////////////////////////////////////////
+
+int RecoverState::loadCollections () {
+  if (server->_indexPool == nullptr) {
+    // no parallelism configured. collections are loaded on demand
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  std::vector<std::pair<TRI_vocbase_t*, TRI_voc_cid_t>> toLoad;
+  toLoad.reserve(usedCollections.size());
+
+  // databases are looked up here, as useDatabase() is not thread-safe
+  for (auto const& it : usedCollections) {
+    TRI_voc_cid_t collectionId = it.first;
+    TRI_voc_tick_t databaseId  = it.second;
+
+    if (willBeDropped(collectionId) || 
+        createdIds.find(collectionId) != createdIds.end() ||
+        isDropped(databaseId, collectionId) ||
+        openedCollections.find(collectionId) != openedCollections.end()) {
+      continue;
+    }
+
+    TRI_vocbase_t* vocbase = useDatabase(databaseId);
+
+    if (vocbase != nullptr) {
+      toLoad.emplace_back(vocbase, collectionId);
+    }
+  }
+
+  size_t const n = toLoad.size();
+
+  if (n < 2) {
+    // not worth it
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  LOG_TRACE("loading %llu collections for WAL recovery", (unsigned long long) n);
+
+  std::vector<TRI_vocbase_col_t*> collections(n, nullptr);
+
+  {
+    // loading a collection fills its indexes using the server's index pool,
+    // so the collections are loaded by a separate pool
+    size_t const numThreads = (std::min)(server->_indexPool->numThreads(), n - 1);
+    triagens::basics::ThreadPool pool(numThreads, "RecoveryLoader");
+
+    pool.parallelFor(n, [&toLoad, &collections] (size_t i) -> void {
+      TRI_vocbase_col_status_e status; // ignored here
+      collections[i] = TRI_UseCollectionByIdVocBase(toLoad[i].first, toLoad[i].second, status);
+    });
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    TRI_vocbase_col_t* collection = collections[i];
+
+    if (collection == nullptr) {
+      // will be retried when replaying the logfiles
+      continue;
+    }
+
+    TRI_document_collection_t* document = collection->_collection;
+    TRI_ASSERT(document != nullptr);
+
+    // disable secondary indexes for the moment
+    document->useSecondaryIndexes(false);
+
+    openedCollections.emplace(toLoad[i].second, collection);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replay a single logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -214,6 +214,16 @@ namespace triagens {
                                      void*,
                                      TRI_datafile_t*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the collections referenced by data markers in the logfiles
+///
+/// the collections are loaded in parallel before the logfiles are replayed.
+/// collections that cannot be loaded here are ignored, as replaying the
+/// logfiles will try to load them again and report errors
+////////////////////////////////////////////////////////////////////////////////
+
+      int loadCollections ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replay a single logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -253,6 +263,8 @@ namespace triagens {
       std::unordered_set<TRI_voc_cid_t>                                           droppedCollections;
       std::unordered_set<TRI_voc_tick_t>                                          droppedDatabases;
       std::unordered_set<TRI_voc_cid_t>                                           droppedIds;
+      std::unordered_set<TRI_voc_cid_t>                                           createdIds;
+      std::unordered_map<TRI_voc_cid_t, TRI_voc_tick_t>                           usedCollections;
 
       TRI_voc_tick_t                                                              lastTick;
       std::vector<Logfile*>                                                       logfilesToProcess;
@@ -147,7 +147,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         inline bool isUnused () const {
-          return _status == StatusType::UNUSED;
+          return _status.load(std::memory_order_acquire) == StatusType::UNUSED;
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -155,7 +155,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         inline bool isUsed () const {
-          return _status == StatusType::USED;
+          return _status.load(std::memory_order_acquire) == StatusType::USED;
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -163,8 +163,9 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         inline bool isReturned () const {
-          return (_status == StatusType::RETURNED ||
-                  _status == StatusType::RETURNED_WFS);
+          auto status = _status.load(std::memory_order_acquire);
+          return (status == StatusType::RETURNED ||
+                  status == StatusType::RETURNED_WFS);
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -172,7 +173,7 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         inline bool waitForSync () const {
-          return (_status == StatusType::RETURNED_WFS);
+          return (_status.load(std::memory_order_acquire) == StatusType::RETURNED_WFS);
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -232,9 +233,12 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief slot status
+/// the status is written with release semantics after all other slot
+/// members have been set up, so a thread that observes a status can also
+/// safely read the other slot members without holding a lock
 ////////////////////////////////////////////////////////////////////////////////
 
-        StatusType _status;
+        std::atomic<StatusType> _status;
 
     };
 
@@ -36,8 +36,41 @@
 #include "VocBase/server.h"
 #include "Wal/LogfileManager.h"
 
+#ifdef TRI_HAVE_SCHED_H
+#include <sched.h>
+#endif
+
 using namespace triagens::wal;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                   class Slots::ReservationLocker
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scoped holder of the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+class Slots::ReservationLocker {
+
+  public:
+
+    ReservationLocker (ReservationLocker const&) = delete;
+    ReservationLocker& operator= (ReservationLocker const&) = delete;
+
+    explicit ReservationLocker (Slots* slots)
+      : _slots(slots) {
+      _slots->acquireReservation();
+    }
+
+    ~ReservationLocker () {
+      _slots->releaseReservation();
+    }
+
+  private:
+
+    Slots* _slots;
+};
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -52,6 +85,9 @@ Slots::Slots (LogfileManager* logfileManager,
   : _logfileManager(logfileManager),
     _condition(),
     _lock(),
+    _reserved(false),
+    _parked(0),
+    _turnCondition(),
     _slots(nullptr),
     _numberOfSlots(numberOfSlots),
     _freeSlots(numberOfSlots),
@@ -86,10 +122,9 @@ Slots::~Slots () {
 void Slots::statistics (Slot::TickType& lastTick,
                         Slot::TickType& lastDataTick,
                         uint64_t& numEvents) {
-  MUTEX_LOCKER(_lock);
-  lastTick     = _lastCommittedTick;
-  lastDataTick = _lastCommittedDataTick;
-  numEvents    = _numEvents;
+  lastTick     = _lastCommittedTick.load(std::memory_order_acquire);
+  lastDataTick = _lastCommittedDataTick.load(std::memory_order_acquire);
+  numEvents    = _numEvents.load(std::memory_order_relaxed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -130,8 +165,7 @@ int Slots::flush (bool waitForSync) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Slot::TickType Slots::lastCommittedTick () {
-  MUTEX_LOCKER(_lock);
-  return _lastCommittedTick;
+  return _lastCommittedTick.load(std::memory_order_acquire);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -141,117 +175,36 @@ Slot::TickType Slots::lastCommittedTick () {
 SlotInfo Slots::nextUnused (uint32_t size) {
   // we need to use the aligned size for writing
   uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(size);
-  int iterations = 0;
-  bool hasWaited = false;
 
   TRI_ASSERT(size > 0);
 
-  while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
-
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
+  ReservationLocker locker(this);
 
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
+  Slot* slot = nullptr;
+  int res = waitForUnusedSlot(slot);
 
-        // cycle until we have a valid logfile
-        while (_logfile == nullptr ||
-               _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
-
-          if (_logfile != nullptr) {
-            // seal existing logfile by creating a footer marker
-            int res = writeFooter(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileSealRequested(_logfile);
-
-            _logfile = nullptr;
-          }
-            
-          TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-            return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
-          }
-
-          // fetch the next free logfile (this may create a new one)
-          Logfile::StatusType status;
-          int res = newLogfile(alignedSize, status);
-
-          if (res != TRI_ERROR_NO_ERROR) {
-            if (res != TRI_ERROR_ARANGO_NO_JOURNAL) {
-              return SlotInfo(res);
-            }
-
-            usleep(10 * 1000);
-            // try again in next iteration
-          }
-          else {
-            TRI_ASSERT(_logfile != nullptr);
-
-            if (status == Logfile::StatusType::EMPTY) {
-              // initialize the empty logfile by writing a header marker
-              int res = writeHeader(slot);
-
-              if (res != TRI_ERROR_NO_ERROR) {
-                return SlotInfo(res);
-              }
-
-              // advance to next slot
-              slot = &_slots[_handoutIndex];
-              _logfileManager->setLogfileOpen(_logfile);
-            }
-            else {
-              TRI_ASSERT(status == Logfile::StatusType::OPEN);
-            }
-          }
-        }
-
-        // if we get here, we got a free slot for the actual data...
-
-        char* mem = _logfile->reserve(alignedSize);
+  if (res != TRI_ERROR_NO_ERROR) {
+    return SlotInfo(res);
+  }
 
-        if (mem == nullptr) {
-          return SlotInfo(TRI_ERROR_INTERNAL);
-        }
+  res = ensureLogfile(alignedSize, slot);
 
-        // only in this case we return a valid slot
-        slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
+  if (res != TRI_ERROR_NO_ERROR) {
+    return SlotInfo(res);
+  }
 
-        return SlotInfo(slot);
-      }
-    }
-    
-    // if we get here, all slots are busy
-    CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
-    }
+  // if we get here, we got a free slot for the actual data...
 
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
-    }
+  char* mem = _logfile->reserve(alignedSize);
 
-    if (mustWait) {
-      guard.wait(10 * 1000);
-    }
-            
+  if (mem == nullptr) {
+    return SlotInfo(TRI_ERROR_INTERNAL);
   }
 
-  return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
+  // only in this case we return a valid slot
+  slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
+
+  return SlotInfo(slot);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -269,131 +222,138 @@ SlotInfo Slots::nextUnused (uint32_t size,
                             // legendOffset 0 means no legend included
   // we need to use the aligned size for writing
   uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(size);
-  int iterations = 0;
-  bool hasWaited = false;
 
   TRI_ASSERT(size > 0);
 
-  while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
+  ReservationLocker locker(this);
 
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
+  Slot* slot = nullptr;
+  int res = waitForUnusedSlot(slot);
 
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
+  if (res != TRI_ERROR_NO_ERROR) {
+    return SlotInfo(res);
+  }
 
-        // cycle until we have a valid logfile
-        while (_logfile == nullptr ||
-               _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
-
-          if (_logfile != nullptr) {
-            // seal existing logfile by creating a footer marker
-            int res = writeFooter(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              return SlotInfo(res);
-            }
-
-            // advance to next slot
-            slot = &_slots[_handoutIndex];
-            _logfileManager->setLogfileSealRequested(_logfile);
-
-            _logfile = nullptr;
-          }
-            
-          TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-            return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
-          }
-
-          // fetch the next free logfile (this may create a new one)
-          Logfile::StatusType status;
-          int res = newLogfile(alignedSize, status);
-
-          if (res != TRI_ERROR_NO_ERROR) {
-            if (res != TRI_ERROR_ARANGO_NO_JOURNAL) {
-              return SlotInfo(res);
-            }
-
-            usleep(10 * 1000);
-            // try again in next iteration
-          }
-          else {
-            TRI_ASSERT(_logfile != nullptr);
-
-            if (status == Logfile::StatusType::EMPTY) {
-              // initialize the empty logfile by writing a header marker
-              int res = writeHeader(slot);
-
-              if (res != TRI_ERROR_NO_ERROR) {
-                return SlotInfo(res);
-              }
-
-              // advance to next slot
-              slot = &_slots[_handoutIndex];
-              _logfileManager->setLogfileOpen(_logfile);
-            }
-            else {
-              TRI_ASSERT(status == Logfile::StatusType::OPEN);
-            }
-          }
-        }
+  res = ensureLogfile(alignedSize, slot);
 
-        // if we get here, we got a free slot for the actual data...
-        
-        // Now sort out the legend business:
-        if (legendOffset == 0) {
-          void* legend = _logfile->lookupLegend(cid, sid);
-          if (nullptr == legend) {
-            // Bad, we would need a legend for this marker
-            return SlotInfo(TRI_ERROR_LEGEND_NOT_IN_WAL_FILE);
-          }
-          oldLegend = legend;
-        }
+  if (res != TRI_ERROR_NO_ERROR) {
+    return SlotInfo(res);
+  }
 
-        char* mem = _logfile->reserve(alignedSize);
+  // if we get here, we got a free slot for the actual data...
+  
+  // Now sort out the legend business:
+  if (legendOffset == 0) {
+    void* legend = _logfile->lookupLegend(cid, sid);
+    if (nullptr == legend) {
+      // Bad, we would need a legend for this marker
+      return SlotInfo(TRI_ERROR_LEGEND_NOT_IN_WAL_FILE);
+    }
+    oldLegend = legend;
+  }
 
-        if (mem == nullptr) {
-          return SlotInfo(TRI_ERROR_INTERNAL);
-        }
+  char* mem = _logfile->reserve(alignedSize);
 
-        if (legendOffset != 0) {
-          void* legend = static_cast<void*>(mem + legendOffset);
-          _logfile->cacheLegend(cid, sid, legend);
-        }
+  if (mem == nullptr) {
+    return SlotInfo(TRI_ERROR_INTERNAL);
+  }
+
+  if (legendOffset != 0) {
+    void* legend = static_cast<void*>(mem + legendOffset);
+    _logfile->cacheLegend(cid, sid, legend);
+  }
+
+  // only in this case we return a valid slot
+  slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
+
+  return SlotInfo(slot);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return unused slots for a range of requests
+///
+/// All slots are reserved under a single reservation turn. Only the first
+/// request may wait for a free slot or switch the logfile. Later requests are
+/// only served while the next slot is unused and the current logfile has
+/// enough space left, because the slots reserved so far are not yet returned
+/// and would otherwise keep the synchronizer from recycling slots or sealing
+/// the logfile we wait for. The caller returns the reserved slots and asks
+/// again for the remaining requests.
+///
+/// The legend handling is the same as in the legend version of nextUnused.
+/// If the legend for a request is not found, the slots reserved so far are
+/// handed out and TRI_ERROR_LEGEND_NOT_IN_WAL_FILE is returned for the
+/// request that follows them.
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::nextUnused (std::vector<SlotRequest>& requests,
+                       size_t from,
+                       size_t to,
+                       std::vector<SlotInfo>& result) {
+  TRI_ASSERT(from < to);
+  TRI_ASSERT(to <= requests.size());
+
+  ReservationLocker locker(this);
 
-        // only in this case we return a valid slot
-        slot->setUsed(static_cast<void*>(mem), size, _logfile->id(), handout());
+  for (size_t i = from; i < to; ++i) {
+    auto& request = requests[i];
 
-        return SlotInfo(slot);
+    TRI_ASSERT(request.size > 0);
+
+    // we need to use the aligned size for writing
+    uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(request.size);
+    Slot* slot = nullptr;
+
+    if (i == from) {
+      int res = waitForUnusedSlot(slot);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      res = ensureLogfile(alignedSize, slot);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
       }
     }
-    
-    // if we get here, all slots are busy
-    CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
+    else {
+      slot = &_slots[_handoutIndex];
+
+      if (! slot->isUnused() ||
+          _logfile == nullptr ||
+          _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
+        // let the caller return the slots reserved so far
+        return TRI_ERROR_NO_ERROR;
+      }
     }
 
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
+    if (request.checkLegend && request.legendOffset == 0) {
+      void* legend = _logfile->lookupLegend(request.cid, request.sid);
+
+      if (nullptr == legend) {
+        // we would need a legend for this marker
+        return TRI_ERROR_LEGEND_NOT_IN_WAL_FILE;
+      }
+      request.oldLegend = legend;
     }
 
-    if (mustWait) {
-      guard.wait(10 * 1000);
+    char* mem = _logfile->reserve(alignedSize);
+
+    if (mem == nullptr) {
+      return TRI_ERROR_INTERNAL;
+    }
+
+    if (request.checkLegend && request.legendOffset != 0) {
+      void* legend = static_cast<void*>(mem + request.legendOffset);
+      _logfile->cacheLegend(request.cid, request.sid, legend);
     }
+
+    slot->setUsed(static_cast<void*>(mem), request.size, _logfile->id(), handout());
+    result.emplace_back(slot);
   }
 
-  return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
+  return TRI_ERROR_NO_ERROR;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -407,11 +367,10 @@ void Slots::returnUsed (SlotInfo& slotInfo,
 
   TRI_ASSERT(tick > 0);
 
-  {
-    MUTEX_LOCKER(_lock);
-    slotInfo.slot->setReturned(waitForSync);
-    ++_numEvents;
-  }
+  // no lock required here. the status is published with release semantics
+  // and is picked up by the synchronizer thread
+  slotInfo.slot->setReturned(waitForSync);
+  _numEvents.fetch_add(1, std::memory_order_relaxed);
 
   _logfileManager->signalSync();
 
@@ -422,14 +381,14 @@ void Slots::returnUsed (SlotInfo& slotInfo,
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the next synchronisable region
+/// this is only called by the synchronizer thread, which is also the only
+/// thread that recycles slots
 ////////////////////////////////////////////////////////////////////////////////
 
 SyncRegion Slots::getSyncRegion () { 
   bool sealRequested = false;
   SyncRegion region;
 
-  MUTEX_LOCKER(_lock);
-
   size_t slotIndex = _recycleIndex;
 
   while (true) {
@@ -444,7 +403,9 @@ SyncRegion Slots::getSyncRegion () {
       // found a slot that is not yet returned
       // if it belongs to another logfile, we can seal the logfile we created
       // the region for
-      auto otherId = slot->logfileId();
+      // the logfile id of a slot may only be read after the slot has been
+      // published as used. unused slots have a logfile id of 0
+      auto otherId = slot->isUsed() ? slot->logfileId() : 0;
 
       if (region.logfileId != 0 && otherId != 0 && 
           otherId != region.logfileId) {
@@ -510,6 +471,8 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
   size_t slotIndex = region.firstSlotIndex;
 
   {
+    // the lock protects the tick range of the logfile, which is also read
+    // by getActiveTickRange
     MUTEX_LOCKER(_lock);
 
     while (true) {
@@ -518,8 +481,8 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
 
       // note last tick
       Slot::TickType tick = slot->tick();
-      TRI_ASSERT(tick >= _lastCommittedTick);
-      _lastCommittedTick = tick;
+      TRI_ASSERT(tick >= _lastCommittedTick.load(std::memory_order_relaxed));
+      _lastCommittedTick.store(tick, std::memory_order_release);
 
       // update the data tick
       TRI_df_marker_t const* m = static_cast<TRI_df_marker_t const*>(slot->mem());
@@ -527,13 +490,13 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
           m->_type != TRI_DF_MARKER_FOOTER && 
           m->_type != TRI_WAL_MARKER_ATTRIBUTE &&
           m->_type != TRI_WAL_MARKER_SHAPE) {
-        _lastCommittedDataTick = tick;
+        _lastCommittedDataTick.store(tick, std::memory_order_release);
       }
 
       region.logfile->update(m);
 
       slot->setUnused();
-      ++_freeSlots;
+      _freeSlots.fetch_add(1, std::memory_order_release);
 
       // update recycle index, too
       if (++_recycleIndex >= _numberOfSlots) {
@@ -560,13 +523,13 @@ void Slots::returnSyncRegion (SyncRegion const& region) {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the current open region of a logfile
-/// this uses the slots lock
+/// this waits for the reservation turn
 ////////////////////////////////////////////////////////////////////////////////
 
 void Slots::getActiveLogfileRegion (Logfile* logfile,
                                     char const*& begin,
                                     char const*& end) {
-  MUTEX_LOCKER(_lock);
+  ReservationLocker locker(this);
 
   TRI_datafile_t* datafile = logfile->df();
 
@@ -596,117 +559,297 @@ void Slots::getActiveTickRange (Logfile* logfile,
 // -----------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief close a logfile
+/// @brief try to take the reservation turn without waiting
 ////////////////////////////////////////////////////////////////////////////////
 
-int Slots::closeLogfile (Slot::TickType& lastCommittedTick,
-                         bool& worked) {
+bool Slots::tryAcquireReservation () {
+  // test before test-and-set so spinning writers do not keep stealing the
+  // cache line from the current holder
+  return (! _reserved.load(std::memory_order_relaxed) &&
+          ! _reserved.exchange(true, std::memory_order_acquire));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the caller holds the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+void Slots::acquireReservation () {
+  // the reservation itself is very short, so spin for a while first. the
+  // turn is not handed out in arrival order: a writer that is still running
+  // may take it before a parked one, so a parked writer that has not been
+  // scheduled yet cannot hold up everybody else
+  for (int i = 0; i < MaxTurnSpins; ++i) {
+    if (tryAcquireReservation()) {
+      return;
+    }
+
+    if (i < MaxTurnSpins / 2) {
+#if defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+#endif
+    }
+    else {
+#ifdef TRI_HAVE_SCHED_H
+      // let the current holder run if there are more writers than cores
+      sched_yield();
+#endif
+    }
+  }
+
+  // the current holder is waiting for free slots or for a new logfile.
+  // park instead of taking away CPU time from the other writers
+  CONDITION_LOCKER(guard, _turnCondition);
+  _parked.fetch_add(1, std::memory_order_seq_cst);
+
+  while (_reserved.exchange(true, std::memory_order_seq_cst)) {
+    guard.wait();
+  }
+
+  _parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief give up the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+void Slots::releaseReservation () {
+  TRI_ASSERT(_reserved.load(std::memory_order_relaxed));
+  _reserved.store(false, std::memory_order_seq_cst);
+
+  // the seq_cst store and load pair with the ones in acquireReservation, so
+  // either the parked writer sees the free turn or we see the parked writer.
+  // wake up a single writer only. if a running writer takes the turn first,
+  // the woken one parks again and is woken by the next release
+  if (_parked.load(std::memory_order_seq_cst) > 0) {
+    CONDITION_LOCKER(guard, _turnCondition);
+    guard.signal();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the slot at the handout index is unused
+/// the caller must hold the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::waitForUnusedSlot (Slot*& slot) {
   int iterations = 0;
   bool hasWaited = false;
-  worked = false;
 
   while (++iterations < 1000) {
-    {
-      MUTEX_LOCKER(_lock);
+    slot = &_slots[_handoutIndex];
+    TRI_ASSERT(slot != nullptr);
 
-      lastCommittedTick = _lastCommittedTick;
+    if (slot->isUnused()) {
+      if (hasWaited) {
+        CONDITION_LOCKER(guard, _condition);
+        TRI_ASSERT(_waiting > 0);
+        --_waiting;
+      }
 
-      Slot* slot = &_slots[_handoutIndex];
-      TRI_ASSERT(slot != nullptr);
+      return TRI_ERROR_NO_ERROR;
+    }
 
-      if (slot->isUnused()) {
-        if (hasWaited) {
-          CONDITION_LOCKER(guard, _condition);
-          TRI_ASSERT(_waiting > 0);
-          --_waiting;
-          hasWaited = false;
-        }
+    // if we get here, all slots are busy
+    CONDITION_LOCKER(guard, _condition);
+    if (! hasWaited) {
+      ++_waiting;
+      hasWaited = true;
+    }
 
-        if (_logfile != nullptr) {
-          if (_logfile->status() == Logfile::StatusType::EMPTY) {
-            // no need to seal a still-empty logfile
-            return TRI_ERROR_NO_ERROR;
-          }
+    if (_freeSlots.load(std::memory_order_acquire) == 0) {
+      guard.wait(10 * 1000);
+    }
+  }
 
-          // seal existing logfile by creating a footer marker
-          int res = writeFooter(slot);
+  if (hasWaited) {
+    CONDITION_LOCKER(guard, _condition);
+    TRI_ASSERT(_waiting > 0);
+    --_waiting;
+  }
 
-          if (res != TRI_ERROR_NO_ERROR) {
-            LOG_ERROR("could not write logfile footer: %s", TRI_errno_string(res));
-            return res;
-          }
+  slot = nullptr;
+  return TRI_ERROR_ARANGO_NO_JOURNAL;
+}
 
-          _logfileManager->setLogfileSealRequested(_logfile);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure there is a logfile that can hold a marker of the
+/// specified size. seals the current logfile if it is too full.
+/// the caller must hold the reservation turn
+////////////////////////////////////////////////////////////////////////////////
 
-          // advance to next slot
-          slot = &_slots[_handoutIndex];
+int Slots::ensureLogfile (uint32_t alignedSize,
+                          Slot*& slot) {
+  if (_logfile != nullptr &&
+      _logfile->freeSize() >= static_cast<uint64_t>(alignedSize)) {
+    // fast path: the current logfile has enough space left
+    return TRI_ERROR_NO_ERROR;
+  }
 
-          // invalidate the logfile so for the next write we'll use a
-          // new one
-          _logfile = nullptr;
+  // the logfile is only switched by the holder of the reservation turn, so
+  // no further lock is needed here. in particular, _lock must not be held
+  // while waiting for free slots, because the synchronizer needs it to
+  // return slots
 
-          // fall-through intentional
-        }
-          
-        TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
-          return TRI_ERROR_ARANGO_NO_JOURNAL;
-        }
+  // cycle until we have a valid logfile
+  while (_logfile == nullptr ||
+         _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
 
-        TRI_ASSERT(_logfile == nullptr);
-        // fetch the next free logfile (this may create a new one)
-        // note: as we don't have a real marker to write the size does
-        // not matter (we use a size of 1 as  it must be > 0)
-        Logfile::StatusType status;
-        int res = newLogfile(1, status);
+    if (_logfile != nullptr) {
+      // seal existing logfile by creating a footer marker
+      int res = writeFooter(slot);
 
-        if (res != TRI_ERROR_NO_ERROR) {
-          if (res != TRI_ERROR_ARANGO_NO_JOURNAL) {
-            return res;
-          }
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      _logfileManager->setLogfileSealRequested(_logfile);
+
+      _logfile = nullptr;
+
+      // advance to next slot
+      res = waitForUnusedSlot(slot);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+    }
+      
+    TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
+      return TRI_ERROR_ARANGO_NO_JOURNAL;
+    }
 
-          usleep(10 * 1000);
-          // try again in next iteration
+    // fetch the next free logfile (this may create a new one)
+    Logfile::StatusType status;
+    int res = newLogfile(alignedSize, status);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      if (res != TRI_ERROR_ARANGO_NO_JOURNAL) {
+        return res;
+      }
+
+      usleep(10 * 1000);
+      // try again in next iteration
+    }
+    else {
+      TRI_ASSERT(_logfile != nullptr);
+
+      if (status == Logfile::StatusType::EMPTY) {
+        // initialize the empty logfile by writing a header marker
+        res = writeHeader(slot);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
         }
-        else {
-          TRI_ASSERT(_logfile != nullptr);
-
-          if (status == Logfile::StatusType::EMPTY) {
-            // initialize the empty logfile by writing a header marker
-            res = writeHeader(slot);
-
-            if (res != TRI_ERROR_NO_ERROR) {
-              LOG_ERROR("could not write logfile header: %s", TRI_errno_string(res));
-              return res;
-            }
-
-            _logfileManager->setLogfileOpen(_logfile);
-            worked = true;
-          }
-          else {
-            TRI_ASSERT(status == Logfile::StatusType::OPEN);
-            worked = false;
-          }
-
-          return TRI_ERROR_NO_ERROR;
+
+        _logfileManager->setLogfileOpen(_logfile);
+
+        // advance to next slot
+        res = waitForUnusedSlot(slot);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
         }
       }
+      else {
+        TRI_ASSERT(status == Logfile::StatusType::OPEN);
+      }
     }
+  }
 
-    // if we get here, all slots are busy
-    CONDITION_LOCKER(guard, _condition);
-    if (! hasWaited) {
-      ++_waiting;
-      hasWaited = true;
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief close a logfile
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::closeLogfile (Slot::TickType& lastCommittedTick,
+                         bool& worked) {
+  int iterations = 0;
+  worked = false;
+
+  ReservationLocker locker(this);
+
+  while (++iterations < 1000) {
+    lastCommittedTick = _lastCommittedTick.load(std::memory_order_acquire);
+
+    Slot* slot = nullptr;
+    int res = waitForUnusedSlot(slot);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
     }
 
-    bool mustWait;
-    {
-      MUTEX_LOCKER(_lock);
-      mustWait = (_freeSlots == 0);
+    if (_logfile != nullptr) {
+      if (_logfile->status() == Logfile::StatusType::EMPTY) {
+        // no need to seal a still-empty logfile
+        return TRI_ERROR_NO_ERROR;
+      }
+
+      // seal existing logfile by creating a footer marker
+      res = writeFooter(slot);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        LOG_ERROR("could not write logfile footer: %s", TRI_errno_string(res));
+        return res;
+      }
+
+      _logfileManager->setLogfileSealRequested(_logfile);
+
+      // invalidate the logfile so for the next write we'll use a
+      // new one
+      _logfile = nullptr;
+
+      // advance to next slot
+      res = waitForUnusedSlot(slot);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      // fall-through intentional
+    }
+      
+    TRI_IF_FAILURE("LogfileManagerGetWriteableLogfile") {
+      return TRI_ERROR_ARANGO_NO_JOURNAL;
     }
 
-    if (mustWait) {
-      guard.wait(10 * 1000);
+    TRI_ASSERT(_logfile == nullptr);
+    // fetch the next free logfile (this may create a new one)
+    // note: as we don't have a real marker to write the size does
+    // not matter (we use a size of 1 as  it must be > 0)
+    Logfile::StatusType status;
+    res = newLogfile(1, status);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      if (res != TRI_ERROR_ARANGO_NO_JOURNAL) {
+        return res;
+      }
+
+      usleep(10 * 1000);
+      // try again in next iteration
+    }
+    else {
+      TRI_ASSERT(_logfile != nullptr);
+
+      if (status == Logfile::StatusType::EMPTY) {
+        // initialize the empty logfile by writing a header marker
+        res = writeHeader(slot);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          LOG_ERROR("could not write logfile header: %s", TRI_errno_string(res));
+          return res;
+        }
+
+        _logfileManager->setLogfileOpen(_logfile);
+        worked = true;
+      }
+      else {
+        TRI_ASSERT(status == Logfile::StatusType::OPEN);
+        worked = false;
+      }
+
+      return TRI_ERROR_NO_ERROR;
     }
   }
 
@@ -756,8 +899,8 @@ int Slots::writeFooter (Slot* slot) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Slot::TickType Slots::handout () {
-  TRI_ASSERT(_freeSlots > 0);
-  _freeSlots--;
+  TRI_ASSERT(_freeSlots.load(std::memory_order_relaxed) > 0);
+  _freeSlots.fetch_sub(1, std::memory_order_relaxed);
 
   if (++_handoutIndex ==_numberOfSlots) {
     // wrap around
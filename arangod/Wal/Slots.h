@@ -99,12 +99,54 @@ namespace triagens {
       int         errorCode;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                struct SlotRequest
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a request for a slot, used when reserving slots for several markers
+/// at once. if checkLegend is set, the request is treated like the legend
+/// version of nextUnused
+////////////////////////////////////////////////////////////////////////////////
+
+    struct SlotRequest {
+      SlotRequest (uint32_t size)
+        : size(size),
+          checkLegend(false),
+          cid(0),
+          sid(0),
+          legendOffset(0),
+          oldLegend(nullptr) {
+      }
+
+      SlotRequest (uint32_t size,
+                   TRI_voc_cid_t cid,
+                   TRI_shape_sid_t sid,
+                   uint32_t legendOffset)
+        : size(size),
+          checkLegend(true),
+          cid(cid),
+          sid(sid),
+          legendOffset(legendOffset),
+          oldLegend(nullptr) {
+      }
+
+      uint32_t        size;
+      bool            checkLegend;
+      TRI_voc_cid_t   cid;
+      TRI_shape_sid_t sid;
+      uint32_t        legendOffset;
+      void*           oldLegend;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       class Slots
 // -----------------------------------------------------------------------------
 
     class Slots {
 
+      class ReservationLocker;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -172,6 +214,18 @@ namespace triagens {
                              uint32_t legendIncluded,
                              void*& oldLegend);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return unused slots for a range of requests, acquiring the
+/// reservation turn only once. the reserved slots are appended to the result.
+/// may reserve fewer slots than requested, but at least one if no error
+/// occurs
+////////////////////////////////////////////////////////////////////////////////
+
+        int nextUnused (std::vector<SlotRequest>&,
+                        size_t,
+                        size_t,
+                        std::vector<SlotInfo>&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return a used slot, allowing its synchronization
 ////////////////////////////////////////////////////////////////////////////////
@@ -193,7 +247,7 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the current open region of a logfile
-/// this uses the slots lock
+/// this waits for the reservation turn
 ////////////////////////////////////////////////////////////////////////////////
 
         void getActiveLogfileRegion (Logfile*,
@@ -213,6 +267,41 @@ namespace triagens {
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief try to take the reservation turn without waiting
+////////////////////////////////////////////////////////////////////////////////
+
+        bool tryAcquireReservation ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the caller holds the reservation turn
+/// spins for a short while and then parks the caller
+////////////////////////////////////////////////////////////////////////////////
+
+        void acquireReservation ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief give up the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+        void releaseReservation ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the slot at the handout index is unused
+/// the caller must hold the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+        int waitForUnusedSlot (Slot*&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make sure there is a logfile that can hold a marker of the
+/// specified size. seals the current logfile if it is too full.
+/// the caller must hold the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+        int ensureLogfile (uint32_t,
+                           Slot*&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief close a logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,6 +341,19 @@ namespace triagens {
         int newLogfile (uint32_t,
                         Logfile::StatusType& status);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of attempts to take the reservation turn before a writer
+/// parks
+////////////////////////////////////////////////////////////////////////////////
+
+        static int const MaxTurnSpins = 1024;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -271,11 +373,38 @@ namespace triagens {
         basics::ConditionVariable _condition;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief mutex protecting the slots interface
+/// @brief mutex protecting the tick ranges of the active logfile, which are
+/// updated by the synchronizer. it is neither acquired for slot reservations
+/// nor for logfile switches, which are done by the holder of the reservation
+/// turn. it must never be held while waiting for free slots
 ////////////////////////////////////////////////////////////////////////////////
 
         basics::Mutex _lock;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether a writer currently holds the reservation turn
+///
+/// the reservation itself only picks the slot at the handout index, bumps
+/// the logfile write position and assigns the tick. all three must be in
+/// the same order for the synchronizer and for replication, so this step
+/// cannot run concurrently. everything else (copying the marker, returning
+/// the slot, syncing) does not wait for the reservation turn
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<bool> _reserved;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of writers parked until the reservation turn is free
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint32_t> _parked;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief condition variable for the parked writers
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::ConditionVariable _turnCondition;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief all slots
 ////////////////////////////////////////////////////////////////////////////////
@@ -292,28 +421,32 @@ namespace triagens {
 /// @brief the number of currently free slots
 ////////////////////////////////////////////////////////////////////////////////
 
-        size_t _freeSlots;
+        std::atomic<size_t> _freeSlots;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not someone is waiting for a slot
+/// protected by the condition variable
 ////////////////////////////////////////////////////////////////////////////////
 
         uint32_t _waiting;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the index of the slot to hand out next
+/// only accessed by the holder of the reservation turn
 ////////////////////////////////////////////////////////////////////////////////
 
         size_t _handoutIndex;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the index of the slot to recycle
+/// only accessed by the synchronizer thread
 ////////////////////////////////////////////////////////////////////////////////
 
         size_t _recycleIndex;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief the current logfile to write into
+/// only accessed by the holder of the reservation turn
 ////////////////////////////////////////////////////////////////////////////////
 
         Logfile* _logfile;
@@ -328,19 +461,19 @@ namespace triagens {
 /// @brief last committed tick value
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType _lastCommittedTick;
+        std::atomic<Slot::TickType> _lastCommittedTick;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief last committed data tick value
 ////////////////////////////////////////////////////////////////////////////////
 
-        Slot::TickType _lastCommittedDataTick;
+        std::atomic<Slot::TickType> _lastCommittedDataTick;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief number of log events handled
 ////////////////////////////////////////////////////////////////////////////////
 
-        uint64_t _numEvents;
+        std::atomic<uint64_t> _numEvents;
 
     };
 
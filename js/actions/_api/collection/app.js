@@ -780,6 +780,20 @@ function get_api_collections (req, res) {
 /// @RESTSTRUCT{size,collection_figures_indexes,integer,required,int64}
 /// The total memory allocated for indexes in bytes.
 ///
+/// @RESTSTRUCT{headers,collection_figures,object,required,collection_figures_headers}
+/// @RESTSTRUCT{count,collection_figures_headers,integer,required,int64}
+/// The number of document master pointers in use. There is one master pointer
+/// per document in memory, including documents that are contained in the
+/// write-ahead log only.
+///
+/// @RESTSTRUCT{size,collection_figures_headers,integer,required,int64}
+/// The total memory reserved for master pointers in bytes. This includes
+/// memory for master pointers that are currently unused.
+///
+/// @RESTSTRUCT{sizePerDocument,collection_figures_headers,integer,required,int64}
+/// The size of a single master pointer in bytes, i.e. the fixed memory overhead
+/// per document.
+///
 /// @RESTSTRUCT{maxTick,collection_figures,integer,required,int64}
 /// The tick of the last marker that was stored in a journal
 /// of the collection. This might be 0 if the collection does not yet have
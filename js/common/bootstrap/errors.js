@@ -154,6 +154,7 @@
     "ERROR_QUERY_EMPTY"            : { "code" : 1502, "message" : "query is empty" },
     "ERROR_QUERY_SCRIPT"           : { "code" : 1503, "message" : "runtime error '%s'" },
     "ERROR_QUERY_NUMBER_OUT_OF_RANGE" : { "code" : 1504, "message" : "number out of range" },
+    "ERROR_QUERY_RESOURCE_LIMIT"   : { "code" : 1505, "message" : "query would use more memory than allowed" },
     "ERROR_QUERY_VARIABLE_NAME_INVALID" : { "code" : 1510, "message" : "variable name '%s' has an invalid format" },
     "ERROR_QUERY_VARIABLE_REDECLARED" : { "code" : 1511, "message" : "variable '%s' is assigned multiple times" },
     "ERROR_QUERY_VARIABLE_NAME_UNKNOWN" : { "code" : 1512, "message" : "unknown variable '%s'" },
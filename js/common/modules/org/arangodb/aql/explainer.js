@@ -251,6 +251,43 @@ function printIndexes (indexes) {
   }
 }
 
+/* print join order */
+function printJoinOrder (joins) {
+  'use strict';
+  if (joins.length < 2) {
+    return;
+  }
+
+  stringBuilder.appendLine(section("Join order:"));
+  var maxIdLen = String("Id").length;
+  var maxCollectionLen = String("Collection").length;
+  var maxVariableLen = String("Variable").length;
+  var maxAccessLen = String("Access").length;
+  var maxEstimateLen = String("Est. Items").length;
+  joins.forEach(function(join) {
+    maxIdLen = Math.max(maxIdLen, String(join.node).length);
+    maxCollectionLen = Math.max(maxCollectionLen, join.collection.length);
+    maxVariableLen = Math.max(maxVariableLen, join.variable.length);
+    maxAccessLen = Math.max(maxAccessLen, join.access.length);
+    maxEstimateLen = Math.max(maxEstimateLen, String(join.estimate).length);
+  });
+
+  stringBuilder.appendLine(" " + pad(1 + maxIdLen - String("Id").length) + header("Id") + "   " +
+                           header("Collection") + pad(1 + maxCollectionLen - "Collection".length) + "   " +
+                           header("Variable") + pad(1 + maxVariableLen - "Variable".length) + "   " +
+                           header("Access") + pad(1 + maxAccessLen - "Access".length) + "   " +
+                           pad(1 + maxEstimateLen - "Est. Items".length) + header("Est. Items"));
+
+  joins.forEach(function(join) {
+    stringBuilder.appendLine(" " + pad(1 + maxIdLen - String(join.node).length) + variable(String(join.node)) + "   " +
+                             collection(join.collection) + pad(1 + maxCollectionLen - join.collection.length) + "   " +
+                             variable(join.variable) + pad(1 + maxVariableLen - join.variable.length) + "   " +
+                             keyword(join.access) + pad(1 + maxAccessLen - join.access.length) + "   " +
+                             pad(1 + maxEstimateLen - String(join.estimate).length) + value(join.estimate));
+  });
+  stringBuilder.appendLine();
+}
+
 /* analzye and print execution plan */
 function processQuery (query, explain) {
   'use strict';
@@ -295,6 +332,7 @@ function processQuery (query, explain) {
     collectionVariables = { }, 
     usedVariables = { },
     indexes = [ ], 
+    joins = [ ],
     modificationFlags,
     isConst = true;
 
@@ -479,7 +517,8 @@ function processQuery (query, explain) {
         return keyword("EMPTY") + "   " + annotation("/* empty result set */");
       case "EnumerateCollectionNode":
         collectionVariables[node.outVariable.id] = node.collection;
-        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* full collection scan" + (node.random ? ", random order" : "") + " */");
+        joins.push({ node: node.id, collection: node.collection, variable: node.outVariable.name, access: "full collection scan", estimate: node.estimatedNrItems });
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + (node.hasOwnProperty("filter") ? " " + keyword("FILTER") + " " + buildExpression(node.filter) : "") + "   " + annotation("/* full collection scan" + (node.random ? ", random order" : "") + (node.hasOwnProperty("filter") ? ", embedded filter" : "") + " */");
       case "EnumerateListNode":
         return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + variableName(node.inVariable) + "   " + annotation("/* list iteration */");
       case "IndexRangeNode":
@@ -489,7 +528,26 @@ function processQuery (query, explain) {
         index.collection = node.collection;
         index.node = node.id;
         indexes.push(index);
-        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* " + (node.reverse ? "reverse " : "") + node.index.type + " index scan */");
+        var access = node.index.type + " index scan";
+        if (node.combination === "intersection" || node.combination === "union") {
+          node.additionalLookups.forEach(function(lookup) {
+            var other = lookup.index;
+            other.ranges = lookup.ranges.map(buildRanges).join(" || ");
+            other.collection = node.collection;
+            other.node = node.id;
+            indexes.push(other);
+          });
+          access = "index " + node.combination;
+        }
+        else if (node.covering) {
+          access = "covering " + access;
+        }
+        joins.push({ node: node.id, collection: node.collection, variable: node.outVariable.name, access: access, estimate: node.estimatedNrItems });
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* " + (node.reverse ? "reverse " : "") + access + " */");
+      case "HashJoinNode":
+        collectionVariables[node.outVariable.id] = node.collection;
+        joins.push({ node: node.id, collection: node.collection, variable: node.outVariable.name, access: "hash join", estimate: node.estimatedNrItems });
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* hash join on " + node.attribute.join(".") + " == ") + variableName(node.inVariable) + annotation(" */");
       case "CalculationNode":
         return keyword("LET") + " " + variableName(node.outVariable) + " = " + buildExpression(node.expression) + "   " + annotation("/* " + node.expressionType + " expression */");
       case "FilterNode":
@@ -505,13 +563,13 @@ function processQuery (query, explain) {
       case "SortNode":
         return keyword("SORT") + " " + node.elements.map(function(node) {
           return variableName(node.inVariable) + " " + keyword(node.ascending ? "ASC" : "DESC"); 
-        }).join(", ");
+        }).join(", ") + (node.limit > 0 ? "   " + annotation("/* top " + node.limit + " rows only */") : "");
       case "LimitNode":
         return keyword("LIMIT") + " " + value(JSON.stringify(node.offset)) + ", " + value(JSON.stringify(node.limit)); 
       case "ReturnNode":
         return keyword("RETURN") + " " + variableName(node.inVariable);
       case "SubqueryNode":
-        return keyword("LET") + " " + variableName(node.outVariable) + " = ...   " + annotation("/* subquery */");
+        return keyword("LET") + " " + variableName(node.outVariable) + " = ...   " + annotation("/* " + (node.isConst ? "const " : "") + (node.hasOwnProperty("outerKeyVariable") ? "decorrelated " : "") + "subquery */");
       case "InsertNode":
         modificationFlags = node.modificationFlags;
         return keyword("INSERT") + " " + variableName(node.inVariable) + " " + keyword("IN") + " " + collection(node.collection);
@@ -563,6 +621,7 @@ function processQuery (query, explain) {
     if ([ "EnumerateCollectionNode",
           "EnumerateListNode",
           "IndexRangeNode",
+          "HashJoinNode",
           "SubqueryNode" ].indexOf(node.type) !== -1) {
       level++;
     }
@@ -636,6 +695,7 @@ function processQuery (query, explain) {
   stringBuilder.appendLine();
   printIndexes(indexes);
   stringBuilder.appendLine();
+  printJoinOrder(joins);
   printRules(plan.rules);
   printModificationFlags(modificationFlags);
   printWarnings(explain.warnings);
@@ -346,6 +346,33 @@ function CapConstraintSuite() {
       assertEqual([5, 97, 98, 99, 100], collection.toArray().map(fun).sort(nsort));
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test: first / last use the order of the cap constraint
+////////////////////////////////////////////////////////////////////////////////
+
+    testFirstLast : function () {
+      var idx = collection.ensureCapConstraint(5);
+      var fun = function(d) { return d.n; };
+
+      var docs = [ ];
+      for (var i = 0;  i < 6;  ++i) {
+        docs[i] = collection.save({ n : i });
+      }
+
+      assertEqual([1, 2], collection.first(2).map(fun));
+      assertEqual([5, 4], collection.last(2).map(fun));
+
+      collection.replace(docs[2], { n: 100 });
+      assertEqual([1, 3, 4, 5], collection.first(4).map(fun));
+      assertEqual([100, 5, 4, 3, 1], collection.last(10).map(fun));
+
+      var figures = collection.getIndexes(true).filter(function (i) {
+        return i.id === idx.id;
+      })[0].figures;
+
+      assertTrue(figures.memory > 0);
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test: updates
 ////////////////////////////////////////////////////////////////////////////////
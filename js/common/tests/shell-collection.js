@@ -951,6 +951,67 @@ function CollectionSuite () {
       db._drop(cn);
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test first / last with updates, removals and rollbacks
+////////////////////////////////////////////////////////////////////////////////
+
+    testFirstLastModified : function () {
+      var cn = "example";
+      var keys = function (docs) {
+        return docs.map(function (doc) { return doc._key; });
+      };
+
+      db._drop(cn);
+      var c1 = db._create(cn);
+
+      for (var i = 0; i < 10; ++i) {
+        c1.save({ _key : "test" + i, "value" : i });
+      }
+
+      assertEqual("test0", c1.first()._key);
+      assertEqual("test9", c1.last()._key);
+
+      // updated documents move to the end
+      c1.update("test0", { "value" : 100 });
+      c1.replace("test5", { "value" : 5 });
+
+      assertEqual([ "test1", "test2", "test3" ], keys(c1.first(3)));
+      assertEqual([ "test5", "test0", "test9" ], keys(c1.last(3)));
+
+      // changes of an aborted transaction must not change the order
+      var aborted = false;
+      try {
+        db._executeTransaction({
+          collections: { write: cn },
+          action: function (params) {
+            var c = require("internal").db._collection(params.cn);
+            c.update("test1", { "value" : 101 });
+            c.remove("test2");
+            c.save({ _key : "test10" });
+            throw "rollback";
+          },
+          params: { cn: cn }
+        });
+      }
+      catch (err) {
+        aborted = true;
+      }
+
+      assertTrue(aborted);
+
+      assertEqual([ "test1", "test2", "test3" ], keys(c1.first(3)));
+      assertEqual([ "test5", "test0", "test9" ], keys(c1.last(3)));
+
+      c1.remove("test1");
+      c1.remove("test5");
+
+      assertEqual([ "test2", "test3" ], keys(c1.first(2)));
+      assertEqual([ "test0", "test9" ], keys(c1.last(2)));
+      assertEqual(8, c1.first(100).length);
+
+      db._drop(cn);
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test first / last after reload
 ////////////////////////////////////////////////////////////////////////////////
@@ -70,6 +70,8 @@ function FiguresSuite () {
       assertEqual(0, f.dead.count);
       assertEqual(0, f.dead.size);
       assertEqual(0, f.dead.deletion);
+      assertEqual(0, f.headers.count);
+      assertTrue(f.headers.sizePerDocument > 0);
 
       var d1 = c1.save({ hello : 1 });
 
@@ -96,6 +98,8 @@ function FiguresSuite () {
       assertEqual(0, f.dead.count);
       assertEqual(0, f.dead.size);
       assertEqual(0, f.dead.deletion);
+      assertEqual(1, f.headers.count);
+      assertTrue(f.headers.size >= f.headers.count * f.headers.sizePerDocument);
 
       var d2 = c1.save({ hello : 2 });
 
@@ -247,7 +247,7 @@ var dayOfYearOffsets = [
 var dayOfLeapYearOffsets = [
   0,
   31,  // + 31 Jan
-  59,  // + 29 Feb*
+  60,  // + 29 Feb*
   91,  // + 31 Mar
   121, // + 30 Apr
   152, // + 31 May
@@ -29,6 +29,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test suite
@@ -139,6 +140,104 @@ function attributeAccessTestSuite () {
       // won't work (accessing an attribute of an array)
       var result = AQL_EXECUTE("RETURN (FOR value IN @values RETURN value).name", { values: values }).json;
       assertEqual([ null ], result);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test attribute access on documents with many different shapes
+////////////////////////////////////////////////////////////////////////////////
+
+    testDocumentShapes : function () {
+      var cn = "UnitTestsAhuacatlAttributeAccess";
+      db._drop(cn);
+      var c = db._create(cn);
+
+      // more different shapes than an attribute accessor caches
+      for (var i = 0; i < 500; ++i) {
+        var doc = { nr: i, value: i, sub: { value: i } };
+        if (i % 5 === 0) {
+          delete doc.value;
+        }
+        if (i % 3 === 0) {
+          doc.sub = "sub" + i;
+        }
+        doc["attr" + (i % 100)] = i;
+        c.save(doc);
+      }
+
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " SORT doc.nr RETURN [ doc.nr, doc.value, doc.sub.value, doc.attr7 ]").json;
+      assertEqual(500, result.length);
+
+      result.forEach(function (r, i) {
+        assertEqual(i, r[0]);
+        assertEqual(i % 5 === 0 ? null : i, r[1]);
+        assertEqual(i % 3 === 0 ? null : i, r[2]);
+        assertEqual(i % 100 === 7 ? i : null, r[3]);
+      });
+
+      result = AQL_EXECUTE("FOR doc IN " + cn + " FILTER doc.sub.value != null RETURN doc.sub.value").json;
+      assertEqual(333, result.length);
+
+      result = AQL_EXECUTE("FOR doc IN " + cn + " FILTER doc.value == null RETURN 1").json;
+      assertEqual(100, result.length);
+
+      db._drop(cn);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test dynamic array and object literals with null members
+////////////////////////////////////////////////////////////////////////////////
+
+    testDynamicLiteralsNull : function () {
+      var result = AQL_EXECUTE("FOR i IN 1..3 RETURN [ i, null, i > 1 ? null : i ]").json;
+      assertEqual([ [ 1, null, 1 ], [ 2, null, null ], [ 3, null, null ] ], result);
+
+      result = AQL_EXECUTE("FOR i IN 1..2 RETURN { a: i, b: null, c: [ null, i ], d: { e: null } }").json;
+      assertEqual([ 
+        { a: 1, b: null, c: [ null, 1 ], d: { e: null } }, 
+        { a: 2, b: null, c: [ null, 2 ], d: { e: null } } 
+      ], result);
+
+      result = AQL_EXECUTE("FOR i IN 1..2 LET v = { a: null, b: i } RETURN [ v.a, v.b, v.c, LENGTH(ATTRIBUTES(v)) ]").json;
+      assertEqual([ [ null, 1, null, 2 ], [ null, 2, null, 2 ] ], result);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test dynamic literals built from document attributes
+////////////////////////////////////////////////////////////////////////////////
+
+    testDynamicLiteralsFromDocuments : function () {
+      var cn = "UnitTestsAttributeAccess";
+      db._drop(cn);
+      var c = db._create(cn);
+
+      for (var i = 0; i < 100; ++i) {
+        if (i % 2 === 0) {
+          c.save({ value: i, sub: { value: i } });
+        }
+        else {
+          c.save({ value: null });
+        }
+      }
+
+      var result = AQL_EXECUTE("FOR doc IN " + cn + " SORT doc.sub.value RETURN { a: doc.value, b: doc.sub.value, c: [ doc.value, doc.missing, doc.sub ] }").json;
+      assertEqual(100, result.length);
+      result.forEach(function(r, i) {
+        assertEqual([ "a", "b", "c" ], Object.keys(r).sort());
+        assertEqual(3, r.c.length);
+        assertEqual(null, r.c[1]);
+        if (i < 50) {
+          assertEqual(null, r.a);
+          assertEqual(null, r.b);
+          assertEqual([ null, null, null ], r.c);
+        }
+        else {
+          assertEqual((i - 50) * 2, r.a);
+          assertEqual((i - 50) * 2, r.b);
+          assertEqual({ value: (i - 50) * 2 }, r.c[2]);
+        }
+      });
+
+      db._drop(cn);
     }
 
   };
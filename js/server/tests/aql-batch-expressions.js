@@ -0,0 +1,180 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for expressions executed in batch mode
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+var helper = require("org/arangodb/aql-helper");
+var getQueryResults = helper.getQueryResults;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function batchExpressionsTestSuite () {
+
+  // executes the expression in batch mode and in row mode, and compares
+  // the results. wrapping the expression into an array access prevents
+  // batch mode
+  var compare = function (expression, values) {
+    var bind = { values: values };
+    var batch = getQueryResults("FOR v IN @values RETURN " + expression, bind);
+    var row = getQueryResults("FOR v IN @values RETURN [ " + expression + " ][0]", bind);
+
+    assertEqual(row, batch, expression);
+    assertEqual(values.length, batch.length);
+    return batch;
+  };
+
+  var range = function (from, to) {
+    var result = [ ];
+    for (var i = from; i <= to; ++i) {
+      result.push(i);
+    }
+    return result;
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test numeric comparisons
+////////////////////////////////////////////////////////////////////////////////
+
+    testNumbers : function () {
+      var values = range(-1000, 1000);
+
+      [ "v == 17", "v != 17", "v < 0", "v <= 0", "v > 3.5", "v >= -3.5",
+        "17 == v", "0 > v", "v == v", "v < v" ].forEach(function (expression) {
+        compare(expression, values);
+      });
+
+      assertEqual(1001, getQueryResults("FOR v IN @values FILTER v >= 0 RETURN v", { values: values }).length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test logical operators
+////////////////////////////////////////////////////////////////////////////////
+
+    testLogical : function () {
+      var values = range(0, 2000);
+
+      [ "v > 10 && v < 20", "v < 10 || v > 1990", "! (v > 10)",
+        "NOT (v > 10 && v < 1990) || v == 1000", "(v > 10) == (v > 20)" ].forEach(function (expression) {
+        compare(expression, values);
+      });
+
+      assertEqual(9, getQueryResults("FOR v IN @values FILTER v > 10 && v < 20 RETURN v", { values: values }).length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test string comparisons
+////////////////////////////////////////////////////////////////////////////////
+
+    testStrings : function () {
+      var values = [ "a", "b", "B", "A", "", "abc", "ab", "ä", "z", "Zz", "foo bar", "b" ];
+
+      [ "v == 'b'", "v != 'b'", "v < 'b'", "v <= 'B'", "v > 'ab'", "v >= ''", "v < v" ].forEach(function (expression) {
+        compare(expression, values);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test comparisons of booleans and nulls
+////////////////////////////////////////////////////////////////////////////////
+
+    testBooleansNulls : function () {
+      [ "v == true", "v < true", "v == null", "v > null", "v && true", "v || false" ].forEach(function (expression) {
+        compare(expression, [ true, false, false, true, true ]);
+        compare(expression, [ null, null, null ]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test comparisons of different types
+////////////////////////////////////////////////////////////////////////////////
+
+    testMixedTypes : function () {
+      var values = [ 1, "1", null, true, false, [ ], { }, -1, "", [ 1 ], { a: 1 }, 0 ];
+
+      [ "v == 1", "v < 1", "v > 'a'", "v >= null", "v == true", "v && true", "! v", "v == [ ]" ].forEach(function (expression) {
+        compare(expression, values);
+      });
+
+      // a column with a single type compared to a constant of another type
+      compare("v < 'a'", range(1, 100));
+      compare("v == null", range(1, 100));
+      compare("v > true", range(1, 100));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test attribute accesses on documents
+////////////////////////////////////////////////////////////////////////////////
+
+    testDocuments : function () {
+      var cn = "UnitTestsAhuacatlBatchExpressions";
+      db._drop(cn);
+      var c = db._create(cn);
+
+      for (var i = 0; i < 3000; ++i) {
+        if (i % 1000 === 999) {
+          // documents without the attribute force the row mode
+          c.save({ group: "test" + (i % 7) });
+        }
+        else {
+          c.save({ value: i, group: "test" + (i % 7), sub: { flag: (i % 2 === 0) } });
+        }
+      }
+
+      var query = "FOR doc IN " + cn + " FILTER doc.value >= 1000 && doc.value < 2000 && doc.sub.flag == true RETURN doc.value";
+      assertEqual(500, getQueryResults(query).length);
+
+      query = "FOR doc IN " + cn + " FILTER doc.group == 'test3' RETURN 1";
+      assertEqual(429, getQueryResults(query).length);
+
+      query = "FOR doc IN " + cn + " FILTER doc.value == null RETURN 1";
+      assertEqual(3, getQueryResults(query).length);
+
+      db._drop(cn);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(batchExpressionsTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -1,5 +1,5 @@
 /*jshint globalstrict:false, strict:false, maxlen: 500 */
-/*global assertEqual */
+/*global assertEqual, assertNotEqual, assertTrue, AQL_EXECUTE, AQL_EXPLAIN */
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief tests for query language, functions
 ///
@@ -40,6 +40,37 @@ var assertQueryWarningAndNull = helper.assertQueryWarningAndNull;
 ////////////////////////////////////////////////////////////////////////////////
 
 function ahuacatlDateFunctionsTestSuite () {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes a query and checks the codes of the warnings registered
+////////////////////////////////////////////////////////////////////////////////
+
+  var assertQueryWarnings = function (expected, query) {
+    var result = AQL_EXECUTE(query), found = { };
+
+    result.warnings.forEach(function (warning) {
+      found[warning.code] = true;
+    });
+
+    assertEqual(expected.map(String).sort(), Object.keys(found).sort(), query);
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks that the calculations of a query do not need V8
+////////////////////////////////////////////////////////////////////////////////
+
+  var assertNoV8Expressions = function (query) {
+    var nodes = AQL_EXPLAIN(query, { }, { optimizer: { rules: [ "-all" ] } }).plan.nodes;
+    var types = nodes.filter(function (node) {
+      return node.type === "CalculationNode";
+    }).map(function (node) {
+      return node.expressionType;
+    });
+
+    assertNotEqual(-1, types.indexOf("simple"), query);
+    assertEqual(-1, types.indexOf("v8"), query);
+  };
+
   return {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -886,8 +917,80 @@ function ahuacatlDateFunctionsTestSuite () {
       });
     },
 
-// TODO: DATE_QUARTER()
-// TODO: DATE_DAYS_IN_MONTH()
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_quarter function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateQuarterInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_QUARTER()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_QUARTER(1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_QUARTER(null)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_QUARTER(false)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_QUARTER([])");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_QUARTER({})");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_QUARTER('')");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_quarter function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateQuarter : function () {
+      var values = [
+        [ "2012-01-01", 1 ],
+        [ "2012-03-31T23:59:59.999Z", 1 ],
+        [ "2012-04-01", 2 ],
+        [ "2012-06-30", 2 ],
+        [ "2012-07-01", 3 ],
+        [ "2012-09-30", 3 ],
+        [ "2012-10-01", 4 ],
+        [ "2012-12-31Z", 4 ],
+        [ 1399395674000, 2 ],
+        [ 0, 1 ]
+      ];
+
+      values.forEach(function (value) {
+        var actual = getQueryResults("RETURN DATE_QUARTER(@value)", { value: value[0] });
+        assertEqual([ value[1] ], actual);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_days_in_month function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateDaysInMonthInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_DAYS_IN_MONTH()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_DAYS_IN_MONTH(1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DAYS_IN_MONTH(null)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DAYS_IN_MONTH(false)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DAYS_IN_MONTH([])");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DAYS_IN_MONTH({})");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DAYS_IN_MONTH('')");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_days_in_month function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateDaysInMonth : function () {
+      var values = [
+        [ "2000-02-01", 29 ],
+        [ "2100-02-01", 28 ],
+        [ "2012-02-29", 29 ],
+        [ "2013-02-01Z", 28 ],
+        [ "2012-01-31", 31 ],
+        [ "2012-04-15", 30 ],
+        [ "2012-12-01T12:00:00Z", 31 ],
+        [ 0, 31 ]
+      ];
+
+      values.forEach(function (value) {
+        var actual = getQueryResults("RETURN DATE_DAYS_IN_MONTH(@value)", { value: value[0] });
+        assertEqual([ value[1] ], actual);
+      });
+    },
+
 
 // TODO: additional ISO duration tests for DATE_ADD() / DATE_SUBTRACT()
 ////////////////////////////////////////////////////////////////////////////////
@@ -1008,10 +1111,207 @@ function ahuacatlDateFunctionsTestSuite () {
       }); 
     },
 
-// TODO: DATE_SUBTRACT()
-// TODO: DATE_DIFF()
-// TODO: DATE_COMPARE()
-// TODO: DATE_FORMAT()
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_subtract function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateSubtractInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_SUBTRACT()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_SUBTRACT(1, 1, 1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN DATE_SUBTRACT(1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN DATE_SUBTRACT(1, 1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN DATE_SUBTRACT(1, null, 'year')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT(null, 1, 'year')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT([], 1, 'year')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT('', 1, 'year')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT(DATE_NOW(), 1, 'sugar')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT(DATE_NOW(), 1, '')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT(DATE_NOW(), 'P1X')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_SUBTRACT(DATE_NOW(), '')");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_subtract function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateSubtract : function () {
+      var values = [
+        [ [ "2012-03-01", 1, "day" ], "2012-02-29T00:00:00.000Z" ],
+        [ [ "2012-03-01Z", "P1D" ], "2012-02-29T00:00:00.000Z" ],
+        [ [ "2000-01-01", 1, "years" ], "1999-01-01T00:00:00.000Z" ],
+        [ [ "2012-02-12T13:24:12Z", 12, "hours" ], "2012-02-12T01:24:12.000Z" ],
+        [ [ "2012-02-12T13:24:12Z", "PT1H30M" ], "2012-02-12T11:54:12.000Z" ],
+        [ [ 0, 1, "ms" ], "1969-12-31T23:59:59.999Z" ]
+      ];
+
+      values.forEach(function (value) {
+        var actual;
+        if (value[0].length === 2) {
+          actual = getQueryResults("RETURN DATE_SUBTRACT(@value, @amount)", {
+            value: value[0][0],
+            amount: value[0][1]
+          });
+        }
+        else {
+          actual = getQueryResults("RETURN DATE_SUBTRACT(@value, @amount, @unit)", {
+            value: value[0][0],
+            amount: value[0][1],
+            unit: value[0][2]
+          });
+        }
+        assertEqual([ value[1] ], actual);
+      }); 
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_diff function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateDiffInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_DIFF()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_DIFF(1, 1)");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_DIFF(1, 1, 'd', true, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(null, 1, 'd')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(1, null, 'd')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF([], 1, 'd')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(1, '', 'd')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(1, 1, 'sugar')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(1, 1, '')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_DIFF(1, 1, null)");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_diff function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateDiff : function () {
+      var values = [
+        [ [ "2012-01-01", "2012-01-08", "days" ], 7 ],
+        [ [ "2012-01-08", "2012-01-01", "d" ], -7 ],
+        [ [ "2012-01-01", "2012-01-08", "weeks" ], 1 ],
+        [ [ "2012-01-01", "2012-03-01", "months" ], 2 ],
+        [ [ "2012-01-01", "2014-01-01", "Years" ], 2 ],
+        [ [ "2012-01-01T00:00:00Z", "2012-01-01T12:00:00Z", "d" ], 0 ],
+        [ [ "2012-01-01T00:00:00Z", "2012-01-01T12:00:00Z", "d", true ], 0.5 ],
+        [ [ 0, 1500, "s" ], 1 ],
+        [ [ 0, 1500, "s", true ], 1.5 ],
+        [ [ 0, 60000, "minutes" ], 1 ],
+        [ [ 0, 0, "ms" ], 0 ]
+      ];
+
+      values.forEach(function (value) {
+        var actual = getQueryResults("RETURN DATE_DIFF(@value[0], @value[1], @value[2], @value[3])", { value: value[0] });
+        assertEqual([ value[1] ], actual);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_compare function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateCompareInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_COMPARE()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_COMPARE(1, 1)");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_COMPARE(1, 1, 'years', 'days', 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(null, 1, 'years')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, {}, 'years')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, '', 'years')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, 1, 'sugar')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, 1, '')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, 1, null)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, 1, 'years', 'sugar')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_COMPARE(1, 1, 'days', 'years')");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_compare function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateCompare : function () {
+      var values = [
+        [ [ "2012-02-12", "2012-02-28", "years", "months" ], true ],
+        [ [ "2012-02-12", "2012-02-28", "days" ], false ],
+        [ [ "2012-02-12T13:00:00Z", "2013-02-12T13:00:00Z", "months", "hours" ], true ],
+        [ [ "2012-02-12T13:00:00Z", "2012-02-12T13:00:01Z", "years", "minutes" ], true ],
+        [ [ "2012-02-12T13:00:00Z", "2012-02-12T13:00:01Z", "years", "seconds" ], false ],
+        [ [ "2012-02-12", "2012-02-12", "milliseconds" ], true ]
+      ];
+
+      values.forEach(function (value) {
+        var actual;
+        if (value[0].length === 3) {
+          actual = getQueryResults("RETURN DATE_COMPARE(@value[0], @value[1], @value[2])", { value: value[0] });
+        }
+        else {
+          actual = getQueryResults("RETURN DATE_COMPARE(@value[0], @value[1], @value[2], @value[3])", { value: value[0] });
+        }
+        assertEqual([ value[1] ], actual);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_format function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateFormatInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_FORMAT()");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_FORMAT(1)");
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_FORMAT(1, '%y', 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT(null, '%y')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT(false, '%y')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT('', '%y')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT(1, null)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT(1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_FORMAT(1, [])");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test date_format function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateFormat : function () {
+      var dt = "2012-02-12T13:24:12.345Z";
+      var values = [
+        [ "%yyyy-%mm-%dd", "2012-02-12" ],
+        [ "%hh:%ii:%ss.%fff", "13:24:12.345" ],
+        [ "%y/%m/%d %h:%i:%s", "2012/2/12 13:24:12" ],
+        [ "%q", "1" ],
+        [ "%mmmm", "February" ],
+        [ "%wwww", "Sunday" ],
+        [ "%%", "%" ],
+        [ "", "" ],
+        [ "no placeholders", "no placeholders" ]
+      ];
+
+      values.forEach(function (value) {
+        var actual = getQueryResults("RETURN DATE_FORMAT(@value, @format)", { value: dt, format: value[0] });
+        assertEqual([ value[1] ], actual, value[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test the warnings registered for invalid date values
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateWarnings : function () {
+      var typeMismatch = errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code;
+      var invalidDate = errors.ERROR_QUERY_INVALID_DATE_VALUE.code;
+      var numberMismatch = errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code;
+
+      assertQueryWarnings([ ], "RETURN DATE_YEAR('2012-01-01')");
+      assertQueryWarnings([ ], "RETURN DATE_YEAR(0)");
+      assertQueryWarnings([ typeMismatch, invalidDate ], "RETURN DATE_YEAR(null)");
+      assertQueryWarnings([ typeMismatch, invalidDate ], "RETURN DATE_YEAR(false)");
+      assertQueryWarnings([ typeMismatch, invalidDate ], "RETURN DATE_YEAR([ ])");
+      assertQueryWarnings([ invalidDate ], "RETURN DATE_YEAR('')");
+      assertQueryWarnings([ invalidDate ], "RETURN DATE_YEAR('foo')");
+      assertQueryWarnings([ invalidDate ], "RETURN DATE_YEAR(9e15)");
+      assertQueryWarnings([ numberMismatch, invalidDate ], "RETURN DATE_TIMESTAMP(2012, 1)");
+      assertQueryWarnings([ typeMismatch, invalidDate ], "RETURN DATE_TIMESTAMP(2012, [ ], 1)");
+      assertQueryWarnings([ invalidDate ], "RETURN DATE_TIMESTAMP(2012, -1, 1)");
+      assertQueryWarnings([ typeMismatch ], "RETURN DATE_ADD(0, null, 'days')");
+      assertQueryWarnings([ invalidDate ], "RETURN DATE_ADD(0, 1, 'sugar')");
+    },
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test date_timestamp function
@@ -1020,6 +1320,13 @@ function ahuacatlDateFunctionsTestSuite () {
     testDateTimestampInvalid : function () {
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_TIMESTAMP()");
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN DATE_TIMESTAMP(1, 1, 1, 1, 1, 1, 1, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP(null)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP(false)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP([])");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP('')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP(2012, 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP(2012, [], 1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_INVALID_DATE_VALUE.code, "RETURN DATE_TIMESTAMP(2012, -1, 1)");
     },
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1282,6 +1589,43 @@ function ahuacatlDateFunctionsTestSuite () {
 
       actual = getQueryResults("RETURN DATE_ISO8601(DATE_TIMESTAMP(DATE_YEAR(@value), DATE_MONTH(@value), DATE_DAY(@value), DATE_HOUR(@value), DATE_MINUTE(@value), DATE_SECOND(@value), DATE_MILLISECOND(@value)))", { value: dt + "Z" });
       assertEqual([ dt + "Z" ], actual); 
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the date functions are executed without V8
+////////////////////////////////////////////////////////////////////////////////
+
+    testDateFunctionsNoV8 : function () {
+      var expressions = [
+        "DATE_NOW()",
+        "DATE_TIMESTAMP(value)",
+        "DATE_TIMESTAMP(DATE_YEAR(value), DATE_MONTH(value), DATE_DAY(value))",
+        "DATE_ISO8601(value)",
+        "DATE_DAYOFWEEK(value)",
+        "DATE_YEAR(value)",
+        "DATE_MONTH(value)",
+        "DATE_DAY(value)",
+        "DATE_HOUR(value)",
+        "DATE_MINUTE(value)",
+        "DATE_SECOND(value)",
+        "DATE_MILLISECOND(value)",
+        "DATE_DAYOFYEAR(value)",
+        "DATE_ISOWEEK(value)",
+        "DATE_LEAPYEAR(value)",
+        "DATE_QUARTER(value)",
+        "DATE_DAYS_IN_MONTH(value)",
+        "DATE_ADD(value, 1, 'day')",
+        "DATE_SUBTRACT(value, 'P1D')",
+        "DATE_DIFF(value, '2015-01-01', 'd')",
+        "DATE_COMPARE(value, '2015-01-01', 'years', 'days')",
+        "DATE_FORMAT(value, '%yyyy-%mm-%dd')"
+      ];
+
+      expressions.forEach(function (expression) {
+        var query = "FOR value IN [ '2014-05-07T15:23:21.446Z', 1399476201446 ] RETURN " + expression;
+        assertNoV8Expressions(query);
+        assertEqual(2, AQL_EXECUTE(query).json.length, query);
+      });
     }
   
   };
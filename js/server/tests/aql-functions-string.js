@@ -1,5 +1,5 @@
 /*jshint globalstrict:false, strict:false, maxlen: 500 */
-/*global assertEqual */
+/*global assertEqual, assertNotEqual, AQL_EXECUTE, AQL_EXPLAIN */
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief tests for query language, functions
 ///
@@ -33,12 +33,43 @@ var jsunity = require("jsunity");
 var helper = require("org/arangodb/aql-helper");
 var getQueryResults = helper.getQueryResults;
 var assertQueryError = helper.assertQueryError;
+var assertQueryWarningAndNull = helper.assertQueryWarningAndNull;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test suite
 ////////////////////////////////////////////////////////////////////////////////
 
 function ahuacatlStringFunctionsTestSuite () {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes a query and checks its result and warnings
+////////////////////////////////////////////////////////////////////////////////
+
+  var assertQueryResultAndWarnings = function (expected, warnings, query) {
+    var result = AQL_EXECUTE(query);
+
+    assertEqual([ expected ], result.json, query);
+    assertEqual(warnings, result.warnings.map(function (warning) {
+      return warning.code;
+    }), query);
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks that the calculations of a query do not need V8
+////////////////////////////////////////////////////////////////////////////////
+
+  var assertNoV8Expressions = function (query) {
+    var nodes = AQL_EXPLAIN(query, { }, { optimizer: { rules: [ "-all" ] } }).plan.nodes;
+    var types = nodes.filter(function (node) {
+      return node.type === "CalculationNode";
+    }).map(function (node) {
+      return node.expressionType;
+    });
+
+    assertNotEqual(-1, types.indexOf("simple"), query);
+    assertEqual(-1, types.indexOf("v8"), query);
+  };
+
   return {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -318,6 +349,26 @@ function ahuacatlStringFunctionsTestSuite () {
       });
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test contains with invalid and empty arguments
+////////////////////////////////////////////////////////////////////////////////
+
+    testContainsInvalid : function () {
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN CONTAINS()"); 
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN CONTAINS('foo')"); 
+      assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN CONTAINS('foo', 'bar', true, 1)"); 
+      assertQueryResultAndWarnings(true, [ ], "RETURN CONTAINS(null, 'ul')");
+      assertQueryResultAndWarnings(true, [ ], "RETURN CONTAINS(true, 'ru')");
+      assertQueryResultAndWarnings(1, [ ], "RETURN CONTAINS(123, 2, true)");
+      assertQueryResultAndWarnings(true, [ ], "RETURN CONTAINS([ 1, 2 ], ',')");
+      assertQueryResultAndWarnings(true, [ ], "RETURN CONTAINS({ }, 'object')");
+      assertQueryResultAndWarnings(true, [ ], "RETURN CONTAINS('null', null)");
+      assertQueryResultAndWarnings(false, [ ], "RETURN CONTAINS('foo', '')");
+      assertQueryResultAndWarnings(-1, [ ], "RETURN CONTAINS('foo', '', true)");
+      assertQueryResultAndWarnings(false, [ ], "RETURN CONTAINS('', 'foo')");
+      assertQueryResultAndWarnings(false, [ ], "RETURN CONTAINS('', '')");
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test left function
 ////////////////////////////////////////////////////////////////////////////////
@@ -434,6 +485,17 @@ function ahuacatlStringFunctionsTestSuite () {
     testSubstituteInvalid : function () {
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN SUBSTITUTE()"); 
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN SUBSTITUTE('foo', 'bar', 'baz', 2, 2)"); 
+      assertQueryResultAndWarnings("nxll", [ ], "RETURN SUBSTITUTE(null, 'u', 'x')");
+      assertQueryResultAndWarnings("frue", [ ], "RETURN SUBSTITUTE(true, 't', 'f')");
+      assertQueryResultAndWarnings("foo 2", [ ], "RETURN SUBSTITUTE('foo 1', 1, 2)");
+      assertQueryResultAndWarnings("foo", [ ], "RETURN SUBSTITUTE('foo', null, 'x')");
+      assertQueryResultAndWarnings("f", [ ], "RETURN SUBSTITUTE('foo', 'o')");
+      assertQueryResultAndWarnings("f", [ ], "RETURN SUBSTITUTE('foo', 'o', null)");
+      assertQueryResultAndWarnings("f", [ ], "RETURN SUBSTITUTE('foo', [ 'o' ], [ ])");
+      assertQueryResultAndWarnings("", [ ], "RETURN SUBSTITUTE('', 'a', 'b')");
+      assertQueryResultAndWarnings("foo", [ errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code ], "RETURN SUBSTITUTE('foo', [ ], 'x')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN SUBSTITUTE('foo', 'o', 'x', -1)");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN SUBSTITUTE('foo', { o: 'x' }, -1)");
     },
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -513,6 +575,16 @@ function ahuacatlStringFunctionsTestSuite () {
     testSplitInvalid : function () {
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN SPLIT()"); 
       assertQueryError(errors.ERROR_QUERY_FUNCTION_ARGUMENT_NUMBER_MISMATCH.code, "RETURN SPLIT('foo', '', 10, '')"); 
+      assertQueryResultAndWarnings([ "null" ], [ ], "RETURN SPLIT(null, ',')");
+      assertQueryResultAndWarnings([ "tr", "e" ], [ ], "RETURN SPLIT(true, 'u')");
+      assertQueryResultAndWarnings([ "a", "b", "c" ], [ ], "RETURN SPLIT('a1b2c', [ 1, 2 ])");
+      assertQueryResultAndWarnings([ "a,b" ], [ ], "RETURN SPLIT('a,b', null)");
+      assertQueryResultAndWarnings([ "a", ",", "b" ], [ ], "RETURN SPLIT('a,b', [ ])");
+      assertQueryResultAndWarnings([ ], [ ], "RETURN SPLIT('a,b', ',', 0)");
+      assertQueryResultAndWarnings([ "a", "b" ], [ ], "RETURN SPLIT('a,b', ',', null)");
+      assertQueryResultAndWarnings([ "" ], [ ], "RETURN SPLIT('', ',')");
+      assertQueryResultAndWarnings([ ], [ ], "RETURN SPLIT('', '')");
+      assertQueryWarningAndNull(errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH.code, "RETURN SPLIT('a,b', ',', -1)");
     },
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1078,6 +1150,64 @@ function ahuacatlStringFunctionsTestSuite () {
       assertEqual([ "[object object]" ], getQueryResults("RETURN LOWER({})"));
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test string functions with empty arguments
+////////////////////////////////////////////////////////////////////////////////
+
+    testStringFunctionsEmpty : function () {
+      var queries = [
+        [ "RETURN CONCAT_SEPARATOR('', 'a', 'b')", "ab" ],
+        [ "RETURN CONCAT_SEPARATOR(',', null)", "" ],
+        [ "RETURN CONCAT_SEPARATOR(',', [ ])", "" ],
+        [ "RETURN CHAR_LENGTH('')", 0 ],
+        [ "RETURN LOWER('')", "" ],
+        [ "RETURN UPPER('')", "" ],
+        [ "RETURN SUBSTRING('', 0, 1)", "" ],
+        [ "RETURN LEFT('', 1)", "" ],
+        [ "RETURN RIGHT('', 1)", "" ],
+        [ "RETURN TRIM('')", "" ],
+        [ "RETURN LTRIM('')", "" ],
+        [ "RETURN RTRIM('')", "" ],
+        [ "RETURN FIND_FIRST('', 'a')", -1 ],
+        [ "RETURN FIND_LAST('', 'a')", -1 ]
+      ];
+
+      queries.forEach(function (query) {
+        assertQueryResultAndWarnings(query[1], [ ], query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the string functions are executed without V8
+////////////////////////////////////////////////////////////////////////////////
+
+    testStringFunctionsNoV8 : function () {
+      var expressions = [
+        "CONCAT_SEPARATOR(',', value, 'b')",
+        "CHAR_LENGTH(value)",
+        "LOWER(value)",
+        "UPPER(value)",
+        "SUBSTRING(value, 1, 2)",
+        "CONTAINS(value, 'o', true)",
+        "LEFT(value, 2)",
+        "RIGHT(value, 2)",
+        "TRIM(value)",
+        "LTRIM(value, ' ')",
+        "RTRIM(value, ' ')",
+        "FIND_FIRST(value, 'o')",
+        "FIND_LAST(value, 'o', 1)",
+        "SPLIT(value, ' ', 2)",
+        "SUBSTITUTE(value, { 'o': 'a' })",
+        "UPPER(SUBSTITUTE(TRIM(value), 'fox', 'dog'))"
+      ];
+
+      expressions.forEach(function (expression) {
+        var query = "FOR value IN [ ' the quick fox ', 'foo' ] RETURN " + expression;
+        assertNoV8Expressions(query);
+        assertEqual(2, AQL_EXECUTE(query).json.length, query);
+      });
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test upper function
 ////////////////////////////////////////////////////////////////////////////////
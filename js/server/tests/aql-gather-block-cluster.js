@@ -333,6 +333,110 @@ function gatherBlockTestSuite () {
       var actual = AQL_EXECUTE(query).json;
 
       assertEqual(expected, actual, query);
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief results of several batches per shard, fetched ahead of time
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchAll : function () {
+      var query = "FOR d IN " + cn1 + " RETURN d.Hallo";
+      
+      var actual = AQL_EXECUTE(query).json;
+      assertEqual(4000, actual.length, query);
+
+      var counts = [ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 ];
+      actual.forEach(function (value) {
+        counts[value]++;
+      });
+      assertEqual([ 400, 400, 400, 400, 400, 400, 400, 400, 400, 400 ], counts, query);
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief sorted gather requests the next batch from all shards at once
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchSorted : function () {
+      var query = "FOR d IN " + cn1 + " SORT d.Hallo RETURN d.Hallo";
+      
+      assertTrue(explain(AQL_EXPLAIN(query)).indexOf("GatherNode") !== -1, query);
+
+      var actual = AQL_EXECUTE(query).json;
+      assertEqual(4000, actual.length, query);
+
+      for (var i = 0; i < actual.length; ++i) {
+        assertEqual(Math.floor(i / 400), actual[i], query);
+      }
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief skipping over prefetched and not yet fetched rows
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchSkip : function () {
+      var query = "FOR d IN " + cn1 + " SORT d.Hallo LIMIT 1500, 1000 RETURN d.Hallo";
+      
+      var actual = AQL_EXECUTE(query).json;
+      assertEqual(1000, actual.length, query);
+
+      for (var i = 0; i < actual.length; ++i) {
+        assertEqual(Math.floor((i + 1500) / 400), actual[i], query);
+      }
+      
+      query = "FOR d IN " + cn1 + " LIMIT 3500, 1000 RETURN d.Hallo";
+      assertEqual(500, AQL_EXECUTE(query).json.length, query);
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief a query that stops early leaves prefetch requests in flight,
+    /// which must not break the shutdown of the query
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchEarlyEnd : function () {
+      var query, actual, i;
+
+      query = "FOR d IN " + cn1 + " SORT d.Hallo LIMIT 1100 RETURN d.Hallo";
+      for (i = 0; i < 5; ++i) {
+        actual = AQL_EXECUTE(query).json;
+        assertEqual(1100, actual.length, query);
+        assertEqual(2, actual[1099], query);
+      }
+
+      query = "FOR d IN " + cn1 + " FOR e IN " + cn3 + " FILTER d.Hallo == e.Hallo LIMIT 1001 RETURN d.Hallo";
+      for (i = 0; i < 5; ++i) {
+        assertEqual(1001, AQL_EXECUTE(query).json.length, query);
+      }
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief a subquery re-initializes its remote blocks for every outer row,
+    /// which must discard the rows prefetched for the previous row
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchSubquery : function () {
+      var query = "FOR x IN 0..9 LET s = (FOR d IN " + cn1 + " FILTER d.Hallo == x LIMIT 5 RETURN d.Hallo) RETURN s";
+      
+      var actual = AQL_EXECUTE(query).json;
+      assertEqual(10, actual.length, query);
+
+      for (var i = 0; i < actual.length; ++i) {
+        assertEqual([ i, i, i, i, i ], actual[i], query);
+      }
+      
+      query = "FOR x IN 1..3 LET s = (FOR d IN " + cn1 + " SORT d.Hallo RETURN d.Hallo) RETURN [ LENGTH(s), s[0], s[3999] ]";
+      assertEqual([ [ 4000, 0, 9 ], [ 4000, 0, 9 ], [ 4000, 0, 9 ] ], AQL_EXECUTE(query).json, query);
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief counting with fullCount skips over prefetched rows
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testPrefetchFullCount : function () {
+      var query = "FOR d IN " + cn1 + " LIMIT 10, 20 RETURN d.Hallo";
+      
+      var result = AQL_EXECUTE(query, { }, { fullCount: true });
+      assertEqual(20, result.json.length, query);
+      assertEqual(4000, result.stats.fullCount, query);
     }
 
   };
@@ -0,0 +1,152 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, fail, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for the AQL memory limit
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+var internal = require("internal");
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function memoryLimitTestSuite () {
+  var c = null;
+  var cn = "UnitTestsAhuacatlMemoryLimit";
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 2000; ++i) {
+        c.save({ value: i, text: "this is a test string " + i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test peak memory usage is reported
+////////////////////////////////////////////////////////////////////////////////
+
+    testPeakMemoryUsage : function () {
+      var result = AQL_EXECUTE("FOR i IN " + cn + " SORT i.text RETURN MERGE(i, { foo: 'bar' })");
+
+      assertEqual(2000, result.json.length);
+      assertTrue(result.stats.hasOwnProperty("peakMemoryUsage"));
+      assertTrue(result.stats.peakMemoryUsage > 0);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test peak memory usage grows with the data
+////////////////////////////////////////////////////////////////////////////////
+
+    testPeakMemoryUsageGrows : function () {
+      var small = AQL_EXECUTE("FOR i IN 1..10 SORT i DESC RETURN CONCAT('test', i)");
+      var large = AQL_EXECUTE("FOR i IN 1..100000 SORT i DESC RETURN CONCAT('test', i)");
+
+      assertEqual(10, small.json.length);
+      assertEqual(100000, large.json.length);
+      assertTrue(large.stats.peakMemoryUsage > small.stats.peakMemoryUsage);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test recycling of item blocks
+////////////////////////////////////////////////////////////////////////////////
+
+    testItemBlockRecycling : function () {
+      var result = AQL_EXECUTE("FOR i IN " + cn + " FOR j IN 1..10 FILTER j == 5 RETURN i.value");
+
+      assertEqual(2000, result.json.length);
+      assertTrue(result.stats.hasOwnProperty("itemBlocksRequested"));
+      assertTrue(result.stats.hasOwnProperty("itemBlocksRecycled"));
+      assertTrue(result.stats.itemBlocksRequested > 0);
+      assertTrue(result.stats.itemBlocksRecycled > 0);
+      assertTrue(result.stats.itemBlocksRecycled <= result.stats.itemBlocksRequested);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test queries within the limit
+////////////////////////////////////////////////////////////////////////////////
+
+    testWithinLimit : function () {
+      var result = AQL_EXECUTE("FOR i IN " + cn + " FILTER i.value < 10 RETURN i.value", { }, { memoryLimit: 1024 * 1024 * 1024 });
+
+      assertEqual(10, result.json.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test queries exceeding the limit
+////////////////////////////////////////////////////////////////////////////////
+
+    testExceedLimit : function () {
+      var queries = [
+        "FOR i IN " + cn + " LET x = MERGE(i, { foo: 'bar' }) SORT x.value DESC RETURN x",
+        "FOR i IN 1..100000 SORT CONCAT('test', i) RETURN i",
+        "FOR i IN 1..100000 LET s = (FOR j IN 1..10 RETURN CONCAT(i, '-', j)) RETURN s"
+      ];
+
+      queries.forEach(function(query) {
+        try {
+          AQL_EXECUTE(query, { }, { memoryLimit: 64 * 1024 });
+          fail();
+        }
+        catch (err) {
+          assertEqual(internal.errors.ERROR_QUERY_RESOURCE_LIMIT.code, err.errorNum, query);
+        }
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(memoryLimitTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
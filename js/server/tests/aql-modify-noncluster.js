@@ -2056,6 +2056,76 @@ function ahuacatlInsertSuite () {
       db._drop("UnitTestsAhuacatlEdge");
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertBatchIgnore : function () {
+      var expected = { writesExecuted: 4950, writesIgnored: 50 };
+      var actual = getModifyQueryResultsRaw("FOR i IN 0..4999 INSERT { _key: CONCAT('test', TO_STRING((i + 2500) % 5000)), value: i } IN @@cn OPTIONS { ignoreErrors: true } LET inserted = NEW RETURN inserted.value", { "@cn": cn2 });
+
+      assertEqual(4950, actual.json.length);
+      assertEqual(2499, actual.json[2499]);
+      assertEqual(2550, actual.json[2500]);
+      assertEqual(5000, c2.count());
+      assertEqual(expected, sanitizeStats(actual.stats));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertBatchUniqueConstraint : function () {
+      assertQueryError(errors.ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED.code, "FOR i IN 0..4999 INSERT { _key: CONCAT('test', TO_STRING((i + 2500) % 5000)) } IN @@cn", { "@cn": cn2 });
+      assertEqual(50, c2.count());
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertBatchEdges : function () {
+      db._drop("UnitTestsAhuacatlEdge");
+      var edge = db._createEdgeCollection("UnitTestsAhuacatlEdge"); 
+
+      var actual = getModifyQueryResultsRaw("FOR i IN 0..2999 INSERT { _from: CONCAT('UnitTestsAhuacatlInsert1/test', TO_STRING(i % 100)), _to: CONCAT('UnitTestsAhuacatlInsert2/test', TO_STRING(i % 50)) } INTO @@cn LET inserted = NEW RETURN inserted", { "@cn": edge.name() });
+
+      assertEqual(3000, actual.json.length);
+      assertEqual(3000, edge.count());
+      actual.json.forEach(function (doc, i) {
+        assertEqual("UnitTestsAhuacatlInsert1/test" + (i % 100), doc._from);
+        assertEqual("UnitTestsAhuacatlInsert2/test" + (i % 50), doc._to);
+      });
+      assertEqual(30, edge.outEdges(cn1 + "/test7").length);
+      assertEqual(60, edge.inEdges(cn2 + "/test7").length);
+
+      db._drop("UnitTestsAhuacatlEdge");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertBatchHashIndexes : function () {
+      c2.ensureHashIndex("value1");
+      c2.ensureUniqueConstraint("value2");
+
+      var lookup = "FOR doc IN @@cn FILTER doc.value1 == 3 RETURN doc.value2";
+      var expected = { writesExecuted: 50, writesIgnored: 4950 };
+      var actual = getModifyQueryResultsRaw("FOR i IN 0..4999 INSERT { value1: i % 10, value2: CONCAT('test', TO_STRING(i % 100)) } IN @@cn OPTIONS { ignoreErrors: true }", { "@cn": cn2 });
+
+      assertEqual(expected, sanitizeStats(actual.stats));
+      assertEqual(100, c2.count());
+
+      // documents rejected by the unique index must not be left in the other index
+      actual = AQL_EXECUTE(lookup, { "@cn": cn2 }).json.sort();
+      assertEqual([ "test3", "test53", "test63", "test73", "test83", "test93" ], actual);
+
+      actual = getModifyQueryResultsRaw("FOR i IN 0..4999 INSERT { value1: i % 10, value2: CONCAT('other', TO_STRING(i)) } IN @@cn", { "@cn": cn2 });
+      assertEqual(5100, c2.count());
+      assertEqual(506, AQL_EXECUTE(lookup, { "@cn": cn2 }).json.length);
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test insert
 ////////////////////////////////////////////////////////////////////////////////
@@ -4122,6 +4122,127 @@ function optimizerIndexesSortTestSuite () {
   };
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerIndexCombinationTestSuite () {
+  var c;
+  var noOpt = { optimizer: { rules: [ "-all" ] } };
+
+  var combination = function (query, bind) {
+    var result = null;
+    AQL_EXPLAIN(query, bind || { }).plan.nodes.forEach(function(node) {
+      if (node.type === "IndexRangeNode") {
+        result = node.combination;
+      }
+    });
+    return result;
+  };
+
+  var compare = function (query, bind) {
+    var expected = AQL_EXECUTE(query, bind || { }, noOpt).json.sort();
+    var results = AQL_EXECUTE(query, bind || { });
+    assertEqual(expected, results.json.sort(), query);
+    return results;
+  };
+
+  return {
+    setUp : function () {
+      db._drop("UnitTestsCollection");
+      c = db._create("UnitTestsCollection");
+
+      for (var i = 0; i < 5000; ++i) {
+        c.save({ _key: "test" + i, tenant: "t" + (i % 50), owner: "u" + (i % 70), value: i });
+      }
+
+      c.ensureHashIndex("tenant");
+      c.ensureHashIndex("owner");
+    },
+
+    tearDown : function () {
+      db._drop("UnitTestsCollection");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test index intersection
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexIntersection : function () {
+      var query = "FOR i IN " + c.name() + " FILTER i.tenant == @tenant && i.owner == @owner RETURN i._key";
+      var bind = { tenant: "t7", owner: "u17" };
+
+      assertEqual("intersection", combination(query, bind));
+
+      var results = compare(query, bind);
+      assertEqual(14, results.json.length);
+      assertEqual(0, results.stats.scannedFull);
+
+      // no matches
+      bind = { tenant: "t7", owner: "u13" };
+      results = compare(query, bind);
+      assertEqual(0, results.json.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test index intersection with separate FILTER statements and SORT
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexIntersectionSort : function () {
+      var query = "FOR i IN " + c.name() + " FILTER i.owner == 'u17' FILTER i.tenant == 't7' SORT i.value DESC RETURN i.value";
+
+      assertEqual("intersection", combination(query));
+
+      var results = AQL_EXECUTE(query).json;
+      assertEqual(14, results.length);
+      for (var i = 1; i < results.length; ++i) {
+        assertTrue(results[i - 1] > results[i]);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test index union
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexUnion : function () {
+      var query = "FOR i IN " + c.name() + " FILTER i.tenant == 't7' || i.owner == 'u17' RETURN i._key";
+
+      assertEqual("union", combination(query));
+
+      // documents matching both conditions must be returned only once
+      var results = compare(query);
+      assertEqual(100 + 72 - 14, results.json.length);
+      assertEqual(0, results.stats.scannedFull);
+
+      query = "FOR i IN " + c.name() + " FILTER i.tenant IN [ 't1', 't2' ] || i.owner == 'u3' || i._key == 'test4999' RETURN i._key";
+      assertEqual("union", combination(query));
+      compare(query);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test conditions that cannot use index intersection or union
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexCombinationNotUsed : function () {
+      var queries = [
+        // one part of the OR condition is not indexed
+        "FOR i IN " + c.name() + " FILTER i.tenant == 't7' || i.value == 17 RETURN i._key",
+        // one index is sufficient
+        "FOR i IN " + c.name() + " FILTER i.tenant == 't7' || i.tenant == 't8' RETURN i._key",
+        "FOR i IN " + c.name() + " FILTER i.tenant == 't7' && i.value == 17 RETURN i._key",
+        // non-constant lookup value
+        "FOR t IN [ 't7', 't8' ] FOR i IN " + c.name() + " FILTER i.tenant == t && i.owner == 'u17' RETURN i._key"
+      ];
+
+      queries.forEach(function(query) {
+        assertEqual(-1, [ "intersection", "union" ].indexOf(combination(query)), query);
+        compare(query);
+      });
+    }
+
+  };
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief executes the test suites
 ////////////////////////////////////////////////////////////////////////////////
@@ -4131,6 +4252,7 @@ jsunity.run(optimizerEdgeIndexTestSuite);
 jsunity.run(optimizerIndexesInOrTestSuite);
 jsunity.run(optimizerIndexesRangesTestSuite);
 jsunity.run(optimizerIndexesSortTestSuite);
+jsunity.run(optimizerIndexCombinationTestSuite);
 
 return jsunity.done();
 
@@ -0,0 +1,226 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertFalse, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "decorrelate-subqueries";
+
+  // various choices to control the optimizer: 
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var outer = null;
+  var inner = null;
+  var outerName = "UnitTestsAhuacatlOptimizerOuter";
+  var innerName = "UnitTestsAhuacatlOptimizerInner";
+
+  var subqueryNodes = function (plan) {
+    return plan.nodes.filter(function(node) {
+      return (node.type === "SubqueryNode");
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      var i;
+
+      db._drop(outerName);
+      db._drop(innerName);
+      outer = db._create(outerName);
+      inner = db._create(innerName);
+
+      for (i = 0; i < 100; ++i) {
+        outer.save({ _key: "test" + i, value: i, ref: i % 10, sub: { ref: i % 10 } });
+      }
+      for (i = 0; i < 50; ++i) {
+        inner.save({ value: i % 20, name: "test" + i, sub: { value: i % 20 } });
+      }
+      inner.save({ name: "null" });
+      inner.save({ value: "5", name: "string" });
+      inner.save({ value: -0, name: "zero" });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(outerName);
+      db._drop(innerName);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [ 
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value > o.ref RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref + 1 RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN [ i, o ]) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref LIMIT 1 RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref SORT i.name RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN RAND()) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FOR j IN " + outerName + " FILTER i.value == o.ref RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i) REMOVE o IN " + innerName
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertTrue(result.plan.rules.indexOf(ruleName) === -1, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [ 
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER o.ref == i.value RETURN i.name) RETURN x",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.sub.value == o.sub.ref FILTER i.name != 'test1' RETURN i.name) RETURN x",
+        "FOR o IN 1..100 LET x = (FOR i IN " + innerName + " FILTER i.value == o RETURN i) RETURN x"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query);
+        var nodes = subqueryNodes(result.plan);
+        assertEqual(1, nodes.length, query);
+        assertTrue(nodes[0].hasOwnProperty("outerKeyVariable"), query);
+        assertFalse(nodes[0].isConst, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the original plan is kept
+////////////////////////////////////////////////////////////////////////////////
+
+    testOriginalPlanKept : function () {
+      var query = "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i) RETURN x";
+
+      var plans = AQL_EXPLAIN(query, { }, { allPlans: true, optimizer: { rules: [ "-all", "+" + ruleName ] } }).plans;
+      assertEqual(2, plans.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test constant subqueries
+////////////////////////////////////////////////////////////////////////////////
+
+    testConstSubqueries : function () {
+      var queries = [ 
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " RETURN i.value) RETURN x", true ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN 1..10 RETURN i) RETURN x", true ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i) RETURN x", false ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " RETURN RAND()) RETURN x", false ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " SORT RAND() RETURN i) RETURN x", false ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " RETURN i) REMOVE o IN " + innerName, false ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN 1..10 INSERT { value: i } IN " + innerName + ") RETURN x", false ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramDisabled);
+        var nodes = subqueryNodes(result.plan);
+        assertEqual(1, nodes.length, query[0]);
+        assertEqual(query[1], nodes[0].isConst, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results of constant subqueries
+////////////////////////////////////////////////////////////////////////////////
+
+    testConstResults : function () {
+      var query = "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == 5 RETURN i.name) RETURN [ o.value, x ]";
+      var result = AQL_EXECUTE(query).json;
+
+      assertEqual(100, result.length);
+      result.forEach(function(row) {
+        assertEqual([ "test5", "test25", "test45" ], row[1].sort());
+      });
+
+      query = "FOR o IN 1..3 LET x = (FOR j IN 1..3 LET y = (FOR i IN 1..2 RETURN i) RETURN [ j, y ]) RETURN x";
+      result = AQL_EXECUTE(query).json;
+      assertEqual(3, result.length);
+      result.forEach(function(row) {
+        assertEqual([ [ 1, [ 1, 2 ] ], [ 2, [ 1, 2 ] ], [ 3, [ 1, 2 ] ] ], row);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [ 
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i.name) RETURN [ o.value, x ]",
+        "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.sub.value == o.sub.ref RETURN i.name) RETURN [ o.value, x ]",
+        "FOR o IN 0..20 LET x = (FOR i IN " + innerName + " FILTER i.value == o FILTER i.name != 'test0' RETURN i.name) RETURN [ o, x ]",
+        "FOR o IN [ null, '5', 0, 5, 5.0, [ 1 ], 99 ] LET x = (FOR i IN " + innerName + " FILTER i.value == o RETURN i.name) RETURN x",
+        "FOR o IN " + outerName + " FILTER o.value < 20 LET x = (FOR i IN " + innerName + " FILTER i.value == o.value RETURN LENGTH(i.name)) RETURN LENGTH(x)"
+      ];
+
+      queries.forEach(function(query) {
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query, { }, paramEnabled).json;
+
+        assertTrue(resultDisabled.length > 0, query);
+        assertEqual(resultDisabled, resultEnabled, query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,156 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertTrue, assertEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2015 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+
+var db = require("org/arangodb").db;
+var jsunity = require("jsunity");
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "distribute-collect-to-cluster";
+  // various choices to control the optimizer: 
+  var rulesAll         = { optimizer: { rules: [ "+all" ] } };
+  var thisRuleDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var cn = "UnitTestsAqlOptimizerRuleDistributeCollect";
+  var c;
+
+  var aggregateNodes = function (plan) {
+    return plan.nodes.filter(function(node) {
+      return (node.type === "AggregateNode");
+    });
+  };
+  
+  return {
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief set up
+    ////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn, { numberOfShards: 5 });
+      for (var i = 0; i < 1000; i++) { 
+        c.insert({ value: i, group: i % 7, sub: { group: i % 3 } });
+      }
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief tear down
+    ////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief test that rule has no effect
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [ 
+        "FOR d IN " + cn + " RETURN d",
+        "FOR d IN " + cn + " COLLECT group = d.group INTO g RETURN [ group, LENGTH(g) ]",
+        "FOR d IN " + cn + " COLLECT group = d.group INTO g = d.value RETURN [ group, g ]",
+        "FOR d IN " + cn + " LIMIT 10 COLLECT group = d.group WITH COUNT INTO count RETURN [ group, count ]"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, rulesAll);
+        assertTrue(result.plan.rules.indexOf(ruleName) === -1, query);
+      });
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief test that rule has an effect
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [ 
+        "FOR d IN " + cn + " COLLECT WITH COUNT INTO count RETURN count",
+        "FOR d IN " + cn + " COLLECT group = d.group WITH COUNT INTO count RETURN [ group, count ]",
+        "FOR d IN " + cn + " COLLECT group = d.group, sub = d.sub.group WITH COUNT INTO count RETURN [ group, sub, count ]",
+        "FOR d IN " + cn + " FILTER d.value > 100 COLLECT group = d.group RETURN group",
+        "FOR d IN " + cn + " RETURN DISTINCT d.group"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, rulesAll);
+        assertTrue(result.plan.rules.indexOf(ruleName) !== -1, query);
+        assertEqual(2, aggregateNodes(result.plan).length, query);
+        
+        result = AQL_EXPLAIN(query, { }, thisRuleDisabled);
+        assertTrue(result.plan.rules.indexOf(ruleName) === -1, query);
+        assertEqual(1, aggregateNodes(result.plan).length, query);
+      });
+    },
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// @brief test results
+    ////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [ 
+        [ "FOR d IN " + cn + " COLLECT WITH COUNT INTO count RETURN count", [ 1000 ] ],
+        [ "FOR d IN " + cn + " FILTER d.value < 0 COLLECT WITH COUNT INTO count RETURN count", [ 0 ] ],
+        [ "FOR d IN " + cn + " COLLECT group = d.group WITH COUNT INTO count RETURN [ group, count ]", 
+          [ [ 0, 143 ], [ 1, 143 ], [ 2, 143 ], [ 3, 143 ], [ 4, 143 ], [ 5, 143 ], [ 6, 142 ] ] ],
+        [ "FOR d IN " + cn + " COLLECT group = d.sub.group WITH COUNT INTO count SORT group RETURN [ group, count ]", 
+          [ [ 0, 334 ], [ 1, 333 ], [ 2, 333 ] ] ],
+        [ "FOR d IN " + cn + " FILTER d.value < 10 COLLECT group = d.group SORT group RETURN group", 
+          [ 0, 1, 2, 3, 4, 5, 6 ] ]
+      ];
+
+      queries.forEach(function(query) {
+        var resultEnabled  = AQL_EXECUTE(query[0], { }, rulesAll).json;
+        var resultDisabled = AQL_EXECUTE(query[0], { }, thisRuleDisabled).json;
+
+        assertEqual(query[1], resultEnabled, query[0]);
+        assertEqual(resultDisabled, resultEnabled, query[0]);
+      });
+    }
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
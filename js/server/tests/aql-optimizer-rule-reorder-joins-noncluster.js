@@ -0,0 +1,181 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "reorder-joins";
+
+  // various choices to control the optimizer: 
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var small = null;
+  var big = null;
+  var smallName = "UnitTestsAhuacatlOptimizerSmall";
+  var bigName = "UnitTestsAhuacatlOptimizerBig";
+
+  var collectionOrder = function (plan) {
+    var result = [ ];
+    plan.nodes.forEach(function(node) {
+      if (node.type === "EnumerateCollectionNode" || node.type === "IndexRangeNode") {
+        result.push(node.collection);
+      }
+    });
+    return result;
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      var i;
+
+      db._drop(smallName);
+      db._drop(bigName);
+      small = db._create(smallName);
+      big = db._create(bigName);
+
+      for (i = 0; i < 10; ++i) {
+        small.save({ _key: "test" + i, value: i });
+      }
+      for (i = 0; i < 1000; ++i) {
+        big.save({ value: i, ref: "test" + (i % 10) });
+      }
+      big.ensureHashIndex("ref");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(smallName);
+      db._drop(bigName);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [ 
+        "FOR i IN " + smallName + " RETURN i",
+        "FOR i IN " + smallName + " FOR j IN " + smallName + " RETURN i",
+        "FOR i IN " + smallName + " FOR j IN " + bigName + " FILTER j.ref == i._key RETURN i",
+        "FOR i IN " + smallName + " LIMIT 1 FOR j IN " + bigName + " RETURN i",
+        "FOR i IN 1..10 FOR j IN " + bigName + " FILTER j.value == i RETURN j"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertTrue(result.plan.rules.indexOf(ruleName) === -1, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [ 
+        "FOR j IN " + bigName + " FOR i IN " + smallName + " FILTER j.ref == i._key RETURN i",
+        "FOR j IN " + bigName + " FOR i IN " + smallName + " FILTER i._key == j.ref RETURN i",
+        "FOR j IN " + bigName + " FILTER j.value > 5 FOR i IN " + smallName + " FILTER i._key == j.ref FILTER i.value == 1 RETURN i"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query);
+        assertEqual([ smallName, bigName ], collectionOrder(result.plan), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the reordered join can use the index
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexUsedAfterReordering : function () {
+      var query = "FOR j IN " + bigName + " FOR i IN " + smallName + " FILTER j.ref == i._key RETURN i";
+
+      var result = AQL_EXPLAIN(query);
+      assertNotEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertNotEqual(-1, result.plan.rules.indexOf("use-index-range"));
+
+      var nodes = result.plan.nodes.filter(function(node) {
+        return (node.type === "IndexRangeNode");
+      });
+      assertEqual(1, nodes.length);
+      assertEqual(bigName, nodes[0].collection);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [ 
+        "FOR j IN " + bigName + " FOR i IN " + smallName + " FILTER j.ref == i._key SORT j.value RETURN [ i.value, j.value ]",
+        "FOR j IN " + bigName + " FILTER j.value < 100 FOR i IN " + smallName + " FILTER i._key == j.ref FILTER i.value == 1 SORT j.value RETURN [ i.value, j.value ]",
+        "FOR j IN " + bigName + " FOR i IN " + smallName + " LET v = i.value * 2 FILTER j.ref == i._key FILTER v < 6 SORT j.value RETURN [ v, j.value ]"
+      ];
+
+      queries.forEach(function(query) {
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query).json;
+
+        assertTrue(resultDisabled.length > 0, query);
+        assertEqual(resultDisabled, resultEnabled, query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
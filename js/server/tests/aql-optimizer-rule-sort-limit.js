@@ -0,0 +1,183 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "sort-limit";
+
+  // various choices to control the optimizer: 
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var c = null;
+  var cn = "UnitTestsAhuacatlOptimizerSortLimit";
+
+  var sortLimits = function (plan) {
+    return plan.nodes.filter(function(node) {
+      return (node.type === "SortNode");
+    }).map(function(node) {
+      return node.limit;
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 3000; ++i) {
+        c.save({ value: i, group: i % 7, name: "test" + i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR i IN 1..100 SORT i LIMIT 5 RETURN i",
+        "FOR i IN 1..100 SORT i LIMIT 2, 5 RETURN i"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual([ ], result.plan.rules, query);
+        assertEqual([ 0 ], sortLimits(result.plan), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR i IN 1..100 SORT i RETURN i",
+        "FOR i IN 1..100 SORT i FILTER i > 3 LIMIT 5 RETURN i",
+        "FOR i IN 1..100 SORT i LET x = (FOR j IN 1..i RETURN j) LIMIT 5 RETURN x",
+        "FOR i IN 1..100 SORT i LIMIT 0 RETURN i",
+        "FOR i IN 1..100 LIMIT 5 SORT i RETURN i"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when the LIMIT must count its input
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffectFullCount : function () {
+      var query = "FOR i IN 1..100 SORT i LIMIT 5 RETURN i";
+      var result = AQL_EXPLAIN(query, { }, { fullCount: true, optimizer: paramEnabled.optimizer });
+      assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [ 
+        [ "FOR i IN 1..100 SORT i LIMIT 5 RETURN i", 5 ],
+        [ "FOR i IN 1..100 SORT i DESC LIMIT 2, 5 RETURN i", 7 ],
+        [ "FOR i IN 1..100 SORT i LET x = i * 2 LIMIT 10 RETURN x", 10 ],
+        [ "FOR i IN " + cn + " SORT i.value DESC LIMIT 10 RETURN i", 10 ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+        assertEqual([ query[1] ], sortLimits(result.plan), query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [ 
+        "FOR i IN " + cn + " SORT i.value DESC LIMIT 10 RETURN i.value",
+        "FOR i IN " + cn + " SORT i.value LIMIT 1500, 20 RETURN i.value",
+        "FOR i IN " + cn + " SORT i.group, i.value DESC LIMIT 1200 RETURN [ i.group, i.value ]",
+        "FOR i IN " + cn + " SORT i.name LIMIT 2990, 100 RETURN i.name",
+        "FOR i IN " + cn + " SORT i.group LIMIT 100 RETURN i.group",
+        "FOR i IN " + cn + " FILTER i.value < 5 SORT i.value LIMIT 10 RETURN i.value",
+        "FOR i IN " + cn + " FILTER i.value > 10000 SORT i.value LIMIT 10 RETURN i.value",
+        "FOR i IN 1..10 LET x = (FOR j IN " + cn + " FILTER j.group == i % 7 SORT j.value DESC LIMIT 3 RETURN j.value) RETURN x"
+      ];
+
+      queries.forEach(function(query) {
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query).json;
+
+        assertEqual(resultDisabled, resultEnabled, query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
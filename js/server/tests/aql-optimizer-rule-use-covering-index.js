@@ -0,0 +1,210 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertFalse, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-covering-index";
+
+  var paramEnabled  = { optimizer: { rules: [ "+all" ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var c = null;
+  var cn = "UnitTestsAhuacatlOptimizerCoveringIndex";
+
+  var isCovering = function (plan) {
+    return plan.nodes.filter(function(node) {
+      return (node.type === "IndexRangeNode");
+    }).map(function(node) {
+      return node.covering;
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 2000; ++i) {
+        var doc = { a: i % 100, b: "test" + i, h1: i % 10, h2: "a long string value " + (i % 3), other: i };
+        if (i % 10 === 0) {
+          doc.sub = { c: i, d: [ i ] };
+        }
+        if (i % 100 === 5) {
+          delete doc.b;
+        }
+        c.save(doc);
+      }
+
+      c.ensureSkiplist("a", "b");
+      c.ensureHashIndex("h1", "h2");
+      c.ensureSkiplist("sub.c");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var query = "FOR d IN " + cn + " FILTER d.a == 1 RETURN d.b";
+
+      var result = AQL_EXPLAIN(query, { }, paramDisabled);
+      assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      assertEqual([ false ], isCovering(result.plan), query);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR d IN " + cn + " FILTER d.a == 1 RETURN d",
+        "FOR d IN " + cn + " FILTER d.a == 1 RETURN d.other",
+        "FOR d IN " + cn + " FILTER d.a == 1 RETURN d._key",
+        "FOR d IN " + cn + " FILTER d.a == 1 RETURN MERGE(d, { })",
+        "FOR d IN " + cn + " FILTER d.a == 1 LET x = d RETURN x.b",
+        "FOR d IN " + cn + " FILTER d.a == 1 LET x = (FOR i IN 1..2 RETURN d) RETURN x",
+        "FOR d IN " + cn + " FILTER d.h1 == 1 && d.h2 == 'a long string value 1' SORT d.other RETURN d.h1",
+        "FOR d IN " + cn + " FILTER d.a == 1 UPDATE d WITH { updated: true } IN " + cn,
+        "FOR d IN " + cn + " FILTER d.a == 1 INSERT { value: d.b } IN " + cn,
+        "FOR d IN " + cn + " FILTER d.other == 1 RETURN d.other",
+        "FOR d IN " + cn + " FILTER d.sub.c >= 100 RETURN d.sub",
+        "FOR d IN " + cn + " FILTER d.sub.c >= 100 RETURN d.sub.d"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        "FOR d IN " + cn + " FILTER d.a == 1 RETURN d.b",
+        "FOR d IN " + cn + " FILTER d.a >= 98 SORT d.a, d.b RETURN [ d.a, d.b ]",
+        "FOR d IN " + cn + " FILTER d.a == 1 && d.b == 'test101' RETURN 1",
+        "FOR d IN " + cn + " FILTER d.h1 == 3 && d.h2 == 'a long string value 0' RETURN { h1: d.h1, h2: d.h2 }",
+        "FOR d IN " + cn + " FILTER d.sub.c >= 100 && d.sub.c < 200 RETURN d.sub.c",
+        "FOR i IN 1..3 FOR d IN " + cn + " FILTER d.a == i COLLECT b = d.b WITH COUNT INTO count RETURN [ b, count ]"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertTrue(result.plan.rules.indexOf(ruleName) !== -1, query);
+        assertEqual([ true ], isCovering(result.plan), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        [ "FOR d IN " + cn + " FILTER d.a == 1 SORT d.b RETURN d.b", 20 ],
+        [ "FOR d IN " + cn + " FILTER d.a == 5 RETURN d.b", 20 ],
+        [ "FOR d IN " + cn + " FILTER d.a >= 98 SORT d.a, d.b RETURN [ d.a, d.b ]", 40 ],
+        [ "FOR d IN " + cn + " FILTER d.a IN [ 3, 4 ] && d.b > 'test1' SORT d.b RETURN d.b", 40 ],
+        [ "FOR d IN " + cn + " FILTER d.h1 == 3 && d.h2 == 'a long string value 0' SORT d.h1 RETURN { h1: d.h1, h2: d.h2 }", 67 ],
+        [ "FOR d IN " + cn + " FILTER d.sub.c >= 100 && d.sub.c < 200 SORT d.sub.c RETURN d.sub.c", 10 ],
+        [ "FOR i IN 1..3 FOR d IN " + cn + " FILTER d.a == i COLLECT b = d.b WITH COUNT INTO count RETURN [ b, count ]", 60 ]
+      ];
+
+      queries.forEach(function(query) {
+        var expected = AQL_EXECUTE(query[0], { }, paramDisabled).json;
+        var actual = AQL_EXECUTE(query[0], { }, paramEnabled).json;
+
+        assertEqual(query[1], actual.length, query[0]);
+        assertEqual(expected, actual, query[0]);
+      });
+
+      // documents without the attribute
+      var actual = AQL_EXECUTE("FOR d IN " + cn + " FILTER d.a == 5 RETURN d.b", { }, paramEnabled).json;
+      actual.forEach(function(value) {
+        assertEqual(null, value);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the index scan produces the indexed attributes only
+////////////////////////////////////////////////////////////////////////////////
+
+    testResultsMissingAttributes : function () {
+      var query = "FOR d IN " + cn + " FILTER d.a == 1 RETURN d.b.x";
+      var result = AQL_EXPLAIN(query, { }, paramEnabled);
+      assertEqual([ true ], isCovering(result.plan), query);
+
+      var actual = AQL_EXECUTE(query, { }, paramEnabled).json;
+      assertEqual(20, actual.length);
+      actual.forEach(function(value) {
+        assertEqual(null, value);
+      });
+
+      assertFalse(AQL_EXPLAIN("FOR d IN " + cn + " FILTER d.a == 1 RETURN d.other", { }, paramEnabled).plan.rules.indexOf(ruleName) !== -1);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -0,0 +1,225 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertNotEqual, fail, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+var internal = require("internal");
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-hash-join";
+
+  // various choices to control the optimizer: 
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var outer = null;
+  var inner = null;
+  var outerName = "UnitTestsAhuacatlOptimizerOuter";
+  var innerName = "UnitTestsAhuacatlOptimizerInner";
+
+  var hashJoinNodes = function (plan) {
+    return plan.nodes.filter(function(node) {
+      return (node.type === "HashJoinNode");
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      var i;
+
+      db._drop(outerName);
+      db._drop(innerName);
+      outer = db._create(outerName);
+      inner = db._create(innerName);
+
+      for (i = 0; i < 100; ++i) {
+        outer.save({ _key: "test" + i, value: i, ref: i % 10, sub: { ref: i % 10 } });
+      }
+      for (i = 0; i < 50; ++i) {
+        inner.save({ value: i % 20, name: "test" + i, sub: { value: i % 20 } });
+      }
+      inner.save({ name: "null" });
+      inner.save({ value: "5", name: "string" });
+      inner.save({ value: -0, name: "zero" });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(outerName);
+      db._drop(innerName);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [ 
+        "FOR i IN " + innerName + " RETURN i",
+        "FOR i IN " + innerName + " FILTER i.value == 1 RETURN i",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value > o.ref RETURN i",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == i.name RETURN i",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == 1 RETURN i",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == o.ref REMOVE i IN " + innerName,
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " SORT RAND() FILTER i.value == o.ref RETURN i",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == RAND() + o.ref RETURN i"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertTrue(result.plan.rules.indexOf(ruleName) === -1, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [ 
+        [ "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i", [ "value" ] ],
+        [ "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER o.ref == i.value RETURN i", [ "value" ] ],
+        [ "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.sub.value == o.sub.ref RETURN i", [ "sub", "value" ] ],
+        [ "FOR o IN 1..10 FOR i IN " + innerName + " FILTER i.value == o + 1 RETURN i", [ "value" ] ],
+        [ "FOR o IN " + outerName + " LET x = (FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i) RETURN x", [ "value" ] ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+        var nodes = hashJoinNodes(result.plan);
+        assertEqual(1, nodes.length, query[0]);
+        assertEqual(innerName, nodes[0].collection, query[0]);
+        assertEqual(query[1], nodes[0].attribute, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that an index is preferred over the hash join
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexPreferred : function () {
+      inner.ensureHashIndex("value");
+      var query = "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == o.ref RETURN i";
+
+      var result = AQL_EXPLAIN(query);
+      assertEqual(-1, result.plan.rules.indexOf(ruleName));
+      assertEqual(0, hashJoinNodes(result.plan).length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [ 
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == o.ref SORT o.value, i.name RETURN [ o.value, i.name ]",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.sub.value == o.sub.ref SORT o.value, i.name RETURN [ o.value, i.name ]",
+        "FOR o IN 0..20 FOR i IN " + innerName + " FILTER i.value == o SORT o, i.name RETURN [ o, i.name ]",
+        "FOR o IN [ null, '5', 0, 5, 5.0, [ 1 ] ] FOR i IN " + innerName + " FILTER i.value == o SORT i.name RETURN i.name",
+        "FOR o IN " + outerName + " FILTER o.value < 20 LET x = (FOR i IN " + innerName + " FILTER i.value == o.value SORT i.name RETURN i.name) RETURN x",
+        "FOR o IN " + outerName + " FOR i IN " + innerName + " FILTER i.value == o.ref LIMIT 5, 10 RETURN 1"
+      ];
+
+      queries.forEach(function(query) {
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query).json;
+
+        assertTrue(resultDisabled.length > 0, query);
+        assertEqual(resultDisabled, resultEnabled, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the hash table is not built for an empty outer side
+////////////////////////////////////////////////////////////////////////////////
+
+    testEmptyOuter : function () {
+      var query = "FOR o IN [ ] FOR i IN " + innerName + " FILTER i.value == o RETURN i";
+
+      var plan = AQL_EXPLAIN(query, { }, paramEnabled).plan;
+      assertEqual(1, hashJoinNodes(plan).length);
+
+      var result = AQL_EXECUTE(query, { }, paramEnabled);
+      assertEqual([ ], result.json);
+      assertEqual(0, result.stats.scannedFull);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the hash table is charged to the query's memory limit
+////////////////////////////////////////////////////////////////////////////////
+
+    testMemoryLimit : function () {
+      var value = new Array(1025).join("x");
+
+      for (var i = 0; i < 1000; ++i) {
+        inner.save({ value: value + i });
+      }
+
+      var query = "FOR o IN 1..1 FOR i IN " + innerName + " FILTER i.value == o RETURN i";
+      var plan = AQL_EXPLAIN(query, { }, paramEnabled).plan;
+      assertEqual(1, hashJoinNodes(plan).length);
+
+      try {
+        AQL_EXECUTE(query, { }, { memoryLimit: 256 * 1024, optimizer: paramEnabled.optimizer });
+        fail();
+      }
+      catch (err) {
+        assertEqual(internal.errors.ERROR_QUERY_RESOURCE_LIMIT.code, err.errorNum);
+      }
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,232 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertFalse, AQL_EXECUTE, AQL_EXPLAIN */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for parallel full collection scans
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function parallelScanTestSuite () {
+  var c = null;
+  var cn = "UnitTestsAhuacatlParallelScan";
+  var ruleName = "move-filters-into-enumerate";
+  var parallel = { scanThreads: 4 };
+
+  var nodeTypes = function (query) {
+    return AQL_EXPLAIN(query, { }, parallel).plan.nodes.map(function (node) {
+      return node.type;
+    });
+  };
+
+  var parallelScans = function (query) {
+    return AQL_EXPLAIN(query, { }, parallel).plan.nodes.filter(function (node) {
+      return node.type === "EnumerateCollectionNode" && node.parallel;
+    }).length;
+  };
+
+  var compare = function (query) {
+    var expected = AQL_EXECUTE(query).json;
+    var actual = AQL_EXECUTE(query, { }, parallel).json;
+
+    assertEqual(expected, actual, query);
+    return actual;
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 50000; ++i) {
+        c.save({ value: i, group: i % 13, name: "test" + i });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+      c = null;
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the rule only fires with multiple scan threads
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleUsage : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 3 RETURN i";
+
+      assertEqual(-1, AQL_EXPLAIN(query).plan.rules.indexOf(ruleName));
+      assertEqual(-1, AQL_EXPLAIN(query, { }, { scanThreads: 1 }).plan.rules.indexOf(ruleName));
+      assertTrue(AQL_EXPLAIN(query, { }, parallel).plan.rules.indexOf(ruleName) !== -1);
+
+      assertEqual(-1, nodeTypes(query).indexOf("FilterNode"));
+      assertEqual(1, parallelScans(query));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that non-deterministic filters are not moved into the scan
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNonDeterministic : function () {
+      var query = "FOR i IN " + cn + " FILTER i.value > RAND() RETURN i";
+
+      assertTrue(nodeTypes(query).indexOf("FilterNode") !== -1);
+      assertEqual(1, parallelScans(query));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that filters using _id or the complete documents are not 
+/// moved into the scan
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleIdOrDocument : function () {
+      [ 
+        "FOR i IN " + cn + " FILTER i._id == '" + cn + "/test' RETURN i",
+        "FOR i IN " + cn + " FILTER i['_id'] == '" + cn + "/test' RETURN i",
+        "FOR i IN " + cn + " FILTER HAS(i, 'value') RETURN i",
+        "FOR i IN " + cn + " FILTER i == { } RETURN i"
+      ].forEach(function (query) {
+        assertTrue(nodeTypes(query).indexOf("FilterNode") !== -1, query);
+      });
+
+      var actual = compare("FOR i IN " + cn + " FILTER i._id == CONCAT('" + cn + "/', i._key) && i.group == 3 RETURN i.value");
+      assertEqual(3846, actual.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that only the outermost scan runs in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleOutermost : function () {
+      assertEqual(1, parallelScans("FOR i IN " + cn + " FOR j IN " + cn + " FILTER i.value == j.value RETURN 1"));
+      assertEqual(0, parallelScans("FOR j IN 1..3 FOR i IN " + cn + " FILTER i.group == j RETURN 1"));
+      assertEqual(0, parallelScans("FOR j IN 1..3 LET x = (FOR i IN " + cn + " FILTER i.group == j RETURN 1) RETURN x"));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a full scan without filters
+////////////////////////////////////////////////////////////////////////////////
+
+    testScan : function () {
+      var actual = compare("FOR i IN " + cn + " RETURN i.value");
+      assertEqual(50000, actual.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a full scan with filters
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanFilter : function () {
+      var actual = compare("FOR i IN " + cn + " FILTER i.group == 3 && i.value >= 1000 RETURN i.value");
+      assertEqual(3769, actual.length);
+
+      actual = compare("FOR i IN " + cn + " FILTER i.group == 3 FILTER LIKE(i.name, 'test1%') RETURN i.name");
+      actual.forEach(function (name) {
+        assertEqual("test1", name.substr(0, 5));
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a filter that does not match anything
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanFilterEmpty : function () {
+      var actual = compare("FOR i IN " + cn + " FILTER i.group == 99 RETURN i");
+      assertEqual(0, actual.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test statistics
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanStats : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 3 RETURN i";
+      var stats = AQL_EXECUTE(query, { }, parallel).stats;
+
+      assertEqual(50000, stats.scannedFull);
+      assertEqual(50000 - 3846, stats.filtered);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test scans with COLLECT and SORT
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanCollectSort : function () {
+      compare("FOR i IN " + cn + " FILTER i.value % 2 == 0 COLLECT group = i.group WITH COUNT INTO count RETURN { group: group, count: count }");
+      compare("FOR i IN " + cn + " FILTER i.group IN [ 1, 2 ] SORT i.value DESC LIMIT 10, 100 RETURN i.value");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test scans in subqueries and with LIMIT
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanSubquery : function () {
+      compare("FOR j IN 1..3 LET x = (FOR i IN " + cn + " FILTER i.group == j RETURN i.value) RETURN LENGTH(x)");
+      var actual = compare("FOR i IN " + cn + " FILTER i.group == 5 LIMIT 17 RETURN i.value");
+      assertEqual(17, actual.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that modification queries are not scanned in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+    testScanModification : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 3 UPDATE i WITH { updated: true } IN " + cn;
+      AQL_EXECUTE(query, { }, parallel);
+
+      assertEqual(3846, AQL_EXECUTE("FOR i IN " + cn + " FILTER i.updated == true RETURN 1", { }, parallel).json.length);
+      assertFalse(AQL_EXECUTE("FOR i IN " + cn + " FILTER i.group != 3 && i.updated == true RETURN 1", { }, parallel).json.length > 0);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(parallelScanTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
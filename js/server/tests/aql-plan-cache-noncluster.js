@@ -0,0 +1,308 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertNotEqual, fail, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for the AQL execution plan cache
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+var errors = require("internal").errors;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function planCacheTestSuite () {
+  var c = null;
+  var cn = "UnitTestsAhuacatlPlanCache";
+
+  var fill = function () {
+    for (var i = 0; i < 100; ++i) {
+      c.save({ value: i, group: i % 10 });
+    }
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      db._drop(cn + "2");
+      c = db._create(cn);
+      fill();
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+      db._drop(cn + "2");
+      c = null;
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test repeated execution of the same query
+////////////////////////////////////////////////////////////////////////////////
+
+    testRepeatedExecution : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 3 SORT i.value RETURN i.value";
+
+      for (var i = 0; i < 5; ++i) {
+        assertEqual([ 3, 13, 23, 33, 43, 53, 63, 73, 83, 93 ], AQL_EXECUTE(query).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test repeated execution with different bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameters : function () {
+      var query = "FOR i IN @@cn FILTER i.group == @group SORT i.value LIMIT 2 RETURN i.value";
+
+      for (var i = 0; i < 3; ++i) {
+        assertEqual([ 1, 11 ], AQL_EXECUTE(query, { "@cn": cn, group: 1 }).json);
+        assertEqual([ 7, 17 ], AQL_EXECUTE(query, { "@cn": cn, group: 7 }).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that bind parameter values are not baked into cached plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameterValues : function () {
+      var query = "FOR i IN " + cn + " FILTER @all || i.value == @value SORT i.value LIMIT 3 RETURN i.value";
+
+      c.ensureHashIndex("value");
+
+      for (var i = 0; i < 3; ++i) {
+        assertEqual([ 42 ], AQL_EXECUTE(query, { all: false, value: 42 }).json);
+        assertEqual([ 0, 1, 2 ], AQL_EXECUTE(query, { all: true, value: 42 }).json);
+        assertEqual([ 17 ], AQL_EXECUTE(query, { value: 17, all: false }).json);
+        assertEqual([ ], AQL_EXECUTE(query, { all: false, value: "42" }).json);
+        assertEqual([ 1, 2, 3 ], AQL_EXECUTE("FOR i IN @values RETURN i", { values: [ 1, 2, 3 ] }).json);
+        assertEqual([ "a" ], AQL_EXECUTE("FOR i IN @values RETURN i", { values: [ "a" ] }).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test bind parameters used as index bounds in cached plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameterIndexBounds : function () {
+      var range = "FOR i IN " + cn + " FILTER i.value >= @low && i.value < @high SORT i.value RETURN i.value";
+      var list = "FOR i IN " + cn + " FILTER i.group IN @groups && i.value < @max SORT i.value RETURN i.value";
+
+      c.ensureSkiplist("value");
+      c.ensureHashIndex("group");
+
+      for (var i = 0; i < 3; ++i) {
+        assertEqual([ 10, 11, 12 ], AQL_EXECUTE(range, { low: 10, high: 13 }).json);
+        assertEqual([ 97, 98, 99 ], AQL_EXECUTE(range, { low: 97, high: 1000 }).json);
+        assertEqual([ ], AQL_EXECUTE(range, { low: 50, high: 50 }).json);
+        assertEqual([ ], AQL_EXECUTE(range, { low: "a", high: "b" }).json);
+        assertEqual([ 1, 2, 11, 12 ], AQL_EXECUTE(list, { groups: [ 1, 2 ], max: 20 }).json);
+        assertEqual([ 9 ], AQL_EXECUTE(list, { groups: [ 9 ], max: 10 }).json);
+        assertEqual([ ], AQL_EXECUTE(list, { groups: [ ], max: 100 }).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test constant expressions with bind parameters in cached plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameterExpressions : function () {
+      var query = "FOR i IN 1..3 LET x = @a + @b RETURN [ i * x, CONCAT(@prefix, i), @obj.sub ]";
+
+      for (var i = 0; i < 3; ++i) {
+        assertEqual([ [ 3, "a1", 1 ], [ 6, "a2", 1 ], [ 9, "a3", 1 ] ], AQL_EXECUTE(query, { a: 1, b: 2, prefix: "a", obj: { sub: 1 } }).json);
+        assertEqual([ [ 0, "1", null ], [ 0, "2", null ], [ 0, "3", null ] ], AQL_EXECUTE(query, { a: 0, b: 0, prefix: "", obj: { } }).json);
+        assertEqual([ [ 10, "x-1", [ 2 ] ], [ 20, "x-2", [ 2 ] ], [ 30, "x-3", [ 2 ] ] ], AQL_EXECUTE(query, { a: 5, b: 5, prefix: "x-", obj: { sub: [ 2 ] } }).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test bind parameters that determine the structure of the plan
+////////////////////////////////////////////////////////////////////////////////
+
+    testStructuralBindParameters : function () {
+      var query = "FOR i IN @@cn SORT i.value @dir LIMIT @offset, @count RETURN i.@attr";
+      var c2 = db._create(cn + "2");
+      c2.save({ value: 1, other: "foo" });
+      c2.save({ value: 2, other: "bar" });
+
+      for (var i = 0; i < 3; ++i) {
+        assertEqual([ 0, 1 ], AQL_EXECUTE(query, { "@cn": cn, dir: "ASC", offset: 0, count: 2, attr: "value" }).json);
+        assertEqual([ 99, 98, 97 ], AQL_EXECUTE(query, { "@cn": cn, dir: "DESC", offset: 0, count: 3, attr: "value" }).json);
+        assertEqual([ 8, 7 ], AQL_EXECUTE(query, { "@cn": cn, dir: "DESC", offset: 1, count: 2, attr: "group" }).json);
+        assertEqual([ "foo", "bar" ], AQL_EXECUTE(query, { "@cn": cn + "2", dir: "ASC", offset: 0, count: 2, attr: "other" }).json);
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test missing and superfluous bind parameters with cached plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testBindParameterErrors : function () {
+      var query = "FOR i IN " + cn + " FILTER i.value == @value RETURN i.value";
+
+      assertEqual([ 42 ], AQL_EXECUTE(query, { value: 42 }).json);
+
+      try {
+        AQL_EXECUTE(query, { });
+        fail();
+      }
+      catch (err1) {
+        assertEqual(errors.ERROR_QUERY_BIND_PARAMETER_MISSING.code, err1.errorNum);
+      }
+      
+      try {
+        AQL_EXECUTE(query, { value: 42, other: 1 });
+        fail();
+      }
+      catch (err2) {
+        assertEqual(errors.ERROR_QUERY_BIND_PARAMETER_UNDECLARED.code, err2.errorNum);
+      }
+
+      assertEqual([ 23 ], AQL_EXECUTE(query, { value: 23 }).json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test repeated execution with different options
+////////////////////////////////////////////////////////////////////////////////
+
+    testOptions : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 2 SORT i.value RETURN i.value";
+      var expected = [ 2, 12, 22, 32, 42, 52, 62, 72, 82, 92 ];
+
+      assertEqual(expected, AQL_EXECUTE(query).json);
+      assertEqual(expected, AQL_EXECUTE(query, { }, { optimizer: { rules: [ "-all" ] } }).json);
+      assertEqual(expected, AQL_EXECUTE(query, { }, { planCache: false }).json);
+      assertEqual(expected, AQL_EXECUTE(query).json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that data modifications are visible to cached plans
+////////////////////////////////////////////////////////////////////////////////
+
+    testDataModification : function () {
+      var query = "FOR i IN " + cn + " FILTER i.group == 5 RETURN i.value";
+
+      assertEqual(10, AQL_EXECUTE(query).json.length);
+      c.save({ value: 1000, group: 5 });
+      assertEqual(11, AQL_EXECUTE(query).json.length);
+      AQL_EXECUTE("FOR i IN " + cn + " FILTER i.group == 5 REMOVE i IN " + cn);
+      assertEqual(0, AQL_EXECUTE(query).json.length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test repeated execution of a modification query
+////////////////////////////////////////////////////////////////////////////////
+
+    testModificationQuery : function () {
+      var query = "FOR i IN 1..10 INSERT { value: i } IN " + cn;
+
+      for (var i = 0; i < 3; ++i) {
+        AQL_EXECUTE(query);
+      }
+
+      assertEqual(130, c.count());
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test index creation and removal
+////////////////////////////////////////////////////////////////////////////////
+
+    testIndexes : function () {
+      var query = "FOR i IN " + cn + " FILTER i.value == 42 RETURN i.group";
+
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+
+      var idx = c.ensureHashIndex("value");
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+
+      // the cached plan used the index, and must not be used anymore 
+      c.dropIndex(idx);
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+
+      idx = c.ensureSkiplist("value");
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+      c.dropIndex(idx);
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test dropping and re-creating the collection
+////////////////////////////////////////////////////////////////////////////////
+
+    testRecreateCollection : function () {
+      var query = "FOR i IN " + cn + " FILTER i.value < 3 SORT i.value RETURN i.value";
+
+      assertEqual([ 0, 1, 2 ], AQL_EXECUTE(query).json);
+
+      db._drop(cn);
+      c = db._create(cn);
+      c.save({ value: 1 });
+      assertEqual([ 1 ], AQL_EXECUTE(query).json);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test renaming the collection
+////////////////////////////////////////////////////////////////////////////////
+
+    testRenameCollection : function () {
+      var query = "FOR i IN " + cn + " FILTER i.value < 3 SORT i.value RETURN i.value";
+
+      assertEqual([ 0, 1, 2 ], AQL_EXECUTE(query).json);
+
+      c.rename(cn + "2");
+      c = db._create(cn);
+      c.save({ value: 2 });
+      assertEqual([ 2 ], AQL_EXECUTE(query).json);
+      assertNotEqual(0, db._collection(cn + "2").count());
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(planCacheTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
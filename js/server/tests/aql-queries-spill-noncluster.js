@@ -0,0 +1,155 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for queries that spill intermediate results to disk
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var db = require("org/arangodb").db;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function spillTestSuite () {
+  var c = null;
+  var cn = "UnitTestsAhuacatlSpill";
+
+  // spill as early as possible
+  var paramSpill = { spillThreshold: 1 };
+  var paramNoSpill = { spillThreshold: 0 };
+
+  var compare = function (queries) {
+    queries.forEach(function(query) {
+      var expected = AQL_EXECUTE(query, { }, paramNoSpill).json;
+      var actual = AQL_EXECUTE(query, { }, paramSpill).json;
+
+      assertTrue(expected.length > 0, query);
+      assertEqual(expected, actual, query);
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      db._drop(cn);
+      c = db._create(cn);
+
+      for (var i = 0; i < 5000; ++i) {
+        c.save({ value: i, group: i % 113, name: "test" + (i % 250), flag: (i % 3 === 0) });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      db._drop(cn);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting with spilling
+////////////////////////////////////////////////////////////////////////////////
+
+    testSort : function () {
+      compare([
+        "FOR i IN " + cn + " SORT i.value RETURN i.value",
+        "FOR i IN " + cn + " SORT i.value DESC RETURN i.value",
+        "FOR i IN " + cn + " SORT i.name, i.value DESC RETURN [ i.name, i.value ]",
+        "FOR i IN " + cn + " SORT i.flag, i.group RETURN [ i.flag, i.group, i.value ]",
+        "FOR i IN " + cn + " SORT i.group RETURN i",
+        "FOR i IN " + cn + " SORT i.missing, i.value RETURN i.value",
+        "FOR i IN 1..10000 SORT i % 17, i DESC RETURN i"
+      ]);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting with spilling, skipping rows
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortSkip : function () {
+      compare([
+        "FOR i IN " + cn + " SORT i.value LIMIT 1234, 2000 RETURN i.value",
+        "FOR i IN " + cn + " SORT i.name, i.value LIMIT 4990, 100 RETURN i.value"
+      ]);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting with spilling inside a subquery
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortSubquery : function () {
+      compare([
+        "FOR j IN 1..3 LET s = (FOR i IN " + cn + " FILTER i.group == j SORT i.value DESC RETURN i.value) RETURN s"
+      ]);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test hashed COLLECT with spilling
+////////////////////////////////////////////////////////////////////////////////
+
+    testHashCollect : function () {
+      compare([
+        "FOR i IN " + cn + " COLLECT value = i.group OPTIONS { method: 'hash' } SORT value RETURN value",
+        "FOR i IN " + cn + " COLLECT value = i.group WITH COUNT INTO cnt OPTIONS { method: 'hash' } SORT value RETURN [ value, cnt ]",
+        "FOR i IN " + cn + " COLLECT name = i.name, flag = i.flag WITH COUNT INTO cnt OPTIONS { method: 'hash' } SORT name, flag RETURN [ name, flag, cnt ]",
+        "FOR i IN " + cn + " COLLECT value = i.value OPTIONS { method: 'hash' } SORT value RETURN value",
+        "FOR i IN 1..10000 COLLECT value = i % 1000 WITH COUNT INTO cnt OPTIONS { method: 'hash' } SORT value RETURN [ value, cnt ]"
+      ]);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test hashed COLLECT with spilling, counting results
+////////////////////////////////////////////////////////////////////////////////
+
+    testHashCollectCount : function () {
+      var query = "FOR i IN " + cn + " COLLECT value = i.value OPTIONS { method: 'hash' } RETURN value";
+      var actual = AQL_EXECUTE(query, { }, paramSpill).json;
+
+      assertEqual(5000, actual.length);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(spillTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,301 @@
+/*jshint globalstrict:false, strict:false */
+/*global assertEqual, assertTrue, assertNotEqual */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test the collection checkpoints
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var internal = require("internal");
+var fs = require("fs");
+var testHelper = require("org/arangodb/test-helper").Helper;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       checkpoints
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite: checkpoints
+////////////////////////////////////////////////////////////////////////////////
+
+function CheckpointSuite () {
+  'use strict';
+  var cn = "UnitTestsCheckpoint";
+  var c = null;
+
+  var checkpointFile = function () {
+    return fs.join(internal.db._path(), "collection-" + c._id, "checkpoint.db");
+  };
+
+  var checkpointSize = function () {
+    var file = checkpointFile();
+
+    if (! fs.exists(file)) {
+      return 0;
+    }
+    return fs.size(file);
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief waits until the compactor has (re-)written the checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+  var waitForCheckpoint = function (previousSize) {
+    var end = internal.time() + 90;
+    var size = checkpointSize();
+
+    while ((size === 0 || size === previousSize) && internal.time() < end) {
+      internal.wait(1, false);
+      size = checkpointSize();
+    }
+
+    assertNotEqual(0, size);
+    assertNotEqual(previousSize, size);
+
+    return size;
+  };
+
+  var insert = function (from, to) {
+    for (var i = from; i < to; ++i) {
+      c.save({ _key: "test" + i, value: i, text: "the quick brown fox " + i });
+    }
+  };
+
+  var state = function () {
+    var fig = c.figures();
+    var docs = c.toArray().map(function (doc) {
+      return [ doc._key, doc._rev, doc.value ];
+    });
+
+    docs.sort(function (l, r) {
+      return l[0] < r[0] ? -1 : (l[0] > r[0] ? 1 : 0);
+    });
+
+    return {
+      count: c.count(),
+      documents: docs,
+      alive: fig.alive,
+      dead: fig.dead,
+      shapes: fig.shapes.count,
+      attributes: fig.attributes.count,
+      datafiles: fig.datafiles.count
+    };
+  };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the collection with and without its checkpoint, and checks
+/// that both result in the same state
+////////////////////////////////////////////////////////////////////////////////
+
+  var verify = function (expectedCount) {
+    // load using the checkpoint
+    testHelper.waitUnload(c);
+    assertTrue(fs.exists(checkpointFile()));
+    c.load();
+    var withCheckpoint = state();
+
+    // load by scanning all datafiles
+    testHelper.waitUnload(c);
+    fs.remove(checkpointFile());
+    c.load();
+    var withoutCheckpoint = state();
+
+    assertEqual(expectedCount, withCheckpoint.count);
+    assertEqual(expectedCount, withCheckpoint.documents.length);
+    assertEqual(withoutCheckpoint, withCheckpoint);
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      internal.debugClearFailAt();
+      internal.db._drop(cn);
+      c = internal.db._create(cn, { journalSize: 1048576 });
+
+      // do not wait for the checkpoint interval
+      internal.debugSetFailAt("CompactorCheckpointInterval");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      internal.debugClearFailAt();
+      internal.db._drop(cn);
+      c = null;
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checkpoint is written for sealed datafiles and used when loading
+////////////////////////////////////////////////////////////////////////////////
+
+    testWriteAndLoad : function () {
+      insert(0, 1000);
+
+      for (var i = 0; i < 20; ++i) {
+        c.update("test" + i, { value: -i });
+        c.remove("test" + (i + 500));
+      }
+
+      testHelper.rotate(c);
+      waitForCheckpoint(0);
+
+      verify(980);
+      assertEqual(-5, c.document("test5").value);
+      assertEqual(false, c.exists("test505"));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checkpoint is extended by newly sealed datafiles that update and
+/// remove documents covered by the previous checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+    testIncremental : function () {
+      var i;
+
+      insert(0, 1000);
+      testHelper.rotate(c);
+      var size = waitForCheckpoint(0);
+
+      // few enough changes so the first datafile is not compacted
+      insert(1000, 1500);
+
+      for (i = 0; i < 20; ++i) {
+        c.update("test" + (i * 10), { value: -i });
+        c.remove("test" + (i * 10 + 1));
+      }
+
+      testHelper.rotate(c);
+      waitForCheckpoint(size);
+
+      verify(1480);
+      assertEqual(-3, c.document("test30").value);
+      assertEqual(false, c.exists("test31"));
+      assertEqual(1499, c.document("test1499").value);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compaction keeps the checkpoint, and the next checkpoint reflects
+/// the compacted datafiles
+////////////////////////////////////////////////////////////////////////////////
+
+    testCompaction : function () {
+      var i;
+
+      insert(0, 1000);
+      testHelper.rotate(c);
+      insert(1000, 2000);
+      testHelper.rotate(c);
+      var size = waitForCheckpoint(0);
+
+      // make the second datafile eligible for compaction
+      for (i = 1000; i < 1800; ++i) {
+        c.remove("test" + i);
+      }
+
+      testHelper.rotate(c);
+      waitForCheckpoint(size);
+
+      verify(1200);
+      assertEqual(false, c.exists("test1000"));
+      assertEqual(1800, c.document("test1800").value);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the edge index is filled for edges restored from a checkpoint
+////////////////////////////////////////////////////////////////////////////////
+
+    testEdges : function () {
+      var i;
+
+      internal.db._drop(cn);
+      c = internal.db._createEdgeCollection(cn, { journalSize: 1048576 });
+
+      for (i = 0; i < 1000; ++i) {
+        c.save("vertices/v" + (i % 10), "vertices/w" + i, { _key: "test" + i, value: i });
+      }
+
+      for (i = 0; i < 10; ++i) {
+        c.remove("test" + (i * 10));
+      }
+
+      testHelper.rotate(c);
+      waitForCheckpoint(0);
+
+      verify(990);
+      assertEqual(99, c.outEdges("vertices/v0").length);
+      assertEqual(100, c.outEdges("vertices/v1").length);
+      assertEqual(1, c.inEdges("vertices/w999").length);
+      assertEqual(0, c.inEdges("vertices/w990").length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a checkpoint that does not match the datafiles is ignored
+////////////////////////////////////////////////////////////////////////////////
+
+    testInvalidCheckpoint : function () {
+      insert(0, 1000);
+      testHelper.rotate(c);
+      waitForCheckpoint(0);
+
+      testHelper.waitUnload(c);
+      fs.write(checkpointFile(), "this is not a checkpoint");
+      c.load();
+
+      assertEqual(1000, c.count());
+      assertEqual(999, c.document("test999").value);
+
+      // the compactor replaces the invalid checkpoint
+      waitForCheckpoint("this is not a checkpoint".length);
+      verify(1000);
+    }
+
+  };
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                              main
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suites
+////////////////////////////////////////////////////////////////////////////////
+
+if (internal.debugCanUseFailAt()) {
+  jsunity.run(CheckpointSuite);
+}
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
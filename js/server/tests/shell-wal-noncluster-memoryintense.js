@@ -409,6 +409,57 @@ function walSuite () {
       }
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test concurrent writers while logfiles are switched
+////////////////////////////////////////////////////////////////////////////////
+
+    testConcurrentWritesWithFlush : function () {
+      var tasks = require("org/arangodb/tasks");
+      var cnDone = cn + "Done";
+      var numTasks = 16;
+      var numDocuments = 2000;
+      var i;
+
+      db._drop(cnDone);
+      db._create(cnDone);
+
+      var task = {
+        offset: 0,
+        params: { cn: cn, cnDone: cnDone, numDocuments: numDocuments },
+        command: function (params) {
+          var db = require("internal").db;
+          var c = db._collection(params.cn);
+
+          for (var i = 0; i < params.numDocuments; ++i) {
+            // some writers wait for the synchronizer, too
+            c.save({ value: i, payload: "some payload to fill the logfiles" }, (i % 100 === 0));
+          }
+
+          db._collection(params.cnDone).save({ });
+        }
+      };
+
+      for (i = 0; i < numTasks; ++i) {
+        task.id = "walwriter" + i;
+        tasks.register(task);
+      }
+
+      // switch logfiles while the writers are running
+      var tries = 0;
+      while (db._collection(cnDone).count() < numTasks && ++tries < 600) {
+        internal.wal.flush(tries % 2 === 0, false);
+        internal.wait(0.1, false);
+      }
+
+      assertEqual(numTasks, db._collection(cnDone).count());
+      db._drop(cnDone);
+
+      assertEqual(numTasks * numDocuments, c.count());
+      assertEqual(numTasks, c.byExample({ value: numDocuments - 1 }).toArray().length);
+
+      internal.wal.flush(true, false);
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test transactions
 ////////////////////////////////////////////////////////////////////////////////
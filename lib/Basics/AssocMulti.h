@@ -452,24 +452,30 @@ namespace triagens {
             std::vector<std::thread> threads;
             threads.reserve(numThreads);
 
-            try {
-              for (size_t i = 0; i < numThreads; ++i) {
-                size_t lower = i * chunkSize;
-                size_t upper = (i + 1) * chunkSize;
+            if (numThreads == 1) {
+              // no need to start a thread for a single chunk
+              partitioner(0, elements.size());
+            }
+            else {
+              try {
+                for (size_t i = 0; i < numThreads; ++i) {
+                  size_t lower = i * chunkSize;
+                  size_t upper = (i + 1) * chunkSize;
 
-                if (i + 1 == numThreads) {
-                  // last chunk. account for potential rounding errors
-                  upper = elements.size();
-                }
-                else if (upper > elements.size()) {
-                  upper = elements.size();
-                }
+                  if (i + 1 == numThreads) {
+                    // last chunk. account for potential rounding errors
+                    upper = elements.size();
+                  }
+                  else if (upper > elements.size()) {
+                    upper = elements.size();
+                  }
 
-                threads.emplace_back(std::thread(partitioner, lower, upper));
+                  threads.emplace_back(std::thread(partitioner, lower, upper));
+                }
+              }
+              catch (...) {
+                res = TRI_ERROR_INTERNAL;
               }
-            }
-            catch (...) {
-              res = TRI_ERROR_INTERNAL;
             }
 
             for (size_t i = 0; i < threads.size(); ++i) {
@@ -514,13 +520,18 @@ namespace triagens {
             std::vector<std::thread> threads;
             threads.reserve(numThreads);
 
-            try {
-              for (size_t i = 0; i < numThreads; ++i) {
-                threads.emplace_back(std::thread(inserter, i));
-              }
+            if (numThreads == 1) {
+              inserter(0);
             }
-            catch (...) {
-              res = TRI_ERROR_INTERNAL;
+            else {
+              try {
+                for (size_t i = 0; i < numThreads; ++i) {
+                  threads.emplace_back(std::thread(inserter, i));
+                }
+              }
+              catch (...) {
+                res = TRI_ERROR_INTERNAL;
+              }
             }
 
             for (size_t i = 0; i < threads.size(); ++i) {
@@ -399,6 +399,49 @@ namespace triagens {
             return sum;
           }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the number of buckets
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t numBuckets () const {
+            return _buckets.size();
+          }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief get the number of slots in a bucket
+////////////////////////////////////////////////////////////////////////////////
+
+          uint64_t bucketCapacity (size_t bucketId) const {
+            TRI_ASSERT(bucketId < _buckets.size());
+            return _buckets[bucketId]._nrAlloc;
+          }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invokes a callback for all elements in the slot range [from, to)
+/// of a bucket. the range is clamped to the bucket's size. the caller must
+/// make sure that the hash is not modified concurrently
+////////////////////////////////////////////////////////////////////////////////
+
+          void invokeOnRange (size_t bucketId,
+                              uint64_t from,
+                              uint64_t to,
+                              CallbackElementFuncType const& callback) const {
+            TRI_ASSERT(bucketId < _buckets.size());
+            Bucket const& b = _buckets[bucketId];
+
+            if (to > b._nrAlloc) {
+              to = b._nrAlloc;
+            }
+
+            for (uint64_t i = from; i < to; ++i) {
+              Element* element = b._table[i];
+
+              if (element != nullptr) {
+                callback(element);
+              }
+            }
+          }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief resizes the hash table
 ////////////////////////////////////////////////////////////////////////////////
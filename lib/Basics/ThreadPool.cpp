@@ -32,6 +32,54 @@
 
 using namespace triagens::basics;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shared state of a parallelFor call
+///
+/// pool threads may pick up their task after the caller has returned, so the
+/// state is reference-counted and the function is only called for values
+/// that have not been claimed yet
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+  struct ParallelForState {
+    ParallelForState (size_t n,
+                      std::function<void(size_t)> const& func)
+      : _n(n),
+        _func(func),
+        _next(0),
+        _done(0),
+        _condition() {
+    }
+
+    void work () {
+      while (true) {
+        size_t i = _next++;
+
+        if (i >= _n) {
+          return;
+        }
+
+        _func(i);
+
+        if (++_done == _n) {
+          CONDITION_LOCKER(guard, _condition);
+          guard.broadcast();
+        }
+      }
+    }
+
+    size_t const                        _n;
+    std::function<void(size_t)> const   _func;
+    std::atomic<size_t>                 _next;
+    std::atomic<size_t>                 _done;
+    triagens::basics::ConditionVariable _condition;
+  };
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                        ThreadPool
 // -----------------------------------------------------------------------------
@@ -113,6 +161,42 @@ bool ThreadPool::dequeue (std::function<void()>& result) {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calls the function for all values from 0 to n - 1 in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::parallelFor (size_t n,
+                              std::function<void(size_t)> const& func) {
+  if (n == 0) {
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>(n, func);
+
+  size_t const helpers = (std::min)(numThreads(), n - 1);
+
+  for (size_t i = 0; i < helpers; ++i) {
+    try {
+      enqueue([state] () -> void {
+        state->work();
+      });
+    }
+    catch (...) {
+      // the calling thread will do the remaining work
+      break;
+    }
+  }
+
+  state->work();
+
+  // wait for calls still running in pool threads
+  CONDITION_LOCKER(guard, state->_condition);
+
+  while (state->_done.load() < n) {
+    guard.wait(10000);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
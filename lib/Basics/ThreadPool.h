@@ -103,6 +103,18 @@ namespace triagens {
           _condition.signal();
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calls the function for all values from 0 to n - 1 in parallel
+///
+/// the calls are distributed over the pool's threads and the calling thread.
+/// the calling thread only waits for calls that have already been started by
+/// pool threads, so this can also be used from within a task running in the
+/// same pool. the function must not throw
+////////////////////////////////////////////////////////////////////////////////
+
+        void parallelFor (size_t,
+                          std::function<void(size_t)> const&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -29,6 +29,13 @@
 
 #include "hashes.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <nmmintrin.h>
+#endif
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                               FNV
 // -----------------------------------------------------------------------------
@@ -524,6 +531,219 @@ uint32_t TRI_Crc32HashString (char const* data) {
   return TRI_FinalCrc32(crc);
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                            CRC32C
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief precomputed lookup values for crc32c 8 bytes-at-a-time calculation
+/// (software fallback), generated by TRI_InitializeHashes
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t Crc32CLookup[8][256];
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the crc32c implementation in use, selected by TRI_InitializeHashes
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t (*BlockCrc32CImplementation) (uint32_t, char const*, size_t) = nullptr;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generates the crc32c lookup tables
+////////////////////////////////////////////////////////////////////////////////
+
+static void GenerateCrc32CLookup () {
+  // reflected Castagnoli polynomial (0x1EDC6F41)
+  uint32_t const polynomial = 0x82F63B78;
+
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t value = i;
+
+    for (int j = 0; j < 8; ++j) {
+      value = (value >> 1) ^ ((value & 1) ? polynomial : 0);
+    }
+
+    Crc32CLookup[0][i] = value;
+  }
+
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (int slice = 1; slice < 8; ++slice) {
+      uint32_t previous = Crc32CLookup[slice - 1][i];
+      Crc32CLookup[slice][i] = (previous >> 8) ^ Crc32CLookup[0][previous & 0xFF];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, software version
+///
+/// uses the same slicing-by-8 approach as TRI_BlockCrc32
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t BlockCrc32CSoftware (uint32_t value, char const* data, size_t length) {
+  uint32_t* current = (uint32_t*) data;
+  uint8_t* currentChar;
+
+  // process eight bytes at once
+  while (length >= 8) {
+    uint32_t one = *current++ ^ value;
+    uint32_t two = *current++;
+
+    value = Crc32CLookup[0][(two>>24) & 0xFF] ^
+            Crc32CLookup[1][(two>>16) & 0xFF] ^
+            Crc32CLookup[2][(two>> 8) & 0xFF] ^
+            Crc32CLookup[3][ two      & 0xFF] ^
+            Crc32CLookup[4][(one>>24) & 0xFF] ^
+            Crc32CLookup[5][(one>>16) & 0xFF] ^
+            Crc32CLookup[6][(one>> 8) & 0xFF] ^
+            Crc32CLookup[7][ one      & 0xFF];
+    length -= 8;
+  }
+
+  currentChar = (uint8_t*) current;
+  // remaining 1 to 7 bytes (standard CRC table-based algorithm)
+  while (length--) {
+    value = (value >> 8) ^ Crc32CLookup[0][(value & 0xFF) ^ *currentChar++];
+  }
+
+  return value;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief SSE4.2 crc32 instructions. inline assembly is used so the file
+/// does not need to be compiled with -msse4.2
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_HAVE_HARDWARE_CRC32C 1
+
+static inline uint64_t Crc32CInstruction64 (uint64_t crc, uint64_t value) {
+  __asm__("crc32q %1, %0" : "+r" (crc) : "rm" (value));
+  return crc;
+}
+
+static inline uint32_t Crc32CInstruction8 (uint32_t crc, uint8_t value) {
+  __asm__("crc32b %1, %0" : "+r" (crc) : "rm" (value));
+  return crc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the CPU supports SSE4.2
+////////////////////////////////////////////////////////////////////////////////
+
+static bool HasHardwareCrc32C () {
+  unsigned int eax, ebx, ecx, edx;
+
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+
+  return (ecx & bit_SSE4_2) != 0;
+}
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+
+#define TRI_HAVE_HARDWARE_CRC32C 1
+
+static inline uint64_t Crc32CInstruction64 (uint64_t crc, uint64_t value) {
+  return _mm_crc32_u64(crc, value);
+}
+
+static inline uint32_t Crc32CInstruction8 (uint32_t crc, uint8_t value) {
+  return _mm_crc32_u8(crc, value);
+}
+
+static bool HasHardwareCrc32C () {
+  int info[4];
+  __cpuid(info, 1);
+
+  return (info[2] & (1 << 20)) != 0;
+}
+
+#endif
+
+#ifdef TRI_HAVE_HARDWARE_CRC32C
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, hardware version
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t BlockCrc32CHardware (uint32_t value, char const* data, size_t length) {
+  uint8_t const* current = reinterpret_cast<uint8_t const*>(data);
+
+  // process single bytes until the data is aligned
+  while (length > 0 && (reinterpret_cast<uintptr_t>(current) & 7) != 0) {
+    value = Crc32CInstruction8(value, *current++);
+    --length;
+  }
+
+  // process eight bytes at once
+  uint64_t value64 = value;
+
+  while (length >= 8) {
+    value64 = Crc32CInstruction64(value64, *reinterpret_cast<uint64_t const*>(current));
+    current += 8;
+    length -= 8;
+  }
+
+  value = static_cast<uint32_t>(value64);
+
+  // remaining 1 to 7 bytes
+  while (length--) {
+    value = Crc32CInstruction8(value, *current++);
+  }
+
+  return value;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block
+///
+/// uses the SSE4.2 crc32 instruction if the CPU supports it, and a
+/// table-based implementation otherwise. both produce identical results
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32C (uint32_t value, char const* data, size_t length) {
+  TRI_ASSERT(BlockCrc32CImplementation != nullptr);
+
+  return BlockCrc32CImplementation(value, data, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, always using the software version
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32CSoftware (uint32_t value, char const* data, size_t length) {
+  return BlockCrc32CSoftware(value, data, length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not CRC32C values are calculated in hardware
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_HasHardwareCrc32C () {
+#ifdef TRI_HAVE_HARDWARE_CRC32C
+  return HasHardwareCrc32C();
+#else
+  return false;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                            MODULE
 // -----------------------------------------------------------------------------
@@ -552,6 +772,15 @@ void TRI_InitializeHashes () {
   }
 
   GenerateCrc32Polynomial();
+  GenerateCrc32CLookup();
+
+  BlockCrc32CImplementation = &BlockCrc32CSoftware;
+
+#ifdef TRI_HAVE_HARDWARE_CRC32C
+  if (HasHardwareCrc32C()) {
+    BlockCrc32CImplementation = &BlockCrc32CHardware;
+  }
+#endif
 
   Initialized = true;
 }
@@ -102,6 +102,35 @@ uint32_t TRI_Crc32HashPointer (void const*, size_t);
 
 uint32_t TRI_Crc32HashString (char const*);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                            CRC32C
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C (Castagnoli) value of data block
+///
+/// uses the same initial and final values as CRC32, so TRI_InitialCrc32 and
+/// TRI_FinalCrc32 can be used with it
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32C (uint32_t, char const* data, size_t length);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief CRC32C value of data block, always using the software version
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TRI_BlockCrc32CSoftware (uint32_t, char const* data, size_t length);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not CRC32C values are calculated in hardware
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_HasHardwareCrc32C ();
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                            MODULE
 // -----------------------------------------------------------------------------
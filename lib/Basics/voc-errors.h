@@ -368,6 +368,9 @@
 ///   Will be raised when a runtime error is caused by the query.
 /// - 1504: @LIT{number out of range}
 ///   Will be raised when a number is outside the expected range.
+/// - 1505: @LIT{query would use more memory than allowed}
+///   Will be raised when a query uses more memory than its configured memory
+///   limit.
 /// - 1510: @LIT{variable name '\%s' has an invalid format}
 ///   Will be raised when an invalid variable name is used.
 /// - 1511: @LIT{variable '\%s' is assigned multiple times}
@@ -2179,6 +2182,17 @@ void TRI_InitializeErrorMessages ();
 
 #define TRI_ERROR_QUERY_NUMBER_OUT_OF_RANGE                               (1504)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 1505: ERROR_QUERY_RESOURCE_LIMIT
+///
+/// query would use more memory than allowed
+///
+/// Will be raised when a query uses more memory than its configured memory
+/// limit.
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_QUERY_RESOURCE_LIMIT                                    (1505)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief 1510: ERROR_QUERY_VARIABLE_NAME_INVALID
 ///